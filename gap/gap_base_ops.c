@@ -28,6 +28,8 @@
  */
 
 /* revision history:
+ * 2.7.0a;  2026/10/18   hof: delete, duplicate, shift, reverse and renumber
+ *                            rename the frames as one batch (gap_frame_rename)
  * 1.3.17b; 2003/07/31   hof: message text fixes for translators (# 118392)
  * 1.3.16b; 2003/07/04   hof: added gap_density, confirm dialog for frame deleting operations
  * 1.3.15a  2003/06/21   hof: textspacing
@@ -53,6 +55,7 @@
 #include "gap_base_ops.h"
 #include "gap_pdb_calls.h"
 #include "gap_arr_dialog.h"
+#include "gap_frame_rename.h"
 #include "gap_lock.h"
 #include "gap_thumbnail.h"
 
@@ -431,6 +434,8 @@ static gint32
 p_del(GapAnimInfo *ainfo_ptr, long cnt)
 {
    long  l_lo, l_hi, l_curr, l_idx;
+   gint32 l_rc;
+   GapFrameRenameBatch *rbat;
 
    if(gap_debug) fprintf(stderr, "DEBUG  p_del\n");
 
@@ -459,24 +464,28 @@ p_del(GapAnimInfo *ainfo_ptr, long cnt)
       l_idx++;
    }
 
+   if(ainfo_ptr->run_mode == GIMP_RUN_INTERACTIVE)
+   {
+     gimp_progress_init( _("Renumber frame sequence..."));
+   }
+
    /* rename (renumber) all frames with number greater than current
     */
+   rbat = gap_frame_rename_batch_new(ainfo_ptr);
    l_lo   = l_curr;
    l_hi   = l_curr + cnt;
    while(l_hi <= ainfo_ptr->last_frame_nr)
    {
-     if(0 != gap_lib_rename_frame(ainfo_ptr, l_hi, l_lo))
-     {
-        gchar *tmp_errtxt;
-
-        tmp_errtxt = g_strdup_printf(_("Error: could not rename frame %ld to %ld") ,l_hi, l_lo);
-        gap_arr_msg_win(ainfo_ptr->run_mode, tmp_errtxt);
-        g_free(tmp_errtxt);
-        return -1;
-     }
+     gap_frame_rename_batch_add(rbat, l_hi, l_lo);
      l_lo++;
      l_hi++;
    }
+   l_rc = gap_frame_rename_batch_execute(rbat);
+   gap_frame_rename_batch_free(rbat);
+   if(l_rc != 0)
+   {
+     return -1;
+   }
 
    /* calculate how much frames are left */
    ainfo_ptr->frame_cnt -= cnt;
@@ -525,6 +534,8 @@ p_dup(GapAnimInfo *ainfo_ptr, long cnt, long range_from, long range_to)
    char  *l_dup_name;
    char  *l_curr_name;
    gdouble    l_percentage, l_percentage_step;
+   gint32 l_rc;
+   GapFrameRenameBatch *rbat;
 
    if(gap_debug) fprintf(stderr, "DEBUG  p_dup fr:%d to:%d cnt:%d extension:%s: basename:%s frame_cnt:%d\n",
                          (int)range_from, (int)range_to, (int)cnt, ainfo_ptr->extension, ainfo_ptr->basename, (int)ainfo_ptr->frame_cnt);
@@ -594,21 +605,21 @@ p_dup(GapAnimInfo *ainfo_ptr, long cnt, long range_from, long range_to)
 
    /* rename (renumber) all frames with number greater than current
     */
+   rbat = gap_frame_rename_batch_new(ainfo_ptr);
    l_lo   = ainfo_ptr->last_frame_nr;
    l_hi   = l_lo + l_cnt2;
    while(l_lo > l_src_nr_max)
    {
-     if(0 != gap_lib_rename_frame(ainfo_ptr, l_lo, l_hi))
-     {
-        gchar *tmp_errtxt;
-        tmp_errtxt = g_strdup_printf(_("Error: could not rename frame %ld to %ld"), l_lo, l_hi);
-        gap_arr_msg_win(ainfo_ptr->run_mode, tmp_errtxt);
-        g_free(tmp_errtxt);
-        return -1;
-     }
+     gap_frame_rename_batch_add(rbat, l_lo, l_hi);
      l_lo--;
      l_hi--;
    }
+   l_rc = gap_frame_rename_batch_execute(rbat);
+   gap_frame_rename_batch_free(rbat);
+   if(l_rc != 0)
+   {
+     return -1;
+   }
 
 
    l_percentage_step = 1.0 / ((1.0 + l_hi) - l_src_nr_max);
@@ -738,12 +749,10 @@ static gint32
 p_shift(GapAnimInfo *ainfo_ptr, long cnt, long range_from, long range_to)
 {
    long  l_lo, l_hi, l_curr, l_dst;
-   long  l_upper;
    long  l_shift;
    gchar *l_curr_name;
-   gchar *tmp_errtxt;
-
-   gdouble    l_percentage, l_percentage_step;
+   gint32 l_rc;
+   GapFrameRenameBatch *rbat;
 
    if(gap_debug) fprintf(stderr, "DEBUG  p_shift fr:%d to:%d cnt:%d\n",
                          (int)range_from, (int)range_to, (int)cnt);
@@ -781,56 +790,30 @@ p_shift(GapAnimInfo *ainfo_ptr, long cnt, long range_from, long range_to)
    }
    g_free(l_curr_name);
 
-   l_percentage = 0.0;
    if(ainfo_ptr->run_mode == GIMP_RUN_INTERACTIVE)
    {
      gimp_progress_init( _("Renumber frame sequence..."));
    }
 
-   /* rename (renumber) all frames (using high numbers)
-    */
-
-   l_upper = ainfo_ptr->last_frame_nr +100;
-   l_percentage_step = 0.5 / ((1.0 + l_lo) - l_hi);
-   for(l_curr = l_lo; l_curr <= l_hi; l_curr++)
-   {
-     if(0 != gap_lib_rename_frame(ainfo_ptr, l_curr, l_curr + l_upper))
-     {
-        tmp_errtxt = g_strdup_printf(_("Error: could not rename frame %ld to %ld"), l_lo, l_hi);
-        gap_arr_msg_win(ainfo_ptr->run_mode, tmp_errtxt);
-        g_free(tmp_errtxt);
-        return -1;
-     }
-     if(ainfo_ptr->run_mode == GIMP_RUN_INTERACTIVE)
-     {
-       l_percentage += l_percentage_step;
-       gimp_progress_update (l_percentage);
-     }
-   }
-
-   /* rename (renumber) all frames (using desied destination numbers)
+   /* rename (renumber) all frames (using desired destination numbers)
+    * the batch orders the renames so that no temporary high numbers are needed
     */
+   rbat = gap_frame_rename_batch_new(ainfo_ptr);
    l_dst = l_lo + l_shift;
    if (l_dst > l_hi) { l_dst -= (l_lo -1); }
    if (l_dst < l_lo) { l_dst += ((l_hi - l_lo) +1); }
-   for(l_curr = l_upper + l_lo; l_curr <= l_upper + l_hi; l_curr++)
+   for(l_curr = l_lo; l_curr <= l_hi; l_curr++)
    {
      if (l_dst > l_hi) { l_dst = l_lo; }
-     if(0 != gap_lib_rename_frame(ainfo_ptr, l_curr, l_dst))
-     {
-        tmp_errtxt = g_strdup_printf(_("Error: could not rename frame %ld to %ld"), l_lo, l_hi);
-        gap_arr_msg_win(ainfo_ptr->run_mode, tmp_errtxt);
-        g_free(tmp_errtxt);
-        return -1;
-     }
-     if(ainfo_ptr->run_mode == GIMP_RUN_INTERACTIVE)
-     {
-       l_percentage += l_percentage_step;
-       gimp_progress_update (l_percentage);
-     }
-
+     gap_frame_rename_batch_add(rbat, l_curr, l_dst);
      l_dst ++;
    }
+   l_rc = gap_frame_rename_batch_execute(rbat);
+   gap_frame_rename_batch_free(rbat);
+   if(l_rc != 0)
+   {
+     return -1;
+   }
 
 
    /* load from the "new" current frame */
@@ -857,14 +840,9 @@ p_shift(GapAnimInfo *ainfo_ptr, long cnt, long range_from, long range_to)
 static gint32
 p_reverse(GapAnimInfo *ainfo_ptr, long range_from, long range_to)
 {
-   long  l_tmp_nr;
    long  l_lo, l_hi, l_curr;
-   long  l_swap;
-   gchar *tmp_errtxt;
-
-   gdouble    l_percentage;
-
-   l_tmp_nr = ainfo_ptr->last_frame_nr + 4;  /* use a free frame_nr for temp name */
+   gint32 l_rc;
+   GapFrameRenameBatch *rbat;
 
    if(gap_debug) fprintf(stderr, "DEBUG  p_reverse fr:%d to:%d\n",
                          (int)range_from, (int)range_to);
@@ -896,46 +874,24 @@ p_reverse(GapAnimInfo *ainfo_ptr, long range_from, long range_to)
         return -1;
    }
 
-   l_percentage = 0.0;
    if(ainfo_ptr->run_mode == GIMP_RUN_INTERACTIVE)
    {
      gimp_progress_init( _("Renumber frame sequence..."));
    }
 
-   /* swap lo with high for each of the (first half of the) frames */
-   for(l_curr = l_lo; l_curr < l_lo + ((l_hi - l_lo + 1) / 2); l_curr++)
+   /* swap lo with high for each of the frames
+    * (the batch renames each pair via one temporary name)
+    */
+   rbat = gap_frame_rename_batch_new(ainfo_ptr);
+   for(l_curr = l_lo; l_curr <= l_hi; l_curr++)
+   {
+     gap_frame_rename_batch_add(rbat, l_curr, l_hi - (l_curr - l_lo));
+   }
+   l_rc = gap_frame_rename_batch_execute(rbat);
+   gap_frame_rename_batch_free(rbat);
+   if(l_rc != 0)
    {
-     l_swap = l_hi - (l_curr - l_lo);
-     /* rename hi to temp */
-     if(0 != gap_lib_rename_frame(ainfo_ptr, l_swap, l_tmp_nr))
-     {
-       tmp_errtxt = g_strdup_printf(_("Error: could not rename frame %ld to %ld"), l_swap, l_tmp_nr);
-       gap_arr_msg_win(ainfo_ptr->run_mode, tmp_errtxt);
-       g_free(tmp_errtxt);
-       return -1;
-     }
-     /* rename lo to hi */
-     if(0 != gap_lib_rename_frame(ainfo_ptr, l_curr, l_swap))
-     {
-       tmp_errtxt = g_strdup_printf(_("Error: could not rename frame %ld to %ld"), ainfo_ptr->curr_frame_nr, l_swap);
-       gap_arr_msg_win(ainfo_ptr->run_mode, tmp_errtxt);
-       g_free(tmp_errtxt);
-       return -1;
-     }
-     /* rename temp to lo */
-     if(0 != gap_lib_rename_frame(ainfo_ptr, l_tmp_nr, l_curr))
-     {
-       tmp_errtxt = g_strdup_printf(_("Error: could not rename frame %ld to %ld"), l_tmp_nr, ainfo_ptr->curr_frame_nr);
-       gap_arr_msg_win(ainfo_ptr->run_mode, tmp_errtxt);
-       g_free(tmp_errtxt);
      return -1;
-     }
-     if (ainfo_ptr->run_mode == GIMP_RUN_INTERACTIVE)
-     {
-       l_percentage = (double)((l_curr - l_lo + 1) / ((l_hi - l_lo + 1) / 2.0 ));
-       if (l_percentage > 1.0) l_percentage = 1.0;
-       gimp_progress_update (l_percentage);
-     }
    }
 
    /* load from the "new" current frame */
@@ -1169,7 +1125,9 @@ gap_base_del(GimpRunMode run_mode, gint32 image_id, int nr)
   ainfo_ptr = gap_lib_alloc_ainfo(image_id, run_mode);
   if(ainfo_ptr != NULL)
   {
-    if (0 == gap_lib_dir_ainfo(ainfo_ptr))
+    /* complete an interrupted frame rename batch before reading the frames */
+    if ((gap_frame_rename_journal_recover(ainfo_ptr))
+    && (0 == gap_lib_dir_ainfo(ainfo_ptr)))
     {
       if(0 != gap_lib_chk_framerange(ainfo_ptr))   return -1;
 
@@ -1545,7 +1503,9 @@ gap_base_dup(GimpRunMode run_mode, gint32 image_id, int nr,
   ainfo_ptr = gap_lib_alloc_ainfo(image_id, run_mode);
   if(ainfo_ptr != NULL)
   {
-    if (0 == gap_lib_dir_ainfo(ainfo_ptr))
+    /* complete an interrupted frame rename batch before reading the frames */
+    if ((gap_frame_rename_journal_recover(ainfo_ptr))
+    && (0 == gap_lib_dir_ainfo(ainfo_ptr)))
     {
       if(run_mode == GIMP_RUN_INTERACTIVE)
       {
@@ -1800,7 +1760,9 @@ gap_base_shift(GimpRunMode run_mode, gint32 image_id, int nr,
   ainfo_ptr = gap_lib_alloc_ainfo(image_id, run_mode);
   if(ainfo_ptr != NULL)
   {
-    if (0 == gap_lib_dir_ainfo(ainfo_ptr))
+    /* complete an interrupted frame rename batch before reading the frames */
+    if ((gap_frame_rename_journal_recover(ainfo_ptr))
+    && (0 == gap_lib_dir_ainfo(ainfo_ptr)))
     {
       if(run_mode == GIMP_RUN_INTERACTIVE)
       {
@@ -1856,7 +1818,9 @@ gap_base_reverse(GimpRunMode run_mode, gint32 image_id,
   ainfo_ptr = gap_lib_alloc_ainfo(image_id, run_mode);
   if(ainfo_ptr != NULL)
   {
-    if (0 == gap_lib_dir_ainfo(ainfo_ptr))
+    /* complete an interrupted frame rename batch before reading the frames */
+    if ((gap_frame_rename_journal_recover(ainfo_ptr))
+    && (0 == gap_lib_dir_ainfo(ainfo_ptr)))
     {
       if(run_mode == GIMP_RUN_INTERACTIVE)
       {
@@ -2010,10 +1974,6 @@ gap_lib_rename_frame_digits(GapAnimInfo *ainfo_ptr, long from_nr, long to_nr, lo
  *     frame_14.xcf                frame_0010.xcf
  *     frame_16.xcf                frame_0011.xcf
  *
- * the 2nd example is processed in 2 loops, where the 1.st loop
- * steps down through all frames and makes continous numbers  0017, 0016, 0015, 0014.
- * the 2nd (up stepping) pass makes the final numbers.
- *
  *  example3:  digits == 4, start_frame_nr == 8
  *
  *     Old filenames               New Filenames
@@ -2023,8 +1983,9 @@ gap_lib_rename_frame_digits(GapAnimInfo *ainfo_ptr, long from_nr, long to_nr, lo
  *     frame_4.xcf                 frame_0010.xcf
  *     frame_5.xcf                 frame_0011.xcf
  *
- * the 3nd example does not need a 2nd pass, because the 1.st downstepping loop
- * can make the requested numbers.
+ * all renames are done as one batch (gap_frame_rename), the batch
+ * orders the renames so that no frame is overwritten
+ * (e.g. in the 2nd example frame_0008.xcf is renamed before frame_7.xcf)
  */
 static gint32
 p_renumber_frames(GapAnimInfo *ainfo_ptr, long start_frame_nr, long digits)
@@ -2032,86 +1993,36 @@ p_renumber_frames(GapAnimInfo *ainfo_ptr, long start_frame_nr, long digits)
   long l_from;
   long l_to;
   long l_has_digits;
-  gboolean two_pass;
+  gint32 l_rc;
+  GapFrameRenameBatch *rbat;
 
 
   if(ainfo_ptr->run_mode == GIMP_RUN_INTERACTIVE)
   {
     gimp_progress_init(_("Renumber Frames"));
   }
-  two_pass = FALSE;
-  if(start_frame_nr > ainfo_ptr->first_frame_nr)
-  {
-    long l_cnt;
-
-    l_from = ainfo_ptr->last_frame_nr;
-    l_to = ainfo_ptr->last_frame_nr + (start_frame_nr - ainfo_ptr->first_frame_nr);
 
-    l_cnt=0;
-    while (l_cnt < ainfo_ptr->frame_cnt)
-    {
-
-      if (gap_debug) printf("p_renumber_frames: DOWNSTEP l_cnt:%d l_from:%d l_to:%d\n", (int)l_cnt, (int)l_to, (int)l_from);
-      if( gap_lib_exists_frame_nr(ainfo_ptr, l_from, &l_has_digits) )
-      {
-        if((l_from != l_to)
-        || (l_has_digits != digits))
-        {
-          if (0 != gap_lib_rename_frame_digits(ainfo_ptr, l_from, l_to, l_has_digits, digits))
-          {
-            return -1;
-          }
-        }
-        l_to--;
-        l_cnt++;
-      }
-      l_from--;
-      if(ainfo_ptr->run_mode == GIMP_RUN_INTERACTIVE)
-      {
-        gimp_progress_update( (gdouble)(l_cnt)
-                            / (gdouble)(ainfo_ptr->frame_cnt) );
-      }
-    }
-    if(start_frame_nr !=  (l_to +1))
+  rbat = gap_frame_rename_batch_new(ainfo_ptr);
+  l_to = start_frame_nr;
+  for(l_from = ainfo_ptr->first_frame_nr; l_from <= ainfo_ptr->last_frame_nr; l_from++)
+  {
+    if( gap_frame_rename_batch_probe_frame_nr(rbat, l_from, &l_has_digits) )
     {
-      two_pass = TRUE;
-      if(ainfo_ptr->run_mode == GIMP_RUN_INTERACTIVE)
+      if (gap_debug) printf("p_renumber_frames: l_from:%d l_to:%d\n", (int)l_from, (int)l_to);
+      if((l_from != l_to)
+      || (l_has_digits != digits))
       {
-        gimp_progress_init(_("Renumber Frames 2nd Pass"));
+        gap_frame_rename_batch_add_digits(rbat, l_from, l_to, l_has_digits, digits);
       }
+      l_to++;
     }
   }
 
-  if((start_frame_nr <= ainfo_ptr->first_frame_nr)
-  || (two_pass))
+  l_rc = gap_frame_rename_batch_execute(rbat);
+  gap_frame_rename_batch_free(rbat);
+  if(l_rc != 0)
   {
-    l_from = ainfo_ptr->first_frame_nr;
-    l_to = start_frame_nr;
-    while (l_to < start_frame_nr + ainfo_ptr->frame_cnt)
-    {
-
-      if (gap_debug) printf("p_renumber_frames: UPSTEP l_from:%d l_to:%d\n", (int)l_to, (int)l_from);
-
-      if( gap_lib_exists_frame_nr(ainfo_ptr, l_from, &l_has_digits) )
-      {
-        if((l_from != l_to)
-        || (l_has_digits != digits))
-        {
-          if(0 != gap_lib_rename_frame_digits(ainfo_ptr, l_from, l_to, l_has_digits, digits))
-          {
-            return -1;
-          }
-        }
-        l_to++;
-      }
-      l_from++;
-
-      if(ainfo_ptr->run_mode == GIMP_RUN_INTERACTIVE)
-      {
-        gimp_progress_update( (gdouble)(l_from - ainfo_ptr->first_frame_nr)
-                            / (gdouble)(1+ (ainfo_ptr->last_frame_nr - ainfo_ptr->first_frame_nr)) );
-      }
-    }
+    return -1;
   }
 
   return 0; /* OK */
@@ -2137,7 +2048,9 @@ gap_base_renumber(GimpRunMode run_mode, gint32 image_id,
   ainfo_ptr = gap_lib_alloc_ainfo(image_id, run_mode);
   if(ainfo_ptr != NULL)
   {
-    if (0 == gap_lib_dir_ainfo(ainfo_ptr))
+    /* complete an interrupted frame rename batch before reading the frames */
+    if ((gap_frame_rename_journal_recover(ainfo_ptr))
+    && (0 == gap_lib_dir_ainfo(ainfo_ptr)))
     {
       if(run_mode == GIMP_RUN_INTERACTIVE)
       {
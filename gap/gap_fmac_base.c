@@ -35,6 +35,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <time.h>
 
 #include <glib/gstdio.h>
 
@@ -77,9 +80,48 @@ typedef struct FMacLine {
  gint32      paramlength;
 } FMacLine;
 
+/* cache element for the compiled (parsed and merged) list
+ * of one filtermacro file (or pair of files for varying apply)
+ */
+typedef struct FMacCacheElem {
+ char       *filtermacro_file1;
+ char       *filtermacro_file2;    /* NULL for constant apply */
+ time_t      mtime1;
+ off_t       size1;
+ time_t      mtime2;
+ off_t       size2;
+ gboolean    isTrusted;            /* FALSE: file(s) modified too recently to trust mtime and size */
+ FMacElem   *fmac_root;
+ gint32      last_access;
+ void       *next;
+} FMacCacheElem;
+
+#define GAP_FMAC_CACHE_MAX_ELEMS 16
+
+/* the filtermacro file(s) must be older than this (relative to the start of building
+ * the list) to trust the cached list (a file rewritten within the same second
+ * at the same size has the same signature, FAT filesystems have 2 sec timestamp resolution)
+ */
+#define GAP_FMAC_CACHE_RACY_SECS 2
+
+/* the cache lives as long as the process, this is typically the
+ * storyboard render processor that applies the same filtermacro
+ * files frame by frame.
+ * (filtermacros are applied in the main thread only, therefore no locking)
+ */
+static FMacCacheElem *global_fmac_cache_list = NULL;
+static gint32         global_fmac_cache_access_count = 0;
+
 static void      p_print_and_free_msg(char *msg, GimpRunMode run_mode);
+static void      p_free_fmac_list(FMacElem *fmac_root);
+static gboolean  p_get_file_signature(const char *filename, time_t *mtime, off_t *size);
+static void      p_fmac_cache_free_elem(FMacCacheElem *fmac_cache_elem);
+static FMacElem *p_fmac_cache_get_fmac_list(const char *filtermacro_file1
+                        , const char *filtermacro_file2
+                        , GimpRunMode run_mode);
 
-gint             p_fmac_execute(GimpRunMode run_mode, gint32 image_id, gint32 drawable_id
+static gboolean  p_merge_fmac_list(FMacElem *fmac_root, const char *filtermacro_file, GimpRunMode run_mode);
+static gint      p_fmac_execute(GimpRunMode run_mode, gint32 image_id, gint32 drawable_id
                         , const char *filtermacro_file1
                         , const char *filtermacro_file2
                         , gdouble current_step
@@ -121,6 +163,30 @@ p_free_fmac_line(FMacLine *fmac_line)
   g_free(fmac_line);
 }  /* end p_free_fmac_line */
 
+
+/* ------------------------
+ * p_free_fmac_list
+ * ------------------------
+ */
+static void
+p_free_fmac_list(FMacElem *fmac_root)
+{
+  FMacElem *fmac_elem;
+  FMacElem *fmac_next;
+
+  fmac_elem = fmac_root;
+  while(fmac_elem != NULL)
+  {
+    fmac_next = (FMacElem *)fmac_elem->next;
+    g_free(fmac_elem->filtername);
+    g_free(fmac_elem->buffer_from);
+    g_free(fmac_elem->buffer_to);
+    g_free(fmac_elem->iteratorname);
+    g_free(fmac_elem);
+    fmac_elem = fmac_next;
+  }
+}  /* end p_free_fmac_list */
+
 /* ------------------------
  * p_scan_fmac_line
  * ------------------------
@@ -356,7 +422,7 @@ p_build_fmac_list(const char *filtermacro_file, GimpRunMode run_mode)
  * in the 2nd filtermacro file AND have an iterator 
  * (that can do the plug-in specific mix of the parmetervakues)
  */
-gboolean
+static gboolean
 p_merge_fmac_list(FMacElem *fmac_root, const char *filtermacro_file, GimpRunMode run_mode)
 {
   gchar   *l_msg;
@@ -435,6 +501,209 @@ p_merge_fmac_list(FMacElem *fmac_root, const char *filtermacro_file, GimpRunMode
 }  /* end p_merge_fmac_list */
 
 
+/* ------------------------
+ * p_get_file_signature
+ * ------------------------
+ * deliver modification time and size of the specified file.
+ * returns FALSE if the file is not accessible.
+ */
+static gboolean
+p_get_file_signature(const char *filename, time_t *mtime, off_t *size)
+{
+  struct stat  l_stat;
+
+  *mtime = 0;
+  *size = 0;
+  if(filename == NULL)
+  {
+    return (TRUE);
+  }
+  if (g_stat(filename, &l_stat) != 0)
+  {
+    return (FALSE);
+  }
+  *mtime = l_stat.st_mtime;
+  *size = l_stat.st_size;
+  return (TRUE);
+}  /* end p_get_file_signature */
+
+
+/* ------------------------
+ * p_fmac_cache_free_elem
+ * ------------------------
+ */
+static void
+p_fmac_cache_free_elem(FMacCacheElem *fmac_cache_elem)
+{
+  p_free_fmac_list(fmac_cache_elem->fmac_root);
+  g_free(fmac_cache_elem->filtermacro_file1);
+  if(fmac_cache_elem->filtermacro_file2 != NULL)
+  {
+    g_free(fmac_cache_elem->filtermacro_file2);
+  }
+  g_free(fmac_cache_elem);
+}  /* end p_fmac_cache_free_elem */
+
+
+/* ---------------------------
+ * p_fmac_cache_get_fmac_list
+ * ---------------------------
+ * deliver the filtermacro processing list for filtermacro_file1
+ * (merged with the optional filtermacro_file2 for varying apply).
+ * The list is built on the first request and kept in the cache,
+ * further requests for the same file(s) deliver the cached list
+ * as long as modification time and size of the file(s) are unchanged.
+ * A list built from file(s) modified less than GAP_FMAC_CACHE_RACY_SECS
+ * before is not trusted and is built again on the next request.
+ * The cached list includes the parameter buffers (from and to)
+ * and the resolved iterator names, so that no file access and no PDB query
+ * is required for repeated apply of the same filtermacro.
+ *
+ * returns NULL if the list could not be built.
+ * Note that the caller must not free the returned list
+ * (it is owned by the cache).
+ */
+static FMacElem *
+p_fmac_cache_get_fmac_list(const char *filtermacro_file1
+   , const char *filtermacro_file2
+   , GimpRunMode run_mode)
+{
+  FMacCacheElem *fmac_cache_elem;
+  FMacCacheElem *fmac_cache_prev;
+  FMacCacheElem *fmac_cache_lru;
+  FMacElem      *fmac_root;
+  time_t         l_mtime1;
+  off_t          l_size1;
+  time_t         l_mtime2;
+  off_t          l_size2;
+  time_t         l_buildStart;
+  gint32         l_count;
+
+  if(filtermacro_file1 == NULL)
+  {
+    return (NULL);
+  }
+
+  global_fmac_cache_access_count++;
+  l_buildStart = time(NULL);
+  p_get_file_signature(filtermacro_file1, &l_mtime1, &l_size1);
+  p_get_file_signature(filtermacro_file2, &l_mtime2, &l_size2);
+
+  fmac_cache_prev = NULL;
+  for(fmac_cache_elem = global_fmac_cache_list; fmac_cache_elem != NULL; fmac_cache_elem = (FMacCacheElem *)fmac_cache_elem->next)
+  {
+    if((strcmp(fmac_cache_elem->filtermacro_file1, filtermacro_file1) == 0)
+    && (((fmac_cache_elem->filtermacro_file2 == NULL) && (filtermacro_file2 == NULL))
+       || ((fmac_cache_elem->filtermacro_file2 != NULL)
+          && (filtermacro_file2 != NULL)
+          && (strcmp(fmac_cache_elem->filtermacro_file2, filtermacro_file2) == 0))))
+    {
+      if((fmac_cache_elem->mtime1 == l_mtime1)
+      && (fmac_cache_elem->size1 == l_size1)
+      && (fmac_cache_elem->mtime2 == l_mtime2)
+      && (fmac_cache_elem->size2 == l_size2)
+      && (fmac_cache_elem->isTrusted == TRUE))
+      {
+        if(gap_debug)
+        {
+          printf("p_fmac_cache_get_fmac_list: HIT filtermacro_file:%s\n"
+                 , filtermacro_file1
+                 );
+        }
+        fmac_cache_elem->last_access = global_fmac_cache_access_count;
+        return (fmac_cache_elem->fmac_root);
+      }
+
+      /* the file(s) have changed since the list was built
+       * (or were too recently modified to be sure), drop the outdated element
+       */
+      if(gap_debug)
+      {
+        printf("p_fmac_cache_get_fmac_list: OUTDATED filtermacro_file:%s isTrusted:%d\n"
+               , filtermacro_file1
+               , (int)fmac_cache_elem->isTrusted
+               );
+      }
+      if(fmac_cache_prev == NULL)
+      {
+        global_fmac_cache_list = (FMacCacheElem *)fmac_cache_elem->next;
+      }
+      else
+      {
+        fmac_cache_prev->next = fmac_cache_elem->next;
+      }
+      p_fmac_cache_free_elem(fmac_cache_elem);
+      break;
+    }
+    fmac_cache_prev = fmac_cache_elem;
+  }
+
+  fmac_root = p_build_fmac_list(filtermacro_file1, run_mode);
+  if(fmac_root == NULL)
+  {
+    return (NULL);
+  }
+  if(filtermacro_file2 != NULL)
+  {
+    p_merge_fmac_list(fmac_root, filtermacro_file2, run_mode);
+  }
+
+  /* drop the least recently used element when the cache is full */
+  l_count = 0;
+  fmac_cache_lru = NULL;
+  for(fmac_cache_elem = global_fmac_cache_list; fmac_cache_elem != NULL; fmac_cache_elem = (FMacCacheElem *)fmac_cache_elem->next)
+  {
+    l_count++;
+    if((fmac_cache_lru == NULL)
+    || (fmac_cache_elem->last_access < fmac_cache_lru->last_access))
+    {
+      fmac_cache_lru = fmac_cache_elem;
+    }
+  }
+  if((l_count >= GAP_FMAC_CACHE_MAX_ELEMS) && (fmac_cache_lru != NULL))
+  {
+    fmac_cache_prev = NULL;
+    for(fmac_cache_elem = global_fmac_cache_list; fmac_cache_elem != fmac_cache_lru; fmac_cache_elem = (FMacCacheElem *)fmac_cache_elem->next)
+    {
+      fmac_cache_prev = fmac_cache_elem;
+    }
+    if(fmac_cache_prev == NULL)
+    {
+      global_fmac_cache_list = (FMacCacheElem *)fmac_cache_lru->next;
+    }
+    else
+    {
+      fmac_cache_prev->next = fmac_cache_lru->next;
+    }
+    p_fmac_cache_free_elem(fmac_cache_lru);
+  }
+
+  fmac_cache_elem = g_malloc0(sizeof(FMacCacheElem));
+  fmac_cache_elem->filtermacro_file1 = g_strdup(filtermacro_file1);
+  fmac_cache_elem->filtermacro_file2 = NULL;
+  if(filtermacro_file2 != NULL)
+  {
+    fmac_cache_elem->filtermacro_file2 = g_strdup(filtermacro_file2);
+  }
+  fmac_cache_elem->mtime1 = l_mtime1;
+  fmac_cache_elem->size1 = l_size1;
+  fmac_cache_elem->mtime2 = l_mtime2;
+  fmac_cache_elem->size2 = l_size2;
+  fmac_cache_elem->isTrusted = TRUE;
+  if((l_mtime1 + GAP_FMAC_CACHE_RACY_SECS > l_buildStart)
+  || ((filtermacro_file2 != NULL) && (l_mtime2 + GAP_FMAC_CACHE_RACY_SECS > l_buildStart)))
+  {
+    fmac_cache_elem->isTrusted = FALSE;
+  }
+  fmac_cache_elem->fmac_root = fmac_root;
+  fmac_cache_elem->last_access = global_fmac_cache_access_count;
+  fmac_cache_elem->next = global_fmac_cache_list;
+  global_fmac_cache_list = fmac_cache_elem;
+
+  return (fmac_root);
+}  /* end p_fmac_cache_get_fmac_list */
+
+
 /* ----------------------------
  * p_fmac_execute_single_filter
  * ----------------------------
@@ -746,8 +1015,10 @@ p_find_layer_for_next_processing(gint32 image_id, gint32 ref_layer_id
  *   file2:line 2.) correlates with file1:line 2.)
  *   file2:line 3.) correlates with file1:line 4.)
  *   
+ * the processing list is taken from the filtermacro cache
+ * (parsing of the file(s) is done only once per process as long as the files are unchanged)
  */
-gint
+static gint
 p_fmac_execute(GimpRunMode run_mode, gint32 image_id, gint32 drawable_id
    , const char *filtermacro_file1
    , const char *filtermacro_file2
@@ -757,7 +1028,7 @@ p_fmac_execute(GimpRunMode run_mode, gint32 image_id, gint32 drawable_id
 {
   FMacElem *fmac_root;
   
-  fmac_root = p_build_fmac_list(filtermacro_file1, run_mode);
+  fmac_root = p_fmac_cache_get_fmac_list(filtermacro_file1, filtermacro_file2, run_mode);
   if (fmac_root)
   {
     FMacElem *fmac_elem;
@@ -773,12 +1044,6 @@ p_fmac_execute(GimpRunMode run_mode, gint32 image_id, gint32 drawable_id
                                  , filtermacro_file1
                                  );
 
-
-
-    if(filtermacro_file2 != NULL)
-    {
-      p_merge_fmac_list(fmac_root, filtermacro_file2, run_mode);
-    }
     for(fmac_elem = fmac_root; fmac_elem != NULL; fmac_elem = (FMacElem *)fmac_elem->next)
     {
       gint          l_nlayers;
@@ -823,8 +1088,8 @@ p_fmac_execute(GimpRunMode run_mode, gint32 image_id, gint32 drawable_id
 
     /* disable the sessionwide filtermacro context */
     gap_fmct_disable_GapFmacContext();
-    
-    //TODO p_free_fmac_list(fmac_root);  /* free the filtermacro processing list */
+
+    /* Note: fmac_root is owned by the filtermacro cache (must not be freed here) */
   }
   
   return(0);
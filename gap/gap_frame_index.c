@@ -0,0 +1,1144 @@
+/*  gap_frame_index.c
+ *
+ *  This module provides a cached index of the frame numbers
+ *  of frame sequences on disk (one index per basename and extension)
+ *
+ *  The index is built while gap_lib_dir_ainfo scans the directory,
+ *  and is reused by subsequent gap_lib_dir_ainfo, gap_lib_exists_frame_nr
+ *  and gap_lib_alloc_fname6 calls as long as the directory is unchanged.
+ *  This saves the directory rescans and the stat probes for all
+ *  possible digit styles of the frame number part on each
+ *  navigation step and frame range operation.
+ *
+ *  The directory is considered unchanged when its stat signature
+ *  (mtime and ctime including nanoseconds where available, size,
+ *  number of links and inode) is the same as at scan time.
+ *
+ *  Trusted indexes are also stored on disk (one small file per basename
+ *  and extension in the frame index cache directory, see libgapbase/gap_file_cache.c)
+ *  with the stat signature of the directory as part of the key.
+ *  This way the index is shared between plug-in processes,
+ *  e.g. the navigator runs each step (plug_in_gap_next, plug_in_gap_prev ...)
+ *  as a separate process that loads the index instead of scanning the directory.
+ *  The size of the frame index cache is limited by the gimprc parameter
+ *    (gap-frame-index-cache-size "4")   size in MB, 0 turns off the disk storage
+ *
+ *  An index is not trusted (and not used for the probes) when
+ *  - the directory was modified within the timestamp resolution
+ *    of the directory scan (changes in the same second may not
+ *    change the directory modification time)
+ *  - a matching file was empty at scan time
+ *    (gap_lib_file_exists treats empty files as not existing,
+ *    writing into the file would not change the directory modification time)
+ *  In those cases the callers fall back to the direct stat probes.
+ *
+ *  Snapshots are private copies of an index that reflect the directory
+ *  at the time they were taken (also when recently modified).
+ *  They are used to plan a batch of operations before modifying the directory.
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * version 2.7.0;   2026/10/18  created
+ *                               added snapshots (for planning batched frame renames)
+ *                               store trusted indexes on disk, validate by the full stat signature
+ */
+
+#include "config.h"
+
+/* SYSTEM (UNIX) includes */
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib/gstdio.h>
+
+/* GIMP includes */
+#include "libgimp/gimp.h"
+
+/* GAP includes */
+#include "gap_file_cache.h"
+#include "gap_frame_index.h"
+
+extern      int gap_debug; /* ==0  ... dont print debug infos */
+
+/* max number of digits in the number part (longer numbers overflow long) */
+#define GAP_FRAME_INDEX_MAX_DIGITS        18
+
+/* max number of cached indexes (all are dropped when the limit is reached) */
+#define GAP_FRAME_INDEX_MAX_CACHED        16
+
+/* the directory must be older than this (relative to the scan start)
+ * to trust the index (covers the 2 sec timestamp resolution of FAT filesystems)
+ */
+#define GAP_FRAME_INDEX_RACY_SECS         2
+
+/* disk storage of the index */
+#define GAP_FRAME_INDEX_GIMPRC_CACHE_SIZE "gap-frame-index-cache-size"
+#define GAP_FRAME_INDEX_GIMPRC_CACHE_DIR  "gap-frame-index-cache-dir"
+#define GAP_FRAME_INDEX_DEFAULT_CACHE_MB  4
+#define GAP_FRAME_INDEX_CACHE_MAGIC       "GAPFIX01"
+#define GAP_FRAME_INDEX_CACHE_SUFFIX      ".gapfix"
+#define GAP_FRAME_INDEX_CACHE_HDR_COUNT   1   /* size of GapFrameIndexEntry */
+
+
+/* all frames with the same frame number
+ * (e.g. frame_000001.xcf and frame_1.xcf)
+ */
+typedef struct GapFrameIndexEntry {
+  long      nr;
+  guint32   widthMask;   /* bit n is set if a file with n digits in the number part exists */
+} GapFrameIndexEntry;
+
+struct GapFrameIndex {   /* nickname: fidx */
+  gchar    *dirname;
+  gchar    *dirSignature;  /* stat signature of the directory at scan time */
+  gboolean  isTrusted;
+  long      fileCount;
+  GArray   *entries;     /* of GapFrameIndexEntry, sorted by ascending nr */
+};
+
+
+static GStaticMutex  frameIndexMutex = G_STATIC_MUTEX_INIT;
+static GHashTable   *frameIndexTable = NULL;
+static GapFileCache  frameIndexFcd = GAP_FILE_CACHE_INITIALIZER("GAP frame index"
+                                                               , GAP_FRAME_INDEX_CACHE_SUFFIX
+                                                               , GAP_FRAME_INDEX_CACHE_MAGIC
+                                                               );
+
+/* the digit styles in the order that is probed by gap_lib_exists_frame_nr
+ * and gap_lib_alloc_fname6 (1 is the style without leading zeroes)
+ */
+static const gint    probeOrderDigits[] = { 6, 8, 7, 4, 5, 3, 2, 1 };
+
+
+/* ----------------------------------
+ * p_index_free
+ * ----------------------------------
+ */
+static void
+p_index_free(gpointer data)
+{
+  GapFrameIndex *fidx;
+
+  fidx = (GapFrameIndex *)data;
+  if(fidx == NULL)
+  {
+    return;
+  }
+  g_free(fidx->dirname);
+  g_free(fidx->dirSignature);
+  g_array_free(fidx->entries, TRUE);
+  g_free(fidx);
+}  /* end p_index_free */
+
+
+/* ----------------------------------
+ * p_index_copy
+ * ----------------------------------
+ */
+static GapFrameIndex *
+p_index_copy(GapFrameIndex *fidx)
+{
+  GapFrameIndex *fidxCopy;
+
+  fidxCopy = g_new0(GapFrameIndex, 1);
+  fidxCopy->dirname = g_strdup(fidx->dirname);
+  fidxCopy->dirSignature = g_strdup(fidx->dirSignature);
+  fidxCopy->isTrusted = fidx->isTrusted;
+  fidxCopy->fileCount = fidx->fileCount;
+  fidxCopy->entries = g_array_sized_new(FALSE, FALSE, sizeof(GapFrameIndexEntry), fidx->entries->len);
+  g_array_append_vals(fidxCopy->entries, fidx->entries->data, fidx->entries->len);
+  return (fidxCopy);
+}  /* end p_index_copy */
+
+
+/* ----------------------------------
+ * p_is_supported_extension
+ * ----------------------------------
+ * the index handles only extensions that start with "."
+ * and contain no further "." (the directory scan of gap_lib_dir_ainfo
+ * compares the part after the last "." of the filenames)
+ */
+static gboolean
+p_is_supported_extension(const char *extension)
+{
+  if(extension == NULL)
+  {
+    return (FALSE);
+  }
+  if(extension[0] != '.')
+  {
+    return (FALSE);
+  }
+  if(strchr(&extension[1], '.') != NULL)
+  {
+    return (FALSE);
+  }
+  return (TRUE);
+}  /* end p_is_supported_extension */
+
+
+/* ----------------------------------
+ * p_alloc_key
+ * ----------------------------------
+ * relative basenames are qualified with the current directory
+ */
+static gchar *
+p_alloc_key(const char *basename, const char *extension)
+{
+  gchar *key;
+
+  if(g_path_is_absolute(basename))
+  {
+    key = g_strdup_printf("%s\n%s", basename, extension);
+  }
+  else
+  {
+    gchar *currentDir;
+
+    currentDir = g_get_current_dir();
+    key = g_strdup_printf("%s\n%s\n%s", currentDir, basename, extension);
+    g_free(currentDir);
+  }
+  return (key);
+}  /* end p_alloc_key */
+
+
+/* ----------------------------------
+ * p_split_basename
+ * ----------------------------------
+ * split the basename (that may include a directory path)
+ * into the directory and the filename prefix of the frames.
+ * returns the newly allocated directory name
+ * and sets prefixPtr to the prefix part of basename.
+ */
+static gchar *
+p_split_basename(const char *basename, const char **prefixPtr)
+{
+  const char *l_ptr;
+
+  l_ptr = &basename[strlen(basename)];
+  while(l_ptr != basename)
+  {
+    l_ptr--;
+    if ((*l_ptr == G_DIR_SEPARATOR) || (*l_ptr == DIR_ROOT))
+    {
+      *prefixPtr = l_ptr + 1;
+      if (l_ptr == basename)
+      {
+        return (g_strdup(G_DIR_SEPARATOR_S));
+      }
+      if (*l_ptr != G_DIR_SEPARATOR)
+      {
+        /* keep the drive part (e.g. "C:") */
+        return (g_strndup(basename, (l_ptr - basename) + 1));
+      }
+      return (g_strndup(basename, l_ptr - basename));
+    }
+  }
+
+  *prefixPtr = basename;
+  return (g_strdup("."));
+}  /* end p_split_basename */
+
+
+/* ----------------------------------
+ * p_alloc_dir_signature
+ * ----------------------------------
+ * returns the stat signature of the directory.
+ * Any change of the directory entries (create, remove, rename)
+ * changes mtime and ctime, most filesystems also change size or number of links.
+ * The nanosecond parts of mtime and ctime are included where available,
+ * so that changes within the same second are detected
+ * (also when the mtime was set back, e.g. by NFS servers with clock skew).
+ */
+static gchar *
+p_alloc_dir_signature(const struct stat *stat_buf)
+{
+  long mtimeNsec;
+  long ctimeNsec;
+
+#if defined(_STATBUF_ST_NSEC)
+  mtimeNsec = stat_buf->st_mtim.tv_nsec;
+  ctimeNsec = stat_buf->st_ctim.tv_nsec;
+#else
+  mtimeNsec = 0;
+  ctimeNsec = 0;
+#endif
+  return (g_strdup_printf("%ld.%09ld:%ld.%09ld:%ld:%ld:%ld"
+                         , (long)stat_buf->st_mtime
+                         , mtimeNsec
+                         , (long)stat_buf->st_ctime
+                         , ctimeNsec
+                         , (long)stat_buf->st_size
+                         , (long)stat_buf->st_nlink
+                         , (long)stat_buf->st_ino
+                         ));
+}  /* end p_alloc_dir_signature */
+
+
+/* ----------------------------------
+ * p_compare_entries
+ * ----------------------------------
+ */
+static gint
+p_compare_entries(gconstpointer a, gconstpointer b)
+{
+  const GapFrameIndexEntry *ea;
+  const GapFrameIndexEntry *eb;
+
+  ea = (const GapFrameIndexEntry *)a;
+  eb = (const GapFrameIndexEntry *)b;
+  if(ea->nr < eb->nr)
+  {
+    return (-1);
+  }
+  if(ea->nr > eb->nr)
+  {
+    return (1);
+  }
+  return (0);
+}  /* end p_compare_entries */
+
+
+/* ----------------------------------
+ * p_index_scan
+ * ----------------------------------
+ * read the directory and create a new index for all regular non-empty files
+ * with name  <prefix><digits><extension>
+ * returns NULL if the directory is not readable
+ * or contains names that can not be handled by the index.
+ */
+static GapFrameIndex *
+p_index_scan(const char *basename, const char *extension)
+{
+  GapFrameIndex      *fidx;
+  GArray             *files;
+  GDir               *l_dirp;
+  const gchar        *l_entry;
+  const char         *prefix;
+  struct stat         l_stat_buf;
+  time_t              scanStart;
+  gint                prefixLen;
+  gint                extLen;
+  gboolean            isOverlong;
+  guint               ii;
+
+  fidx = g_new0(GapFrameIndex, 1);
+  fidx->dirname = p_split_basename(basename, &prefix);
+  fidx->entries = g_array_new(FALSE, FALSE, sizeof(GapFrameIndexEntry));
+  fidx->isTrusted = TRUE;
+
+  /* get the directory modification time before reading the entries
+   * (changes during the scan make the index stale)
+   */
+  scanStart = time(NULL);
+  if (0 != g_stat(fidx->dirname, &l_stat_buf))
+  {
+    p_index_free(fidx);
+    return (NULL);
+  }
+  fidx->dirSignature = p_alloc_dir_signature(&l_stat_buf);
+  if(l_stat_buf.st_mtime + GAP_FRAME_INDEX_RACY_SECS > scanStart)
+  {
+    fidx->isTrusted = FALSE;
+  }
+
+  l_dirp = g_dir_open(fidx->dirname, 0, NULL);
+  if(l_dirp == NULL)
+  {
+    p_index_free(fidx);
+    return (NULL);
+  }
+
+  prefixLen = strlen(prefix);
+  extLen = strlen(extension);
+  isOverlong = FALSE;
+  files = g_array_new(FALSE, FALSE, sizeof(GapFrameIndexEntry));
+
+  while ( (l_entry = g_dir_read_name(l_dirp)) != NULL )
+  {
+    GapFrameIndexEntry  file;
+    gchar              *fullname;
+    gint                len;
+    gint                digits;
+    gint                jj;
+
+    len = strlen(l_entry);
+    digits = len - (prefixLen + extLen);
+    if(digits < 1)
+    {
+      continue;
+    }
+    if((0 != strncmp(l_entry, prefix, prefixLen))
+    || (0 != strcmp(&l_entry[len - extLen], extension)))
+    {
+      continue;
+    }
+
+    file.nr = 0;
+    for(jj = prefixLen; jj < prefixLen + digits; jj++)
+    {
+      if((l_entry[jj] < '0') || (l_entry[jj] > '9'))
+      {
+        break;
+      }
+      file.nr = (file.nr * 10) + (l_entry[jj] - '0');
+    }
+    if(jj < prefixLen + digits)
+    {
+      continue;  /* number part has non-digit characters */
+    }
+    if(digits > GAP_FRAME_INDEX_MAX_DIGITS)
+    {
+      isOverlong = TRUE;
+      break;
+    }
+
+    /* check for regular non-empty file (same rules as gap_lib_file_exists) */
+    fullname = g_build_filename(fidx->dirname, l_entry, NULL);
+    if (0 != g_stat(fullname, &l_stat_buf))
+    {
+      g_free(fullname);
+      continue;
+    }
+    g_free(fullname);
+    if(!S_ISREG(l_stat_buf.st_mode))
+    {
+      continue;
+    }
+    if(l_stat_buf.st_size < 1)
+    {
+      fidx->isTrusted = FALSE;
+      continue;
+    }
+
+    file.widthMask = (1 << digits);
+    g_array_append_val(files, file);
+  }
+  g_dir_close(l_dirp);
+
+  if(isOverlong)
+  {
+    if(gap_debug)
+    {
+      printf("p_index_scan: number part longer than %d digits in %s, no index\n"
+            , (int)GAP_FRAME_INDEX_MAX_DIGITS
+            , fidx->dirname
+            );
+    }
+    g_array_free(files, TRUE);
+    p_index_free(fidx);
+    return (NULL);
+  }
+
+  /* sort and merge all files with the same frame number into one entry */
+  g_array_sort(files, p_compare_entries);
+  fidx->fileCount = files->len;
+  for(ii=0; ii < files->len; ii++)
+  {
+    GapFrameIndexEntry *file;
+
+    file = &g_array_index(files, GapFrameIndexEntry, ii);
+    if(fidx->entries->len > 0)
+    {
+      GapFrameIndexEntry *last;
+
+      last = &g_array_index(fidx->entries, GapFrameIndexEntry, fidx->entries->len -1);
+      if(last->nr == file->nr)
+      {
+        last->widthMask |= file->widthMask;
+        continue;
+      }
+    }
+    g_array_append_val(fidx->entries, *file);
+  }
+  g_array_free(files, TRUE);
+
+  if(gap_debug)
+  {
+    printf("p_index_scan: dir:%s prefix:%s ext:%s files:%ld numbers:%d trusted:%d\n"
+          , fidx->dirname
+          , prefix
+          , extension
+          , fidx->fileCount
+          , (int)fidx->entries->len
+          , (int)fidx->isTrusted
+          );
+  }
+
+  return (fidx);
+}  /* end p_index_scan */
+
+
+/* ----------------------------------
+ * p_index_is_fresh
+ * ----------------------------------
+ * check if the directory was not modified since the index was built.
+ */
+static gboolean
+p_index_is_fresh(GapFrameIndex *fidx)
+{
+  struct stat  l_stat_buf;
+  gchar       *dirSignature;
+  gboolean     isFresh;
+
+  if (0 != g_stat(fidx->dirname, &l_stat_buf))
+  {
+    return (FALSE);
+  }
+  dirSignature = p_alloc_dir_signature(&l_stat_buf);
+  isFresh = (strcmp(dirSignature, fidx->dirSignature) == 0);
+  g_free(dirSignature);
+
+  return (isFresh);
+}  /* end p_index_is_fresh */
+
+
+/* ----------------------------------
+ * p_index_lookup_fresh
+ * ----------------------------------
+ * returns the cached index for basename and extension
+ * if it is trusted and still up to date, NULL otherwise.
+ * (the caller must hold the frameIndexMutex)
+ */
+static GapFrameIndex *
+p_index_lookup_fresh(const char *key)
+{
+  GapFrameIndex *fidx;
+
+  if(frameIndexTable == NULL)
+  {
+    return (NULL);
+  }
+  fidx = g_hash_table_lookup(frameIndexTable, key);
+  if(fidx == NULL)
+  {
+    return (NULL);
+  }
+  if((fidx->isTrusted != TRUE) || (p_index_is_fresh(fidx) != TRUE))
+  {
+    g_hash_table_remove(frameIndexTable, key);
+    return (NULL);
+  }
+  return (fidx);
+}  /* end p_index_lookup_fresh */
+
+
+/* ----------------------------------
+ * p_index_store
+ * ----------------------------------
+ * (the caller must hold the frameIndexMutex)
+ */
+static void
+p_index_store(gchar *key, GapFrameIndex *fidx)
+{
+  if(frameIndexTable == NULL)
+  {
+    frameIndexTable = g_hash_table_new_full(g_str_hash, g_str_equal
+                          , g_free, p_index_free);
+  }
+  if(g_hash_table_size(frameIndexTable) >= GAP_FRAME_INDEX_MAX_CACHED)
+  {
+    g_hash_table_remove_all(frameIndexTable);
+  }
+  g_hash_table_replace(frameIndexTable, key, fidx);
+}  /* end p_index_store */
+
+
+/* ----------------------------------
+ * p_index_cache_is_enabled
+ * ----------------------------------
+ * check if the disk storage of indexes is enabled
+ * (reads the gimprc configuration at the first call)
+ */
+static gboolean
+p_index_cache_is_enabled(void)
+{
+  gap_file_cache_init_config(&frameIndexFcd
+                            , GAP_FRAME_INDEX_GIMPRC_CACHE_SIZE
+                            , GAP_FRAME_INDEX_GIMPRC_CACHE_DIR
+                            , "gapframeindex"
+                            , GAP_FRAME_INDEX_DEFAULT_CACHE_MB
+                            );
+  return (gap_file_cache_is_enabled(&frameIndexFcd));
+}  /* end p_index_cache_is_enabled */
+
+
+/* ----------------------------------
+ * p_index_cache_build_filename
+ * ----------------------------------
+ * returns the name of the disk file for the index with the specified key
+ * and sets *persistentKey to the key that is stored in the file.
+ * The file is named by the key (one file per basename and extension),
+ * the stored key includes the stat signature of the directory
+ * (an index for another state of the directory never matches).
+ */
+static gchar *
+p_index_cache_build_filename(const char *key, const char *dirSignature, gchar **persistentKey)
+{
+  gchar  name[16];
+
+  *persistentKey = g_strdup_printf("%s\n%s", key, dirSignature);
+  g_snprintf(name, sizeof(name), "%08x", (guint)g_str_hash(key));
+
+  return (gap_file_cache_build_filename(&frameIndexFcd, name));
+}  /* end p_index_cache_build_filename */
+
+
+/* ----------------------------------
+ * p_index_save
+ * ----------------------------------
+ * store a trusted index on disk.
+ * data layout: gint64 fileCount, followed by the entries.
+ * (the caller must hold the frameIndexMutex)
+ */
+static void
+p_index_save(const char *key, GapFrameIndex *fidx)
+{
+  gchar   *filename;
+  gchar   *persistentKey;
+  guchar  *data;
+  gsize    dataSize;
+  gint64   fileCount;
+  gint32   hdr[GAP_FRAME_INDEX_CACHE_HDR_COUNT];
+
+  if((fidx->isTrusted != TRUE) || (p_index_cache_is_enabled() != TRUE))
+  {
+    return;
+  }
+
+  filename = p_index_cache_build_filename(key, fidx->dirSignature, &persistentKey);
+  dataSize = sizeof(gint64) + (fidx->entries->len * sizeof(GapFrameIndexEntry));
+  data = g_malloc(dataSize);
+  fileCount = fidx->fileCount;
+  memcpy(data, &fileCount, sizeof(gint64));
+  memcpy(data + sizeof(gint64), fidx->entries->data, fidx->entries->len * sizeof(GapFrameIndexEntry));
+  hdr[0] = sizeof(GapFrameIndexEntry);
+
+  if(gap_file_cache_write_file(&frameIndexFcd
+                         , filename
+                         , hdr, GAP_FRAME_INDEX_CACHE_HDR_COUNT
+                         , persistentKey
+                         , data, dataSize
+                         ))
+  {
+    gap_file_cache_add_stored_bytes(&frameIndexFcd
+                         , gap_file_cache_get_file_size(GAP_FRAME_INDEX_CACHE_HDR_COUNT, persistentKey, dataSize)
+                         );
+  }
+
+  if(gap_debug)
+  {
+    printf("p_index_save: dir:%s numbers:%d file:%s\n"
+          , fidx->dirname
+          , (int)fidx->entries->len
+          , filename
+          );
+  }
+
+  g_free(data);
+  g_free(persistentKey);
+  g_free(filename);
+}  /* end p_index_save */
+
+
+/* ----------------------------------
+ * p_index_load
+ * ----------------------------------
+ * load the index for basename and extension from disk.
+ * returns NULL if there is no stored index for the current stat signature
+ * of the directory, or the directory was modified within
+ * GAP_FRAME_INDEX_RACY_SECS (in doubt the directory is scanned again).
+ * (the caller must hold the frameIndexMutex)
+ */
+static GapFrameIndex *
+p_index_load(const char *key, const char *basename)
+{
+  GapFrameIndex      *fidx;
+  gchar              *dirname;
+  gchar              *dirSignature;
+  gchar              *filename;
+  gchar              *persistentKey;
+  gchar              *contents;
+  gsize               length;
+  gsize               hdrSize;
+  gsize               dataSize;
+  const guchar       *data;
+  const char         *prefix;
+  struct stat         l_stat_buf;
+  gint32              hdr[GAP_FRAME_INDEX_CACHE_HDR_COUNT];
+  gint64              fileCount;
+  guint               entryCount;
+
+  if(p_index_cache_is_enabled() != TRUE)
+  {
+    return (NULL);
+  }
+
+  dirname = p_split_basename(basename, &prefix);
+  if ((0 != g_stat(dirname, &l_stat_buf))
+  || (l_stat_buf.st_mtime + GAP_FRAME_INDEX_RACY_SECS > time(NULL)))
+  {
+    g_free(dirname);
+    return (NULL);
+  }
+
+  dirSignature = p_alloc_dir_signature(&l_stat_buf);
+  filename = p_index_cache_build_filename(key, dirSignature, &persistentKey);
+  fidx = NULL;
+  contents = NULL;
+  if(g_file_get_contents(filename, &contents, &length, NULL))
+  {
+    hdrSize = gap_file_cache_get_file_size(GAP_FRAME_INDEX_CACHE_HDR_COUNT, persistentKey, 0);
+    dataSize = (length > hdrSize) ? length - hdrSize : 0;
+    hdr[0] = sizeof(GapFrameIndexEntry);
+    data = NULL;
+    if((dataSize >= sizeof(gint64))
+    && (((dataSize - sizeof(gint64)) % sizeof(GapFrameIndexEntry)) == 0))
+    {
+      data = gap_file_cache_check_contents(&frameIndexFcd
+                         , contents, length
+                         , hdr, GAP_FRAME_INDEX_CACHE_HDR_COUNT
+                         , persistentKey
+                         , dataSize
+                         );
+    }
+    if(data != NULL)
+    {
+      memcpy(&fileCount, data, sizeof(gint64));
+      entryCount = (dataSize - sizeof(gint64)) / sizeof(GapFrameIndexEntry);
+
+      fidx = g_new0(GapFrameIndex, 1);
+      fidx->dirname = dirname;
+      fidx->dirSignature = dirSignature;
+      fidx->isTrusted = TRUE;
+      fidx->fileCount = fileCount;
+      fidx->entries = g_array_sized_new(FALSE, FALSE, sizeof(GapFrameIndexEntry), entryCount);
+      g_array_append_vals(fidx->entries, data + sizeof(gint64), entryCount);
+      dirname = NULL;
+      dirSignature = NULL;
+    }
+  }
+
+  if(gap_debug)
+  {
+    printf("p_index_load: file:%s loaded:%d\n"
+          , filename
+          , (int)(fidx != NULL)
+          );
+  }
+
+  g_free(contents);
+  g_free(persistentKey);
+  g_free(filename);
+  g_free(dirSignature);
+  g_free(dirname);
+
+  return (fidx);
+}  /* end p_index_load */
+
+
+/* ----------------------------------
+ * p_index_lookup_or_load
+ * ----------------------------------
+ * returns the up to date index for basename and extension
+ * from the process local table or from disk, NULL if there is none.
+ * (the caller must hold the frameIndexMutex)
+ */
+static GapFrameIndex *
+p_index_lookup_or_load(const char *key, const char *basename)
+{
+  GapFrameIndex *fidx;
+
+  fidx = p_index_lookup_fresh(key);
+  if(fidx == NULL)
+  {
+    fidx = p_index_load(key, basename);
+    if(fidx != NULL)
+    {
+      p_index_store(g_strdup(key), fidx);
+    }
+  }
+  return (fidx);
+}  /* end p_index_lookup_or_load */
+
+
+/* ----------------------------------
+ * p_index_find_entry
+ * ----------------------------------
+ * binary search for the smallest entry with number >= nr.
+ * returns the position (entries->len if there is none)
+ */
+static guint
+p_index_find_entry(GapFrameIndex *fidx, long nr)
+{
+  guint lo;
+  guint hi;
+
+  lo = 0;
+  hi = fidx->entries->len;
+  while(lo < hi)
+  {
+    guint mid;
+
+    mid = lo + ((hi - lo) / 2);
+    if(g_array_index(fidx->entries, GapFrameIndexEntry, mid).nr < nr)
+    {
+      lo = mid + 1;
+    }
+    else
+    {
+      hi = mid;
+    }
+  }
+  return (lo);
+}  /* end p_index_find_entry */
+
+
+/* ----------------------------------
+ * p_index_probe_digits
+ * ----------------------------------
+ * returns the digits style that the stat probes in gap_lib_exists_frame_nr
+ * would find first for frame number nr, or 0 if there is no such frame.
+ * (formatting nr with d digits gives a number part of MAX(d, natural length of nr))
+ */
+static gint
+p_index_probe_digits(GapFrameIndex *fidx, long nr)
+{
+  GapFrameIndexEntry *entry;
+  guint               pos;
+  gint                naturalDigits;
+  gint                ii;
+  gchar               buf[32];
+
+  pos = p_index_find_entry(fidx, nr);
+  if(pos >= fidx->entries->len)
+  {
+    return (0);
+  }
+  entry = &g_array_index(fidx->entries, GapFrameIndexEntry, pos);
+  if(entry->nr != nr)
+  {
+    return (0);
+  }
+
+  naturalDigits = g_snprintf(buf, sizeof(buf), "%ld", nr);
+  for(ii=0; ii < G_N_ELEMENTS(probeOrderDigits); ii++)
+  {
+    gint width;
+
+    width = MAX(probeOrderDigits[ii], naturalDigits);
+    if((width <= GAP_FRAME_INDEX_MAX_DIGITS)
+    && ((entry->widthMask & (1 << width)) != 0))
+    {
+      return (probeOrderDigits[ii]);
+    }
+  }
+  return (0);
+}  /* end p_index_probe_digits */
+
+
+/* ----------------------------------
+ * p_index_probe_frame_nr
+ * ----------------------------------
+ * check the frames nr, nr-1, 1 and 0 in the same order as the stat probes
+ * in gap_lib_exists_frame_nr and gap_lib_alloc_fname6.
+ */
+static void
+p_index_probe_frame_nr(GapFrameIndex *fidx, long nr, long *digits_used, gboolean *exists)
+{
+  long l_nr_chk;
+
+  l_nr_chk = nr;
+  while(l_nr_chk >= 0)
+  {
+    gint digits;
+
+    digits = p_index_probe_digits(fidx, l_nr_chk);
+    if(digits > 0)
+    {
+      *digits_used = digits;
+      if(l_nr_chk == nr)
+      {
+        *exists = TRUE;
+      }
+      break;
+    }
+    l_nr_chk--;
+
+    /* same shortcut as the stat probes: check nr, nr-1, 1 and 0 */
+    if((l_nr_chk == nr -2) && (l_nr_chk > 1))
+    {
+      l_nr_chk = 1;
+    }
+  }
+}  /* end p_index_probe_frame_nr */
+
+
+/* ============================================================================
+ * gap_frame_index_dir_ainfo
+ *
+ * fill in frame_cnt, first_frame_nr, last_frame_nr
+ * frame_nr_before_curr_frame_nr and frame_nr_after_curr_frame_nr
+ * from the index (with the same results as the directory scan
+ * in gap_lib_dir_ainfo). A new index is built if there is no
+ * up to date index for the basename and extension.
+ *
+ * returns FALSE if the index could not be used,
+ *   (the caller has to scan the directory itself)
+ * ============================================================================
+ */
+gboolean
+gap_frame_index_dir_ainfo(GapAnimInfo *ainfo_ptr)
+{
+  GapFrameIndex *fidx;
+  gchar         *key;
+  gint           len;
+  guint          pos;
+  long           l_minnr;
+  long           l_maxnr;
+
+  if((ainfo_ptr->basename == NULL)
+  || (p_is_supported_extension(ainfo_ptr->extension) != TRUE))
+  {
+    return (FALSE);
+  }
+
+  /* gap_lib_dir_ainfo strips all trailing digits to get the basename
+   * of the directory entries, a basename ending with a digit never matches
+   * and is left to the directory scan.
+   */
+  len = strlen(ainfo_ptr->basename);
+  if((len > 0)
+  && (ainfo_ptr->basename[len -1] >= '0')
+  && (ainfo_ptr->basename[len -1] <= '9'))
+  {
+    return (FALSE);
+  }
+
+  key = p_alloc_key(ainfo_ptr->basename, ainfo_ptr->extension);
+
+  g_static_mutex_lock(&frameIndexMutex);
+
+  fidx = p_index_lookup_or_load(key, ainfo_ptr->basename);
+  if(fidx == NULL)
+  {
+    fidx = p_index_scan(ainfo_ptr->basename, ainfo_ptr->extension);
+    if(fidx == NULL)
+    {
+      g_static_mutex_unlock(&frameIndexMutex);
+      g_free(key);
+      return (FALSE);
+    }
+    p_index_save(key, fidx);
+    p_index_store(key, fidx);
+  }
+  else
+  {
+    g_free(key);
+  }
+
+  ainfo_ptr->frame_cnt = fidx->fileCount;
+  l_minnr = 99999999;
+  l_maxnr = 0;
+  if(fidx->entries->len > 0)
+  {
+    l_minnr = MIN(l_minnr, g_array_index(fidx->entries, GapFrameIndexEntry, 0).nr);
+    l_maxnr = MAX(l_maxnr, g_array_index(fidx->entries, GapFrameIndexEntry, fidx->entries->len -1).nr);
+  }
+
+  pos = p_index_find_entry(fidx, ainfo_ptr->curr_frame_nr);
+  if(pos > 0)
+  {
+    long l_nr;
+
+    l_nr = g_array_index(fidx->entries, GapFrameIndexEntry, pos -1).nr;
+    if (l_nr > ainfo_ptr->frame_nr_before_curr_frame_nr)
+    {
+      ainfo_ptr->frame_nr_before_curr_frame_nr = l_nr;
+    }
+  }
+  if((pos < fidx->entries->len)
+  && (g_array_index(fidx->entries, GapFrameIndexEntry, pos).nr == ainfo_ptr->curr_frame_nr))
+  {
+    pos++;
+  }
+  if(pos < fidx->entries->len)
+  {
+    long l_nr;
+
+    l_nr = g_array_index(fidx->entries, GapFrameIndexEntry, pos).nr;
+    if ((ainfo_ptr->frame_nr_after_curr_frame_nr < 0)
+    || (l_nr < ainfo_ptr->frame_nr_after_curr_frame_nr))
+    {
+      ainfo_ptr->frame_nr_after_curr_frame_nr = l_nr;
+    }
+  }
+
+  g_static_mutex_unlock(&frameIndexMutex);
+
+  ainfo_ptr->last_frame_nr = l_maxnr;
+  ainfo_ptr->first_frame_nr = MIN(l_minnr, l_maxnr);
+
+  return (TRUE);
+}  /* end gap_frame_index_dir_ainfo */
+
+
+/* ============================================================================
+ * gap_frame_index_probe_frame_nr
+ *
+ * answer the frame existence and digits style check of
+ * gap_lib_exists_frame_nr and gap_lib_alloc_fname6 from an up to date index
+ * (checks the frames nr, nr-1, 1 and 0 in the same order as the stat probes).
+ * digits_used is set only when a frame was found,
+ * exists is set to TRUE when the found frame is nr itself.
+ *
+ * returns FALSE if there is no trusted up to date index
+ *   (the caller has to probe the files itself)
+ * ============================================================================
+ */
+gboolean
+gap_frame_index_probe_frame_nr(const char *basename
+  , const char *extension
+  , long nr
+  , long *digits_used
+  , gboolean *exists
+  )
+{
+  GapFrameIndex *fidx;
+  gchar         *key;
+
+  if((basename == NULL)
+  || (p_is_supported_extension(extension) != TRUE))
+  {
+    return (FALSE);
+  }
+
+  key = p_alloc_key(basename, extension);
+
+  g_static_mutex_lock(&frameIndexMutex);
+
+  fidx = p_index_lookup_or_load(key, basename);
+  g_free(key);
+  if(fidx == NULL)
+  {
+    g_static_mutex_unlock(&frameIndexMutex);
+    return (FALSE);
+  }
+
+  p_index_probe_frame_nr(fidx, nr, digits_used, exists);
+
+  g_static_mutex_unlock(&frameIndexMutex);
+
+  return (TRUE);
+}  /* end gap_frame_index_probe_frame_nr */
+
+
+/* ============================================================================
+ * gap_frame_index_snapshot_new
+ *
+ * returns a private snapshot of the frame index for basename and extension
+ * that reflects the current directory content (the cached index is used
+ * if it is up to date, otherwise the directory is scanned).
+ * The snapshot is not updated, it is intended for planning a batch of
+ * operations before the directory is modified.
+ *
+ * returns NULL if no index is available
+ *   (the caller has to probe the files itself)
+ * ============================================================================
+ */
+GapFrameIndex *
+gap_frame_index_snapshot_new(const char *basename, const char *extension)
+{
+  GapFrameIndex *fidx;
+  GapFrameIndex *fidxSnapshot;
+  gchar         *key;
+
+  if((basename == NULL)
+  || (p_is_supported_extension(extension) != TRUE))
+  {
+    return (NULL);
+  }
+
+  key = p_alloc_key(basename, extension);
+
+  g_static_mutex_lock(&frameIndexMutex);
+
+  fidx = p_index_lookup_or_load(key, basename);
+  if(fidx != NULL)
+  {
+    g_free(key);
+    fidxSnapshot = p_index_copy(fidx);
+  }
+  else
+  {
+    fidxSnapshot = p_index_scan(basename, extension);
+    if((fidxSnapshot != NULL) && (fidxSnapshot->isTrusted))
+    {
+      p_index_save(key, fidxSnapshot);
+      p_index_store(key, p_index_copy(fidxSnapshot));
+    }
+    else
+    {
+      g_free(key);
+    }
+  }
+
+  g_static_mutex_unlock(&frameIndexMutex);
+
+  return (fidxSnapshot);
+}  /* end gap_frame_index_snapshot_new */
+
+
+/* ============================================================================
+ * gap_frame_index_snapshot_probe_frame_nr
+ *
+ * same as gap_frame_index_probe_frame_nr, but answered from the snapshot
+ * (without checking the directory).
+ * ============================================================================
+ */
+gboolean
+gap_frame_index_snapshot_probe_frame_nr(GapFrameIndex *fidx
+  , long nr
+  , long *digits_used
+  , gboolean *exists
+  )
+{
+  if(fidx == NULL)
+  {
+    return (FALSE);
+  }
+  p_index_probe_frame_nr(fidx, nr, digits_used, exists);
+  return (TRUE);
+}  /* end gap_frame_index_snapshot_probe_frame_nr */
+
+
+/* ============================================================================
+ * gap_frame_index_snapshot_free
+ * ============================================================================
+ */
+void
+gap_frame_index_snapshot_free(GapFrameIndex *fidx)
+{
+  p_index_free(fidx);
+}  /* end gap_frame_index_snapshot_free */
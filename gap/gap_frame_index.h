@@ -0,0 +1,53 @@
+/*  gap_frame_index.h
+ *
+ *  This module provides a cached index of the frame numbers
+ *  of frame sequences on disk (one index per basename and extension)
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * version 2.7.0;   2026/10/18  created
+ *                               added snapshots (for planning batched frame renames)
+ */
+
+#ifndef _GAP_FRAME_INDEX_H
+#define _GAP_FRAME_INDEX_H
+
+#include "libgimp/gimp.h"
+#include "gap_lib_common_defs.h"
+
+typedef struct GapFrameIndex GapFrameIndex;  /* opaque, nickname: fidx */
+
+gboolean   gap_frame_index_dir_ainfo(GapAnimInfo *ainfo_ptr);
+gboolean   gap_frame_index_probe_frame_nr(const char *basename
+                 , const char *extension
+                 , long nr
+                 , long *digits_used
+                 , gboolean *exists
+                 );
+
+GapFrameIndex * gap_frame_index_snapshot_new(const char *basename, const char *extension);
+gboolean   gap_frame_index_snapshot_probe_frame_nr(GapFrameIndex *fidx
+                 , long nr
+                 , long *digits_used
+                 , gboolean *exists
+                 );
+void       gap_frame_index_snapshot_free(GapFrameIndex *fidx);
+
+#endif
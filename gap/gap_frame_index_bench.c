@@ -0,0 +1,552 @@
+/* gap_frame_index_bench.c
+ *
+ * GAP ... Gimp Animation Plugins
+ *
+ * equality check and benchmark for the frame index (gap_frame_index.c)
+ *
+ * A frame directory with gaps and mixed digit styles of the number part
+ * (frame_000001.xcf, frame_0002.xcf, frame_3.xcf, frame_03.xcf)
+ * is generated with a fixed seed.
+ *   a) scan: gap_frame_index_dir_ainfo and gap_frame_index_probe_frame_nr
+ *      are compared against the expected results of the directory scan
+ *      and the stat probes (same check order as gap_lib_exists_frame_nr).
+ *   b) disk: the index is dropped from the process local table
+ *      (as in a new plug-in process) and must be loaded from the
+ *      frame index cache directory with identical results.
+ *   c) changes: a new frame is added and the directory mtime is set back
+ *      to its old value (as a change within the same second would leave it).
+ *      The stored index must not be used, the rescan must find the new frame.
+ *      A directory that was modified within GAP_FRAME_INDEX_RACY_SECS
+ *      must not be loaded from disk.
+ *
+ * usage:
+ *   gap_frame_index_bench             equality check on 500 frame numbers (run by make check)
+ *   gap_frame_index_bench -b [n]      equality check and benchmark (20 gap_frame_index_dir_ainfo calls
+ *                                     as in new processes, with directory scan and with the stored index)
+ *                                     on n frame numbers (default 5000)
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * 2026.10.18  created
+ */
+
+/* included (not linked) to access the static index procedures */
+#include "gap_frame_index.c"
+
+#include <utime.h>
+
+#define BENCH_LOOPS  20
+
+int gap_debug = 0;  /* 1 == print debug infos , 0 dont print debug infos */
+
+static const gint    benchDigits[] = { 6, 6, 6, 4, 8, 1 };
+
+
+/* ---------------------------------
+ * p_write_frame
+ * ---------------------------------
+ */
+static gboolean
+p_write_frame(const char *basename, long nr, gint digits)
+{
+  gchar   *filename;
+  FILE    *fp;
+
+  filename = g_strdup_printf("%s%0*ld.xcf", basename, digits, nr);
+  fp = g_fopen(filename, "wb");
+  g_free(filename);
+  if(fp == NULL)
+  {
+    return (FALSE);
+  }
+  fprintf(fp, "frame %ld\n", nr);
+  fclose(fp);
+  return (TRUE);
+}  /* end p_write_frame */
+
+
+/* ---------------------------------
+ * p_set_dir_mtime
+ * ---------------------------------
+ */
+static void
+p_set_dir_mtime(const char *dirname, time_t mtime)
+{
+  struct utimbuf  ut;
+
+  ut.actime = mtime;
+  ut.modtime = mtime;
+  g_utime(dirname, &ut);
+}  /* end p_set_dir_mtime */
+
+
+/* ---------------------------------
+ * p_generate_frames
+ * ---------------------------------
+ * write frames with numbers 1 upto maxNr (with gaps)
+ */
+static gboolean
+p_generate_frames(const char *basename, long maxNr, guint32 seed)
+{
+  GRand   *rand;
+  long     nr;
+  gboolean ok;
+
+  ok = TRUE;
+  rand = g_rand_new_with_seed(seed);
+  for(nr = 1; (nr <= maxNr) && (ok); nr++)
+  {
+    gint32 rr;
+
+    rr = g_rand_int_range(rand, 0, 100);
+    if(rr < 20)
+    {
+      continue;   /* gap in the sequence */
+    }
+    ok = p_write_frame(basename, nr
+                      , benchDigits[g_rand_int_range(rand, 0, G_N_ELEMENTS(benchDigits))]
+                      );
+    if((ok) && (rr >= 97))
+    {
+      /* the same number in another digit style */
+      ok = p_write_frame(basename, nr, 2);
+    }
+  }
+  g_rand_free(rand);
+
+  return (ok);
+}  /* end p_generate_frames */
+
+
+/* ---------------------------------
+ * p_file_exists
+ * ---------------------------------
+ * same rules as gap_lib_file_exists (regular non-empty file)
+ */
+static gboolean
+p_file_exists(const char *filename)
+{
+  struct stat  l_stat_buf;
+
+  if (0 != g_stat(filename, &l_stat_buf))
+  {
+    return (FALSE);
+  }
+  return ((S_ISREG(l_stat_buf.st_mode)) && (l_stat_buf.st_size > 0));
+}  /* end p_file_exists */
+
+
+/* ---------------------------------
+ * p_probe_reference
+ * ---------------------------------
+ * the stat probes of gap_lib_exists_frame_nr and gap_lib_alloc_fname6
+ * (frames nr, nr-1, 1 and 0 in the digit style order 6,8,7,4,5,3,2,1)
+ */
+static void
+p_probe_reference(const char *basename, long nr, long *digits_used, gboolean *exists)
+{
+  long l_nr_chk;
+
+  l_nr_chk = nr;
+  while(l_nr_chk >= 0)
+  {
+    gint ii;
+
+    for(ii=0; ii < G_N_ELEMENTS(probeOrderDigits); ii++)
+    {
+      gchar    *filename;
+      gboolean  found;
+
+      filename = g_strdup_printf("%s%0*ld.xcf", basename, probeOrderDigits[ii], l_nr_chk);
+      found = p_file_exists(filename);
+      g_free(filename);
+      if(found)
+      {
+        *digits_used = probeOrderDigits[ii];
+        if(l_nr_chk == nr)
+        {
+          *exists = TRUE;
+        }
+        return;
+      }
+    }
+    l_nr_chk--;
+    if((l_nr_chk == nr -2) && (l_nr_chk > 1))
+    {
+      l_nr_chk = 1;
+    }
+  }
+}  /* end p_probe_reference */
+
+
+/* ---------------------------------
+ * p_dir_ainfo_reference
+ * ---------------------------------
+ * frame_cnt, first, last, before and after curr_frame_nr
+ * as the directory scan of gap_lib_dir_ainfo computes them.
+ */
+static void
+p_dir_ainfo_reference(GapAnimInfo *ainfo_ptr, const char *dirname, const char *prefix)
+{
+  GDir         *l_dirp;
+  const gchar  *l_entry;
+  long          l_minnr;
+  long          l_maxnr;
+  gint          prefixLen;
+
+  l_minnr = 99999999;
+  l_maxnr = 0;
+  prefixLen = strlen(prefix);
+  l_dirp = g_dir_open(dirname, 0, NULL);
+  while((l_dirp != NULL) && ((l_entry = g_dir_read_name(l_dirp)) != NULL))
+  {
+    gchar  *fullname;
+    long    nr;
+    gint    len;
+    gint    jj;
+
+    len = strlen(l_entry);
+    if((len <= prefixLen + 4)
+    || (strncmp(l_entry, prefix, prefixLen) != 0)
+    || (strcmp(&l_entry[len - 4], ".xcf") != 0))
+    {
+      continue;
+    }
+    nr = 0;
+    for(jj = prefixLen; jj < len - 4; jj++)
+    {
+      nr = (nr * 10) + (l_entry[jj] - '0');
+    }
+    fullname = g_build_filename(dirname, l_entry, NULL);
+    if(p_file_exists(fullname))
+    {
+      ainfo_ptr->frame_cnt++;
+      l_minnr = MIN(l_minnr, nr);
+      l_maxnr = MAX(l_maxnr, nr);
+      if((nr < ainfo_ptr->curr_frame_nr) && (nr > ainfo_ptr->frame_nr_before_curr_frame_nr))
+      {
+        ainfo_ptr->frame_nr_before_curr_frame_nr = nr;
+      }
+      if((nr > ainfo_ptr->curr_frame_nr)
+      && ((ainfo_ptr->frame_nr_after_curr_frame_nr < 0) || (nr < ainfo_ptr->frame_nr_after_curr_frame_nr)))
+      {
+        ainfo_ptr->frame_nr_after_curr_frame_nr = nr;
+      }
+    }
+    g_free(fullname);
+  }
+  if(l_dirp != NULL)
+  {
+    g_dir_close(l_dirp);
+  }
+  ainfo_ptr->last_frame_nr = l_maxnr;
+  ainfo_ptr->first_frame_nr = MIN(l_minnr, l_maxnr);
+}  /* end p_dir_ainfo_reference */
+
+
+/* ---------------------------------
+ * p_init_ainfo
+ * ---------------------------------
+ */
+static void
+p_init_ainfo(GapAnimInfo *ainfo_ptr, char *basename, long curr_frame_nr)
+{
+  memset(ainfo_ptr, 0, sizeof(GapAnimInfo));
+  ainfo_ptr->basename = basename;
+  ainfo_ptr->extension = ".xcf";
+  ainfo_ptr->curr_frame_nr = curr_frame_nr;
+  ainfo_ptr->frame_nr_before_curr_frame_nr = -1;
+  ainfo_ptr->frame_nr_after_curr_frame_nr = -1;
+}  /* end p_init_ainfo */
+
+
+/* ---------------------------------
+ * p_check_index
+ * ---------------------------------
+ * compare index results against the reference for frame numbers 0 upto maxNr +2
+ * returns the number of differences.
+ */
+static gint32
+p_check_index(const char *label, char *basename, const char *dirname, long maxNr)
+{
+  GapAnimInfo  ainfoIdx;
+  GapAnimInfo  ainfoRef;
+  gint32       diffs;
+  long         nr;
+
+  diffs = 0;
+  p_init_ainfo(&ainfoIdx, basename, maxNr / 2);
+  p_init_ainfo(&ainfoRef, basename, maxNr / 2);
+  if(gap_frame_index_dir_ainfo(&ainfoIdx) != TRUE)
+  {
+    printf("%s: gap_frame_index_dir_ainfo failed\n", label);
+    return (1);
+  }
+  p_dir_ainfo_reference(&ainfoRef, dirname, "frame_");
+  if((ainfoIdx.frame_cnt != ainfoRef.frame_cnt)
+  || (ainfoIdx.first_frame_nr != ainfoRef.first_frame_nr)
+  || (ainfoIdx.last_frame_nr != ainfoRef.last_frame_nr)
+  || (ainfoIdx.frame_nr_before_curr_frame_nr != ainfoRef.frame_nr_before_curr_frame_nr)
+  || (ainfoIdx.frame_nr_after_curr_frame_nr != ainfoRef.frame_nr_after_curr_frame_nr))
+  {
+    printf("%s: MISMATCH dir_ainfo cnt:%ld/%ld first:%ld/%ld last:%ld/%ld before:%ld/%ld after:%ld/%ld\n"
+          , label
+          , ainfoIdx.frame_cnt, ainfoRef.frame_cnt
+          , ainfoIdx.first_frame_nr, ainfoRef.first_frame_nr
+          , ainfoIdx.last_frame_nr, ainfoRef.last_frame_nr
+          , ainfoIdx.frame_nr_before_curr_frame_nr, ainfoRef.frame_nr_before_curr_frame_nr
+          , ainfoIdx.frame_nr_after_curr_frame_nr, ainfoRef.frame_nr_after_curr_frame_nr
+          );
+    diffs++;
+  }
+
+  for(nr = 0; nr <= maxNr + 2; nr++)
+  {
+    long      digitsIdx;
+    long      digitsRef;
+    gboolean  existsIdx;
+    gboolean  existsRef;
+
+    digitsIdx = -1;
+    digitsRef = -1;
+    existsIdx = FALSE;
+    existsRef = FALSE;
+    if(gap_frame_index_probe_frame_nr(basename, ".xcf", nr, &digitsIdx, &existsIdx) != TRUE)
+    {
+      printf("%s: no trusted index for probe of frame %ld\n", label, nr);
+      return (diffs + 1);
+    }
+    p_probe_reference(basename, nr, &digitsRef, &existsRef);
+    if((digitsIdx != digitsRef) || (existsIdx != existsRef))
+    {
+      if(diffs < 10)
+      {
+        printf("%s: MISMATCH probe frame %ld digits:%ld/%ld exists:%d/%d\n"
+              , label, nr, digitsIdx, digitsRef, (int)existsIdx, (int)existsRef);
+      }
+      diffs++;
+    }
+  }
+  return (diffs);
+}  /* end p_check_index */
+
+
+/* ---------------------------------
+ * p_remove_dir
+ * ---------------------------------
+ */
+static void
+p_remove_dir(const char *dirname)
+{
+  GDir         *l_dirp;
+  const gchar  *l_entry;
+
+  l_dirp = g_dir_open(dirname, 0, NULL);
+  if(l_dirp == NULL)
+  {
+    return;
+  }
+  while((l_entry = g_dir_read_name(l_dirp)) != NULL)
+  {
+    gchar *fullname;
+
+    fullname = g_build_filename(dirname, l_entry, NULL);
+    g_remove(fullname);
+    g_free(fullname);
+  }
+  g_dir_close(l_dirp);
+  g_rmdir(dirname);
+}  /* end p_remove_dir */
+
+
+/* ---------------------------------
+ * p_drop_process_index
+ * ---------------------------------
+ * forget all indexes of this process (as a new plug-in process would start)
+ */
+static void
+p_drop_process_index(void)
+{
+  if(frameIndexTable != NULL)
+  {
+    g_hash_table_remove_all(frameIndexTable);
+  }
+}  /* end p_drop_process_index */
+
+
+/* ---------------------------------
+ * main
+ * ---------------------------------
+ */
+int
+main(int argc, char *argv[])
+{
+  GapFrameIndex *fidx;
+  GTimer   *timer;
+  gchar    *tmpname;
+  gchar    *dirname;
+  gchar    *cachedir;
+  gchar    *basename;
+  gchar    *key;
+  time_t    oldMtime;
+  gboolean  isBenchmark;
+  long      maxNr;
+  gint32    numLoops;
+  gint32    errors;
+  gint32    ii;
+  gdouble   timeScan;
+  gdouble   timeLoad;
+
+  isBenchmark = FALSE;
+  maxNr = 500;
+  numLoops = 1;
+  if((argc > 1) && (strcmp(argv[1], "-b") == 0))
+  {
+    isBenchmark = TRUE;
+    maxNr = 5000;
+    numLoops = BENCH_LOOPS;
+    if(argc > 2)
+    {
+      maxNr = MAX(10, atol(argv[2]));
+    }
+  }
+
+  tmpname = g_strdup_printf("gap_frame_index_bench_%d", (int)getpid());
+  dirname = g_build_filename(g_get_tmp_dir(), tmpname, NULL);
+  cachedir = g_build_filename(dirname, "cache", NULL);
+  basename = g_build_filename(dirname, "frame_", NULL);
+  g_free(tmpname);
+
+  if((g_mkdir(dirname, 0755) != 0)
+  || (g_mkdir(cachedir, 0755) != 0)
+  || (p_generate_frames(basename, maxNr, 4711) != TRUE))
+  {
+    printf("could not write frames in %s, test skipped\n", dirname);
+    p_remove_dir(cachedir);
+    p_remove_dir(dirname);
+    return (77);   /* automake: skipped test */
+  }
+
+  /* use the test directory for the frame index cache (instead of the gimprc configuration) */
+  frameIndexFcd.maxMB = 1;
+  frameIndexFcd.dir = cachedir;
+
+  /* the directory must be older than GAP_FRAME_INDEX_RACY_SECS to trust the index */
+  oldMtime = time(NULL) - 100;
+  p_set_dir_mtime(dirname, oldMtime);
+
+  errors = 0;
+  key = p_alloc_key(basename, ".xcf");
+
+  /* a) scan */
+  errors += p_check_index("scan", basename, dirname, maxNr);
+
+  /* b) disk */
+  p_drop_process_index();
+  fidx = p_index_load(key, basename);
+  if(fidx == NULL)
+  {
+    printf("disk:      MISMATCH the stored index was not loaded\n");
+    errors++;
+  }
+  p_index_free(fidx);
+  p_drop_process_index();
+  errors += p_check_index("disk", basename, dirname, maxNr);
+
+  /* c) changes */
+  p_write_frame(basename, maxNr + 1, 6);
+  p_set_dir_mtime(dirname, oldMtime);
+  p_drop_process_index();
+  fidx = p_index_load(key, basename);
+  if(fidx != NULL)
+  {
+#if defined(_STATBUF_ST_NSEC)
+    printf("changes:   MISMATCH the stored index was loaded after the directory changed\n");
+    errors++;
+#else
+    printf("changes:   no nanosecond timestamps, change with unchanged mtime not detected (not checked)\n");
+#endif
+    p_index_free(fidx);
+  }
+  p_drop_process_index();
+  errors += p_check_index("changes", basename, dirname, maxNr + 1);
+
+  p_set_dir_mtime(dirname, time(NULL));
+  p_drop_process_index();
+  fidx = p_index_load(key, basename);
+  if(fidx != NULL)
+  {
+    printf("racy:      MISMATCH the stored index was loaded for a recently modified directory\n");
+    errors++;
+    p_index_free(fidx);
+  }
+  p_set_dir_mtime(dirname, oldMtime);
+
+  if(isBenchmark)
+  {
+    GapAnimInfo  ainfo;
+
+    timer = g_timer_new();
+
+    frameIndexFcd.maxMB = 0;    /* disk storage off: each process scans */
+    g_timer_start(timer);
+    for(ii = 0; ii < numLoops; ii++)
+    {
+      p_drop_process_index();
+      p_init_ainfo(&ainfo, basename, maxNr / 2);
+      gap_frame_index_dir_ainfo(&ainfo);
+    }
+    timeScan = g_timer_elapsed(timer, NULL);
+
+    frameIndexFcd.maxMB = 1;
+    p_drop_process_index();
+    p_init_ainfo(&ainfo, basename, maxNr / 2);
+    gap_frame_index_dir_ainfo(&ainfo);
+    g_timer_start(timer);
+    for(ii = 0; ii < numLoops; ii++)
+    {
+      p_drop_process_index();
+      p_init_ainfo(&ainfo, basename, maxNr / 2);
+      gap_frame_index_dir_ainfo(&ainfo);
+    }
+    timeLoad = g_timer_elapsed(timer, NULL);
+
+    printf("%ld frame numbers (%ld files), %d calls as new process:\n"
+          , maxNr, ainfo.frame_cnt, (int)numLoops);
+    printf("  dir_ainfo (directory scan):   %9.2f ms\n", timeScan * 1000.0);
+    printf("  dir_ainfo (stored index):     %9.2f ms\n", timeLoad * 1000.0);
+    g_timer_destroy(timer);
+  }
+
+  p_drop_process_index();
+  g_free(key);
+  p_remove_dir(cachedir);
+  p_remove_dir(dirname);
+  g_free(cachedir);
+  g_free(dirname);
+  g_free(basename);
+
+  printf("frame index equality check: %s\n"
+        , (errors == 0) ? "OK" : "FAILED"
+        );
+
+  return ((errors == 0) ? 0 : 1);
+
+}  /* end main */
@@ -0,0 +1,926 @@
+/*  gap_frame_rename.c
+ *
+ *  This module handles batched renaming (renumbering) of frame imagefiles
+ *  for the frame range operations (delete, duplicate, shift, reverse, renumber)
+ *
+ *  The caller adds all moves (from_nr -> to_nr) of the operation to a batch.
+ *  The filenames are resolved from one snapshot of the frame index
+ *  (instead of probing the digit styles for each frame),
+ *  then the moves are ordered, so that each rename has a free destination:
+ *  - chains (a->b, b->c, c->free) are renamed starting at the free end.
+ *  - cycles (a->b, b->a) are broken by renaming one frame to a temporary name.
+ *  This takes one rename per moved frame plus one per cycle
+ *  where the old implementation used 2 renames per frame
+ *  (shift via high frame numbers). A shift of n frames is one cycle
+ *  (n+1 renames), a reverse of n frames consists of n/2 cycles
+ *  of 2 frames each (about 1.5n renames).
+ *  A rename never replaces an existing file (except the temporary name).
+ *
+ *  Before the first rename, the ordered list of renames is written
+ *  to a journal file next to the frames, each completed rename
+ *  is marked in the journal. The marks are synced to disk before
+ *  a rename whose destination was freed by a preceding rename
+ *  (otherwise a lost mark could let the recovery rename the wrong file
+ *  to that destination). If the operation is interrupted
+ *  (crash, killed process, rename error) the next frame range operation
+ *  on the same frames completes the remaining renames
+ *  (see gap_frame_rename_journal_recover).
+ *
+ *  journal format (one line each):
+ *    GAP_FRAME_RENAME_JOURNAL <pid> <number of renames>
+ *    <from_filename>\t<to_filename>      (for each rename in execution order)
+ *    BEGIN
+ *    ++++                                (one "+" per completed rename)
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * version 2.7.0;   2026/10/18  created
+ */
+
+#include "config.h"
+
+/* SYSTEM (UNIX) includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+/* GIMP includes */
+#include "gtk/gtk.h"
+#include "gap-intl.h"
+#include "libgimp/gimp.h"
+
+/* GAP includes */
+#include "gap_libgapbase.h"
+#include "gap_arr_dialog.h"
+#include "gap_frame_index.h"
+#include "gap_frame_rename.h"
+#include "gap_lib.h"
+#include "gap_thumbnail.h"
+
+extern      int gap_debug; /* ==0  ... dont print debug infos */
+
+#define GAP_FRAME_RENAME_JOURNAL_SUFFIX    ".gap_rename_journal"
+#define GAP_FRAME_RENAME_TMP_SUFFIX        ".gap_rename_tmp"
+#define GAP_FRAME_RENAME_JOURNAL_MAGIC     "GAP_FRAME_RENAME_JOURNAL"
+#define GAP_FRAME_RENAME_JOURNAL_BEGIN     "BEGIN"
+
+
+typedef struct GapFrameRenameMove {
+  long      from_nr;
+  long      to_nr;
+  gchar    *from_fname;
+  gchar    *to_fname;
+} GapFrameRenameMove;
+
+typedef struct GapFrameRenameStep {
+  gchar    *from_fname;
+  gchar    *to_fname;
+  gint32    moveIdx;       /* the move that this rename belongs to */
+} GapFrameRenameStep;
+
+struct GapFrameRenameBatch {   /* nickname: rbat */
+  GapAnimInfo    *ainfo_ptr;
+  GapFrameIndex  *fidx;     /* snapshot of the frames on disk before the renames (may be NULL) */
+  GArray         *moves;    /* of GapFrameRenameMove */
+  GArray         *steps;    /* of GapFrameRenameStep (in execution order) */
+  gboolean        isValid;
+};
+
+
+/* ----------------------------------
+ * p_alloc_journal_name
+ * ----------------------------------
+ */
+static gchar *
+p_alloc_journal_name(GapAnimInfo *ainfo_ptr)
+{
+  return (g_strdup_printf("%s%s%s"
+                         , ainfo_ptr->basename
+                         , ainfo_ptr->extension
+                         , GAP_FRAME_RENAME_JOURNAL_SUFFIX
+                         ));
+}  /* end p_alloc_journal_name */
+
+
+/* ----------------------------------
+ * p_alloc_frame_fname
+ * ----------------------------------
+ * build the name of frame nr like gap_lib_alloc_fname6 does
+ * (the digit style is picked from the frames nr, nr-1, 1 or 0 that exist
+ * in the snapshot, default_digits is used if none of them exists,
+ * default_digits -1 picks the default of gap_lib_alloc_fname)
+ */
+static gchar *
+p_alloc_frame_fname(GapFrameRenameBatch *rbat, long nr, long default_digits)
+{
+  GapAnimInfo *ainfo_ptr;
+  long         l_digits;
+  gboolean     l_exists;
+
+  ainfo_ptr = rbat->ainfo_ptr;
+  l_digits = default_digits;
+  l_exists = FALSE;
+  if(nr >= 100000000)
+  {
+    l_digits = 0;
+  }
+  else if(!gap_frame_index_snapshot_probe_frame_nr(rbat->fidx, nr, &l_digits, &l_exists))
+  {
+    l_digits = -1;
+  }
+
+  if(l_digits < 0)
+  {
+    if(default_digits < 0)
+    {
+      return (gap_lib_alloc_fname(ainfo_ptr->basename, nr, ainfo_ptr->extension));
+    }
+    return (gap_lib_alloc_fname6(ainfo_ptr->basename, nr, ainfo_ptr->extension, default_digits));
+  }
+
+  return (gap_lib_alloc_fname_fixed_digits(ainfo_ptr->basename, nr, ainfo_ptr->extension, l_digits));
+}  /* end p_alloc_frame_fname */
+
+
+/* ----------------------------------
+ * p_add_move
+ * ----------------------------------
+ */
+static void
+p_add_move(GapFrameRenameBatch *rbat, long from_nr, long to_nr
+  , gchar *from_fname, gchar *to_fname)
+{
+  GapFrameRenameMove move;
+
+  if((from_fname == NULL) || (to_fname == NULL))
+  {
+    rbat->isValid = FALSE;
+    g_free(from_fname);
+    g_free(to_fname);
+    return;
+  }
+  if(strcmp(from_fname, to_fname) == 0)
+  {
+    /* nothing to rename */
+    g_free(from_fname);
+    g_free(to_fname);
+    return;
+  }
+
+  move.from_nr = from_nr;
+  move.to_nr = to_nr;
+  move.from_fname = from_fname;
+  move.to_fname = to_fname;
+  g_array_append_val(rbat->moves, move);
+}  /* end p_add_move */
+
+
+/* ----------------------------------
+ * p_add_step
+ * ----------------------------------
+ */
+static void
+p_add_step(GArray *steps, const gchar *from_fname, const gchar *to_fname, gint32 moveIdx)
+{
+  GapFrameRenameStep step;
+
+  step.from_fname = g_strdup(from_fname);
+  step.to_fname = g_strdup(to_fname);
+  step.moveIdx = moveIdx;
+  g_array_append_val(steps, step);
+}  /* end p_add_step */
+
+
+/* ----------------------------------
+ * p_free_steps
+ * ----------------------------------
+ */
+static void
+p_free_steps(GArray *steps)
+{
+  guint ii;
+
+  for(ii=0; ii < steps->len; ii++)
+  {
+    g_free(g_array_index(steps, GapFrameRenameStep, ii).from_fname);
+    g_free(g_array_index(steps, GapFrameRenameStep, ii).to_fname);
+  }
+  g_array_free(steps, TRUE);
+}  /* end p_free_steps */
+
+
+/* ----------------------------------
+ * p_plan_steps
+ * ----------------------------------
+ * order the moves of the batch into rename steps where
+ * the destination of each rename is free at the time it is executed.
+ * the moves form chains and cycles (each filename is the source
+ * of at most one move and the destination of at most one move).
+ * returns FALSE if two moves have the same destination.
+ */
+static gboolean
+p_plan_steps(GapFrameRenameBatch *rbat)
+{
+  GHashTable *srcTable;
+  gint32     *waiter;
+  gboolean   *isPlanned;
+  gint32      numMoves;
+  gint32      ii;
+  gboolean    isOk;
+
+  numMoves = rbat->moves->len;
+  srcTable = g_hash_table_new(g_str_hash, g_str_equal);
+  waiter = g_new(gint32, numMoves);
+  isPlanned = g_new0(gboolean, numMoves);
+  isOk = TRUE;
+
+  for(ii=0; ii < numMoves; ii++)
+  {
+    g_hash_table_insert(srcTable
+                       , g_array_index(rbat->moves, GapFrameRenameMove, ii).from_fname
+                       , GINT_TO_POINTER(ii + 1)
+                       );
+    waiter[ii] = -1;
+  }
+
+  /* waiter[jj] is the move that can be done after move jj has freed its source */
+  for(ii=0; ii < numMoves; ii++)
+  {
+    gint32 jj;
+
+    jj = GPOINTER_TO_INT(g_hash_table_lookup(srcTable
+                           , g_array_index(rbat->moves, GapFrameRenameMove, ii).to_fname)) -1;
+    if(jj >= 0)
+    {
+      if(waiter[jj] >= 0)
+      {
+        printf("p_plan_steps: more than one rename to %s\n"
+              , g_array_index(rbat->moves, GapFrameRenameMove, ii).to_fname);
+        isOk = FALSE;
+        break;
+      }
+      waiter[jj] = ii;
+    }
+  }
+
+  if(isOk)
+  {
+    /* chains: start with the moves that have a free destination */
+    for(ii=0; ii < numMoves; ii++)
+    {
+      gint32 kk;
+
+      if(g_hash_table_lookup(srcTable
+           , g_array_index(rbat->moves, GapFrameRenameMove, ii).to_fname) != NULL)
+      {
+        continue;
+      }
+      for(kk = ii; kk >= 0; kk = waiter[kk])
+      {
+        GapFrameRenameMove *move;
+
+        move = &g_array_index(rbat->moves, GapFrameRenameMove, kk);
+        p_add_step(rbat->steps, move->from_fname, move->to_fname, kk);
+        isPlanned[kk] = TRUE;
+      }
+    }
+
+    /* cycles: move one frame to a temporary name */
+    for(ii=0; ii < numMoves; ii++)
+    {
+      GapFrameRenameMove *move;
+      gchar              *tmp_fname;
+      gint32              kk;
+
+      if(isPlanned[ii])
+      {
+        continue;
+      }
+      move = &g_array_index(rbat->moves, GapFrameRenameMove, ii);
+      tmp_fname = g_strdup_printf("%s%s", move->from_fname, GAP_FRAME_RENAME_TMP_SUFFIX);
+      p_add_step(rbat->steps, move->from_fname, tmp_fname, ii);
+      isPlanned[ii] = TRUE;
+      for(kk = waiter[ii]; kk != ii; kk = waiter[kk])
+      {
+        GapFrameRenameMove *kmove;
+
+        kmove = &g_array_index(rbat->moves, GapFrameRenameMove, kk);
+        p_add_step(rbat->steps, kmove->from_fname, kmove->to_fname, kk);
+        isPlanned[kk] = TRUE;
+      }
+      p_add_step(rbat->steps, tmp_fname, move->to_fname, ii);
+      g_free(tmp_fname);
+    }
+  }
+
+  g_hash_table_destroy(srcTable);
+  g_free(waiter);
+  g_free(isPlanned);
+
+  return (isOk);
+}  /* end p_plan_steps */
+
+
+/* ----------------------------------
+ * p_journal_create
+ * ----------------------------------
+ * write all rename steps to the journal file.
+ * returns the open journal file (for the progress marks)
+ * or NULL if the journal could not be written.
+ */
+static FILE *
+p_journal_create(const gchar *journal_name, GArray *steps)
+{
+  FILE  *fp;
+  guint  ii;
+
+  for(ii=0; ii < steps->len; ii++)
+  {
+    GapFrameRenameStep *step;
+
+    step = &g_array_index(steps, GapFrameRenameStep, ii);
+    if((strpbrk(step->from_fname, "\t\n") != NULL)
+    || (strpbrk(step->to_fname, "\t\n") != NULL))
+    {
+      /* filenames can not be represented in the journal format */
+      return (NULL);
+    }
+  }
+
+  fp = g_fopen(journal_name, "w");
+  if(fp == NULL)
+  {
+    return (NULL);
+  }
+
+  fprintf(fp, "%s %d %d\n"
+         , GAP_FRAME_RENAME_JOURNAL_MAGIC
+         , (int)gap_base_getpid()
+         , (int)steps->len
+         );
+  for(ii=0; ii < steps->len; ii++)
+  {
+    GapFrameRenameStep *step;
+
+    step = &g_array_index(steps, GapFrameRenameStep, ii);
+    fprintf(fp, "%s\t%s\n", step->from_fname, step->to_fname);
+  }
+  fprintf(fp, "%s\n", GAP_FRAME_RENAME_JOURNAL_BEGIN);
+
+  if((fflush(fp) != 0) || (ferror(fp)))
+  {
+    fclose(fp);
+    g_remove(journal_name);
+    return (NULL);
+  }
+#ifndef G_OS_WIN32
+  fsync(fileno(fp));
+#endif
+
+  return (fp);
+}  /* end p_journal_create */
+
+
+/* ----------------------------------
+ * p_journal_sync
+ * ----------------------------------
+ */
+static void
+p_journal_sync(FILE *journal_fp)
+{
+  fflush(journal_fp);
+#ifndef G_OS_WIN32
+  fsync(fileno(journal_fp));
+#endif
+}  /* end p_journal_sync */
+
+
+/* ----------------------------------
+ * p_is_tmp_fname
+ * ----------------------------------
+ */
+static gboolean
+p_is_tmp_fname(const gchar *fname)
+{
+  return (g_str_has_suffix(fname, GAP_FRAME_RENAME_TMP_SUFFIX));
+}  /* end p_is_tmp_fname */
+
+
+/* ----------------------------------
+ * p_execute_steps
+ * ----------------------------------
+ * rename (and move the thumbnails) starting at step startIdx.
+ * each completed rename is marked in the journal (if there is one).
+ * the marks are synced to disk before a rename to a destination
+ * that was the source of a preceding rename with a not yet synced mark.
+ * A rename to an existing file (other than the temporary name) is refused,
+ * the planned destinations are free, an existing destination means
+ * that the frames on disk do not match the plan (or the journal).
+ * returns the index of the failed step or -1 if all renames were done.
+ * (destExists is set TRUE if the failed step was refused)
+ */
+static gint32
+p_execute_steps(GArray *steps, gint32 startIdx, FILE *journal_fp, GimpRunMode run_mode
+  , gboolean *destExists)
+{
+  GHashTable *srcTable;
+  gint32      syncedIdx;
+  gint32      failedIdx;
+  gint32      ii;
+
+  *destExists = FALSE;
+  failedIdx = -1;
+
+  /* srcTable: filename -> 1 + index of the last step that renamed this file (freed the name) */
+  srcTable = g_hash_table_new(g_str_hash, g_str_equal);
+  for(ii=0; ii < startIdx; ii++)
+  {
+    g_hash_table_insert(srcTable
+                       , g_array_index(steps, GapFrameRenameStep, ii).from_fname
+                       , GINT_TO_POINTER(ii + 1));
+  }
+  syncedIdx = startIdx;   /* the marks of all steps before syncedIdx are on disk */
+
+  for(ii=startIdx; ii < steps->len; ii++)
+  {
+    GapFrameRenameStep *step;
+    gint32              freedIdx;
+
+    step = &g_array_index(steps, GapFrameRenameStep, ii);
+    if(gap_debug) printf("DEBUG p_execute_steps: %s ..to.. %s\n", step->from_fname, step->to_fname);
+
+    freedIdx = GPOINTER_TO_INT(g_hash_table_lookup(srcTable, step->to_fname)) -1;
+    if((journal_fp != NULL) && (freedIdx >= syncedIdx))
+    {
+      p_journal_sync(journal_fp);
+      syncedIdx = ii;
+    }
+
+    if((!p_is_tmp_fname(step->to_fname))
+    && (g_file_test(step->to_fname, G_FILE_TEST_EXISTS)))
+    {
+      printf("p_execute_steps: refused to rename %s to the existing file %s\n"
+            , step->from_fname
+            , step->to_fname
+            );
+      *destExists = TRUE;
+      failedIdx = ii;
+      break;
+    }
+    if(0 != g_rename(step->from_fname, step->to_fname))
+    {
+      failedIdx = ii;
+      break;
+    }
+    g_hash_table_insert(srcTable, step->from_fname, GINT_TO_POINTER(ii + 1));
+    if(journal_fp != NULL)
+    {
+      fputc('+', journal_fp);
+      fflush(journal_fp);
+    }
+
+    gap_thumb_file_rename_thumbnail(step->from_fname, step->to_fname);
+
+    if((run_mode == GIMP_RUN_INTERACTIVE) && ((ii % 32) == 0))
+    {
+      gimp_progress_update((gdouble)(ii + 1) / (gdouble)steps->len);
+    }
+  }
+
+  if(journal_fp != NULL)
+  {
+    p_journal_sync(journal_fp);
+  }
+  g_hash_table_destroy(srcTable);
+
+  return (failedIdx);
+}  /* end p_execute_steps */
+
+
+/* ============================================================================
+ * gap_frame_rename_batch_new
+ *
+ * create an empty batch for renaming frames of the frame sequence
+ * described by ainfo_ptr (basename, extension and run_mode are used).
+ * takes a snapshot of the frames on disk, all moves must be added
+ * before the batch is executed.
+ * ============================================================================
+ */
+GapFrameRenameBatch *
+gap_frame_rename_batch_new(GapAnimInfo *ainfo_ptr)
+{
+  GapFrameRenameBatch *rbat;
+
+  rbat = g_new0(GapFrameRenameBatch, 1);
+  rbat->ainfo_ptr = ainfo_ptr;
+  rbat->fidx = gap_frame_index_snapshot_new(ainfo_ptr->basename, ainfo_ptr->extension);
+  rbat->moves = g_array_new(FALSE, FALSE, sizeof(GapFrameRenameMove));
+  rbat->steps = g_array_new(FALSE, FALSE, sizeof(GapFrameRenameStep));
+  rbat->isValid = TRUE;
+
+  return (rbat);
+}  /* end gap_frame_rename_batch_new */
+
+
+/* ============================================================================
+ * gap_frame_rename_batch_add
+ *
+ * add renaming frame from_nr to to_nr.
+ * the new filename is built with the same number of digits
+ * as the original frame imagefile (same rules as gap_lib_rename_frame).
+ * ============================================================================
+ */
+void
+gap_frame_rename_batch_add(GapFrameRenameBatch *rbat, long from_nr, long to_nr)
+{
+  gchar *l_from_fname;
+  gchar *l_to_fname;
+  long   l_digits_used;
+
+  l_from_fname = p_alloc_frame_fname(rbat, from_nr, -1);
+  if(l_from_fname == NULL)
+  {
+    rbat->isValid = FALSE;
+    return;
+  }
+
+  l_digits_used = gap_lib_count_framenumber_digits(l_from_fname);
+  if (l_digits_used > 0)
+  {
+    l_to_fname = p_alloc_frame_fname(rbat, to_nr, l_digits_used);
+  }
+  else
+  {
+    /* this should not occur when the frame imagfile with from_nr already exists */
+    l_to_fname = p_alloc_frame_fname(rbat, to_nr, -1);
+  }
+
+  p_add_move(rbat, from_nr, to_nr, l_from_fname, l_to_fname);
+}  /* end gap_frame_rename_batch_add */
+
+
+/* ============================================================================
+ * gap_frame_rename_batch_add_digits
+ *
+ * add renaming frame from_nr to to_nr where both filenames
+ * have fixed number of digits (same rules as gap_lib_rename_frame_digits).
+ * ============================================================================
+ */
+void
+gap_frame_rename_batch_add_digits(GapFrameRenameBatch *rbat, long from_nr, long to_nr
+  , long from_digits, long to_digits)
+{
+  GapAnimInfo *ainfo_ptr;
+
+  ainfo_ptr = rbat->ainfo_ptr;
+  p_add_move(rbat, from_nr, to_nr
+            , gap_lib_alloc_fname_fixed_digits(ainfo_ptr->basename, from_nr, ainfo_ptr->extension, from_digits)
+            , gap_lib_alloc_fname_fixed_digits(ainfo_ptr->basename, to_nr, ainfo_ptr->extension, to_digits)
+            );
+}  /* end gap_frame_rename_batch_add_digits */
+
+
+/* ============================================================================
+ * gap_frame_rename_batch_probe_frame_nr
+ *
+ * check if frame nr exists (before the renames of the batch)
+ * and find out how much digits are used for the number part
+ * (same as gap_lib_exists_frame_nr, but answered from the snapshot)
+ * ============================================================================
+ */
+gboolean
+gap_frame_rename_batch_probe_frame_nr(GapFrameRenameBatch *rbat, long nr, long *has_digits)
+{
+  gboolean l_exists;
+
+  l_exists = FALSE;
+  *has_digits = GAP_LIB_DEFAULT_DIGITS;
+  if(gap_frame_index_snapshot_probe_frame_nr(rbat->fidx, nr, has_digits, &l_exists))
+  {
+    return (l_exists);
+  }
+  return (gap_lib_exists_frame_nr(rbat->ainfo_ptr, nr, has_digits));
+}  /* end gap_frame_rename_batch_probe_frame_nr */
+
+
+/* ============================================================================
+ * gap_frame_rename_batch_execute
+ *
+ * rename all frames of the batch.
+ * on errors a message is shown, the journal is kept
+ * (the remaining renames are done by the next frame range operation
+ * via gap_frame_rename_journal_recover)
+ *
+ * return 0 on success, -1 on errors
+ * ============================================================================
+ */
+gint32
+gap_frame_rename_batch_execute(GapFrameRenameBatch *rbat)
+{
+  GapAnimInfo *ainfo_ptr;
+  FILE        *journal_fp;
+  gchar       *journal_name;
+  gint32       failedIdx;
+  gboolean     destExists;
+
+  ainfo_ptr = rbat->ainfo_ptr;
+  if((rbat->isValid != TRUE) || (p_plan_steps(rbat) != TRUE))
+  {
+    return (-1);
+  }
+  if(rbat->steps->len == 0)
+  {
+    return (0);
+  }
+
+  if(gap_debug)
+  {
+    printf("gap_frame_rename_batch_execute: moves:%d renames:%d\n"
+          , (int)rbat->moves->len
+          , (int)rbat->steps->len
+          );
+  }
+
+  journal_name = p_alloc_journal_name(ainfo_ptr);
+  journal_fp = p_journal_create(journal_name, rbat->steps);
+  if(journal_fp == NULL)
+  {
+    printf("gap_frame_rename_batch_execute: could not write journal %s (renaming without journal)\n"
+          , journal_name);
+  }
+
+  failedIdx = p_execute_steps(rbat->steps, 0, journal_fp, ainfo_ptr->run_mode, &destExists);
+
+  if(journal_fp != NULL)
+  {
+    fclose(journal_fp);
+    if(failedIdx < 0)
+    {
+      g_remove(journal_name);
+    }
+  }
+  g_free(journal_name);
+
+  if(failedIdx >= 0)
+  {
+    GapFrameRenameMove *move;
+    gchar *tmp_errtxt;
+
+    move = &g_array_index(rbat->moves, GapFrameRenameMove
+                         , g_array_index(rbat->steps, GapFrameRenameStep, failedIdx).moveIdx);
+    if(destExists)
+    {
+      tmp_errtxt = g_strdup_printf(_("Error: could not rename frame %ld to %ld\n"
+                                     "because the file %s already exists")
+                                  , move->from_nr, move->to_nr
+                                  , g_array_index(rbat->steps, GapFrameRenameStep, failedIdx).to_fname);
+    }
+    else
+    {
+      tmp_errtxt = g_strdup_printf(_("Error: could not rename frame %ld to %ld"), move->from_nr, move->to_nr);
+    }
+    gap_arr_msg_win(ainfo_ptr->run_mode, tmp_errtxt);
+    g_free(tmp_errtxt);
+    return (-1);
+  }
+
+  return (0);
+}  /* end gap_frame_rename_batch_execute */
+
+
+/* ============================================================================
+ * gap_frame_rename_batch_free
+ * ============================================================================
+ */
+void
+gap_frame_rename_batch_free(GapFrameRenameBatch *rbat)
+{
+  guint ii;
+
+  if(rbat == NULL)
+  {
+    return;
+  }
+  for(ii=0; ii < rbat->moves->len; ii++)
+  {
+    g_free(g_array_index(rbat->moves, GapFrameRenameMove, ii).from_fname);
+    g_free(g_array_index(rbat->moves, GapFrameRenameMove, ii).to_fname);
+  }
+  g_array_free(rbat->moves, TRUE);
+  p_free_steps(rbat->steps);
+  gap_frame_index_snapshot_free(rbat->fidx);
+  g_free(rbat);
+}  /* end gap_frame_rename_batch_free */
+
+
+/* ============================================================================
+ * gap_frame_rename_journal_recover
+ *
+ * check for the journal of an interrupted batch rename
+ * of the frame sequence described by ainfo_ptr and complete
+ * the remaining renames.
+ * The journal of a batch that is still running in another (alive) process
+ * is not touched.
+ *
+ * return FALSE if an interrupted batch could not be completed,
+ *        TRUE  otherwise
+ * ============================================================================
+ */
+gboolean
+gap_frame_rename_journal_recover(GapAnimInfo *ainfo_ptr)
+{
+  gchar     *journal_name;
+  gchar     *contents;
+  gchar    **lines;
+  GArray    *steps;
+  FILE      *journal_fp;
+  gint       pid;
+  gint       numSteps;
+  gint       numDone;
+  gint       ii;
+  gint32     failedIdx;
+  gboolean   isOk;
+  gboolean   destExists;
+
+  if((ainfo_ptr->basename == NULL) || (ainfo_ptr->extension == NULL))
+  {
+    return (TRUE);
+  }
+
+  journal_name = p_alloc_journal_name(ainfo_ptr);
+  if(!g_file_test(journal_name, G_FILE_TEST_EXISTS))
+  {
+    g_free(journal_name);
+    return (TRUE);
+  }
+
+  contents = NULL;
+  if(!g_file_get_contents(journal_name, &contents, NULL, NULL))
+  {
+    g_free(journal_name);
+    return (FALSE);
+  }
+  lines = g_strsplit(contents, "\n", -1);
+  g_free(contents);
+
+  if((lines[0] == NULL)
+  || (sscanf(lines[0], GAP_FRAME_RENAME_JOURNAL_MAGIC " %d %d", &pid, &numSteps) != 2)
+  || (numSteps < 0))
+  {
+    printf("gap_frame_rename_journal_recover: %s is not a valid journal\n", journal_name);
+    g_strfreev(lines);
+    g_free(journal_name);
+    return (FALSE);
+  }
+
+  if((pid != gap_base_getpid()) && (gap_base_is_pid_alive(pid)))
+  {
+    /* the batch is still running in another process */
+    g_strfreev(lines);
+    g_free(journal_name);
+    return (TRUE);
+  }
+
+  steps = g_array_new(FALSE, FALSE, sizeof(GapFrameRenameStep));
+  isOk = TRUE;
+  for(ii=1; ii <= numSteps; ii++)
+  {
+    gchar **names;
+
+    if(lines[ii] == NULL)
+    {
+      isOk = FALSE;
+      break;
+    }
+    names = g_strsplit(lines[ii], "\t", 2);
+    if((names[0] == NULL) || (names[1] == NULL))
+    {
+      isOk = FALSE;
+    }
+    else
+    {
+      p_add_step(steps, names[0], names[1], -1);
+    }
+    g_strfreev(names);
+    if(!isOk)
+    {
+      break;
+    }
+  }
+
+  if((!isOk)
+  || (lines[ii] == NULL)
+  || (strcmp(lines[ii], GAP_FRAME_RENAME_JOURNAL_BEGIN) != 0))
+  {
+    /* journal was not completely written, no rename was done */
+    printf("gap_frame_rename_journal_recover: removing incomplete journal %s\n", journal_name);
+    g_strfreev(lines);
+    p_free_steps(steps);
+    g_remove(journal_name);
+    g_free(journal_name);
+    return (TRUE);
+  }
+
+  /* count the completed renames */
+  numDone = 0;
+  for(ii++; lines[ii] != NULL; ii++)
+  {
+    gchar *l_ptr;
+
+    for(l_ptr = lines[ii]; *l_ptr == '+'; l_ptr++)
+    {
+      numDone++;
+    }
+  }
+  g_strfreev(lines);
+
+  journal_fp = g_fopen(journal_name, "a");
+
+  /* the rename after the last mark may be done
+   * (if the process was interrupted before the mark was written).
+   * the source of a rename exists until the rename is done
+   */
+  if((numDone < steps->len)
+  && (!g_file_test(g_array_index(steps, GapFrameRenameStep, numDone).from_fname, G_FILE_TEST_EXISTS)))
+  {
+    if(journal_fp != NULL)
+    {
+      fputc('+', journal_fp);
+      p_journal_sync(journal_fp);
+    }
+    gap_thumb_file_rename_thumbnail(g_array_index(steps, GapFrameRenameStep, numDone).from_fname
+                                   , g_array_index(steps, GapFrameRenameStep, numDone).to_fname);
+    numDone++;
+  }
+
+  printf("gap_frame_rename_journal_recover: %s completing %d of %d renames\n"
+        , journal_name
+        , (int)(steps->len - numDone)
+        , (int)steps->len
+        );
+
+  isOk = TRUE;
+  failedIdx = p_execute_steps(steps, numDone, journal_fp, GIMP_RUN_NONINTERACTIVE, &destExists);
+  if(journal_fp != NULL)
+  {
+    fclose(journal_fp);
+  }
+  if(failedIdx >= 0)
+  {
+    gchar *tmp_errtxt;
+
+    if(destExists)
+    {
+      tmp_errtxt = g_strdup_printf(_("Error: could not rename file %s to %s\n"
+                                     "because the destination already exists.\n"
+                                     "The interrupted renames are kept in %s")
+                                  , g_array_index(steps, GapFrameRenameStep, failedIdx).from_fname
+                                  , g_array_index(steps, GapFrameRenameStep, failedIdx).to_fname
+                                  , journal_name
+                                  );
+    }
+    else
+    {
+      tmp_errtxt = g_strdup_printf(_("Error: could not rename file %s to %s")
+                                  , g_array_index(steps, GapFrameRenameStep, failedIdx).from_fname
+                                  , g_array_index(steps, GapFrameRenameStep, failedIdx).to_fname
+                                  );
+    }
+    gap_arr_msg_win(ainfo_ptr->run_mode, tmp_errtxt);
+    g_free(tmp_errtxt);
+    isOk = FALSE;
+  }
+  else
+  {
+    g_remove(journal_name);
+  }
+
+  p_free_steps(steps);
+  g_free(journal_name);
+
+  return (isOk);
+}  /* end gap_frame_rename_journal_recover */
@@ -0,0 +1,57 @@
+/*  gap_frame_rename.h
+ *
+ *  This module handles batched renaming (renumbering) of frame imagefiles
+ *  for the frame range operations (delete, duplicate, shift, reverse, renumber)
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * version 2.7.0;   2026/10/18  created
+ */
+
+#ifndef _GAP_FRAME_RENAME_H
+#define _GAP_FRAME_RENAME_H
+
+#include "libgimp/gimp.h"
+#include "gap_lib_common_defs.h"
+
+typedef struct GapFrameRenameBatch GapFrameRenameBatch;  /* opaque, nickname: rbat */
+
+
+GapFrameRenameBatch *  gap_frame_rename_batch_new(GapAnimInfo *ainfo_ptr);
+void                   gap_frame_rename_batch_add(GapFrameRenameBatch *rbat
+                           , long from_nr
+                           , long to_nr
+                           );
+void                   gap_frame_rename_batch_add_digits(GapFrameRenameBatch *rbat
+                           , long from_nr
+                           , long to_nr
+                           , long from_digits
+                           , long to_digits
+                           );
+gboolean               gap_frame_rename_batch_probe_frame_nr(GapFrameRenameBatch *rbat
+                           , long nr
+                           , long *has_digits
+                           );
+gint32                 gap_frame_rename_batch_execute(GapFrameRenameBatch *rbat);
+void                   gap_frame_rename_batch_free(GapFrameRenameBatch *rbat);
+
+gboolean               gap_frame_rename_journal_recover(GapAnimInfo *ainfo_ptr);
+
+#endif
@@ -0,0 +1,517 @@
+/* gap_frame_rename_bench.c
+ *
+ * GAP ... Gimp Animation Plugins
+ *
+ * check and benchmark for the batched frame renaming (gap_frame_rename.c)
+ *
+ * Frame directories are generated with a fixed seed (each frame file
+ * contains its original frame number) and renamed by one batch:
+ *   a) plan: reverse, rotate (cycles) and shift (chain to free numbers)
+ *      of random frame ranges with 6 or 4 digits. The frames must end up
+ *      at their new numbers (in the digit style of the source), and the batch
+ *      must take one rename per moved frame plus one per cycle.
+ *   b) failures: the rename call number k fails
+ *        - before renaming (rename error)
+ *        - after renaming, before the journal mark is written (interrupted process).
+ *      gap_frame_rename_batch_execute must report the error and keep the journal,
+ *      gap_frame_rename_journal_recover must complete the renames.
+ *   In all cases no temporary file and no journal may be left.
+ *
+ * usage:
+ *   gap_frame_rename_bench             check with 300 random batches (run by make check)
+ *   gap_frame_rename_bench -b [n]      check and benchmark (rotate and reverse
+ *                                      of n frames, default 2000)
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * 2026.10.18  created
+ */
+
+/* included (not linked) to configure the frame index
+ * and to replace g_rename and the thumbnail handling of the batch
+ */
+#include "gap_frame_index.c"
+
+#include <glib/gstdio.h>
+#include "gap_thumbnail.h"
+
+#undef  g_rename
+#define g_rename                         p_bench_rename
+#define gap_thumb_file_rename_thumbnail  p_bench_rename_thumbnail
+
+static int p_bench_rename(const gchar *oldfilename, const gchar *newfilename);
+static void p_bench_rename_thumbnail(char *filename_src, char *filename_dst);
+
+#include "gap_frame_rename.c"
+
+#include <utime.h>
+
+#define BENCH_ROUNDS     300
+#define BENCH_MAX_FRAMES  40
+
+int gap_debug = 0;  /* 1 == print debug infos , 0 dont print debug infos */
+
+typedef enum
+{
+  BENCH_FAIL_NONE,
+  BENCH_FAIL_BEFORE_RENAME,     /* g_rename fails */
+  BENCH_FAIL_AFTER_RENAME       /* the process is interrupted before the journal mark */
+} BenchFailMode;
+
+static const char *kindNames[] = { "reverse", "rotate", "shift" };
+
+static BenchFailMode  benchFailMode = BENCH_FAIL_NONE;
+static gint32         benchFailAt = -1;
+static gint32         benchRenameCalls = 0;
+
+
+/* ---------------------------------
+ * p_bench_rename
+ * ---------------------------------
+ * g_rename with failure injection at rename call number benchFailAt
+ */
+static int
+p_bench_rename(const gchar *oldfilename, const gchar *newfilename)
+{
+  gint32 callNr;
+
+  callNr = benchRenameCalls;
+  benchRenameCalls++;
+  if((benchFailMode != BENCH_FAIL_NONE) && (callNr == benchFailAt))
+  {
+    if(benchFailMode == BENCH_FAIL_AFTER_RENAME)
+    {
+      rename(oldfilename, newfilename);
+    }
+    return (-1);
+  }
+  return (rename(oldfilename, newfilename));
+}  /* end p_bench_rename */
+
+
+/* ---------------------------------
+ * p_bench_rename_thumbnail
+ * ---------------------------------
+ * the test frames have no thumbnails
+ * (and the gimprc thumbnail settings are not available without gimp)
+ */
+static void
+p_bench_rename_thumbnail(char *filename_src, char *filename_dst)
+{
+}  /* end p_bench_rename_thumbnail */
+
+
+/* ---------------------------------
+ * p_write_frame
+ * ---------------------------------
+ */
+static gboolean
+p_write_frame(const char *basename, long nr, gint digits)
+{
+  gchar   *filename;
+  FILE    *fp;
+
+  filename = g_strdup_printf("%s%0*ld.xcf", basename, digits, nr);
+  fp = g_fopen(filename, "wb");
+  g_free(filename);
+  if(fp == NULL)
+  {
+    return (FALSE);
+  }
+  fprintf(fp, "%ld\n", nr);
+  fclose(fp);
+  return (TRUE);
+}  /* end p_write_frame */
+
+
+/* ---------------------------------
+ * p_read_frame
+ * ---------------------------------
+ * returns the original frame number stored in frame nr
+ * or -1 if frame nr does not exist
+ */
+static long
+p_read_frame(const char *basename, long nr, gint digits)
+{
+  gchar   *filename;
+  FILE    *fp;
+  long     origNr;
+
+  origNr = -1;
+  filename = g_strdup_printf("%s%0*ld.xcf", basename, digits, nr);
+  fp = g_fopen(filename, "rb");
+  g_free(filename);
+  if(fp != NULL)
+  {
+    if(fscanf(fp, "%ld", &origNr) != 1)
+    {
+      origNr = -1;
+    }
+    fclose(fp);
+  }
+  return (origNr);
+}  /* end p_read_frame */
+
+
+/* ---------------------------------
+ * p_set_dir_mtime
+ * ---------------------------------
+ */
+static void
+p_set_dir_mtime(const char *dirname, time_t mtime)
+{
+  struct utimbuf  ut;
+
+  ut.actime = mtime;
+  ut.modtime = mtime;
+  g_utime(dirname, &ut);
+}  /* end p_set_dir_mtime */
+
+
+/* ---------------------------------
+ * p_remove_dir_files
+ * ---------------------------------
+ * remove all files in dirname,
+ * returns the number of files that are not frames (temporary files, journal)
+ */
+static gint32
+p_remove_dir_files(const char *dirname)
+{
+  GDir         *l_dirp;
+  const gchar  *l_entry;
+  gint32        numOther;
+
+  numOther = 0;
+  l_dirp = g_dir_open(dirname, 0, NULL);
+  if(l_dirp == NULL)
+  {
+    return (0);
+  }
+  while((l_entry = g_dir_read_name(l_dirp)) != NULL)
+  {
+    gchar *fullname;
+
+    if(!g_str_has_suffix(l_entry, ".xcf"))
+    {
+      printf("left over file: %s\n", l_entry);
+      numOther++;
+    }
+    fullname = g_build_filename(dirname, l_entry, NULL);
+    g_remove(fullname);
+    g_free(fullname);
+  }
+  g_dir_close(l_dirp);
+
+  return (numOther);
+}  /* end p_remove_dir_files */
+
+
+/* ---------------------------------
+ * p_build_map
+ * ---------------------------------
+ * map[nr] is the new number of frame nr (1 <= nr <= numFrames)
+ * returns the number of cycles (each cycle needs one extra rename).
+ */
+static gint32
+p_build_map(GRand *rand, gint kind, long *map, long numFrames)
+{
+  gboolean *visited;
+  gint32    numCycles;
+  long      shift;
+  long      nr;
+
+  shift = g_rand_int_range(rand, 1, MAX(2, numFrames));
+  for(nr = 1; nr <= numFrames; nr++)
+  {
+    switch(kind)
+    {
+      case 0:  map[nr] = numFrames + 1 - nr;                  break;
+      case 1:  map[nr] = ((nr - 1 + shift) % numFrames) + 1;  break;
+      default: map[nr] = nr + (shift % 5) + 1;                break;
+    }
+  }
+
+  /* count the cycles of the moved frames */
+  visited = g_new0(gboolean, numFrames + 1);
+  numCycles = 0;
+  for(nr = 1; nr <= numFrames; nr++)
+  {
+    long kk;
+
+    if((visited[nr]) || (map[nr] == nr))
+    {
+      continue;
+    }
+    for(kk = nr; (kk >= 1) && (kk <= numFrames) && (!visited[kk]); kk = map[kk])
+    {
+      visited[kk] = TRUE;
+    }
+    if(kk == nr)
+    {
+      numCycles++;
+    }
+  }
+  g_free(visited);
+
+  return (numCycles);
+}  /* end p_build_map */
+
+
+/* ---------------------------------
+ * p_init_ainfo
+ * ---------------------------------
+ */
+static void
+p_init_ainfo(GapAnimInfo *ainfo_ptr, char *basename)
+{
+  memset(ainfo_ptr, 0, sizeof(GapAnimInfo));
+  ainfo_ptr->basename = basename;
+  ainfo_ptr->extension = ".xcf";
+  ainfo_ptr->run_mode = GIMP_RUN_NONINTERACTIVE;
+}  /* end p_init_ainfo */
+
+
+/* ---------------------------------
+ * p_run_batch
+ * ---------------------------------
+ * write numFrames frames, rename them by one batch of the specified kind
+ * (with failure injection) and check the result.
+ * returns the number of errors.
+ */
+static gint32
+p_run_batch(GRand *rand, const char *label, char *basename, const char *dirname
+  , gint kind, long numFrames, gint digits, BenchFailMode failMode, gdouble *elapsed)
+{
+  GapFrameRenameBatch *rbat;
+  GapAnimInfo  ainfo;
+  GTimer      *timer;
+  long        *map;
+  long        *expected;
+  long         maxNr;
+  long         nr;
+  gint32       numCycles;
+  gint32       numMoved;
+  gint32       rc;
+  gint32       errors;
+
+  errors = 0;
+  maxNr = numFrames + 6;
+  map = g_new0(long, numFrames + 1);
+  expected = g_new(long, maxNr + 1);
+  numCycles = p_build_map(rand, kind, map, numFrames);
+  numMoved = 0;
+  for(nr = 0; nr <= maxNr; nr++)
+  {
+    expected[nr] = -1;
+  }
+  for(nr = 1; nr <= numFrames; nr++)
+  {
+    p_write_frame(basename, nr, digits);
+    expected[map[nr]] = nr;
+    if(map[nr] != nr)
+    {
+      numMoved++;
+    }
+  }
+
+  /* the directory must be older than GAP_FRAME_INDEX_RACY_SECS to use the snapshot,
+   * the index of the previous batch is dropped (as in a new plug-in process)
+   */
+  p_set_dir_mtime(dirname, time(NULL) - 100);
+  if(frameIndexTable != NULL)
+  {
+    g_hash_table_remove_all(frameIndexTable);
+  }
+
+  p_init_ainfo(&ainfo, basename);
+  benchFailMode = failMode;
+  benchFailAt = g_rand_int_range(rand, 0, numMoved + numCycles);
+  benchRenameCalls = 0;
+
+  timer = g_timer_new();
+  rbat = gap_frame_rename_batch_new(&ainfo);
+  for(nr = 1; nr <= numFrames; nr++)
+  {
+    gap_frame_rename_batch_add(rbat, nr, map[nr]);
+  }
+  rc = gap_frame_rename_batch_execute(rbat);
+  gap_frame_rename_batch_free(rbat);
+  if(elapsed != NULL)
+  {
+    *elapsed = g_timer_elapsed(timer, NULL);
+  }
+  g_timer_destroy(timer);
+
+  if(failMode == BENCH_FAIL_NONE)
+  {
+    if(rc != 0)
+    {
+      printf("%s: %s of %ld frames failed\n", label, kindNames[kind], numFrames);
+      errors++;
+    }
+    if(benchRenameCalls != numMoved + numCycles)
+    {
+      printf("%s: %s of %ld frames took %d renames, expected %d\n"
+            , label, kindNames[kind], numFrames
+            , (int)benchRenameCalls, (int)(numMoved + numCycles));
+      errors++;
+    }
+  }
+  else
+  {
+    gchar *journal_name;
+
+    journal_name = p_alloc_journal_name(&ainfo);
+    if((rc == 0) || (!g_file_test(journal_name, G_FILE_TEST_EXISTS)))
+    {
+      printf("%s: %s of %ld frames, rename %d failed: error not reported or journal missing\n"
+            , label, kindNames[kind], numFrames, (int)benchFailAt);
+      errors++;
+    }
+    g_free(journal_name);
+
+    benchFailMode = BENCH_FAIL_NONE;
+    if(gap_frame_rename_journal_recover(&ainfo) != TRUE)
+    {
+      printf("%s: %s of %ld frames, rename %d failed: recover failed\n"
+            , label, kindNames[kind], numFrames, (int)benchFailAt);
+      errors++;
+    }
+  }
+
+  for(nr = 1; nr <= maxNr; nr++)
+  {
+    long origNr;
+
+    origNr = p_read_frame(basename, nr, digits);
+    if(origNr != expected[nr])
+    {
+      if(errors < 10)
+      {
+        printf("%s: %s of %ld frames: MISMATCH frame %ld contains %ld, expected %ld\n"
+              , label, kindNames[kind], numFrames, nr, origNr, expected[nr]);
+      }
+      errors++;
+    }
+  }
+  errors += p_remove_dir_files(dirname);
+
+  g_free(map);
+  g_free(expected);
+
+  return (errors);
+}  /* end p_run_batch */
+
+
+/* ---------------------------------
+ * main
+ * ---------------------------------
+ */
+int
+main(int argc, char *argv[])
+{
+  GRand    *rand;
+  gchar    *tmpname;
+  gchar    *dirname;
+  gchar    *basename;
+  gboolean  isBenchmark;
+  long      numFrames;
+  gint32    errors;
+  gint32    ii;
+
+  isBenchmark = FALSE;
+  numFrames = 2000;
+  if((argc > 1) && (strcmp(argv[1], "-b") == 0))
+  {
+    isBenchmark = TRUE;
+    if(argc > 2)
+    {
+      numFrames = MAX(10, atol(argv[2]));
+    }
+  }
+
+  tmpname = g_strdup_printf("gap_frame_rename_bench_%d", (int)getpid());
+  dirname = g_build_filename(g_get_tmp_dir(), tmpname, NULL);
+  basename = g_build_filename(dirname, "frame_", NULL);
+  g_free(tmpname);
+
+  if((g_mkdir(dirname, 0755) != 0)
+  || (p_write_frame(basename, 1, 6) != TRUE))
+  {
+    printf("could not write frames in %s, test skipped\n", dirname);
+    g_rmdir(dirname);
+    return (77);   /* automake: skipped test */
+  }
+  p_remove_dir_files(dirname);
+
+  /* the snapshots are taken by directory scan (no frame index cache on disk) */
+  frameIndexFcd.maxMB = 0;
+
+  errors = 0;
+  rand = g_rand_new_with_seed(4711);
+
+  /* a) plan,  b) failures */
+  for(ii = 0; ii < BENCH_ROUNDS; ii++)
+  {
+    BenchFailMode failMode;
+
+    failMode = (BenchFailMode)(ii % 3);
+    errors += p_run_batch(rand
+                  , (failMode == BENCH_FAIL_NONE) ? "plan" : "failures"
+                  , basename
+                  , dirname
+                  , g_rand_int_range(rand, 0, G_N_ELEMENTS(kindNames))
+                  , g_rand_int_range(rand, 2, BENCH_MAX_FRAMES + 1)
+                  , (g_rand_boolean(rand)) ? 6 : 4
+                  , failMode
+                  , NULL
+                  );
+  }
+  printf("plan and failures: %d random batches\n", (int)BENCH_ROUNDS);
+
+  if(isBenchmark)
+  {
+    gint kind;
+
+    for(kind = 0; kind < 2; kind++)
+    {
+      gdouble elapsed;
+      gint32  renames;
+
+      errors += p_run_batch(rand, "bench", basename, dirname
+                           , kind, numFrames, 6, BENCH_FAIL_NONE, &elapsed);
+      renames = benchRenameCalls;
+      printf("  %-8s %ld frames: %6d renames %9.1f ms\n"
+            , kindNames[kind], numFrames, (int)renames, elapsed * 1000.0);
+    }
+  }
+
+  g_rand_free(rand);
+  g_rmdir(dirname);
+  g_free(dirname);
+  g_free(basename);
+
+  printf("frame rename check: %s\n"
+        , (errors == 0) ? "OK" : "FAILED"
+        );
+
+  return ((errors == 0) ? 0 : 1);
+
+}  /* end main */
@@ -26,6 +26,10 @@
  */
 
 /* revision history:
+ * 2.7.0a   2026/10/18   hof: gap_lib_alloc_fname_fixed_digits no longer leaks an unused buffer per call
+ * 2.7.0a   2026/10/18   hof: p_gzip uses zlib (in-process) instead of calling the gzip program
+ * 2.7.0a   2026/10/18   hof: gap_lib_dir_ainfo, gap_lib_exists_frame_nr and gap_lib_alloc_fname6
+ *                            use the cached frame index (gap_frame_index)
  * 2.1.0a   2005/03/10   hof: added active_layer_tracking feature
  * 2.1.0a   2004/12/04   hof: added gap_lib (base)_shorten_filename
  * 2.1.0a   2004/04/18   hof: added gap_lib (base)_fprintf_gdouble
@@ -96,11 +100,13 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <fcntl.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
 
 #include <glib/gstdio.h>
+#include <zlib.h>
 
 /* GIMP includes */
 #include "gtk/gtk.h"
@@ -122,11 +128,17 @@
 #include <process.h>            /* For _getpid() */
 #endif
 
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
 /* GAP includes */
 #include "gap_arr_dialog.h"
+#include "gap_frame_index.h"
 #include "gap_image.h"
 #include "gap_layer_copy.h"
 #include "gap_lib.h"
+#include "gap_libgapbase.h"
 #include "gap_lock.h"
 #include "gap_navi_activtable.h"
 #include "gap_onion_base.h"
@@ -1142,11 +1154,8 @@ char*
 gap_lib_alloc_fname_fixed_digits(char *basename, long nr, char *extension, long digits)
 {
   gchar *l_fname;
-  gint   l_len;
 
   if(basename == NULL) return (NULL);
-  l_len = (strlen(basename)  + strlen(extension) + 10);
-  l_fname = (char *)g_malloc(l_len);
 
   switch(digits)
   {
@@ -1231,6 +1240,8 @@ gap_lib_alloc_fname6(char *basename, long nr, char *extension, long default_digi
   gint   l_digits_used;
   gint   l_len;
   long   l_nr_chk;
+  long   l_digits_found;
+  gboolean l_exists;
 
   if(basename == NULL) return (NULL);
   l_len = (strlen(basename)  + strlen(extension) + 10);
@@ -1245,6 +1256,14 @@ gap_lib_alloc_fname6(char *basename, long nr, char *extension, long default_digi
         * or not                              "frame_1.xcf"
         */
        l_nr_chk = nr;
+       l_digits_found = l_digits_used;
+       l_exists = FALSE;
+       if(gap_frame_index_probe_frame_nr(basename, extension, nr, &l_digits_found, &l_exists))
+       {
+         /* answered from the up to date frame index, skip the file probes */
+         l_digits_used = l_digits_found;
+         l_nr_chk = -1;
+       }
 
        while(l_nr_chk >= 0)
        {
@@ -1374,6 +1393,7 @@ gap_lib_exists_frame_nr(GapAnimInfo *ainfo_ptr, long nr, long *l_has_digits)
   gint   l_digits_used;
   gint   l_len;
   long   l_nr_chk;
+  long   l_digits_found;
   gboolean l_exists;
 
   l_exists = FALSE;
@@ -1385,6 +1405,15 @@ gap_lib_exists_frame_nr(GapAnimInfo *ainfo_ptr, long nr, long *l_has_digits)
   l_digits_used = GAP_LIB_DEFAULT_DIGITS;
   l_nr_chk = nr;
 
+  l_digits_found = l_digits_used;
+  if(gap_frame_index_probe_frame_nr(ainfo_ptr->basename, ainfo_ptr->extension
+                                   , nr, &l_digits_found, &l_exists))
+  {
+    /* answered from the up to date frame index, skip the file probes */
+    l_digits_used = l_digits_found;
+    l_nr_chk = -1;
+  }
+
   while(l_nr_chk >= 0)
   {
      /* check if frame is on disk with 6-digit style framenumber */
@@ -1672,6 +1701,8 @@ gap_lib_alloc_ainfo(gint32 image_id, GimpRunMode run_mode)
  * - frame_cnt
  *
  * to get this information, the directory entries have to be checked
+ * (the results are kept in the frame index and reused
+ * as long as the directory is not modified)
  * ============================================================================
  */
 int
@@ -1690,6 +1721,12 @@ gap_lib_dir_ainfo(GapAnimInfo *ainfo_ptr)
    short          l_dirflag;
    char           dirname_buff[1024];
 
+   if(gap_frame_index_dir_ainfo(ainfo_ptr))
+   {
+     /* got the frame numbers from the up to date frame index (process local, stored on disk or freshly scanned) */
+     return 0;         /* OK */
+   }
+
    ainfo_ptr->frame_cnt = 0;
    l_dirp = NULL;
    l_minnr = 99999999;
@@ -1967,52 +2004,146 @@ gap_lib_chk_framerange(GapAnimInfo *ainfo_ptr)
  *   gzip or gunzip the file to a temporary file.
  *   zip == "zip"    compress
  *   zip == "unzip"  decompress
- *   return a pointer to the temporary created (by gzip) file.
+ *   return a pointer to the temporary created file.
  *          NULL  in case of errors
+ *
+ *   (the file is processed in-process by zlib, the gzip program is not used.
+ *    like gzip -cfd the unzip mode copies files that are not gzip compressed
+ *    unchanged. The compression level for zip is taken from
+ *    the gimprc option video-frame-gzip-level)
  * ============================================================================
  */
 char *
 p_gzip (char *orig_name, char *new_name, char *zip)
 {
-  gchar*   l_cmd;
-  gchar*   l_tmpname;
-  gint     l_rc, l_rc2;
+#define GAP_GZIP_BUFSIZE 65536
+  gchar   *l_buf;
+  gchar    l_mode[8];
+  gzFile   l_gz;
+  FILE    *l_fp;
+  gint     l_fd;
+  gint     l_len;
+  gint     l_level;
+  int      l_zerr;
+  gboolean l_ok;
 
   if(zip == NULL) return NULL;
 
-  l_cmd = NULL;
-  l_tmpname = new_name;
-
-  /* used gzip options:
-   *     -c --stdout --to-stdout
-   *          Write  output  on  standard  output
-   *     -d --decompress --uncompress
-   *          Decompress.
-   *     -f --force
-   *           Force compression or decompression even if the file
-   */
+  l_ok = FALSE;
+  l_buf = g_malloc(GAP_GZIP_BUFSIZE);
 
   if(*zip == 'u')
   {
-    l_cmd = g_strdup_printf("gzip -cfd <\"%s\"  >\"%s\"", orig_name, l_tmpname);
+    /* gunzip orig_name ==> new_name */
+    if(gap_debug) printf("p_gzip: unzip %s to %s\n", orig_name, new_name);
+
+    l_fd = g_open(orig_name, O_RDONLY | O_BINARY, 0);
+    l_gz = (l_fd < 0) ? NULL : gzdopen(l_fd, "rb");
+    if(l_gz == NULL)
+    {
+      if(l_fd >= 0) close(l_fd);
+      fprintf(stderr, "ERROR p_gzip: can't open %s for read\n", orig_name);
+    }
+    else
+    {
+      l_fp = g_fopen(new_name, "wb");
+      if(l_fp == NULL)
+      {
+        fprintf(stderr, "ERROR p_gzip: can't create %s\n", new_name);
+      }
+      else
+      {
+        l_ok = TRUE;
+        while((l_len = gzread(l_gz, l_buf, GAP_GZIP_BUFSIZE)) > 0)
+        {
+          if(fwrite(l_buf, 1, l_len, l_fp) != (size_t)l_len)
+          {
+            fprintf(stderr, "ERROR p_gzip: write failed on %s\n", new_name);
+            l_ok = FALSE;
+            break;
+          }
+        }
+        gzerror(l_gz, &l_zerr);
+        if((l_len < 0) || ((l_zerr != Z_OK) && (l_zerr != Z_STREAM_END)))
+        {
+          /* corrupted or truncated (Z_BUF_ERROR) compressed data */
+          fprintf(stderr, "ERROR p_gzip: %s is corrupted\n", orig_name);
+          l_ok = FALSE;
+        }
+        if(fclose(l_fp) != 0)
+        {
+          l_ok = FALSE;
+        }
+      }
+      gzclose(l_gz);
+    }
   }
   else
   {
-    l_cmd = g_strdup_printf("gzip -cf  <\"%s\"  >\"%s\"", orig_name, l_tmpname);
+    /* gzip orig_name ==> new_name */
+    l_level = gap_base_get_gimprc_int_value("video-frame-gzip-level"
+                 , Z_DEFAULT_COMPRESSION
+                 , Z_DEFAULT_COMPRESSION
+                 , Z_BEST_COMPRESSION
+                 );
+    if(l_level == Z_DEFAULT_COMPRESSION)
+    {
+      g_snprintf(l_mode, sizeof(l_mode), "wb");
+    }
+    else
+    {
+      g_snprintf(l_mode, sizeof(l_mode), "wb%d", (int)l_level);
+    }
+    if(gap_debug) printf("p_gzip: zip %s to %s mode:%s\n", orig_name, new_name, l_mode);
+
+    l_fp = g_fopen(orig_name, "rb");
+    if(l_fp == NULL)
+    {
+      fprintf(stderr, "ERROR p_gzip: can't open %s for read\n", orig_name);
+    }
+    else
+    {
+      l_fd = g_open(new_name, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
+      l_gz = (l_fd < 0) ? NULL : gzdopen(l_fd, l_mode);
+      if(l_gz == NULL)
+      {
+        if(l_fd >= 0) close(l_fd);
+        fprintf(stderr, "ERROR p_gzip: can't create %s\n", new_name);
+      }
+      else
+      {
+        l_ok = TRUE;
+        while((l_len = fread(l_buf, 1, GAP_GZIP_BUFSIZE, l_fp)) > 0)
+        {
+          if(gzwrite(l_gz, l_buf, l_len) != l_len)
+          {
+            fprintf(stderr, "ERROR p_gzip: write failed on %s\n", new_name);
+            l_ok = FALSE;
+            break;
+          }
+        }
+        if(ferror(l_fp))
+        {
+          fprintf(stderr, "ERROR p_gzip: read failed on %s\n", orig_name);
+          l_ok = FALSE;
+        }
+        if(gzclose(l_gz) != Z_OK)
+        {
+          l_ok = FALSE;
+        }
+      }
+      fclose(l_fp);
+    }
   }
 
-  if(gap_debug) printf("system: %s\n", l_cmd);
+  g_free(l_buf);
 
-  l_rc = system(l_cmd);
-  if(l_rc != 0)
+  if(!l_ok)
   {
-     /* Shift 8 Bits gets Retcode of the executed Program */
-     l_rc2 = l_rc >> 8;
-     fprintf(stderr, "ERROR system: %s\nreturncodes %d %d", l_cmd, l_rc, l_rc2);
-     l_tmpname = NULL;
+    g_remove(new_name);
+    return NULL;
   }
-  g_free(l_cmd);
-  return l_tmpname;
+  return new_name;
 
 }       /* end p_gzip */
 
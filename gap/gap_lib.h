@@ -103,6 +103,7 @@ gint32 gap_vid_edit_paste(GimpRunMode run_mode, gint32 image_id, long paste_mode
 gboolean gap_lib_gap_check_save_needed(gint32 image_id);
 
 int      gap_lib_rename_frame(GapAnimInfo *ainfo_ptr, long from_nr, long to_nr);
+long     gap_lib_count_framenumber_digits(const char *imagename);
 int      gap_lib_delete_frame(GapAnimInfo *ainfo_ptr, long nr);
 gint32   gap_lib_replace_image(GapAnimInfo *ainfo_ptr);
 
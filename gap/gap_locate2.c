@@ -24,6 +24,13 @@
 
 /* revision history:
  * version 2.7.0;             hof: created
+ * version 2.7.0;  2026/10/18 the reference area and the target search window are read
+ *                            once into contiguous buffers (instead of pixel region
+ *                            processing per attempted offset).
+ *                            coarse to fine pyramid search provides a bound for early
+ *                            cancel of the attempts at full resolution.
+ * version 2.7.0;  2026/10/18 sum of RGBA differences per row with an SSE2 kernel
+ *                            (psadbw) that is selected at runtime on x86 CPUs.
  */
 
 /* SYTEM (UNIX) includes */
@@ -35,14 +42,48 @@
 #include "libgimp/gimp.h"
 
 /* GAP includes */
-#include "gap_pixelrgn.h"
 #include "gap_locate2.h"
 
 #define MAX_DIFF_VALUE_PER_PIXEL  (255.0 + 255.0 + 255.0)
 #define OPACITY_LEVEL_UCHAR 50
 
+/* pyramid search settings
+ * the coarsest level keeps at least GAP_LOCATE_PYRAMID_MIN_SHAPE_RADIUS pixels
+ * of the reference shape radius.
+ */
+#define GAP_LOCATE_PYRAMID_MAX_LEVEL          3
+#define GAP_LOCATE_PYRAMID_MIN_SHAPE_RADIUS   4
+#define GAP_LOCATE_PYRAMID_CANDIDATES         4
+#define GAP_LOCATE_PYRAMID_BPP                4
+
+/* the vector implementation requires gcc >= 4.9 (target attributes with intrinsics)
+ * and an x86 CPU
+ */
+#if defined(__GNUC__) && !defined(__clang__) \
+ && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))) \
+ && (defined(__x86_64__) || defined(__i386__))
+#define GAP_LOCATE_SIMD_X86 1
+#include <immintrin.h>
+#define GAP_LOCATE_TARGET_SSE2   __attribute__((target("sse2")))
+#endif
+
 extern int gap_debug;
 
+static gboolean  simdInitialized = FALSE;
+static gboolean  simdSse2 = FALSE;
+
+typedef struct PyramidLevel {
+  guchar   *data;                   /* RGBA pixels, GAP_LOCATE_PYRAMID_BPP */
+  gint32    width;
+  gint32    height;
+} PyramidLevel;
+
+typedef struct PyramidCandidate {
+  gint32    dx;                     /* offset relative to the search center at the level */
+  gint32    dy;
+  gdouble   avgDiff;
+} PyramidCandidate;
+
 typedef struct Context {
   gint32    refShapeRadius;
   gint32    refX;
@@ -63,9 +104,28 @@ typedef struct Context {
   gdouble bestMatchingSumDiffValue; /* summ of the RGB channel differences of the best matching attempt */
   gdouble veryNearDistance;         /* square of near radius to stop evaluation when exactly matching area is detected */
   gdouble bestMatchingAvgColordiff; /* average colordiff at best matching attempt */
+  gdouble seedSumDiffValue;         /* summ of the RGB channel differences of the best pyramid search candidate */
   GimpDrawable *refDrawable;
   GimpDrawable *targetDrawable;
-  
+
+  /* the reference area (rx1, ry1, rWidth, rHeight) in the refDrawable */
+  gint32    rx1;
+  gint32    ry1;
+  gint32    rWidth;
+  gint32    rHeight;
+  gint32    leftShapeRadius;
+  gint32    upperShapeRadius;
+  guchar   *refBuf;
+  gint32    refBpp;
+
+  /* the target search window (wx1, wy1, wWidth, wHeight) in the targetDrawable */
+  gint32    wx1;
+  gint32    wy1;
+  gint32    wWidth;
+  gint32    wHeight;
+  guchar   *targetBuf;
+  gint32    targetBpp;
+
 } Context;
 
 
@@ -92,120 +152,269 @@ p_calculate_average_colordiff(gdouble sumDiffValue, gint32 pixelCount)
 
 
 /* ---------------------------------
- * p_compare_regions
+ * p_simd_init
+ * ---------------------------------
+ * check the capabilities of the CPU (once)
+ */
+static void
+p_simd_init(void)
+{
+  if(simdInitialized)
+  {
+    return;
+  }
+
+#ifdef GAP_LOCATE_SIMD_X86
+  __builtin_cpu_init();
+  simdSse2 = (__builtin_cpu_supports("sse2") != 0);
+#endif
+
+  if(gap_debug)
+  {
+    printf("gap_locate2: sse2:%d\n", (int)simdSse2);
+  }
+  simdInitialized = TRUE;
+
+}  /* end p_simd_init */
+
+
+/* ---------------------------------
+ * p_scalar_sum_diff_rgba_row
+ * ---------------------------------
+ * add the RGB channel differences of the pixels startCol .. width -1
+ * of one RGBA row where reference and target pixel are both opaque
+ * to rowSumDiff and the number of those pixels to rowPixelCount.
+ * (this is the reference implementation)
+ */
+static inline void
+p_scalar_sum_diff_rgba_row(const guchar *ref, const guchar *target
+                  , gint32 startCol, gint32 width
+                  , guint32 *rowSumDiff, gint32 *rowPixelCount)
+{
+  const guchar *refPtr;
+  const guchar *targetPtr;
+  gint32  col;
+  guint32 sumDiff;
+  gint32  pixelCount;
+
+  refPtr = ref + (startCol * 4);
+  targetPtr = target + (startCol * 4);
+  sumDiff = 0;
+  pixelCount = 0;
+
+  /* branch free loop on contiguous rows */
+  for(col = startCol; col < width; col++)
+  {
+    guint32 isCompareable;
+    guint32 diff;
+
+    isCompareable = ((refPtr[3] >= OPACITY_LEVEL_UCHAR) & (targetPtr[3] >= OPACITY_LEVEL_UCHAR));
+    diff = abs(refPtr[0] - targetPtr[0])
+         + abs(refPtr[1] - targetPtr[1])
+         + abs(refPtr[2] - targetPtr[2]);
+    sumDiff += isCompareable * diff;
+    pixelCount += isCompareable;
+    refPtr += 4;
+    targetPtr += 4;
+  }
+
+  *rowSumDiff += sumDiff;
+  *rowPixelCount += pixelCount;
+
+}  /* end p_scalar_sum_diff_rgba_row */
+
+
+#ifdef GAP_LOCATE_SIMD_X86
+/* ---------------------------------
+ * p_sse2_sum_diff_rgba_row
+ * ---------------------------------
+ * SSE2 version of p_scalar_sum_diff_rgba_row for 4 pixels per step.
+ * The absolute byte differences are masked (pand) to the RGB channels
+ * of the pixels where both alpha bytes are >= OPACITY_LEVEL_UCHAR
+ * and summed up by psadbw.
+ * returns the number of handled pixels (a multiple of 4),
+ * the remaining pixels must be handled by p_scalar_sum_diff_rgba_row.
+ */
+static gint32 GAP_LOCATE_TARGET_SSE2
+p_sse2_sum_diff_rgba_row(const guchar *ref, const guchar *target, gint32 width
+                  , guint32 *rowSumDiff, gint32 *rowPixelCount)
+{
+  __m128i opacityLevel;
+  __m128i alphaMask;
+  __m128i rgbMask;
+  __m128i sumAcc;
+  __m128i countAcc;
+  gint32  col;
+  guint32 sumLanes[4];
+  gint32  countLanes[4];
+
+  opacityLevel = _mm_set1_epi8((char)OPACITY_LEVEL_UCHAR);
+  alphaMask = _mm_set1_epi32((gint32)0xff000000);
+  rgbMask = _mm_set1_epi32(0x00ffffff);
+  sumAcc = _mm_setzero_si128();
+  countAcc = _mm_setzero_si128();
+
+  for(col = 0; col + 4 <= width; col += 4)
+  {
+    __m128i r;
+    __m128i t;
+    __m128i absDiff;
+    __m128i isOpaque;
+    __m128i isCompareable;
+
+    r = _mm_loadu_si128((const __m128i *)(ref + (col * 4)));
+    t = _mm_loadu_si128((const __m128i *)(target + (col * 4)));
+
+    /* |r - t| per byte */
+    absDiff = _mm_or_si128(_mm_subs_epu8(r, t), _mm_subs_epu8(t, r));
+
+    /* 0xff in the alpha byte where both pixels are opaque (unsigned compare via max) */
+    isOpaque = _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(r, opacityLevel), r)
+                           , _mm_cmpeq_epi8(_mm_max_epu8(t, opacityLevel), t));
+    /* spread the alpha byte to all 32 bits of the pixel (0 or -1) */
+    isCompareable = _mm_srai_epi32(_mm_and_si128(isOpaque, alphaMask), 31);
+
+    absDiff = _mm_and_si128(absDiff, _mm_and_si128(isCompareable, rgbMask));
+    sumAcc = _mm_add_epi64(sumAcc, _mm_sad_epu8(absDiff, _mm_setzero_si128()));
+    countAcc = _mm_sub_epi32(countAcc, isCompareable);
+  }
+
+  _mm_storeu_si128((__m128i *)sumLanes, sumAcc);
+  _mm_storeu_si128((__m128i *)countLanes, countAcc);
+
+  /* the 64 bit sums of psadbw are in the lanes 0 and 2 */
+  *rowSumDiff += sumLanes[0] + sumLanes[2];
+  *rowPixelCount += countLanes[0] + countLanes[1] + countLanes[2] + countLanes[3];
+
+  return (col);
+
+}  /* end p_sse2_sum_diff_rgba_row */
+#endif
+
+
+/* ---------------------------------
+ * p_sum_diff_rgba_row
+ * ---------------------------------
+ * sum of the RGB channel differences of one RGBA row
+ * (with the best implementation the CPU supports)
+ */
+static inline void
+p_sum_diff_rgba_row(const guchar *ref, const guchar *target, gint32 width
+                  , guint32 *rowSumDiff, gint32 *rowPixelCount)
+{
+  gint32 col;
+
+  col = 0;
+#ifdef GAP_LOCATE_SIMD_X86
+  if(simdSse2)
+  {
+    col = p_sse2_sum_diff_rgba_row(ref, target, width, rowSumDiff, rowPixelCount);
+  }
+#endif
+  /* remaining columns (or all columns on CPUs without vector support) */
+  p_scalar_sum_diff_rgba_row(ref, target, col, width, rowSumDiff, rowPixelCount);
+
+}  /* end p_sum_diff_rgba_row */
+
+
+/* ---------------------------------
+ * p_compare_buffers
  * ---------------------------------
  * calculate summary Colorvalues difference for all opaque pixels
- * in the compared area region.
+ * in the compared area of width x height pixels
+ * (ref and target point to the upper left pixel of the compared area
+ * in the contiguous reference and target buffers)
+ * The current attempt is canceled as soon as the summary exceeds cancelSumDiffValue.
+ * (the sum only grows, therefore a canceled attempt can not become the best match)
  */
 static void
-p_compare_regions (const GimpPixelRgn *refPR
-                  ,const GimpPixelRgn *targetPR
+p_compare_buffers (const guchar *ref
+                  ,const guchar *target
+                  ,gint32 width
+                  ,gint32 height
+                  ,gdouble cancelSumDiffValue
                   ,Context *context)
 {
-  guint    row;
-  guchar*  ref = refPR->data;   /* the reference drawable */
-  guchar*  target = targetPR->data;   /* the target drawable */
-
-//   if(gap_debug)
-//   {
-//     printf("region REF x:%d y:%d w:%d h:%d  TARGET x:%d y:%d w:%d h:%d   px:%d py:%d\n"
-//        , (int)refPR->x
-//        , (int)refPR->y
-//        , (int)refPR->w
-//        , (int)refPR->h
-//        , (int)targetPR->x
-//        , (int)targetPR->y
-//        , (int)targetPR->w
-//        , (int)targetPR->h
-//        , (int)context->px
-//        , (int)context->py
-//        );
-//   }
-
-
-  for (row = 0; row < targetPR->h; row++)
-  {
-    guint  col;
-    guint  idxref;
-    guint  idxtarget;
-    
-    if (row >= refPR->h)
+  gint32   row;
+  gint32   refBpp;
+  gint32   targetBpp;
+  gint32   refRowstride;
+  gint32   targetRowstride;
+
+  refBpp = context->refBpp;
+  targetBpp = context->targetBpp;
+  refRowstride = context->rWidth * refBpp;
+  targetRowstride = context->wWidth * targetBpp;
+
+  for (row = 0; row < height; row++)
+  {
+    const guchar *refPtr;
+    const guchar *targetPtr;
+    gint32  col;
+    guint32 rowSumDiff;
+    gint32  rowPixelCount;
+
+    refPtr = ref;
+    targetPtr = target;
+    rowSumDiff = 0;
+    rowPixelCount = 0;
+
+    if ((refBpp == 4) && (targetBpp == 4))
     {
-      continue;
+      /* RGBA against RGBA */
+      p_sum_diff_rgba_row(ref, target, width, &rowSumDiff, &rowPixelCount);
     }
-
-    idxref = 0;
-    idxtarget = 0;
-    for(col = 0; col < targetPR->w; col++)
+    else
     {
-      gboolean isCompareable;
-      
-      isCompareable = TRUE;
-      
-      if (col < refPR->w)
+      for(col = 0; col < width; col++)
       {
-        if(refPR->bpp > 3)
+        gboolean isCompareable;
+
+        isCompareable = TRUE;
+        if(refBpp > 3)
         {
-          if(ref[idxref +3] < OPACITY_LEVEL_UCHAR)
+          if(refPtr[3] < OPACITY_LEVEL_UCHAR)
           {
             /* transparent reference pixel is not compared */
             isCompareable = FALSE;
           }
         }
-      }
-      else
-      {
-        isCompareable = FALSE;
-      }
-      
-
-
-      if(targetPR->bpp > 3)
-      {
-        if(target[idxtarget +3] < OPACITY_LEVEL_UCHAR)
+        if(targetBpp > 3)
         {
-          /* transparent target pixel is not compared */
-          isCompareable = FALSE;
+          if(targetPtr[3] < OPACITY_LEVEL_UCHAR)
+          {
+            /* transparent target pixel is not compared */
+            isCompareable = FALSE;
+          }
         }
-      }
-
-      if (isCompareable == TRUE)
-      {
-        context->involvedPixelCount += 1;
-        context->sumDiffValue += abs(ref[idxref]    - target[idxtarget]);
-        context->sumDiffValue += abs(ref[idxref +1] - target[idxtarget +1]);
-        context->sumDiffValue += abs(ref[idxref +2] - target[idxtarget +2]);
-
-        if (context->sumDiffValue > context->bestMatchingSumDiffValue)
+        if (isCompareable == TRUE)
         {
-          gdouble avgColodiff;
-          
-          avgColodiff =
-              p_calculate_average_colordiff(context->sumDiffValue
-                                          , context->involvedPixelCount
-                                          );
-          if(avgColodiff > context->bestMatchingAvgColordiff)
-          {
-            /* stop evaluating area at current offset on worse results */
-            context->cancelAttemptFlag = TRUE;
-            context->cancelAttemptCount += 1;
-            return;
-          }                               
+          rowPixelCount += 1;
+          rowSumDiff += abs(refPtr[0] - targetPtr[0]);
+          rowSumDiff += abs(refPtr[1] - targetPtr[1]);
+          rowSumDiff += abs(refPtr[2] - targetPtr[2]);
         }
-
-        
+        refPtr += refBpp;
+        targetPtr += targetBpp;
       }
-
-      idxref    += refPR->bpp;
-      idxtarget += targetPR->bpp;
     }
 
-    ref += refPR->rowstride;
-    target += targetPR->rowstride;
+    context->involvedPixelCount += rowPixelCount;
+    context->sumDiffValue += rowSumDiff;
+
+    if (context->sumDiffValue > cancelSumDiffValue)
+    {
+      /* stop evaluating area at current offset on worse results */
+      context->cancelAttemptFlag = TRUE;
+      context->cancelAttemptCount += 1;
+      return;
+    }
 
+    ref += refRowstride;
+    target += targetRowstride;
   }
 
-}  /* end p_compare_regions */
+}  /* end p_compare_buffers */
 
 
 /* ---------------------------------
@@ -227,30 +436,151 @@ p_calculate_distance_to_ref_coord(Context *context, gint32 px, gint32 py)
 
 
 /* --------------------------------------------
- * p_attempt_locate_at_current_offset
+ * p_compare_at_offset
  * --------------------------------------------
+ * compare the reference area against the target area at offset px/py
+ * at full resolution. the result is delivered in context->sumDiffValue
+ * and context->involvedPixelCount (context->cancelAttemptFlag is set
+ * when the comparison was canceled because sumDiffValue exceeds cancelSumDiffValue)
+ * returns FALSE if there is no intersecting area at this offset.
  */
-void
-p_attempt_locate_at_current_offset(Context *context, gint32 px, gint32 py)
+static gboolean
+p_compare_at_offset(Context *context, gint32 px, gint32 py, gdouble cancelSumDiffValue)
 {
-  GimpPixelRgn refPR;
-  GimpPixelRgn targetPR;
-  gpointer  pr;
-  gint      rx1, ry1, rWidth, rHeight;
   gint      tx1, ty1, tWidth, tHeight;
-  gint      commonAreaWidth, commonAreaHeight;
   gboolean  isIntersect;
+  const guchar *ref;
+  const guchar *target;
+
+  context->cancelAttemptFlag = FALSE;
+  context->sumDiffValue = 0;
+  context->involvedPixelCount = 0;
+
+  isIntersect =
+   gimp_rectangle_intersect((px - context->leftShapeRadius)  /* origin1 */
+                          , (py - context->upperShapeRadius)
+                          , context->rWidth               /*  width1 */
+                          , context->rHeight              /* height1 */
+                          ,0
+                          ,0
+                          ,context->targetDrawable->width
+                          ,context->targetDrawable->height
+                          ,&tx1
+                          ,&ty1
+                          ,&tWidth
+                          ,&tHeight
+                          );
+  if (!isIntersect)
+  {
+    return (FALSE);
+  }
+
+  /* the intersecting target area is always inside the target search window.
+   * Note that the compared reference area starts at rx1/ry1 also in case
+   * the target area was clipped at the left or upper border.
+   */
+  ref = context->refBuf;
+  target = context->targetBuf
+         + (((ty1 - context->wy1) * context->wWidth) + (tx1 - context->wx1)) * context->targetBpp;
+
+  p_compare_buffers(ref, target, tWidth, tHeight, cancelSumDiffValue, context);
 
-  gint    leftShapeRadius;
-  gint    upperShapeRadius;
+  return (TRUE);
 
+}  /* end p_compare_at_offset */
+
+
+/* --------------------------------------------
+ * p_attempt_locate_at_current_offset
+ * --------------------------------------------
+ */
+static void
+p_attempt_locate_at_current_offset(Context *context, gint32 px, gint32 py)
+{
+  gdouble cancelSumDiffValue;
 
   if (context->isFinishedFlag)
   {
     return;
   }
 
-  /* calculate processing relevant interecting reference / target rectangles */  
+  context->currentDistance = p_calculate_distance_to_ref_coord(context, px, py);
+  context->px = px;
+  context->py = py;
+
+  /* attempts with higher sum than the best matching attempt so far
+   * or the best pyramid search candidate (that is also an offset
+   * within the search radius) can not become the best match.
+   */
+  cancelSumDiffValue = MIN(context->bestMatchingSumDiffValue, context->seedSumDiffValue);
+
+  if (!p_compare_at_offset(context, px, py, cancelSumDiffValue))
+  {
+    return;
+  }
+  if (context->cancelAttemptFlag)
+  {
+    return;
+  }
+
+  if ((context->involvedPixelCount >= context->requiredPixelCount)
+  &&  (context->sumDiffValue <= context->bestMatchingSumDiffValue))
+  {
+    if((context->sumDiffValue < context->bestMatchingSumDiffValue)
+    || ( context->currentDistance < context->bestMatchingDistance))
+    {
+      context->bestMatchingSumDiffValue = context->sumDiffValue;
+      context->bestMatchingDistance = context->currentDistance;
+      context->bestMatchingPixelCount = context->involvedPixelCount;
+      context->bestX = px;
+      context->bestY = py;
+      context->bestMatchingAvgColordiff = 
+        p_calculate_average_colordiff(context->bestMatchingSumDiffValue
+                                    , context->bestMatchingPixelCount
+                                    );
+
+      if(gap_debug)
+      {
+        printf("FOUND: bestX:%d bestY:%d squareDist:%d\n"
+               "             sumDiffValues:%d pixelCount:%d bestMatchingAvgColordiff:%.5f\n"
+          , (int)context->bestX
+          , (int)context->bestY
+          , (int)context->bestMatchingDistance
+          , (int)context->bestMatchingSumDiffValue
+          , (int)context->bestMatchingPixelCount
+          , (float)context->bestMatchingAvgColordiff
+          );
+      }
+       
+      if ((context->currentDistance <= context->veryNearDistance)
+      &&  (context->sumDiffValue == 0))
+      {
+        /* stop all further attempts on exact matching area when near reference origin */
+        context->isFinishedFlag = TRUE;
+      }
+    }
+  }
+
+  
+}  /* end p_attempt_locate_at_current_offset */
+
+
+/* --------------------------------------------
+ * p_read_area_buffers
+ * --------------------------------------------
+ * read the reference area and the target search window
+ * (that includes the target areas at all offsets within targetMoveRadius
+ * around centerX/centerY) into contiguous buffers.
+ * returns FALSE if the reference area or the search window is empty.
+ */
+static gboolean
+p_read_area_buffers(Context *context, gint32 centerX, gint32 centerY, gint32 targetMoveRadius)
+{
+  GimpPixelRgn refPR;
+  GimpPixelRgn targetPR;
+  gint      rx1, ry1, rWidth, rHeight;
+  gint      wx1, wy1, wWidth, wHeight;
+  gboolean  isIntersect;
 
   isIntersect =
    gimp_rectangle_intersect((context->refX - context->refShapeRadius)  /* origin1 */
@@ -268,147 +598,396 @@ p_attempt_locate_at_current_offset(Context *context, gint32 px, gint32 py)
                           );
   if (!isIntersect)
   {
-    return;
+    return (FALSE);
   }
 
-  leftShapeRadius = context->refX - rx1;
-  upperShapeRadius = context->refY - ry1;
+  context->rx1 = rx1;
+  context->ry1 = ry1;
+  context->rWidth = rWidth;
+  context->rHeight = rHeight;
+  context->leftShapeRadius = context->refX - rx1;
+  context->upperShapeRadius = context->refY - ry1;
 
   isIntersect =
-   gimp_rectangle_intersect((px - leftShapeRadius)  /* origin1 */
-                          , (py - upperShapeRadius)
-                          , rWidth               /*  width1 */
-                          , rHeight               /* height1 */
+   gimp_rectangle_intersect((centerX - targetMoveRadius - context->leftShapeRadius)  /* origin1 */
+                          , (centerY - targetMoveRadius - context->upperShapeRadius)
+                          , (2 * targetMoveRadius) + rWidth              /*  width1 */
+                          , (2 * targetMoveRadius) + rHeight             /* height1 */
                           ,0
                           ,0
                           ,context->targetDrawable->width
                           ,context->targetDrawable->height
-                          ,&tx1
-                          ,&ty1
-                          ,&tWidth
-                          ,&tHeight
+                          ,&wx1
+                          ,&wy1
+                          ,&wWidth
+                          ,&wHeight
                           );
   if (!isIntersect)
   {
-    return;
+    return (FALSE);
   }
 
-  commonAreaWidth = tWidth;
-  commonAreaHeight = tHeight;
-  
+  context->wx1 = wx1;
+  context->wy1 = wy1;
+  context->wWidth = wWidth;
+  context->wHeight = wHeight;
 
-//   if(gap_debug)
-//   {
-//     printf("p_attempt_locate_at: px: %04d py:%04d\n"
-//            "                     rx1:%04d ry1:%04d rWidth:%d rHeight:%d\n"
-//            "                     tx1:%04d ty1:%04d tWidth:%d tHeight:%d\n"
-//            "                     commonAreaWidth:%d commonAreaHeight:%d\n"
-//       ,(int)px
-//       ,(int)py
-//       ,(int)rx1
-//       ,(int)ry1
-//       ,(int)rWidth
-//       ,(int)rHeight
-//       ,(int)tx1
-//       ,(int)ty1
-//       ,(int)tWidth
-//       ,(int)tHeight
-//       ,(int)commonAreaWidth
-//       ,(int)commonAreaHeight
-//       );
-//   }
-
-  /* rest 'per offset' values in the context */
-  context->cancelAttemptFlag = FALSE;
-  context->sumDiffValue = 0;
-  context->involvedPixelCount = 0;
-  context->currentDistance = p_calculate_distance_to_ref_coord(context, px, py);
-  context->px = px;
-  context->py = py;
+  context->refBpp = context->refDrawable->bpp;
+  context->targetBpp = context->targetDrawable->bpp;
+  /* (4 extra bytes, the compare loop reads 3 channels also for gray pixels) */
+  context->refBuf = g_malloc((rWidth * rHeight * context->refBpp) + 4);
+  context->targetBuf = g_malloc((wWidth * wHeight * context->targetBpp) + 4);
 
   gimp_pixel_rgn_init (&refPR, context->refDrawable, rx1, ry1
-                      , commonAreaWidth, commonAreaHeight
+                      , rWidth, rHeight
                       , FALSE     /* dirty */
                       , FALSE     /* shadow */
                        );
+  gimp_pixel_rgn_get_rect (&refPR, context->refBuf, rx1, ry1, rWidth, rHeight);
 
-  gimp_pixel_rgn_init (&targetPR, context->targetDrawable, tx1, ty1
-                      , commonAreaWidth, commonAreaHeight
+  gimp_pixel_rgn_init (&targetPR, context->targetDrawable, wx1, wy1
+                      , wWidth, wHeight
                       , FALSE     /* dirty */
                       , FALSE     /* shadow */
                        );
+  gimp_pixel_rgn_get_rect (&targetPR, context->targetBuf, wx1, wy1, wWidth, wHeight);
 
-  /* compare pixel areas in tiled portions via pixel region processing loops.
-   */
-  for (pr = gimp_pixel_rgns_register (2, &refPR, &targetPR);
-       pr != NULL;
-       pr = gimp_pixel_rgns_process (pr))
+  return (TRUE);
+
+}  /* end p_read_area_buffers */
+
+
+/* --------------------------------------------
+ * p_pyramid_level_init
+ * --------------------------------------------
+ * init level 1 (half size) from a full resolution buffer with bpp
+ * (gray and RGB buffers are handled like RGBA with full opacity)
+ */
+static void
+p_pyramid_level_init(PyramidLevel *level, const guchar *buf, gint32 width, gint32 height, gint32 bpp)
+{
+  gint32 x;
+  gint32 y;
+
+  level->width = MAX(1, (width + 1) / 2);
+  level->height = MAX(1, (height + 1) / 2);
+  level->data = g_malloc(level->width * level->height * GAP_LOCATE_PYRAMID_BPP);
+
+  for(y = 0; y < level->height; y++)
   {
-    if (context->cancelAttemptFlag)
+    for(x = 0; x < level->width; x++)
     {
-      break;
+      guint32 sum[GAP_LOCATE_PYRAMID_BPP];
+      gint32  count;
+      gint32  sx;
+      gint32  sy;
+      gint    ch;
+      guchar *dst;
+
+      sum[0] = sum[1] = sum[2] = sum[3] = 0;
+      count = 0;
+      for(sy = 2 * y; (sy < (2 * y) + 2) && (sy < height); sy++)
+      {
+        for(sx = 2 * x; (sx < (2 * x) + 2) && (sx < width); sx++)
+        {
+          const guchar *src;
+
+          src = buf + ((sy * width) + sx) * bpp;
+          if(bpp >= 3)
+          {
+            sum[0] += src[0];
+            sum[1] += src[1];
+            sum[2] += src[2];
+          }
+          else
+          {
+            sum[0] += src[0];
+            sum[1] += src[0];
+            sum[2] += src[0];
+          }
+          sum[3] += ((bpp == 2) || (bpp > 3)) ? src[bpp -1] : 255;
+          count++;
+        }
+      }
+      dst = level->data + ((y * level->width) + x) * GAP_LOCATE_PYRAMID_BPP;
+      for(ch = 0; ch < GAP_LOCATE_PYRAMID_BPP; ch++)
+      {
+        dst[ch] = (count > 0) ? (sum[ch] / count) : 0;
+      }
     }
-    else
+  }
+
+}  /* end p_pyramid_level_init */
+
+
+/* --------------------------------------------
+ * p_pyramid_level_downsample
+ * --------------------------------------------
+ * init level with half the size of the specified finer level
+ */
+static void
+p_pyramid_level_downsample(PyramidLevel *level, const PyramidLevel *finer)
+{
+  p_pyramid_level_init(level, finer->data, finer->width, finer->height, GAP_LOCATE_PYRAMID_BPP);
+}  /* end p_pyramid_level_downsample */
+
+
+/* --------------------------------------------
+ * p_pyramid_compare
+ * --------------------------------------------
+ * compare the reference level against the target level
+ * where the upper left reference pixel corresponds to target level pixel ox/oy.
+ * returns the average colordiff of the opaque pixels
+ * or 1.0 if less than requiredPixelCount pixels were compared.
+ */
+static gdouble
+p_pyramid_compare(const PyramidLevel *refLevel, const PyramidLevel *targetLevel
+  , gint32 ox, gint32 oy, gint32 requiredPixelCount)
+{
+  gint32  x1, x2, y1, y2;
+  gint32  y;
+  gdouble sumDiffValue;
+  gint32  pixelCount;
+
+  x1 = MAX(0, -ox);
+  y1 = MAX(0, -oy);
+  x2 = MIN(refLevel->width, targetLevel->width - ox);
+  y2 = MIN(refLevel->height, targetLevel->height - oy);
+
+  sumDiffValue = 0;
+  pixelCount = 0;
+  for(y = y1; y < y2; y++)
+  {
+    const guchar *refPtr;
+    const guchar *targetPtr;
+    guint32 rowSumDiff;
+    gint32  rowPixelCount;
+
+    refPtr = refLevel->data + ((y * refLevel->width) + x1) * GAP_LOCATE_PYRAMID_BPP;
+    targetPtr = targetLevel->data + (((y + oy) * targetLevel->width) + (x1 + ox)) * GAP_LOCATE_PYRAMID_BPP;
+    rowSumDiff = 0;
+    rowPixelCount = 0;
+    if (x2 > x1)
     {
-      p_compare_regions(&refPR, &targetPR, context);
+      p_sum_diff_rgba_row(refPtr, targetPtr, x2 - x1, &rowSumDiff, &rowPixelCount);
     }
+    sumDiffValue += rowSumDiff;
+    pixelCount += rowPixelCount;
   }
 
-  if (pr != NULL)
+  if ((pixelCount < requiredPixelCount) || (pixelCount <= 0))
   {
-     /* NOTE:
-      * early escaping from the loop with pr != NULL
-      * leads to memory leaks due to unbalanced tile ref/unref calls.
-      * the call to gap_gimp_pixel_rgns_unref cals unref on the current tile
-      * (in th same way as gimp_pixel_rgns_process does)
-      * but does not ref another available tile.
-      */
-    gap_gimp_pixel_rgns_unref (pr);
-  
+    return (1.0);
   }
-  
+  return (p_calculate_average_colordiff(sumDiffValue, pixelCount));
 
-  
-  if ((context->involvedPixelCount >= context->requiredPixelCount)
-  &&  (context->sumDiffValue <= context->bestMatchingSumDiffValue))
+}  /* end p_pyramid_compare */
+
+
+/* --------------------------------------------
+ * p_pyramid_add_candidate
+ * --------------------------------------------
+ * insert dx/dy into the sorted list of the best candidates
+ * (lowest avgDiff first) if it is better than the worst one.
+ */
+static void
+p_pyramid_add_candidate(PyramidCandidate *candidates, gint32 *numCandidates
+  , gint32 dx, gint32 dy, gdouble avgDiff)
+{
+  gint32 ii;
+  gint32 jj;
+
+  for(ii = 0; ii < *numCandidates; ii++)
   {
-    if((context->sumDiffValue < context->bestMatchingSumDiffValue)
-    || ( context->currentDistance < context->bestMatchingDistance))
+    if((candidates[ii].dx == dx) && (candidates[ii].dy == dy))
     {
-      context->bestMatchingSumDiffValue = context->sumDiffValue;
-      context->bestMatchingDistance = context->currentDistance;
-      context->bestMatchingPixelCount = context->involvedPixelCount;
-      context->bestX = px;
-      context->bestY = py;
-      context->bestMatchingAvgColordiff = 
-        p_calculate_average_colordiff(context->bestMatchingSumDiffValue
-                                    , context->bestMatchingPixelCount
-                                    );
+      return;
+    }
+  }
 
-      if(gap_debug)
+  for(ii = 0; ii < *numCandidates; ii++)
+  {
+    if(avgDiff < candidates[ii].avgDiff)
+    {
+      break;
+    }
+  }
+  if(ii >= GAP_LOCATE_PYRAMID_CANDIDATES)
+  {
+    return;
+  }
+
+  if(*numCandidates < GAP_LOCATE_PYRAMID_CANDIDATES)
+  {
+    (*numCandidates)++;
+  }
+  for(jj = *numCandidates -1; jj > ii; jj--)
+  {
+    candidates[jj] = candidates[jj -1];
+  }
+  candidates[ii].dx = dx;
+  candidates[ii].dy = dy;
+  candidates[ii].avgDiff = avgDiff;
+
+}  /* end p_pyramid_add_candidate */
+
+
+/* --------------------------------------------
+ * p_pyramid_compare_at_level
+ * --------------------------------------------
+ * compare at level for the full resolution offset centerX + dx * 2^levelNr, centerY + dy * 2^levelNr
+ */
+static gdouble
+p_pyramid_compare_at_level(Context *context, PyramidLevel *refLevel, PyramidLevel *targetLevel
+  , gint32 levelNr, gint32 centerX, gint32 centerY, gint32 dx, gint32 dy)
+{
+  gint32 scale;
+  gint32 tx;
+  gint32 ty;
+  gint32 ox;
+  gint32 oy;
+  gint32 requiredPixelCount;
+
+  scale = 1 << levelNr;
+
+  /* position of the upper left reference pixel in the target search window (full resolution) */
+  tx = (centerX + (dx * scale)) - context->leftShapeRadius - context->wx1;
+  ty = (centerY + (dy * scale)) - context->upperShapeRadius - context->wy1;
+
+  /* position at the level (round down also for negative positions) */
+  ox = (tx >= 0) ? (tx / scale) : -(((-tx) + scale -1) / scale);
+  oy = (ty >= 0) ? (ty / scale) : -(((-ty) + scale -1) / scale);
+
+  requiredPixelCount = MAX(1, context->requiredPixelCount / (scale * scale));
+
+  return (p_pyramid_compare(refLevel, targetLevel, ox, oy, requiredPixelCount));
+
+}  /* end p_pyramid_compare_at_level */
+
+
+/* --------------------------------------------
+ * p_pyramid_search_seed
+ * --------------------------------------------
+ * coarse to fine search on downsampled pyramid levels
+ * of the reference area and the target search window.
+ * the best candidates at the coarsest level are refined level by level,
+ * finally the candidates are compared at full resolution.
+ * The summary color difference of the best full resolution candidate
+ * (that is an offset within targetMoveRadius) is set as
+ * context->seedSumDiffValue. This is used as bound to cancel
+ * worse attempts of the full search early. (the full search
+ * still delivers the same result as without the pyramid search)
+ */
+static void
+p_pyramid_search_seed(Context *context, gint32 centerX, gint32 centerY, gint32 targetMoveRadius)
+{
+  PyramidLevel      refLevels[GAP_LOCATE_PYRAMID_MAX_LEVEL +1];
+  PyramidLevel      targetLevels[GAP_LOCATE_PYRAMID_MAX_LEVEL +1];
+  PyramidCandidate  candidates[GAP_LOCATE_PYRAMID_CANDIDATES];
+  PyramidCandidate  prevCandidates[GAP_LOCATE_PYRAMID_CANDIDATES];
+  gint32            numCandidates;
+  gint32            numPrevCandidates;
+  gint32            maxLevel;
+  gint32            levelNr;
+  gint32            levelRadius;
+  gint32            dx;
+  gint32            dy;
+  gint32            ii;
+
+  maxLevel = 0;
+  while((maxLevel < GAP_LOCATE_PYRAMID_MAX_LEVEL)
+  &&    ((context->refShapeRadius >> (maxLevel +1)) >= GAP_LOCATE_PYRAMID_MIN_SHAPE_RADIUS)
+  &&    ((targetMoveRadius >> (maxLevel +1)) >= 1))
+  {
+    maxLevel++;
+  }
+  if (maxLevel < 1)
+  {
+    /* search radius or shape too small, the full search is fast enough */
+    return;
+  }
+
+  p_pyramid_level_init(&refLevels[1], context->refBuf, context->rWidth, context->rHeight, context->refBpp);
+  p_pyramid_level_init(&targetLevels[1], context->targetBuf, context->wWidth, context->wHeight, context->targetBpp);
+  for(levelNr = 2; levelNr <= maxLevel; levelNr++)
+  {
+    p_pyramid_level_downsample(&refLevels[levelNr], &refLevels[levelNr -1]);
+    p_pyramid_level_downsample(&targetLevels[levelNr], &targetLevels[levelNr -1]);
+  }
+
+  /* full search at the coarsest level */
+  numCandidates = 0;
+  levelRadius = (targetMoveRadius >> maxLevel) + 1;
+  for(dy = -levelRadius; dy <= levelRadius; dy++)
+  {
+    for(dx = -levelRadius; dx <= levelRadius; dx++)
+    {
+      p_pyramid_add_candidate(candidates, &numCandidates, dx, dy
+        , p_pyramid_compare_at_level(context, &refLevels[maxLevel], &targetLevels[maxLevel]
+                                    , maxLevel, centerX, centerY, dx, dy)
+        );
+    }
+  }
+
+  /* refine the candidates in the 3x3 neighbourhood at each finer level */
+  for(levelNr = maxLevel -1; levelNr >= 1; levelNr--)
+  {
+    memcpy(prevCandidates, candidates, sizeof(candidates));
+    numPrevCandidates = numCandidates;
+    numCandidates = 0;
+    for(ii = 0; ii < numPrevCandidates; ii++)
+    {
+      for(dy = (2 * prevCandidates[ii].dy) -1; dy <= (2 * prevCandidates[ii].dy) +1; dy++)
       {
-        printf("FOUND: bestX:%d bestY:%d squareDist:%d\n"
-               "             sumDiffValues:%d pixelCount:%d bestMatchingAvgColordiff:%.5f\n"
-          , (int)context->bestX
-          , (int)context->bestY
-          , (int)context->bestMatchingDistance
-          , (int)context->bestMatchingSumDiffValue
-          , (int)context->bestMatchingPixelCount
-          , (float)context->bestMatchingAvgColordiff
-          );
+        for(dx = (2 * prevCandidates[ii].dx) -1; dx <= (2 * prevCandidates[ii].dx) +1; dx++)
+        {
+          p_pyramid_add_candidate(candidates, &numCandidates, dx, dy
+            , p_pyramid_compare_at_level(context, &refLevels[levelNr], &targetLevels[levelNr]
+                                        , levelNr, centerX, centerY, dx, dy)
+            );
+        }
       }
-       
-      if ((context->currentDistance <= context->veryNearDistance)
-      &&  (context->sumDiffValue == 0))
+    }
+  }
+
+  /* compare the candidates at full resolution within targetMoveRadius */
+  for(ii = 0; ii < numCandidates; ii++)
+  {
+    for(dy = (2 * candidates[ii].dy) -1; dy <= (2 * candidates[ii].dy) +1; dy++)
+    {
+      for(dx = (2 * candidates[ii].dx) -1; dx <= (2 * candidates[ii].dx) +1; dx++)
       {
-        /* stop all further attempts on exact matching area when near reference origin */
-        context->isFinishedFlag = TRUE;
+        if((abs(dx) > targetMoveRadius) || (abs(dy) > targetMoveRadius))
+        {
+          continue;
+        }
+        if(p_compare_at_offset(context, centerX + dx, centerY + dy, context->seedSumDiffValue))
+        {
+          if((context->cancelAttemptFlag != TRUE)
+          && (context->involvedPixelCount >= context->requiredPixelCount))
+          {
+            context->seedSumDiffValue = MIN(context->seedSumDiffValue, context->sumDiffValue);
+          }
+        }
       }
     }
   }
 
-  
-}  /* end p_attempt_locate_at_current_offset */
+  if(gap_debug)
+  {
+    printf("p_pyramid_search_seed: maxLevel:%d seedSumDiffValue:%.0f\n"
+      , (int)maxLevel
+      , (float)context->seedSumDiffValue
+      );
+  }
+
+  for(levelNr = 1; levelNr <= maxLevel; levelNr++)
+  {
+    g_free(refLevels[levelNr].data);
+    g_free(targetLevels[levelNr].data);
+  }
+
+}  /* end p_pyramid_search_seed */
 
 
 
@@ -438,14 +1017,17 @@ gap_locateAreaWithinRadiusWithOffset(gint32  refDrawableId
   Context contextData;
   Context *context;
   gdouble averageColorDiff;
-  gboolean isFinishedFlag;
   gint    idx;
   gint    idy;
   gdouble maxPixelCount;
+  gint32  centerX;
+  gint32  centerY;
   
   
   *targetX = refX;
   *targetY = refY;
+
+  p_simd_init();
   
   /* init Context */
   context = &contextData;
@@ -463,6 +1045,8 @@ gap_locateAreaWithinRadiusWithOffset(gint32  refDrawableId
   context->currentDistance = 0;
   context->bestMatchingPixelCount = 0;
   context->veryNearDistance = (2 * 2);
+  context->refBuf = NULL;
+  context->targetBuf = NULL;
 
   context->refDrawable = gimp_drawable_get(refDrawableId);
   context->targetDrawable = gimp_drawable_get(targetDrawableId);
@@ -473,56 +1057,65 @@ gap_locateAreaWithinRadiusWithOffset(gint32  refDrawableId
   context->bestMatchingSumDiffValue = maxPixelCount * MAX_DIFF_VALUE_PER_PIXEL;
   context->bestMatchingDistance = maxPixelCount;
   context->bestMatchingAvgColordiff = 1.0;
+  context->seedSumDiffValue = context->bestMatchingSumDiffValue;
   
   averageColorDiff = 1.0;
-  
-  for(idx = 0; idx <= targetMoveRadius; idx ++)
+
+  centerX = offsetX + refX;
+  centerY = offsetY + refY;
+
+  if (p_read_area_buffers(context, centerX, centerY, targetMoveRadius))
   {
-    if (context->isFinishedFlag) 
-    { 
-      break; 
-    }
+    p_pyramid_search_seed(context, centerX, centerY, targetMoveRadius);
 
-    for(idy = 0; idy <= targetMoveRadius; idy++)
+    for(idx = 0; idx <= targetMoveRadius; idx ++)
     {
-      gint32 dx;
-      gint32 dy;
-      
-      dx = idx;
-      dy = idy;
-      p_attempt_locate_at_current_offset(context, (offsetX + refX) + dx, (offsetY + refY) +dy);
-      if (isFinishedFlag)
+      if (context->isFinishedFlag) 
       { 
-        break;
+        break; 
       }
-      
-      if (idx > 0)
+
+      for(idy = 0; idy <= targetMoveRadius; idy++)
       {
-        p_attempt_locate_at_current_offset(context, (offsetX + refX) - dx, (offsetY + refY) +dy);
-        if (context->isFinishedFlag) 
+        gint32 dx;
+        gint32 dy;
+      
+        dx = idx;
+        dy = idy;
+        p_attempt_locate_at_current_offset(context, centerX + dx, centerY +dy);
+        if (context->isFinishedFlag)
+        { 
+          break;
+        }
+      
+        if (idx > 0)
         {
-          break; 
+          p_attempt_locate_at_current_offset(context, centerX - dx, centerY +dy);
+          if (context->isFinishedFlag) 
+          {
+            break; 
+          }
         }
-      }
       
-      if (idy > 0)
-      {
-        p_attempt_locate_at_current_offset(context, (offsetX + refX) + dx, (offsetY + refY) -dy);
-        if (context->isFinishedFlag) 
+        if (idy > 0)
         {
-          break; 
+          p_attempt_locate_at_current_offset(context, centerX + dx, centerY -dy);
+          if (context->isFinishedFlag) 
+          {
+            break; 
+          }
         }
-      }
       
-      if ((idx > 0) && (idy > 0))
-      {
-        p_attempt_locate_at_current_offset(context, (offsetX + refX) - dx, (offsetY + refY) -dy);
-        if (context->isFinishedFlag) 
+        if ((idx > 0) && (idy > 0))
         {
-          break; 
+          p_attempt_locate_at_current_offset(context, centerX - dx, centerY -dy);
+          if (context->isFinishedFlag) 
+          {
+            break; 
+          }
         }
-      }
       
+      }
     }
   }
   
@@ -549,6 +1142,14 @@ gap_locateAreaWithinRadiusWithOffset(gint32  refDrawableId
     }
   }
 
+  if(context->refBuf != NULL)
+  {
+    g_free(context->refBuf);
+  }
+  if(context->targetBuf != NULL)
+  {
+    g_free(context->targetBuf);
+  }
 
   if(context->refDrawable != NULL)
   {
@@ -0,0 +1,446 @@
+/* gap_locate2_bench.c
+ *
+ * GAP ... Gimp Animation Plugins
+ *
+ * equality check and benchmark for the sum of RGBA differences
+ * of the locate procedures (gap_locate2.c)
+ *
+ * RGBA rows are generated (random pixels with a fixed seed, the alpha bytes
+ * are chosen around OPACITY_LEVEL_UCHAR to hit both sides of the threshold)
+ * and compared
+ *   a) by p_scalar_sum_diff_rgba_row (the reference implementation)
+ *   b) by p_sse2_sum_diff_rgba_row (remaining columns by the scalar implementation)
+ * for row widths 0 .. 70 at unaligned start positions.
+ * In addition p_compare_buffers and p_pyramid_compare are run at both dispatch
+ * levels on a generated reference area and target search window.
+ * The sums and pixel counts must be identical.
+ *
+ * usage:
+ *   gap_locate2_bench                equality check (run by make check)
+ *   gap_locate2_bench -b [r]         equality check and benchmark of p_compare_buffers
+ *                                    with a reference area of 2r x 2r pixels
+ *                                    (default 30) at all offsets within radius 2r
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * 2026.10.18  created
+ */
+
+/* included (not linked) to access the static compare procedures and the dispatch level */
+#include "gap_locate2.c"
+
+#define BENCH_MAX_ROW_WIDTH   70
+#define BENCH_NUM_ROWS        2000
+
+int gap_debug = 0;  /* 1 == print debug infos , 0 dont print debug infos */
+
+
+/* ---------------------------------
+ * p_fill_rgba
+ * ---------------------------------
+ * fill count RGBA pixels with random values.
+ * the alpha bytes are transparent, opaque or near OPACITY_LEVEL_UCHAR.
+ */
+static void
+p_fill_rgba(GRand *rand, guchar *buf, gint32 count)
+{
+  gint32 ii;
+
+  for(ii = 0; ii < count; ii++)
+  {
+    buf[0] = g_rand_int_range(rand, 0, 256);
+    buf[1] = g_rand_int_range(rand, 0, 256);
+    buf[2] = g_rand_int_range(rand, 0, 256);
+    switch(g_rand_int_range(rand, 0, 4))
+    {
+      case 0:
+        buf[3] = 0;
+        break;
+      case 1:
+        buf[3] = OPACITY_LEVEL_UCHAR + g_rand_int_range(rand, -2, 3);
+        break;
+      case 2:
+        buf[3] = g_rand_int_range(rand, 0, 256);
+        break;
+      default:
+        buf[3] = 255;
+        break;
+    }
+    buf += 4;
+  }
+}  /* end p_fill_rgba */
+
+
+#ifdef GAP_LOCATE_SIMD_X86
+/* ---------------------------------
+ * p_check_rows
+ * ---------------------------------
+ * return the number of rows where the SSE2 kernel differs from the reference
+ */
+static gint32
+p_check_rows(GRand *rand)
+{
+  guchar  *refBuf;
+  guchar  *targetBuf;
+  gint32   errors;
+  gint32   ii;
+
+  refBuf = g_malloc((BENCH_MAX_ROW_WIDTH + 4) * 4);
+  targetBuf = g_malloc((BENCH_MAX_ROW_WIDTH + 4) * 4);
+  errors = 0;
+
+  for(ii = 0; ii < BENCH_NUM_ROWS; ii++)
+  {
+    const guchar *ref;
+    const guchar *target;
+    guint32  sumScalar;
+    guint32  sumSse2;
+    gint32   countScalar;
+    gint32   countSse2;
+    gint32   width;
+    gint32   col;
+
+    p_fill_rgba(rand, refBuf, BENCH_MAX_ROW_WIDTH + 4);
+    p_fill_rgba(rand, targetBuf, BENCH_MAX_ROW_WIDTH + 4);
+    if((ii % 5) == 0)
+    {
+      /* identical rows (sum 0) */
+      memcpy(targetBuf, refBuf, (BENCH_MAX_ROW_WIDTH + 4) * 4);
+    }
+    width = ii % (BENCH_MAX_ROW_WIDTH + 1);
+    ref = refBuf + (4 * g_rand_int_range(rand, 0, 4));
+    target = targetBuf + (4 * g_rand_int_range(rand, 0, 4));
+
+    sumScalar = 0;
+    countScalar = 0;
+    p_scalar_sum_diff_rgba_row(ref, target, 0, width, &sumScalar, &countScalar);
+
+    sumSse2 = 0;
+    countSse2 = 0;
+    col = p_sse2_sum_diff_rgba_row(ref, target, width, &sumSse2, &countSse2);
+    p_scalar_sum_diff_rgba_row(ref, target, col, width, &sumSse2, &countSse2);
+
+    if((sumScalar != sumSse2) || (countScalar != countSse2))
+    {
+      printf("MISMATCH row width:%d scalar:(%u %d) sse2:(%u %d)\n"
+            , (int)width
+            , (unsigned)sumScalar, (int)countScalar
+            , (unsigned)sumSse2, (int)countSse2
+            );
+      errors++;
+    }
+  }
+
+  g_free(refBuf);
+  g_free(targetBuf);
+
+  return (errors);
+}  /* end p_check_rows */
+#endif
+
+
+/* ---------------------------------
+ * p_init_areas
+ * ---------------------------------
+ * init context with a generated reference area of rWidth x rHeight
+ * and a target search window of wWidth x wHeight RGBA pixels.
+ * the target window contains a noisy copy of the reference at 7/5.
+ */
+static void
+p_init_areas(Context *context, GRand *rand, gint32 rWidth, gint32 rHeight
+  , gint32 wWidth, gint32 wHeight)
+{
+  gint32 x;
+  gint32 y;
+
+  memset(context, 0, sizeof(Context));
+  context->refBpp = 4;
+  context->targetBpp = 4;
+  context->rWidth = rWidth;
+  context->rHeight = rHeight;
+  context->wWidth = wWidth;
+  context->wHeight = wHeight;
+  context->refBuf = g_malloc((rWidth * rHeight * 4) + 4);
+  context->targetBuf = g_malloc((wWidth * wHeight * 4) + 4);
+  p_fill_rgba(rand, context->refBuf, rWidth * rHeight);
+  p_fill_rgba(rand, context->targetBuf, wWidth * wHeight);
+
+  for(y = 0; (y < rHeight) && (y + 5 < wHeight); y++)
+  {
+    for(x = 0; (x < rWidth) && (x + 7 < wWidth); x++)
+    {
+      guchar *dst;
+      gint    ch;
+
+      dst = context->targetBuf + ((((y + 5) * wWidth) + x + 7) * 4);
+      memcpy(dst, context->refBuf + (((y * rWidth) + x) * 4), 4);
+      for(ch = 0; ch < 3; ch++)
+      {
+        dst[ch] = CLAMP(dst[ch] + g_rand_int_range(rand, -3, 4), 0, 255);
+      }
+    }
+  }
+}  /* end p_init_areas */
+
+
+/* ---------------------------------
+ * p_compare_all_offsets
+ * ---------------------------------
+ * run p_compare_buffers at all offsets of the reference area in the target window
+ * and collect the sums and pixel counts (with useBestBound the sum of the best
+ * match so far is the cancel bound, as done by the full search)
+ */
+static void
+p_compare_all_offsets(Context *context, gdouble *sums, gint32 *counts, gboolean useBestBound)
+{
+  gdouble bestSum;
+  gint32  x;
+  gint32  y;
+  gint32  idx;
+
+  bestSum = context->rWidth * context->rHeight * MAX_DIFF_VALUE_PER_PIXEL;
+  idx = 0;
+  for(y = 0; y < context->wHeight; y++)
+  {
+    for(x = 0; x < context->wWidth; x++)
+    {
+      context->cancelAttemptFlag = FALSE;
+      context->sumDiffValue = 0;
+      context->involvedPixelCount = 0;
+      p_compare_buffers(context->refBuf
+                       , context->targetBuf + (((y * context->wWidth) + x) * 4)
+                       , MIN(context->rWidth, context->wWidth - x)
+                       , MIN(context->rHeight, context->wHeight - y)
+                       , (useBestBound) ? bestSum : G_MAXDOUBLE
+                       , context
+                       );
+      if((useBestBound) && (!context->cancelAttemptFlag))
+      {
+        bestSum = MIN(bestSum, context->sumDiffValue);
+      }
+      sums[idx] = context->sumDiffValue;
+      counts[idx] = context->involvedPixelCount;
+      idx++;
+    }
+  }
+}  /* end p_compare_all_offsets */
+
+
+/* ---------------------------------
+ * p_check_areas
+ * ---------------------------------
+ * run p_compare_buffers and p_pyramid_compare with the scalar and the SSE2 dispatch level
+ * return the number of offsets with different results
+ */
+static gint32
+p_check_areas(GRand *rand, gint32 rWidth, gint32 rHeight, gint32 wWidth, gint32 wHeight)
+{
+  Context       contextData;
+  PyramidLevel  refLevel;
+  PyramidLevel  targetLevel;
+  gdouble      *sumsScalar;
+  gdouble      *sumsSse2;
+  gint32       *countsScalar;
+  gint32       *countsSse2;
+  gint32        numOffsets;
+  gint32        errors;
+  gint32        ii;
+  gint32        ox;
+  gint32        oy;
+
+  p_init_areas(&contextData, rand, rWidth, rHeight, wWidth, wHeight);
+  numOffsets = wWidth * wHeight;
+  sumsScalar = g_new(gdouble, numOffsets);
+  sumsSse2 = g_new(gdouble, numOffsets);
+  countsScalar = g_new(gint32, numOffsets);
+  countsSse2 = g_new(gint32, numOffsets);
+  errors = 0;
+
+  simdSse2 = FALSE;
+  p_compare_all_offsets(&contextData, sumsScalar, countsScalar, TRUE);
+  simdSse2 = TRUE;
+  p_compare_all_offsets(&contextData, sumsSse2, countsSse2, TRUE);
+  for(ii = 0; ii < numOffsets; ii++)
+  {
+    if((sumsScalar[ii] != sumsSse2[ii]) || (countsScalar[ii] != countsSse2[ii]))
+    {
+      errors++;
+    }
+  }
+
+  p_pyramid_level_init(&refLevel, contextData.refBuf, rWidth, rHeight, 4);
+  p_pyramid_level_init(&targetLevel, contextData.targetBuf, wWidth, wHeight, 4);
+  for(oy = -refLevel.height; oy <= targetLevel.height; oy++)
+  {
+    for(ox = -refLevel.width; ox <= targetLevel.width; ox++)
+    {
+      gdouble avgScalar;
+      gdouble avgSse2;
+
+      simdSse2 = FALSE;
+      avgScalar = p_pyramid_compare(&refLevel, &targetLevel, ox, oy, 1);
+      simdSse2 = TRUE;
+      avgSse2 = p_pyramid_compare(&refLevel, &targetLevel, ox, oy, 1);
+      if(avgScalar != avgSse2)
+      {
+        errors++;
+      }
+    }
+  }
+
+  if(errors != 0)
+  {
+    printf("MISMATCH areas ref:%dx%d window:%dx%d (%d offsets differ)\n"
+          , (int)rWidth, (int)rHeight, (int)wWidth, (int)wHeight, (int)errors);
+  }
+
+  g_free(refLevel.data);
+  g_free(targetLevel.data);
+  g_free(sumsScalar);
+  g_free(sumsSse2);
+  g_free(countsScalar);
+  g_free(countsSse2);
+  g_free(contextData.refBuf);
+  g_free(contextData.targetBuf);
+
+  return (errors);
+}  /* end p_check_areas */
+
+
+/* ---------------------------------
+ * p_bench_compare
+ * ---------------------------------
+ * time p_compare_buffers at all offsets (without cancel bound)
+ * for a reference area of 2r x 2r pixels in a window of 6r x 6r pixels
+ */
+static gint32
+p_bench_compare(gint32 radius)
+{
+  Context   contextData;
+  GRand    *rand;
+  GTimer   *timer;
+  gdouble  *sumsScalar;
+  gdouble  *sumsSse2;
+  gint32   *countsScalar;
+  gint32   *countsSse2;
+  gdouble   timeScalar;
+  gdouble   timeSse2;
+  gint32    numOffsets;
+  gint32    errors;
+  gint32    ii;
+
+  rand = g_rand_new_with_seed(4711);
+  p_init_areas(&contextData, rand, 2 * radius, 2 * radius, 6 * radius, 6 * radius);
+  numOffsets = contextData.wWidth * contextData.wHeight;
+  sumsScalar = g_new(gdouble, numOffsets);
+  sumsSse2 = g_new(gdouble, numOffsets);
+  countsScalar = g_new(gint32, numOffsets);
+  countsSse2 = g_new(gint32, numOffsets);
+  timer = g_timer_new();
+
+  simdSse2 = FALSE;
+  g_timer_start(timer);
+  p_compare_all_offsets(&contextData, sumsScalar, countsScalar, FALSE);
+  timeScalar = g_timer_elapsed(timer, NULL);
+
+  simdSse2 = TRUE;
+  g_timer_start(timer);
+  p_compare_all_offsets(&contextData, sumsSse2, countsSse2, FALSE);
+  timeSse2 = g_timer_elapsed(timer, NULL);
+
+  errors = 0;
+  for(ii = 0; ii < numOffsets; ii++)
+  {
+    if((sumsScalar[ii] != sumsSse2[ii]) || (countsScalar[ii] != countsSse2[ii]))
+    {
+      errors++;
+    }
+  }
+
+  printf("compare ref:%dx%d offsets:%d scalar:%9.1f ms sse2:%9.1f ms (%.1f x) %s\n"
+        , (int)contextData.rWidth
+        , (int)contextData.rHeight
+        , (int)numOffsets
+        , timeScalar * 1000.0
+        , timeSse2 * 1000.0
+        , (timeSse2 > 0.0) ? timeScalar / timeSse2 : 0.0
+        , (errors == 0) ? "identical" : "MISMATCH"
+        );
+
+  g_timer_destroy(timer);
+  g_rand_free(rand);
+  g_free(sumsScalar);
+  g_free(sumsSse2);
+  g_free(countsScalar);
+  g_free(countsSse2);
+  g_free(contextData.refBuf);
+  g_free(contextData.targetBuf);
+
+  return (errors);
+}  /* end p_bench_compare */
+
+
+/* ---------------------------------
+ * main
+ * ---------------------------------
+ */
+int
+main(int argc, char *argv[])
+{
+  GRand    *rand;
+  gint32    errors;
+
+  p_simd_init();
+  if(!simdSse2)
+  {
+    printf("no SSE2 implementation for this compiler or CPU, check skipped\n");
+    return (77);   /* automake: skipped test */
+  }
+
+  errors = 0;
+  rand = g_rand_new_with_seed(1);
+#ifdef GAP_LOCATE_SIMD_X86
+  errors += p_check_rows(rand);
+#endif
+  errors += p_check_areas(rand, 1, 1, 9, 9);
+  errors += p_check_areas(rand, 7, 5, 30, 20);
+  errors += p_check_areas(rand, 33, 31, 80, 70);
+  g_rand_free(rand);
+
+  if((argc > 1) && (strcmp(argv[1], "-b") == 0))
+  {
+    gint32 radius;
+
+    radius = 30;
+    if(argc > 2)
+    {
+      radius = MAX(1, atoi(argv[2]));
+    }
+    errors += p_bench_compare(radius);
+  }
+
+  printf("locate sum of differences equality check: %s (%d mismatches)\n"
+        , (errors == 0) ? "OK" : "FAILED"
+        , (int)errors
+        );
+
+  return ((errors == 0) ? 0 : 1);
+
+}  /* end main */
@@ -28,6 +28,8 @@
  */
 
 /* revision history:
+ * gimp    2.6.x;  2026/10/18       p_pixel_warp_core: init the QUALITY selection state in each call,
+ *                                  QUALITY is rendered in parallel row bands too
  * gimp    2.0.2b; 2004/07/28  hof: added p_mix_layers
  * gimp    2.0.2b; 2004/07/17  hof: p_pixel_warp_core: changed workpoint selection (both FAST and Quality strategy)
  * gimp    2.0.2a; 2004/04/07  hof: created
@@ -93,17 +95,129 @@ typedef struct GapMorphExeLayerstack
   
 } GapMorphExeLayerstack;
 
+typedef struct GapMorphExePickCache
+{
+  gboolean valid;
+  gdouble  xx;
+  gdouble  yy;
+  gdouble  pick_x;
+  gdouble  pick_y;
+  
+} GapMorphExePickCache;
+
+#define GAP_MORPH_PCK_CACHE_SIZE 32
+
+#define GAP_MORPH_WARP_MAX_THREADS  16
+#define GAP_MORPH_WARP_BAND_HEIGHT  32
+
+/* data shared by all threads that render one warped layer */
+typedef struct GapMorphWarpLayerData  /* nickname: wld */
+{
+  const guchar  *src_data;          /* source layer pixels (src_width * src_height * bpp) */
+  gint32         src_width;
+  gint32         src_height;
+  gint32         bpp;
+  guchar        *dst_data;          /* warped pixels (dst_width * dst_height * bpp) */
+  gint32         dst_width;
+  gint32         dst_height;
+  gboolean       have_workpointsets;
+  gdouble        wp_mix_factor;
+  struct GapMorphWarpThreadData *wtdArray;  /* GAP_MORPH_WARP_MAX_THREADS elements (p_layer_warp_move only) */
+
+  GMutex        *mutex;             /* protects the following members */
+  GCond         *cond;
+  gint32         numBands;
+  gint32         nextBand;
+  gint32         bandsDone;
+  gint32         numWorkersActive;
+  gint32         refCount;          /* one reference per queued worker + one for the caller */
+} GapMorphWarpLayerData;
+
+/* private data per thread (the p_pixel_warp_core calculation writes
+ * per pixel scratch values into the workpoints, therefore each thread
+ * operates on its own copy of the workpoint lists)
+ */
+typedef struct GapMorphWarpThreadData  /* nickname: wtd */
+{
+  GapMorphWarpLayerData *wld;
+  GapMorphWarpCoreAPI    wcap_1;
+  GapMorphWarpCoreAPI    wcap_2;
+  GapMorphWorkPoint     *master_list_1;   /* the shared workpoint lists (read only) */
+  GapMorphWorkPoint     *master_list_2;
+  GapMorphExePickCache   pick_cache[GAP_MORPH_PCK_CACHE_SIZE][2];
+  gint                   pick_cache_idx[2];
+  gint                   cpuId;
+  gboolean               isStarted;         /* protected by wld->mutex */
+} GapMorphWarpThreadData;
+
+/* gimprc option for the number of tween frames that are rendered in parallel
+ * by p_morph_render_frame_tweens_in_subdir (value 1 disables the batch mode)
+ */
+#define GAP_MORPH_GIMPRC_TWEEN_BATCH_SIZE  "video-morph-tween-batch-size"
+#define GAP_MORPH_TWEEN_BATCH_MAX_SIZE     64
+
+/* one tween frame of a tween batch */
+typedef struct GapMorphTweenJob  /* nickname: tjob */
+{
+  gdouble            current_step;
+  gint32             curr_width;
+  gint32             curr_height;
+  gdouble            curr_mix_factor;   /* 0.0 <= mix <= 1.0 */
+  GapMorphWorkPoint *wp_list_bg;        /* workpoint movement to warp the src layer (BG) */
+  GapMorphWorkPoint *wp_list_top;       /* workpoint movement to warp the dst layer (TOP) */
+  guchar            *tween_data;        /* the mixed tween pixels (curr_width * curr_height * bpp) */
+  gboolean           skip;              /* TRUE: tween frame is not rendered (target file exists) */
+  gboolean           isRendered;
+} GapMorphTweenJob;
+
+/* one worker thread of a tween batch (handed over to the thread pool) */
+typedef struct GapMorphTweenWorker  /* nickname: twrk */
+{
+  struct GapMorphTweenBatch *tbat;
+  gint               cpuId;
+  gboolean           isStarted;         /* protected by tbat->mutex */
+} GapMorphTweenWorker;
+
+/* data shared by the worker threads that render the tween frames
+ * between one pair of source frames.
+ * Only the pixels of the 2 source layers and at most maxResident tween frames
+ * (starting at firstResident) are held in memory at the same time.
+ */
+typedef struct GapMorphTweenBatch  /* nickname: tbat */
+{
+  GapMorphWarpCoreAPI  wcap;            /* radius, gravity and strategy for all warp operations */
+  guchar            *src_data;          /* pixels of the src layer (osrc_layer_id) */
+  gint32             src_width;
+  gint32             src_height;
+  guchar            *dst_data;          /* pixels of the dst layer (fdst_layer_id) */
+  gint32             dst_width;
+  gint32             dst_height;
+  gint32             bpp;
+  GapMorphTweenJob  *jobs;
+  gint32             numJobs;
+  gint32             maxResident;
+  gint               numThreads;
+  gboolean           haveWorkers;       /* FALSE: jobs are rendered in the main thread */
+  GapMorphTweenWorker workers[GAP_MORPH_WARP_MAX_THREADS];
+
+  GMutex            *mutex;             /* protects the following members */
+  GCond             *cond;
+  gint32             nextJob;
+  gint32             firstResident;
+  gint32             numWorkersActive;
+  gboolean           cancel;
+  gint32             refCount;          /* one reference per queued worker + one for the main thread */
+} GapMorphTweenBatch;
+
 extern int gap_debug;
 
 static inline gdouble     p_get_tolerance(gdouble dist);
-static void               p_clip_gimp_pixel_fetcher_get_pixel(GimpPixelFetcher *pft
-                                   ,GimpDrawable     *drawable
+static inline void        p_clip_get_pixel(GapMorphWarpLayerData *wld
                                    ,gint xi
                                    ,gint yi
                                    ,guchar *pixel
                                    );
-static void               p_bilinear_get_pixel(GimpPixelFetcher *pft
-                                         , GimpDrawable     *drawable
+static void               p_bilinear_get_pixel(GapMorphWarpLayerData *wld
                                          , gdouble needx
                                          , gdouble needy
                                          , guchar *dest
@@ -123,14 +237,16 @@ static void               p_pixel_warp_core(GapMorphWarpCoreAPI *wcap
                                       , gdouble *out_pick_x
                                       , gdouble *out_pick_y
                                       );
-static void               p_pixel_warp_pick(GapMorphWarpCoreAPI *wcap
+static void               p_pixel_warp_pick(GapMorphWarpThreadData *wtd
+                                      , GapMorphWarpCoreAPI *wcap
                                       , gint32        in_x
                                       , gint32        in_y
                                       , gint          set_idx
                                       , gdouble      *out_pick_x
                                       , gdouble      *out_pick_y
                                       );
-static void               p_pixel_warp_multipick(GapMorphWarpCoreAPI *wcap_1
+static void               p_pixel_warp_multipick(GapMorphWarpThreadData *wtd
+                                      , GapMorphWarpCoreAPI *wcap_1
                                       , GapMorphWarpCoreAPI *wcap_2
                                       , gdouble       wp_mix_factor
                                       , gint32        in_x
@@ -153,20 +269,6 @@ static gint32 p_get_tween_steps_and_layerstacks(GapMorphGlobalParams *mgpp, GapM
 #define GAP_MORPH_WORKPOINT_FILE_HEADER "GAP-MORPH workpoint file"
 
 
-typedef struct GapMorphExePickCache
-{
-  gboolean valid;
-  gdouble  xx;
-  gdouble  yy;
-  gdouble  pick_x;
-  gdouble  pick_y;
-  
-} GapMorphExePickCache;
-
-#define GAP_MORPH_PCK_CACHE_SIZE 32
-static  GapMorphExePickCache gloabl_pick_cache[GAP_MORPH_PCK_CACHE_SIZE][2];
-static  gint gloabl_pick_cache_idx[2];
-
 
 /* ---------------------------------
  * p_get_tolerance
@@ -569,6 +671,7 @@ p_load_workpoint_set(const char *filename
   gint32              tween_steps;
   
   wps = g_new(GapMorphWarpCoreAPI ,1);
+  wps->wp_grid = NULL;
   wps->wp_list = p_load_workpointfile(filename
                                 ,mgpp->osrc_layer_id
                                 ,mgpp->fdst_layer_id
@@ -750,23 +853,25 @@ gap_morph_exec_find_dst_drawable(gint32 image_id, gint32 layer_id)
 
 
 /* -----------------------------------
- * p_clip_gimp_pixel_fetcher_get_pixel
+ * p_clip_get_pixel
  * -----------------------------------
+ * get one pixel from the source layer pixel data wld->src_data
  */
-static void
-p_clip_gimp_pixel_fetcher_get_pixel(GimpPixelFetcher *pft
-                                   ,GimpDrawable     *drawable
-                                   ,gint xi
-                                   ,gint yi
-                                   ,guchar *pixel
-                                   )
+static inline void
+p_clip_get_pixel(GapMorphWarpLayerData *wld
+                ,gint xi
+                ,gint yi
+                ,guchar *pixel
+                )
 {
   if((xi >= 0)
   && (yi >= 0)
-  && (xi < (gint)drawable->width)
-  && (yi < (gint)drawable->height))
+  && (xi < wld->src_width)
+  && (yi < wld->src_height))
   {
-    gimp_pixel_fetcher_get_pixel (pft, xi, yi, pixel);
+    memcpy(pixel
+          , wld->src_data + (((yi * wld->src_width) + xi) * wld->bpp)
+          , wld->bpp);
   }
   else
   {
@@ -776,7 +881,7 @@ p_clip_gimp_pixel_fetcher_get_pixel(GimpPixelFetcher *pft
     pixel[2] = 0;
     pixel[3] = 0;
   }
-}  /* end p_clip_gimp_pixel_fetcher_get_pixel */
+}  /* end p_clip_get_pixel */
 
 /* ------------------------
  * p_bilinear_get_pixel
@@ -786,8 +891,7 @@ p_clip_gimp_pixel_fetcher_get_pixel(GimpPixelFetcher *pft
  * and calculate the value by bilinear interpolation.
  */
 static void
-p_bilinear_get_pixel(GimpPixelFetcher *pft
-                    ,GimpDrawable     *drawable
+p_bilinear_get_pixel(GapMorphWarpLayerData *wld
                     , gdouble needx
                     , gdouble needy
                     , guchar *dest
@@ -811,12 +915,12 @@ p_bilinear_get_pixel(GimpPixelFetcher *pft
   else
     yi = -((int) -needy + 1);
 
-  p_clip_gimp_pixel_fetcher_get_pixel (pft, drawable, xi,     yi,     pixel[0]);
-  p_clip_gimp_pixel_fetcher_get_pixel (pft, drawable, xi + 1, yi,     pixel[1]);
-  p_clip_gimp_pixel_fetcher_get_pixel (pft, drawable, xi,     yi + 1, pixel[2]);
-  p_clip_gimp_pixel_fetcher_get_pixel (pft, drawable, xi + 1, yi + 1, pixel[3]);
+  p_clip_get_pixel (wld, xi,     yi,     pixel[0]);
+  p_clip_get_pixel (wld, xi + 1, yi,     pixel[1]);
+  p_clip_get_pixel (wld, xi,     yi + 1, pixel[2]);
+  p_clip_get_pixel (wld, xi + 1, yi + 1, pixel[3]);
 
-  for (k = 0; k < drawable->bpp; k++)
+  for (k = 0; k < wld->bpp; k++)
   {
     values[0] = pixel[0][k];
     values[1] = pixel[1][k];
@@ -1035,6 +1139,204 @@ p_calc_angle(GapMorphWorkPoint *wp, gint32 in_x, gint32 in_y)
 }   /* end p_calc_angle */
 
 
+/* ---------------------------------
+ * p_next_candidate_wp
+ * ---------------------------------
+ * returns the next workpoint to be checked by p_pixel_warp_core.
+ * without spatial index (wp_cand == NULL) this is the next point in the wp_list,
+ * otherwise the next candidate of the current grid cell.
+ */
+static inline GapMorphWorkPoint *
+p_next_candidate_wp(GapMorphWorkPoint *wp
+                   , GapMorphWorkPoint **wp_cand
+                   , gint32 *cand_idx
+                   , gint32 cand_count)
+{
+  if(wp_cand == NULL)
+  {
+    return ((GapMorphWorkPoint *)wp->next);
+  }
+  (*cand_idx)++;
+  if(*cand_idx < cand_count)
+  {
+    return (wp_cand[*cand_idx]);
+  }
+  return (NULL);
+}  /* end p_next_candidate_wp */
+
+
+/* ---------------------------------
+ * p_grid_cell_index
+ * ---------------------------------
+ */
+static inline gint32
+p_grid_cell_index(GapMorphWpGrid *wpgrid, gdouble x, gdouble y)
+{
+  gint32 col;
+  gint32 row;
+
+  col = CLAMP((gint32)floor(x / wpgrid->cell_size), 0, wpgrid->cols -1);
+  row = CLAMP((gint32)floor(y / wpgrid->cell_size), 0, wpgrid->rows -1);
+  return ((row * wpgrid->cols) + col);
+}  /* end p_grid_cell_index */
+
+
+/* ---------------------------------
+ * p_create_wp_grid
+ * ---------------------------------
+ * create a spatial index for the workpoints of the specified wcap->wp_list
+ * that is used by p_pixel_warp_core to check only the workpoints
+ * near the processed pixel (instead of all workpoints in the list).
+ *
+ * The area width x height is divided into square cells. For each cell
+ * the grid holds all workpoints located in the cell itself and its 8 neighbour cells,
+ * in the same order as they appear in the wp_list (the order is relevant
+ * for the selection of the nearest workpoint per sektor and for direct hits).
+ *
+ * The cell size is greater than the largest distance at which
+ * p_pixel_warp_core may accept any workpoint (e.g. the affect_radius,
+ * or the largest sektor tolerance radius for the QUALITY strategy).
+ * Therefore all workpoints outside the neighbour cells are
+ * rejected in the same way by the full list scan, and the warp result
+ * is identical to the unindexed calculation.
+ *
+ * returns NULL in case the index would not reduce the number of checked workpoints.
+ */
+static GapMorphWpGrid *
+p_create_wp_grid(GapMorphWarpCoreAPI *wcap, gint32 width, gint32 height)
+{
+#define GAP_MORPH_GRID_MAX_CELLS 65536
+  GapMorphWpGrid    *wpgrid;
+  GapMorphWorkPoint *wp;
+  gdouble            sqr_max_radius;
+  gint32             cell_size;
+  gint32             cols;
+  gint32             rows;
+  gint32             numCells;
+  gint32             cellIdx;
+  gint32             ii;
+  gint32            *fill_idx;
+
+  sqr_max_radius = wcap->sqr_affect_radius;
+  if(wcap->use_quality_wp_selection)
+  {
+    /* the QUALITY strategy accepts points up to the sektor specific tolerance
+     * (limited by GAP_MORPH_TOL_FAKTOR times the square distance
+     *  of the nearest point in the sektor or GAP_MORPH_MIN_TOL_FAKTOR times
+     *  the square distance of a near point that is within the affect radius)
+     */
+    sqr_max_radius = MAX(sqr_max_radius, wcap->sqr_affect_radius * GAP_MORPH_TOL_FAKTOR);
+    sqr_max_radius = MAX(sqr_max_radius
+                     , MIN(GAP_MORPH_NEAR_SQR_RADIUS, wcap->sqr_affect_radius) * GAP_MORPH_MIN_TOL_FAKTOR);
+  }
+
+  /* the pixel warp is also called for koordinates up to 3 pixels outside the layer
+   * (see p_pixel_warp_pick)
+   */
+  width += 4;
+  height += 4;
+
+  cell_size = 1 + (gint32)sqrt(sqr_max_radius);
+  while(TRUE)
+  {
+    cols = 1 + (width / cell_size);
+    rows = 1 + (height / cell_size);
+    if((cols * rows) <= GAP_MORPH_GRID_MAX_CELLS)
+    {
+      break;
+    }
+    cell_size *= 2;
+  }
+
+  if((cols <= 3) && (rows <= 3))
+  {
+    /* the neighbour cells cover the whole area, the grid does not help */
+    return (NULL);
+  }
+
+  numCells = cols * rows;
+  wpgrid = g_new(GapMorphWpGrid, 1);
+  wpgrid->cell_size = cell_size;
+  wpgrid->cols = cols;
+  wpgrid->rows = rows;
+  wpgrid->cell_start = g_new0(gint32, numCells +1);
+  fill_idx = g_new0(gint32, numCells);
+
+  /* pass 1 count the candidates per cell, pass 2 fill the cells */
+  for(ii=0; ii < 2; ii++)
+  {
+    for(wp = wcap->wp_list; wp != NULL; wp = (GapMorphWorkPoint *)wp->next)
+    {
+      gint32 col;
+      gint32 row;
+      gint32 nbCol;
+      gint32 nbRow;
+
+      cellIdx = p_grid_cell_index(wpgrid, wp->dst_x, wp->dst_y);
+      col = cellIdx % cols;
+      row = cellIdx / cols;
+      for(nbRow = MAX(0, row -1); nbRow <= MIN(rows -1, row +1); nbRow++)
+      {
+        for(nbCol = MAX(0, col -1); nbCol <= MIN(cols -1, col +1); nbCol++)
+        {
+          gint32 nbIdx;
+
+          nbIdx = (nbRow * cols) + nbCol;
+          if(ii == 0)
+          {
+            wpgrid->cell_start[nbIdx +1]++;
+          }
+          else
+          {
+            wpgrid->cell_wps[wpgrid->cell_start[nbIdx] + fill_idx[nbIdx]] = wp;
+            fill_idx[nbIdx]++;
+          }
+        }
+      }
+    }
+
+    if(ii == 0)
+    {
+      for(cellIdx=0; cellIdx < numCells; cellIdx++)
+      {
+        wpgrid->cell_start[cellIdx +1] += wpgrid->cell_start[cellIdx];
+      }
+      wpgrid->cell_wps = g_new(GapMorphWorkPoint*, MAX(1, wpgrid->cell_start[numCells]));
+    }
+  }
+  g_free(fill_idx);
+
+  if(gap_debug)
+  {
+    printf("p_create_wp_grid: cell_size:%d cols:%d rows:%d candidates:%d\n"
+      , (int)cell_size
+      , (int)cols
+      , (int)rows
+      , (int)wpgrid->cell_start[numCells]
+      );
+  }
+
+  return (wpgrid);
+}  /* end p_create_wp_grid */
+
+
+/* ---------------------------------
+ * p_free_wp_grid
+ * ---------------------------------
+ */
+static void
+p_free_wp_grid(GapMorphWpGrid **wpgrid)
+{
+  if(*wpgrid)
+  {
+    g_free((*wpgrid)->cell_start);
+    g_free((*wpgrid)->cell_wps);
+    g_free(*wpgrid);
+    *wpgrid = NULL;
+  }
+}  /* end p_free_wp_grid */
+
+
 /* ---------------------------------
  * p_pixel_warp_core
  * ---------------------------------
@@ -1051,6 +1353,8 @@ p_calc_angle(GapMorphWorkPoint *wp, gint32 in_x, gint32 in_y)
  *  in case there is no workpoint available
  *       the pixel is picked by simply scaling in_x/in_y to ssrc koords
  *
+ *  in case wcap->wp_grid is available only the workpoints
+ *  of the grid cell at in_x/in_y are checked.
  */
 static void
 p_pixel_warp_core(GapMorphWarpCoreAPI *wcap
@@ -1086,8 +1390,24 @@ p_pixel_warp_core(GapMorphWarpCoreAPI *wcap
   gdouble dy;
   gdouble adx;
   gdouble ady;
+  GapMorphWorkPoint **wp_cand;
+  gint32             cand_count;
+  gint32             cand_idx;
+  GapMorphWorkPoint *wp_first;
 
 
+  wp_cand = NULL;
+  cand_count = 0;
+  wp_first = wcap->wp_list;
+  if(wcap->wp_grid)
+  {
+    gint32 cellIdx;
+
+    cellIdx = p_grid_cell_index(wcap->wp_grid, in_x, in_y);
+    wp_cand = &wcap->wp_grid->cell_wps[wcap->wp_grid->cell_start[cellIdx]];
+    cand_count = wcap->wp_grid->cell_start[cellIdx +1] - wcap->wp_grid->cell_start[cellIdx];
+    wp_first = (cand_count > 0) ? wp_cand[0] : NULL;
+  }
 
   /* reset sektor tab */
   for(sek_idx=0; sek_idx < GAP_MORPH_8_SEKTORS; sek_idx++)
@@ -1105,13 +1425,20 @@ p_pixel_warp_core(GapMorphWarpCoreAPI *wcap
    * check for direct hits
    * and build sector table (nearest workpoints foreach sector
    */
-  for(wp=wcap->wp_list; wp != NULL; wp = (GapMorphWorkPoint *)wp->next)
+  for(cand_idx = 0, wp = wp_first; wp != NULL; wp = p_next_candidate_wp(wp, wp_cand, &cand_idx, cand_count))
   {
     dx = in_x - wp->dst_x;
     dy = in_y - wp->dst_y;
     
     wp->sqr_dist =  (dx * dx ) + (dy * dy);
     wp->sek_idx = 0;
+
+    /* the QUALITY selection reads is_alive and next_sek of all candidates
+     * (also those outside the affect radius), init them in each call
+     * to keep the result independent from the previously processed pixel
+     */
+    wp->is_alive = TRUE;
+    wp->next_sek = NULL;
     
     if(wp->sqr_dist <= wcap->sqr_affect_radius)
     {
@@ -1134,8 +1461,6 @@ p_pixel_warp_core(GapMorphWarpCoreAPI *wcap
       }
       else
       {
-        wp->is_alive = TRUE;
-
         /* sektor index 8 sectors */
         sek_idx = p_calc_sector(wp, dx, dy);
         wp->sek_idx = sek_idx;
@@ -1158,7 +1483,6 @@ p_pixel_warp_core(GapMorphWarpCoreAPI *wcap
           /* found 1.st workpint for this sektor */
           wp_sektor_tab[sek_idx] = wp;
         }
-        wp->next_sek = NULL;  /* init empty sektors list */
         if(wp->sqr_dist < min_sqr_dist)
         {
           min_sqr_dist = wp->sqr_dist;
@@ -1201,28 +1525,6 @@ p_pixel_warp_core(GapMorphWarpCoreAPI *wcap
           gdouble l_tol;
           gdouble r_tol;
 
-          /* xy_relation is the representation of the angle
-           * (is used to compare for similar angle in steps 10tiems finer than the 8 sektors.
-           *  and is faster to calculate than the real angle)
-           */
-          adx = abs(in_x - wp_sek->dst_x);
-          ady = abs(in_y - wp_sek->dst_y);
-          if(adx > ady)
-          {
-            wp_sek->xy_relation = (gint)(0.5 + (GAP_MORPH_XY_REL_FAKTOR * (ady / adx)));
-          }
-          else
-          {
-            if(ady != 0)
-            {
-              wp_sek->xy_relation = (gint)(0.5 + (GAP_MORPH_XY_REL_FAKTOR * (adx / ady)));
-            }
-            else
-            {
-              wp_sek->xy_relation = 0;
-            }
-          }
-
           wp_l_sek = wp_sektor_tab[tab_l1_idx[sek_idx]];
           wp_r_sek = wp_sektor_tab[tab_r1_idx[sek_idx]];
           if(wp_l_sek == NULL)
@@ -1269,7 +1571,36 @@ p_pixel_warp_core(GapMorphWarpCoreAPI *wcap
        * but discard those points that have same angle as another nearer point
        * in the same sektor
        */
-      for(wp=wcap->wp_list; wp != NULL; wp = (GapMorphWorkPoint *)wp->next)
+      for(sek_idx = 0; sek_idx < GAP_MORPH_8_SEKTORS; sek_idx++)
+      {
+        wp_sek = wp_sektor_tab[sek_idx];
+        if(wp_sek)
+        {
+          /* xy_relation is the representation of the angle
+           * (is used to compare for similar angle in steps 10tiems finer than the 8 sektors.
+           *  and is faster to calculate than the real angle)
+           */
+          adx = abs(in_x - wp_sek->dst_x);
+          ady = abs(in_y - wp_sek->dst_y);
+          if(adx > ady)
+          {
+            wp_sek->xy_relation = (gint)(0.5 + (GAP_MORPH_XY_REL_FAKTOR * (ady / adx)));
+          }
+          else
+          {
+            if(ady != 0)
+            {
+              wp_sek->xy_relation = (gint)(0.5 + (GAP_MORPH_XY_REL_FAKTOR * (adx / ady)));
+            }
+            else
+            {
+              wp_sek->xy_relation = 0;
+            }
+          }
+        }
+      }
+
+      for(cand_idx = 0, wp = wp_first; wp != NULL; wp = p_next_candidate_wp(wp, wp_cand, &cand_idx, cand_count))
       {
         sek_idx = CLAMP(wp->sek_idx, 0, (GAP_MORPH_8_SEKTORS -1));
 
@@ -1457,6 +1788,7 @@ gap_morph_exec_get_warp_pick_koords(GapMorphWorkPoint *wp_list
   
   wcap->sqr_affect_radius = affect_radius * affect_radius;
   wcap->wp_list = wp_list;
+  wcap->wp_grid = NULL;
   wcap->scale_x = scale_x;
   wcap->scale_y = scale_y;
   wcap->use_gravity = use_gravity;
@@ -1545,7 +1877,8 @@ gap_morph_exec_get_warp_pick_koords(GapMorphWorkPoint *wp_list
  * ---------------------------------
  */
 static void
-p_pixel_warp_pick(GapMorphWarpCoreAPI *wcap
+p_pixel_warp_pick(GapMorphWarpThreadData *wtd
+            , GapMorphWarpCoreAPI *wcap
             , gint32        in_x
             , gint32        in_y
             , gint          set_idx
@@ -1578,7 +1911,7 @@ p_pixel_warp_pick(GapMorphWarpCoreAPI *wcap
    * signifikant different movement settings.
    * To comensate this unwanted effect, we do multiple picks 
    * and use the average pick koordinates.
-   * We use gloabl_pick_cache to reduce the effective
+   * We use the (per thread) pick_cache to reduce the effective
    * number of p_pixel_warp_core calls
    */
   nn = 0;
@@ -1592,7 +1925,7 @@ p_pixel_warp_pick(GapMorphWarpCoreAPI *wcap
       
       for(ii=0; ii < GAP_MORPH_PCK_CACHE_SIZE; ii++)
       {
-        pcp = &gloabl_pick_cache[ii][set_idx];
+        pcp = &wtd->pick_cache[ii][set_idx];
         if ((pcp->valid)
         &&  (pcp->xx == xx)
         &&  (pcp->yy == yy))
@@ -1614,17 +1947,17 @@ p_pixel_warp_pick(GapMorphWarpCoreAPI *wcap
                        ,&pick_y
                        );
          /* save pick koords in cache table */
-         pcp = &gloabl_pick_cache[gloabl_pick_cache_idx[set_idx]][set_idx];
+         pcp = &wtd->pick_cache[wtd->pick_cache_idx[set_idx]][set_idx];
 
          pcp->xx     = xx;
          pcp->yy     = yy;
          pcp->pick_x = pick_x;
          pcp->pick_y = pick_y;
          pcp->valid  = TRUE;
-         gloabl_pick_cache_idx[set_idx]++;
-         if(gloabl_pick_cache_idx[set_idx] >= GAP_MORPH_PCK_CACHE_SIZE)
+         wtd->pick_cache_idx[set_idx]++;
+         if(wtd->pick_cache_idx[set_idx] >= GAP_MORPH_PCK_CACHE_SIZE)
          {
-           gloabl_pick_cache_idx[set_idx] = 0;
+           wtd->pick_cache_idx[set_idx] = 0;
          }
        }
        sum_pick_x += (pick_x - ((in_x - xx) * wcap->scale_x));
@@ -1644,7 +1977,8 @@ p_pixel_warp_pick(GapMorphWarpCoreAPI *wcap
  * ---------------------------------
  */
 static void
-p_pixel_warp_multipick(GapMorphWarpCoreAPI *wcap_1
+p_pixel_warp_multipick(GapMorphWarpThreadData *wtd
+                      ,GapMorphWarpCoreAPI *wcap_1
                       ,GapMorphWarpCoreAPI *wcap_2
                       ,gdouble wp_mix_factor
                       , gint32        in_x
@@ -1665,7 +1999,8 @@ p_pixel_warp_multipick(GapMorphWarpCoreAPI *wcap_1
   
   if(wp_mix_factor != 0.0)
   {
-    p_pixel_warp_pick(wcap_1
+    p_pixel_warp_pick(wtd
+          , wcap_1
           , in_x
           , in_y
           , 0                      /* set_idx */
@@ -1676,7 +2011,8 @@ p_pixel_warp_multipick(GapMorphWarpCoreAPI *wcap_1
   
   if(wp_mix_factor != 1.0)
   {
-    p_pixel_warp_pick(wcap_1
+    p_pixel_warp_pick(wtd
+          , wcap_1
           , in_x
           , in_y
           , 1                      /* set_idx */
@@ -1844,721 +2180,1570 @@ p_calculate_work_point_movement(gdouble total_steps
 
 
 /* ---------------------------------
- * p_layer_warp_move
+ * p_copy_workpoint_list
  * ---------------------------------
+ * return a duplicate of the specified workpoint list (same order)
  */
-static void
-p_layer_warp_move (GapMorphWorkPoint     *wp_list_1
-                  ,GapMorphWorkPoint     *wp_list_2
-                  , gint32                src_layer_id
-                  , gint32                dst_layer_id
-                  , GapMorphGlobalParams *mgpp
-                  , GapMorphWarpCoreAPI  *p1
-                  , GapMorphWarpCoreAPI  *p2
-                  , gdouble               wp_mix_factor
-                  )
+static GapMorphWorkPoint *
+p_copy_workpoint_list(GapMorphWorkPoint *master_list)
 {
-  GapMorphWarpCoreAPI  wcap_struct_1;
-  GapMorphWarpCoreAPI  wcap_struct_2;
-  GapMorphWarpCoreAPI *wcap_1;
-  GapMorphWarpCoreAPI *wcap_2;
-  GimpDrawable *src_drawable;
-  GimpDrawable *dst_drawable;
-  GimpPixelFetcher *src_pixfet;
-  GimpPixelRgn    dstPR;
-  gpointer        pr;
-  guchar         *pixel_ptr;
-  guint32         l_row;
-  guint32         l_col;
-  gdouble         scale_x;
-  gdouble         scale_y;
-  gdouble         l_max_progress;
-  gdouble         l_progress;
-  gint ii;
-  gint set_idx;
-
-  wcap_1 = &wcap_struct_1;
-  wcap_2 = &wcap_struct_2;
-
-  wcap_1->wp_list = wp_list_1;
-  wcap_2->wp_list = wp_list_2;
-  
-  wcap_1->sqr_affect_radius = mgpp->affect_radius * mgpp->affect_radius;
-  wcap_1->use_gravity = mgpp->use_gravity;
-  wcap_1->gravity_intensity = mgpp->gravity_intensity;
-  if(p1)
-  {
-    wcap_1->sqr_affect_radius = p1->affect_radius * p1->affect_radius;
-    wcap_1->use_gravity = p1->use_gravity;
-    wcap_1->gravity_intensity = p1->gravity_intensity;
-  }
-  
-  wcap_2->sqr_affect_radius = mgpp->affect_radius * mgpp->affect_radius;
-  wcap_2->use_gravity = mgpp->use_gravity;
-  wcap_2->gravity_intensity = mgpp->gravity_intensity;
-  if(p2)
-  {
-    wcap_2->sqr_affect_radius = p2->sqr_affect_radius * p2->sqr_affect_radius;
-    wcap_2->use_gravity = p2->use_gravity;
-    wcap_2->gravity_intensity = p2->gravity_intensity;
-  }
-  
-
-  wcap_1->printf_flag = FALSE;
-  wcap_2->printf_flag = FALSE;
+  GapMorphWorkPoint *wp;
+  GapMorphWorkPoint *wp_list;
+  GapMorphWorkPoint *wp_elem_dup;
+  GapMorphWorkPoint *wp_elem_prev;
 
-  wcap_1->use_quality_wp_selection = mgpp->use_quality_wp_selection;
-  wcap_2->use_quality_wp_selection = mgpp->use_quality_wp_selection;
-  
-  /* clear the global cache for picking koordinates */
-  for(set_idx=0; set_idx < 2; set_idx++)
+  wp_list = NULL;
+  wp_elem_prev = NULL;
+  for(wp = master_list; wp != NULL; wp = (GapMorphWorkPoint *)wp->next)
   {
-    for(ii=0; ii < GAP_MORPH_PCK_CACHE_SIZE; ii++)
+    wp_elem_dup = g_new(GapMorphWorkPoint, 1);
+    memcpy(wp_elem_dup, wp, sizeof(GapMorphWorkPoint));
+    wp_elem_dup->next = NULL;
+    if(wp_elem_prev == NULL)
+    {
+      wp_list = wp_elem_dup;
+    }
+    else
     {
-       gloabl_pick_cache[ii][set_idx].valid = FALSE;
+      wp_elem_prev->next = wp_elem_dup;
     }
-    gloabl_pick_cache_idx[set_idx] = 0;
+    wp_elem_prev = wp_elem_dup;
   }
+  return(wp_list);
+}  /* end p_copy_workpoint_list */
 
-  src_drawable = gimp_drawable_get (src_layer_id);
-  dst_drawable = gimp_drawable_get (dst_layer_id);
 
-  if(src_drawable == NULL)                   { return; }
-  if(dst_drawable == NULL)                   { return; }
-  if(src_drawable->bpp != dst_drawable->bpp) { return; }
-  if((src_drawable->bpp != 4)  && (src_drawable->bpp != 2))
-  { 
-    return;
+/* ---------------------------------
+ * p_reset_workpoint_list_copy
+ * ---------------------------------
+ * reset all members of the workpoints in wp_list (that was created via p_copy_workpoint_list)
+ * to the values of the corresponding workpoints in the master_list.
+ * This discards all per pixel scratch values left over from the previous
+ * p_pixel_warp_core calls.
+ */
+static void
+p_reset_workpoint_list_copy(GapMorphWorkPoint *wp_list, GapMorphWorkPoint *master_list)
+{
+  GapMorphWorkPoint *wp;
+  GapMorphWorkPoint *wp_master;
+  void              *next;
+
+  wp_master = master_list;
+  for(wp = wp_list; (wp != NULL) && (wp_master != NULL); wp = (GapMorphWorkPoint *)next)
+  {
+    next = wp->next;
+    memcpy(wp, wp_master, sizeof(GapMorphWorkPoint));
+    wp->next = next;
+    wp_master = (GapMorphWorkPoint *)wp_master->next;
   }
+}  /* end p_reset_workpoint_list_copy */
 
 
-  /* if src and dst size not equal: caluclate scaling factors x/y */
-  scale_x = src_drawable->width / MAX(1,dst_drawable->width);
-  scale_y = src_drawable->height / MAX(1,dst_drawable->height);
+/* ---------------------------------
+ * p_warp_get_next_band
+ * ---------------------------------
+ * returns the index of the next row band to be rendered
+ * or -1 when all bands are already assigned.
+ */
+static gint32
+p_warp_get_next_band(GapMorphWarpLayerData *wld)
+{
+  gint32 bandIdx;
 
-  wcap_1->scale_x = scale_x;
-  wcap_2->scale_x = scale_x;
-  wcap_1->scale_y = scale_y;
-  wcap_2->scale_y = scale_y;
+  g_mutex_lock(wld->mutex);
+  bandIdx = -1;
+  if(wld->nextBand < wld->numBands)
+  {
+    bandIdx = wld->nextBand;
+    wld->nextBand++;
+  }
+  g_mutex_unlock(wld->mutex);
 
-  /* init Pixel Fetcher for source drawable  */
-  src_pixfet = gimp_pixel_fetcher_new (src_drawable, FALSE /*shadow*/);
-  if(src_drawable == NULL)                   { return; }
+  return (bandIdx);
+}  /* end p_warp_get_next_band */
 
-  
-  /* init Pixel Region  */
-  gimp_pixel_rgn_init (&dstPR, dst_drawable
-                      , 0
-                      , 0
-                      , dst_drawable->width
-                      , dst_drawable->height
-                      , TRUE      /* dirty */
-                      , TRUE      /* shadow */
-                       );
 
-  l_max_progress = dst_drawable->width * dst_drawable->height;
-  l_progress = 0;
+/* ---------------------------------
+ * p_warp_clear_pick_cache
+ * ---------------------------------
+ */
+static void
+p_warp_clear_pick_cache(GapMorphWarpThreadData *wtd)
+{
+  gint ii;
+  gint set_idx;
+
+  for(set_idx=0; set_idx < 2; set_idx++)
+  {
+    for(ii=0; ii < GAP_MORPH_PCK_CACHE_SIZE; ii++)
+    {
+       wtd->pick_cache[ii][set_idx].valid = FALSE;
+    }
+    wtd->pick_cache_idx[set_idx] = 0;
+  }
+}  /* end p_warp_clear_pick_cache */
+
+
+/* ---------------------------------
+ * p_warp_rect
+ * ---------------------------------
+ * render the warped pixels of the rectangle x1/y1 (inclusive) upto x2/y2 (exclusive)
+ * row by row into wld->dst_data.
+ */
+static void
+p_warp_rect(GapMorphWarpThreadData *wtd, gint32 x1, gint32 y1, gint32 x2, gint32 y2)
+{
+  GapMorphWarpLayerData *wld;
+  guchar         *pixel_ptr;
+  gint32          l_row;
+  gint32          l_col;
 
+  wld = wtd->wld;
 
-  for (pr = gimp_pixel_rgns_register (1, &dstPR);
-       pr != NULL;
-       pr = gimp_pixel_rgns_process (pr))
+  for (l_row = y1; l_row < y2; l_row++)
   {
-     guint x;
-     guint y;
-     guchar *dest;
+     pixel_ptr = wld->dst_data + (((l_row * wld->dst_width) + x1) * wld->bpp);
 
-     dest = dstPR.data;
-     for (y = 0; y < dstPR.h; y++)
+     for (l_col = x1; l_col < x2; l_col++)
      {
-        pixel_ptr = dest;
-        l_row = dstPR.y + y;
-        
-        for (x = 0; x < dstPR.w; x++)
+        gdouble            pick_x;
+        gdouble            pick_y;
+
+        if(wld->have_workpointsets)
         {
-           gdouble            pick_x;
-           gdouble            pick_y;
-           
-           l_col = dstPR.x + x;
-           if(mgpp->have_workpointsets)
-           {
-             /* pick based on 2 sets of workpoints */
-             p_pixel_warp_multipick(wcap_1  /*  list1 */
-                   , wcap_2                 /*  list2 */
-                   , wp_mix_factor
-                   , l_col
-                   , l_row
-                   , &pick_x
-                   , &pick_y
-                   );
-           }
-           else
-           {
-             /* pick based on a single set of workpoints */
-             p_pixel_warp_pick(wcap_1
-                   , l_col
-                   , l_row
-                   , 0                      /* set_idx */
-                   , &pick_x
-                   , &pick_y
-                   );
-           }
-           p_bilinear_get_pixel (src_pixfet
-                                ,src_drawable
-                                ,pick_x
-                                ,pick_y
-                                ,pixel_ptr
-                                ,dst_drawable->bpp);
-           pixel_ptr += dstPR.bpp;
+          /* pick based on 2 sets of workpoints */
+          p_pixel_warp_multipick(wtd
+                , &wtd->wcap_1           /*  list1 */
+                , &wtd->wcap_2           /*  list2 */
+                , wld->wp_mix_factor
+                , l_col
+                , l_row
+                , &pick_x
+                , &pick_y
+                );
         }
-        dest += dstPR.rowstride;
-     }
-     
-     if(mgpp->do_progress)
-     {
-       gdouble l_total_progress;
-       
-       l_progress += (dstPR.w * dstPR.h);
-       l_total_progress = mgpp->master_progress 
-                           + (mgpp->layer_progress_step * (l_progress /l_max_progress));
-
-       /*
-        * if)gap_debug)
-        * {
-        *   printf("Progress: mgpp->master_progress:%f mgpp->layer_progress_step:%f l_total_progress:%f\n"
-        *    ,(float)mgpp->master_progress
-        *    ,(float)mgpp->layer_progress_step
-        *    ,(float)l_total_progress
-        *    );
-        * }
-        */
-        
-       if(mgpp->progress_callback_fptr == NULL)
-       {
-         gimp_progress_update(l_total_progress);
-       }
-       else
-       {
-         (*mgpp->progress_callback_fptr)(l_total_progress, mgpp->callback_data_ptr);
-       }
+        else
+        {
+          /* pick based on a single set of workpoints */
+          p_pixel_warp_pick(wtd
+                , &wtd->wcap_1
+                , l_col
+                , l_row
+                , 0                      /* set_idx */
+                , &pick_x
+                , &pick_y
+                );
+        }
+        p_bilinear_get_pixel (wld
+                             ,pick_x
+                             ,pick_y
+                             ,pixel_ptr
+                             ,wld->bpp);
+        pixel_ptr += wld->bpp;
      }
-
   }
+}  /* end p_warp_rect */
 
-  gimp_drawable_flush (dst_drawable);
-  gimp_drawable_merge_shadow (dst_drawable->drawable_id, TRUE);
-  gimp_drawable_update (dst_layer_id
-                      , 0
-                      , 0
-                      , dst_drawable->width
-                      , dst_drawable->height
-                      );
-  gimp_pixel_fetcher_destroy (src_pixfet);
-
-  gimp_drawable_detach(src_drawable);
-  gimp_drawable_detach(dst_drawable);
-}   /* end p_layer_warp_move */
 
 /* ---------------------------------
- * p_mix_layers
+ * p_warp_band
  * ---------------------------------
- * create a layer by mixing bg_layer_id and top_layer_id
+ * render the warped pixels of one row band into wld->dst_data.
+ * Each band starts with the initial workpoint values and an empty pick cache,
+ * therefore the result does not depend on the number of threads
+ * and on the order in which the bands are processed.
  */
-static gint32
-p_mix_layers (gint32  curr_image_id
-                  ,gint32  bg_layer_id
-                  ,gint32  top_layer_id
-                  ,gint32  curr_width
-                  ,gint32  curr_height
-                  ,gdouble curr_mix_factor  /* 0.0 <= mix <= 1.0 */
-                  )
+static void
+p_warp_band(GapMorphWarpThreadData *wtd, gint32 bandIdx)
 {
-  gint32        dst_layer_id;
-  GimpDrawable *top_drawable;
-  GimpDrawable *bg_drawable;
-  GimpDrawable *dst_drawable;
-  GimpPixelRgn    dstPR;
-  GimpPixelRgn    topPR;
-  GimpPixelRgn    bgPR;
-  gpointer        pr;
+  GapMorphWarpLayerData *wld;
+  gint32          l_row;
 
-  if(gap_debug)
-  {
-    printf("p_mix_layers START curr_mix_factor: %f\n"
-      ,(float)curr_mix_factor
-      );
-  }
+  wld = wtd->wld;
 
-  top_drawable = gimp_drawable_get (top_layer_id);
-  bg_drawable  = gimp_drawable_get (bg_layer_id);
+  p_reset_workpoint_list_copy(wtd->wcap_1.wp_list, wtd->master_list_1);
+  p_reset_workpoint_list_copy(wtd->wcap_2.wp_list, wtd->master_list_2);
+  p_warp_clear_pick_cache(wtd);
 
-  if(top_drawable == NULL)                   { return (-1); }
-  if(bg_drawable == NULL)                    { return (-1); }
-  if(top_drawable->bpp < 3)
-  {
-    dst_layer_id = gimp_layer_new(curr_image_id, "morph_tween"
-                               , curr_width
-                               , curr_height
-                               , GIMP_GRAYA_IMAGE
-                               , 100.0      /* full opaque */
-                               , GIMP_NORMAL_MODE
-                               );
-  }
-  else
-  {
-    dst_layer_id = gimp_layer_new(curr_image_id, "morph_tween"
-                               , curr_width
-                               , curr_height
-                               , GIMP_RGBA_IMAGE
-                               , 100.0      /* full opaque */
-                               , GIMP_NORMAL_MODE
-                               );
-  }
-  
+  l_row = bandIdx * GAP_MORPH_WARP_BAND_HEIGHT;
+  p_warp_rect(wtd, 0, l_row
+             , wld->dst_width
+             , MIN(l_row + GAP_MORPH_WARP_BAND_HEIGHT, wld->dst_height)
+             );
+}  /* end p_warp_band */
 
-  gimp_image_add_layer(curr_image_id, dst_layer_id, 0);
 
+/* ---------------------------------
+ * p_warp_layer_data_unref
+ * ---------------------------------
+ * drop one reference to the shared data of a p_layer_warp_move call,
+ * it is freed when the last reference is dropped.
+ */
+static void
+p_warp_layer_data_unref(GapMorphWarpLayerData *wld)
+{
+  gint32 refCount;
 
-  dst_drawable = gimp_drawable_get (dst_layer_id);
-  if(dst_drawable == NULL)                   { return (-1); }
+  g_mutex_lock(wld->mutex);
+  wld->refCount--;
+  refCount = wld->refCount;
+  g_mutex_unlock(wld->mutex);
 
-  if(gap_debug)
+  if(refCount <= 0)
   {
-    printf("p_mix_layers dst_layer_id: %d bpp:%d  top_layer_id:%d bpp:%d  bg_layer_id:%d bpp:%d\n"
-      ,(int)dst_layer_id
-      ,(int)dst_drawable->bpp
-      ,(int)top_layer_id
-      ,(int)top_drawable->bpp
-      ,(int)bg_layer_id
-      ,(int)bg_drawable->bpp
-      );
+    g_mutex_free(wld->mutex);
+    g_cond_free(wld->cond);
+    g_free(wld->wtdArray);
+    g_free(wld);
   }
+}  /* end p_warp_layer_data_unref */
 
 
-  
-  /* init Pixel Region  */
-  gimp_pixel_rgn_init (&dstPR, dst_drawable
-                      , 0
-                      , 0
-                      , dst_drawable->width
-                      , dst_drawable->height
-                      , TRUE      /* dirty */
-                      , TRUE      /* shadow */
-                       );
-  gimp_pixel_rgn_init (&topPR, top_drawable
-                      , 0
-                      , 0
-                      , top_drawable->width
-                      , top_drawable->height
-                      , FALSE      /* dirty */
-                      , FALSE      /* shadow */
-                       );
-  gimp_pixel_rgn_init (&bgPR, bg_drawable
-                      , 0
-                      , 0
-                      , bg_drawable->width
-                      , bg_drawable->height
-                      , FALSE      /* dirty */
-                      , FALSE      /* shadow */
-                       );
+/* ---------------------------------
+ * p_warp_WorkerThreadFunction
+ * ---------------------------------
+ * this function runs in concurrent parallel worker threads.
+ * each thread renders row bands until all bands are assigned.
+ * A worker that was queued but was already given up by the main thread
+ * (see p_warp_start_worker) just drops its reference.
+ * (the worker threads do not call any gimp procedures)
+ */
+static void
+p_warp_WorkerThreadFunction(GapMorphWarpThreadData *wtd)
+{
+  GapMorphWarpLayerData *wld;
+  gint32 bandIdx;
+  gboolean isClaimed;
 
-  for (pr = gimp_pixel_rgns_register (3, &dstPR, &topPR, &bgPR);
-       pr != NULL;
-       pr = gimp_pixel_rgns_process (pr))
+  wld = wtd->wld;
+
+  g_mutex_lock(wld->mutex);
+  isClaimed = (wtd->isStarted != TRUE);
+  wtd->isStarted = TRUE;
+  g_mutex_unlock(wld->mutex);
+
+  if(isClaimed)
   {
-     guint x;
-     guint y;
-     guchar *dest;
-     guchar *top;
-     guchar *bg;
-     guchar         *pixel_ptr;
-     guchar         *top_ptr;
-     guchar         *bg_ptr;
+    while((bandIdx = p_warp_get_next_band(wld)) >= 0)
+    {
+      p_warp_band(wtd, bandIdx);
 
-     dest = dstPR.data;
-     top  = topPR.data;
-     bg   = bgPR.data;
-     for (y = 0; y < dstPR.h; y++)
-     {
-        pixel_ptr = dest;
-        top_ptr = top;
-        bg_ptr = bg;
-        
-        for (x = 0; x < dstPR.rowstride ; x++)
-        {
-           gdouble val;
-           
-           val = GAP_BASE_MIX_VALUE(curr_mix_factor, (gdouble)(*bg_ptr), (gdouble)(*top_ptr));
-           *pixel_ptr = (guchar)val;
-           
-           pixel_ptr++;
-           top_ptr++;
-           bg_ptr++;
-        }
-        dest += dstPR.rowstride;
-        top  += topPR.rowstride;
-        bg   += bgPR.rowstride;
-     }
-  }
+      g_mutex_lock(wld->mutex);
+      wld->bandsDone++;
+      g_cond_signal(wld->cond);
+      g_mutex_unlock(wld->mutex);
+    }
 
-  gimp_drawable_flush (dst_drawable);
-  gimp_drawable_merge_shadow (dst_drawable->drawable_id, TRUE);
-  gimp_drawable_update (dst_layer_id
-                      , 0
-                      , 0
-                      , dst_drawable->width
-                      , dst_drawable->height
-                      );
+    g_mutex_lock(wld->mutex);
+    wld->numWorkersActive--;
+    g_cond_signal(wld->cond);
+    g_mutex_unlock(wld->mutex);
+  }
 
-  gimp_drawable_detach(bg_drawable);
-  gimp_drawable_detach(top_drawable);
-  gimp_drawable_detach(dst_drawable);
+  p_warp_layer_data_unref(wld);
 
-  return(dst_layer_id);
+}  /* end p_warp_WorkerThreadFunction */
 
-}   /* end p_mix_layers */
 
 /* ---------------------------------
- * p_create_morph_tween_frame
+ * p_warp_start_worker
  * ---------------------------------
- * return the newly created tween morphed layer
+ * hand over the thread data wtd to the thread pool.
+ * glib queues the data even when no additional thread could be started.
+ * In that case the worker is given up (unless a pool thread has already
+ * picked it up) and the main thread renders its bands.
  */
-static gint32
-p_create_morph_tween_frame(gint32 total_steps
-                          ,gint32 current_step
-                          ,GapMorphGlobalParams *mgpp
-                          ,GapMorphExeLayerstack *mlayers
-                          )
+static void
+p_warp_start_worker(GThreadPool *threadPool, GapMorphWarpThreadData *wtd)
 {
-   GimpDrawable *dst_drawable;
-   gint32  curr_image_id;  /* a temp image of current layer size */
-   gint32  bg_layer_id;
-   gint32  top_layer_id;
-   gint32  merged_layer_id;
-   gint32  curr_width;
-   gint32  curr_height;
-   gdouble curr_opacity;
-   GapMorphWorkPoint *curr_wp_list_1;
-   GapMorphWorkPoint *curr_wp_list_2;
-   GapMorphWarpCoreAPI *wp_set_1;
-   GapMorphWarpCoreAPI *wp_set_2;
-   gint32 src_layer_id;
-   gint32 dst_layer_id;
-   gboolean forward_move;
-   gdouble  wp_mix_factor;
-   
-   forward_move = TRUE;
-   src_layer_id = mgpp->osrc_layer_id;
-   dst_layer_id = mgpp->fdst_layer_id;
+  GapMorphWarpLayerData *wld;
+  GError *error;
 
-   wp_set_1 = NULL;
-   wp_set_2 = NULL;
-   wp_mix_factor = 1.0;
+  wld = wtd->wld;
+  wtd->isStarted = FALSE;
 
-   if(gap_debug)
-   {
-     printf("p_create_morph_tween_frame START total_steps:%d  current_step:%d\n"
-            " mgpp->create_tween_layers:%d\n"
-            " mgpp->have_workpointsets:%d\n"
-            " mlayers->available_wp_sets:%d\n"
-            " mgpp->render_mode:%d\n"
-       ,(int)total_steps
-       ,(int)current_step
-       ,(int)mgpp->create_tween_layers
-       ,(int)mgpp->have_workpointsets
-       ,(int)mlayers->available_wp_sets
-       ,(int)mgpp->render_mode
-       );
-   }
+  g_mutex_lock(wld->mutex);
+  wld->numWorkersActive++;
+  wld->refCount++;
+  g_mutex_unlock(wld->mutex);
 
-   if(mgpp->create_tween_layers)
-   {
-     /* size of the new frame */
-     curr_width = p_linear_advance((gdouble)total_steps
-                                  ,(gdouble)current_step
-                                  ,(gdouble)gimp_drawable_width(src_layer_id)
-                                  ,(gdouble)gimp_drawable_width(dst_layer_id)
-                                  );
-     curr_height = p_linear_advance((gdouble)total_steps
-                                  ,(gdouble)current_step
-                                  ,(gdouble)gimp_drawable_height(src_layer_id)
-                                  ,(gdouble)gimp_drawable_height(dst_layer_id)
-                                  );
-   }
-   else
-   {
-     gint ii;
-     
-     ii = mlayers->dst1_idx - (current_step -1);
-     
-     /* operate on existing destination layers */
-     dst_layer_id = mlayers->dst_layers[ii];
-     curr_width = gimp_drawable_width(dst_layer_id);
-     curr_height = gimp_drawable_height(dst_layer_id);
-     
-     ii = p_linear_advance((gdouble)total_steps
-                                  ,(gdouble)current_step
-                                  ,(gdouble)mlayers->src1_idx
-                                  ,(gdouble)mlayers->src2_idx
-                                  );
+  error = NULL;
+  g_thread_pool_push (threadPool
+                     , wtd    /* user Data for the worker thread*/
+                     , &error
+                     );
+  if(error != NULL)
+  {
+    printf("** WARNING p_layer_warp_move: could not push worker %d to the thread pool %s\n"
+      , (int)wtd->cpuId
+      , error->message
+      );
+    g_error_free(error);
 
-     /* in this case also operate with changing source layers (if there are more than one) */
-     src_layer_id = mlayers->src_layers[ii];
-   }
+    g_mutex_lock(wld->mutex);
+    if(wtd->isStarted != TRUE)
+    {
+      wtd->isStarted = TRUE;
+      wld->numWorkersActive--;
+    }
+    g_mutex_unlock(wld->mutex);
+  }
+}  /* end p_warp_start_worker */
 
-   if((mgpp->have_workpointsets)
-   && (mlayers->available_wp_sets > 1))
-   {
-     gint wps_idx;
-     gint wps_idx_2;
-     gdouble wp_stepspeed;
-     gdouble ref;
-     
-     wp_stepspeed = (gdouble)(mlayers->available_wp_sets -1) / (gdouble)MIN((total_steps -1),1);
-     ref = (gdouble)((gdouble)(current_step -1) * wp_stepspeed);
-     wps_idx = (gint)ref;
-     wps_idx_2 = MIN(wps_idx+1, (mlayers->available_wp_sets -1));
 
-     wp_set_1 = mlayers->tab_wp_sets[wps_idx];
-     wp_set_2 = mlayers->tab_wp_sets[wps_idx_2];
-     wp_mix_factor = ref - (gdouble)wps_idx;
-   }
+/* ---------------------------------
+ * p_warp_progress_update
+ * ---------------------------------
+ */
+static void
+p_warp_progress_update(GapMorphGlobalParams *mgpp, gdouble l_progress)
+{
+  gdouble l_total_progress;
 
-   dst_drawable = gimp_drawable_get (dst_layer_id);
+  if(!mgpp->do_progress)
+  {
+    return;
+  }
 
-   if(gap_debug)
-   {
-     printf("p_create_morph_tween_frame dst_layer_id:%d, bpp:%d\n"
-        ,(int)dst_layer_id
-        ,(int)dst_drawable->bpp
-        );
-   }   
+  l_total_progress = mgpp->master_progress 
+                      + (mgpp->layer_progress_step * l_progress);
 
-   /* add empty BG layer */
-   if(dst_drawable->bpp < 3)
-   {
-     /* create the tween frame image */
-     curr_image_id = gimp_image_new(curr_width, curr_height, GIMP_GRAY);
+  if(mgpp->progress_callback_fptr == NULL)
+  {
+    gimp_progress_update(l_total_progress);
+  }
+  else
+  {
+    (*mgpp->progress_callback_fptr)(l_total_progress, mgpp->callback_data_ptr);
+  }
+}  /* end p_warp_progress_update */
 
-     bg_layer_id = gimp_layer_new(curr_image_id, "bg_morph_layer"
-                               , curr_width
-                               , curr_height
-                               , GIMP_GRAYA_IMAGE
-                               , 100.0      /* full opaque */
-                               , GIMP_NORMAL_MODE
-                               );
-   }
-   else
-   {
-     /* create the tween frame image */
-     curr_image_id = gimp_image_new(curr_width, curr_height, GIMP_RGB);
-     bg_layer_id = gimp_layer_new(curr_image_id, "bg_morph_layer"
-                               , curr_width
-                               , curr_height
-                               , GIMP_RGBA_IMAGE
-                               , 100.0      /* full opaque */
-                               , GIMP_NORMAL_MODE
-                               );
-   }
-   gimp_image_add_layer(curr_image_id, bg_layer_id, 0);
 
-   /* add empty TOP layer */
-   curr_opacity = p_linear_advance((gdouble)total_steps
-                                ,(gdouble)current_step
-                                ,(gdouble)0.0
-                                ,(gdouble)100.0
-                                );
-   if(dst_drawable->bpp < 3)
-   {
-     top_layer_id = gimp_layer_new(curr_image_id, "top_morph_layer"
-                               , curr_width
-                               , curr_height
-                               , GIMP_GRAYA_IMAGE
-                               , curr_opacity
-                               , GIMP_NORMAL_MODE
-                               );
-   }
-   else
-   {
-     top_layer_id = gimp_layer_new(curr_image_id, "top_morph_layer"
-                               , curr_width
-                               , curr_height
-                               , GIMP_RGBA_IMAGE
-                               , curr_opacity
-                               , GIMP_NORMAL_MODE
-                               );
-   }
-   gimp_image_add_layer(curr_image_id, top_layer_id, 0);
+/* ---------------------------------
+ * p_layer_warp_move
+ * ---------------------------------
+ * render the warped src layer into the dst layer.
+ * The source pixels are read into memory and the warped pixels are
+ * rendered in row bands of GAP_MORPH_WARP_BAND_HEIGHT rows that are spread
+ * on the available processors via a thread pool. The calling (main) thread
+ * renders bands too and handles all gimp calls and progress updates.
+ * p_pixel_warp_core inits all per workpoint scratch values it reads in each call,
+ * therefore the result (for FAST and QUALITY strategy) does not depend
+ * on the pixel order and on the number of threads.
+ */
+static void
+p_layer_warp_move (GapMorphWorkPoint     *wp_list_1
+                  ,GapMorphWorkPoint     *wp_list_2
+                  , gint32                src_layer_id
+                  , gint32                dst_layer_id
+                  , GapMorphGlobalParams *mgpp
+                  , GapMorphWarpCoreAPI  *p1
+                  , GapMorphWarpCoreAPI  *p2
+                  , gdouble               wp_mix_factor
+                  )
+{
+  static GThreadPool  *threadPool = NULL;
+  GapMorphWarpCoreAPI  wcap_struct_1;
+  GapMorphWarpCoreAPI  wcap_struct_2;
+  GapMorphWarpCoreAPI *wcap_1;
+  GapMorphWarpCoreAPI *wcap_2;
+  GapMorphWarpLayerData *wld;
+  GapMorphWarpThreadData *wtd;
+  GimpDrawable *src_drawable;
+  GimpDrawable *dst_drawable;
+  GimpPixelRgn    srcPR;
+  GimpPixelRgn    dstPR;
+  guchar         *src_data;
+  guchar         *dst_data;
+  gdouble         scale_x;
+  gdouble         scale_y;
+  gint32          bandIdx;
+  gint            numThreads;
+  gint ii;
 
+  static gint32 funcId = -1;
 
-   if(!mgpp->render_mode == GAP_MORPH_RENDER_MODE_WARP)
-   {
-     if((wp_set_1) && (wp_set_2))
-     {
-       /* multi workpoint settings for src_layer */
-       curr_wp_list_1 = p_calculate_work_point_movement((gdouble)total_steps
-                                                     ,(gdouble)current_step
-                                                     ,wp_set_1->wp_list
-                                                     ,mgpp->osrc_layer_id
-                                                     ,mgpp->fdst_layer_id
-                                                     ,curr_width
-                                                     ,curr_height
-                                                     ,forward_move
-                                                     );
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "p_layer_warp_move");
 
-       curr_wp_list_2 = p_calculate_work_point_movement((gdouble)total_steps
-                                                     ,(gdouble)current_step
-                                                     ,wp_set_2->wp_list
-                                                     ,mgpp->osrc_layer_id
-                                                     ,mgpp->fdst_layer_id
-                                                     ,curr_width
-                                                     ,curr_height
-                                                     ,forward_move
-                                                     );
+  wcap_1 = &wcap_struct_1;
+  wcap_2 = &wcap_struct_2;
 
-       /* warp the BG layer */
-       p_layer_warp_move ( curr_wp_list_1
-                         , curr_wp_list_2
-                         , src_layer_id
-                         , bg_layer_id
-                         , mgpp
-                         , wp_set_1
-                         , wp_set_2
-                         , wp_mix_factor
-                         );
-       gap_morph_exec_free_workpoint_list(&curr_wp_list_1);
-       gap_morph_exec_free_workpoint_list(&curr_wp_list_2);
-     }
-     else
-     {
-       if(gap_debug)
-       {
-         printf("simple workpoint setting for BG LAYER total_steps:%.2f current_step:%.2f forward_move:%d  wp_mix_factor:%.3f\n"
-            , (float)total_steps
-            , (float)current_step
-            , (int)forward_move
-            , (float)wp_mix_factor
-            );
-       }
-     
-       /* simple workpoint settings for src_layer */
-       curr_wp_list_1 = p_calculate_work_point_movement((gdouble)total_steps
-                                                     ,(gdouble)current_step
-                                                     ,mgpp->master_wp_list
-                                                     ,mgpp->osrc_layer_id
-                                                     ,mgpp->fdst_layer_id
-                                                     ,curr_width
-                                                     ,curr_height
-                                                     ,forward_move
-                                                     );
+  wcap_1->wp_list = wp_list_1;
+  wcap_2->wp_list = wp_list_2;
+  wcap_1->wp_grid = NULL;
+  wcap_2->wp_grid = NULL;
+  
+  wcap_1->sqr_affect_radius = mgpp->affect_radius * mgpp->affect_radius;
+  wcap_1->use_gravity = mgpp->use_gravity;
+  wcap_1->gravity_intensity = mgpp->gravity_intensity;
+  if(p1)
+  {
+    wcap_1->sqr_affect_radius = p1->affect_radius * p1->affect_radius;
+    wcap_1->use_gravity = p1->use_gravity;
+    wcap_1->gravity_intensity = p1->gravity_intensity;
+  }
+  
+  wcap_2->sqr_affect_radius = mgpp->affect_radius * mgpp->affect_radius;
+  wcap_2->use_gravity = mgpp->use_gravity;
+  wcap_2->gravity_intensity = mgpp->gravity_intensity;
+  if(p2)
+  {
+    wcap_2->sqr_affect_radius = p2->sqr_affect_radius * p2->sqr_affect_radius;
+    wcap_2->use_gravity = p2->use_gravity;
+    wcap_2->gravity_intensity = p2->gravity_intensity;
+  }
+  
 
-       /* warp the BG layer */
-       p_layer_warp_move ( curr_wp_list_1
-                         , NULL
-                         , src_layer_id
-                         , bg_layer_id
-                         , mgpp
-                         , NULL
-                         , NULL
-                         , wp_mix_factor
-                         );
+  wcap_1->printf_flag = FALSE;
+  wcap_2->printf_flag = FALSE;
 
-       gap_morph_exec_free_workpoint_list(&curr_wp_list_1);
-     }
-     forward_move = FALSE;
-     mgpp->master_progress += mgpp->layer_progress_step;
-   }
-   
-   if((wp_set_1) && (wp_set_2))
-   {
-     /* milti workpoint settings for sc_layer */
-     curr_wp_list_1 = p_calculate_work_point_movement((gdouble)total_steps
-                                                   ,(gdouble)current_step
-                                                   ,wp_set_1->wp_list
-                                                   ,mgpp->osrc_layer_id
-                                                   ,mgpp->fdst_layer_id
-                                                   ,curr_width
-                                                   ,curr_height
-                                                   ,forward_move
-                                                   );
-     
-     curr_wp_list_2 = p_calculate_work_point_movement((gdouble)total_steps
-                                                   ,(gdouble)current_step
-                                                   ,wp_set_2->wp_list
-                                                   ,mgpp->osrc_layer_id
-                                                   ,mgpp->fdst_layer_id
-                                                   ,curr_width
-                                                   ,curr_height
-                                                   ,forward_move
-                                                   );
-     
-     /* warp the TOP layer */
-     p_layer_warp_move ( curr_wp_list_1
-                       , curr_wp_list_2
-                       , dst_layer_id
-                       , top_layer_id
-                       , mgpp
-                       , wp_set_1
-                       , wp_set_2
-                       , wp_mix_factor
+  wcap_1->use_quality_wp_selection = mgpp->use_quality_wp_selection;
+  wcap_2->use_quality_wp_selection = mgpp->use_quality_wp_selection;
+  
+  src_drawable = gimp_drawable_get (src_layer_id);
+  dst_drawable = gimp_drawable_get (dst_layer_id);
+
+  if(src_drawable == NULL)                   { return; }
+  if(dst_drawable == NULL)                   { return; }
+  if(src_drawable->bpp != dst_drawable->bpp) { return; }
+  if((src_drawable->bpp != 4)  && (src_drawable->bpp != 2))
+  { 
+    return;
+  }
+
+  GAP_TIMM_START_FUNCTION(funcId);
+
+  /* if src and dst size not equal: caluclate scaling factors x/y */
+  scale_x = src_drawable->width / MAX(1,dst_drawable->width);
+  scale_y = src_drawable->height / MAX(1,dst_drawable->height);
+
+  wcap_1->scale_x = scale_x;
+  wcap_2->scale_x = scale_x;
+  wcap_1->scale_y = scale_y;
+  wcap_2->scale_y = scale_y;
+
+  /* read all source pixels into memory (the gimp calls must stay in the main thread) */
+  src_data = g_malloc(src_drawable->width * src_drawable->height * src_drawable->bpp);
+  dst_data = g_malloc(dst_drawable->width * dst_drawable->height * dst_drawable->bpp);
+  gimp_pixel_rgn_init (&srcPR, src_drawable
+                      , 0
+                      , 0
+                      , src_drawable->width
+                      , src_drawable->height
+                      , FALSE     /* dirty */
+                      , FALSE     /* shadow */
                        );
+  gimp_pixel_rgn_get_rect (&srcPR, src_data
+                      , 0
+                      , 0
+                      , src_drawable->width
+                      , src_drawable->height
+                      );
 
-     gap_morph_exec_free_workpoint_list(&curr_wp_list_1);
-     gap_morph_exec_free_workpoint_list(&curr_wp_list_2);
-   }
-   else
-   {
-     if(gap_debug)
-     {
-       printf("simple workpoint setting for TOP LAYER total_steps:%.2f current_step:%.2f forward_move:%d  wp_mix_factor:%.3f\n"
-          , (float)total_steps
-          , (float)current_step
-          , (int)forward_move
-          , (float)wp_mix_factor
-          );
-     }
+  wld = g_new0(GapMorphWarpLayerData, 1);
+  wld->wtdArray = g_new0(GapMorphWarpThreadData, GAP_MORPH_WARP_MAX_THREADS);
+  wld->src_data = src_data;
+  wld->src_width = src_drawable->width;
+  wld->src_height = src_drawable->height;
+  wld->bpp = src_drawable->bpp;
+  wld->dst_data = dst_data;
+  wld->dst_width = dst_drawable->width;
+  wld->dst_height = dst_drawable->height;
+  wld->have_workpointsets = mgpp->have_workpointsets;
+  wld->wp_mix_factor = wp_mix_factor;
+  wld->numBands = (dst_drawable->height + (GAP_MORPH_WARP_BAND_HEIGHT -1)) / GAP_MORPH_WARP_BAND_HEIGHT;
+  wld->nextBand = 0;
+  wld->bandsDone = 0;
+  wld->numWorkersActive = 0;
+  wld->refCount = 1;
+  wld->mutex = NULL;
+  wld->cond = NULL;
+
+  numThreads = MIN(gap_base_get_numProcessors(), GAP_MORPH_WARP_MAX_THREADS);
+  numThreads = MIN(numThreads, wld->numBands);
+  if(numThreads > 1)
+  {
+    if(gap_base_thread_init() != TRUE)
+    {
+      numThreads = 1;
+    }
+  }
+  if((numThreads > 1) && (threadPool == NULL))
+  {
+    GError *error = NULL;
+
+    /* init the treadPool at first multiprocessing call
+     * (and keep the threads until end of main process..)
+     */
+    threadPool = g_thread_pool_new((GFunc) p_warp_WorkerThreadFunction
+                                         ,NULL        /* user data */
+                                         ,GAP_MORPH_WARP_MAX_THREADS          /* max_threads */
+                                         ,TRUE        /* exclusive */
+                                         ,&error      /* GError **error */
+                                         );
+    if((threadPool == NULL) || (error != NULL))
+    {
+      /* an exclusive pool reports an error when not all of its threads could be started */
+      printf("** ERROR p_layer_warp_move: could not create thread pool %s\n"
+        , (error != NULL) ? error->message : ""
+        );
+      if(error != NULL)
+      {
+        g_error_free(error);
+      }
+      if(threadPool != NULL)
+      {
+        g_thread_pool_free(threadPool, FALSE, TRUE);
+        threadPool = NULL;
+      }
+      numThreads = 1;
+    }
+  }
+  wld->mutex = g_mutex_new();
+  wld->cond = g_cond_new();
+
+  if(gap_debug)
+  {
+    printf("p_layer_warp_move: dst size:%d x %d numBands:%d numThreads:%d\n"
+      , (int)wld->dst_width
+      , (int)wld->dst_height
+      , (int)wld->numBands
+      , (int)numThreads
+      );
+  }
+
+  /* each thread operates on private copies of the workpoint lists */
+  for(ii=0; ii < numThreads; ii++)
+  {
+    wtd = &wld->wtdArray[ii];
+    wtd->wld = wld;
+    wtd->cpuId = ii;
+    wtd->master_list_1 = wp_list_1;
+    wtd->master_list_2 = wp_list_2;
+    wtd->wcap_1 = *wcap_1;
+    wtd->wcap_2 = *wcap_2;
+    wtd->wcap_1.wp_list = p_copy_workpoint_list(wp_list_1);
+    wtd->wcap_2.wp_list = p_copy_workpoint_list(wp_list_2);
+
+    /* spatial index to check only the workpoints near the processed pixel */
+    wtd->wcap_1.wp_grid = p_create_wp_grid(&wtd->wcap_1, wld->dst_width, wld->dst_height);
+    if(mgpp->have_workpointsets)
+    {
+      wtd->wcap_2.wp_grid = p_create_wp_grid(&wtd->wcap_2, wld->dst_width, wld->dst_height);
+    }
+  }
+
+  /* (re)activate the worker threads, the main thread renders bands too */
+  for(ii=1; ii < numThreads; ii++)
+  {
+    p_warp_start_worker(threadPool, &wld->wtdArray[ii]);
+  }
+
+  while((bandIdx = p_warp_get_next_band(wld)) >= 0)
+  {
+    gint32 bandsDone;
+
+    p_warp_band(&wld->wtdArray[0], bandIdx);
+
+    g_mutex_lock(wld->mutex);
+    wld->bandsDone++;
+    bandsDone = wld->bandsDone;
+    g_mutex_unlock(wld->mutex);
+
+    p_warp_progress_update(mgpp, (gdouble)bandsDone / (gdouble)wld->numBands);
+  }
+
+  /* wait until all worker threads have finished their bands */
+  g_mutex_lock(wld->mutex);
+  while(wld->numWorkersActive > 0)
+  {
+    gint32 bandsDone;
+
+    g_cond_wait(wld->cond, wld->mutex);
+    bandsDone = wld->bandsDone;
+
+    g_mutex_unlock(wld->mutex);
+    p_warp_progress_update(mgpp, (gdouble)bandsDone / (gdouble)wld->numBands);
+    g_mutex_lock(wld->mutex);
+  }
+  g_mutex_unlock(wld->mutex);
+
+  for(ii=0; ii < numThreads; ii++)
+  {
+    wtd = &wld->wtdArray[ii];
+    p_free_wp_grid(&wtd->wcap_1.wp_grid);
+    p_free_wp_grid(&wtd->wcap_2.wp_grid);
+    gap_morph_exec_free_workpoint_list(&wtd->wcap_1.wp_list);
+    gap_morph_exec_free_workpoint_list(&wtd->wcap_2.wp_list);
+  }
+
+  /* a worker that was given up in p_warp_start_worker may still hold a reference */
+  p_warp_layer_data_unref(wld);
+
+  /* write the warped pixels to the shadow of the dst drawable */
+  gimp_pixel_rgn_init (&dstPR, dst_drawable
+                      , 0
+                      , 0
+                      , dst_drawable->width
+                      , dst_drawable->height
+                      , TRUE      /* dirty */
+                      , TRUE      /* shadow */
+                       );
+  gimp_pixel_rgn_set_rect (&dstPR, dst_data
+                      , 0
+                      , 0
+                      , dst_drawable->width
+                      , dst_drawable->height
+                      );
+  g_free(src_data);
+  g_free(dst_data);
+
+  gimp_drawable_flush (dst_drawable);
+  gimp_drawable_merge_shadow (dst_drawable->drawable_id, TRUE);
+  gimp_drawable_update (dst_layer_id
+                      , 0
+                      , 0
+                      , dst_drawable->width
+                      , dst_drawable->height
+                      );
+
+  gimp_drawable_detach(src_drawable);
+  gimp_drawable_detach(dst_drawable);
+
+  GAP_TIMM_STOP_FUNCTION(funcId);
+}   /* end p_layer_warp_move */
+
+/* ---------------------------------
+ * p_mix_layers
+ * ---------------------------------
+ * create a layer by mixing bg_layer_id and top_layer_id
+ */
+static gint32
+p_mix_layers (gint32  curr_image_id
+                  ,gint32  bg_layer_id
+                  ,gint32  top_layer_id
+                  ,gint32  curr_width
+                  ,gint32  curr_height
+                  ,gdouble curr_mix_factor  /* 0.0 <= mix <= 1.0 */
+                  )
+{
+  gint32        dst_layer_id;
+  GimpDrawable *top_drawable;
+  GimpDrawable *bg_drawable;
+  GimpDrawable *dst_drawable;
+  GimpPixelRgn    dstPR;
+  GimpPixelRgn    topPR;
+  GimpPixelRgn    bgPR;
+  gpointer        pr;
+
+  if(gap_debug)
+  {
+    printf("p_mix_layers START curr_mix_factor: %f\n"
+      ,(float)curr_mix_factor
+      );
+  }
+
+  top_drawable = gimp_drawable_get (top_layer_id);
+  bg_drawable  = gimp_drawable_get (bg_layer_id);
+
+  if(top_drawable == NULL)                   { return (-1); }
+  if(bg_drawable == NULL)                    { return (-1); }
+  if(top_drawable->bpp < 3)
+  {
+    dst_layer_id = gimp_layer_new(curr_image_id, "morph_tween"
+                               , curr_width
+                               , curr_height
+                               , GIMP_GRAYA_IMAGE
+                               , 100.0      /* full opaque */
+                               , GIMP_NORMAL_MODE
+                               );
+  }
+  else
+  {
+    dst_layer_id = gimp_layer_new(curr_image_id, "morph_tween"
+                               , curr_width
+                               , curr_height
+                               , GIMP_RGBA_IMAGE
+                               , 100.0      /* full opaque */
+                               , GIMP_NORMAL_MODE
+                               );
+  }
+  
+
+  gimp_image_add_layer(curr_image_id, dst_layer_id, 0);
+
+
+  dst_drawable = gimp_drawable_get (dst_layer_id);
+  if(dst_drawable == NULL)                   { return (-1); }
+
+  if(gap_debug)
+  {
+    printf("p_mix_layers dst_layer_id: %d bpp:%d  top_layer_id:%d bpp:%d  bg_layer_id:%d bpp:%d\n"
+      ,(int)dst_layer_id
+      ,(int)dst_drawable->bpp
+      ,(int)top_layer_id
+      ,(int)top_drawable->bpp
+      ,(int)bg_layer_id
+      ,(int)bg_drawable->bpp
+      );
+  }
+
+
+  
+  /* init Pixel Region  */
+  gimp_pixel_rgn_init (&dstPR, dst_drawable
+                      , 0
+                      , 0
+                      , dst_drawable->width
+                      , dst_drawable->height
+                      , TRUE      /* dirty */
+                      , TRUE      /* shadow */
+                       );
+  gimp_pixel_rgn_init (&topPR, top_drawable
+                      , 0
+                      , 0
+                      , top_drawable->width
+                      , top_drawable->height
+                      , FALSE      /* dirty */
+                      , FALSE      /* shadow */
+                       );
+  gimp_pixel_rgn_init (&bgPR, bg_drawable
+                      , 0
+                      , 0
+                      , bg_drawable->width
+                      , bg_drawable->height
+                      , FALSE      /* dirty */
+                      , FALSE      /* shadow */
+                       );
+
+  for (pr = gimp_pixel_rgns_register (3, &dstPR, &topPR, &bgPR);
+       pr != NULL;
+       pr = gimp_pixel_rgns_process (pr))
+  {
+     guint x;
+     guint y;
+     guchar *dest;
+     guchar *top;
+     guchar *bg;
+     guchar         *pixel_ptr;
+     guchar         *top_ptr;
+     guchar         *bg_ptr;
+
+     dest = dstPR.data;
+     top  = topPR.data;
+     bg   = bgPR.data;
+     for (y = 0; y < dstPR.h; y++)
+     {
+        pixel_ptr = dest;
+        top_ptr = top;
+        bg_ptr = bg;
+        
+        for (x = 0; x < dstPR.rowstride ; x++)
+        {
+           gdouble val;
+           
+           val = GAP_BASE_MIX_VALUE(curr_mix_factor, (gdouble)(*bg_ptr), (gdouble)(*top_ptr));
+           *pixel_ptr = (guchar)val;
+           
+           pixel_ptr++;
+           top_ptr++;
+           bg_ptr++;
+        }
+        dest += dstPR.rowstride;
+        top  += topPR.rowstride;
+        bg   += bgPR.rowstride;
+     }
+  }
+
+  gimp_drawable_flush (dst_drawable);
+  gimp_drawable_merge_shadow (dst_drawable->drawable_id, TRUE);
+  gimp_drawable_update (dst_layer_id
+                      , 0
+                      , 0
+                      , dst_drawable->width
+                      , dst_drawable->height
+                      );
+
+  gimp_drawable_detach(bg_drawable);
+  gimp_drawable_detach(top_drawable);
+  gimp_drawable_detach(dst_drawable);
+
+  return(dst_layer_id);
+
+}   /* end p_mix_layers */
+
+/* ---------------------------------
+ * p_create_morph_tween_frame
+ * ---------------------------------
+ * return the newly created tween morphed layer
+ */
+static gint32
+p_create_morph_tween_frame(gint32 total_steps
+                          ,gint32 current_step
+                          ,GapMorphGlobalParams *mgpp
+                          ,GapMorphExeLayerstack *mlayers
+                          )
+{
+   GimpDrawable *dst_drawable;
+   gint32  curr_image_id;  /* a temp image of current layer size */
+   gint32  bg_layer_id;
+   gint32  top_layer_id;
+   gint32  merged_layer_id;
+   gint32  curr_width;
+   gint32  curr_height;
+   gdouble curr_opacity;
+   GapMorphWorkPoint *curr_wp_list_1;
+   GapMorphWorkPoint *curr_wp_list_2;
+   GapMorphWarpCoreAPI *wp_set_1;
+   GapMorphWarpCoreAPI *wp_set_2;
+   gint32 src_layer_id;
+   gint32 dst_layer_id;
+   gboolean forward_move;
+   gdouble  wp_mix_factor;
+   
+   forward_move = TRUE;
+   src_layer_id = mgpp->osrc_layer_id;
+   dst_layer_id = mgpp->fdst_layer_id;
+
+   wp_set_1 = NULL;
+   wp_set_2 = NULL;
+   wp_mix_factor = 1.0;
+
+   if(gap_debug)
+   {
+     printf("p_create_morph_tween_frame START total_steps:%d  current_step:%d\n"
+            " mgpp->create_tween_layers:%d\n"
+            " mgpp->have_workpointsets:%d\n"
+            " mlayers->available_wp_sets:%d\n"
+            " mgpp->render_mode:%d\n"
+       ,(int)total_steps
+       ,(int)current_step
+       ,(int)mgpp->create_tween_layers
+       ,(int)mgpp->have_workpointsets
+       ,(int)mlayers->available_wp_sets
+       ,(int)mgpp->render_mode
+       );
+   }
+
+   if(mgpp->create_tween_layers)
+   {
+     /* size of the new frame */
+     curr_width = p_linear_advance((gdouble)total_steps
+                                  ,(gdouble)current_step
+                                  ,(gdouble)gimp_drawable_width(src_layer_id)
+                                  ,(gdouble)gimp_drawable_width(dst_layer_id)
+                                  );
+     curr_height = p_linear_advance((gdouble)total_steps
+                                  ,(gdouble)current_step
+                                  ,(gdouble)gimp_drawable_height(src_layer_id)
+                                  ,(gdouble)gimp_drawable_height(dst_layer_id)
+                                  );
+   }
+   else
+   {
+     gint ii;
+     
+     ii = mlayers->dst1_idx - (current_step -1);
+     
+     /* operate on existing destination layers */
+     dst_layer_id = mlayers->dst_layers[ii];
+     curr_width = gimp_drawable_width(dst_layer_id);
+     curr_height = gimp_drawable_height(dst_layer_id);
+     
+     ii = p_linear_advance((gdouble)total_steps
+                                  ,(gdouble)current_step
+                                  ,(gdouble)mlayers->src1_idx
+                                  ,(gdouble)mlayers->src2_idx
+                                  );
+
+     /* in this case also operate with changing source layers (if there are more than one) */
+     src_layer_id = mlayers->src_layers[ii];
+   }
+
+   if((mgpp->have_workpointsets)
+   && (mlayers->available_wp_sets > 1))
+   {
+     gint wps_idx;
+     gint wps_idx_2;
+     gdouble wp_stepspeed;
+     gdouble ref;
+     
+     wp_stepspeed = (gdouble)(mlayers->available_wp_sets -1) / (gdouble)MIN((total_steps -1),1);
+     ref = (gdouble)((gdouble)(current_step -1) * wp_stepspeed);
+     wps_idx = (gint)ref;
+     wps_idx_2 = MIN(wps_idx+1, (mlayers->available_wp_sets -1));
+
+     wp_set_1 = mlayers->tab_wp_sets[wps_idx];
+     wp_set_2 = mlayers->tab_wp_sets[wps_idx_2];
+     wp_mix_factor = ref - (gdouble)wps_idx;
+   }
+
+   dst_drawable = gimp_drawable_get (dst_layer_id);
+
+   if(gap_debug)
+   {
+     printf("p_create_morph_tween_frame dst_layer_id:%d, bpp:%d\n"
+        ,(int)dst_layer_id
+        ,(int)dst_drawable->bpp
+        );
+   }   
+
+   /* add empty BG layer */
+   if(dst_drawable->bpp < 3)
+   {
+     /* create the tween frame image */
+     curr_image_id = gimp_image_new(curr_width, curr_height, GIMP_GRAY);
+
+     bg_layer_id = gimp_layer_new(curr_image_id, "bg_morph_layer"
+                               , curr_width
+                               , curr_height
+                               , GIMP_GRAYA_IMAGE
+                               , 100.0      /* full opaque */
+                               , GIMP_NORMAL_MODE
+                               );
+   }
+   else
+   {
+     /* create the tween frame image */
+     curr_image_id = gimp_image_new(curr_width, curr_height, GIMP_RGB);
+     bg_layer_id = gimp_layer_new(curr_image_id, "bg_morph_layer"
+                               , curr_width
+                               , curr_height
+                               , GIMP_RGBA_IMAGE
+                               , 100.0      /* full opaque */
+                               , GIMP_NORMAL_MODE
+                               );
+   }
+   gimp_image_add_layer(curr_image_id, bg_layer_id, 0);
+
+   /* add empty TOP layer */
+   curr_opacity = p_linear_advance((gdouble)total_steps
+                                ,(gdouble)current_step
+                                ,(gdouble)0.0
+                                ,(gdouble)100.0
+                                );
+   if(dst_drawable->bpp < 3)
+   {
+     top_layer_id = gimp_layer_new(curr_image_id, "top_morph_layer"
+                               , curr_width
+                               , curr_height
+                               , GIMP_GRAYA_IMAGE
+                               , curr_opacity
+                               , GIMP_NORMAL_MODE
+                               );
+   }
+   else
+   {
+     top_layer_id = gimp_layer_new(curr_image_id, "top_morph_layer"
+                               , curr_width
+                               , curr_height
+                               , GIMP_RGBA_IMAGE
+                               , curr_opacity
+                               , GIMP_NORMAL_MODE
+                               );
+   }
+   gimp_image_add_layer(curr_image_id, top_layer_id, 0);
+
+
+   if(!mgpp->render_mode == GAP_MORPH_RENDER_MODE_WARP)
+   {
+     if((wp_set_1) && (wp_set_2))
+     {
+       /* multi workpoint settings for src_layer */
+       curr_wp_list_1 = p_calculate_work_point_movement((gdouble)total_steps
+                                                     ,(gdouble)current_step
+                                                     ,wp_set_1->wp_list
+                                                     ,mgpp->osrc_layer_id
+                                                     ,mgpp->fdst_layer_id
+                                                     ,curr_width
+                                                     ,curr_height
+                                                     ,forward_move
+                                                     );
+
+       curr_wp_list_2 = p_calculate_work_point_movement((gdouble)total_steps
+                                                     ,(gdouble)current_step
+                                                     ,wp_set_2->wp_list
+                                                     ,mgpp->osrc_layer_id
+                                                     ,mgpp->fdst_layer_id
+                                                     ,curr_width
+                                                     ,curr_height
+                                                     ,forward_move
+                                                     );
+
+       /* warp the BG layer */
+       p_layer_warp_move ( curr_wp_list_1
+                         , curr_wp_list_2
+                         , src_layer_id
+                         , bg_layer_id
+                         , mgpp
+                         , wp_set_1
+                         , wp_set_2
+                         , wp_mix_factor
+                         );
+       gap_morph_exec_free_workpoint_list(&curr_wp_list_1);
+       gap_morph_exec_free_workpoint_list(&curr_wp_list_2);
+     }
+     else
+     {
+       if(gap_debug)
+       {
+         printf("simple workpoint setting for BG LAYER total_steps:%.2f current_step:%.2f forward_move:%d  wp_mix_factor:%.3f\n"
+            , (float)total_steps
+            , (float)current_step
+            , (int)forward_move
+            , (float)wp_mix_factor
+            );
+       }
+     
+       /* simple workpoint settings for src_layer */
+       curr_wp_list_1 = p_calculate_work_point_movement((gdouble)total_steps
+                                                     ,(gdouble)current_step
+                                                     ,mgpp->master_wp_list
+                                                     ,mgpp->osrc_layer_id
+                                                     ,mgpp->fdst_layer_id
+                                                     ,curr_width
+                                                     ,curr_height
+                                                     ,forward_move
+                                                     );
+
+       /* warp the BG layer */
+       p_layer_warp_move ( curr_wp_list_1
+                         , NULL
+                         , src_layer_id
+                         , bg_layer_id
+                         , mgpp
+                         , NULL
+                         , NULL
+                         , wp_mix_factor
+                         );
+
+       gap_morph_exec_free_workpoint_list(&curr_wp_list_1);
+     }
+     forward_move = FALSE;
+     mgpp->master_progress += mgpp->layer_progress_step;
+   }
+   
+   if((wp_set_1) && (wp_set_2))
+   {
+     /* milti workpoint settings for sc_layer */
+     curr_wp_list_1 = p_calculate_work_point_movement((gdouble)total_steps
+                                                   ,(gdouble)current_step
+                                                   ,wp_set_1->wp_list
+                                                   ,mgpp->osrc_layer_id
+                                                   ,mgpp->fdst_layer_id
+                                                   ,curr_width
+                                                   ,curr_height
+                                                   ,forward_move
+                                                   );
+     
+     curr_wp_list_2 = p_calculate_work_point_movement((gdouble)total_steps
+                                                   ,(gdouble)current_step
+                                                   ,wp_set_2->wp_list
+                                                   ,mgpp->osrc_layer_id
+                                                   ,mgpp->fdst_layer_id
+                                                   ,curr_width
+                                                   ,curr_height
+                                                   ,forward_move
+                                                   );
+     
+     /* warp the TOP layer */
+     p_layer_warp_move ( curr_wp_list_1
+                       , curr_wp_list_2
+                       , dst_layer_id
+                       , top_layer_id
+                       , mgpp
+                       , wp_set_1
+                       , wp_set_2
+                       , wp_mix_factor
+                       );
+
+     gap_morph_exec_free_workpoint_list(&curr_wp_list_1);
+     gap_morph_exec_free_workpoint_list(&curr_wp_list_2);
+   }
+   else
+   {
+     if(gap_debug)
+     {
+       printf("simple workpoint setting for TOP LAYER total_steps:%.2f current_step:%.2f forward_move:%d  wp_mix_factor:%.3f\n"
+          , (float)total_steps
+          , (float)current_step
+          , (int)forward_move
+          , (float)wp_mix_factor
+          );
+     }
+
+     /* simple workpoint settings for sc_layer */
+     curr_wp_list_1 = p_calculate_work_point_movement((gdouble)total_steps
+                                                   ,(gdouble)current_step
+                                                   ,mgpp->master_wp_list
+                                                   ,mgpp->osrc_layer_id
+                                                   ,mgpp->fdst_layer_id
+                                                   ,curr_width
+                                                   ,curr_height
+                                                   ,forward_move
+                                                   );
+
+     /* warp the TOP layer */
+     p_layer_warp_move ( curr_wp_list_1
+                       , NULL
+                       , dst_layer_id
+                       , top_layer_id
+                       , mgpp
+                       , NULL
+                       , NULL
+                       , wp_mix_factor
+                       );
+
+     gap_morph_exec_free_workpoint_list(&curr_wp_list_1);
+   }
+
+   gimp_drawable_detach(dst_drawable);
+
+   if(mgpp->render_mode == GAP_MORPH_RENDER_MODE_WARP)
+   {
+     /* for warp only mode all is done at this point */
+     return(top_layer_id);
+   }
+
+   /* merge BG and TOP Layer (does mix opacity according to current step) */
+   merged_layer_id = p_mix_layers(curr_image_id
+               ,bg_layer_id
+               ,top_layer_id
+               ,curr_width
+               ,curr_height
+               ,(gdouble)(curr_opacity / 100.0)
+               );
+
+   /* DEBUG code: show duplicate of the temporary tween image */
+   if(FALSE)
+   {
+     gint32 dup_id;
+
+     dup_id = gimp_image_duplicate(curr_image_id);
+     gimp_display_new (dup_id);
+
+   }
+
+   return(merged_layer_id);
+
+}  /* end p_create_morph_tween_frame  */
+
+
+/* ---------------------------------
+ * p_get_tween_steps_and_layerstacks
+ * ---------------------------------
+ * get layerstack for both src and dst
+ * 
+ * return the constraint tween_steps value
+ * when operating on existing destination layers
+ */
+static gint32
+p_get_tween_steps_and_layerstacks(GapMorphGlobalParams *mgpp, GapMorphExeLayerstack *mlayers)
+{
+  gint32 src_image_id;
+  gint32 dst_image_id;
+  gint32 tween_steps;
+  gint32 ii;
+  
+  tween_steps = 0;
+  mlayers->src_nlayers = 0;
+  mlayers->src_layers = NULL;
+  mlayers->dst_nlayers = 0;
+  mlayers->dst_layers = NULL;
+
+  mlayers->src1_idx = -1;
+  mlayers->src2_idx = -1;
+  mlayers->dst1_idx = -1;
+  mlayers->dst2_idx = -1;
+  src_image_id = -1;
+  dst_image_id = -1;
+
+
+  if(gap_debug)
+  {
+    printf("p_get_tween_steps_and_layerstacks: START\n");
+  }
+  
+  if(mgpp->osrc_layer_id >= 0)
+  {
+    src_image_id = gimp_drawable_get_image(mgpp->osrc_layer_id);
+    
+    mlayers->src_layers = gimp_image_get_layers (src_image_id
+                                             ,&mlayers->src_nlayers
+                                             );
+    for(ii=0; ii < mlayers->src_nlayers; ii++)
+    {
+      if(gap_debug)
+      {
+        printf("src: id[%d]: %d\n", (int)ii, (int)mlayers->src_layers[ii] );
+      }
+      if(mlayers->src_layers[ii] == mgpp->osrc_layer_id)
+      {
+        mlayers->src1_idx = ii;  /* src at 1.st step */
+        mlayers->src2_idx = ii;  /* src at last step */
+        break;
+      }
+    }
+  }
+  
+  if(mgpp->fdst_layer_id >= 0)
+  {
+    tween_steps = mgpp->tween_steps;
+    
+    dst_image_id = gimp_drawable_get_image(mgpp->fdst_layer_id);
+    mlayers->dst_layers = gimp_image_get_layers (dst_image_id
+                                             ,&mlayers->dst_nlayers
+                                             );
+    for(ii=0; ii < mlayers->dst_nlayers; ii++)
+    {
+
+      if(gap_debug)
+      {
+        printf("dst: id[%d]: %d\n", (int)ii, (int)mlayers->dst_layers[ii] );
+      }
+
+      if(mlayers->dst_layers[ii] == mgpp->fdst_layer_id)
+      {
+        mlayers->dst2_idx = ii;  /* dst at last step */
+        break;
+      }
+    }
+  }
+
+  if(mgpp->create_tween_layers)
+  {
+    mlayers->dst1_idx = mlayers->dst2_idx + (tween_steps -1);
+    if(gap_debug)
+    {
+      printf("p_get_tween_steps_and_layerstacks: create_tween_layers RETURN tween_steps:%d\n"
+         ,(int)tween_steps
+         );
+    }
+    return(tween_steps);
+  }
+  
+  if(mgpp->render_mode == GAP_MORPH_RENDER_MODE_WARP)
+  {
+    if(dst_image_id == src_image_id)
+    {
+      if(mlayers->dst2_idx > mlayers->src1_idx)
+      {
+        gint32 tmp;
+        /* source layer is above the destination layer
+         * in this case swap src with dst layer
+         */
+        tmp = mgpp->fdst_layer_id;
+        mgpp->fdst_layer_id = mgpp->osrc_layer_id;
+        mgpp->osrc_layer_id = tmp;
+        
+        tmp = mlayers->dst2_idx;
+        mlayers->dst2_idx = mlayers->src1_idx;
+        mlayers->src1_idx = tmp;
+        mlayers->src2_idx = tmp;
+      }
+      tween_steps = 1 + (mlayers->src1_idx - mlayers->dst2_idx );
+    }
+    else
+    {
+      tween_steps = MIN(tween_steps, (mlayers->dst_nlayers - mlayers->dst2_idx) );
+    }
+  }
+
+  mlayers->dst1_idx = mlayers->dst2_idx + (tween_steps -1);
+  if(mgpp->render_mode == GAP_MORPH_RENDER_MODE_WARP)
+  {
+    mgpp->osrc_layer_id = mlayers->dst_layers[mlayers->dst1_idx];
+  }
+  
+  mlayers->src1_idx = MIN((mlayers->src2_idx + (tween_steps -1)) , (mlayers->src_nlayers -1));
+
+  if(gap_debug)
+  {
+    printf("p_get_tween_steps_and_layerstacks: create_tween_layers END, RETURN tween_steps:%d\n"
+       ,(int)tween_steps
+       );
+  }
+
+  return(tween_steps);
+}   /* end p_get_tween_steps_and_layerstacks */
+
+
+/* ---------------------------------
+ * gap_morph_execute
+ * ---------------------------------
+ * layer morphing master procedure
+ */
+gint32  
+gap_morph_execute(GapMorphGlobalParams *mgpp)
+{
+  gint32 total_steps;
+  gint32 current_step;
+  gint32 last_step;
+  gint32 new_layer_id;
+  gint32 cp_layer_id;
+  gint32 dst_image_id;
+  gint32 dst_stack_position;
+  GapMorphExeLayerstack mlayers_struct;
+  GapMorphExeLayerstack *mlayers;
+  
+  mlayers = &mlayers_struct;
+  mlayers->tab_wp_sets = NULL;
+  mlayers->available_wp_sets = 0;
+
+  mgpp->tween_steps = p_get_tween_steps_and_layerstacks(mgpp, mlayers);
+  
+  if(mgpp->have_workpointsets)
+  {
+    /* check for available workpointfile sets and load them.
+     * (note: this also handles the case when working with a single workpointfile
+     *  where the same workpoint file is used both as upper and lower set)
+     */
+    p_build_wp_set_table(mgpp ,mlayers);
+  }
+  
+  if(gap_debug) printf("gap_morph_execute: START src_layer:%d dst_layer:%d  tween_steps:%d\n"
+         ,(int)mgpp->osrc_layer_id
+         ,(int)mgpp->fdst_layer_id
+         ,(int)mgpp->tween_steps
+         );
+
+  if(mgpp->osrc_layer_id == mgpp->fdst_layer_id)
+  {
+     /* for identical layers we do only warp
+      * (fading identical images makes no sense, force warp only mode)
+      */
+    mgpp->render_mode = GAP_MORPH_RENDER_MODE_WARP;
+  }
+
+  if((mgpp->do_progress) && (mgpp->progress_callback_fptr == NULL))
+  {
+    if(mgpp->render_mode == GAP_MORPH_RENDER_MODE_MORPH)
+    {
+      gimp_progress_init(_("creating morph tween layers..."));
+    }
+    else
+    {
+      gimp_progress_init(_("creating warp tween layers..."));
+    }
+    
+  }
+
+  cp_layer_id = -1;
+  dst_image_id = gimp_drawable_get_image(mgpp->fdst_layer_id);
+  dst_stack_position = 1;
+
+  /* findout stackposition (where to insert new tween layer(s)
+   * in the destination image.
+   * (one below the mgpp->fdst_layer_id Layer)
+   * where 0 is on top of stack
+   */
+  {
+    gint       ii;
+    gint       l_nlayers;
+    gint32    *l_layers_list;
+
+    l_layers_list = gimp_image_get_layers(dst_image_id, &l_nlayers);
+    for(ii=0; ii < l_nlayers; ii++)
+    {
+      if(l_layers_list[ii] == mgpp->fdst_layer_id)
+      {
+        dst_stack_position = ii +1;
+        break;
+      }
+    }
+    if(l_layers_list)
+    {
+      g_free (l_layers_list);
+    }
+  }
+
+  
+  last_step = mgpp->tween_steps;
+  total_steps = 1 + mgpp->tween_steps;
+  mgpp->master_progress = 0.0;
+  mgpp->layer_progress_step = 0.5 / (gdouble)(MAX(1, last_step));
+
+  if(mgpp->render_mode == GAP_MORPH_RENDER_MODE_WARP)
+  {
+    /* warp_only mode (equal layer)
+     * must do one extra step to render the final distortion step
+     * (in morph mode this makes no sense, because this extra step
+     *  would deliver the destination layer again as result)
+     */
+    last_step = mgpp->tween_steps;
+    total_steps = mgpp->tween_steps;
+
+    mgpp->layer_progress_step = 1.0 / (gdouble)(MAX(1, last_step));
+  }
+
+  
+  for(current_step=1; current_step <= last_step; current_step++)
+  {
+    new_layer_id = p_create_morph_tween_frame(total_steps
+                          ,current_step
+                          ,mgpp
+                          ,mlayers
+                          );
+    if(new_layer_id < 0)
+    {
+      continue;
+      break;
+    }
+    else
+    {
+      gint32 tween_image_id;
+      gint   l_src_offset_x, l_src_offset_y;    /* layeroffsets as they were in src_image */
+      
+      if(mgpp->create_tween_layers)
+      {
+        cp_layer_id = gap_layer_copy_to_dest_image(dst_image_id
+                                     ,new_layer_id
+                                     ,100.0           /* Opacity */
+                                     ,0               /* NORMAL */
+                                     ,&l_src_offset_x
+                                     ,&l_src_offset_y
+                                     );
+        gimp_image_add_layer(dst_image_id
+                            , cp_layer_id
+                            , dst_stack_position
+                            );
+      }
+      else
+      {
+        gint ii;
+
+        /* replace content of current dst_layer[ii] by content of new_layer_id */
+        ii = mlayers->dst1_idx - (current_step -1);
+        gap_layer_copy_content(mlayers->dst_layers[ii], new_layer_id);
+      }
+      tween_image_id = gimp_drawable_get_image(new_layer_id);
+      gimp_image_delete(tween_image_id);
+    }
+
+
+    if(mgpp->do_progress)
+    {
+      mgpp->master_progress = (gdouble)current_step / (gdouble)(MAX(1, last_step));
+      if(mgpp->progress_callback_fptr == NULL)
+      {
+        gimp_progress_update(mgpp->master_progress);
+      }
+      else
+      {
+        (*mgpp->progress_callback_fptr)(mgpp->master_progress, mgpp->callback_data_ptr);
+      }
+    }
+
+    
+  }
+  return(cp_layer_id);
+  
+}  /* end gap_morph_execute */
+
+
+
+/* ----------------------------------
+ * p_create_simple_fade_tween_frame
+ * ----------------------------------
+ *
+ * return the newly created tween morphed layer
+ *
+ */
+static gint32
+p_create_simple_fade_tween_frame(gint32 total_steps
+                          ,gint32 current_step
+                          ,GapMorphGlobalParams *mgpp
+                          )
+{
+   gint32  curr_image_id;  /* a temp image of current layer size */
+   gint32  bg_layer_id;
+   gint32  top_layer_id;
+   gint32  merged_layer_id;
+   gint32  curr_width;
+   gint32  curr_height;
+   gdouble curr_opacity;
+   gint32 src_layer_id;
+   gint32 dst_layer_id;
+   GimpImageType  l_src_type;
+   
+   src_layer_id = mgpp->osrc_layer_id;
+   dst_layer_id = mgpp->fdst_layer_id;
 
-     /* simple workpoint settings for sc_layer */
-     curr_wp_list_1 = p_calculate_work_point_movement((gdouble)total_steps
-                                                   ,(gdouble)current_step
-                                                   ,mgpp->master_wp_list
-                                                   ,mgpp->osrc_layer_id
-                                                   ,mgpp->fdst_layer_id
-                                                   ,curr_width
-                                                   ,curr_height
-                                                   ,forward_move
-                                                   );
 
-     /* warp the TOP layer */
-     p_layer_warp_move ( curr_wp_list_1
-                       , NULL
-                       , dst_layer_id
-                       , top_layer_id
-                       , mgpp
-                       , NULL
-                       , NULL
-                       , wp_mix_factor
-                       );
+   /* check size of the new frame */
+   curr_width = gimp_drawable_width(src_layer_id);
+   if (curr_width != gimp_drawable_width(dst_layer_id))
+   {
+     return -1;
+   }
 
-     gap_morph_exec_free_workpoint_list(&curr_wp_list_1);
+   curr_height = gimp_drawable_height(src_layer_id);
+   if (curr_height != gimp_drawable_height(dst_layer_id))
+   {
+     return -1;
    }
 
-   gimp_drawable_detach(dst_drawable);
 
-   if(mgpp->render_mode == GAP_MORPH_RENDER_MODE_WARP)
+  l_src_type    = gimp_drawable_type(src_layer_id);
+  if (l_src_type != gimp_drawable_type(dst_layer_id))
+  {
+    return -1;
+  }
+  
+  curr_image_id = -1;
+  
+  switch(l_src_type)
+  {
+    case GIMP_RGB_IMAGE:         /* 0 */
+    case GIMP_RGBA_IMAGE:        /* 1 */
+       curr_image_id = gimp_image_new(curr_width, curr_height, GIMP_RGB);
+       break;
+    case GIMP_GRAY_IMAGE:        /* 2 */
+    case GIMP_GRAYA_IMAGE:       /* 3 */
+       curr_image_id = gimp_image_new(curr_width, curr_height, GIMP_GRAY);
+       break;
+    case GIMP_INDEXED_IMAGE:     /* 4 */
+    case GIMP_INDEXEDA_IMAGE:    /* 5 */
+       return -1;
+       break;
+  }   
+
+
+   bg_layer_id = gap_layer_copy_to_image (curr_image_id, mgpp->osrc_layer_id);
+   top_layer_id = gap_layer_copy_to_image (curr_image_id, mgpp->fdst_layer_id);
+
+   /* merge BG and TOP Layer (does mix opacity according to current step) */
+   curr_opacity = p_linear_advance((gdouble)total_steps
+                                ,(gdouble)current_step
+                                ,(gdouble)0.0
+                                ,(gdouble)100.0
+                                );
+   if(mgpp->do_progress)
    {
-     /* for warp only mode all is done at this point */
-     return(top_layer_id);
+     if(mgpp->progress_callback_fptr != NULL)
+     {
+         (*mgpp->progress_callback_fptr)(0.05, mgpp->callback_data_ptr);
+     }
    }
 
-   /* merge BG and TOP Layer (does mix opacity according to current step) */
-   merged_layer_id = p_mix_layers(curr_image_id
+   merged_layer_id = 
+   p_mix_layers(curr_image_id
                ,bg_layer_id
                ,top_layer_id
                ,curr_width
                ,curr_height
                ,(gdouble)(curr_opacity / 100.0)
                );
+ 
+   if(mgpp->do_progress)
+   {
+     if(mgpp->progress_callback_fptr != NULL)
+     {
+         (*mgpp->progress_callback_fptr)(1.0, mgpp->callback_data_ptr);
+     }
+   }
+   mgpp->master_progress += mgpp->layer_progress_step;
+
 
    /* DEBUG code: show duplicate of the temporary tween image */
    if(FALSE)
@@ -2572,709 +3757,975 @@ p_create_morph_tween_frame(gint32 total_steps
 
    return(merged_layer_id);
 
-}  /* end p_create_morph_tween_frame  */
+}  /* end p_create_simple_fade_tween_frame  */
 
 
-/* ---------------------------------
- * p_get_tween_steps_and_layerstacks
- * ---------------------------------
- * get layerstack for both src and dst
- * 
- * return the constraint tween_steps value
- * when operating on existing destination layers
+/* ----------------------------------
+ * gap_morph_render_one_of_n_tweens
+ * ----------------------------------
+ * This procedure creates only one tween (a scene between 2 video frames)
+ * according to the specified total_steps and current_step parameters.
+ * the created tween is part of a new created image
+ * that contians the tween layer.
+ *
+ * return the newly created tween morphed layer
+ *
  */
-static gint32
-p_get_tween_steps_and_layerstacks(GapMorphGlobalParams *mgpp, GapMorphExeLayerstack *mlayers)
+gint32
+gap_morph_render_one_of_n_tweens(GapMorphGlobalParams *mgpp, gdouble total_steps, gdouble current_step)
 {
-  gint32 src_image_id;
-  gint32 dst_image_id;
-  gint32 tween_steps;
-  gint32 ii;
+  gint32 new_layer_id;
+  GapMorphExeLayerstack mlayers_struct;
+  GapMorphExeLayerstack *mlayers;
+  gint32              bck_tween_steps;
+  gint32              ret_layer_id;
   
-  tween_steps = 0;
-  mlayers->src_nlayers = 0;
-  mlayers->src_layers = NULL;
-  mlayers->dst_nlayers = 0;
-  mlayers->dst_layers = NULL;
-
-  mlayers->src1_idx = -1;
-  mlayers->src2_idx = -1;
-  mlayers->dst1_idx = -1;
-  mlayers->dst2_idx = -1;
-  src_image_id = -1;
-  dst_image_id = -1;
+  mlayers = &mlayers_struct;
+  mlayers->tab_wp_sets = NULL;
+  mlayers->available_wp_sets = 0;
+  new_layer_id = -1;
+  
+  p_get_tween_steps_and_layerstacks(mgpp, mlayers);
 
+  mgpp->create_tween_layers = TRUE;
 
-  if(gap_debug)
-  {
-    printf("p_get_tween_steps_and_layerstacks: START\n");
-  }
-  
-  if(mgpp->osrc_layer_id >= 0)
+  /* check if workpoint filename is available */
+  if(mgpp->workpoint_file_lower)
   {
-    src_image_id = gimp_drawable_get_image(mgpp->osrc_layer_id);
-    
-    mlayers->src_layers = gimp_image_get_layers (src_image_id
-                                             ,&mlayers->src_nlayers
-                                             );
-    for(ii=0; ii < mlayers->src_nlayers; ii++)
+    if(*mgpp->workpoint_file_lower != '\0')
     {
-      if(gap_debug)
-      {
-        printf("src: id[%d]: %d\n", (int)ii, (int)mlayers->src_layers[ii] );
-      }
-      if(mlayers->src_layers[ii] == mgpp->osrc_layer_id)
-      {
-        mlayers->src1_idx = ii;  /* src at 1.st step */
-        mlayers->src2_idx = ii;  /* src at last step */
-        break;
-      }
+      /* load a single workpointfile */
+      mlayers->available_wp_sets = 1;
+      mlayers->tab_wp_sets = g_new(GapMorphWarpCoreAPI*, mlayers->available_wp_sets);
+      
+      mlayers->tab_wp_sets[0] = p_load_workpoint_set(mgpp->workpoint_file_lower, mgpp, mlayers);
+      mgpp->master_wp_list = mlayers->tab_wp_sets[0]->wp_list;
+      
+      mgpp->have_workpointsets = FALSE;
+      mlayers->available_wp_sets = 0;
     }
   }
   
-  if(mgpp->fdst_layer_id >= 0)
-  {
-    tween_steps = mgpp->tween_steps;
-    
-    dst_image_id = gimp_drawable_get_image(mgpp->fdst_layer_id);
-    mlayers->dst_layers = gimp_image_get_layers (dst_image_id
-                                             ,&mlayers->dst_nlayers
-                                             );
-    for(ii=0; ii < mlayers->dst_nlayers; ii++)
-    {
-
-      if(gap_debug)
-      {
-        printf("dst: id[%d]: %d\n", (int)ii, (int)mlayers->dst_layers[ii] );
-      }
-
-      if(mlayers->dst_layers[ii] == mgpp->fdst_layer_id)
-      {
-        mlayers->dst2_idx = ii;  /* dst at last step */
-        break;
-      }
-    }
-  }
+  /* overrule the number of steps with the explicite parameter value */
+  bck_tween_steps = mgpp->tween_steps;
+  mgpp->tween_steps = total_steps;
 
-  if(mgpp->create_tween_layers)
+  if(mgpp->do_simple_fade)
   {
-    mlayers->dst1_idx = mlayers->dst2_idx + (tween_steps -1);
     if(gap_debug)
     {
-      printf("p_get_tween_steps_and_layerstacks: create_tween_layers RETURN tween_steps:%d\n"
-         ,(int)tween_steps
-         );
+      printf("do_simple_fade == TRUE, skip morph and do fade operation instead\n");
     }
-    return(tween_steps);
+
+    /* we have no workpoints available
+     * in this case make an attempt with a fast fade operation
+     *  (but restricted to frames of same size and type)
+     */
+    new_layer_id =  p_create_simple_fade_tween_frame(total_steps
+                          ,current_step
+                          ,mgpp
+                          );
+    
   }
   
-  if(mgpp->render_mode == GAP_MORPH_RENDER_MODE_WARP)
+  if( new_layer_id < 0)
   {
-    if(dst_image_id == src_image_id)
-    {
-      if(mlayers->dst2_idx > mlayers->src1_idx)
-      {
-        gint32 tmp;
-        /* source layer is above the destination layer
-         * in this case swap src with dst layer
-         */
-        tmp = mgpp->fdst_layer_id;
-        mgpp->fdst_layer_id = mgpp->osrc_layer_id;
-        mgpp->osrc_layer_id = tmp;
-        
-        tmp = mlayers->dst2_idx;
-        mlayers->dst2_idx = mlayers->src1_idx;
-        mlayers->src1_idx = tmp;
-        mlayers->src2_idx = tmp;
-      }
-      tween_steps = 1 + (mlayers->src1_idx - mlayers->dst2_idx );
-    }
-    else
+    if(gap_debug)
     {
-      tween_steps = MIN(tween_steps, (mlayers->dst_nlayers - mlayers->dst2_idx) );
+      printf("calling the full morph algorithm  total_steps:%f current_step:%f\n"
+        ,(float)total_steps
+        ,(float)current_step
+        );
     }
+    new_layer_id = p_create_morph_tween_frame(total_steps
+                          ,current_step
+                          ,mgpp
+                          ,mlayers
+                          );
   }
+  ret_layer_id = gap_image_merge_to_specified_layer(new_layer_id, GIMP_CLIP_TO_IMAGE);
+
+  /* restore tween_steps value */
+  mgpp->tween_steps = bck_tween_steps;
+  
+  return(ret_layer_id);
+  
+}  /* end gap_morph_render_one_of_n_tweens */
 
-  mlayers->dst1_idx = mlayers->dst2_idx + (tween_steps -1);
-  if(mgpp->render_mode == GAP_MORPH_RENDER_MODE_WARP)
-  {
-    mgpp->osrc_layer_id = mlayers->dst_layers[mlayers->dst1_idx];
-  }
+
+/* ----------------------------------
+ * gap_morph_render_one_tween
+ * ----------------------------------
+ * This procedure creates only one tween (a scene between 2 video frames)
+ * according to the specified mix factor (mgpp->tween_mix_factor)
+ * the created tween is part of a new created image
+ * that contians the tween layer.
+ *
+ * return the newly created tween morphed layer
+ *
+ */
+gint32
+gap_morph_render_one_tween(GapMorphGlobalParams *mgpp)
+{
+  gint32 new_layer_id;
+  gdouble total_steps;
+  gdouble current_step;
   
-  mlayers->src1_idx = MIN((mlayers->src2_idx + (tween_steps -1)) , (mlayers->src_nlayers -1));
+  total_steps = 1.0 * 100000;
+  current_step = CLAMP(mgpp->tween_mix_factor, 0.0, 1.0) * 100000;
 
-  if(gap_debug)
-  {
-    printf("p_get_tween_steps_and_layerstacks: create_tween_layers END, RETURN tween_steps:%d\n"
-       ,(int)tween_steps
-       );
-  }
+  
+  new_layer_id = gap_morph_render_one_of_n_tweens(mgpp, total_steps, current_step);
 
-  return(tween_steps);
-}   /* end p_get_tween_steps_and_layerstacks */
+  return (new_layer_id);
+}  /* end gap_morph_render_one_tween */
 
 
-/* ---------------------------------
- * gap_morph_execute
- * ---------------------------------
- * layer morphing master procedure
+
+
+/* -----------------------------------------------
+ * p_buildTargetTweenFilename
+ * -----------------------------------------------
+ * build filename for the target Tween frame with the specified targetFrameNr number part
+ * with full directory path (specified by tweenDirectory)
+ *
+ * the caller is rsponsible to g_free the returned filename.
  */
-gint32  
-gap_morph_execute(GapMorphGlobalParams *mgpp)
+static char*
+p_buildTargetTweenFilename(GapAnimInfo *ainfo_ptr, const char *tweenDirectory, gint32 targetFrameNr)
 {
-  gint32 total_steps;
-  gint32 current_step;
-  gint32 last_step;
-  gint32 new_layer_id;
-  gint32 cp_layer_id;
-  gint32 dst_image_id;
-  gint32 dst_stack_position;
-  GapMorphExeLayerstack mlayers_struct;
-  GapMorphExeLayerstack *mlayers;
+  char *fileBasenameWithoutDir;
+  char *fileNameTarget;
+  char *fileNameTargetWithDir;
+  char *checkName;
   
-  mlayers = &mlayers_struct;
-  mlayers->tab_wp_sets = NULL;
-  mlayers->available_wp_sets = 0;
+  
+  fileBasenameWithoutDir = g_path_get_basename(ainfo_ptr->basename);
+  fileNameTarget = g_strdup_printf("%s%06d%s"
+                          , fileBasenameWithoutDir
+                          , (int)targetFrameNr
+                          , ainfo_ptr->extension
+                          );
 
-  mgpp->tween_steps = p_get_tween_steps_and_layerstacks(mgpp, mlayers);
+  checkName = g_build_filename(tweenDirectory, fileBasenameWithoutDir, NULL);
   
-  if(mgpp->have_workpointsets)
+  if((strcmp(checkName, ainfo_ptr->basename) == 0)
+  || (*tweenDirectory == '.'))
   {
-    /* check for available workpointfile sets and load them.
-     * (note: this also handles the case when working with a single workpointfile
-     *  where the same workpoint file is used both as upper and lower set)
-     */
-    p_build_wp_set_table(mgpp ,mlayers);
+    if(gap_debug)
+    {
+      printf("WARNING: create tween in directory: %s\n"
+           "  with additional prefix tween_"
+           "  to prevent overwrite of source frames in the same directory\n"
+        , tweenDirectory
+        );
+    }
+    fileNameTarget = g_strdup_printf("tween_%s%06d%s"
+                          , fileBasenameWithoutDir
+                          , (int)targetFrameNr
+                          , ainfo_ptr->extension
+                          );
   }
-  
-  if(gap_debug) printf("gap_morph_execute: START src_layer:%d dst_layer:%d  tween_steps:%d\n"
-         ,(int)mgpp->osrc_layer_id
-         ,(int)mgpp->fdst_layer_id
-         ,(int)mgpp->tween_steps
-         );
-
-  if(mgpp->osrc_layer_id == mgpp->fdst_layer_id)
+  else
   {
-     /* for identical layers we do only warp
-      * (fading identical images makes no sense, force warp only mode)
-      */
-    mgpp->render_mode = GAP_MORPH_RENDER_MODE_WARP;
+    fileNameTarget = g_strdup_printf("%s%06d%s"
+                          , fileBasenameWithoutDir
+                          , (int)targetFrameNr
+                          , ainfo_ptr->extension
+                          );
   }
 
-  if((mgpp->do_progress) && (mgpp->progress_callback_fptr == NULL))
+  fileNameTargetWithDir = g_build_filename(tweenDirectory, fileNameTarget, NULL);
+
+
+  if(gap_debug)
   {
-    if(mgpp->render_mode == GAP_MORPH_RENDER_MODE_MORPH)
-    {
-      gimp_progress_init(_("creating morph tween layers..."));
-    }
-    else
-    {
-      gimp_progress_init(_("creating warp tween layers..."));
-    }
-    
+    printf("checkName: %s\n", checkName);
+    printf("fileBasenameWithoutDir: %s\n", fileBasenameWithoutDir);
+    printf("fileNameTarget: %s\n", fileNameTarget);
+    printf("fileNameTargetWithDir: %s\n", fileNameTargetWithDir);
   }
+  
+  if(fileBasenameWithoutDir)    { g_free(fileBasenameWithoutDir); }
+  if(fileNameTarget)            { g_free(fileNameTarget); }
+  if(checkName)                 { g_free(checkName); }
 
-  cp_layer_id = -1;
-  dst_image_id = gimp_drawable_get_image(mgpp->fdst_layer_id);
-  dst_stack_position = 1;
+  return(fileNameTargetWithDir);
 
-  /* findout stackposition (where to insert new tween layer(s)
-   * in the destination image.
-   * (one below the mgpp->fdst_layer_id Layer)
-   * where 0 is on top of stack
-   */
-  {
-    gint       ii;
-    gint       l_nlayers;
-    gint32    *l_layers_list;
+}  /* end p_buildTargetTweenFilename */
 
-    l_layers_list = gimp_image_get_layers(dst_image_id, &l_nlayers);
-    for(ii=0; ii < l_nlayers; ii++)
-    {
-      if(l_layers_list[ii] == mgpp->fdst_layer_id)
-      {
-        dst_stack_position = ii +1;
-        break;
-      }
-    }
-    if(l_layers_list)
-    {
-      g_free (l_layers_list);
-    }
-  }
 
-  
-  last_step = mgpp->tween_steps;
-  total_steps = 1 + mgpp->tween_steps;
-  mgpp->master_progress = 0.0;
-  mgpp->layer_progress_step = 0.5 / (gdouble)(MAX(1, last_step));
+/* -----------------------------------------------
+ * p_copyAndGetMergedFrameImageLayer
+ * -----------------------------------------------
+ * load the specified frame as temporary image, merge to one layer and return this layer's id.
+ * further copy the original image to the directory specified via tweenDirectory
+ * the filename of the copy is built with original filename and extension but the number part is replaced
+ * by the specified targetFrameNr.
+ *
+ * return -1 if FAILED, or layerId (positive integer) on success
+ */
+gint32
+p_copyAndGetMergedFrameImageLayer(GapAnimInfo *ainfo_ptr, gint32 frameNr
+   , const char *tweenDirectory, gint32 targetFrameNr, gboolean overwrite_flag)
+{
+  gint32 imageId;
+  gint32 layerId;
 
-  if(mgpp->render_mode == GAP_MORPH_RENDER_MODE_WARP)
+  layerId = -1;
+  if(ainfo_ptr->new_filename != NULL)
   {
-    /* warp_only mode (equal layer)
-     * must do one extra step to render the final distortion step
-     * (in morph mode this makes no sense, because this extra step
-     *  would deliver the destination layer again as result)
-     */
-    last_step = mgpp->tween_steps;
-    total_steps = mgpp->tween_steps;
-
-    mgpp->layer_progress_step = 1.0 / (gdouble)(MAX(1, last_step));
+    g_free(ainfo_ptr->new_filename);
   }
-
-  
-  for(current_step=1; current_step <= last_step; current_step++)
+  ainfo_ptr->new_filename = gap_lib_alloc_fname(ainfo_ptr->basename,
+                                      frameNr,
+                                      ainfo_ptr->extension);
+  if(ainfo_ptr->new_filename == NULL)
   {
-    new_layer_id = p_create_morph_tween_frame(total_steps
-                          ,current_step
-                          ,mgpp
-                          ,mlayers
-                          );
-    if(new_layer_id < 0)
-    {
-      continue;
-      break;
-    }
-    else
-    {
-      gint32 tween_image_id;
-      gint   l_src_offset_x, l_src_offset_y;    /* layeroffsets as they were in src_image */
-      
-      if(mgpp->create_tween_layers)
-      {
-        cp_layer_id = gap_layer_copy_to_dest_image(dst_image_id
-                                     ,new_layer_id
-                                     ,100.0           /* Opacity */
-                                     ,0               /* NORMAL */
-                                     ,&l_src_offset_x
-                                     ,&l_src_offset_y
-                                     );
-        gimp_image_add_layer(dst_image_id
-                            , cp_layer_id
-                            , dst_stack_position
-                            );
-      }
-      else
-      {
-        gint ii;
+     printf("could not create frame filename for frameNr:%d\n", (int)frameNr);
+     return -1;
+  }
 
-        /* replace content of current dst_layer[ii] by content of new_layer_id */
-        ii = mlayers->dst1_idx - (current_step -1);
-        gap_layer_copy_content(mlayers->dst_layers[ii], new_layer_id);
-      }
-      tween_image_id = gimp_drawable_get_image(new_layer_id);
-      gimp_image_delete(tween_image_id);
+  if(!g_file_test(ainfo_ptr->new_filename, G_FILE_TEST_EXISTS))
+  {
+     printf("file not found: %s\n", ainfo_ptr->new_filename);
+     return -1;
+  }
+
+  /* load current frame */
+  imageId = gap_lib_load_image(ainfo_ptr->new_filename);
+  if(imageId >= 0)
+  {
+    char *targetTweenFilename;
+    
+    layerId = gap_image_merge_visible_layers(imageId, GIMP_CLIP_TO_IMAGE);
+    
+    targetTweenFilename = p_buildTargetTweenFilename(ainfo_ptr, tweenDirectory, targetFrameNr);
+    
+    if(gap_debug)
+    {
+      printf("COPY: %s ==> %s\n", ainfo_ptr->new_filename, targetTweenFilename);
     }
 
 
-    if(mgpp->do_progress)
+    if((!g_file_test(targetTweenFilename, G_FILE_TEST_EXISTS))
+    || (overwrite_flag == TRUE))
     {
-      mgpp->master_progress = (gdouble)current_step / (gdouble)(MAX(1, last_step));
-      if(mgpp->progress_callback_fptr == NULL)
-      {
-        gimp_progress_update(mgpp->master_progress);
-      }
-      else
-      {
-        (*mgpp->progress_callback_fptr)(mgpp->master_progress, mgpp->callback_data_ptr);
-      }
+      gap_lib_file_copy(ainfo_ptr->new_filename /* the original file */
+                     ,targetTweenFilename     /* the copy */
+                     );
     }
-
     
+
   }
-  return(cp_layer_id);
   
-}  /* end gap_morph_execute */
+  return(layerId);
 
+}  /* end p_copyAndGetMergedFrameImageLayer */
 
 
-/* ----------------------------------
- * p_create_simple_fade_tween_frame
- * ----------------------------------
- *
- * return the newly created tween morphed layer
- *
+/* -------------------------------------
+ * p_tween_batch_is_canceled
+ * -------------------------------------
  */
-static gint32
-p_create_simple_fade_tween_frame(gint32 total_steps
-                          ,gint32 current_step
-                          ,GapMorphGlobalParams *mgpp
-                          )
+static gboolean
+p_tween_batch_is_canceled(GapMorphTweenBatch *tbat)
 {
-   gint32  curr_image_id;  /* a temp image of current layer size */
-   gint32  bg_layer_id;
-   gint32  top_layer_id;
-   gint32  merged_layer_id;
-   gint32  curr_width;
-   gint32  curr_height;
-   gdouble curr_opacity;
-   gint32 src_layer_id;
-   gint32 dst_layer_id;
-   GimpImageType  l_src_type;
-   
-   src_layer_id = mgpp->osrc_layer_id;
-   dst_layer_id = mgpp->fdst_layer_id;
+  gboolean cancel;
 
+  g_mutex_lock(tbat->mutex);
+  cancel = tbat->cancel;
+  g_mutex_unlock(tbat->mutex);
 
-   /* check size of the new frame */
-   curr_width = gimp_drawable_width(src_layer_id);
-   if (curr_width != gimp_drawable_width(dst_layer_id))
-   {
-     return -1;
-   }
+  return (cancel);
+}  /* end p_tween_batch_is_canceled */
 
-   curr_height = gimp_drawable_height(src_layer_id);
-   if (curr_height != gimp_drawable_height(dst_layer_id))
-   {
-     return -1;
-   }
 
+/* -------------------------------------
+ * p_tween_batch_warp
+ * -------------------------------------
+ * render the warped pixels of wld->src_data into wld->dst_data
+ * in the current thread (band by band, or in gimp tile order for the
+ * QUALITY workpoint selection, same result as p_layer_warp_move).
+ * returns FALSE when the batch was canceled while rendering.
+ */
+static gboolean
+p_tween_batch_warp(GapMorphTweenBatch *tbat, GapMorphWarpLayerData *wld, GapMorphWorkPoint *wp_list)
+{
+  GapMorphWarpThreadData  wtd_struct;
+  GapMorphWarpThreadData *wtd;
+  gint32   bandIdx;
+  gboolean ok;
+
+  wtd = &wtd_struct;
+  wtd->wld = wld;
+  wtd->cpuId = 0;
+  wtd->master_list_1 = wp_list;
+  wtd->master_list_2 = NULL;
+  wtd->wcap_1 = tbat->wcap;
+  wtd->wcap_2 = tbat->wcap;
+  wtd->wcap_1.wp_list = p_copy_workpoint_list(wp_list);
+  wtd->wcap_2.wp_list = NULL;
+  wtd->wcap_1.wp_grid = NULL;
+  wtd->wcap_2.wp_grid = NULL;
 
-  l_src_type    = gimp_drawable_type(src_layer_id);
-  if (l_src_type != gimp_drawable_type(dst_layer_id))
+  /* if src and dst size not equal: caluclate scaling factors x/y */
+  wtd->wcap_1.scale_x = wld->src_width / MAX(1,wld->dst_width);
+  wtd->wcap_1.scale_y = wld->src_height / MAX(1,wld->dst_height);
+  wtd->wcap_2.scale_x = wtd->wcap_1.scale_x;
+  wtd->wcap_2.scale_y = wtd->wcap_1.scale_y;
+
+  wtd->wcap_1.wp_grid = p_create_wp_grid(&wtd->wcap_1, wld->dst_width, wld->dst_height);
+
+  ok = TRUE;
+  for(bandIdx = 0; bandIdx < wld->numBands; bandIdx++)
   {
-    return -1;
+    if(p_tween_batch_is_canceled(tbat))
+    {
+      ok = FALSE;
+      break;
+    }
+    p_warp_band(wtd, bandIdx);
   }
-  
-  curr_image_id = -1;
-  
-  switch(l_src_type)
-  {
-    case GIMP_RGB_IMAGE:         /* 0 */
-    case GIMP_RGBA_IMAGE:        /* 1 */
-       curr_image_id = gimp_image_new(curr_width, curr_height, GIMP_RGB);
-       break;
-    case GIMP_GRAY_IMAGE:        /* 2 */
-    case GIMP_GRAYA_IMAGE:       /* 3 */
-       curr_image_id = gimp_image_new(curr_width, curr_height, GIMP_GRAY);
-       break;
-    case GIMP_INDEXED_IMAGE:     /* 4 */
-    case GIMP_INDEXEDA_IMAGE:    /* 5 */
-       return -1;
-       break;
-  }   
 
+  p_free_wp_grid(&wtd->wcap_1.wp_grid);
+  gap_morph_exec_free_workpoint_list(&wtd->wcap_1.wp_list);
 
-   bg_layer_id = gap_layer_copy_to_image (curr_image_id, mgpp->osrc_layer_id);
-   top_layer_id = gap_layer_copy_to_image (curr_image_id, mgpp->fdst_layer_id);
+  return (ok);
+}  /* end p_tween_batch_warp */
 
-   /* merge BG and TOP Layer (does mix opacity according to current step) */
-   curr_opacity = p_linear_advance((gdouble)total_steps
-                                ,(gdouble)current_step
-                                ,(gdouble)0.0
-                                ,(gdouble)100.0
-                                );
-   if(mgpp->do_progress)
-   {
-     if(mgpp->progress_callback_fptr != NULL)
-     {
-         (*mgpp->progress_callback_fptr)(0.05, mgpp->callback_data_ptr);
-     }
-   }
 
-   merged_layer_id = 
-   p_mix_layers(curr_image_id
-               ,bg_layer_id
-               ,top_layer_id
-               ,curr_width
-               ,curr_height
-               ,(gdouble)(curr_opacity / 100.0)
-               );
- 
-   if(mgpp->do_progress)
-   {
-     if(mgpp->progress_callback_fptr != NULL)
-     {
-         (*mgpp->progress_callback_fptr)(1.0, mgpp->callback_data_ptr);
-     }
-   }
-   mgpp->master_progress += mgpp->layer_progress_step;
+/* -------------------------------------
+ * p_tween_batch_render_job
+ * -------------------------------------
+ * render one tween frame into tjob->tween_data.
+ * The src layer is warped forward (BG), the dst layer is warped backward (TOP)
+ * and both are mixed according to the current step
+ * (the same operations as p_create_morph_tween_frame and p_mix_layers
+ * perform via gimp layers).
+ */
+static void
+p_tween_batch_render_job(GapMorphTweenBatch *tbat, GapMorphTweenJob *tjob)
+{
+  GapMorphWarpLayerData  wld_struct;
+  GapMorphWarpLayerData *wld;
+  guchar  *bg_data;
+  guchar  *top_data;
+  gint32   dataSize;
+  gint32   ii;
+
+  dataSize = tjob->curr_width * tjob->curr_height * tbat->bpp;
+  bg_data = g_malloc(dataSize);
+  top_data = g_malloc(dataSize);
+
+  wld = &wld_struct;
+  wld->bpp = tbat->bpp;
+  wld->dst_width = tjob->curr_width;
+  wld->dst_height = tjob->curr_height;
+  wld->have_workpointsets = FALSE;
+  wld->wp_mix_factor = 1.0;
+  wld->wtdArray = NULL;
+  wld->numBands = (tjob->curr_height + (GAP_MORPH_WARP_BAND_HEIGHT -1)) / GAP_MORPH_WARP_BAND_HEIGHT;
+  wld->nextBand = 0;
+  wld->bandsDone = 0;
+  wld->numWorkersActive = 0;
+  wld->refCount = 1;
+  wld->mutex = NULL;
+  wld->cond = NULL;
+
+  /* warp the BG layer */
+  wld->src_data = tbat->src_data;
+  wld->src_width = tbat->src_width;
+  wld->src_height = tbat->src_height;
+  wld->dst_data = bg_data;
+  if(p_tween_batch_warp(tbat, wld, tjob->wp_list_bg))
+  {
+    /* warp the TOP layer */
+    wld->src_data = tbat->dst_data;
+    wld->src_width = tbat->dst_width;
+    wld->src_height = tbat->dst_height;
+    wld->dst_data = top_data;
+    if(p_tween_batch_warp(tbat, wld, tjob->wp_list_top))
+    {
+      /* mix BG and TOP (does mix opacity according to current step) */
+      tjob->tween_data = g_malloc(dataSize);
+      for(ii=0; ii < dataSize; ii++)
+      {
+        gdouble val;
 
+        val = GAP_BASE_MIX_VALUE(tjob->curr_mix_factor, (gdouble)(bg_data[ii]), (gdouble)(top_data[ii]));
+        tjob->tween_data[ii] = (guchar)val;
+      }
+    }
+  }
 
-   /* DEBUG code: show duplicate of the temporary tween image */
-   if(FALSE)
-   {
-     gint32 dup_id;
+  g_free(bg_data);
+  g_free(top_data);
 
-     dup_id = gimp_image_duplicate(curr_image_id);
-     gimp_display_new (dup_id);
+}  /* end p_tween_batch_render_job */
 
-   }
 
-   return(merged_layer_id);
+/* -------------------------------------
+ * p_tween_batch_unref
+ * -------------------------------------
+ * drop one reference to the batch, the batch is freed
+ * when the last reference is dropped.
+ */
+static void
+p_tween_batch_unref(GapMorphTweenBatch *tbat)
+{
+  gint32 refCount;
+  gint32 ii;
 
-}  /* end p_create_simple_fade_tween_frame  */
+  refCount = 0;
+  if(tbat->mutex != NULL)
+  {
+    g_mutex_lock(tbat->mutex);
+    tbat->refCount--;
+    refCount = tbat->refCount;
+    g_mutex_unlock(tbat->mutex);
+  }
+  if(refCount > 0)
+  {
+    return;
+  }
 
+  if(tbat->mutex != NULL)
+  {
+    g_mutex_free(tbat->mutex);
+    g_cond_free(tbat->cond);
+  }
+  for(ii=0; ii < tbat->numJobs; ii++)
+  {
+    gap_morph_exec_free_workpoint_list(&tbat->jobs[ii].wp_list_bg);
+    gap_morph_exec_free_workpoint_list(&tbat->jobs[ii].wp_list_top);
+    if(tbat->jobs[ii].tween_data != NULL)
+    {
+      g_free(tbat->jobs[ii].tween_data);
+    }
+  }
+  g_free(tbat->jobs);
+  g_free(tbat->src_data);
+  g_free(tbat->dst_data);
+  g_free(tbat);
 
-/* ----------------------------------
- * gap_morph_render_one_of_n_tweens
- * ----------------------------------
- * This procedure creates only one tween (a scene between 2 video frames)
- * according to the specified total_steps and current_step parameters.
- * the created tween is part of a new created image
- * that contians the tween layer.
- *
- * return the newly created tween morphed layer
- *
+}  /* end p_tween_batch_unref */
+
+
+/* -------------------------------------
+ * p_tween_batch_WorkerThreadFunction
+ * -------------------------------------
+ * this function runs in concurrent parallel worker threads.
+ * each thread renders tween frames (in ascending order of the steps)
+ * until all jobs are assigned or the batch is canceled.
+ * A job is assigned only when it fits into the window of maxResident
+ * tween frames that are not yet saved by the main thread.
+ * A worker that was queued but was already given up by the main thread
+ * (see p_tween_batch_start) just drops its reference.
+ * (the worker threads do not call any gimp procedures)
  */
-gint32
-gap_morph_render_one_of_n_tweens(GapMorphGlobalParams *mgpp, gdouble total_steps, gdouble current_step)
+static void
+p_tween_batch_WorkerThreadFunction(GapMorphTweenWorker *twrk)
 {
-  gint32 new_layer_id;
-  GapMorphExeLayerstack mlayers_struct;
-  GapMorphExeLayerstack *mlayers;
-  gint32              bck_tween_steps;
-  gint32              ret_layer_id;
-  
-  mlayers = &mlayers_struct;
-  mlayers->tab_wp_sets = NULL;
-  mlayers->available_wp_sets = 0;
-  new_layer_id = -1;
-  
-  p_get_tween_steps_and_layerstacks(mgpp, mlayers);
+  GapMorphTweenBatch *tbat;
+  GapMorphTweenJob   *tjob;
+  gboolean            isClaimed;
 
-  mgpp->create_tween_layers = TRUE;
+  tbat = twrk->tbat;
 
-  /* check if workpoint filename is available */
-  if(mgpp->workpoint_file_lower)
+  g_mutex_lock(tbat->mutex);
+  isClaimed = (twrk->isStarted != TRUE);
+  twrk->isStarted = TRUE;
+  g_mutex_unlock(tbat->mutex);
+
+  if(isClaimed != TRUE)
   {
-    if(*mgpp->workpoint_file_lower != '\0')
-    {
-      /* load a single workpointfile */
-      mlayers->available_wp_sets = 1;
-      mlayers->tab_wp_sets = g_new(GapMorphWarpCoreAPI*, mlayers->available_wp_sets);
-      
-      mlayers->tab_wp_sets[0] = p_load_workpoint_set(mgpp->workpoint_file_lower, mgpp, mlayers);
-      mgpp->master_wp_list = mlayers->tab_wp_sets[0]->wp_list;
-      
-      mgpp->have_workpointsets = FALSE;
-      mlayers->available_wp_sets = 0;
-    }
+    p_tween_batch_unref(tbat);
+    return;
   }
-  
-  /* overrule the number of steps with the explicite parameter value */
-  bck_tween_steps = mgpp->tween_steps;
-  mgpp->tween_steps = total_steps;
 
-  if(mgpp->do_simple_fade)
+  while(TRUE)
   {
-    if(gap_debug)
+    g_mutex_lock(tbat->mutex);
+    while((tbat->cancel != TRUE)
+    && (tbat->nextJob < tbat->numJobs)
+    && (tbat->nextJob >= tbat->firstResident + tbat->maxResident))
     {
-      printf("do_simple_fade == TRUE, skip morph and do fade operation instead\n");
+      g_cond_wait(tbat->cond, tbat->mutex);
     }
+    if((tbat->cancel == TRUE) || (tbat->nextJob >= tbat->numJobs))
+    {
+      g_mutex_unlock(tbat->mutex);
+      break;
+    }
+    tjob = &tbat->jobs[tbat->nextJob];
+    tbat->nextJob++;
+    g_mutex_unlock(tbat->mutex);
 
-    /* we have no workpoints available
-     * in this case make an attempt with a fast fade operation
-     *  (but restricted to frames of same size and type)
-     */
-    new_layer_id =  p_create_simple_fade_tween_frame(total_steps
-                          ,current_step
-                          ,mgpp
-                          );
-    
-  }
-  
-  if( new_layer_id < 0)
-  {
-    if(gap_debug)
+    if(tjob->skip != TRUE)
     {
-      printf("calling the full morph algorithm  total_steps:%f current_step:%f\n"
-        ,(float)total_steps
-        ,(float)current_step
-        );
+      p_tween_batch_render_job(tbat, tjob);
     }
-    new_layer_id = p_create_morph_tween_frame(total_steps
-                          ,current_step
-                          ,mgpp
-                          ,mlayers
-                          );
+
+    g_mutex_lock(tbat->mutex);
+    tjob->isRendered = TRUE;
+    g_cond_broadcast(tbat->cond);
+    g_mutex_unlock(tbat->mutex);
   }
-  ret_layer_id = gap_image_merge_to_specified_layer(new_layer_id, GIMP_CLIP_TO_IMAGE);
 
-  /* restore tween_steps value */
-  mgpp->tween_steps = bck_tween_steps;
-  
-  return(ret_layer_id);
-  
-}  /* end gap_morph_render_one_of_n_tweens */
+  g_mutex_lock(tbat->mutex);
+  tbat->numWorkersActive--;
+  g_cond_broadcast(tbat->cond);
+  g_mutex_unlock(tbat->mutex);
 
+  p_tween_batch_unref(tbat);
 
-/* ----------------------------------
- * gap_morph_render_one_tween
- * ----------------------------------
- * This procedure creates only one tween (a scene between 2 video frames)
- * according to the specified mix factor (mgpp->tween_mix_factor)
- * the created tween is part of a new created image
- * that contians the tween layer.
- *
- * return the newly created tween morphed layer
+}  /* end p_tween_batch_WorkerThreadFunction */
+
+
+/* -------------------------------------
+ * p_tween_batch_new
+ * -------------------------------------
+ * prepare parallel rendering of the tween frames 1 upto numSteps
+ * between mgpp->osrc_layer_id and mgpp->fdst_layer_id.
+ * returns NULL in case the batch mode is not applicable
+ * (single processor, simple fade, warp mode, or layers without alpha channel).
+ * In this case the caller shall render the tweens one after another
+ * via gap_morph_render_one_of_n_tweens.
  *
+ * Note: all gimp calls (including the calculation of the workpoint movement)
+ * are done here in the main thread, the worker threads
+ * are started later via p_tween_batch_start.
  */
-gint32
-gap_morph_render_one_tween(GapMorphGlobalParams *mgpp)
+static GapMorphTweenBatch *
+p_tween_batch_new(GapMorphGlobalParams *mgpp, gdouble total_steps, gint32 numSteps)
 {
-  gint32 new_layer_id;
-  gdouble total_steps;
-  gdouble current_step;
-  
-  total_steps = 1.0 * 100000;
-  current_step = CLAMP(mgpp->tween_mix_factor, 0.0, 1.0) * 100000;
+  GapMorphTweenBatch    *tbat;
+  GapMorphExeLayerstack  mlayers_struct;
+  GapMorphWarpCoreAPI   *wps;
+  GimpDrawable *src_drawable;
+  GimpDrawable *dst_drawable;
+  GimpPixelRgn  srcPR;
+  GimpPixelRgn  dstPR;
+  gint32        batchSize;
+  gint          numThreads;
+  gint32        ii;
+
+  if((mgpp->do_simple_fade)
+  || (mgpp->render_mode != GAP_MORPH_RENDER_MODE_MORPH)
+  || (mgpp->workpoint_file_lower[0] == '\0')
+  || (numSteps < 2))
+  {
+    return (NULL);
+  }
 
-  
-  new_layer_id = gap_morph_render_one_of_n_tweens(mgpp, total_steps, current_step);
+  batchSize = gap_base_get_gimprc_int_value(GAP_MORPH_GIMPRC_TWEEN_BATCH_SIZE
+                                 , gap_base_get_numProcessors()
+                                 , 1
+                                 , GAP_MORPH_TWEEN_BATCH_MAX_SIZE
+                                 );
+  numThreads = MIN(gap_base_get_numProcessors(), GAP_MORPH_WARP_MAX_THREADS);
+  numThreads = MIN(numThreads, batchSize);
+  numThreads = MIN(numThreads, numSteps);
+  if(numThreads < 2)
+  {
+    return (NULL);
+  }
+  if(gap_base_thread_init() != TRUE)
+  {
+    return (NULL);
+  }
 
-  return (new_layer_id);
-}  /* end gap_morph_render_one_tween */
+  if((gimp_drawable_bpp(mgpp->osrc_layer_id) != gimp_drawable_bpp(mgpp->fdst_layer_id))
+  || ((gimp_drawable_bpp(mgpp->osrc_layer_id) != 4) && (gimp_drawable_bpp(mgpp->osrc_layer_id) != 2)))
+  {
+    return (NULL);
+  }
+
+  /* load the workpoint file (the same way as gap_morph_render_one_of_n_tweens does) */
+  mlayers_struct.tab_wp_sets = NULL;
+  mlayers_struct.available_wp_sets = 0;
+  mgpp->create_tween_layers = TRUE;
+  wps = p_load_workpoint_set(mgpp->workpoint_file_lower, mgpp, &mlayers_struct);
+  mgpp->master_wp_list = wps->wp_list;
+  mgpp->have_workpointsets = FALSE;
+  g_free(wps);
+
+  tbat = g_new0(GapMorphTweenBatch, 1);
+  tbat->numThreads = numThreads;
+  tbat->maxResident = MAX(batchSize, numThreads);
+  tbat->numJobs = numSteps;
+  tbat->nextJob = 0;
+  tbat->firstResident = 0;
+  tbat->numWorkersActive = 0;
+  tbat->cancel = FALSE;
+  tbat->refCount = 1;
+
+  tbat->wcap.wp_list = NULL;
+  tbat->wcap.wp_grid = NULL;
+  tbat->wcap.sqr_affect_radius = mgpp->affect_radius * mgpp->affect_radius;
+  tbat->wcap.use_gravity = mgpp->use_gravity;
+  tbat->wcap.gravity_intensity = mgpp->gravity_intensity;
+  tbat->wcap.printf_flag = FALSE;
+  tbat->wcap.use_quality_wp_selection = mgpp->use_quality_wp_selection;
+
+  /* read the pixels of both source layers into memory */
+  src_drawable = gimp_drawable_get (mgpp->osrc_layer_id);
+  dst_drawable = gimp_drawable_get (mgpp->fdst_layer_id);
+  tbat->bpp = src_drawable->bpp;
+  tbat->src_width = src_drawable->width;
+  tbat->src_height = src_drawable->height;
+  tbat->dst_width = dst_drawable->width;
+  tbat->dst_height = dst_drawable->height;
+  tbat->src_data = g_malloc(tbat->src_width * tbat->src_height * tbat->bpp);
+  tbat->dst_data = g_malloc(tbat->dst_width * tbat->dst_height * tbat->bpp);
+  gimp_pixel_rgn_init (&srcPR, src_drawable, 0, 0, tbat->src_width, tbat->src_height
+                      , FALSE     /* dirty */
+                      , FALSE     /* shadow */
+                       );
+  gimp_pixel_rgn_get_rect (&srcPR, tbat->src_data, 0, 0, tbat->src_width, tbat->src_height);
+  gimp_pixel_rgn_init (&dstPR, dst_drawable, 0, 0, tbat->dst_width, tbat->dst_height
+                      , FALSE     /* dirty */
+                      , FALSE     /* shadow */
+                       );
+  gimp_pixel_rgn_get_rect (&dstPR, tbat->dst_data, 0, 0, tbat->dst_width, tbat->dst_height);
+  gimp_drawable_detach(src_drawable);
+  gimp_drawable_detach(dst_drawable);
 
+  /* calculate size, opacity and workpoint movement of all tween frames */
+  tbat->jobs = g_new0(GapMorphTweenJob, numSteps);
+  for(ii=0; ii < numSteps; ii++)
+  {
+    GapMorphTweenJob *tjob;
+
+    tjob = &tbat->jobs[ii];
+    tjob->current_step = ii + 1;
+    tjob->curr_width = p_linear_advance(total_steps
+                                  ,tjob->current_step
+                                  ,(gdouble)tbat->src_width
+                                  ,(gdouble)tbat->dst_width
+                                  );
+    tjob->curr_height = p_linear_advance(total_steps
+                                  ,tjob->current_step
+                                  ,(gdouble)tbat->src_height
+                                  ,(gdouble)tbat->dst_height
+                                  );
+    tjob->curr_mix_factor = p_linear_advance(total_steps
+                                  ,tjob->current_step
+                                  ,(gdouble)0.0
+                                  ,(gdouble)100.0
+                                  ) / 100.0;
+    tjob->wp_list_bg = p_calculate_work_point_movement(total_steps
+                                  ,tjob->current_step
+                                  ,mgpp->master_wp_list
+                                  ,mgpp->osrc_layer_id
+                                  ,mgpp->fdst_layer_id
+                                  ,tjob->curr_width
+                                  ,tjob->curr_height
+                                  ,TRUE    /* forward_move */
+                                  );
+    tjob->wp_list_top = p_calculate_work_point_movement(total_steps
+                                  ,tjob->current_step
+                                  ,mgpp->master_wp_list
+                                  ,mgpp->osrc_layer_id
+                                  ,mgpp->fdst_layer_id
+                                  ,tjob->curr_width
+                                  ,tjob->curr_height
+                                  ,FALSE   /* forward_move */
+                                  );
+    tjob->tween_data = NULL;
+    tjob->skip = FALSE;
+    tjob->isRendered = FALSE;
+  }
 
+  if(gap_debug)
+  {
+    printf("p_tween_batch_new: numSteps:%d numThreads:%d maxResident:%d\n"
+      , (int)tbat->numJobs
+      , (int)tbat->numThreads
+      , (int)tbat->maxResident
+      );
+  }
 
+  return (tbat);
+}  /* end p_tween_batch_new */
 
-/* -----------------------------------------------
- * p_buildTargetTweenFilename
- * -----------------------------------------------
- * build filename for the target Tween frame with the specified targetFrameNr number part
- * with full directory path (specified by tweenDirectory)
- *
- * the caller is rsponsible to g_free the returned filename.
+
+/* -------------------------------------
+ * p_tween_batch_start
+ * -------------------------------------
+ * start the worker threads (the jobs that shall be skipped
+ * must be marked before this call)
  */
-static char*
-p_buildTargetTweenFilename(GapAnimInfo *ainfo_ptr, const char *tweenDirectory, gint32 targetFrameNr)
+static void
+p_tween_batch_start(GapMorphTweenBatch *tbat)
 {
-  char *fileBasenameWithoutDir;
-  char *fileNameTarget;
-  char *fileNameTargetWithDir;
-  char *checkName;
-  
-  
-  fileBasenameWithoutDir = g_path_get_basename(ainfo_ptr->basename);
-  fileNameTarget = g_strdup_printf("%s%06d%s"
-                          , fileBasenameWithoutDir
-                          , (int)targetFrameNr
-                          , ainfo_ptr->extension
-                          );
+  static GThreadPool  *threadPool = NULL;
+  gint ii;
 
-  checkName = g_build_filename(tweenDirectory, fileBasenameWithoutDir, NULL);
-  
-  if((strcmp(checkName, ainfo_ptr->basename) == 0)
-  || (*tweenDirectory == '.'))
+  if(threadPool == NULL)
   {
-    if(gap_debug)
+    GError *error = NULL;
+
+    /* init the treadPool at first multiprocessing call
+     * (and keep the threads until end of main process..)
+     */
+    threadPool = g_thread_pool_new((GFunc) p_tween_batch_WorkerThreadFunction
+                                         ,NULL        /* user data */
+                                         ,GAP_MORPH_WARP_MAX_THREADS          /* max_threads */
+                                         ,TRUE        /* exclusive */
+                                         ,&error      /* GError **error */
+                                         );
+    if((threadPool == NULL) || (error != NULL))
     {
-      printf("WARNING: create tween in directory: %s\n"
-           "  with additional prefix tween_"
-           "  to prevent overwrite of source frames in the same directory\n"
-        , tweenDirectory
+      /* an exclusive pool reports an error when not all of its threads could be started */
+      printf("** ERROR p_tween_batch_start: could not create thread pool %s\n"
+        , (error != NULL) ? error->message : ""
         );
+      if(error != NULL)
+      {
+        g_error_free(error);
+      }
+      if(threadPool != NULL)
+      {
+        g_thread_pool_free(threadPool, FALSE, TRUE);
+        threadPool = NULL;
+      }
     }
-    fileNameTarget = g_strdup_printf("tween_%s%06d%s"
-                          , fileBasenameWithoutDir
-                          , (int)targetFrameNr
-                          , ainfo_ptr->extension
-                          );
   }
-  else
+
+  tbat->mutex = g_mutex_new();
+  tbat->cond = g_cond_new();
+  tbat->haveWorkers = (threadPool != NULL);
+  if(tbat->haveWorkers != TRUE)
   {
-    fileNameTarget = g_strdup_printf("%s%06d%s"
-                          , fileBasenameWithoutDir
-                          , (int)targetFrameNr
-                          , ainfo_ptr->extension
-                          );
+    /* no workers available, p_tween_batch_fetch_layer renders in the main thread */
+    return;
   }
 
-  fileNameTargetWithDir = g_build_filename(tweenDirectory, fileNameTarget, NULL);
+  for(ii=0; ii < tbat->numThreads; ii++)
+  {
+    GapMorphTweenWorker *twrk;
+    GError *error = NULL;
+
+    twrk = &tbat->workers[ii];
+    twrk->tbat = tbat;
+    twrk->cpuId = ii;
+    twrk->isStarted = FALSE;
+
+    g_mutex_lock(tbat->mutex);
+    tbat->numWorkersActive++;
+    tbat->refCount++;
+    g_mutex_unlock(tbat->mutex);
+
+    g_thread_pool_push (threadPool
+                       , twrk    /* user Data for the worker thread*/
+                       , &error
+                       );
+    if(error != NULL)
+    {
+      /* glib queues the worker even when no additional thread could be started.
+       * it is given up unless a pool thread has already picked it up,
+       * a worker that is picked up later just drops its reference.
+       */
+      printf("** WARNING p_tween_batch_start: could not push worker %d to the thread pool %s\n"
+        , (int)ii
+        , error->message
+        );
+      g_error_free(error);
 
+      g_mutex_lock(tbat->mutex);
+      if(twrk->isStarted != TRUE)
+      {
+        twrk->isStarted = TRUE;
+        tbat->numWorkersActive--;
+      }
+      g_mutex_unlock(tbat->mutex);
+    }
+  }
 
-  if(gap_debug)
+  g_mutex_lock(tbat->mutex);
+  if(tbat->numWorkersActive <= 0)
   {
-    printf("checkName: %s\n", checkName);
-    printf("fileBasenameWithoutDir: %s\n", fileBasenameWithoutDir);
-    printf("fileNameTarget: %s\n", fileNameTarget);
-    printf("fileNameTargetWithDir: %s\n", fileNameTargetWithDir);
+    /* all workers were given up, p_tween_batch_fetch_layer renders in the main thread */
+    tbat->haveWorkers = FALSE;
   }
-  
-  if(fileBasenameWithoutDir)    { g_free(fileBasenameWithoutDir); }
-  if(fileNameTarget)            { g_free(fileNameTarget); }
-  if(checkName)                 { g_free(checkName); }
-
-  return(fileNameTargetWithDir);
+  g_mutex_unlock(tbat->mutex);
 
-}  /* end p_buildTargetTweenFilename */
+}  /* end p_tween_batch_start */
 
 
-/* -----------------------------------------------
- * p_copyAndGetMergedFrameImageLayer
- * -----------------------------------------------
- * load the specified frame as temporary image, merge to one layer and return this layer's id.
- * further copy the original image to the directory specified via tweenDirectory
- * the filename of the copy is built with original filename and extension but the number part is replaced
- * by the specified targetFrameNr.
+/* -------------------------------------
+ * p_tween_batch_fetch_layer
+ * -------------------------------------
+ * wait until the tween frame with the specified step is rendered
+ * and create an image with the tween frame layer.
+ * While waiting the layer progress is updated and the cancelFlagPtr is checked.
+ * The pixel data of all tween frames up to this step is freed
+ * (this lets the worker threads continue with the next tween frames).
  *
- * return -1 if FAILED, or layerId (positive integer) on success
+ * return the tween layer id, or -1 when canceled.
  */
-gint32
-p_copyAndGetMergedFrameImageLayer(GapAnimInfo *ainfo_ptr, gint32 frameNr
-   , const char *tweenDirectory, gint32 targetFrameNr, gboolean overwrite_flag)
+static gint32
+p_tween_batch_fetch_layer(GapMorphTweenBatch *tbat, gint32 step
+  , GapMorphGlobalParams *mgpp, gboolean *cancelFlagPtr)
 {
-  gint32 imageId;
-  gint32 layerId;
+  GapMorphTweenJob *tjob;
+  GimpDrawable     *dst_drawable;
+  GimpPixelRgn      dstPR;
+  gint32            curr_image_id;
+  gint32            layer_id;
+  gint32            jobIdx;
 
-  layerId = -1;
-  if(ainfo_ptr->new_filename != NULL)
+  jobIdx = step -1;
+  tjob = &tbat->jobs[jobIdx];
+
+  if(tbat->haveWorkers != TRUE)
   {
-    g_free(ainfo_ptr->new_filename);
+    /* thread pool not available: render in the main thread */
+    p_tween_batch_render_job(tbat, tjob);
+    tjob->isRendered = TRUE;
   }
-  ainfo_ptr->new_filename = gap_lib_alloc_fname(ainfo_ptr->basename,
-                                      frameNr,
-                                      ainfo_ptr->extension);
-  if(ainfo_ptr->new_filename == NULL)
+
+  mgpp->master_progress = 0.0;
+  mgpp->layer_progress_step = 1.0;
+
+  /* the previous tween frames are already saved or skipped,
+   * move the window of resident tween frames up to the requested step
+   */
+  g_mutex_lock(tbat->mutex);
+  tbat->firstResident = MAX(tbat->firstResident, jobIdx);
+  g_cond_broadcast(tbat->cond);
+  while(tjob->isRendered != TRUE)
   {
-     printf("could not create frame filename for frameNr:%d\n", (int)frameNr);
-     return -1;
+    GTimeVal  endTime;
+    gint32    jj;
+    gint32    jobsRendered;
+
+    /* timed wait to keep progress and cancel handling alive */
+    g_get_current_time(&endTime);
+    g_time_val_add(&endTime, 250000);   /* 0.25 sec */
+    g_cond_timed_wait(tbat->cond, tbat->mutex, &endTime);
+
+    jobsRendered = 0;
+    for(jj = tbat->firstResident; jj < tbat->nextJob; jj++)
+    {
+      if(tbat->jobs[jj].isRendered)
+      {
+        jobsRendered++;
+      }
+    }
+    g_mutex_unlock(tbat->mutex);
+
+    p_warp_progress_update(mgpp, (gdouble)jobsRendered / (gdouble)MAX(1, tbat->maxResident));
+    if((mgpp->do_progress) && (cancelFlagPtr != NULL))
+    {
+      if (*cancelFlagPtr == TRUE)
+      {
+        return (-1);
+      }
+    }
+
+    g_mutex_lock(tbat->mutex);
   }
+  tbat->firstResident = jobIdx + 1;
+  g_cond_broadcast(tbat->cond);
+  g_mutex_unlock(tbat->mutex);
 
-  if(!g_file_test(ainfo_ptr->new_filename, G_FILE_TEST_EXISTS))
+  if(tjob->tween_data == NULL)
   {
-     printf("file not found: %s\n", ainfo_ptr->new_filename);
-     return -1;
+    return (-1);
   }
 
-  /* load current frame */
-  imageId = gap_lib_load_image(ainfo_ptr->new_filename);
-  if(imageId >= 0)
+  /* create the tween frame image and layer in the main thread */
+  if(tbat->bpp < 3)
   {
-    char *targetTweenFilename;
-    
-    layerId = gap_image_merge_visible_layers(imageId, GIMP_CLIP_TO_IMAGE);
-    
-    targetTweenFilename = p_buildTargetTweenFilename(ainfo_ptr, tweenDirectory, targetFrameNr);
-    
-    if(gap_debug)
-    {
-      printf("COPY: %s ==> %s\n", ainfo_ptr->new_filename, targetTweenFilename);
-    }
+    curr_image_id = gimp_image_new(tjob->curr_width, tjob->curr_height, GIMP_GRAY);
+    layer_id = gimp_layer_new(curr_image_id, "morph_tween"
+                               , tjob->curr_width
+                               , tjob->curr_height
+                               , GIMP_GRAYA_IMAGE
+                               , 100.0      /* full opaque */
+                               , GIMP_NORMAL_MODE
+                               );
+  }
+  else
+  {
+    curr_image_id = gimp_image_new(tjob->curr_width, tjob->curr_height, GIMP_RGB);
+    layer_id = gimp_layer_new(curr_image_id, "morph_tween"
+                               , tjob->curr_width
+                               , tjob->curr_height
+                               , GIMP_RGBA_IMAGE
+                               , 100.0      /* full opaque */
+                               , GIMP_NORMAL_MODE
+                               );
+  }
+  gimp_image_add_layer(curr_image_id, layer_id, 0);
+
+  dst_drawable = gimp_drawable_get (layer_id);
+  gimp_pixel_rgn_init (&dstPR, dst_drawable, 0, 0, tjob->curr_width, tjob->curr_height
+                      , TRUE      /* dirty */
+                      , TRUE      /* shadow */
+                       );
+  gimp_pixel_rgn_set_rect (&dstPR, tjob->tween_data, 0, 0, tjob->curr_width, tjob->curr_height);
+  gimp_drawable_flush (dst_drawable);
+  gimp_drawable_merge_shadow (dst_drawable->drawable_id, TRUE);
+  gimp_drawable_update (layer_id, 0, 0, tjob->curr_width, tjob->curr_height);
+  gimp_drawable_detach(dst_drawable);
 
+  g_free(tjob->tween_data);
+  tjob->tween_data = NULL;
 
-    if((!g_file_test(targetTweenFilename, G_FILE_TEST_EXISTS))
-    || (overwrite_flag == TRUE))
+  return (gap_image_merge_to_specified_layer(layer_id, GIMP_CLIP_TO_IMAGE));
+
+}  /* end p_tween_batch_fetch_layer */
+
+
+/* -------------------------------------
+ * p_tween_batch_free
+ * -------------------------------------
+ * cancel not yet started jobs, wait until all worker threads
+ * have finished and free the batch.
+ */
+static void
+p_tween_batch_free(GapMorphTweenBatch **tbatPtr)
+{
+  GapMorphTweenBatch *tbat;
+
+  tbat = *tbatPtr;
+  if(tbat == NULL)
+  {
+    return;
+  }
+
+  if(tbat->mutex != NULL)
+  {
+    g_mutex_lock(tbat->mutex);
+    tbat->cancel = TRUE;
+    g_cond_broadcast(tbat->cond);
+    while(tbat->numWorkersActive > 0)
     {
-      gap_lib_file_copy(ainfo_ptr->new_filename /* the original file */
-                     ,targetTweenFilename     /* the copy */
-                     );
+      g_cond_wait(tbat->cond, tbat->mutex);
     }
-    
-
+    g_mutex_unlock(tbat->mutex);
   }
-  
-  return(layerId);
 
-}  /* end p_copyAndGetMergedFrameImageLayer */
+  /* a worker that was given up in p_tween_batch_start may still hold a reference */
+  p_tween_batch_unref(tbat);
+  *tbatPtr = NULL;
 
+}  /* end p_tween_batch_free */
 
 
 
 /* -------------------------------------
  * p_morph_render_frame_tweens_in_subdir
  * -------------------------------------
+ * On multiprocessor machines the tween frames between each pair of source frames
+ * are rendered in parallel worker threads (see p_tween_batch_new),
+ * the main thread creates and saves the tween frames in frame order.
+ * The gimprc option video-morph-tween-batch-size limits the number of tween frames
+ * that are held in memory at the same time (value 1 disables the batch mode).
  *
  * return one of the newly created morphed tween frame layers
  *       (the one that was created last is picked)
@@ -3301,12 +4752,14 @@ p_morph_render_frame_tweens_in_subdir(GapAnimInfo *ainfo_ptr, GapMorphGlobalPara
   gdouble framesToProcess;
   gdouble nTweenFramesTotal;   /* for outer progress (frames that are just copied are not included in progress) */
   gdouble nTweenFramesDone;    /* rendered tween frames so far (frames that are just copied are not included) */
+  GapMorphTweenBatch *tbat;
 
 
 
   l_tween_layer_id = -1;
   l_errno = 0;
   targetTweenFrameFilename = NULL;
+  tbat = NULL;
 
   if(gap_debug)
   {
@@ -3481,6 +4934,31 @@ p_morph_render_frame_tweens_in_subdir(GapAnimInfo *ainfo_ptr, GapMorphGlobalPara
        mgpp->osrc_layer_id = currLayerId;
        mgpp->fdst_layer_id = nextLayerId;
 
+      /* render the tween frames of this frame pair in parallel (if applicable) */
+      tbat = p_tween_batch_new(mgpp, tweenFramesToBeCreated +1, tweenFramesToBeCreated);
+      if(tbat != NULL)
+      {
+        if (mgpp->overwrite_flag != TRUE)
+        {
+          gint32 ii;
+
+          for(ii=0; ii < tweenFramesToBeCreated; ii++)
+          {
+            char *tweenFilename;
+
+            tweenFilename = p_buildTargetTweenFilename(ainfo_ptr
+                                            , tweenDirectory
+                                            , currTargetFrameNr + 1 + ii);
+            if(tweenFilename != NULL)
+            {
+              tbat->jobs[ii].skip = g_file_test(tweenFilename, G_FILE_TEST_EXISTS);
+              g_free(tweenFilename);
+            }
+          }
+        }
+        p_tween_batch_start(tbat);
+      }
+
       /* loop to generate tween frames between currentFrameNr and nextFrameNr */
       for (l_current_step = 1; l_current_step <= tweenFramesToBeCreated; l_current_step++)
       {
@@ -3569,10 +5047,22 @@ p_morph_render_frame_tweens_in_subdir(GapAnimInfo *ainfo_ptr, GapMorphGlobalPara
 
         /* CALL of the morphing processor */
 
-        l_tween_layer_id = gap_morph_render_one_of_n_tweens(mgpp
-                                                           , tweenFramesToBeCreated +1
-                                                           , l_current_step
-                                                           );
+        if(tbat != NULL)
+        {
+          l_tween_layer_id = p_tween_batch_fetch_layer(tbat, l_current_step, mgpp, cancelFlagPtr);
+          if(l_tween_layer_id < 0)
+          {
+            success = FALSE;
+            break;
+          }
+        }
+        else
+        {
+          l_tween_layer_id = gap_morph_render_one_of_n_tweens(mgpp
+                                                             , tweenFramesToBeCreated +1
+                                                             , l_current_step
+                                                             );
+        }
         l_tween_tmp_image_id = gimp_drawable_get_image(l_tween_layer_id);
         if(gap_debug)
         {
@@ -3599,6 +5089,7 @@ p_morph_render_frame_tweens_in_subdir(GapAnimInfo *ainfo_ptr, GapMorphGlobalPara
 
       }
 
+      p_tween_batch_free(&tbat);
       g_free(workpointFileName);
       gap_image_delete_immediate(gimp_drawable_get_image(currLayerId));
       if(!success)
@@ -135,8 +135,18 @@ typedef struct GapMorphGlobalParams  { /* nickname: mgpp */
   gpointer                        callback_data_ptr;
 } GapMorphGlobalParams;
 
+/* spatial index for the workpoints of one wp_list (see p_create_wp_grid) */
+typedef struct GapMorphWpGrid  { /* nickname: wpgrid */
+  gint32              cell_size;     /* cell width and height in pixels */
+  gint32              cols;
+  gint32              rows;
+  gint32             *cell_start;    /* cols * rows +1 offsets into cell_wps */
+  GapMorphWorkPoint **cell_wps;      /* candidate workpoints per cell (in wp_list order) */
+} GapMorphWpGrid;
+
 typedef struct GapMorphWarpCoreAPI  { /* nickname: wcap */
   GapMorphWorkPoint *wp_list;
+  GapMorphWpGrid    *wp_grid;              /* NULL: check all points of wp_list per pixel */
   gboolean      use_quality_wp_selection;
   gboolean      use_gravity;
   gdouble       gravity_intensity;
@@ -0,0 +1,464 @@
+/* gap_morph_warp_bench.c
+ *
+ * GAP ... Gimp Animation Plugins
+ *
+ * equality check and benchmark for the workpoint grid index
+ * of p_pixel_warp_core (gap_morph_exec.c)
+ *
+ * Workpoint sets are generated (random positions and movement vectors
+ * with a fixed seed, every 7th point on integer koordinates to provoke direct hits).
+ * For each set every pixel of the area (including the 4 pixel border
+ * that p_pixel_warp_pick may access) is warped twice:
+ *   a) without grid (wcap.wp_grid == NULL), this is the original full scan
+ *      of the wp_list for each pixel
+ *   b) with the grid built by p_create_wp_grid
+ * The pick koordinates of both runs must be bit-identical.
+ *
+ * Then a generated source image is warped
+ *   c) serial by one p_warp_rect call for the whole area
+ *      (one workpoint list, pixel after pixel in row order)
+ *   d) in row bands by p_warp_band in 1 .. GAP_MORPH_WARP_MAX_THREADS threads
+ *      (the same band distribution as in p_layer_warp_move)
+ * The warped pixels must be identical for all thread counts
+ * (p_pixel_warp_core must not depend on the previously processed pixel).
+ *
+ * usage:
+ *   gap_morph_warp_bench               equality check on a 320x180 area (run by make check)
+ *   gap_morph_warp_bench -b [w h]      equality check and benchmark on a w x h area
+ *                                      (default 1280x720) for FAST and QUALITY strategy,
+ *                                      affect radius 30, 100, 250 and 10 .. 1000 workpoints
+ *                                      and the row band rendering times with 1 .. 16 threads
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * 2026.10.18  created
+ * 2026.10.18  check the row band rendering in parallel threads against the serial warp
+ */
+
+/* included (not linked) to access the static warp procedures */
+#include "gap_morph_exec.c"
+
+int gap_debug = 0;  /* 1 == print debug infos , 0 dont print debug infos */
+
+
+/* ---------------------------------
+ * p_generate_wp_list
+ * ---------------------------------
+ */
+static GapMorphWorkPoint *
+p_generate_wp_list(gint32 count, gint32 width, gint32 height, guint32 seed)
+{
+  GapMorphWorkPoint *wp_list;
+  GapMorphWorkPoint *wp;
+  GRand             *rand;
+  gint32             ii;
+
+  rand = g_rand_new_with_seed(seed);
+  wp_list = NULL;
+  for(ii = 0; ii < count; ii++)
+  {
+    wp = g_new0(GapMorphWorkPoint, 1);
+    wp->dst_x = g_rand_int_range(rand, 0, width * 10) / 10.0;
+    wp->dst_y = g_rand_int_range(rand, 0, height * 10) / 10.0;
+    if((ii % 7) == 0)
+    {
+      wp->dst_x = (gint32)wp->dst_x;
+      wp->dst_y = (gint32)wp->dst_y;
+    }
+    wp->src_x = wp->dst_x + g_rand_int_range(rand, -20, 21);
+    wp->src_y = wp->dst_y + g_rand_int_range(rand, -20, 21);
+    wp->fdst_x = wp->dst_x;
+    wp->fdst_y = wp->dst_y;
+    wp->osrc_x = wp->src_x;
+    wp->osrc_y = wp->src_y;
+    wp->next = wp_list;
+    wp_list = wp;
+  }
+  g_rand_free(rand);
+
+  return (wp_list);
+}  /* end p_generate_wp_list */
+
+
+/* ---------------------------------
+ * p_run_one_set
+ * ---------------------------------
+ * warp all pixels with and without grid.
+ * return the number of rows with differing pick koordinates.
+ */
+static gint32
+p_run_one_set(gint32 width, gint32 height, gboolean use_quality_wp_selection
+  , gdouble affect_radius, gint32 count, gboolean printTimes)
+{
+  GapMorphWarpCoreAPI  wcapList;
+  GapMorphWarpCoreAPI  wcapGrid;
+  GTimer              *timer;
+  gdouble             *pickList;
+  gdouble             *pickGrid;
+  gdouble              timeList;
+  gdouble              timeGrid;
+  gint32               diffRows;
+  gint32               xx;
+  gint32               yy;
+
+  memset(&wcapList, 0, sizeof(wcapList));
+  wcapList.wp_list = p_generate_wp_list(count, width, height, count + (guint32)affect_radius);
+  wcapList.wp_grid = NULL;
+  wcapList.use_quality_wp_selection = use_quality_wp_selection;
+  wcapList.use_gravity = TRUE;
+  wcapList.gravity_intensity = 2.0;
+  wcapList.affect_radius = affect_radius;
+  wcapList.sqr_affect_radius = affect_radius * affect_radius;
+  wcapList.scale_x = 1.0;
+  wcapList.scale_y = 1.0;
+  wcapList.printf_flag = FALSE;
+
+  /* separate copy of the same points (the warp core writes per pixel data into the workpoints) */
+  wcapGrid = wcapList;
+  wcapGrid.wp_list = p_generate_wp_list(count, width, height, count + (guint32)affect_radius);
+  wcapGrid.wp_grid = p_create_wp_grid(&wcapGrid, width, height);
+
+  pickList = g_new(gdouble, 2 * (width + 4));
+  pickGrid = g_new(gdouble, 2 * (width + 4));
+  timer = g_timer_new();
+  timeList = 0.0;
+  timeGrid = 0.0;
+  diffRows = 0;
+
+  for(yy = 0; yy < height + 4; yy++)
+  {
+    g_timer_start(timer);
+    for(xx = 0; xx < width + 4; xx++)
+    {
+      p_pixel_warp_core(&wcapList, xx, yy, &pickList[2 * xx], &pickList[(2 * xx) + 1]);
+    }
+    timeList += g_timer_elapsed(timer, NULL);
+
+    g_timer_start(timer);
+    for(xx = 0; xx < width + 4; xx++)
+    {
+      p_pixel_warp_core(&wcapGrid, xx, yy, &pickGrid[2 * xx], &pickGrid[(2 * xx) + 1]);
+    }
+    timeGrid += g_timer_elapsed(timer, NULL);
+
+    if(memcmp(pickList, pickGrid, 2 * (width + 4) * sizeof(gdouble)) != 0)
+    {
+      diffRows++;
+    }
+  }
+
+  if((printTimes) || (diffRows != 0))
+  {
+    printf("%-7s R=%3d n=%4d list:%9.1f ms grid:%9.1f ms %s\n"
+          , use_quality_wp_selection ? "QUALITY" : "FAST"
+          , (int)affect_radius
+          , (int)count
+          , timeList * 1000.0
+          , timeGrid * 1000.0
+          , (diffRows == 0) ? "identical" : "MISMATCH"
+          );
+  }
+
+  g_timer_destroy(timer);
+  g_free(pickList);
+  g_free(pickGrid);
+  p_free_wp_grid(&wcapGrid.wp_grid);
+  gap_morph_exec_free_workpoint_list(&wcapList.wp_list);
+  gap_morph_exec_free_workpoint_list(&wcapGrid.wp_list);
+
+  return (diffRows);
+}  /* end p_run_one_set */
+
+
+/* ---------------------------------
+ * p_band_worker
+ * ---------------------------------
+ * thread function, renders row bands until all bands are assigned
+ */
+static gpointer
+p_band_worker(gpointer data)
+{
+  GapMorphWarpThreadData *wtd;
+  gint32 bandIdx;
+
+  wtd = (GapMorphWarpThreadData *)data;
+  while((bandIdx = p_warp_get_next_band(wtd->wld)) >= 0)
+  {
+    p_warp_band(wtd, bandIdx);
+  }
+  return (NULL);
+}  /* end p_band_worker */
+
+
+/* ---------------------------------
+ * p_render_bands
+ * ---------------------------------
+ * render all row bands of wld with numThreads threads
+ * (the calling thread renders bands too).
+ * numThreads 0 renders the whole area serial by one p_warp_rect call.
+ * returns the elapsed time in seconds.
+ */
+static gdouble
+p_render_bands(GapMorphWarpLayerData *wld, GapMorphWarpCoreAPI *wcap, gint numThreads)
+{
+  GapMorphWarpThreadData  wtdArray[GAP_MORPH_WARP_MAX_THREADS];
+  GThread                *threads[GAP_MORPH_WARP_MAX_THREADS];
+  GapMorphWarpThreadData *wtd;
+  GTimer                 *timer;
+  gdouble                 elapsed;
+  gint                    ii;
+
+  memset(wtdArray, 0, sizeof(wtdArray));
+  for(ii = 0; ii < MAX(1, numThreads); ii++)
+  {
+    wtd = &wtdArray[ii];
+    wtd->wld = wld;
+    wtd->cpuId = ii;
+    wtd->master_list_1 = wcap->wp_list;
+    wtd->master_list_2 = NULL;
+    wtd->wcap_1 = *wcap;
+    wtd->wcap_1.wp_list = p_copy_workpoint_list(wcap->wp_list);
+    wtd->wcap_1.wp_grid = p_create_wp_grid(&wtd->wcap_1, wld->dst_width, wld->dst_height);
+    wtd->wcap_2 = wtd->wcap_1;
+    wtd->wcap_2.wp_list = NULL;
+    wtd->wcap_2.wp_grid = NULL;
+  }
+  wld->nextBand = 0;
+  memset(wld->dst_data, 0, wld->dst_width * wld->dst_height * wld->bpp);
+
+  timer = g_timer_new();
+  if(numThreads == 0)
+  {
+    p_warp_clear_pick_cache(&wtdArray[0]);
+    p_warp_rect(&wtdArray[0], 0, 0, wld->dst_width, wld->dst_height);
+  }
+  else
+  {
+    for(ii = 1; ii < numThreads; ii++)
+    {
+      threads[ii] = g_thread_create(p_band_worker, &wtdArray[ii], TRUE, NULL);
+    }
+    p_band_worker(&wtdArray[0]);
+    for(ii = 1; ii < numThreads; ii++)
+    {
+      if(threads[ii] != NULL)
+      {
+        g_thread_join(threads[ii]);
+      }
+    }
+  }
+  elapsed = g_timer_elapsed(timer, NULL);
+  g_timer_destroy(timer);
+
+  for(ii = 0; ii < MAX(1, numThreads); ii++)
+  {
+    p_free_wp_grid(&wtdArray[ii].wcap_1.wp_grid);
+    gap_morph_exec_free_workpoint_list(&wtdArray[ii].wcap_1.wp_list);
+  }
+
+  return (elapsed);
+}  /* end p_render_bands */
+
+
+/* ---------------------------------
+ * p_run_bands
+ * ---------------------------------
+ * warp a generated source image serial and in row bands
+ * with 1 .. GAP_MORPH_WARP_MAX_THREADS threads.
+ * return the number of thread counts with pixels that differ from the serial warp.
+ */
+static gint32
+p_run_bands(gint32 width, gint32 height, gboolean use_quality_wp_selection
+  , gdouble affect_radius, gint32 count, gboolean printTimes)
+{
+  static const gint       threadCounts[] = { 1, 2, 4, 8, 16 };
+  GapMorphWarpLayerData   wld_struct;
+  GapMorphWarpLayerData  *wld;
+  GapMorphWarpCoreAPI     wcap;
+  GRand                  *rand;
+  guchar                 *serialData;
+  gdouble                 elapsed;
+  gint32                  dataSize;
+  gint32                  diffCount;
+  gint32                  ii;
+  guint                   ti;
+
+  wld = &wld_struct;
+  memset(wld, 0, sizeof(GapMorphWarpLayerData));
+  wld->bpp = 4;
+  wld->src_width = width;
+  wld->src_height = height;
+  wld->dst_width = width;
+  wld->dst_height = height;
+  wld->have_workpointsets = FALSE;
+  wld->wp_mix_factor = 1.0;
+  wld->numBands = (height + (GAP_MORPH_WARP_BAND_HEIGHT -1)) / GAP_MORPH_WARP_BAND_HEIGHT;
+  wld->mutex = g_mutex_new();
+
+  dataSize = width * height * wld->bpp;
+  rand = g_rand_new_with_seed(4711);
+  wld->src_data = g_malloc(dataSize);
+  for(ii = 0; ii < dataSize; ii++)
+  {
+    ((guchar *)wld->src_data)[ii] = (guchar)((ii / wld->bpp) + g_rand_int_range(rand, 0, 64));
+  }
+  g_rand_free(rand);
+  wld->dst_data = g_malloc(dataSize);
+  serialData = g_malloc(dataSize);
+
+  memset(&wcap, 0, sizeof(wcap));
+  wcap.wp_list = p_generate_wp_list(count, width, height, count + (guint32)affect_radius);
+  wcap.use_quality_wp_selection = use_quality_wp_selection;
+  wcap.use_gravity = TRUE;
+  wcap.gravity_intensity = 2.0;
+  wcap.affect_radius = affect_radius;
+  wcap.sqr_affect_radius = affect_radius * affect_radius;
+  wcap.scale_x = 1.0;
+  wcap.scale_y = 1.0;
+  wcap.printf_flag = FALSE;
+
+  elapsed = p_render_bands(wld, &wcap, 0);
+  memcpy(serialData, wld->dst_data, dataSize);
+  if(printTimes)
+  {
+    printf("%-7s R=%3d n=%4d serial:%9.1f ms"
+          , use_quality_wp_selection ? "QUALITY" : "FAST"
+          , (int)affect_radius
+          , (int)count
+          , elapsed * 1000.0
+          );
+  }
+
+  diffCount = 0;
+  for(ti = 0; ti < G_N_ELEMENTS(threadCounts); ti++)
+  {
+    elapsed = p_render_bands(wld, &wcap, threadCounts[ti]);
+    if(memcmp(serialData, wld->dst_data, dataSize) != 0)
+    {
+      printf("%-7s R=%3d n=%4d threads:%2d warped pixels MISMATCH the serial warp\n"
+            , use_quality_wp_selection ? "QUALITY" : "FAST"
+            , (int)affect_radius
+            , (int)count
+            , (int)threadCounts[ti]
+            );
+      diffCount++;
+    }
+    if(printTimes)
+    {
+      printf("  %dT:%8.1f", (int)threadCounts[ti], elapsed * 1000.0);
+    }
+  }
+  if(printTimes)
+  {
+    printf(" ms\n");
+  }
+
+  gap_morph_exec_free_workpoint_list(&wcap.wp_list);
+  g_free((guchar *)wld->src_data);
+  g_free(wld->dst_data);
+  g_free(serialData);
+  g_mutex_free(wld->mutex);
+
+  return (diffCount);
+}  /* end p_run_bands */
+
+
+/* ---------------------------------
+ * main
+ * ---------------------------------
+ */
+int
+main(int argc, char *argv[])
+{
+  static const gint32  counts[] = { 10, 50, 100, 300, 1000 };
+  static const gdouble radii[] = { 30.0, 100.0, 250.0 };
+  gboolean  isBenchmark;
+  gint32    width;
+  gint32    height;
+  gint32    maxCount;
+  gint32    errors;
+  gint32    bandErrors;
+  guint     ci;
+  guint     ri;
+  gint      quality;
+
+  isBenchmark = FALSE;
+  width = 320;
+  height = 180;
+  maxCount = 300;
+  if((argc > 1) && (strcmp(argv[1], "-b") == 0))
+  {
+    isBenchmark = TRUE;
+    width = 1280;
+    height = 720;
+    maxCount = 1000;
+    if(argc > 3)
+    {
+      width = MAX(1, atoi(argv[2]));
+      height = MAX(1, atoi(argv[3]));
+    }
+  }
+
+  errors = 0;
+  for(quality = 0; quality < 2; quality++)
+  {
+    for(ri = 0; ri < G_N_ELEMENTS(radii); ri++)
+    {
+      for(ci = 0; ci < G_N_ELEMENTS(counts); ci++)
+      {
+        if(counts[ci] > maxCount)
+        {
+          continue;
+        }
+        errors += p_run_one_set(width, height, quality, radii[ri], counts[ci], isBenchmark);
+      }
+    }
+  }
+
+  printf("warp grid equality check %dx%d: %s (%d rows differ)\n"
+        , (int)width, (int)height
+        , (errors == 0) ? "OK" : "FAILED"
+        , (int)errors
+        );
+
+  if(gap_base_thread_init() != TRUE)
+  {
+    printf("warp band check: no thread support (skipped)\n");
+    return ((errors == 0) ? 0 : 1);
+  }
+
+  bandErrors = 0;
+  for(quality = 0; quality < 2; quality++)
+  {
+    for(ri = 0; ri < G_N_ELEMENTS(radii); ri++)
+    {
+      bandErrors += p_run_bands(width, height, quality, radii[ri], MIN(300, maxCount), isBenchmark);
+    }
+  }
+
+  printf("warp band check %dx%d: %s (%d thread counts differ)\n"
+        , (int)width, (int)height
+        , (bandErrors == 0) ? "OK" : "FAILED"
+        , (int)bandErrors
+        );
+
+  return (((errors + bandErrors) == 0) ? 0 : 1);
+
+}  /* end main */
@@ -23,6 +23,7 @@
  */
 
 /* revision history:
+ * version 2.7.0;   2026/10/18  added gap_player_cache_dup_cdata
  * version 2.2.1;   2006/05/22  hof: created
  */
 
@@ -95,6 +96,11 @@
 #include <libgimp/gimp.h>
 #include <libgimp/gimpui.h>
 
+/* JPEGlib includes */
+#include <setjmp.h>
+#include "jpeglib.h"
+#include "jerror.h"
+
 #include "gap_libgapbase.h"
 #include "gap_player_main.h"
 #include "gap_player_dialog.h"
@@ -120,6 +126,7 @@ typedef struct GapPlayerCacheAdmin {  /* nick: admin_ptr */
   GapPlayerCacheElem               *end_elem;     /* last list elem (access long ago) */
   gint32                           summary_bytesize;
   gint32                           configured_max_bytesize;
+  gint32                           configured_jpeg_quality;
   GHashTable                      *pcache_elemref_hash;
   } GapPlayerCacheAdmin;
 
@@ -163,6 +170,7 @@ p_get_admin_ptr(void)
     admin_ptr->end_elem = NULL;
     admin_ptr->summary_bytesize = 0;
     admin_ptr->configured_max_bytesize = GAP_PLAYER_CACHE_DEFAULT_MAX_BYTESIZE;
+    admin_ptr->configured_jpeg_quality = GAP_PLAYER_CACHE_DEFAULT_JPEG_QUALITY;
 
     /* use NULL to skip destructor for the ckey
      * because the ckey is also part of the value
@@ -252,6 +260,310 @@ p_debug_printf_cache_list(GapPlayerCacheAdmin *admin_ptr)
 }  /* end p_debug_printf_cache_list */
 
 
+/* *************************************************
+   ***    JPEG memory compression for cache data ***
+   *************************************************
+   The cached frames are compressed/decompressed in memory
+   via libjpeg source and destination managers.
+   These procedures use no global data and are reentrant,
+   (gap_player_cache_decompress may run in a worker thread)
+ */
+
+typedef struct GapPlayerCacheJpegErrorMgr {
+  struct jpeg_error_mgr    pub;          /* public fields */
+  jmp_buf                  setjmp_buffer;
+  } GapPlayerCacheJpegErrorMgr;
+
+typedef struct GapPlayerCacheJpegDestMgr {
+  struct jpeg_destination_mgr pub;       /* public fields */
+  guchar                  *buffer;       /* the growing output buffer */
+  size_t                   buffer_size;
+  } GapPlayerCacheJpegDestMgr;
+
+
+/* ------------------------------
+ * p_jpeg_error_exit
+ * ------------------------------
+ * replaces the libjpeg standard error_exit method (that terminates the process)
+ * and returns control to the setjmp point of the caller.
+ */
+static void
+p_jpeg_error_exit(j_common_ptr cinfo)
+{
+  GapPlayerCacheJpegErrorMgr *err;
+
+  err = (GapPlayerCacheJpegErrorMgr *) cinfo->err;
+  if(gap_debug)
+  {
+    (*cinfo->err->output_message) (cinfo);
+  }
+  longjmp(err->setjmp_buffer, 1);
+}  /* end p_jpeg_error_exit */
+
+/* ------------------------------
+ * p_jpeg_output_message
+ * ------------------------------
+ */
+static void
+p_jpeg_output_message(j_common_ptr cinfo)
+{
+  if(gap_debug)
+  {
+    char buffer[JMSG_LENGTH_MAX];
+
+    (*cinfo->err->format_message) (cinfo, buffer);
+    printf("gap_player_cache JPEG: %s\n", buffer);
+  }
+}  /* end p_jpeg_output_message */
+
+/* ------------------------------
+ * p_jpeg_init_destination
+ * ------------------------------
+ */
+static void
+p_jpeg_init_destination(j_compress_ptr cinfo)
+{
+  GapPlayerCacheJpegDestMgr *dest;
+
+  dest = (GapPlayerCacheJpegDestMgr *) cinfo->dest;
+  dest->pub.next_output_byte = dest->buffer;
+  dest->pub.free_in_buffer = dest->buffer_size;
+}  /* end p_jpeg_init_destination */
+
+/* ------------------------------
+ * p_jpeg_empty_output_buffer
+ * ------------------------------
+ * the output buffer is full: double its size
+ */
+static boolean
+p_jpeg_empty_output_buffer(j_compress_ptr cinfo)
+{
+  GapPlayerCacheJpegDestMgr *dest;
+  size_t                     old_size;
+
+  dest = (GapPlayerCacheJpegDestMgr *) cinfo->dest;
+  old_size = dest->buffer_size;
+  dest->buffer_size = 2 * old_size;
+  dest->buffer = g_realloc(dest->buffer, dest->buffer_size);
+  dest->pub.next_output_byte = dest->buffer + old_size;
+  dest->pub.free_in_buffer = dest->buffer_size - old_size;
+
+  return (TRUE);
+}  /* end p_jpeg_empty_output_buffer */
+
+/* ------------------------------
+ * p_jpeg_term_destination
+ * ------------------------------
+ */
+static void
+p_jpeg_term_destination(j_compress_ptr cinfo)
+{
+  /* nothing to do, the caller picks the used size from free_in_buffer */
+}  /* end p_jpeg_term_destination */
+
+/* ------------------------------
+ * p_jpeg_init_source
+ * ------------------------------
+ */
+static void
+p_jpeg_init_source(j_decompress_ptr cinfo)
+{
+  /* nothing to do, the complete jpeg data is already in memory */
+}  /* end p_jpeg_init_source */
+
+/* ------------------------------
+ * p_jpeg_fill_input_buffer
+ * ------------------------------
+ * called when the decompressor wants more data than available
+ * (this happens only for corrupted data). Insert a fake EOI marker.
+ */
+static boolean
+p_jpeg_fill_input_buffer(j_decompress_ptr cinfo)
+{
+  static const JOCTET eoi_buffer[2] = { (JOCTET) 0xFF, (JOCTET) JPEG_EOI };
+
+  WARNMS(cinfo, JWRN_JPEG_EOF);
+  cinfo->src->next_input_byte = eoi_buffer;
+  cinfo->src->bytes_in_buffer = 2;
+
+  return (TRUE);
+}  /* end p_jpeg_fill_input_buffer */
+
+/* ------------------------------
+ * p_jpeg_skip_input_data
+ * ------------------------------
+ */
+static void
+p_jpeg_skip_input_data(j_decompress_ptr cinfo, long num_bytes)
+{
+  if (num_bytes <= 0)
+  {
+    return;
+  }
+  if ((size_t) num_bytes > cinfo->src->bytes_in_buffer)
+  {
+    p_jpeg_fill_input_buffer(cinfo);
+    return;
+  }
+  cinfo->src->next_input_byte += (size_t) num_bytes;
+  cinfo->src->bytes_in_buffer -= (size_t) num_bytes;
+}  /* end p_jpeg_skip_input_data */
+
+/* ------------------------------
+ * p_jpeg_term_source
+ * ------------------------------
+ */
+static void
+p_jpeg_term_source(j_decompress_ptr cinfo)
+{
+}  /* end p_jpeg_term_source */
+
+
+/* ------------------------------
+ * p_jpeg_compress
+ * ------------------------------
+ * compress the th_data (RGB or GRAY pixels) to a newly allocated JPEG buffer.
+ * return the JPEG buffer (and its size in jpeg_size_ptr)
+ * or NULL in case th_data can not be compressed
+ */
+static guchar*
+p_jpeg_compress(const guchar *th_data
+               , gint32 th_width
+               , gint32 th_height
+               , gint32 th_bpp
+               , gint32 jpeg_quality
+               , gint32 *jpeg_size_ptr)
+{
+  struct jpeg_compress_struct  cinfo;
+  GapPlayerCacheJpegErrorMgr   jerr;
+  GapPlayerCacheJpegDestMgr    dest;
+  JSAMPROW                     row_pointer[1];
+  gint32                       rowstride;
+
+  if ((th_bpp != 3) && (th_bpp != 1))
+  {
+    return (NULL);
+  }
+
+  rowstride = th_width * th_bpp;
+
+  /* start with an output buffer of 1/4 of the uncompressed size */
+  dest.buffer_size = MAX(4096, (rowstride * th_height) / 4);
+  dest.buffer = g_malloc(dest.buffer_size);
+
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = p_jpeg_error_exit;
+  jerr.pub.output_message = p_jpeg_output_message;
+  if (setjmp(jerr.setjmp_buffer))
+  {
+    jpeg_destroy_compress(&cinfo);
+    g_free(dest.buffer);
+    return (NULL);
+  }
+
+  jpeg_create_compress(&cinfo);
+  dest.pub.init_destination = p_jpeg_init_destination;
+  dest.pub.empty_output_buffer = p_jpeg_empty_output_buffer;
+  dest.pub.term_destination = p_jpeg_term_destination;
+  cinfo.dest = &dest.pub;
+
+  cinfo.image_width = th_width;
+  cinfo.image_height = th_height;
+  cinfo.input_components = th_bpp;
+  cinfo.in_color_space = (th_bpp == 3) ? JCS_RGB : JCS_GRAYSCALE;
+  jpeg_set_defaults(&cinfo);
+  jpeg_set_quality(&cinfo, CLAMP(jpeg_quality, 1, 100), TRUE);
+  cinfo.dct_method = JDCT_IFAST;
+
+  jpeg_start_compress(&cinfo, TRUE);
+  while (cinfo.next_scanline < cinfo.image_height)
+  {
+    row_pointer[0] = (JSAMPROW) &th_data[cinfo.next_scanline * rowstride];
+    jpeg_write_scanlines(&cinfo, row_pointer, 1);
+  }
+  jpeg_finish_compress(&cinfo);
+
+  *jpeg_size_ptr = dest.buffer_size - dest.pub.free_in_buffer;
+  jpeg_destroy_compress(&cinfo);
+
+  /* shrink the buffer to the used size */
+  return (g_realloc(dest.buffer, *jpeg_size_ptr));
+
+}  /* end p_jpeg_compress */
+
+
+/* ------------------------------
+ * p_jpeg_decompress
+ * ------------------------------
+ * decompress the JPEG data to a newly allocated buffer
+ * of th_width * th_height * th_bpp bytes.
+ * return NULL if the JPEG data does not match the expected size or is corrupted.
+ */
+static guchar*
+p_jpeg_decompress(const guchar *jpeg_data
+               , gint32 jpeg_size
+               , gint32 th_width
+               , gint32 th_height
+               , gint32 th_bpp)
+{
+  struct jpeg_decompress_struct  cinfo;
+  GapPlayerCacheJpegErrorMgr     jerr;
+  struct jpeg_source_mgr         src;
+  JSAMPROW                       row_pointer[1];
+  gint32                         rowstride;
+  guchar                        *th_data;
+
+  rowstride = th_width * th_bpp;
+  th_data = g_new ( guchar, rowstride * th_height );
+
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = p_jpeg_error_exit;
+  jerr.pub.output_message = p_jpeg_output_message;
+  if (setjmp(jerr.setjmp_buffer))
+  {
+    jpeg_destroy_decompress(&cinfo);
+    g_free(th_data);
+    return (NULL);
+  }
+
+  jpeg_create_decompress(&cinfo);
+  src.init_source = p_jpeg_init_source;
+  src.fill_input_buffer = p_jpeg_fill_input_buffer;
+  src.skip_input_data = p_jpeg_skip_input_data;
+  src.resync_to_restart = jpeg_resync_to_restart;  /* use libjpeg default method */
+  src.term_source = p_jpeg_term_source;
+  src.next_input_byte = (const JOCTET *) jpeg_data;
+  src.bytes_in_buffer = jpeg_size;
+  cinfo.src = &src;
+
+  jpeg_read_header(&cinfo, TRUE);
+  cinfo.out_color_space = (th_bpp == 3) ? JCS_RGB : JCS_GRAYSCALE;
+  cinfo.dct_method = JDCT_IFAST;
+  cinfo.do_fancy_upsampling = FALSE;
+  jpeg_start_decompress(&cinfo);
+
+  if ((cinfo.output_width != th_width)
+  ||  (cinfo.output_height != th_height)
+  ||  (cinfo.output_components != th_bpp))
+  {
+    jpeg_destroy_decompress(&cinfo);
+    g_free(th_data);
+    return (NULL);
+  }
+
+  while (cinfo.output_scanline < cinfo.output_height)
+  {
+    row_pointer[0] = (JSAMPROW) &th_data[cinfo.output_scanline * rowstride];
+    jpeg_read_scanlines(&cinfo, row_pointer, 1);
+  }
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+
+  return (th_data);
+
+}  /* end p_jpeg_decompress */
+
+
 /* ---------------------------------
  * gap_player_cache_set_max_bytesize
  * ---------------------------------
@@ -422,6 +734,52 @@ gap_player_cache_set_gimprc_bytesize(gint32 bytesize)
 }  /* end gap_player_cache_set_gimprc_bytesize */
 
 
+/* ------------------------------------------
+ * gap_player_cache_get_gimprc_compression
+ * ------------------------------------------
+ * get the compression for cached frames from the gimprc
+ * parameter video_playback_cache_compression ("jpeg" or "none").
+ * The default is JPEG compression.
+ */
+GapPlayerCacheCompressionType
+gap_player_cache_get_gimprc_compression(void)
+{
+  GapPlayerCacheCompressionType compression;
+  gchar *value_string;
+
+  compression = GAP_PLAYER_CACHE_COMPRESSION_JPEG;
+  value_string = gimp_gimprc_query("video_playback_cache_compression");
+  if(value_string)
+  {
+    if (g_ascii_strncasecmp(value_string, "none", strlen("none")) == 0)
+    {
+      compression = GAP_PLAYER_CACHE_COMPRESSION_NONE;
+    }
+    g_free(value_string);
+  }
+
+  return (compression);
+
+}  /* end gap_player_cache_get_gimprc_compression */
+
+
+/* ------------------------------------
+ * gap_player_cache_set_jpeg_quality
+ * ------------------------------------
+ * set the quality (1 upto 100) for frames that are inserted
+ * with GAP_PLAYER_CACHE_COMPRESSION_JPEG.
+ */
+void
+gap_player_cache_set_jpeg_quality(gint32 jpeg_quality)
+{
+  GapPlayerCacheAdmin *admin_ptr;
+
+  admin_ptr = p_get_admin_ptr();
+  admin_ptr->configured_jpeg_quality = CLAMP(jpeg_quality, 1, 100);
+
+}  /* end gap_player_cache_set_jpeg_quality */
+
+
 
 /* ------------------------------
  * p_get_elem_size
@@ -821,6 +1179,9 @@ gap_player_cache_insert(const gchar *ckey
  * return the decompressed RGB buffer (th_data)
  * (for uncompressed frames this is just a copy of the chaced data)
  * The caller is responsible to g_free the returned data after use.
+ * This procedure does not access the cache list and can be called from
+ * a worker thread, as long as the cdata is not removed from the cache
+ * (by the main thread) while decompressing.
  */
 guchar*
 gap_player_cache_decompress(GapPlayerCacheData *cdata)
@@ -841,9 +1202,18 @@ gap_player_cache_decompress(GapPlayerCacheData *cdata)
         );
     }
   }
-  else
+  else if (cdata->compression == GAP_PLAYER_CACHE_COMPRESSION_JPEG)
   {
-    printf("** ERROR: player chache compression not implemented yet.\n");
+    th_data = p_jpeg_decompress(cdata->th_data
+                               , cdata->th_data_size
+                               , cdata->th_width
+                               , cdata->th_height
+                               , cdata->th_bpp
+                               );
+    if(th_data == NULL)
+    {
+      printf("** ERROR: gap_player_cache_decompress: corrupted JPEG data in player cache\n");
+    }
   }
 
   return (th_data);
@@ -857,9 +1227,11 @@ gap_player_cache_decompress(GapPlayerCacheData *cdata)
  * create and set up a new player chache data stucture.
  * NOTE: The th_data is NOT copied but used as 1:1 reference
  *       in case no compression is done.
- * comression (not implemented yet) will create
- * a compressed copy of th_data (that is put into the newly created
- * GapPlayerCacheData structure, and g_free th_data after the compression.
+ * JPEG compression creates a compressed copy of th_data
+ * (that is put into the newly created GapPlayerCacheData structure),
+ * and does g_free th_data after the compression.
+ * Frames that can not be JPEG compressed (e.g. with alpha channel)
+ * are cached uncompressed.
  */
 GapPlayerCacheData*
 gap_player_cache_new_data(guchar *th_data
@@ -880,16 +1252,41 @@ gap_player_cache_new_data(guchar *th_data
   cdata->th_height = th_height;
   cdata->th_bpp = th_bpp;
   cdata->flip_status = flip_status;
-  if (compression == GAP_PLAYER_CACHE_COMPRESSION_NONE)
+  cdata->th_data = th_data;
+  if ((compression == GAP_PLAYER_CACHE_COMPRESSION_JPEG)
+  &&  (th_size == th_width * th_height * th_bpp))
   {
-    cdata->th_data = th_data;
-
+    guchar *jpeg_data;
+    gint32  jpeg_size;
+
+    jpeg_data = p_jpeg_compress(th_data
+                               , th_width
+                               , th_height
+                               , th_bpp
+                               , p_get_admin_ptr()->configured_jpeg_quality
+                               , &jpeg_size
+                               );
+    if (jpeg_data != NULL)
+    {
+      if(gap_debug)
+      {
+        printf("gap_player_cache_new_data: JPEG compressed size:%d (uncompressed:%d)\n"
+          , (int)jpeg_size
+          , (int)th_size
+          );
+      }
+      g_free(th_data);
+      cdata->th_data = jpeg_data;
+      cdata->th_data_size = jpeg_size;
+    }
+    else
+    {
+      cdata->compression = GAP_PLAYER_CACHE_COMPRESSION_NONE;
+    }
   }
   else
   {
-    printf("** ERROR: player chache compression not implemented yet.\n");
     cdata->compression = GAP_PLAYER_CACHE_COMPRESSION_NONE;
-    cdata->th_data = th_data;
   }
 
   return (cdata);
@@ -897,6 +1294,31 @@ gap_player_cache_new_data(guchar *th_data
 
 
 
+/* ------------------------------
+ * gap_player_cache_dup_cdata
+ * ------------------------------
+ * create a private copy of the specified player cache data
+ * (the (compressed) data is copied as it is).
+ * The copy can be decompressed in a worker thread
+ * independent of the cache list (see gap_player_readahead_offer_cached).
+ */
+GapPlayerCacheData*
+gap_player_cache_dup_cdata(GapPlayerCacheData *cdata)
+{
+  GapPlayerCacheData* dup_cdata;
+
+  if(cdata == NULL)
+  {
+    return (NULL);
+  }
+  dup_cdata = g_new ( GapPlayerCacheData, 1 );
+  *dup_cdata = *cdata;
+  dup_cdata->th_data = g_memdup(cdata->th_data, cdata->th_data_size);
+
+  return (dup_cdata);
+}  /* end gap_player_cache_dup_cdata */
+
+
 /* ------------------------------
  * gap_player_cache_free_cdata
  * ------------------------------
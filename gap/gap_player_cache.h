@@ -29,6 +29,7 @@
 
 #define GAP_PLAYER_CACHE_FRAME_SZIE (3 * 400 * 320)
 #define GAP_PLAYER_CACHE_DEFAULT_MAX_BYTESIZE  (200 * GAP_PLAYER_CACHE_FRAME_SZIE) 
+#define GAP_PLAYER_CACHE_DEFAULT_JPEG_QUALITY  86
 
 #include "libgimp/gimp.h"
 #include "gap_lib.h"
@@ -70,11 +71,14 @@ gint32               gap_player_cache_get_current_frames_cached(void);
 gint32               gap_player_cache_get_gimprc_bytesize(void);
 
 void                 gap_player_cache_set_gimprc_bytesize(gint32 bytesize);
+GapPlayerCacheCompressionType gap_player_cache_get_gimprc_compression(void);
+void                 gap_player_cache_set_jpeg_quality(gint32 jpeg_quality);
 void                 gap_player_cache_set_max_bytesize(gint32 max_bytesize);
 GapPlayerCacheData*  gap_player_cache_lookup(const gchar *ckey);
 void                 gap_player_cache_insert(const gchar *ckey
                         , GapPlayerCacheData *data);
 guchar*              gap_player_cache_decompress(GapPlayerCacheData *cdata);
+GapPlayerCacheData*  gap_player_cache_dup_cdata(GapPlayerCacheData *cdata);
 
 GapPlayerCacheData*  gap_player_cache_new_data(guchar *th_data
                          , gint32 th_size
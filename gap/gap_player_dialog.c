@@ -374,6 +374,14 @@ static guchar * p_fetch_videoframe_via_cache(GapPlayerMainGlobalParams *gpp
 static void     p_frame_chache_processing(GapPlayerMainGlobalParams *gpp
                    , const gchar *ckey);
 static void     p_update_cache_status (GapPlayerMainGlobalParams *gpp);
+static void     p_readahead_stop(GapPlayerMainGlobalParams *gpp);
+static void     p_readahead_update(GapPlayerMainGlobalParams *gpp, gint32 framenr);
+static gboolean p_readahead_frame_must_be_dropped(GapPlayerMainGlobalParams *gpp, gint32 framenr);
+static gint32   p_calculate_next_framenr(GapPlayerMainGlobalParams *gpp
+                   , gint32 framenr
+                   , gboolean *backward_ptr
+                   , gint32 *pingpong_count_ptr
+                   , gboolean *wrapped_ptr);
 
 static void     p_audio_startup_server(GapPlayerMainGlobalParams *gpp);
 static gint32       p_get_audio_relevant_FrameNr(GapPlayerMainGlobalParams *gpp, gint32 framenr);
@@ -2267,6 +2275,27 @@ p_start_playback_timer(GapPlayerMainGlobalParams *gpp)
 }  /* end p_start_playback_timer */
 
 
+/* -----------------------------
+ * p_get_statistics_source_name
+ * -----------------------------
+ * the name of the played storyboard, videofile or frame
+ * (for identification of the playback statistics)
+ */
+static const char *
+p_get_statistics_source_name(GapPlayerMainGlobalParams *gpp)
+{
+  if(gpp->stb_ptr != NULL)
+  {
+    return (gpp->stb_ptr->storyboardfile);
+  }
+  if(gpp->ainfo_ptr != NULL)
+  {
+    return (gpp->ainfo_ptr->old_filename);
+  }
+  return (gpp->imagename);
+}  /* end p_get_statistics_source_name */
+
+
 /* -----------------------------
  * p_initial_start_playback_timer
  * -----------------------------
@@ -2281,9 +2310,21 @@ p_initial_start_playback_timer(GapPlayerMainGlobalParams *gpp)
   gpp->delay_secs = 0.0;            /* absolute delay (for display) */
   gpp->framecnt = 0.0;
   gpp->go_job_framenr = -1;         /* pending timer_go_job gets useless, since we start playback now  */
+  gpp->readahead_consecutive_drops = 0;
 
   gtk_label_set_text ( GTK_LABEL(gpp->status_label), _("Playing"));
 
+  if(gpp->stat_ptr == NULL)
+  {
+    gpp->stat_ptr = gap_player_stat_new();
+  }
+  gap_player_stat_start(gpp->stat_ptr
+     , p_get_statistics_source_name(gpp)
+     , gpp->speed
+     , gpp->pv_ptr->pv_width
+     , gpp->pv_ptr->pv_height
+     );
+
   g_timer_start(gpp->gtimer);  /* (re)start timer at start of playback (== reset to 0) */
   p_start_playback_timer(gpp);
   p_audio_start_play(gpp);
@@ -2320,6 +2361,12 @@ p_stop_playback(GapPlayerMainGlobalParams *gpp)
   gpp->request_cancel_video_api = TRUE;
   gpp->play_is_active = FALSE;
   gpp->pingpong_count = 0;
+  p_readahead_stop(gpp);
+
+  if(gap_player_stat_stop(gpp->stat_ptr, gpp->speed))
+  {
+    gap_player_stat_report(gpp->stat_ptr);
+  }
 
   gtk_label_set_text ( GTK_LABEL(gpp->status_label), _("Ready"));
 
@@ -2991,6 +3038,7 @@ p_fetch_videoframe(GapPlayerMainGlobalParams *gpp
      gdouble l_threshold;
      gboolean do_scale;
      gint32 fcache_size;
+     gdouble l_start_secs;
 
      if(gpp->progress_bar)
      {
@@ -3038,6 +3086,7 @@ p_fetch_videoframe(GapPlayerMainGlobalParams *gpp
      gpp->cancel_video_api = FALSE;
      gpp->request_cancel_video_api = FALSE;
 
+     l_start_secs = gap_player_stat_now(gpp->stat_ptr);
 //printf(" VIDFETCH (6) current_seek_nr:%d current_frame_nr:%d\n", (int)gpp->gvahand->current_seek_nr  ,(int)gpp->gvahand->current_frame_nr );
      /* fetch the wanted framenr  */
      th_data = GVA_fetch_frame_to_buffer(gpp->gvahand
@@ -3050,6 +3099,7 @@ p_fetch_videoframe(GapPlayerMainGlobalParams *gpp
                 , th_width
                 , th_height
                 );
+     gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_DECODE, l_start_secs);
 //printf(" VIDFETCH (7) current_seek_nr:%d current_frame_nr:%d\n", (int)gpp->gvahand->current_seek_nr  ,(int)gpp->gvahand->current_frame_nr );
      if(gpp->progress_bar)
      {
@@ -3157,6 +3207,16 @@ p_init_video_playback_cache(GapPlayerMainGlobalParams *gpp)
 {
   gpp->max_player_cache = gap_player_cache_get_gimprc_bytesize();
   gap_player_cache_set_max_bytesize(gpp->max_player_cache);
+
+  gpp->cache_compression = gap_player_cache_get_gimprc_compression();
+  gpp->cache_jpeg_quality = (gdouble)gap_base_get_gimprc_int_value("video_playback_cache_jpeg_quality"
+                                 , GAP_PLAYER_CACHE_DEFAULT_JPEG_QUALITY
+                                 , 1
+                                 , 100
+                                 ) / 100.0;
+  gap_player_cache_set_jpeg_quality((gint32)(gpp->cache_jpeg_quality * 100.0 + 0.5));
+
+  gpp->readahead_max_frames = gap_player_readahead_get_gimprc_max_frames();
 }  /* end p_init_video_playback_cache */
 
 /* -----------------------------
@@ -3243,9 +3303,11 @@ p_fetch_frame_via_cache(GapPlayerMainGlobalParams *gpp
 {
   GapPlayerCacheData* cdata;
   guchar *th_data;
+  gdouble l_start_secs;
 
   cdata = NULL;
   th_data = NULL;
+  l_start_secs = gap_player_stat_now(gpp->stat_ptr);
 
   if (gpp->mtrace_mode == GAP_PLAYER_MTRACE_OFF)
   {
@@ -3258,6 +3320,7 @@ p_fetch_frame_via_cache(GapPlayerMainGlobalParams *gpp
     *th_width_ptr   = cdata->th_width;
     *th_height_ptr  = cdata->th_height;
     *flip_status_ptr = cdata->flip_status;
+    gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_FETCH, l_start_secs);
   }
 
   return (th_data);
@@ -3381,6 +3444,266 @@ p_frame_chache_processing(GapPlayerMainGlobalParams *gpp
 }  /* end p_frame_chache_processing */
 
 
+/* ------------------------------
+ * p_readahead_stop
+ * ------------------------------
+ * stop the background read-ahead decoder thread (if there is one)
+ * and free the frames it has decoded in advance.
+ */
+static void
+p_readahead_stop(GapPlayerMainGlobalParams *gpp)
+{
+  if(gpp->readahead_ptr != NULL)
+  {
+    gap_player_readahead_free(gpp->readahead_ptr);
+    gpp->readahead_ptr = NULL;
+  }
+}  /* end p_readahead_stop */
+
+
+/* ------------------------------
+ * p_readahead_get_request_size
+ * ------------------------------
+ * the read-ahead decodes frames at the same size as p_display_frame
+ * (current preview size, or -1 for original videosize if thumbnails are not used)
+ */
+static void
+p_readahead_get_request_size(GapPlayerMainGlobalParams *gpp
+  , gint32 *req_width_ptr, gint32 *req_height_ptr)
+{
+  if(gpp->use_thumbnails)
+  {
+    *req_width_ptr = gpp->pv_ptr->pv_width;
+    *req_height_ptr = gpp->pv_ptr->pv_height;
+  }
+  else
+  {
+    *req_width_ptr = -1;
+    *req_height_ptr = -1;
+  }
+}  /* end p_readahead_get_request_size */
+
+
+/* ------------------------------
+ * p_readahead_update
+ * ------------------------------
+ * called by the playback timer for each frame it handles (display or drop).
+ * starts the read-ahead decoder thread on demand
+ * and tells it framenr and the frames that follow in the playback sequence.
+ * wanted frames that are JPEG compressed in the player cache are offered
+ * to the read-ahead thread (as copy of the compressed data) for decompression,
+ * so that p_display_frame picks them up ready to render.
+ *
+ * Read-ahead is done only for playback of a single videoclip.
+ * (image frames and storyboards are fetched via GIMP PDB calls
+ * that must run in the main thread)
+ */
+static void
+p_readahead_update(GapPlayerMainGlobalParams *gpp, gint32 framenr)
+{
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+  gint32   *l_wanted;
+  gint32    l_count;
+  gint32    l_framenr;
+  gint32    l_pingpong_count;
+  gint32    l_req_width;
+  gint32    l_req_height;
+  gboolean  l_backward;
+  gboolean  l_wrapped;
+  gboolean  l_isBackwards;
+
+  if((gpp->readahead_max_frames < 1)
+  || (!gpp->play_is_active)
+  || (gpp->stb_ptr != NULL)
+  || (gpp->ainfo_ptr == NULL)
+  || (gpp->ainfo_ptr->ainfo_type != GAP_AINFO_MOVIE)
+  || (gpp->mtrace_mode != GAP_PLAYER_MTRACE_OFF))
+  {
+    p_readahead_stop(gpp);
+    return;
+  }
+
+  if((gpp->readahead_ptr != NULL)
+  && (!gap_player_readahead_is_for_video(gpp->readahead_ptr
+                , gpp->ainfo_ptr->old_filename
+                , gpp->ainfo_ptr->seltrack
+                , gpp->ainfo_ptr->delace
+                , gpp->preferred_decoder
+                )))
+  {
+    p_readahead_stop(gpp);
+  }
+
+  if(gpp->readahead_ptr == NULL)
+  {
+    gint32 l_fcache_size;
+
+    l_fcache_size = gap_base_get_gimprc_int_value("video-max-frames-keep-cached"
+                                   , GAP_PLAYER_VID_FRAMES_TO_KEEP_CACHED  /* default */
+                                   , 2   /* min */
+                                   , 250 /* max */
+                                   );
+    gpp->readahead_ptr = gap_player_readahead_new(gpp->ainfo_ptr->old_filename
+                                   , gpp->ainfo_ptr->seltrack
+                                   , gpp->ainfo_ptr->delace
+                                   , gpp->preferred_decoder
+                                   , gpp->readahead_max_frames
+                                   , l_fcache_size
+                                   );
+    if(gpp->readahead_ptr == NULL)
+    {
+      /* no thread support, turn read-ahead OFF */
+      gpp->readahead_max_frames = 0;
+      return;
+    }
+    gpp->readahead_consecutive_drops = 0;
+  }
+
+  /* the wanted list starts with framenr itself (displayed next)
+   * followed by the frames in playback sequence
+   */
+  l_wanted = g_new(gint32, gpp->readahead_max_frames);
+  l_framenr = framenr;
+  l_backward = gpp->play_backward;
+  l_pingpong_count = gpp->pingpong_count;
+  for(l_count = 0; l_count < gpp->readahead_max_frames; l_count++)
+  {
+    if(l_count > 0)
+    {
+      l_framenr = p_calculate_next_framenr(gpp
+                    , l_framenr
+                    , &l_backward
+                    , &l_pingpong_count
+                    , &l_wrapped
+                    );
+      if(l_framenr < 0)
+      {
+        break;
+      }
+    }
+    l_wanted[l_count] = l_framenr;
+  }
+
+  p_readahead_get_request_size(gpp, &l_req_width, &l_req_height);
+  l_isBackwards = (gpp->ainfo_ptr->last_frame_nr < gpp->ainfo_ptr->first_frame_nr) || gpp->play_backward;
+  gap_player_readahead_set_wanted(gpp->readahead_ptr
+                    , l_wanted
+                    , l_count
+                    , l_req_width
+                    , l_req_height
+                    , l_isBackwards
+                    );
+
+  if (gpp->max_player_cache > 0)
+  {
+    gint32 l_idx;
+
+    for(l_idx = 0; l_idx < l_count; l_idx++)
+    {
+      GapPlayerCacheData *l_cdata;
+      gchar              *l_ckey;
+
+      if(!gap_player_readahead_wants_cached(gpp->readahead_ptr
+                 , l_wanted[l_idx]
+                 , l_req_width
+                 , l_req_height
+                 ))
+      {
+        continue;
+      }
+      l_ckey = gap_player_cache_new_movie_key(gpp->ainfo_ptr->old_filename
+                         , l_wanted[l_idx]
+                         , gpp->ainfo_ptr->seltrack
+                         , gpp->ainfo_ptr->delace
+                         );
+      l_cdata = gap_player_cache_lookup(l_ckey);
+      g_free(l_ckey);
+      if((l_cdata != NULL)
+      && (l_cdata->compression != GAP_PLAYER_CACHE_COMPRESSION_NONE))
+      {
+        /* uncompressed frames are copied by p_display_frame at the same cost */
+        gap_player_readahead_offer_cached(gpp->readahead_ptr
+                 , l_wanted[l_idx]
+                 , l_req_width
+                 , l_req_height
+                 , gap_player_cache_dup_cdata(l_cdata)
+                 );
+      }
+    }
+  }
+  g_free(l_wanted);
+#endif
+}  /* end p_readahead_update */
+
+
+/* -----------------------------------
+ * p_readahead_frame_must_be_dropped
+ * -----------------------------------
+ * check if framenr shall be dropped because neither the player cache
+ * nor the read-ahead can deliver it right now.
+ * This check runs in the playback timer callback and never waits
+ * for the read-ahead thread (the player cache is checked first).
+ * Frames are dropped only in exact timing mode, and not more than
+ * readahead_max_frames in sequence. Then one frame is decoded synchron
+ * (by p_display_frame) to keep the display going in case
+ * decoding is slower than the playback speed.
+ */
+static gboolean
+p_readahead_frame_must_be_dropped(GapPlayerMainGlobalParams *gpp, gint32 framenr)
+{
+  gint32  l_req_width;
+  gint32  l_req_height;
+
+  if(gpp->readahead_ptr == NULL)
+  {
+    return (FALSE);
+  }
+
+  if (gpp->max_player_cache > 0)
+  {
+    gchar   *l_ckey;
+    gboolean l_isCached;
+
+    l_ckey = gap_player_cache_new_movie_key(gpp->ainfo_ptr->old_filename
+                         , framenr
+                         , gpp->ainfo_ptr->seltrack
+                         , gpp->ainfo_ptr->delace
+                         );
+    l_isCached = (gap_player_cache_lookup(l_ckey) != NULL);
+    g_free(l_ckey);
+    if(l_isCached)
+    {
+      gpp->readahead_consecutive_drops = 0;
+      return (FALSE);
+    }
+  }
+
+  p_readahead_get_request_size(gpp, &l_req_width, &l_req_height);
+  if(gap_player_readahead_wait_until_ready(gpp->readahead_ptr
+                   , framenr
+                   , l_req_width
+                   , l_req_height
+                   , 0           /* timeout_millisecs: check only, no wait */
+                   ))
+  {
+    gpp->readahead_consecutive_drops = 0;
+    return (FALSE);
+  }
+
+  if((!gpp->exact_timing)
+  || (gpp->readahead_consecutive_drops >= gpp->readahead_max_frames))
+  {
+    /* no drop, p_display_frame decodes synchron */
+    gpp->readahead_consecutive_drops = 0;
+    return (FALSE);
+  }
+
+  gpp->readahead_consecutive_drops++;
+  return (TRUE);
+
+}  /* end p_readahead_frame_must_be_dropped */
+
+
 
 
 /* --------------------------------
@@ -3483,7 +3806,10 @@ p_fetch_composite_image(GapPlayerMainGlobalParams *gpp
   if(gpp->stb_comp_vidhand)
   {
       gint32 l_layer_id;
+      gdouble l_start_secs;
+
       l_layer_id = -1;
+      l_start_secs = gap_player_stat_now(gpp->stat_ptr);
 
       /* The storyboard render processor is used to fetch
        * the frame as rendered gimp image of desired size.
@@ -3502,6 +3828,7 @@ p_fetch_composite_image(GapPlayerMainGlobalParams *gpp
                                , NULL   /*  filtermacro_file */
                                , &l_layer_id
                                );
+       gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_DECODE, l_start_secs);
        if(gap_debug)
        {
          printf("p_fetch_composite_image: comp_vidhand:%d  composite_image_id:%d\n"
@@ -3751,14 +4078,18 @@ p_render_display_free_pixbuf(GapPlayerMainGlobalParams *gpp
    , gint32  flip_status
    )
 {
+    gdouble l_start_secs;
+
     /* copy pixbuf as layer into the mtrace_image (only of mtrace_mode not OFF) */
     p_mtrace_pixbuf(gpp, pixbuf);
 
+    l_start_secs = gap_player_stat_now(gpp->stat_ptr);
     gap_pview_render_f_from_pixbuf (gpp->pv_ptr
                                    , pixbuf
                                    , flip_request
                                    , flip_status
                                    );
+    gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_SCALE, l_start_secs);
     g_object_unref(pixbuf);
 }  /* end p_render_display_free_pixbuf */
 
@@ -3782,6 +4113,7 @@ p_render_display_free_thdata(GapPlayerMainGlobalParams *gpp
    )
 {
   gboolean th_data_was_grabbed;
+  gdouble  l_start_secs;
 
   p_mtrace_tmpbuf(gpp
                , th_data
@@ -3790,6 +4122,7 @@ p_render_display_free_thdata(GapPlayerMainGlobalParams *gpp
                , th_bpp
                );
 
+  l_start_secs = gap_player_stat_now(gpp->stat_ptr);
   th_data_was_grabbed = gap_pview_render_f_from_buf (gpp->pv_ptr
                , th_data
                , th_width
@@ -3799,6 +4132,7 @@ p_render_display_free_thdata(GapPlayerMainGlobalParams *gpp
                , flip_request
                , flip_status
                );
+  gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_SCALE, l_start_secs);
   if(th_data_was_grabbed)
   {
     /* the gap_pview_render_f_from_buf procedure can grab the th_data
@@ -3830,6 +4164,8 @@ p_render_display_free_image_id(GapPlayerMainGlobalParams *gpp
    , gint32  flip_status
   )
 {
+  gdouble l_start_secs;
+
   /* there is no need for undo on this scratch image
    * so we turn undo off for performance reasons
    */
@@ -3838,11 +4174,13 @@ p_render_display_free_image_id(GapPlayerMainGlobalParams *gpp
   /* copy image as layer into the mtrace_image (only if mtrace_mode not OFF) */
   p_mtrace_image(gpp, image_id);
 
+  l_start_secs = gap_player_stat_now(gpp->stat_ptr);
   gap_pview_render_f_from_image (gpp->pv_ptr
                                , image_id
                                , flip_request
                                , flip_status
                                );
+  gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_SCALE, l_start_secs);
   gimp_image_delete(image_id);
 
 }  /* end p_render_display_free_image_id */
@@ -3862,6 +4200,9 @@ p_render_display_from_active_image_or_file(GapPlayerMainGlobalParams *gpp
   )
 {
   gint32  l_image_id;
+  gdouble l_start_secs;
+
+  l_start_secs = gap_player_stat_now(gpp->stat_ptr);
 
   /* got no thumbnail data, must use the full image */
   if(framenr_is_the_active_image)
@@ -3910,6 +4251,7 @@ p_render_display_from_active_image_or_file(GapPlayerMainGlobalParams *gpp
   {
     gap_thumb_cond_gimp_file_save_thumbnail(l_image_id, img_filename);
   }
+  gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_DECODE, l_start_secs);
 
 
   p_render_display_free_image_id(gpp
@@ -3961,6 +4303,8 @@ p_display_frame(GapPlayerMainGlobalParams *gpp, gint32 framenr)
   gboolean framenr_is_the_active_image;
   GdkPixbuf *pixbuf;
   gchar *ckey;
+  gdouble l_frame_start_secs;
+  gdouble l_start_secs;
   static gint32 funcId = -1;
   
   GAP_TIMM_GET_FUNCTION_ID(funcId, "playerDialog.p_display_frame");
@@ -3975,6 +4319,7 @@ p_display_frame(GapPlayerMainGlobalParams *gpp, gint32 framenr)
   }
 
   GAP_TIMM_START_FUNCTION(funcId);
+  l_frame_start_secs = gap_player_stat_now(gpp->stat_ptr);
 
   ckey = NULL;
   l_th_data = NULL;
@@ -4069,36 +4414,63 @@ p_display_frame(GapPlayerMainGlobalParams *gpp, gint32 framenr)
                          );
       }
 
-      isBackwards = (gpp->ainfo_ptr->last_frame_nr < gpp->ainfo_ptr->first_frame_nr) || gpp->play_backward;
-      l_th_data  = p_fetch_videoframe_via_cache(gpp
-                                     , gpp->ainfo_ptr->old_filename
+      if(gpp->readahead_ptr != NULL)
+      {
+        gint32 l_req_width;
+        gint32 l_req_height;
+
+        /* pick up the frame if the read-ahead thread has already decoded it */
+        l_req_width = l_th_width;
+        l_req_height = l_th_height;
+        l_start_secs = gap_player_stat_now(gpp->stat_ptr);
+        l_th_data = gap_player_readahead_fetch(gpp->readahead_ptr
                                      , framenr
-                                     , 1 + (abs(gpp->ainfo_ptr->last_frame_nr) - abs(gpp->ainfo_ptr->first_frame_nr))
-                                     , gpp->ainfo_ptr->seltrack
-                                     , gpp->ainfo_ptr->delace
-                                     , gpp->preferred_decoder
-                                     , &l_th_bpp       /* IN/OUT */
-                                     , &l_th_width     /* IN/OUT */
-                                     , &l_th_height    /* IN/OUT */
-                                     , &l_flip_status  /* OUT */
-                                     , ckey            /* IN */
-                                     , isBackwards
+                                     , l_req_width
+                                     , l_req_height
+                                     , &l_th_bpp       /* OUT */
+                                     , &l_th_width     /* OUT */
+                                     , &l_th_height    /* OUT */
+                                     , &l_flip_status  /* IN/OUT */
                                      );
-      if(gpp->cancel_video_api)
-      {
-        if(l_th_data)
+        if(l_th_data != NULL)
         {
-          g_free(l_th_data); /* throw away undefined data in case of cancel */
-          l_th_data = NULL;
+          gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_FETCH, l_start_secs);
         }
-        if(gpp->progress_bar)
+      }
+
+      if(l_th_data == NULL)
+      {
+        isBackwards = (gpp->ainfo_ptr->last_frame_nr < gpp->ainfo_ptr->first_frame_nr) || gpp->play_backward;
+        l_th_data  = p_fetch_videoframe_via_cache(gpp
+                                       , gpp->ainfo_ptr->old_filename
+                                       , framenr
+                                       , 1 + (abs(gpp->ainfo_ptr->last_frame_nr) - abs(gpp->ainfo_ptr->first_frame_nr))
+                                       , gpp->ainfo_ptr->seltrack
+                                       , gpp->ainfo_ptr->delace
+                                       , gpp->preferred_decoder
+                                       , &l_th_bpp       /* IN/OUT */
+                                       , &l_th_width     /* IN/OUT */
+                                       , &l_th_height    /* IN/OUT */
+                                       , &l_flip_status  /* OUT */
+                                       , ckey            /* IN */
+                                       , isBackwards
+                                       );
+        if(gpp->cancel_video_api)
         {
-           gtk_progress_bar_set_text(GTK_PROGRESS_BAR(gpp->progress_bar)
-                        , _("Canceled"));
-        }
+          if(l_th_data)
+          {
+            g_free(l_th_data); /* throw away undefined data in case of cancel */
+            l_th_data = NULL;
+          }
+          if(gpp->progress_bar)
+          {
+             gtk_progress_bar_set_text(GTK_PROGRESS_BAR(gpp->progress_bar)
+                          , _("Canceled"));
+          }
 
-        GAP_TIMM_STOP_FUNCTION(funcId);
-        return;
+          GAP_TIMM_STOP_FUNCTION(funcId);
+          return;
+        }
       }
 
     }
@@ -4155,6 +4527,7 @@ p_display_frame(GapPlayerMainGlobalParams *gpp, gint32 framenr)
   {
     if(gpp->use_thumbnails)
     {
+      l_start_secs = gap_player_stat_now(gpp->stat_ptr);
       if(framenr_is_the_active_image)
       {
          gint32 l_tmp_image_id;
@@ -4215,6 +4588,7 @@ p_display_frame(GapPlayerMainGlobalParams *gpp, gint32 framenr)
                                       );
 
       }
+      gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_DECODE, l_start_secs);
     }
   }
 
@@ -4275,6 +4649,7 @@ p_display_frame(GapPlayerMainGlobalParams *gpp, gint32 framenr)
   }
 
 
+  l_start_secs = gap_player_stat_now(gpp->stat_ptr);
   if (ckey != NULL)
   {
     p_frame_chache_processing(gpp, ckey);
@@ -4286,21 +4661,33 @@ p_display_frame(GapPlayerMainGlobalParams *gpp, gint32 framenr)
   p_update_position_widgets(gpp);
 
   gdk_flush();
+  gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_DISPLAY, l_start_secs);
 
   if(l_th_data)  g_free(l_th_data);
 
   if(l_filename) g_free(l_filename);
 
+  gap_player_stat_add_since(gpp->stat_ptr, GAP_PLAYER_STAT_FRAME, l_frame_start_secs);
   GAP_TIMM_STOP_FUNCTION(funcId);
 
 }  /* end p_display_frame */
 
 /* ------------------------------
- * p_get_next_framenr_in_sequence /2
+ * p_calculate_next_framenr
  * ------------------------------
+ * calculate the framenumber that follows framenr in the playback sequence
+ * (according to loop, pingpong and selection only settings)
+ * without changing the player state.
+ * The play direction and the pingpong counter are passed IN/OUT,
+ * wrapped_ptr is set TRUE when the first or last frame was reached.
+ * returns -1 if playback shall STOP.
  */
-gint32
-p_get_next_framenr_in_sequence2(GapPlayerMainGlobalParams *gpp)
+static gint32
+p_calculate_next_framenr(GapPlayerMainGlobalParams *gpp
+  , gint32 framenr
+  , gboolean *backward_ptr
+  , gint32 *pingpong_count_ptr
+  , gboolean *wrapped_ptr)
 {
   gint32 l_first;
   gint32 l_last;
@@ -4313,85 +4700,114 @@ p_get_next_framenr_in_sequence2(GapPlayerMainGlobalParams *gpp)
     l_last  = gpp->end_frame;
   }
 
+  *wrapped_ptr = FALSE;
 
-  if(gpp->play_backward)
+  if(*backward_ptr)
   {
-    if(gpp->play_current_framenr <= l_first)
+    if(framenr <= l_first)
     {
-      p_audio_resync(gpp);
+      *wrapped_ptr = TRUE;
       if(gpp->play_loop)
       {
         if(gpp->play_pingpong)
         {
-          gpp->play_current_framenr = l_first + 1;
-          gpp->play_backward = FALSE;
-          gpp->pingpong_count++;
+          framenr = l_first + 1;
+          *backward_ptr = FALSE;
+          (*pingpong_count_ptr)++;
         }
         else
         {
-          gpp->play_current_framenr = l_last;
+          framenr = l_last;
         }
       }
       else
       {
-        if((gpp->play_pingpong) && (gpp->pingpong_count <= 0))
+        if((gpp->play_pingpong) && (*pingpong_count_ptr <= 0))
         {
-          gpp->play_current_framenr = l_first + 1;
-          gpp->play_backward = FALSE;
-          gpp->pingpong_count++;
+          framenr = l_first + 1;
+          *backward_ptr = FALSE;
+          (*pingpong_count_ptr)++;
         }
         else
         {
-          gpp->pingpong_count = 0;
+          *pingpong_count_ptr = 0;
           return -1;  /* STOP if first frame reached */
         }
       }
     }
     else
     {
-      gpp->play_current_framenr--;
+      framenr--;
     }
   }
   else
   {
-    if(gpp->play_current_framenr >= l_last)
+    if(framenr >= l_last)
     {
-      p_audio_resync(gpp);
+      *wrapped_ptr = TRUE;
       if(gpp->play_loop)
       {
         if(gpp->play_pingpong)
         {
-          gpp->play_current_framenr = l_last - 1;
-          gpp->play_backward = TRUE;
-          gpp->pingpong_count++;
+          framenr = l_last - 1;
+          *backward_ptr = TRUE;
+          (*pingpong_count_ptr)++;
         }
         else
         {
-          gpp->play_current_framenr = l_first;
+          framenr = l_first;
         }
       }
       else
       {
-        if((gpp->play_pingpong) && (gpp->pingpong_count <= 0))
+        if((gpp->play_pingpong) && (*pingpong_count_ptr <= 0))
         {
-          gpp->play_current_framenr = l_last - 1;
-          gpp->play_backward = TRUE;
-          gpp->pingpong_count++;
+          framenr = l_last - 1;
+          *backward_ptr = TRUE;
+          (*pingpong_count_ptr)++;
         }
         else
         {
-          gpp->pingpong_count = 0;
+          *pingpong_count_ptr = 0;
           return -1;  /* STOP if last frame reached */
         }
       }
     }
     else
     {
-      gpp->play_current_framenr++;
+      framenr++;
     }
   }
 
-  gpp->play_current_framenr = CLAMP(gpp->play_current_framenr, l_first, l_last);
+  return (CLAMP(framenr, l_first, l_last));
+}  /* end p_calculate_next_framenr */
+
+/* ------------------------------
+ * p_get_next_framenr_in_sequence /2
+ * ------------------------------
+ */
+gint32
+p_get_next_framenr_in_sequence2(GapPlayerMainGlobalParams *gpp)
+{
+  gint32   l_framenr;
+  gboolean l_wrapped;
+
+  l_framenr = p_calculate_next_framenr(gpp
+                , gpp->play_current_framenr
+                , &gpp->play_backward
+                , &gpp->pingpong_count
+                , &l_wrapped
+                );
+  if(l_wrapped)
+  {
+    p_audio_resync(gpp);
+  }
+  if(l_framenr < 0)
+  {
+    return -1;
+  }
+
+  gpp->play_current_framenr = l_framenr;
   return (gpp->play_current_framenr);
 }  /* end p_get_next_framenr_in_sequence2 */
 
@@ -4556,10 +4972,12 @@ on_timer_playback(GapPlayerMainGlobalParams *gpp)
        gint32 l_prev_framenr;
        gint32 l_framenr = -1;
        gboolean l_frame_dropped;
+       gboolean l_frame_displayed;
        gdouble  l_delay;
 
        l_framenr = -1;
        l_frame_dropped = FALSE;
+       l_frame_displayed = FALSE;
        l_delay = gpp->delay_secs;
 
        ii_max = (gpp->exact_timing) ? 20 : 2;
@@ -4613,18 +5031,39 @@ on_timer_playback(GapPlayerMainGlobalParams *gpp)
               * until we are in time again
               */
              l_frame_dropped = TRUE;
+             gap_player_stat_count_dropped(gpp->stat_ptr);
              /* printf("DROP (SKIP) frame\n"); */
              gtk_label_set_text ( GTK_LABEL(gpp->status_label), _("Skip"));
+             p_readahead_update(gpp, l_framenr);
            }
            else
            {
-             p_display_frame(gpp, l_framenr);
+             p_readahead_update(gpp, l_framenr);
+             if(p_readahead_frame_must_be_dropped(gpp, l_framenr))
+             {
+               /* the frame was not decoded in time by the read-ahead thread */
+               l_frame_dropped = TRUE;
+               gap_player_stat_count_dropped(gpp->stat_ptr);
+               gtk_label_set_text ( GTK_LABEL(gpp->status_label), _("Skip"));
+             }
+             else
+             {
+               p_display_frame(gpp, l_framenr);
+               l_frame_displayed = TRUE;
+             }
            }
 
            /* get secs elapsed since playbackstart (or last speed change) */
            elapsed_secs = g_timer_elapsed(gpp->gtimer, &elapsed_microsecs);
 
            gpp->rest_secs = (gpp->cycle_time_secs * gpp->framecnt) - elapsed_secs;
+
+           if(l_frame_displayed)
+           {
+             /* the frame is late if the next frame is already due */
+             gap_player_stat_count_displayed(gpp->stat_ptr, (gpp->rest_secs < 0));
+             l_frame_displayed = FALSE;
+           }
            /*if(gap_debug) printf("on_timer_playback[%d]: rest:%.4f\n", (int)ii, (float)gpp->rest_secs); */
 
            if(gpp->rest_secs > 0)
@@ -6041,6 +6480,8 @@ on_shell_window_destroy                (GtkObject       *object,
   gpp->shell_window = NULL;
   p_close_videofile(gpp);
   p_close_composite_storyboard(gpp);
+  gap_player_stat_free(gpp->stat_ptr);
+  gpp->stat_ptr = NULL;
 
   if(gpp->standalone_mode)
   {
@@ -39,6 +39,8 @@
 #include "gap_pview_da.h"
 #include "gap_story_file.h"
 #include "gap_player_cache.h"
+#include "gap_player_readahead.h"
+#include "gap_player_stat.h"
 #include "gap_story_render_types.h"
 #include "gap_drawable_vref_parasite.h"
 
@@ -262,7 +264,14 @@ typedef struct GapPlayerMainGlobalParams {
   gulong       cache_ntiles;                 /* gimp tile cache size for the player process */
   GtkObject   *cache_ntiles_spinbutton_adj;
   GtkWidget   *detail_tracking_checkbutton;
-  
+
+  /* background read-ahead decoding for playback of a single videoclip */
+  GapPlayerReadahead *readahead_ptr;
+  gint32       readahead_max_frames;         /* 0: read-ahead is turned OFF */
+  gint32       readahead_consecutive_drops;
+
+  GapPlayerStat *stat_ptr;                   /* frame timing statistics of the current playback */
+
 } GapPlayerMainGlobalParams;
 
 #define GAP_PLAYER_MAIN_DEFAULT_CACHE_NTILES   200
@@ -0,0 +1,961 @@
+/*  gap_player_readahead.c
+ *
+ *  This module handles background read-ahead decoding of videoframes
+ *  for GAP video playback
+ *
+ */
+
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/* revision history:
+ * version 2.7.0;   2026/10/18  created
+ * version 2.7.0;   2026/10/18  decompress frames offered from the player cache in the producer thread
+ */
+
+/* The read-ahead overview:
+ *
+ * The player (main thread) tells the read-ahead the list of framenumbers
+ * that will be displayed next (the wanted list, in display order)
+ * each time the playback timer handles a frame.
+ * A producer thread decodes the first wanted frame that is not yet ready
+ * (scaled to the requested preview size) via its own private GVA videohandle
+ * and appends the result to the ready list.
+ *
+ *   main thread                               producer thread
+ *   ------------------------------------      -------------------------------
+ *   set_wanted(n+1, n+2, ... n+max)   ---->   decode n+1, n+2 ... (own gvahand)
+ *   wait_until_ready(n+1, timeout)    <----   ready list: n+1, n+2
+ *   fetch(n+1)  (removes from ready list)
+ *
+ * The producer does not touch the player cache, GTK or the GIMP PDB.
+ * (the main thread inserts displayed frames into the player cache as before)
+ * Wanted frames that are available (compressed) in the player cache are
+ * offered by the main thread as a private copy of the cache data
+ * (see gap_player_readahead_offer_cached). The producer decompresses such
+ * frames instead of decoding them, so the playback timer does not spend
+ * time for JPEG decompression of cached frames.
+ * Ready frames that are no longer wanted (after a jump or direction change)
+ * are discarded at the next set_wanted call.
+ * The number of ready frames is limited to max_frames.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <glib/gstdio.h>
+
+#include <libgimp/gimp.h>
+
+#include "gap_libgapbase.h"
+#include "gap_player_cache.h"
+#include "gap_player_readahead.h"
+
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+#include "gap_vid_api.h"
+#endif
+
+extern int gap_debug;  /* 1 == print debug infos , 0 dont print debug infos */
+
+
+typedef struct GapPlayerReadaheadFrame {   /* nickname: rframe */
+  gint32   framenr;
+  gint32   req_width;         /* requested size, -1 for original videosize */
+  gint32   req_height;
+  guchar  *th_data;
+  gint32   th_bpp;
+  gint32   th_width;
+  gint32   th_height;
+  gint32   flip_status;       /* flip status of frames from the player cache */
+  gboolean isFromCache;       /* TRUE: th_data was decompressed from a player cache copy */
+  GapPlayerCacheData *cdata;  /* private copy of the player cache data (offered frames only) */
+} GapPlayerReadaheadFrame;
+
+struct GapPlayerReadahead {
+  gchar    *videofile;
+  gint32    seltrack;
+  gdouble   delace;
+  gchar    *preferred_decoder;
+  gint32    max_frames;
+  gint32    fcache_size;
+
+  GThread  *thread;
+  GMutex   *mutex;            /* protects all members below */
+  GCond    *cond;
+  gboolean  stop;             /* TRUE: request the producer thread to exit */
+  gboolean  cancelBusy;       /* TRUE: the frame in work is no longer wanted */
+
+  gint32   *wanted;           /* framenumbers to display next (in display order) */
+  gint32    wantedCount;
+  gint32    req_width;
+  gint32    req_height;
+  gboolean  isBackwards;
+
+  GList    *ready;            /* list of GapPlayerReadaheadFrame */
+  gint32    readyCount;
+  GList    *offered;          /* list of GapPlayerReadaheadFrame with cdata, waiting for decompression */
+  gint32    busyFramenr;      /* frame currently decoded by the producer, -1 when idle */
+  gint32    failedFramenr;    /* last frame that could not be decoded */
+  gboolean  openFailed;
+
+  /* statistics */
+  gint32    framesDecoded;
+  gint32    framesDecompressed;
+  gint32    framesDelivered;
+  gint32    framesDiscarded;
+};
+
+
+/* ---------------------------------
+ * p_free_rframe
+ * ---------------------------------
+ */
+static void
+p_free_rframe(GapPlayerReadaheadFrame *rframe)
+{
+  if(rframe->th_data)
+  {
+    g_free(rframe->th_data);
+  }
+  if(rframe->cdata)
+  {
+    gap_player_cache_free_cdata(rframe->cdata);
+  }
+  g_free(rframe);
+}  /* end p_free_rframe */
+
+
+/* ---------------------------------
+ * p_is_wanted
+ * ---------------------------------
+ * check if framenr is in the wanted list
+ * (the caller must hold the mutex)
+ */
+static gboolean
+p_is_wanted(GapPlayerReadahead *rahead, gint32 framenr)
+{
+  gint32 ii;
+
+  for(ii=0; ii < rahead->wantedCount; ii++)
+  {
+    if(rahead->wanted[ii] == framenr)
+    {
+      return (TRUE);
+    }
+  }
+  return (FALSE);
+}  /* end p_is_wanted */
+
+
+/* ---------------------------------
+ * p_find_rframe
+ * ---------------------------------
+ * find the list element for framenr at the requested size
+ * (the caller must hold the mutex)
+ */
+static GList *
+p_find_rframe(GList *rframes, gint32 framenr
+  , gint32 req_width, gint32 req_height)
+{
+  GList *list;
+
+  for(list = rframes; list != NULL; list = list->next)
+  {
+    GapPlayerReadaheadFrame *rframe;
+
+    rframe = (GapPlayerReadaheadFrame *)list->data;
+    if((rframe->framenr == framenr)
+    && (rframe->req_width == req_width)
+    && (rframe->req_height == req_height))
+    {
+      return (list);
+    }
+  }
+  return (NULL);
+}  /* end p_find_rframe */
+
+
+/* ---------------------------------
+ * p_find_ready
+ * ---------------------------------
+ * find the ready list element for framenr decoded at the requested size
+ * (the caller must hold the mutex)
+ */
+static GList *
+p_find_ready(GapPlayerReadahead *rahead, gint32 framenr
+  , gint32 req_width, gint32 req_height)
+{
+  return (p_find_rframe(rahead->ready, framenr, req_width, req_height));
+}  /* end p_find_ready */
+
+
+/* ---------------------------------
+ * p_discard_unwanted
+ * ---------------------------------
+ * remove the elements that are no longer wanted (or have another size)
+ * from the list of GapPlayerReadaheadFrame.
+ * returns the number of removed elements.
+ * (the caller must hold the mutex)
+ */
+static gint32
+p_discard_unwanted(GapPlayerReadahead *rahead, GList **rframes_ptr)
+{
+  GList  *list;
+  GList  *next;
+  gint32  count;
+
+  count = 0;
+  for(list = *rframes_ptr; list != NULL; list = next)
+  {
+    GapPlayerReadaheadFrame *rframe;
+
+    next = list->next;
+    rframe = (GapPlayerReadaheadFrame *)list->data;
+    if((rframe->req_width != rahead->req_width)
+    || (rframe->req_height != rahead->req_height)
+    || (!p_is_wanted(rahead, rframe->framenr)))
+    {
+      *rframes_ptr = g_list_delete_link(*rframes_ptr, list);
+      p_free_rframe(rframe);
+      count++;
+    }
+  }
+  return (count);
+}  /* end p_discard_unwanted */
+
+
+/* ---------------------------------
+ * p_is_pending
+ * ---------------------------------
+ * TRUE if the producer thread will (or currently does) decode framenr.
+ * (the caller must hold the mutex)
+ */
+static gboolean
+p_is_pending(GapPlayerReadahead *rahead, gint32 framenr
+  , gint32 req_width, gint32 req_height)
+{
+  if((rahead->stop)
+  || (rahead->openFailed)
+  || (rahead->thread == NULL)
+  || (rahead->failedFramenr == framenr)
+  || (rahead->req_width != req_width)
+  || (rahead->req_height != req_height))
+  {
+    return (FALSE);
+  }
+  return (p_is_wanted(rahead, framenr));
+}  /* end p_is_pending */
+
+
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+
+/* ---------------------------------
+ * p_readahead_progress_callback
+ * ---------------------------------
+ * progress callback of the private videohandle.
+ * returns TRUE to cancel a (long) seek operation
+ * when the frame in work is no longer wanted.
+ */
+static gboolean
+p_readahead_progress_callback(gdouble progress, gpointer user_data)
+{
+  GapPlayerReadahead *rahead;
+  gboolean            cancel;
+
+  rahead = (GapPlayerReadahead *)user_data;
+  g_mutex_lock(rahead->mutex);
+  cancel = (rahead->stop || rahead->cancelBusy);
+  g_mutex_unlock(rahead->mutex);
+
+  return (cancel);
+}  /* end p_readahead_progress_callback */
+
+
+/* ---------------------------------
+ * p_readahead_thread_function
+ * ---------------------------------
+ * the producer thread decodes wanted frames until stop is requested.
+ * Frames offered from the player cache are decompressed
+ * instead of decoding them from the video.
+ * it sleeps on the condition while there is nothing to do
+ * or the ready list is full.
+ */
+static gpointer
+p_readahead_thread_function(GapPlayerReadahead *rahead)
+{
+  t_GVA_Handle *gvahand;
+  gint32        deinterlace;
+  gdouble       threshold;
+
+  gvahand = NULL;
+
+  /* split delace value: integer part is deinterlace mode, rest is threshold */
+  deinterlace = rahead->delace;
+  threshold = rahead->delace - (gdouble)deinterlace;
+
+  g_mutex_lock(rahead->mutex);
+  while(!rahead->stop)
+  {
+    gint32    ii;
+    gint32    framenr;
+    gint32    req_width;
+    gint32    req_height;
+    gboolean  isBackwards;
+    gint32    th_bpp;
+    gint32    th_width;
+    gint32    th_height;
+    gboolean  do_scale;
+    guchar   *th_data;
+    GList    *offered;
+
+    framenr = -1;
+    if(rahead->readyCount < rahead->max_frames)
+    {
+      for(ii=0; ii < rahead->wantedCount; ii++)
+      {
+        if((rahead->wanted[ii] != rahead->failedFramenr)
+        && (p_find_ready(rahead, rahead->wanted[ii], rahead->req_width, rahead->req_height) == NULL))
+        {
+          framenr = rahead->wanted[ii];
+          break;
+        }
+      }
+    }
+
+    if(framenr < 0)
+    {
+      /* nothing to do (or ready list is full) wait for set_wanted or fetch */
+      g_cond_wait(rahead->cond, rahead->mutex);
+      continue;
+    }
+
+    req_width = rahead->req_width;
+    req_height = rahead->req_height;
+    isBackwards = rahead->isBackwards;
+    rahead->busyFramenr = framenr;
+    rahead->cancelBusy = FALSE;
+
+    offered = p_find_rframe(rahead->offered, framenr, req_width, req_height);
+    if(offered != NULL)
+    {
+      GapPlayerReadaheadFrame *rframe;
+
+      /* the frame is available in the player cache, decompress the offered copy */
+      rframe = (GapPlayerReadaheadFrame *)offered->data;
+      rahead->offered = g_list_delete_link(rahead->offered, offered);
+      g_mutex_unlock(rahead->mutex);
+
+      rframe->th_data = gap_player_cache_decompress(rframe->cdata);
+      rframe->th_bpp = rframe->cdata->th_bpp;
+      rframe->th_width = rframe->cdata->th_width;
+      rframe->th_height = rframe->cdata->th_height;
+      rframe->flip_status = rframe->cdata->flip_status;
+      gap_player_cache_free_cdata(rframe->cdata);
+      rframe->cdata = NULL;
+
+      g_mutex_lock(rahead->mutex);
+      rahead->busyFramenr = -1;
+      if((rframe->th_data != NULL)
+      && (p_is_wanted(rahead, framenr))
+      && (req_width == rahead->req_width)
+      && (req_height == rahead->req_height))
+      {
+        rahead->ready = g_list_append(rahead->ready, rframe);
+        rahead->readyCount++;
+        rahead->framesDecompressed++;
+      }
+      else
+      {
+        p_free_rframe(rframe);
+        rahead->framesDiscarded++;
+      }
+      g_cond_broadcast(rahead->cond);
+      continue;
+    }
+    g_mutex_unlock(rahead->mutex);
+
+    if(gvahand == NULL)
+    {
+      gvahand = GVA_open_read_pref(rahead->videofile
+                                  , rahead->seltrack
+                                  , 1 /* aud_track */
+                                  , rahead->preferred_decoder
+                                  , FALSE  /* use MMX if available (disable_mmx == FALSE) */
+                                  );
+      if(gvahand)
+      {
+        /* never use gimp progress, because this runs in a thread */
+        gvahand->do_gimp_progress = FALSE;
+        gvahand->progress_cb_user_data = rahead;
+        gvahand->fptr_progress_callback = p_readahead_progress_callback;
+        if(rahead->fcache_size > GVA_get_fcache_size_in_elements(gvahand))
+        {
+          GVA_set_fcache_size(gvahand, rahead->fcache_size);
+        }
+      }
+      else
+      {
+        g_mutex_lock(rahead->mutex);
+        if(gap_debug)
+        {
+          printf("p_readahead_thread_function: open failed videofile:%s\n"
+            , rahead->videofile
+            );
+        }
+        rahead->openFailed = TRUE;
+        rahead->busyFramenr = -1;
+        g_cond_broadcast(rahead->cond);
+        break;
+      }
+    }
+
+    do_scale = TRUE;
+    th_width = req_width;
+    th_height = req_height;
+    th_bpp = gvahand->frame_bpp;
+    if(th_width < 1)
+    {
+      th_width = gvahand->width;
+      th_height = gvahand->height;
+      do_scale = FALSE;
+    }
+
+    th_data = GVA_fetch_frame_to_buffer(gvahand
+                , do_scale
+                , isBackwards
+                , framenr
+                , deinterlace
+                , threshold
+                , &th_bpp
+                , &th_width
+                , &th_height
+                );
+
+    g_mutex_lock(rahead->mutex);
+    rahead->busyFramenr = -1;
+    if(th_data == NULL)
+    {
+      if((!rahead->cancelBusy) && (!rahead->stop))
+      {
+        /* do not retry this frame, the main thread will try synchron fetch */
+        rahead->failedFramenr = framenr;
+      }
+    }
+    else if((p_is_wanted(rahead, framenr))
+         && (req_width == rahead->req_width)
+         && (req_height == rahead->req_height))
+    {
+      GapPlayerReadaheadFrame *rframe;
+
+      rframe = g_new(GapPlayerReadaheadFrame, 1);
+      rframe->framenr = framenr;
+      rframe->req_width = req_width;
+      rframe->req_height = req_height;
+      rframe->th_data = th_data;
+      rframe->th_bpp = th_bpp;
+      rframe->th_width = th_width;
+      rframe->th_height = th_height;
+      rframe->flip_status = 0;
+      rframe->isFromCache = FALSE;
+      rframe->cdata = NULL;
+      rahead->ready = g_list_append(rahead->ready, rframe);
+      rahead->readyCount++;
+      rahead->framesDecoded++;
+    }
+    else
+    {
+      /* the playhead has moved away while decoding */
+      g_free(th_data);
+      rahead->framesDiscarded++;
+    }
+    g_cond_broadcast(rahead->cond);
+  }
+  g_mutex_unlock(rahead->mutex);
+
+  if(gvahand)
+  {
+    GVA_close(gvahand);
+  }
+
+  return (NULL);
+
+}  /* end p_readahead_thread_function */
+
+#endif  /* GAP_ENABLE_VIDEOAPI_SUPPORT */
+
+
+/* ---------------------------------------------
+ * gap_player_readahead_get_gimprc_max_frames
+ * ---------------------------------------------
+ * get the configured maximum number of frames to decode ahead of the playhead.
+ * 0 turns read-ahead OFF.
+ */
+gint32
+gap_player_readahead_get_gimprc_max_frames(void)
+{
+  return (gap_base_get_gimprc_int_value(GAP_PLAYER_READAHEAD_GIMPRC_MAX_FRAMES
+                 , GAP_PLAYER_READAHEAD_DEFAULT_MAX_FRAMES  /* default */
+                 , 0                                        /* min */
+                 , GAP_PLAYER_READAHEAD_LIMIT_MAX_FRAMES    /* max */
+                 ));
+}  /* end gap_player_readahead_get_gimprc_max_frames */
+
+
+/* ---------------------------------
+ * gap_player_readahead_new
+ * ---------------------------------
+ * create a read-ahead for the specified videofile
+ * and start its producer thread.
+ * returns NULL if read-ahead is not available
+ * (max_frames < 1, no thread support or no video API support)
+ */
+GapPlayerReadahead *
+gap_player_readahead_new(const char *videofile
+  , gint32 seltrack
+  , gdouble delace
+  , const char *preferred_decoder
+  , gint32 max_frames
+  , gint32 fcache_size
+  )
+{
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+  GapPlayerReadahead *rahead;
+  GError *error;
+
+  if((videofile == NULL) || (max_frames < 1))
+  {
+    return (NULL);
+  }
+  if(gap_base_thread_init() != TRUE)
+  {
+    return (NULL);
+  }
+
+  rahead = g_new0(GapPlayerReadahead, 1);
+  rahead->videofile = g_strdup(videofile);
+  rahead->seltrack = seltrack;
+  rahead->delace = delace;
+  rahead->preferred_decoder = NULL;
+  if(preferred_decoder)
+  {
+    rahead->preferred_decoder = g_strdup(preferred_decoder);
+  }
+  rahead->max_frames = max_frames;
+  rahead->fcache_size = fcache_size;
+  rahead->mutex = g_mutex_new();
+  rahead->cond = g_cond_new();
+  rahead->stop = FALSE;
+  rahead->cancelBusy = FALSE;
+  rahead->wanted = g_new(gint32, max_frames);
+  rahead->wantedCount = 0;
+  rahead->req_width = -1;
+  rahead->req_height = -1;
+  rahead->busyFramenr = -1;
+  rahead->failedFramenr = -1;
+
+  error = NULL;
+  rahead->thread = g_thread_create((GThreadFunc)p_readahead_thread_function
+                     , rahead      /* data */
+                     , TRUE        /* joinable */
+                     , &error
+                     );
+  if(rahead->thread == NULL)
+  {
+    if(gap_debug)
+    {
+      printf("gap_player_readahead_new: thread create failed: %s\n"
+        , (error != NULL) ? error->message : "?"
+        );
+    }
+    if(error)
+    {
+      g_error_free(error);
+    }
+    gap_player_readahead_free(rahead);
+    return (NULL);
+  }
+
+  if(gap_debug)
+  {
+    printf("gap_player_readahead_new: videofile:%s max_frames:%d\n"
+      , rahead->videofile
+      , (int)rahead->max_frames
+      );
+  }
+  return (rahead);
+#else
+  return (NULL);
+#endif
+}  /* end gap_player_readahead_new */
+
+
+/* ---------------------------------
+ * gap_player_readahead_is_for_video
+ * ---------------------------------
+ * check if the read-ahead decodes the specified video
+ */
+gboolean
+gap_player_readahead_is_for_video(GapPlayerReadahead *rahead
+  , const char *videofile
+  , gint32 seltrack
+  , gdouble delace
+  , const char *preferred_decoder
+  )
+{
+  if((rahead == NULL) || (videofile == NULL))
+  {
+    return (FALSE);
+  }
+  if((strcmp(rahead->videofile, videofile) != 0)
+  || (rahead->seltrack != seltrack)
+  || (rahead->delace != delace))
+  {
+    return (FALSE);
+  }
+  if((rahead->preferred_decoder == NULL) || (preferred_decoder == NULL))
+  {
+    return (rahead->preferred_decoder == preferred_decoder);
+  }
+  return (strcmp(rahead->preferred_decoder, preferred_decoder) == 0);
+}  /* end gap_player_readahead_is_for_video */
+
+
+/* ---------------------------------
+ * gap_player_readahead_set_wanted
+ * ---------------------------------
+ * set the list of framenumbers that are displayed next (in display order)
+ * at the requested size (req_width/req_height -1 for original videosize).
+ * count is limited to max_frames.
+ * ready frames that are no longer wanted are discarded
+ * and the producer thread is triggered.
+ */
+void
+gap_player_readahead_set_wanted(GapPlayerReadahead *rahead
+  , const gint32 *framenrs
+  , gint32 count
+  , gint32 req_width
+  , gint32 req_height
+  , gboolean isBackwards
+  )
+{
+  gint32 count_discarded;
+
+  if(rahead == NULL)
+  {
+    return;
+  }
+
+  g_mutex_lock(rahead->mutex);
+
+  rahead->wantedCount = CLAMP(count, 0, rahead->max_frames);
+  if(rahead->wantedCount > 0)
+  {
+    memcpy(rahead->wanted, framenrs, rahead->wantedCount * sizeof(gint32));
+  }
+  rahead->req_width = req_width;
+  rahead->req_height = req_height;
+  rahead->isBackwards = isBackwards;
+
+  count_discarded = p_discard_unwanted(rahead, &rahead->ready);
+  rahead->readyCount -= count_discarded;
+  rahead->framesDiscarded += count_discarded;
+  p_discard_unwanted(rahead, &rahead->offered);
+
+  if(!p_is_wanted(rahead, rahead->failedFramenr))
+  {
+    rahead->failedFramenr = -1;
+  }
+  if((rahead->busyFramenr >= 0)
+  && (!p_is_wanted(rahead, rahead->busyFramenr)))
+  {
+    rahead->cancelBusy = TRUE;
+  }
+
+  g_cond_broadcast(rahead->cond);
+  g_mutex_unlock(rahead->mutex);
+
+}  /* end gap_player_readahead_set_wanted */
+
+
+/* ---------------------------------------
+ * gap_player_readahead_wait_until_ready
+ * ---------------------------------------
+ * check if framenr is ready (decoded at the requested size).
+ * if the frame is pending (wanted but not decoded yet)
+ * wait until it gets ready, but not longer than timeout_millisecs.
+ * returns TRUE if the frame is ready.
+ */
+gboolean
+gap_player_readahead_wait_until_ready(GapPlayerReadahead *rahead
+  , gint32 framenr
+  , gint32 req_width
+  , gint32 req_height
+  , gint32 timeout_millisecs
+  )
+{
+  GTimeVal  endTime;
+  gboolean  isReady;
+
+  if(rahead == NULL)
+  {
+    return (FALSE);
+  }
+
+  g_get_current_time(&endTime);
+  g_time_val_add(&endTime, (glong)MAX(0, timeout_millisecs) * 1000);
+
+  g_mutex_lock(rahead->mutex);
+  while(TRUE)
+  {
+    isReady = (p_find_ready(rahead, framenr, req_width, req_height) != NULL);
+    if((isReady)
+    || (timeout_millisecs <= 0)
+    || (!p_is_pending(rahead, framenr, req_width, req_height)))
+    {
+      break;
+    }
+    if(g_cond_timed_wait(rahead->cond, rahead->mutex, &endTime) != TRUE)
+    {
+      isReady = (p_find_ready(rahead, framenr, req_width, req_height) != NULL);
+      break;
+    }
+  }
+  g_mutex_unlock(rahead->mutex);
+
+  return (isReady);
+
+}  /* end gap_player_readahead_wait_until_ready */
+
+
+/* ---------------------------------------
+ * gap_player_readahead_wants_cached
+ * ---------------------------------------
+ * check if framenr is wanted at the requested size
+ * and neither ready, in work nor already offered.
+ * The main thread uses this check to offer only those frames
+ * from the player cache that the producer still has to deliver.
+ */
+gboolean
+gap_player_readahead_wants_cached(GapPlayerReadahead *rahead
+  , gint32 framenr
+  , gint32 req_width
+  , gint32 req_height
+  )
+{
+  gboolean wantsCached;
+
+  if(rahead == NULL)
+  {
+    return (FALSE);
+  }
+
+  g_mutex_lock(rahead->mutex);
+  wantsCached = ((!rahead->stop)
+              && (rahead->thread != NULL)
+              && (rahead->busyFramenr != framenr)
+              && (rahead->req_width == req_width)
+              && (rahead->req_height == req_height)
+              && (p_is_wanted(rahead, framenr))
+              && (p_find_ready(rahead, framenr, req_width, req_height) == NULL)
+              && (p_find_rframe(rahead->offered, framenr, req_width, req_height) == NULL));
+  g_mutex_unlock(rahead->mutex);
+
+  return (wantsCached);
+
+}  /* end gap_player_readahead_wants_cached */
+
+
+/* ---------------------------------------
+ * gap_player_readahead_offer_cached
+ * ---------------------------------------
+ * offer a (compressed) frame from the player cache for framenr.
+ * cdata must be a private copy of the player cache data
+ * (see gap_player_cache_dup_cdata), the read-ahead takes ownership.
+ * The producer thread decompresses the offered frame and delivers
+ * it via the ready list, so that gap_player_readahead_fetch
+ * can pick it up without decompression in the main thread.
+ */
+void
+gap_player_readahead_offer_cached(GapPlayerReadahead *rahead
+  , gint32 framenr
+  , gint32 req_width
+  , gint32 req_height
+  , GapPlayerCacheData *cdata
+  )
+{
+  GapPlayerReadaheadFrame *rframe;
+
+  if(cdata == NULL)
+  {
+    return;
+  }
+
+  rframe = g_new0(GapPlayerReadaheadFrame, 1);
+  rframe->framenr = framenr;
+  rframe->req_width = req_width;
+  rframe->req_height = req_height;
+  rframe->th_data = NULL;
+  rframe->isFromCache = TRUE;
+  rframe->cdata = cdata;
+
+  if(rahead == NULL)
+  {
+    p_free_rframe(rframe);
+    return;
+  }
+
+  g_mutex_lock(rahead->mutex);
+  if((rahead->stop)
+  || (rahead->req_width != req_width)
+  || (rahead->req_height != req_height)
+  || (!p_is_wanted(rahead, framenr))
+  || (p_find_rframe(rahead->offered, framenr, req_width, req_height) != NULL))
+  {
+    p_free_rframe(rframe);
+  }
+  else
+  {
+    rahead->offered = g_list_append(rahead->offered, rframe);
+    g_cond_broadcast(rahead->cond);
+  }
+  g_mutex_unlock(rahead->mutex);
+
+}  /* end gap_player_readahead_offer_cached */
+
+
+/* ---------------------------------
+ * gap_player_readahead_fetch
+ * ---------------------------------
+ * take the decoded frame framenr out of the ready list.
+ * returns NULL if the frame is not ready (no wait).
+ * flip_status is set only for frames that were delivered
+ * from the player cache (decoded frames are not flipped yet).
+ * The caller is responsible to g_free the returned data.
+ */
+guchar *
+gap_player_readahead_fetch(GapPlayerReadahead *rahead
+  , gint32 framenr
+  , gint32 req_width
+  , gint32 req_height
+  , gint32 *th_bpp
+  , gint32 *th_width
+  , gint32 *th_height
+  , gint32 *flip_status
+  )
+{
+  GList  *list;
+  guchar *th_data;
+
+  if(rahead == NULL)
+  {
+    return (NULL);
+  }
+
+  th_data = NULL;
+
+  g_mutex_lock(rahead->mutex);
+  list = p_find_ready(rahead, framenr, req_width, req_height);
+  if(list != NULL)
+  {
+    GapPlayerReadaheadFrame *rframe;
+
+    rframe = (GapPlayerReadaheadFrame *)list->data;
+    th_data = rframe->th_data;
+    *th_bpp = rframe->th_bpp;
+    *th_width = rframe->th_width;
+    *th_height = rframe->th_height;
+    if(rframe->isFromCache)
+    {
+      *flip_status = rframe->flip_status;
+    }
+    rframe->th_data = NULL;
+
+    rahead->ready = g_list_delete_link(rahead->ready, list);
+    rahead->readyCount--;
+    rahead->framesDelivered++;
+    p_free_rframe(rframe);
+
+    /* there is room in the ready list now */
+    g_cond_broadcast(rahead->cond);
+  }
+  g_mutex_unlock(rahead->mutex);
+
+  return (th_data);
+
+}  /* end gap_player_readahead_fetch */
+
+
+/* ---------------------------------
+ * gap_player_readahead_free
+ * ---------------------------------
+ * stop the producer thread (waits until it has finished the frame in work)
+ * close its videohandle and free all ready frames.
+ */
+void
+gap_player_readahead_free(GapPlayerReadahead *rahead)
+{
+  if(rahead == NULL)
+  {
+    return;
+  }
+
+  if(rahead->thread != NULL)
+  {
+    g_mutex_lock(rahead->mutex);
+    rahead->stop = TRUE;
+    g_cond_broadcast(rahead->cond);
+    g_mutex_unlock(rahead->mutex);
+
+    g_thread_join(rahead->thread);
+    rahead->thread = NULL;
+  }
+
+  if(gap_debug)
+  {
+    printf("gap_player_readahead_free: decoded:%d decompressed:%d delivered:%d discarded:%d\n"
+      , (int)rahead->framesDecoded
+      , (int)rahead->framesDecompressed
+      , (int)rahead->framesDelivered
+      , (int)(rahead->framesDiscarded + rahead->readyCount)
+      );
+  }
+
+  while(rahead->ready != NULL)
+  {
+    p_free_rframe((GapPlayerReadaheadFrame *)rahead->ready->data);
+    rahead->ready = g_list_delete_link(rahead->ready, rahead->ready);
+  }
+  while(rahead->offered != NULL)
+  {
+    p_free_rframe((GapPlayerReadaheadFrame *)rahead->offered->data);
+    rahead->offered = g_list_delete_link(rahead->offered, rahead->offered);
+  }
+
+  g_cond_free(rahead->cond);
+  g_mutex_free(rahead->mutex);
+  g_free(rahead->wanted);
+  g_free(rahead->videofile);
+  if(rahead->preferred_decoder)
+  {
+    g_free(rahead->preferred_decoder);
+  }
+  g_free(rahead);
+
+}  /* end gap_player_readahead_free */
@@ -0,0 +1,91 @@
+/*  gap_player_readahead.h
+ *
+ *  This module handles background read-ahead decoding of videoframes
+ *  for GAP video playback
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * version 2.7.0;   2026/10/18  created
+ */
+
+#ifndef _GAP_PLAYER_READAHEAD_H
+#define _GAP_PLAYER_READAHEAD_H
+
+#include "libgimp/gimp.h"
+#include "gap_player_cache.h"
+
+#define GAP_PLAYER_READAHEAD_GIMPRC_MAX_FRAMES    "video_player_readahead_frames"
+#define GAP_PLAYER_READAHEAD_DEFAULT_MAX_FRAMES   8
+#define GAP_PLAYER_READAHEAD_LIMIT_MAX_FRAMES     100
+
+typedef struct GapPlayerReadahead GapPlayerReadahead;  /* opaque, nickname: rahead */
+
+
+gint32                gap_player_readahead_get_gimprc_max_frames(void);
+
+GapPlayerReadahead *  gap_player_readahead_new(const char *videofile
+                          , gint32 seltrack
+                          , gdouble delace
+                          , const char *preferred_decoder
+                          , gint32 max_frames
+                          , gint32 fcache_size
+                          );
+gboolean              gap_player_readahead_is_for_video(GapPlayerReadahead *rahead
+                          , const char *videofile
+                          , gint32 seltrack
+                          , gdouble delace
+                          , const char *preferred_decoder
+                          );
+void                  gap_player_readahead_set_wanted(GapPlayerReadahead *rahead
+                          , const gint32 *framenrs
+                          , gint32 count
+                          , gint32 req_width
+                          , gint32 req_height
+                          , gboolean isBackwards
+                          );
+gboolean              gap_player_readahead_wait_until_ready(GapPlayerReadahead *rahead
+                          , gint32 framenr
+                          , gint32 req_width
+                          , gint32 req_height
+                          , gint32 timeout_millisecs
+                          );
+gboolean              gap_player_readahead_wants_cached(GapPlayerReadahead *rahead
+                          , gint32 framenr
+                          , gint32 req_width
+                          , gint32 req_height
+                          );
+void                  gap_player_readahead_offer_cached(GapPlayerReadahead *rahead
+                          , gint32 framenr
+                          , gint32 req_width
+                          , gint32 req_height
+                          , GapPlayerCacheData *cdata
+                          );
+guchar *              gap_player_readahead_fetch(GapPlayerReadahead *rahead
+                          , gint32 framenr
+                          , gint32 req_width
+                          , gint32 req_height
+                          , gint32 *th_bpp
+                          , gint32 *th_width
+                          , gint32 *th_height
+                          , gint32 *flip_status
+                          );
+void                  gap_player_readahead_free(GapPlayerReadahead *rahead);
+
+#endif
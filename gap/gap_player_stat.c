@@ -0,0 +1,538 @@
+/*  gap_player_stat.c
+ *
+ *  This module collects frame timing statistics for GAP video playback
+ *
+ */
+
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/* revision history:
+ * version 2.7.0;   2026/10/18  created
+ */
+
+/* The player collects statistics from playback start until playback stops.
+ * For each phase the durations are counted in fine bins of 0.1 millisecond
+ * (upto 1 second, longer durations go to an overflow bin).
+ * The p50/p99 values are taken from the fine bins (no samples are stored,
+ * the memory does not grow with the playback time)
+ * The printed histogram uses power of 2 millisecond buckets.
+ *
+ * The summary is printed to stdout on playback stop
+ * if gimprc parameter video_player_statistics is "yes",
+ * and appended to the file configured in video_player_statistics_file.
+ *
+ * all procedures shall be called from the main thread.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <glib/gstdio.h>
+
+#include <libgimp/gimp.h>
+
+#include "gap_libgapbase.h"
+#include "gap_player_stat.h"
+
+extern int gap_debug;  /* 1 == print debug infos , 0 dont print debug infos */
+
+
+#define GAP_PLAYER_STAT_BIN_MILLISECS   0.1
+#define GAP_PLAYER_STAT_NUM_BINS        10001     /* 10000 bins upto 1 sec + 1 overflow bin */
+#define GAP_PLAYER_STAT_NUM_BUCKETS     11        /* <1, 1-2, 2-4 ... 256-512, >=512 millisecs */
+
+typedef struct GapPlayerStatPhaseData {   /* nickname: phd */
+  guint32   count;
+  gdouble   sumMillisecs;
+  gdouble   maxMillisecs;
+  guint32  *bins;                          /* GAP_PLAYER_STAT_NUM_BINS */
+  guint32   buckets[GAP_PLAYER_STAT_NUM_BUCKETS];
+} GapPlayerStatPhaseData;
+
+struct GapPlayerStat {
+  GTimer   *timer;
+  gboolean  isActive;                      /* TRUE between start and stop */
+  gchar    *sourceName;
+  gdouble   targetFps;
+  gboolean  targetFpsChanged;
+  gint32    pvWidth;
+  gint32    pvHeight;
+  gdouble   startSecs;
+  gdouble   playbackSecs;
+
+  guint32   framesDisplayed;
+  guint32   framesLate;
+  guint32   framesDropped;
+
+  GapPlayerStatPhaseData phases[GAP_PLAYER_STAT_NUM_PHASES];
+
+  gboolean  printOnStop;
+  gchar    *exportFilename;
+};
+
+static const char *phaseNames[GAP_PLAYER_STAT_NUM_PHASES] =
+  { "fetch", "decode", "scale", "display", "frame" };
+
+static const char *bucketNames[GAP_PLAYER_STAT_NUM_BUCKETS] =
+  { "<1", "1-2", "2-4", "4-8", "8-16", "16-32", "32-64", "64-128", "128-256", "256-512", ">=512" };
+
+
+/* ---------------------------------
+ * p_reset_counters
+ * ---------------------------------
+ */
+static void
+p_reset_counters(GapPlayerStat *pstat)
+{
+  gint ii;
+
+  pstat->framesDisplayed = 0;
+  pstat->framesLate = 0;
+  pstat->framesDropped = 0;
+  pstat->playbackSecs = 0.0;
+
+  for(ii=0; ii < GAP_PLAYER_STAT_NUM_PHASES; ii++)
+  {
+    GapPlayerStatPhaseData *phd;
+
+    phd = &pstat->phases[ii];
+    phd->count = 0;
+    phd->sumMillisecs = 0.0;
+    phd->maxMillisecs = 0.0;
+    memset(phd->bins, 0, GAP_PLAYER_STAT_NUM_BINS * sizeof(guint32));
+    memset(phd->buckets, 0, sizeof(phd->buckets));
+  }
+}  /* end p_reset_counters */
+
+
+/* ---------------------------------
+ * p_percentile_millisecs
+ * ---------------------------------
+ * returns the duration that is not exceeded by the fraction
+ * percentile (0.0 upto 1.0) of all durations recorded for the phase.
+ * (the upper bound of the fine bin, or the maximum for the overflow bin)
+ */
+static gdouble
+p_percentile_millisecs(GapPlayerStatPhaseData *phd, gdouble percentile)
+{
+  guint32 wanted;
+  guint32 cumulated;
+  gint    ii;
+
+  if(phd->count == 0)
+  {
+    return (0.0);
+  }
+
+  wanted = MAX(1, (guint32)((percentile * (gdouble)phd->count) + 0.999999));
+  cumulated = 0;
+  for(ii=0; ii < GAP_PLAYER_STAT_NUM_BINS -1; ii++)
+  {
+    cumulated += phd->bins[ii];
+    if(cumulated >= wanted)
+    {
+      return (MIN(phd->maxMillisecs, (gdouble)(ii + 1) * GAP_PLAYER_STAT_BIN_MILLISECS));
+    }
+  }
+  return (phd->maxMillisecs);
+}  /* end p_percentile_millisecs */
+
+
+/* ---------------------------------
+ * gap_player_stat_new
+ * ---------------------------------
+ * create an (inactive) statistics collector
+ * and read the gimprc report options.
+ */
+GapPlayerStat *
+gap_player_stat_new(void)
+{
+  GapPlayerStat *pstat;
+  gchar         *value_string;
+  gint           ii;
+
+  pstat = g_new0(GapPlayerStat, 1);
+  pstat->timer = g_timer_new();
+  pstat->isActive = FALSE;
+  for(ii=0; ii < GAP_PLAYER_STAT_NUM_PHASES; ii++)
+  {
+    pstat->phases[ii].bins = g_new0(guint32, GAP_PLAYER_STAT_NUM_BINS);
+  }
+
+  pstat->printOnStop = FALSE;
+  value_string = gimp_gimprc_query(GAP_PLAYER_STAT_GIMPRC_PRINT);
+  if(value_string)
+  {
+    if ((*value_string == 'Y') || (*value_string == 'y'))
+    {
+      pstat->printOnStop = TRUE;
+    }
+    g_free(value_string);
+  }
+
+  pstat->exportFilename = NULL;
+  value_string = gimp_gimprc_query(GAP_PLAYER_STAT_GIMPRC_FILE);
+  if(value_string)
+  {
+    if(*value_string != '\0')
+    {
+      pstat->exportFilename = value_string;
+    }
+    else
+    {
+      g_free(value_string);
+    }
+  }
+
+  return (pstat);
+}  /* end gap_player_stat_new */
+
+
+/* ---------------------------------
+ * gap_player_stat_free
+ * ---------------------------------
+ */
+void
+gap_player_stat_free(GapPlayerStat *pstat)
+{
+  gint ii;
+
+  if(pstat == NULL)
+  {
+    return;
+  }
+  for(ii=0; ii < GAP_PLAYER_STAT_NUM_PHASES; ii++)
+  {
+    g_free(pstat->phases[ii].bins);
+  }
+  g_timer_destroy(pstat->timer);
+  if(pstat->sourceName)
+  {
+    g_free(pstat->sourceName);
+  }
+  if(pstat->exportFilename)
+  {
+    g_free(pstat->exportFilename);
+  }
+  g_free(pstat);
+}  /* end gap_player_stat_free */
+
+
+/* ---------------------------------
+ * gap_player_stat_start
+ * ---------------------------------
+ * reset all counters and start collecting (at playback start)
+ */
+void
+gap_player_stat_start(GapPlayerStat *pstat
+  , const char *source_name
+  , gdouble target_fps
+  , gint32 pv_width
+  , gint32 pv_height
+  )
+{
+  if(pstat == NULL)
+  {
+    return;
+  }
+
+  p_reset_counters(pstat);
+  if(pstat->sourceName)
+  {
+    g_free(pstat->sourceName);
+  }
+  pstat->sourceName = g_strdup((source_name != NULL) ? source_name : "");
+  pstat->targetFps = target_fps;
+  pstat->targetFpsChanged = FALSE;
+  pstat->pvWidth = pv_width;
+  pstat->pvHeight = pv_height;
+  pstat->startSecs = gap_player_stat_now(pstat);
+  pstat->isActive = TRUE;
+}  /* end gap_player_stat_start */
+
+
+/* ---------------------------------
+ * gap_player_stat_stop
+ * ---------------------------------
+ * stop collecting (at playback stop).
+ * returns FALSE if the collector was not active.
+ */
+gboolean
+gap_player_stat_stop(GapPlayerStat *pstat, gdouble target_fps)
+{
+  if((pstat == NULL) || (!pstat->isActive))
+  {
+    return (FALSE);
+  }
+
+  pstat->playbackSecs = gap_player_stat_now(pstat) - pstat->startSecs;
+  if(target_fps != pstat->targetFps)
+  {
+    /* speed was changed while playing, report the final speed */
+    pstat->targetFps = target_fps;
+    pstat->targetFpsChanged = TRUE;
+  }
+  pstat->isActive = FALSE;
+  return (TRUE);
+}  /* end gap_player_stat_stop */
+
+
+/* ---------------------------------
+ * gap_player_stat_now
+ * ---------------------------------
+ * returns the current time in seconds (for use as start_secs)
+ */
+gdouble
+gap_player_stat_now(GapPlayerStat *pstat)
+{
+  if(pstat == NULL)
+  {
+    return (0.0);
+  }
+  return (g_timer_elapsed(pstat->timer, NULL));
+}  /* end gap_player_stat_now */
+
+
+/* ---------------------------------
+ * gap_player_stat_add_since
+ * ---------------------------------
+ * record the duration from start_secs until now for the phase.
+ * returns now (for use as start_secs of the next phase)
+ */
+gdouble
+gap_player_stat_add_since(GapPlayerStat *pstat
+  , GapPlayerStatPhase phase
+  , gdouble start_secs
+  )
+{
+  GapPlayerStatPhaseData *phd;
+  gdouble  now;
+  gdouble  millisecs;
+  gint32   binIdx;
+  gint32   bucketIdx;
+  gdouble  bucketLimit;
+
+  if(pstat == NULL)
+  {
+    return (0.0);
+  }
+
+  now = gap_player_stat_now(pstat);
+  if((!pstat->isActive) || (phase < 0) || (phase >= GAP_PLAYER_STAT_NUM_PHASES))
+  {
+    return (now);
+  }
+
+  millisecs = MAX(0.0, (now - start_secs) * 1000.0);
+  phd = &pstat->phases[phase];
+  phd->count++;
+  phd->sumMillisecs += millisecs;
+  phd->maxMillisecs = MAX(phd->maxMillisecs, millisecs);
+
+  binIdx = MIN((gint32)(millisecs / GAP_PLAYER_STAT_BIN_MILLISECS), GAP_PLAYER_STAT_NUM_BINS -1);
+  phd->bins[binIdx]++;
+
+  bucketIdx = 0;
+  bucketLimit = 1.0;
+  while((bucketIdx < GAP_PLAYER_STAT_NUM_BUCKETS -1) && (millisecs >= bucketLimit))
+  {
+    bucketIdx++;
+    bucketLimit *= 2.0;
+  }
+  phd->buckets[bucketIdx]++;
+
+  return (now);
+}  /* end gap_player_stat_add_since */
+
+
+/* ---------------------------------
+ * gap_player_stat_count_displayed
+ * ---------------------------------
+ * count a displayed frame.
+ * isLate TRUE: the frame was displayed after the next frame was already due.
+ */
+void
+gap_player_stat_count_displayed(GapPlayerStat *pstat, gboolean isLate)
+{
+  if((pstat == NULL) || (!pstat->isActive))
+  {
+    return;
+  }
+  pstat->framesDisplayed++;
+  if(isLate)
+  {
+    pstat->framesLate++;
+  }
+}  /* end gap_player_stat_count_displayed */
+
+
+/* ---------------------------------
+ * gap_player_stat_count_dropped
+ * ---------------------------------
+ */
+void
+gap_player_stat_count_dropped(GapPlayerStat *pstat)
+{
+  if((pstat == NULL) || (!pstat->isActive))
+  {
+    return;
+  }
+  pstat->framesDropped++;
+}  /* end gap_player_stat_count_dropped */
+
+
+/* ---------------------------------
+ * gap_player_stat_print
+ * ---------------------------------
+ * print the summary of the last playback to fp.
+ * (all durations in milliseconds)
+ */
+void
+gap_player_stat_print(GapPlayerStat *pstat, FILE *fp)
+{
+  gint    ii;
+  gint    jj;
+  gdouble achievedFps;
+
+  if((pstat == NULL) || (fp == NULL))
+  {
+    return;
+  }
+
+  achievedFps = 0.0;
+  if(pstat->playbackSecs > 0.0)
+  {
+    achievedFps = (gdouble)pstat->framesDisplayed / pstat->playbackSecs;
+  }
+
+  fprintf(fp, "GAP player statistics (%s)\n", GAP_VERSION_WITH_DATE);
+  fprintf(fp, "  source:           %s\n", pstat->sourceName ? pstat->sourceName : "");
+  fprintf(fp, "  preview size:     %d x %d\n", (int)pstat->pvWidth, (int)pstat->pvHeight);
+  fprintf(fp, "  playback time:    %.3f secs\n", (float)pstat->playbackSecs);
+  fprintf(fp, "  target fps:       %.2f%s\n"
+         , (float)pstat->targetFps
+         , pstat->targetFpsChanged ? " (changed while playing)" : ""
+         );
+  fprintf(fp, "  achieved fps:     %.2f\n", (float)achievedFps);
+  fprintf(fp, "  frames displayed: %d  late: %d  dropped: %d\n"
+         , (int)pstat->framesDisplayed
+         , (int)pstat->framesLate
+         , (int)pstat->framesDropped
+         );
+
+  fprintf(fp, "  %-8s %8s %9s %9s %9s %9s\n"
+         , "phase", "calls", "avg ms", "p50 ms", "p99 ms", "max ms");
+  for(ii=0; ii < GAP_PLAYER_STAT_NUM_PHASES; ii++)
+  {
+    GapPlayerStatPhaseData *phd;
+
+    phd = &pstat->phases[ii];
+    fprintf(fp, "  %-8s %8d %9.2f %9.2f %9.2f %9.2f\n"
+         , phaseNames[ii]
+         , (int)phd->count
+         , (float)((phd->count > 0) ? (phd->sumMillisecs / (gdouble)phd->count) : 0.0)
+         , (float)p_percentile_millisecs(phd, 0.50)
+         , (float)p_percentile_millisecs(phd, 0.99)
+         , (float)phd->maxMillisecs
+         );
+  }
+
+  fprintf(fp, "  histogram (calls per duration range in ms)\n");
+  fprintf(fp, "  %-8s", "phase");
+  for(jj=0; jj < GAP_PLAYER_STAT_NUM_BUCKETS; jj++)
+  {
+    fprintf(fp, " %7s", bucketNames[jj]);
+  }
+  fprintf(fp, "\n");
+  for(ii=0; ii < GAP_PLAYER_STAT_NUM_PHASES; ii++)
+  {
+    fprintf(fp, "  %-8s", phaseNames[ii]);
+    for(jj=0; jj < GAP_PLAYER_STAT_NUM_BUCKETS; jj++)
+    {
+      fprintf(fp, " %7d", (int)pstat->phases[ii].buckets[jj]);
+    }
+    fprintf(fp, "\n");
+  }
+  fflush(fp);
+
+}  /* end gap_player_stat_print */
+
+
+/* ---------------------------------
+ * gap_player_stat_save
+ * ---------------------------------
+ * append the summary of the last playback
+ * (with a timestamp line) to the specified file.
+ * returns TRUE on success.
+ */
+gboolean
+gap_player_stat_save(GapPlayerStat *pstat, const char *filename)
+{
+  FILE   *fp;
+  time_t  now;
+  char    timeString[64];
+
+  if((pstat == NULL) || (filename == NULL))
+  {
+    return (FALSE);
+  }
+
+  fp = g_fopen(filename, "a");
+  if(fp == NULL)
+  {
+    printf("gap_player_stat_save: can not write statistics file:%s\n", filename);
+    return (FALSE);
+  }
+
+  now = time(NULL);
+  strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", localtime(&now));
+  fprintf(fp, "\n# %s\n", timeString);
+  gap_player_stat_print(pstat, fp);
+  fclose(fp);
+
+  return (TRUE);
+}  /* end gap_player_stat_save */
+
+
+/* ---------------------------------
+ * gap_player_stat_report
+ * ---------------------------------
+ * report the summary of the last playback as configured in gimprc
+ * (print to stdout and/or append to the export file).
+ * in debug mode the summary is always printed.
+ */
+void
+gap_player_stat_report(GapPlayerStat *pstat)
+{
+  if(pstat == NULL)
+  {
+    return;
+  }
+  if((pstat->printOnStop) || (gap_debug))
+  {
+    gap_player_stat_print(pstat, stdout);
+  }
+  if(pstat->exportFilename)
+  {
+    gap_player_stat_save(pstat, pstat->exportFilename);
+  }
+}  /* end gap_player_stat_report */
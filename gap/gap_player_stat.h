@@ -0,0 +1,78 @@
+/*  gap_player_stat.h
+ *
+ *  This module collects frame timing statistics for GAP video playback
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * version 2.7.0;   2026/10/18  created
+ */
+
+#ifndef _GAP_PLAYER_STAT_H
+#define _GAP_PLAYER_STAT_H
+
+#include <stdio.h>
+#include "libgimp/gimp.h"
+
+#define GAP_PLAYER_STAT_GIMPRC_PRINT     "video_player_statistics"
+#define GAP_PLAYER_STAT_GIMPRC_FILE      "video_player_statistics_file"
+
+/* the phases of displaying one frame
+ *   FETCH    get already decoded pixels from the player cache or the read-ahead
+ *   DECODE   read and decode from the source (videofile, image, thumbnail, storyboard render)
+ *   SCALE    scale to preview size and render into the preview widget
+ *   DISPLAY  cache insert, position widgets update and flush to the screen
+ *   FRAME    total time of one frame display (includes all phases above)
+ */
+typedef enum {
+    GAP_PLAYER_STAT_FETCH
+   ,GAP_PLAYER_STAT_DECODE
+   ,GAP_PLAYER_STAT_SCALE
+   ,GAP_PLAYER_STAT_DISPLAY
+   ,GAP_PLAYER_STAT_FRAME
+   ,GAP_PLAYER_STAT_NUM_PHASES
+  } GapPlayerStatPhase;
+
+typedef struct GapPlayerStat GapPlayerStat;  /* opaque, nickname: pstat */
+
+
+GapPlayerStat *  gap_player_stat_new(void);
+void             gap_player_stat_free(GapPlayerStat *pstat);
+
+void             gap_player_stat_start(GapPlayerStat *pstat
+                     , const char *source_name
+                     , gdouble target_fps
+                     , gint32 pv_width
+                     , gint32 pv_height
+                     );
+gboolean         gap_player_stat_stop(GapPlayerStat *pstat, gdouble target_fps);
+
+gdouble          gap_player_stat_now(GapPlayerStat *pstat);
+gdouble          gap_player_stat_add_since(GapPlayerStat *pstat
+                     , GapPlayerStatPhase phase
+                     , gdouble start_secs
+                     );
+void             gap_player_stat_count_displayed(GapPlayerStat *pstat, gboolean isLate);
+void             gap_player_stat_count_dropped(GapPlayerStat *pstat);
+
+void             gap_player_stat_print(GapPlayerStat *pstat, FILE *fp);
+gboolean         gap_player_stat_save(GapPlayerStat *pstat, const char *filename);
+void             gap_player_stat_report(GapPlayerStat *pstat);
+
+#endif
@@ -3052,11 +3052,8 @@ p_attw_movepath_file_entry_update_cb(GtkWidget *widget, GapStbAttrWidget *attw)
 
   p_attw_push_undo_and_set_unsaved_changes(attw);
 
-  if(attw->stb_elem_refptr->att_movepath_file_xml)
-  {
-    g_free(attw->stb_elem_refptr->att_movepath_file_xml);
-  }
-  attw->stb_elem_refptr->att_movepath_file_xml = g_strdup(gtk_entry_get_text(GTK_ENTRY(widget)));
+  gap_story_strpool_unref(attw->stb_elem_refptr->att_movepath_file_xml);
+  attw->stb_elem_refptr->att_movepath_file_xml = gap_story_strpool_ref(gtk_entry_get_text(GTK_ENTRY(widget)));
 
   p_attw_movepath_file_validity_check(attw);
 
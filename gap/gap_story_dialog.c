@@ -775,6 +775,8 @@ p_new_stb_tab_widgets(GapStbMainGlobalParams *sgpp, GapStoryMasterType type)
     tabw->undo_stack_list = NULL;
     tabw->undo_stack_ptr = NULL;
     tabw->undo_stack_group_counter = 0.0;
+    tabw->undo_stack_bytes = 0;
+    tabw->undo_stack_max_mb = -1;
 
     tabw->sgpp = sgpp;
 
@@ -1513,7 +1515,7 @@ p_story_set_range_cb(GapPlayerAddClip *plac_ptr)
         if(stb_elem)
         {
           gap_stb_undo_group_begin(tabw);
-          gap_stb_undo_push(tabw, GAP_STB_FEATURE_CREATE_CLIP);
+          gap_stb_undo_push_section(tabw, GAP_STB_FEATURE_CREATE_CLIP, stb_dst->active_section);
 
           gap_story_upd_elem_from_filename(stb_elem, plac_ptr->ainfo_ptr->old_filename);
           stb_elem->track = tabw->vtrack;
@@ -2632,7 +2634,7 @@ p_tabw_add_elem (GapStbTabWidgets *tabw, GapStbMainGlobalParams *sgpp, GapStoryB
   if(stb_elem)
   {
     gap_stb_undo_group_begin(tabw);
-    gap_stb_undo_push(tabw, GAP_STB_FEATURE_CREATE_CLIP);
+    gap_stb_undo_push_section(tabw, GAP_STB_FEATURE_CREATE_CLIP, stb_dst->active_section);
 
     gap_story_list_append_elem(stb_dst, stb_elem);
 
@@ -2676,7 +2678,7 @@ p_tabw_add_section_elem (GapStbTabWidgets *tabw, GapStbMainGlobalParams *sgpp, G
   l_nframes = gap_story_count_total_frames_in_section(referable_section);
 
   stb_elem = gap_story_new_elem(GAP_STBREC_VID_SECTION);
-  stb_elem->orig_filename = g_strdup(referable_section->section_name);
+  stb_elem->orig_filename = gap_story_strpool_ref(referable_section->section_name);
   stb_elem->track = tabw->vtrack;
   stb_elem->from_frame = 1;
   stb_elem->to_frame = l_nframes;
@@ -2685,7 +2687,7 @@ p_tabw_add_section_elem (GapStbTabWidgets *tabw, GapStbMainGlobalParams *sgpp, G
   if(stb_elem)
   {
     gap_stb_undo_group_begin(tabw);
-    gap_stb_undo_push(tabw, GAP_STB_FEATURE_CREATE_SECTION_CLIP);
+    gap_stb_undo_push_section(tabw, GAP_STB_FEATURE_CREATE_SECTION_CLIP, stb_dst->active_section);
 
     gap_story_list_append_elem(stb_dst, stb_elem);
 
@@ -2769,7 +2771,7 @@ p_tabw_add_att_elem (GapStbTabWidgets *tabw, GapStbMainGlobalParams *sgpp, GapSt
   if(stb_elem)
   {
     gap_stb_undo_group_begin(tabw);
-    gap_stb_undo_push(tabw, GAP_STB_FEATURE_CREATE_TRANSITION);
+    gap_stb_undo_push_section(tabw, GAP_STB_FEATURE_CREATE_TRANSITION, stb_dst->active_section);
 
     gap_story_list_append_elem(stb_dst, stb_elem);
 
@@ -10082,7 +10084,7 @@ p_create_stb_elem_from_filename (const char *filename, gint32 vtrack)
   }
 
   stb_elem = gap_story_new_elem(GAP_STBREC_VID_IMAGE);
-  stb_elem->orig_filename = g_strdup(filename);
+  stb_elem->orig_filename = gap_story_strpool_ref(filename);
   stb_elem->track = vtrack;
   stb_elem->from_frame = 1;
   stb_elem->to_frame = 1;
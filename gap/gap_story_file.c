@@ -24,6 +24,10 @@
  */
 
 /* revision history:
+ * version 2.7.0;   2026/10/18  the filename members of storyboard elements are
+ *                              shared via a refcounted string pool
+ *                              (parse, duplicate and copy reference them
+ *                              instead of g_strdup)
  * version 2.3.0;   2006/06/14  hof: added storyboard support for layer_masks,
  *                                   overlapping frames (are converted to shadow tracks at processing)
  *                                   and image flipping
@@ -69,12 +73,25 @@ extern int gap_debug;  /* 1 == print debug infos , 0 dont print debug infos */
     GAP_STB_DUPLICATE_NO_ELEMS
   } GapStoryDuplicateMode;
 
+  /* entry of the string pool, the key of the pool table is the str member */
+  typedef struct GapStoryPoolString
+  {
+    gint32   refCount;
+    char     str[1];      /* allocated with the length of the string */
+  } GapStoryPoolString;
+
 
 static gint32 global_stb_id = 0;
 static gint32 global_stb_elem_id = 0;
 static gint32 global_mask_name_number = 1000;
 static gint32 global_section_name_number = 1;
 
+/* refcounted pool of the filename strings of the storyboard elements
+ * (equal filenames of all loaded storyboards share one copy)
+ */
+static GHashTable   *global_stb_string_pool = NULL;
+static GStaticMutex  stbStringPoolMutex = G_STATIC_MUTEX_INIT;
+
 static const char *gtab_att_transition_key_words[GAP_STB_ATT_TYPES_ARRAY_MAX] =
        { GAP_STBKEY_VID_OPACITY
        , GAP_STBKEY_VID_MOVE_X
@@ -505,6 +522,8 @@ p_calculate_pingpong_framenr(gint32 framenr, gint32 rangesize, gdouble step_dens
 /* ------------------------------
  * p_dup_printable_stringprefix
  * ------------------------------
+ * duplicate up to length characters of str
+ * (stops at the terminating '\0' of shorter strings)
  */
 char *
 p_dup_printable_stringprefix(GapStoryBoard *stb, const char *str, gint32 length)
@@ -514,7 +533,7 @@ p_dup_printable_stringprefix(GapStoryBoard *stb, const char *str, gint32 length)
 
   l_dup_str = g_malloc0(length + 1);
 
-  for(ii=0; ii < length; ii++)
+  for(ii=0; (ii < length) && (str[ii] != '\0'); ii++)
   {
     if(g_ascii_isprint(str[ii]))
     {
@@ -668,6 +687,11 @@ gap_story_new_story_board(const char *filename)
     stb->warnline  = NULL;
     stb->count_unprintable_chars = 0;
 
+    stb->track_append_position = FALSE;
+    stb->append_section = NULL;
+    stb->append_tail = NULL;
+    stb->append_non_comment = NULL;
+
     stb->preferred_decoder  = NULL;
 
     stb->stb_parttype  = 0;
@@ -1229,6 +1253,117 @@ gap_story_filename_is_videofile(const char *filename)
 
 }  /* end gap_story_filename_is_videofile */
 
+
+/* --------------------------------
+ * gap_story_strpool_ref
+ * --------------------------------
+ * return the pooled copy of str (NULL if str is NULL)
+ * and increment its reference count.
+ * The filename members of GapStoryElem (orig_filename, basename, ext,
+ * filtermacro_file, colormask_file, preferred_decoder,
+ * att_movepath_file_xml, aud_filename) refer to pooled strings,
+ * they must not be modified in place and are released
+ * with gap_story_strpool_unref (not g_free).
+ */
+char *
+gap_story_strpool_ref(const char *str)
+{
+  GapStoryPoolString *poolString;
+
+  if(str == NULL)
+  {
+    return (NULL);
+  }
+
+  g_static_mutex_lock(&stbStringPoolMutex);
+  if(global_stb_string_pool == NULL)
+  {
+    global_stb_string_pool = g_hash_table_new_full(g_str_hash, g_str_equal
+                                , NULL     /* the key is part of the value */
+                                , g_free
+                                );
+  }
+
+  poolString = g_hash_table_lookup(global_stb_string_pool, str);
+  if(poolString == NULL)
+  {
+    gsize len;
+
+    len = strlen(str);
+    poolString = g_malloc(G_STRUCT_OFFSET(GapStoryPoolString, str) + len + 1);
+    poolString->refCount = 0;
+    memcpy(&poolString->str[0], str, len + 1);
+    g_hash_table_insert(global_stb_string_pool, &poolString->str[0], poolString);
+  }
+  poolString->refCount++;
+  g_static_mutex_unlock(&stbStringPoolMutex);
+
+  return (&poolString->str[0]);
+
+}  /* end gap_story_strpool_ref */
+
+
+/* --------------------------------
+ * gap_story_strpool_unref
+ * --------------------------------
+ * decrement the reference count of a pooled string
+ * and remove it from the pool when it is no longer referenced.
+ * A string that is not the pooled copy (e.g. assigned with g_strdup)
+ * is freed with g_free.
+ */
+void
+gap_story_strpool_unref(char *str)
+{
+  GapStoryPoolString *poolString;
+
+  if(str == NULL)
+  {
+    return;
+  }
+
+  poolString = NULL;
+  g_static_mutex_lock(&stbStringPoolMutex);
+  if(global_stb_string_pool != NULL)
+  {
+    poolString = g_hash_table_lookup(global_stb_string_pool, str);
+  }
+  if((poolString != NULL) && (&poolString->str[0] == str))
+  {
+    poolString->refCount--;
+    if(poolString->refCount <= 0)
+    {
+      g_hash_table_remove(global_stb_string_pool, str);
+    }
+    g_static_mutex_unlock(&stbStringPoolMutex);
+    return;
+  }
+  g_static_mutex_unlock(&stbStringPoolMutex);
+
+  g_free(str);
+
+}  /* end gap_story_strpool_unref */
+
+
+/* --------------------------------
+ * p_strpool_ref_and_free
+ * --------------------------------
+ * return the pooled copy of an allocated string and free the string.
+ */
+static char *
+p_strpool_ref_and_free(char *str)
+{
+  char *poolStr;
+
+  poolStr = gap_story_strpool_ref(str);
+  if(str)
+  {
+    g_free(str);
+  }
+  return (poolStr);
+
+}  /* end p_strpool_ref_and_free */
+
+
 /* --------------------------------
  * gap_story_upd_elem_from_filename
  * --------------------------------
@@ -1241,24 +1376,14 @@ gap_story_upd_elem_from_filename(GapStoryElem *stb_elem,  const char *filename)
   current_frame = -1;
 
   if(stb_elem == NULL) { return(current_frame); }
-  if(stb_elem->basename)
-  {
-    g_free(stb_elem->basename);
-  }
+  gap_story_strpool_unref(stb_elem->basename);
   stb_elem->basename = NULL;
 
-  if(stb_elem->ext)
-  {
-    g_free(stb_elem->ext);
-  }
+  gap_story_strpool_unref(stb_elem->ext);
   stb_elem->ext = NULL;
 
-
-  if(stb_elem->orig_filename)
-  {
-    g_free(stb_elem->orig_filename);
-  }
-  stb_elem->orig_filename = g_strdup(filename);
+  gap_story_strpool_unref(stb_elem->orig_filename);
+  stb_elem->orig_filename = gap_story_strpool_ref(filename);
 
   switch(stb_elem->record_type)
   {
@@ -1276,8 +1401,8 @@ gap_story_upd_elem_from_filename(GapStoryElem *stb_elem,  const char *filename)
   {
     long   l_number;
 
-    stb_elem->basename = gap_lib_alloc_basename(filename, &l_number);
-    stb_elem->ext = gap_lib_alloc_extension(filename);
+    stb_elem->basename = p_strpool_ref_and_free(gap_lib_alloc_basename(filename, &l_number));
+    stb_elem->ext = p_strpool_ref_and_free(gap_lib_alloc_extension(filename));
     if(gap_story_filename_is_videofile(filename))
     {
       stb_elem->record_type = GAP_STBREC_VID_MOVIE;
@@ -1304,19 +1429,21 @@ gap_story_upd_elem_from_filename(GapStoryElem *stb_elem,  const char *filename)
  * ----------------------------------------------------
  * free all strings that were allocated as members
  * of the passed Storyboard Element
+ * (and release the pooled filename strings)
  */
 static void
 p_free_stb_elem(GapStoryElem *stb_elem)
 {
-  if(stb_elem->orig_filename)          { g_free(stb_elem->orig_filename);}
+  gap_story_strpool_unref(stb_elem->orig_filename);
   if(stb_elem->orig_src_line)          { g_free(stb_elem->orig_src_line);}
-  if(stb_elem->basename)               { g_free(stb_elem->basename);}
-  if(stb_elem->ext)                    { g_free(stb_elem->ext);}
-  if(stb_elem->filtermacro_file)       { g_free(stb_elem->filtermacro_file);}
-  if(stb_elem->colormask_file)         { g_free(stb_elem->colormask_file);}
-  if(stb_elem->preferred_decoder)      { g_free(stb_elem->preferred_decoder);}
+  gap_story_strpool_unref(stb_elem->basename);
+  gap_story_strpool_unref(stb_elem->ext);
+  gap_story_strpool_unref(stb_elem->filtermacro_file);
+  gap_story_strpool_unref(stb_elem->colormask_file);
+  gap_story_strpool_unref(stb_elem->preferred_decoder);
   if(stb_elem->mask_name)              { g_free(stb_elem->mask_name);}
-  if(stb_elem->att_movepath_file_xml)  { g_free(stb_elem->att_movepath_file_xml);}
+  gap_story_strpool_unref(stb_elem->att_movepath_file_xml);
+  gap_story_strpool_unref(stb_elem->aud_filename);
 }  /* end p_free_stb_elem */
 
 
@@ -1526,6 +1653,56 @@ gap_story_free_storyboard(GapStoryBoard **stb_ptr)
 
 
 
+/* ----------------------------------------------------
+ * p_set_track_append_position
+ * ----------------------------------------------------
+ * enable (or disable) tracking of the append position.
+ * This is only enabled while the element lists of stb are built up
+ * by appending (gap_story_parse, p_story_board_duplicate),
+ * where no other procedure removes or inserts elements.
+ */
+static void
+p_set_track_append_position(GapStoryBoard *stb, gboolean enable)
+{
+  stb->track_append_position = enable;
+  stb->append_section = NULL;
+  stb->append_tail = NULL;
+  stb->append_non_comment = NULL;
+}  /* end p_set_track_append_position */
+
+
+/* ----------------------------------------------------
+ * p_update_append_position
+ * ----------------------------------------------------
+ * record the end of the list and the last non comment element
+ * after the appended stb_elem (that can be a single element or list).
+ * non_comment is the last non comment element in front of stb_elem.
+ */
+static void
+p_update_append_position(GapStoryBoard *stb, GapStorySection *active_section
+  , GapStoryElem *stb_elem, GapStoryElem *non_comment)
+{
+  GapStoryElem *stb_listend;
+
+  stb_listend = stb_elem;
+  while(stb_listend != NULL)
+  {
+    if(stb_listend->record_type != GAP_STBREC_VID_COMMENT)
+    {
+      non_comment = stb_listend;
+    }
+    if(stb_listend->next == NULL)
+    {
+      break;
+    }
+    stb_listend = (GapStoryElem *)stb_listend->next;
+  }
+  stb->append_section = active_section;
+  stb->append_tail = stb_listend;
+  stb->append_non_comment = non_comment;
+}  /* end p_update_append_position */
+
+
 /* ----------------------------------------------------
  * gap_story_list_append_elem
  * ----------------------------------------------------
@@ -1553,6 +1730,7 @@ gap_story_list_append_elem(GapStoryBoard *stb, GapStoryElem *stb_elem)
  * the comment-tail is cut off the existing list
  * and assigned to the comment pointer of the new element.
  * In both cases the new element will be the last in the active_section->stb_elem list
+ * (the list is not walked while stb tracks the append position for this section)
  */
 void
 gap_story_list_append_elem_at_section(GapStoryBoard *stb, GapStoryElem *stb_elem
@@ -1594,20 +1772,34 @@ gap_story_list_append_elem_at_section(GapStoryBoard *stb, GapStoryElem *stb_elem
      {
        /* 1. element (or returned list) starts the list */
        active_section->stb_elem = stb_elem;
+       if(stb->track_append_position)
+       {
+         p_update_append_position(stb, active_section, stb_elem, NULL);
+       }
      }
      else
      {
        /* link stb_elem (that can be a single ement or list) to the end of elem list
         * in the specified active section
         */
-       stb_listend = active_section->stb_elem;
-       while(stb_listend->next != NULL)
+       if((stb->track_append_position)
+       && (stb->append_section == active_section)
+       && (stb->append_tail != NULL))
        {
-          if(stb_listend->record_type != GAP_STBREC_VID_COMMENT)
-          {
-            stb_non_comment = stb_listend;
-          }
-          stb_listend = (GapStoryElem *)stb_listend->next;
+         stb_listend = stb->append_tail;
+         stb_non_comment = stb->append_non_comment;
+       }
+       else
+       {
+         stb_listend = active_section->stb_elem;
+         while(stb_listend->next != NULL)
+         {
+            if(stb_listend->record_type != GAP_STBREC_VID_COMMENT)
+            {
+              stb_non_comment = stb_listend;
+            }
+            stb_listend = (GapStoryElem *)stb_listend->next;
+         }
        }
        if((stb_listend->record_type == GAP_STBREC_VID_COMMENT)
        && (stb_elem->record_type != GAP_STBREC_VID_COMMENT))
@@ -1653,6 +1845,14 @@ gap_story_list_append_elem_at_section(GapStoryBoard *stb, GapStoryElem *stb_elem
        else
        {
          stb_listend->next = (GapStoryElem *)stb_elem;
+         if(stb_listend->record_type != GAP_STBREC_VID_COMMENT)
+         {
+           stb_non_comment = stb_listend;
+         }
+       }
+       if(stb->track_append_position)
+       {
+         p_update_append_position(stb, active_section, stb_elem, stb_non_comment);
        }
      }
   }
@@ -1669,6 +1869,17 @@ p_get_last_non_comment_elem(GapStoryBoard *stb, gint32 in_track, GapStorySection
   GapStoryElem *stb_elem_non_comment;
   GapStoryElem *stb_elem;
 
+  if((stb->track_append_position)
+  && (stb->append_section == active_section)
+  && (stb->append_non_comment != NULL))
+  {
+    if(stb->append_non_comment->track == in_track)
+    {
+      /* the last non comment element of the list is in the requested track */
+      return (stb->append_non_comment);
+    }
+  }
+
   stb_elem_non_comment = NULL;
   for(stb_elem = active_section->stb_elem; stb_elem != NULL; stb_elem = (GapStoryElem *)stb_elem->next)
   {
@@ -2888,8 +3099,8 @@ p_assign_parsed_video_values(GapStoryElem *stb_elem
   {
     if(*macro_ptr)
     {
-      stb_elem->filtermacro_file = g_strdup(macro_ptr);
-      p_flip_dir_separators(stb_elem->filtermacro_file);
+      p_flip_dir_separators(macro_ptr);
+      stb_elem->filtermacro_file = gap_story_strpool_ref(macro_ptr);
     }
   }
 
@@ -2898,8 +3109,8 @@ p_assign_parsed_video_values(GapStoryElem *stb_elem
   {
     if(*colormask_file_ptr)
     {
-      stb_elem->colormask_file = g_strdup(colormask_file_ptr);
-      p_flip_dir_separators(stb_elem->colormask_file);
+      p_flip_dir_separators(colormask_file_ptr);
+      stb_elem->colormask_file = gap_story_strpool_ref(colormask_file_ptr);
     }
   }
 
@@ -3035,6 +3246,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
   char *l_record_key;
   char *l_parname;
   char *l_wordval[GAP_MAX_STB_PARAMS_PER_LINE];
+  char  l_empty_string[1];
   gint ii;
   GapStoryElem *stb_elem;
 
@@ -3048,14 +3260,17 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
   stb->curr_nr = longlinenr;
 
 
-  /* clear array of values */
+  /* clear array of values
+   * (unused values refer to l_empty_string, the fetched values
+   * are owned by the array and are freed at cleanup)
+   */
+  l_empty_string[0] = '\0';
   for(ii=0; ii < GAP_MAX_STB_PARAMS_PER_LINE; ii++)
   {
-    l_wordval[ii] = g_strdup("\0");
+    l_wordval[ii] = &l_empty_string[0];
   }
 
   /* get the record key (1.st space separated word) */
-  g_free(l_wordval[0]);
   l_wordval[0]    = p_fetch_string(&l_scan_ptr, &l_parname);
   l_record_key = l_wordval[0];
   if(l_parname)
@@ -3098,6 +3313,11 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
     gchar *l_value;
     gint   l_key_idx;
 
+    if(*l_scan_ptr == '\0')
+    {
+      /* end of line reached, all further parameters are empty */
+      break;
+    }
     if((gap_debug) && (1==0))
     {
       printf("\n%s   ii:%d\n", l_record_key, (int)ii);
@@ -3136,8 +3356,8 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
           }
           else
           {
-            g_free(l_wordval[l_key_idx]);
-            l_wordval[l_key_idx] = g_strdup(l_value);
+            l_wordval[l_key_idx] = l_value;
+            l_value = NULL;
           }
         }
         else
@@ -3148,12 +3368,15 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
           }
           else
           {
-            g_free(l_wordval[ii]);
-            l_wordval[ii] = g_strdup(l_value);
+            l_wordval[ii] = l_value;
+            l_value = NULL;
           }
         }
       }
-      g_free(l_value);
+      if(l_value)
+      {
+        g_free(l_value);
+      }
     }
     /* if(gap_debug) printf("%s   ii:%d (END)\n", l_record_key, (int)ii); */
   }
@@ -3372,7 +3595,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
         if(*l_to_ptr)       { stb_elem->att_arr_value_to[ii]    = p_scan_gdouble(l_to_ptr,   0.0, 10000.0, stb); }
         else                { stb_elem->att_arr_value_to[ii]    = stb_elem->att_arr_value_from[ii]; }
         if(*l_dur_ptr)      { stb_elem->att_arr_value_dur[ii]   = p_scan_gint32(l_dur_ptr,  0, 10000, stb); }
-        if(*l_xml_ptr)      { stb_elem->att_movepath_file_xml   = g_strdup(l_xml_ptr); }
+        if(*l_xml_ptr)      { stb_elem->att_movepath_file_xml   = gap_story_strpool_ref(l_xml_ptr); }
         else                { stb_elem->att_arr_enable[ii] = FALSE; }
 
         p_assign_accel_attr(stb_elem, stb, l_accel_ptr, ii);
@@ -3705,7 +3928,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       stb_elem->orig_src_line = g_strdup(multi_lines);
 
       if(*l_filename_ptr) { p_flip_dir_separators(l_filename_ptr);
-                            stb_elem->orig_filename = g_strdup(l_filename_ptr);
+                            stb_elem->orig_filename = gap_story_strpool_ref(l_filename_ptr);
                           }
       if(*l_track_ptr)    { stb_elem->track = p_scan_gint32(l_track_ptr,  1, GAP_STB_MAX_VID_TRACKS,  stb); }
       p_assign_parsed_video_values(stb_elem, stb
@@ -3763,10 +3986,10 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       if(*l_from_ptr)     { stb_elem->from_frame = p_scan_gint32(l_from_ptr,    0, GAP_STB_MAX_FRAMENR, stb); }
       if(*l_to_ptr)       { stb_elem->to_frame   = p_scan_gint32(l_to_ptr,      0, GAP_STB_MAX_FRAMENR, stb); }
       if(*l_basename_ptr) { p_flip_dir_separators(l_basename_ptr);
-                            stb_elem->basename = g_strdup(l_basename_ptr);
+                            stb_elem->basename = gap_story_strpool_ref(l_basename_ptr);
                           }
-      if(*l_ext_ptr)      { if(*l_ext_ptr == '.') stb_elem->ext = g_strdup(l_ext_ptr);
-                            else                  stb_elem->ext = g_strdup_printf(".%s", l_ext_ptr);
+      if(*l_ext_ptr)      { if(*l_ext_ptr == '.') stb_elem->ext = gap_story_strpool_ref(l_ext_ptr);
+                            else                  stb_elem->ext = p_strpool_ref_and_free(g_strdup_printf(".%s", l_ext_ptr));
                           }
 
       p_assign_parsed_video_values(stb_elem, stb
@@ -3788,10 +4011,10 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       && (*l_from_ptr)
       && (*l_ext_ptr))
       {
-        stb_elem->orig_filename = gap_lib_alloc_fname(stb_elem->basename
+        stb_elem->orig_filename = p_strpool_ref_and_free(gap_lib_alloc_fname(stb_elem->basename
                                                      ,stb_elem->from_frame
                                                      ,stb_elem->ext
-                                                     );
+                                                     ));
       }
 
       gap_story_list_append_elem(stb, stb_elem);
@@ -3833,7 +4056,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
 
       if(*l_track_ptr)    { stb_elem->track      = p_scan_gint32(l_track_ptr, 1, GAP_STB_MAX_VID_TRACKS, stb); }
       if(*l_filename_ptr) { p_flip_dir_separators(l_filename_ptr);
-                            stb_elem->orig_filename = g_strdup(l_filename_ptr);
+                            stb_elem->orig_filename = gap_story_strpool_ref(l_filename_ptr);
                           }
       if(*l_from_ptr)     { stb_elem->from_frame = p_scan_gint32(l_from_ptr,    1, GAP_STB_MAX_FRAMENR, stb); }
       if(*l_to_ptr)       { stb_elem->to_frame   = p_scan_gint32(l_to_ptr,      1, GAP_STB_MAX_FRAMENR, stb); }
@@ -3841,7 +4064,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       if(*l_seltrack_ptr)   { stb_elem->seltrack     = p_scan_gint32(l_seltrack_ptr,  1, 999999, stb); }
       if(*l_exact_seek_ptr) { stb_elem->exact_seek   = p_scan_gint32(l_exact_seek_ptr,  0, 1, stb); }
       if(*l_delace_ptr)     { stb_elem->delace       = p_scan_gdouble(l_delace_ptr, 0.0, GAP_DELACE_MAX, stb); }
-      if(*l_decoder_ptr)    { stb_elem->preferred_decoder = g_strdup(l_decoder_ptr);
+      if(*l_decoder_ptr)    { stb_elem->preferred_decoder = gap_story_strpool_ref(l_decoder_ptr);
                             }
 
       p_assign_parsed_video_values(stb_elem, stb
@@ -3914,7 +4137,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       stb_elem->orig_src_line = g_strdup(multi_lines);
 
       if(*l_track_ptr)    { stb_elem->track      = p_scan_gint32(l_track_ptr, 1, GAP_STB_MAX_VID_TRACKS, stb); }
-      if(*l_section_ptr)  { stb_elem->orig_filename = g_strdup(l_section_ptr);
+      if(*l_section_ptr)  { stb_elem->orig_filename = gap_story_strpool_ref(l_section_ptr);
                           }
       if(*l_from_ptr)     { stb_elem->from_frame = p_scan_gint32(l_from_ptr,    1, GAP_STB_MAX_FRAMENR, stb); }
       if(*l_to_ptr)       { stb_elem->to_frame   = p_scan_gint32(l_to_ptr,      1, GAP_STB_MAX_FRAMENR, stb); }
@@ -4022,7 +4245,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       stb_elem->orig_src_line = g_strdup(multi_lines);
       if(*l_track_ptr)    { stb_elem->track      = p_scan_gint32(l_track_ptr, 1, GAP_STB_MAX_VID_TRACKS, stb); }
       if(*l_filename_ptr) { p_flip_dir_separators(l_filename_ptr);
-                            stb_elem->orig_filename = g_strdup(l_filename_ptr);
+                            stb_elem->orig_filename = gap_story_strpool_ref(l_filename_ptr);
                           }
       if(*l_from_ptr)     { stb_elem->from_frame = p_scan_gint32(l_from_ptr,    0, GAP_STB_MAX_FRAMENR, stb); }
       if(*l_to_ptr)       { stb_elem->to_frame   = p_scan_gint32(l_to_ptr,      0, GAP_STB_MAX_FRAMENR, stb); }
@@ -4120,8 +4343,8 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       stb_elem->aud_play_to_sec = 9999.9;  /* 9999.9 is default for end of audiofile */
       if(*l_track_ptr)        { stb_elem->track      = p_scan_gint32(l_track_ptr,   1, GAP_STB_MAX_AUD_TRACKS,    stb); }
       if(*l_filename_ptr)     { p_flip_dir_separators(l_filename_ptr);
-                                stb_elem->aud_filename = g_strdup(l_filename_ptr);
-                                stb_elem->orig_filename = g_strdup(l_filename_ptr);
+                                stb_elem->aud_filename = gap_story_strpool_ref(l_filename_ptr);
+                                stb_elem->orig_filename = gap_story_strpool_ref(l_filename_ptr);
                               }
       if(*l_from_sec_ptr)     { stb_elem->aud_play_from_sec = p_scan_gdouble(l_from_sec_ptr,     0.0, 9999.9, stb); }
       if(*l_to_sec_ptr)       { stb_elem->aud_play_to_sec   = p_scan_gdouble(l_to_sec_ptr,       0.0, 9999.9, stb); }
@@ -4177,8 +4400,8 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       stb_elem->aud_play_to_sec = 9999.9;  /* 9999.9 is default for end of audiofile */
       if(*l_track_ptr)        { stb_elem->track      = p_scan_gint32(l_track_ptr,   1, GAP_STB_MAX_AUD_TRACKS,    stb); }
       if(*l_filename_ptr)     { p_flip_dir_separators(l_filename_ptr);
-                                stb_elem->aud_filename = g_strdup(l_filename_ptr);
-                                stb_elem->orig_filename = g_strdup(l_filename_ptr);
+                                stb_elem->aud_filename = gap_story_strpool_ref(l_filename_ptr);
+                                stb_elem->orig_filename = gap_story_strpool_ref(l_filename_ptr);
                               }
       if(*l_from_sec_ptr)     { stb_elem->aud_play_from_sec = p_scan_gdouble(l_from_sec_ptr,     0.0, 9999.9, stb); }
       if(*l_to_sec_ptr)       { stb_elem->aud_play_to_sec   = p_scan_gdouble(l_to_sec_ptr,       0.0, 9999.9, stb); }
@@ -4189,7 +4412,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       if(*l_fade_out_sec_ptr) { stb_elem->aud_fade_out_sec  = p_scan_gdouble(l_fade_out_sec_ptr, 0.0, 9999.9, stb); }
       if(*l_nloops_ptr)       { stb_elem->nloop             = p_scan_gint32(l_nloops_ptr,    1, 999999, stb); }
       if(*l_seltrack_ptr)     { stb_elem->aud_seltrack      = p_scan_gint32(l_seltrack_ptr,  1, 999999, stb); }
-      if(*l_decoder_ptr)      { stb_elem->preferred_decoder = g_strdup(l_decoder_ptr);
+      if(*l_decoder_ptr)      { stb_elem->preferred_decoder = gap_story_strpool_ref(l_decoder_ptr);
                               }
 
       /* optional positioning in unit frames */
@@ -4258,7 +4481,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       stb_elem->orig_src_line = g_strdup(multi_lines);
 
       if(*l_filename_ptr)  { p_flip_dir_separators(l_filename_ptr);
-                             stb_elem->orig_filename = g_strdup(l_filename_ptr);
+                             stb_elem->orig_filename = gap_story_strpool_ref(l_filename_ptr);
                            }
       if(*l_mask_name_ptr) { stb_elem->mask_name = g_strdup(l_mask_name_ptr); }
 
@@ -4295,19 +4518,19 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       if(*l_from_ptr)      { stb_elem->from_frame = p_scan_gint32(l_from_ptr,    0, GAP_STB_MAX_FRAMENR, stb); }
       if(*l_to_ptr)        { stb_elem->to_frame   = p_scan_gint32(l_to_ptr,      0, GAP_STB_MAX_FRAMENR, stb); }
       if(*l_basename_ptr)  { p_flip_dir_separators(l_basename_ptr);
-                             stb_elem->basename = g_strdup(l_basename_ptr);
+                             stb_elem->basename = gap_story_strpool_ref(l_basename_ptr);
                            }
-      if(*l_ext_ptr)       { if(*l_ext_ptr == '.') stb_elem->ext = g_strdup(l_ext_ptr);
-                             else                  stb_elem->ext = g_strdup_printf(".%s", l_ext_ptr);
+      if(*l_ext_ptr)       { if(*l_ext_ptr == '.') stb_elem->ext = gap_story_strpool_ref(l_ext_ptr);
+                             else                  stb_elem->ext = p_strpool_ref_and_free(g_strdup_printf(".%s", l_ext_ptr));
                            }
       if((*l_basename_ptr)
       && (*l_from_ptr)
       && (*l_ext_ptr))
       {
-        stb_elem->orig_filename = gap_lib_alloc_fname(stb_elem->basename
+        stb_elem->orig_filename = p_strpool_ref_and_free(gap_lib_alloc_fname(stb_elem->basename
                                                      ,stb_elem->from_frame
                                                      ,stb_elem->ext
-                                                     );
+                                                     ));
       }
 
       p_assign_parsed_flip_value(stb_elem, l_flip_ptr);
@@ -4342,7 +4565,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
 
       if(*l_mask_name_ptr)  { stb_elem->mask_name = g_strdup(l_mask_name_ptr); }
       if(*l_filename_ptr)   { p_flip_dir_separators(l_filename_ptr);
-                              stb_elem->orig_filename = g_strdup(l_filename_ptr);
+                              stb_elem->orig_filename = gap_story_strpool_ref(l_filename_ptr);
                             }
       if(*l_from_ptr)       { stb_elem->from_frame = p_scan_gint32(l_from_ptr,    1, GAP_STB_MAX_FRAMENR, stb); }
       if(*l_to_ptr)         { stb_elem->to_frame   = p_scan_gint32(l_to_ptr,      1, GAP_STB_MAX_FRAMENR, stb); }
@@ -4351,7 +4574,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       if(*l_exact_seek_ptr) { stb_elem->exact_seek   = p_scan_gint32(l_exact_seek_ptr,  0, 1, stb); }
       if(*l_delace_ptr)     { stb_elem->delace       = p_scan_gdouble(l_delace_ptr, 0.0, GAP_DELACE_MAX, stb); }
 
-      if(*l_decoder_ptr)    { stb_elem->preferred_decoder = g_strdup(l_decoder_ptr);
+      if(*l_decoder_ptr)    { stb_elem->preferred_decoder = gap_story_strpool_ref(l_decoder_ptr);
                             }
 
       p_assign_parsed_flip_value(stb_elem, l_flip_ptr);
@@ -4381,7 +4604,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
       stb_elem->orig_src_line = g_strdup(multi_lines);
       if(*l_mask_name_ptr) { stb_elem->mask_name = g_strdup(l_mask_name_ptr); }
       if(*l_filename_ptr)  { p_flip_dir_separators(l_filename_ptr);
-                             stb_elem->orig_filename = g_strdup(l_filename_ptr);
+                             stb_elem->orig_filename = gap_story_strpool_ref(l_filename_ptr);
                            }
       if(*l_from_ptr)      { stb_elem->from_frame = p_scan_gint32(l_from_ptr,    0, GAP_STB_MAX_FRAMENR, stb); }
       if(*l_to_ptr)        { stb_elem->to_frame   = p_scan_gint32(l_to_ptr,      0, GAP_STB_MAX_FRAMENR, stb); }
@@ -4444,7 +4667,7 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
         if(stb_elem)
         {
           stb_elem->file_line_nr = longlinenr;
-          stb_elem->orig_filename = g_strdup(l_record_key);
+          stb_elem->orig_filename = gap_story_strpool_ref(l_record_key);
           stb_elem->orig_src_line = g_strdup(multi_lines);
 
           p_check_image_numpart(stb_elem, l_filename_ptr);
@@ -4491,7 +4714,10 @@ p_story_parse_line(GapStoryBoard *stb, char *longline
 cleanup:
   for(ii=0; ii < GAP_MAX_STB_PARAMS_PER_LINE; ii++)
   {
-    g_free(l_wordval[ii]);
+    if(l_wordval[ii] != &l_empty_string[0])
+    {
+      g_free(l_wordval[ii]);
+    }
     l_wordval[ii] = NULL;
   }
 
@@ -4541,9 +4767,13 @@ p_stb_is_empty_in_all_sections(GapStoryBoard *stb)
 GapStoryBoard *
 gap_story_parse(const gchar *filename)
 {
-  GapValTextFileLines *txf_ptr_root;
-  GapValTextFileLines *txf_ptr;
+  GMappedFile *mapped;
+  const gchar *contents;
+  gsize length;
+  gsize offset;
+  GString *line_buf;
   GapStoryBoard *stb;
+  gchar *line;
   gchar *longline;
   gchar *multi_lines;
   gint32 longlinenr;
@@ -4554,7 +4784,27 @@ gap_story_parse(const gchar *filename)
   {
     return (NULL);
   }
-  txf_ptr_root = gap_val_load_textfile(filename);
+  p_set_track_append_position(stb, TRUE);
+
+  /* the file is memory mapped and split into lines in place,
+   * each line is copied into one reused line buffer for parsing.
+   */
+  contents = NULL;
+  length = 0;
+  mapped = NULL;
+  if(filename != NULL)
+  {
+    mapped = g_mapped_file_new(filename, FALSE, NULL);
+  }
+  if(mapped != NULL)
+  {
+    contents = g_mapped_file_get_contents(mapped);
+    length = g_mapped_file_get_length(mapped);
+    if(contents == NULL)
+    {
+      length = 0;
+    }
+  }
 
   /* when loading from file assume the old behaviour
    * where highest video track is on top.
@@ -4563,57 +4813,80 @@ gap_story_parse(const gchar *filename)
   stb->master_vtrack1_is_toplayer = FALSE;
 
 
+  line_buf = g_string_sized_new(1024);
   longline = NULL;
   multi_lines = NULL;
   longlinenr = 0;
   line_nr = 0;
-  for(txf_ptr = txf_ptr_root; txf_ptr != NULL; txf_ptr = (GapValTextFileLines *) txf_ptr->next)
+  offset = 0;
+  while(offset < length)
   {
+    const gchar *line_start;
+    const gchar *line_end;
     gint l_len;
 
+    line_start = contents + offset;
+    line_end = memchr(line_start, '\n', length - offset);
+    if(line_end == NULL)
+    {
+      line_end = contents + length;
+    }
+    offset = (line_end - contents) + 1;
+
+    g_string_truncate(line_buf, 0);
+    g_string_append_len(line_buf, line_start, line_end - line_start);
+    line = line_buf->str;
+
     line_nr++;
     if(gap_debug)
     {
       printf("line_nr: %d\n", (int)line_nr);
     }
 
-    gap_file_chop_trailingspace_and_nl(&txf_ptr->line[0]);
-    l_len = strlen(txf_ptr->line);
+    gap_file_chop_trailingspace_and_nl(line);
+    l_len = strlen(line);
 
     if(gap_debug)
     {
-      printf("line:%s:\n", txf_ptr->line);
+      printf("line:%s:\n", line);
     }
 
-    /* concatenate long lines */
-    if(multi_lines == NULL)
-    {
-      multi_lines = g_strdup(txf_ptr->line);
-    }
-    else
+    /* concatenate long lines
+     * (multi_lines is only built for lines that are continued
+     * with backslash, a single line is passed as it is)
+     */
+    if((multi_lines != NULL)
+    || ((l_len > 0) && (line[l_len-1] == '\\')))
     {
-      gchar *l_ml;
+      if(multi_lines == NULL)
+      {
+        multi_lines = g_strdup(line);
+      }
+      else
+      {
+        gchar *l_ml;
 
-      l_ml = g_strdup_printf("%s\n%s", multi_lines, txf_ptr->line);
-      g_free(multi_lines);
-      multi_lines = l_ml;
+        l_ml = g_strdup_printf("%s\n%s", multi_lines, line);
+        g_free(multi_lines);
+        multi_lines = l_ml;
+      }
     }
 
     /* handle long lines with backslash at line end
      * concatenate those lines with blank inbetween for
      * the following syntax check.
      */
-    if (txf_ptr->line[l_len-1] == '\\')
+    if ((l_len > 0) && (line[l_len-1] == '\\'))
     {
       if(longline == NULL)
       {
-        longline = g_strdup(txf_ptr->line);
+        longline = g_strdup(line);
       }
       else
       {
         char *l_line;
 
-        l_line = g_strdup_printf("%s %s", longline, txf_ptr->line);
+        l_line = g_strdup_printf("%s %s", longline, line);
         g_free(longline);
         longline = l_line;
       }
@@ -4626,13 +4899,13 @@ gap_story_parse(const gchar *filename)
     {
       if(longline == NULL)
       {
-        p_story_parse_line(stb, txf_ptr->line, line_nr, multi_lines);
+        p_story_parse_line(stb, line, line_nr, line);
       }
       else
       {
         char *l_line;
 
-        l_line = g_strdup_printf("%s %s", longline, txf_ptr->line);
+        l_line = g_strdup_printf("%s %s", longline, line);
         g_free(longline);
         longline = NULL;
         p_story_parse_line(stb, l_line, longlinenr, multi_lines);
@@ -4649,15 +4922,22 @@ gap_story_parse(const gchar *filename)
   if(longline)
   {
     p_story_parse_line(stb, longline, longlinenr, multi_lines);
+    g_free(longline);
     if(multi_lines)
     {
         g_free(multi_lines);
     }
   }
 
-  if(txf_ptr_root)
+  p_set_track_append_position(stb, FALSE);
+  g_string_free(line_buf, TRUE);
+  if(mapped != NULL)
   {
-    gap_val_free_textfile_lines(txf_ptr_root);
+#if GLIB_CHECK_VERSION(2, 22, 0)
+    g_mapped_file_unref(mapped);
+#else
+    g_mapped_file_free(mapped);
+#endif
   }
 
 
@@ -6968,14 +7248,14 @@ gap_story_elem_duplicate(GapStoryElem      *stb_elem)
     stb_elem_dup->story_orig_id   = stb_elem->story_id;
     stb_elem_dup->playmode        = stb_elem->playmode;
     stb_elem_dup->track           = stb_elem->track;
-    if(stb_elem->orig_filename)     stb_elem_dup->orig_filename     = g_strdup(stb_elem->orig_filename);
+    stb_elem_dup->orig_filename     = gap_story_strpool_ref(stb_elem->orig_filename);
     if(stb_elem->orig_src_line)     stb_elem_dup->orig_src_line     = g_strdup(stb_elem->orig_src_line);
-    if(stb_elem->basename)          stb_elem_dup->basename          = g_strdup(stb_elem->basename);
-    if(stb_elem->ext)               stb_elem_dup->ext               = g_strdup(stb_elem->ext);
-    if(stb_elem->filtermacro_file)  stb_elem_dup->filtermacro_file  = g_strdup(stb_elem->filtermacro_file);
-    if(stb_elem->colormask_file)    stb_elem_dup->colormask_file    = g_strdup(stb_elem->colormask_file);
-    if(stb_elem->preferred_decoder) stb_elem_dup->preferred_decoder = g_strdup(stb_elem->preferred_decoder);
-    if(stb_elem->att_movepath_file_xml) stb_elem_dup->att_movepath_file_xml = g_strdup(stb_elem->att_movepath_file_xml);
+    stb_elem_dup->basename          = gap_story_strpool_ref(stb_elem->basename);
+    stb_elem_dup->ext               = gap_story_strpool_ref(stb_elem->ext);
+    stb_elem_dup->filtermacro_file  = gap_story_strpool_ref(stb_elem->filtermacro_file);
+    stb_elem_dup->colormask_file    = gap_story_strpool_ref(stb_elem->colormask_file);
+    stb_elem_dup->preferred_decoder = gap_story_strpool_ref(stb_elem->preferred_decoder);
+    stb_elem_dup->att_movepath_file_xml = gap_story_strpool_ref(stb_elem->att_movepath_file_xml);
     stb_elem_dup->seltrack        = stb_elem->seltrack;
     stb_elem_dup->exact_seek      = stb_elem->exact_seek;
     stb_elem_dup->delace          = stb_elem->delace;
@@ -7019,7 +7299,7 @@ gap_story_elem_duplicate(GapStoryElem      *stb_elem)
     stb_elem_dup->mask_disable            = stb_elem->mask_disable;
 
 
-    if(stb_elem->aud_filename)            stb_elem_dup->aud_filename = g_strdup(stb_elem->aud_filename);
+    stb_elem_dup->aud_filename = gap_story_strpool_ref(stb_elem->aud_filename);
     stb_elem_dup->aud_seltrack            = stb_elem->aud_seltrack;
     stb_elem_dup->aud_wait_untiltime_sec  = stb_elem->aud_wait_untiltime_sec;
     stb_elem_dup->aud_play_from_sec       = stb_elem->aud_play_from_sec;
@@ -7041,6 +7321,89 @@ gap_story_elem_duplicate(GapStoryElem      *stb_elem)
 }  /* end gap_story_elem_duplicate */
 
 
+/* -----------------------------
+ * gap_story_elem_is_equal
+ * -----------------------------
+ * compare all attributes that are copied by gap_story_elem_duplicate.
+ * (story_id, story_orig_id, the selection state
+ * and the comment sublists are not compared)
+ * returns TRUE if both elements are equal in this sense.
+ * Note: keep this procedure in sync with gap_story_elem_duplicate
+ */
+gboolean
+gap_story_elem_is_equal(GapStoryElem *stb_elem1, GapStoryElem *stb_elem2)
+{
+  gint ii;
+
+  if((stb_elem1 == NULL) || (stb_elem2 == NULL))
+  {
+    return (stb_elem1 == stb_elem2);
+  }
+
+  if(stb_elem1->record_type             != stb_elem2->record_type)             return (FALSE);
+  if(stb_elem1->playmode                != stb_elem2->playmode)                return (FALSE);
+  if(stb_elem1->track                   != stb_elem2->track)                   return (FALSE);
+  if(stb_elem1->seltrack                != stb_elem2->seltrack)                return (FALSE);
+  if(stb_elem1->exact_seek              != stb_elem2->exact_seek)              return (FALSE);
+  if(stb_elem1->delace                  != stb_elem2->delace)                  return (FALSE);
+  if(stb_elem1->from_frame              != stb_elem2->from_frame)              return (FALSE);
+  if(stb_elem1->to_frame                != stb_elem2->to_frame)                return (FALSE);
+  if(stb_elem1->nloop                   != stb_elem2->nloop)                   return (FALSE);
+  if(stb_elem1->nframes                 != stb_elem2->nframes)                 return (FALSE);
+  if(stb_elem1->step_density            != stb_elem2->step_density)            return (FALSE);
+  if(stb_elem1->file_line_nr            != stb_elem2->file_line_nr)            return (FALSE);
+  if(stb_elem1->fmac_total_steps        != stb_elem2->fmac_total_steps)        return (FALSE);
+  if(stb_elem1->fmac_accel              != stb_elem2->fmac_accel)              return (FALSE);
+  if(stb_elem1->vid_wait_untiltime_sec  != stb_elem2->vid_wait_untiltime_sec)  return (FALSE);
+  if(stb_elem1->color_red               != stb_elem2->color_red)               return (FALSE);
+  if(stb_elem1->color_green             != stb_elem2->color_green)             return (FALSE);
+  if(stb_elem1->color_blue              != stb_elem2->color_blue)              return (FALSE);
+  if(stb_elem1->color_alpha             != stb_elem2->color_alpha)             return (FALSE);
+  if(stb_elem1->att_keep_proportions    != stb_elem2->att_keep_proportions)    return (FALSE);
+  if(stb_elem1->att_fit_width           != stb_elem2->att_fit_width)           return (FALSE);
+  if(stb_elem1->att_fit_height          != stb_elem2->att_fit_height)          return (FALSE);
+  if(stb_elem1->flip_request            != stb_elem2->flip_request)            return (FALSE);
+  if(stb_elem1->att_overlap             != stb_elem2->att_overlap)             return (FALSE);
+  if(stb_elem1->mask_anchor             != stb_elem2->mask_anchor)             return (FALSE);
+  if(stb_elem1->mask_stepsize           != stb_elem2->mask_stepsize)           return (FALSE);
+  if(stb_elem1->mask_disable            != stb_elem2->mask_disable)            return (FALSE);
+  if(stb_elem1->aud_seltrack            != stb_elem2->aud_seltrack)            return (FALSE);
+  if(stb_elem1->aud_wait_untiltime_sec  != stb_elem2->aud_wait_untiltime_sec)  return (FALSE);
+  if(stb_elem1->aud_play_from_sec       != stb_elem2->aud_play_from_sec)       return (FALSE);
+  if(stb_elem1->aud_play_to_sec         != stb_elem2->aud_play_to_sec)         return (FALSE);
+  if(stb_elem1->aud_volume_start        != stb_elem2->aud_volume_start)        return (FALSE);
+  if(stb_elem1->aud_volume              != stb_elem2->aud_volume)              return (FALSE);
+  if(stb_elem1->aud_volume_end          != stb_elem2->aud_volume_end)          return (FALSE);
+  if(stb_elem1->aud_fade_in_sec         != stb_elem2->aud_fade_in_sec)         return (FALSE);
+  if(stb_elem1->aud_fade_out_sec        != stb_elem2->aud_fade_out_sec)        return (FALSE);
+  if(stb_elem1->aud_min_play_sec        != stb_elem2->aud_min_play_sec)        return (FALSE);
+  if(stb_elem1->aud_max_play_sec        != stb_elem2->aud_max_play_sec)        return (FALSE);
+  if(stb_elem1->aud_framerate           != stb_elem2->aud_framerate)           return (FALSE);
+
+  for(ii=0; ii < GAP_STB_ATT_TYPES_ARRAY_MAX; ii++)
+  {
+    if(stb_elem1->att_arr_enable[ii]      != stb_elem2->att_arr_enable[ii])      return (FALSE);
+    if(stb_elem1->att_arr_value_from[ii]  != stb_elem2->att_arr_value_from[ii])  return (FALSE);
+    if(stb_elem1->att_arr_value_to[ii]    != stb_elem2->att_arr_value_to[ii])    return (FALSE);
+    if(stb_elem1->att_arr_value_dur[ii]   != stb_elem2->att_arr_value_dur[ii])   return (FALSE);
+    if(stb_elem1->att_arr_value_accel[ii] != stb_elem2->att_arr_value_accel[ii]) return (FALSE);
+  }
+
+  if(!p_null_strcmp(stb_elem1->orig_filename, stb_elem2->orig_filename))                  return (FALSE);
+  if(!p_null_strcmp(stb_elem1->orig_src_line, stb_elem2->orig_src_line))                  return (FALSE);
+  if(!p_null_strcmp(stb_elem1->basename, stb_elem2->basename))                            return (FALSE);
+  if(!p_null_strcmp(stb_elem1->ext, stb_elem2->ext))                                      return (FALSE);
+  if(!p_null_strcmp(stb_elem1->filtermacro_file, stb_elem2->filtermacro_file))            return (FALSE);
+  if(!p_null_strcmp(stb_elem1->colormask_file, stb_elem2->colormask_file))                return (FALSE);
+  if(!p_null_strcmp(stb_elem1->preferred_decoder, stb_elem2->preferred_decoder))          return (FALSE);
+  if(!p_null_strcmp(stb_elem1->att_movepath_file_xml, stb_elem2->att_movepath_file_xml))  return (FALSE);
+  if(!p_null_strcmp(stb_elem1->mask_name, stb_elem2->mask_name))                          return (FALSE);
+  if(!p_null_strcmp(stb_elem1->aud_filename, stb_elem2->aud_filename))                    return (FALSE);
+
+  return (TRUE);
+}  /* end gap_story_elem_is_equal */
+
+
 /* -----------------------------
  * gap_story_elem_copy
  * -----------------------------
@@ -7056,15 +7419,15 @@ gap_story_elem_copy(GapStoryElem *stb_elem_dst, GapStoryElem *stb_elem)
 
   if((stb_elem_dst) && (stb_elem))
   {
-    if(stb_elem_dst->orig_filename)     g_free(stb_elem_dst->orig_filename);
+    gap_story_strpool_unref(stb_elem_dst->orig_filename);
     if(stb_elem_dst->orig_src_line)     g_free(stb_elem_dst->orig_src_line);
-    if(stb_elem_dst->basename)          g_free(stb_elem_dst->basename);
-    if(stb_elem_dst->ext)               g_free(stb_elem_dst->ext);
-    if(stb_elem_dst->filtermacro_file)  g_free(stb_elem_dst->filtermacro_file);
-    if(stb_elem_dst->colormask_file)    g_free(stb_elem_dst->colormask_file);
-    if(stb_elem_dst->preferred_decoder) g_free(stb_elem_dst->preferred_decoder);
+    gap_story_strpool_unref(stb_elem_dst->basename);
+    gap_story_strpool_unref(stb_elem_dst->ext);
+    gap_story_strpool_unref(stb_elem_dst->filtermacro_file);
+    gap_story_strpool_unref(stb_elem_dst->colormask_file);
+    gap_story_strpool_unref(stb_elem_dst->preferred_decoder);
     if(stb_elem_dst->mask_name)         g_free(stb_elem_dst->mask_name);
-    if(stb_elem_dst->aud_filename)      g_free(stb_elem_dst->aud_filename);
+    gap_story_strpool_unref(stb_elem_dst->aud_filename);
 
 
     stb_elem_dst->orig_filename     = NULL;
@@ -7086,15 +7449,15 @@ gap_story_elem_copy(GapStoryElem *stb_elem_dst, GapStoryElem *stb_elem)
     stb_elem_dst->playmode        = stb_elem->playmode;
     stb_elem_dst->track           = stb_elem->track;
 
-    if(stb_elem->orig_filename)     stb_elem_dst->orig_filename     = g_strdup(stb_elem->orig_filename);
+    stb_elem_dst->orig_filename     = gap_story_strpool_ref(stb_elem->orig_filename);
     if(stb_elem->orig_src_line)     stb_elem_dst->orig_src_line     = g_strdup(stb_elem->orig_src_line);
-    if(stb_elem->basename)          stb_elem_dst->basename          = g_strdup(stb_elem->basename);
-    if(stb_elem->ext)               stb_elem_dst->ext               = g_strdup(stb_elem->ext);
-    if(stb_elem->filtermacro_file)  stb_elem_dst->filtermacro_file  = g_strdup(stb_elem->filtermacro_file);
-    if(stb_elem->colormask_file)    stb_elem_dst->colormask_file    = g_strdup(stb_elem->colormask_file);
-    if(stb_elem->preferred_decoder) stb_elem_dst->preferred_decoder = g_strdup(stb_elem->preferred_decoder);
+    stb_elem_dst->basename          = gap_story_strpool_ref(stb_elem->basename);
+    stb_elem_dst->ext               = gap_story_strpool_ref(stb_elem->ext);
+    stb_elem_dst->filtermacro_file  = gap_story_strpool_ref(stb_elem->filtermacro_file);
+    stb_elem_dst->colormask_file    = gap_story_strpool_ref(stb_elem->colormask_file);
+    stb_elem_dst->preferred_decoder = gap_story_strpool_ref(stb_elem->preferred_decoder);
     if(stb_elem->mask_name)         stb_elem_dst->mask_name         = g_strdup(stb_elem->mask_name);
-    if(stb_elem->aud_filename)      stb_elem_dst->aud_filename      = g_strdup(stb_elem->aud_filename);
+    stb_elem_dst->aud_filename      = gap_story_strpool_ref(stb_elem->aud_filename);
 
     stb_elem_dst->seltrack        = stb_elem->seltrack;
     stb_elem_dst->exact_seek      = stb_elem->exact_seek;
@@ -7131,8 +7494,8 @@ gap_story_elem_copy(GapStoryElem *stb_elem_dst, GapStoryElem *stb_elem)
         stb_elem_dst->att_arr_value_accel[ii] = stb_elem->att_arr_value_accel[ii];
       }
     }
-    stb_elem_dst->att_movepath_file_xml  = NULL;
-    if(stb_elem->att_movepath_file_xml)  stb_elem_dst->att_movepath_file_xml  = g_strdup(stb_elem->att_movepath_file_xml);
+    gap_story_strpool_unref(stb_elem_dst->att_movepath_file_xml);
+    stb_elem_dst->att_movepath_file_xml  = gap_story_strpool_ref(stb_elem->att_movepath_file_xml);
 
     stb_elem_dst->flip_request            = stb_elem->flip_request;
     stb_elem_dst->att_overlap             = stb_elem->att_overlap;
@@ -7404,6 +7767,7 @@ p_story_board_duplicate(GapStoryBoard *stb_ptr, GapStoryDuplicateMode dup_mode
   {
     return (NULL);
   }
+  p_set_track_append_position(stb_dup, TRUE);
   stb_dup->master_type = stb_ptr->master_type;
   stb_dup->master_width = stb_ptr->master_width;
   stb_dup->master_height = stb_ptr->master_height;
@@ -7634,6 +7998,7 @@ p_story_board_duplicate(GapStoryBoard *stb_ptr, GapStoryDuplicateMode dup_mode
   {
     p_story_board_duplicate_refered_mask_definitions(stb_dup, stb_ptr);
   }
+  p_set_track_append_position(stb_dup, FALSE);
 
   if(gap_debug)
   {
@@ -7673,6 +8038,36 @@ gap_story_duplicate_full(GapStoryBoard *stb_ptr)
   return(stb_dup);
 }  /* end gap_story_duplicate_full  */
 
+
+/* --------------------------------
+ * gap_story_duplicate_without_elems
+ * --------------------------------
+ * make a duplicate of the master and edit settings
+ * and the section structure (including current_vtrack of the sections),
+ * but without any elements.
+ * (the storyboard undo uses this to record the master data
+ * and keeps the elements separately)
+ */
+GapStoryBoard *
+gap_story_duplicate_without_elems(GapStoryBoard *stb_ptr)
+{
+  GapStoryBoard *stb_dup;
+
+  stb_dup = p_story_board_duplicate(stb_ptr
+                                , GAP_STB_DUPLICATE_NO_ELEMS
+                                , -1         /* include all video tracks */
+                                , -1         /* include all audio tracks */
+                                , NULL       /* include all sections, keep section structure */
+                                , FALSE      /* no mask definitions */
+                                , -1         /* story_id */
+                                );
+  if(stb_dup != NULL)
+  {
+    stb_dup->unsaved_changes = stb_ptr->unsaved_changes;
+  }
+  return(stb_dup);
+}  /* end gap_story_duplicate_without_elems  */
+
 /* -------------------------------------------
  * gap_story_duplicate_active_and_mask_section
  * -------------------------------------------
@@ -8950,8 +9345,8 @@ gap_story_gen_otone_audio(GapStoryBoard *stb
                 stb_elem_new->track             = aud_track;
                 stb_elem_new->from_frame        = l_from_frame;
                 stb_elem_new->to_frame          = stb_elem->to_frame;
-                stb_elem_new->aud_filename      = g_strdup(stb_elem->aud_filename);
-                stb_elem_new->orig_filename     = g_strdup(stb_elem->orig_filename);
+                stb_elem_new->aud_filename      = gap_story_strpool_ref(stb_elem->aud_filename);
+                stb_elem_new->orig_filename     = gap_story_strpool_ref(stb_elem->orig_filename);
 
                 stb_elem_new->aud_play_from_sec = (gdouble)l_from_frame / l_framerate;
                 stb_elem_new->aud_play_to_sec   = (gdouble)stb_elem->to_frame / l_framerate;
@@ -8963,7 +9358,7 @@ gap_story_gen_otone_audio(GapStoryBoard *stb
                 stb_elem_new->aud_fade_out_sec       = 0.0;
                 stb_elem_new->nloop                  = stb_elem->nloop;
                 stb_elem_new->aud_seltrack           = aud_seltrack;
-                stb_elem_new->preferred_decoder      = g_strdup(stb_elem->preferred_decoder);
+                stb_elem_new->preferred_decoder      = gap_story_strpool_ref(stb_elem->preferred_decoder);
 
                 stb_elem_new->aud_framerate          = l_framerate;
 
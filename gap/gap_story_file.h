@@ -24,6 +24,10 @@
  */
 
 /* revision history:
+ * version 2.7.0;   2026/10/18  filename members of GapStoryElem are pooled strings
+ *                              (gap_story_strpool_ref, gap_story_strpool_unref)
+ * version 2.7.0;   2026/10/18  GapStoryBoard keeps the append position while
+ *                              parsing and duplicating
  * version 2.3.0;   2006/04/14  new features: overlap, flip, mask definitions
  * version 1.3.25b; 2004/01/23  hof: created
  */
@@ -59,7 +63,14 @@
 #define GAP_GIMPRC_VIDEO_STORYBOARD_MAX_OPEN_VIDEOFILES        "video-storyboard-max-open-videofiles"
 #define GAP_GIMPRC_VIDEO_STORYBOARD_FCACHE_SIZE_PER_VIDEOFILE  "video-storyboard-fcache-size-per-videofile"
 #define GAP_GIMPRC_VIDEO_STORYBOARD_RESOURCE_LOG_INTERVAL      "video-storyboard-resource-log-interval"
+#define GAP_GIMPRC_VIDEO_STORYBOARD_NATIVE_RGB_COMPOSITE       "video-storyboard-native-rgb-composite"
+#define GAP_GIMPRC_VIDEO_STORYBOARD_COMPOSITE_CACHE_SIZE       "video-storyboard-composite-cache-size"
+#define GAP_GIMPRC_VIDEO_STORYBOARD_COMPOSITE_CACHE_DIR        "video-storyboard-composite-cache-dir"
+#define GAP_GIMPRC_VIDEO_STORYBOARD_UNDO_SIZE                  "video-storyboard-undo-size"
 #define GAP_GIMPRC_VIDEO_ENCODER_FFMPEG_MULTIPROCESSOR_ENABLE  "video-enoder-ffmpeg-multiprocessor-enable"
+#define GAP_GIMPRC_VIDEO_ENCODER_FFMPEG_QUEUE_CONVERT_SIZE     "video-enoder-ffmpeg-queue-convert-size"
+#define GAP_GIMPRC_VIDEO_ENCODER_FFMPEG_QUEUE_ENCODE_SIZE      "video-enoder-ffmpeg-queue-encode-size"
+#define GAP_GIMPRC_VIDEO_ENCODER_FFMPEG_QUEUE_MUX_SIZE         "video-enoder-ffmpeg-queue-mux-size"
 
 /* GapStoryRecordType enum values are superset of GapLibAinfoType
  * from the sourcefile gap_lib.h
@@ -123,6 +134,10 @@
     GapStoryVideoPlaymode  playmode;
     gint32                 track;
 
+                            /* orig_filename, basename, ext, filtermacro_file, colormask_file,
+                             * preferred_decoder, att_movepath_file_xml and aud_filename
+                             * are pooled strings, see gap_story_strpool_ref
+                             */
     char  *orig_filename;   /* full filename use for IMAGE and MOVIE Files
                              * and SECTIONS (for section_name)
                              */
@@ -278,6 +293,15 @@
      gchar         *currline;      /* dont g_free this one ! */
      gint32         count_unprintable_chars;
 
+     /* append position while gap_story_parse and the duplicate procedures
+      * build up the element lists, so that appending does not walk
+      * the whole list (not used when track_append_position is FALSE)
+      */
+     gboolean         track_append_position;
+     GapStorySection *append_section;      /* dont free this one ! */
+     GapStoryElem    *append_tail;         /* dont free this one ! */
+     GapStoryElem    *append_non_comment;  /* dont free this one ! */
+
      /* for composite vide playback */
      gint32         stb_parttype;
      gint32         stb_unique_id;
@@ -355,6 +379,8 @@ GapStoryElem *      gap_story_elem_find_by_story_orig_id(GapStoryBoard *stb, gin
 
 
 gboolean            gap_story_save(GapStoryBoard *stb, const char *filename);
+char *              gap_story_strpool_ref(const char *str);
+void                gap_story_strpool_unref(char *str);
 GapStoryElem *      gap_story_new_elem(GapStoryRecordType record_type);
 long                gap_story_upd_elem_from_filename(GapStoryElem *stb_elem,  const char *filename);
 gboolean            gap_story_filename_is_videofile_by_ext(const char *filename);
@@ -398,6 +424,7 @@ GapStoryElem *      gap_story_fetch_nth_active_elem(GapStoryBoard *stb
 GapAnimInfo *       gap_story_fake_ainfo_from_stb(GapStoryBoard *stb_ptr, gint32 in_track);
 
 GapStoryElem *      gap_story_elem_duplicate(GapStoryElem *stb_elem);
+gboolean            gap_story_elem_is_equal(GapStoryElem *stb_elem1, GapStoryElem *stb_elem2);
 void                gap_story_elem_copy(GapStoryElem *stb_elem_dst, GapStoryElem *stb_elem_src);
 
 GapStoryElem *      gap_story_find_mask_definition_by_name(GapStoryBoard *stb_ptr, const char *mask_name);
@@ -405,6 +432,7 @@ GapStoryElem *      gap_story_find_mask_reference_by_name(GapStoryBoard *stb_ptr
 
 void                gap_story_enable_hidden_maskdefinitions(GapStoryBoard *stb_ptr);
 GapStoryBoard *     gap_story_duplicate_full(GapStoryBoard *stb_ptr);
+GapStoryBoard *     gap_story_duplicate_without_elems(GapStoryBoard *stb_ptr);
 GapStoryBoard *     gap_story_duplicate_active_and_mask_section(GapStoryBoard *stb_ptr);
 GapStoryBoard *     gap_story_duplicate_vtrack(GapStoryBoard *stb_ptr, gint32 in_vtrack);
 GapStoryBoard *     gap_story_duplicate_sel_only(GapStoryBoard *stb_ptr, gint32 in_vtrack);
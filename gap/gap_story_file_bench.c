@@ -0,0 +1,531 @@
+/* gap_story_file_bench.c
+ *
+ * GAP ... Gimp Animation Plugins
+ *
+ * equality check and benchmark for loading, saving and duplicating
+ * storyboards (gap_story_file.c)
+ *
+ * A storyboard file is generated (clips, attributes, comments, empty lines,
+ * lines continued with backslash, CR LF line ends, trailing blanks and a last
+ * line without newline, with a fixed seed).
+ *   a) load: gap_story_parse (memory mapped file, one reused line buffer)
+ *      is compared against p_parse_reference, the original line loop
+ *      via gap_val_load_textfile that feeds the same p_story_parse_line.
+ *      All elements must be equal (gap_story_elem_is_equal and orig_src_line).
+ *   b) save: the saved file is loaded and saved again, both files must be identical.
+ *   c) duplicate: the saved gap_story_duplicate_full copy must be identical
+ *      to the saved original.
+ *
+ * usage:
+ *   gap_story_file_bench             equality check on a 2000 line storyboard (run by make check)
+ *   gap_story_file_bench -b [n]      equality check and benchmark (20 loads, saves and duplicates)
+ *                                    on a n line storyboard (default 10000)
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * 2026.10.18  created
+ */
+
+/* included (not linked) to access the static parser procedures */
+#include "gap_story_file.c"
+
+#define BENCH_LOOPS  20
+
+int gap_debug = 0;  /* 1 == print debug infos , 0 dont print debug infos */
+
+
+/* ---------------------------------
+ * p_generate_storyboard
+ * ---------------------------------
+ * write a storyboard file with (at least) numLines lines.
+ */
+static gboolean
+p_generate_storyboard(const char *filename, gint32 numLines, guint32 seed)
+{
+  FILE    *fp;
+  GRand   *rand;
+  gint32   lineCount;
+  gint32   ii;
+
+  fp = g_fopen(filename, "wb");
+  if(fp == NULL)
+  {
+    return (FALSE);
+  }
+  rand = g_rand_new_with_seed(seed);
+
+  fprintf(fp, "%s\n", GAP_STBKEY_STB_HEADER);
+  fprintf(fp, "VID_MASTER_SIZE         width:320  height:200\n");
+  fprintf(fp, "VID_MASTER_FRAMERATE    frames_per_sec:24.0\n");
+  lineCount = 3;
+  for(ii = 0; lineCount < numLines -1; ii++)
+  {
+    gint32 rr;
+
+    rr = g_rand_int_range(rand, 0, 100);
+    if(rr < 5)
+    {
+      fprintf(fp, "# comment %d   \n", (int)ii);
+      lineCount++;
+    }
+    else if(rr < 8)
+    {
+      /* the backslash is part of the last item of a continued line,
+       * (a blank before the backslash would make it an item of its own)
+       */
+      fprintf(fp, "VID_PLAY_MOVIE     track:1  file:\"/data/videos/clip%03d.mpg\"  mode:normal from:1\\\n"
+                  "                   to:%d\\\n"
+                  "                   nloops:%d\n"
+                , (int)(ii % 50)
+                , (int)g_rand_int_range(rand, 2, 500)
+                , (int)g_rand_int_range(rand, 1, 4)
+                );
+      lineCount += 3;
+    }
+    else if(rr < 9)
+    {
+      fprintf(fp, "\n");
+      lineCount++;
+    }
+    else if(rr < 12)
+    {
+      fprintf(fp, "VID_OPACITY        track:1  opacity_from:0.0     opacity_to:1.0     nframes:%d\n"
+                , (int)g_rand_int_range(rand, 1, 50)
+                );
+      lineCount++;
+    }
+    else if(rr < 14)
+    {
+      fprintf(fp, "VID_PLAY_COLOR     track:1  red:0.%d green:1.0 blue:0.0 alpha:1.0   nloops:%d\n"
+                , (int)g_rand_int_range(rand, 0, 10)
+                , (int)g_rand_int_range(rand, 1, 100)
+                );
+      lineCount++;
+    }
+    else if(rr < 16)
+    {
+      fprintf(fp, "VID_PLAY_IMAGE     track:1  file:\"/x y/image%02d.png\"    nloops:%d\n"
+                , (int)(ii % 20)
+                , (int)g_rand_int_range(rand, 1, 100)
+                );
+      lineCount++;
+    }
+    else
+    {
+      gint32 from;
+
+      from = g_rand_int_range(rand, 1, 10000);
+      fprintf(fp, "VID_PLAY_FRAMES    track:1  base:\"/data/frames/scene%02d_\" ext:.xcf  from:%d to:%d mode:normal nloops:1 \r\n"
+                , (int)(ii % 30)
+                , (int)from
+                , (int)(from + g_rand_int_range(rand, 0, 100))
+                );
+      lineCount++;
+    }
+  }
+  /* last line without newline */
+  fprintf(fp, "VID_PLAY_IMAGE     track:1  file:\"/x y/z.png\"  nloops:1");
+
+  g_rand_free(rand);
+  fclose(fp);
+  return (TRUE);
+}  /* end p_generate_storyboard */
+
+
+/* ---------------------------------
+ * p_parse_reference
+ * ---------------------------------
+ * the original gap_story_parse line loop (gap_val_load_textfile,
+ * a list node and a copy per line, multi_lines copy for each line)
+ * (with the check for empty lines before the backslash test, the original
+ * read line[-1] for empty lines)
+ */
+static GapStoryBoard *
+p_parse_reference(const gchar *filename)
+{
+  GapValTextFileLines *txf_ptr_root;
+  GapValTextFileLines *txf_ptr;
+  GapStoryBoard *stb;
+  GapStorySection *stb_section;
+  GapStoryElem *stb_elem;
+  gchar *longline;
+  gchar *multi_lines;
+  gint32 longlinenr;
+  gint32 line_nr;
+
+  stb = gap_story_new_story_board(filename);
+  if(stb == NULL)
+  {
+    return (NULL);
+  }
+  txf_ptr_root = gap_val_load_textfile(filename);
+  stb->master_vtrack1_is_toplayer = FALSE;
+
+  longline = NULL;
+  multi_lines = NULL;
+  longlinenr = 0;
+  line_nr = 0;
+  for(txf_ptr = txf_ptr_root; txf_ptr != NULL; txf_ptr = (GapValTextFileLines *) txf_ptr->next)
+  {
+    gint l_len;
+
+    line_nr++;
+    gap_file_chop_trailingspace_and_nl(&txf_ptr->line[0]);
+    l_len = strlen(txf_ptr->line);
+
+    if(multi_lines == NULL)
+    {
+      multi_lines = g_strdup(txf_ptr->line);
+    }
+    else
+    {
+      gchar *l_ml;
+
+      l_ml = g_strdup_printf("%s\n%s", multi_lines, txf_ptr->line);
+      g_free(multi_lines);
+      multi_lines = l_ml;
+    }
+
+    if ((l_len > 0) && (txf_ptr->line[l_len-1] == '\\'))
+    {
+      if(longline == NULL)
+      {
+        longline = g_strdup(txf_ptr->line);
+      }
+      else
+      {
+        char *l_line;
+
+        l_line = g_strdup_printf("%s %s", longline, txf_ptr->line);
+        g_free(longline);
+        longline = l_line;
+      }
+      if(longlinenr == 0)
+      {
+        longlinenr = line_nr;
+      }
+    }
+    else
+    {
+      if(longline == NULL)
+      {
+        p_story_parse_line(stb, txf_ptr->line, line_nr, multi_lines);
+      }
+      else
+      {
+        char *l_line;
+
+        l_line = g_strdup_printf("%s %s", longline, txf_ptr->line);
+        g_free(longline);
+        longline = NULL;
+        p_story_parse_line(stb, l_line, longlinenr, multi_lines);
+        g_free(l_line);
+      }
+      longlinenr = 0;
+      g_free(multi_lines);
+      multi_lines = NULL;
+    }
+  }
+  if(longline)
+  {
+    p_story_parse_line(stb, longline, longlinenr, multi_lines);
+    g_free(longline);
+    g_free(multi_lines);
+  }
+  if(txf_ptr_root)
+  {
+    gap_val_free_textfile_lines(txf_ptr_root);
+  }
+
+  for(stb_section = stb->stb_section; stb_section != NULL; stb_section = stb_section->next)
+  {
+    for(stb_elem = stb_section->stb_elem; stb_elem != NULL; stb_elem = (GapStoryElem *)stb_elem->next)
+    {
+      if(stb_elem->nframes <= 0)
+      {
+        gap_story_elem_calculate_nframes(stb_elem);
+      }
+    }
+  }
+  stb->active_section = gap_story_find_main_section(stb);
+  stb->unsaved_changes = FALSE;
+
+  return (stb);
+}  /* end p_parse_reference */
+
+
+/* ---------------------------------
+ * p_str_is_equal
+ * ---------------------------------
+ */
+static gboolean
+p_str_is_equal(const char *str1, const char *str2)
+{
+  if((str1 == NULL) || (str2 == NULL))
+  {
+    return (str1 == str2);
+  }
+  return (strcmp(str1, str2) == 0);
+}  /* end p_str_is_equal */
+
+
+/* ---------------------------------
+ * p_compare_storyboards
+ * ---------------------------------
+ * return the number of differing elements (including missing ones)
+ */
+static gint32
+p_compare_storyboards(GapStoryBoard *stb1, GapStoryBoard *stb2, gint32 *elemCount)
+{
+  GapStorySection *section1;
+  GapStorySection *section2;
+  gint32 diffs;
+
+  diffs = 0;
+  *elemCount = 0;
+  section2 = stb2->stb_section;
+  for(section1 = stb1->stb_section; section1 != NULL; section1 = section1->next)
+  {
+    GapStoryElem *stb_elem1;
+    GapStoryElem *stb_elem2;
+
+    if(section2 == NULL)
+    {
+      return (diffs + 1);
+    }
+    stb_elem2 = section2->stb_elem;
+    for(stb_elem1 = section1->stb_elem; stb_elem1 != NULL; stb_elem1 = stb_elem1->next)
+    {
+      (*elemCount)++;
+      if((stb_elem2 == NULL)
+      || (gap_story_elem_is_equal(stb_elem1, stb_elem2) != TRUE)
+      || (p_str_is_equal(stb_elem1->orig_src_line, stb_elem2->orig_src_line) != TRUE))
+      {
+        diffs++;
+        if(diffs < 5)
+        {
+          printf("MISMATCH at line %d: %s\n"
+                , (int)stb_elem1->file_line_nr
+                , stb_elem1->orig_src_line ? stb_elem1->orig_src_line : "(null)"
+                );
+        }
+      }
+      if(stb_elem2 != NULL)
+      {
+        stb_elem2 = stb_elem2->next;
+      }
+    }
+    if(stb_elem2 != NULL)
+    {
+      diffs++;
+    }
+    section2 = section2->next;
+  }
+  if(section2 != NULL)
+  {
+    diffs++;
+  }
+
+  return (diffs);
+}  /* end p_compare_storyboards */
+
+
+/* ---------------------------------
+ * p_files_are_equal
+ * ---------------------------------
+ */
+static gboolean
+p_files_are_equal(const char *filename1, const char *filename2)
+{
+  gchar    *contents1;
+  gchar    *contents2;
+  gsize     length1;
+  gsize     length2;
+  gboolean  isEqual;
+
+  isEqual = FALSE;
+  contents1 = NULL;
+  contents2 = NULL;
+  if((g_file_get_contents(filename1, &contents1, &length1, NULL))
+  && (g_file_get_contents(filename2, &contents2, &length2, NULL)))
+  {
+    isEqual = ((length1 == length2) && (memcmp(contents1, contents2, length1) == 0));
+  }
+  if(contents1)
+  {
+    g_free(contents1);
+  }
+  if(contents2)
+  {
+    g_free(contents2);
+  }
+
+  return (isEqual);
+}  /* end p_files_are_equal */
+
+
+/* ---------------------------------
+ * main
+ * ---------------------------------
+ */
+int
+main(int argc, char *argv[])
+{
+  GapStoryBoard *stb;
+  GapStoryBoard *stbRef;
+  GapStoryBoard *stbDup;
+  GTimer   *timer;
+  gchar    *genName;
+  gchar    *saveName;
+  gchar    *save2Name;
+  gboolean  isBenchmark;
+  gint32    numLines;
+  gint32    numLoops;
+  gint32    elemCount;
+  gint32    errors;
+  gint32    diffs;
+  gint32    ii;
+  gdouble   timeRef;
+  gdouble   timeParse;
+  gdouble   timeSave;
+  gdouble   timeDup;
+
+  isBenchmark = FALSE;
+  numLines = 2000;
+  numLoops = 1;
+  if((argc > 1) && (strcmp(argv[1], "-b") == 0))
+  {
+    isBenchmark = TRUE;
+    numLines = 10000;
+    numLoops = BENCH_LOOPS;
+    if(argc > 2)
+    {
+      numLines = MAX(10, atoi(argv[2]));
+    }
+  }
+
+  genName = g_build_filename(g_get_tmp_dir(), "gap_story_file_bench_gen.txt", NULL);
+  saveName = g_build_filename(g_get_tmp_dir(), "gap_story_file_bench_save.txt", NULL);
+  save2Name = g_build_filename(g_get_tmp_dir(), "gap_story_file_bench_save2.txt", NULL);
+
+  if(p_generate_storyboard(genName, numLines, 4711) != TRUE)
+  {
+    printf("could not write %s, test skipped\n", genName);
+    return (77);   /* automake: skipped test */
+  }
+
+  errors = 0;
+  timer = g_timer_new();
+
+  /* a) load */
+  g_timer_start(timer);
+  for(ii = 0; ii < numLoops; ii++)
+  {
+    stbRef = p_parse_reference(genName);
+    gap_story_free_storyboard(&stbRef);
+  }
+  timeRef = g_timer_elapsed(timer, NULL);
+
+  g_timer_start(timer);
+  for(ii = 0; ii < numLoops; ii++)
+  {
+    stb = gap_story_parse(genName);
+    gap_story_free_storyboard(&stb);
+  }
+  timeParse = g_timer_elapsed(timer, NULL);
+
+  stbRef = p_parse_reference(genName);
+  stb = gap_story_parse(genName);
+  diffs = p_compare_storyboards(stbRef, stb, &elemCount);
+  printf("load:      %d elements, %d differ from the original line loop\n", (int)elemCount, (int)diffs);
+  errors += diffs;
+  if(stb->errtext != NULL)
+  {
+    printf("parse error at line %d: %s\n", (int)stb->errline_nr, stb->errtext);
+    errors++;
+  }
+
+  /* b) save */
+  g_timer_start(timer);
+  for(ii = 0; ii < numLoops; ii++)
+  {
+    gap_story_save(stb, saveName);
+  }
+  timeSave = g_timer_elapsed(timer, NULL);
+  {
+    GapStoryBoard *stbSaved;
+
+    stbSaved = gap_story_parse(saveName);
+    gap_story_save(stbSaved, save2Name);
+    gap_story_free_storyboard(&stbSaved);
+  }
+  if(p_files_are_equal(saveName, save2Name) != TRUE)
+  {
+    printf("save:      MISMATCH after load and save of the saved file\n");
+    errors++;
+  }
+
+  /* c) duplicate */
+  g_timer_start(timer);
+  for(ii = 0; ii < numLoops; ii++)
+  {
+    stbDup = gap_story_duplicate_full(stb);
+    gap_story_free_storyboard(&stbDup);
+  }
+  timeDup = g_timer_elapsed(timer, NULL);
+  /* the duplicate does not include the comment sublists,
+   * therefore compare the elements rather than the saved files
+   */
+  stbDup = gap_story_duplicate_full(stb);
+  diffs = p_compare_storyboards(stb, stbDup, &elemCount);
+  if(diffs != 0)
+  {
+    printf("duplicate: %d of %d elements differ\n", (int)diffs, (int)elemCount);
+    errors += diffs;
+  }
+
+  if(isBenchmark)
+  {
+    printf("%d lines, %d loops:\n", (int)numLines, (int)numLoops);
+    printf("  load (original line loop):  %9.1f ms\n", timeRef * 1000.0);
+    printf("  load (gap_story_parse):     %9.1f ms\n", timeParse * 1000.0);
+    printf("  save:                       %9.1f ms\n", timeSave * 1000.0);
+    printf("  duplicate_full:             %9.1f ms\n", timeDup * 1000.0);
+  }
+
+  gap_story_free_storyboard(&stbDup);
+  gap_story_free_storyboard(&stb);
+  gap_story_free_storyboard(&stbRef);
+  g_timer_destroy(timer);
+
+  g_remove(genName);
+  g_remove(saveName);
+  g_remove(save2Name);
+  g_free(genName);
+  g_free(saveName);
+  g_free(save2Name);
+
+  printf("storyboard load/save/duplicate equality check: %s\n"
+        , (errors == 0) ? "OK" : "FAILED"
+        );
+
+  return ((errors == 0) ? 0 : 1);
+
+}  /* end main */
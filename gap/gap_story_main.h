@@ -420,6 +420,8 @@ typedef struct GapStbTabWidgets  /* nickname: tabw */
   GapStoryUndoElem  *undo_stack_list;
   GapStoryUndoElem  *undo_stack_ptr;
   gdouble            undo_stack_group_counter;
+  gint64             undo_stack_bytes;   /* estimated memory usage of the undo stack */
+  gint32             undo_stack_max_mb;  /* undo stack size limit (0 unlimited, -1 gimprc not yet checked) */
 
   void  *sgpp;               /* never g_free this one ! */
 
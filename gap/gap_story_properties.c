@@ -514,7 +514,9 @@ p_pw_propagate_mask_name_changes(GapStbPropWidget *pw
           * element attribute.
           * This requires update of all video track elements that are refering
           * to this mask definition.
+          * (the undo element of the clip properties must compare all clips)
           */
+         gap_stb_undo_mark_all_dirty(pw->tabw);
          updateOK = gap_story_update_mask_name_references(pw->stb_refptr
            , pw->stb_elem_refptr->mask_name
            , mask_name_old
@@ -2665,12 +2667,8 @@ p_pw_colormask_file_entry_update_cb(GtkWidget *widget, GapStbPropWidget *pw)
     p_pw_push_undo_and_set_unsaved_changes(pw);
   }
 
-  if(pw->stb_elem_refptr->colormask_file)
-  {
-    g_free(pw->stb_elem_refptr->colormask_file);
-  }
-
-  pw->stb_elem_refptr->colormask_file = g_strdup(gtk_entry_get_text(GTK_ENTRY(widget)));
+  gap_story_strpool_unref(pw->stb_elem_refptr->colormask_file);
+  pw->stb_elem_refptr->colormask_file = gap_story_strpool_ref(gtk_entry_get_text(GTK_ENTRY(widget)));
 
 }  /* end p_pw_colormask_file_entry_update_cb */
 
@@ -2689,12 +2687,8 @@ p_pw_fmac_entry_update_cb(GtkWidget *widget, GapStbPropWidget *pw)
     p_pw_push_undo_and_set_unsaved_changes(pw);
   }
 
-  if(pw->stb_elem_refptr->filtermacro_file)
-  {
-    g_free(pw->stb_elem_refptr->filtermacro_file);
-  }
-
-  pw->stb_elem_refptr->filtermacro_file = g_strdup(gtk_entry_get_text(GTK_ENTRY(widget)));
+  gap_story_strpool_unref(pw->stb_elem_refptr->filtermacro_file);
+  pw->stb_elem_refptr->filtermacro_file = gap_story_strpool_ref(gtk_entry_get_text(GTK_ENTRY(widget)));
 
   p_pw_check_fmac_sensitivity(pw);
   
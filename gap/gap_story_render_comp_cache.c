@@ -0,0 +1,603 @@
+/* gap_story_render_comp_cache.c
+ *
+ *
+ *  GAP storyboard composite frame cache.
+ *  (persistent cache of rendered composite frames, keyed by
+ *   a checksum of all inputs that contribute to the composite frame)
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * The composite frame cache stores the final (flattened, filtermacro processed)
+ * rgb888 composite frame of the MAIN section in a cache directory.
+ * The key of a composite frame is built from all clips that are active
+ * at the master_frame_nr in all video tracks:
+ *   clip type, attributes at the current step (opacity, scale, move, rotate, color ...),
+ *   flip, deinterlace (all clip types), videotrack and seek mode,
+ *   the source frame identity (filename, mtime and local frame number),
+ *   clip and global filtermacro files (name and mtime),
+ *   movepath xml file (name and mtime) and phase
+ *   and the auto insert alpha / logo area files.
+ * The key header includes the gimprc setting video-storyboard-native-rgb-composite
+ * (the native rgb888 compositing may deliver other pixels than the gimp layer path).
+ * The master_frame_nr itself is NOT part of the key, so frames that moved
+ * due to an edit at an earlier position in the storyboard are still found.
+ *
+ * Frames that refer to sections or masks are not cached
+ * (their content depends on other parts of the storyboard).
+ *
+ * The cache is configured by the gimprc parameters
+ *   (video-storyboard-composite-cache-size "0")    size in MB, 0 turns the cache off (default)
+ *   (video-storyboard-composite-cache-dir "/path/to/dir")  default is stbcompositecache in the gimp directory.
+ * When the size limit is exceeded the least recently used frames are removed.
+ * (the cache directory handling is shared with the GVA frame diskcache,
+ *  see libgapbase/gap_file_cache.c)
+ */
+
+/*
+ * 2026.10.18  - created
+ */
+
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+
+#define GAP_STB_COMP_CACHE_MAGIC          "GAPSTBC1"
+#define GAP_STB_COMP_CACHE_SUFFIX         ".stbcomp"
+#define GAP_STB_COMP_CACHE_HDR_COUNT      2      /* width, height */
+#define GAP_STB_COMP_CACHE_BPP            3
+
+
+static GapFileCache compCacheFcd = GAP_FILE_CACHE_INITIALIZER("storyboard composite cache"
+                                                             , GAP_STB_COMP_CACHE_SUFFIX
+                                                             , GAP_STB_COMP_CACHE_MAGIC
+                                                             );
+static gint32       compCacheHits = 0;
+static gint32       compCacheMisses = 0;
+static gint32       compCacheStores = 0;
+
+
+/* ----------------------------------------------------
+ * p_comp_cache_init_config
+ * ----------------------------------------------------
+ * read the composite cache configuration from gimprc
+ * (only once per plug-in process)
+ */
+static void
+p_comp_cache_init_config(void)
+{
+  gap_file_cache_init_config(&compCacheFcd
+                            , GAP_GIMPRC_VIDEO_STORYBOARD_COMPOSITE_CACHE_SIZE
+                            , GAP_GIMPRC_VIDEO_STORYBOARD_COMPOSITE_CACHE_DIR
+                            , "stbcompositecache"
+                            , 0     /* default: cache is off */
+                            );
+}  /* end p_comp_cache_init_config */
+
+
+/* ----------------------------------------------------
+ * p_comp_cache_append_double
+ * ----------------------------------------------------
+ * append a double value to the key (locale independent)
+ */
+static void
+p_comp_cache_append_double(GString *key, gdouble value)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append_c(key, ':');
+  g_string_append(key, g_ascii_formatd(buf, sizeof(buf), "%.6f", value));
+
+}  /* end p_comp_cache_append_double */
+
+
+/* ----------------------------------------------------
+ * p_comp_cache_append_file_identity
+ * ----------------------------------------------------
+ * append name and mtime of the specified file to the key
+ * (filename NULL or empty string is appended as "-")
+ */
+static void
+p_comp_cache_append_file_identity(GString *key, const char *filename)
+{
+  if(filename == NULL)
+  {
+    g_string_append(key, ":-");
+    return;
+  }
+  if(*filename == '\0')
+  {
+    g_string_append(key, ":-");
+    return;
+  }
+  g_string_append_printf(key, ":%s:%d"
+                        , filename
+                        , (int)gap_file_get_mtime(filename)
+                        );
+
+}  /* end p_comp_cache_append_file_identity */
+
+
+/* ----------------------------------------------------
+ * p_comp_cache_build_key
+ * ----------------------------------------------------
+ * build the cache key for the composite frame at master_frame_nr
+ * in the MAIN section.
+ * returns NULL if the composite cache is turned off
+ * or the frame refers to clips that can not be cached (sections, masks).
+ * the caller must g_free the returned key.
+ */
+static gchar *
+p_comp_cache_build_key(GapStoryRenderVidHandle *vidhand
+                    , gint32 master_frame_nr  /* starts at 1 */
+                    , gint32  vid_width
+                    , gint32  vid_height
+                    , const char *filtermacro_file
+                    )
+{
+  GapStbFetchData gapStbFetchData;
+  GapStbFetchData *gfd;
+  GString         *key;
+  gint32           l_track;
+  gboolean         isCacheable;
+
+  p_comp_cache_init_config();
+  if(gap_file_cache_is_enabled(&compCacheFcd) != TRUE)
+  {
+    return (NULL);
+  }
+  if(vidhand->is_mask_handle == TRUE)
+  {
+    return (NULL);
+  }
+
+  p_select_section_by_name(vidhand, NULL);
+
+  gfd = &gapStbFetchData;
+  isCacheable = TRUE;
+  key = g_string_new("[@STBCOMP]");
+  g_string_append_printf(key, ":%dx%d", (int)vid_width, (int)vid_height);
+  p_comp_cache_append_file_identity(key, filtermacro_file);
+  g_string_append_printf(key, ":%s"
+                        , vidhand->preferred_decoder ? vidhand->preferred_decoder : "-"
+                        );
+  /* the native rgb888 compositing may deliver other pixels than the gimp layer
+   * based rendering, therefore frames of both render paths are cached separately
+   */
+  g_string_append_printf(key, ":rgbc%d", (int)p_rgb_composite_is_enabled());
+
+  for(l_track = vidhand->minVidTrack; l_track <= vidhand->maxVidTrack; l_track++)
+  {
+    gfd->framename = p_fetch_framename(vidhand
+                 , master_frame_nr /* starts at 1 */
+                 , l_track
+                 , gfd
+                 );
+
+    g_string_append_printf(key, "|T%d:%d", (int)l_track, (int)gfd->frn_type);
+
+    if((gfd->frn_type == GAP_FRN_SECTION)
+    || ((gfd->frn_elem != NULL) && (gfd->frn_elem->mask_name != NULL)))
+    {
+      isCacheable = FALSE;
+    }
+
+    if((gfd->frn_type != GAP_FRN_SILENCE)
+    && (gfd->frn_elem != NULL)
+    && (isCacheable == TRUE))
+    {
+      GapStoryRenderFrameRangeElem *frn_elem;
+
+      frn_elem = gfd->frn_elem;
+
+      /* source frame identity */
+      p_comp_cache_append_file_identity(key, gfd->framename);
+      g_string_append_printf(key, ":%d", (int)gfd->localframe_index);
+      p_comp_cache_append_double(key, gfd->localframe_tween_rest);
+      /* deinterlace applies to all clip types (not only movies) */
+      p_comp_cache_append_double(key, frn_elem->delace);
+      if(gfd->frn_type == GAP_FRN_MOVIE)
+      {
+        g_string_append_printf(key, ":%d:%d", (int)frn_elem->seltrack, (int)frn_elem->exact_seek);
+        if(vidhand->master_insert_alpha_format)
+        {
+          gchar *alpha_imagename;
+
+          alpha_imagename = p_get_insert_alpha_filename(gfd, vidhand);
+          p_comp_cache_append_file_identity(key, alpha_imagename);
+          g_free(alpha_imagename);
+        }
+        if(vidhand->master_insert_area_format)
+        {
+          gchar *logo_imagename;
+
+          logo_imagename = p_get_insert_area_filename(gfd, vidhand);
+          p_comp_cache_append_file_identity(key, logo_imagename);
+          g_free(logo_imagename);
+        }
+      }
+      if(gfd->frn_type == GAP_FRN_COLOR)
+      {
+        p_comp_cache_append_double(key, gfd->red_f);
+        p_comp_cache_append_double(key, gfd->green_f);
+        p_comp_cache_append_double(key, gfd->blue_f);
+        p_comp_cache_append_double(key, gfd->alpha_f);
+      }
+
+      /* attributes at the current step */
+      p_comp_cache_append_double(key, gfd->rotate);
+      p_comp_cache_append_double(key, gfd->opacity);
+      p_comp_cache_append_double(key, gfd->scale_x);
+      p_comp_cache_append_double(key, gfd->scale_y);
+      p_comp_cache_append_double(key, gfd->move_x);
+      p_comp_cache_append_double(key, gfd->move_y);
+      g_string_append_printf(key, ":%d:%d:%d:%d"
+                        , (int)gfd->keep_proportions
+                        , (int)gfd->fit_width
+                        , (int)gfd->fit_height
+                        , (int)frn_elem->flip_request
+                        );
+
+      /* clip filtermacro (with optional varying parameters) */
+      if(p_isFiltermacroActive(gfd->trak_filtermacro_file))
+      {
+        p_comp_cache_append_file_identity(key, gfd->trak_filtermacro_file);
+        p_comp_cache_append_file_identity(key, frn_elem->filtermacro_file_to);
+        g_string_append_printf(key, ":%d:%d:%d"
+                        , (int)frn_elem->fmac_total_steps
+                        , (int)frn_elem->fmac_accel
+                        , (int)gfd->local_stepcount
+                        );
+      }
+
+      /* movepath transition */
+      if(gfd->movepath_file_xml != NULL)
+      {
+        p_comp_cache_append_file_identity(key, gfd->movepath_file_xml);
+        p_comp_cache_append_double(key, gfd->movepath_framePhase);
+      }
+    }
+
+    if(gfd->framename)
+    {
+      g_free(gfd->framename);
+    }
+    if(isCacheable != TRUE)
+    {
+      break;
+    }
+  }
+
+  if(isCacheable != TRUE)
+  {
+    if(gap_debug)
+    {
+      printf("p_comp_cache_build_key: master_frame_nr:%d is not cacheable (section or mask reference)\n"
+            , (int)master_frame_nr
+            );
+    }
+    g_string_free(key, TRUE);
+    return (NULL);
+  }
+
+  return (g_string_free(key, FALSE));
+
+}  /* end p_comp_cache_build_key */
+
+
+/* ----------------------------------------------------
+ * p_comp_cache_build_filename
+ * ----------------------------------------------------
+ */
+static gchar *
+p_comp_cache_build_filename(const gchar *key)
+{
+  gchar  name[40];
+
+  GVA_md5_string(name, key);
+
+  return (gap_file_cache_build_filename(&compCacheFcd, name));
+}  /* end p_comp_cache_build_filename */
+
+
+/* ----------------------------------------------------
+ * p_comp_cache_create_image_from_rgb888
+ * ----------------------------------------------------
+ * create a gimp image with one (opaque RGB) layer
+ * and fill it with the specified rgb888 data.
+ */
+static gint32
+p_comp_cache_create_image_from_rgb888(const guchar *rgb_data
+                    , gint32 vid_width, gint32 vid_height
+                    , gint32 *layer_id)
+{
+  GimpPixelRgn  pixel_rgn;
+  GimpDrawable *drawable;
+  gint32        image_id;
+
+  *layer_id = -1;
+  image_id = gimp_image_new(vid_width, vid_height, GIMP_RGB);
+  if(image_id < 0)
+  {
+    return (-1);
+  }
+  gimp_image_undo_disable(image_id);
+
+  *layer_id = gimp_layer_new(image_id, "composite",
+                          vid_width, vid_height,
+                          GIMP_RGB_IMAGE,
+                          100.0,     /* Opacity full opaque */
+                          GIMP_NORMAL_MODE);
+  gimp_image_add_layer(image_id, *layer_id, 0);
+
+  drawable = gimp_drawable_get (*layer_id);
+  gimp_pixel_rgn_init (&pixel_rgn, drawable, 0, 0, vid_width, vid_height, TRUE, FALSE);
+  gimp_pixel_rgn_set_rect (&pixel_rgn, (guchar *)rgb_data, 0, 0, vid_width, vid_height);
+  gimp_drawable_flush (drawable);
+  gimp_drawable_detach(drawable);
+
+  return (image_id);
+
+}  /* end p_comp_cache_create_image_from_rgb888 */
+
+
+/* ----------------------------------------------------
+ * p_comp_cache_fetch
+ * ----------------------------------------------------
+ * check if the composite frame for the specified key is available in the cache.
+ * on cache hit the frame is delivered
+ *  a) as rgb888 data in gapStoryFetchResult->raw_rgb_data
+ *     (when enable_rgb888_flag is TRUE and gapStoryFetchResult was provided)
+ *     *image_id is set to -1 in this case.
+ *  b) as newly created gimp image (*image_id and *layer_id)
+ *
+ * return TRUE on cache hit.
+ */
+static gboolean
+p_comp_cache_fetch(const gchar *key
+                    , gint32  vid_width
+                    , gint32  vid_height
+                    , gint32 *image_id
+                    , gint32 *layer_id
+                    , gboolean enable_rgb888_flag
+                    , GapStoryFetchResult *gapStoryFetchResult
+                    )
+{
+  GMappedFile  *mapped;
+  gchar        *filename;
+  const guchar *rgb_data;
+  gint32        hdr[GAP_STB_COMP_CACHE_HDR_COUNT];
+  gint32        frameSize;
+  gboolean      isHit;
+
+  static gint32 funcId = -1;
+
+  if(key == NULL)
+  {
+    return (FALSE);
+  }
+
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "p_comp_cache_fetch");
+
+  filename = p_comp_cache_build_filename(key);
+  mapped = g_mapped_file_new(filename, FALSE, NULL);
+  if(mapped == NULL)
+  {
+    compCacheMisses++;
+    g_free(filename);
+    return (FALSE);
+  }
+
+  GAP_TIMM_START_FUNCTION(funcId);
+
+  isHit = FALSE;
+  frameSize = vid_width * vid_height * GAP_STB_COMP_CACHE_BPP;
+  hdr[0] = vid_width;
+  hdr[1] = vid_height;
+
+  /* header: magic, width, height, keylen, key, rgb888 framedata */
+  rgb_data = gap_file_cache_check_contents(&compCacheFcd
+                         , g_mapped_file_get_contents(mapped)
+                         , g_mapped_file_get_length(mapped)
+                         , hdr, GAP_STB_COMP_CACHE_HDR_COUNT
+                         , key
+                         , frameSize
+                         );
+  if(rgb_data != NULL)
+  {
+    if((enable_rgb888_flag == TRUE)
+    && (gapStoryFetchResult != NULL))
+    {
+      if (gapStoryFetchResult->raw_rgb_data == NULL)
+      {
+        gapStoryFetchResult->raw_rgb_data = g_malloc(frameSize);
+      }
+      memcpy(gapStoryFetchResult->raw_rgb_data, rgb_data, frameSize);
+      gapStoryFetchResult->resultEnum = GAP_STORY_FETCH_RESULT_IS_RAW_RGB888;
+      *image_id = -1;
+      *layer_id = -1;
+      isHit = TRUE;
+    }
+    else
+    {
+      *image_id = p_comp_cache_create_image_from_rgb888(rgb_data, vid_width, vid_height, layer_id);
+      isHit = (*image_id >= 0);
+    }
+  }
+
+#if GLIB_CHECK_VERSION(2, 22, 0)
+  g_mapped_file_unref(mapped);
+#else
+  g_mapped_file_free(mapped);
+#endif
+
+  if(isHit)
+  {
+    /* update mtime of the cache file (mtime is used as last access time for LRU eviction) */
+    g_utime(filename, NULL);
+    compCacheHits++;
+  }
+  else
+  {
+    compCacheMisses++;
+  }
+
+  if(gap_debug)
+  {
+    printf("p_comp_cache_fetch: isHit:%d file:%s\n"
+          , (int)isHit
+          , filename
+          );
+  }
+  g_free(filename);
+
+  GAP_TIMM_STOP_FUNCTION(funcId);
+
+  return (isHit);
+
+}  /* end p_comp_cache_fetch */
+
+
+/* ----------------------------------------------------
+ * p_comp_cache_store
+ * ----------------------------------------------------
+ * write the rendered composite frame to the cache.
+ * The frame is taken from gapStoryFetchResult->raw_rgb_data
+ * when the result was delivered as rgb888 buffer (image_id < 0),
+ * otherwise from the (flattened) layer of the composite image.
+ */
+static void
+p_comp_cache_store(const gchar *key
+                    , gint32  vid_width
+                    , gint32  vid_height
+                    , gint32  image_id
+                    , gint32  layer_id
+                    , GapStoryFetchResult *gapStoryFetchResult
+                    )
+{
+  gchar    *filename;
+  guchar   *rgb_data;
+  guchar   *rgb_data_allocated;
+  gint32    hdr[GAP_STB_COMP_CACHE_HDR_COUNT];
+  gint32    frameSize;
+  gboolean  isWritten;
+
+  static gint32 funcId = -1;
+
+  if(key == NULL)
+  {
+    return;
+  }
+
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "p_comp_cache_store");
+  GAP_TIMM_START_FUNCTION(funcId);
+
+  frameSize = vid_width * vid_height * GAP_STB_COMP_CACHE_BPP;
+  rgb_data = NULL;
+  rgb_data_allocated = NULL;
+
+  if(image_id < 0)
+  {
+    if(gapStoryFetchResult != NULL)
+    {
+      if(gapStoryFetchResult->resultEnum == GAP_STORY_FETCH_RESULT_IS_RAW_RGB888)
+      {
+        rgb_data = gapStoryFetchResult->raw_rgb_data;
+      }
+    }
+  }
+  else if(layer_id >= 0)
+  {
+    GimpDrawable *drawable;
+
+    drawable = gimp_drawable_get (layer_id);
+    if((drawable->bpp == GAP_STB_COMP_CACHE_BPP)
+    && (drawable->width == vid_width)
+    && (drawable->height == vid_height))
+    {
+      GimpPixelRgn  pixel_rgn;
+
+      rgb_data_allocated = g_malloc(frameSize);
+      gimp_pixel_rgn_init (&pixel_rgn, drawable, 0, 0, vid_width, vid_height, FALSE, FALSE);
+      gimp_pixel_rgn_get_rect (&pixel_rgn, rgb_data_allocated, 0, 0, vid_width, vid_height);
+      rgb_data = rgb_data_allocated;
+    }
+    gimp_drawable_detach(drawable);
+  }
+
+  if(rgb_data == NULL)
+  {
+    GAP_TIMM_STOP_FUNCTION(funcId);
+    return;
+  }
+
+  hdr[0] = vid_width;
+  hdr[1] = vid_height;
+
+  filename = p_comp_cache_build_filename(key);
+  isWritten = gap_file_cache_write_file(&compCacheFcd
+                         , filename
+                         , hdr, GAP_STB_COMP_CACHE_HDR_COUNT
+                         , key
+                         , rgb_data, frameSize
+                         );
+  if(isWritten)
+  {
+    compCacheStores++;
+    gap_file_cache_add_stored_bytes(&compCacheFcd
+                         , gap_file_cache_get_file_size(GAP_STB_COMP_CACHE_HDR_COUNT, key, frameSize)
+                         );
+  }
+
+  if(gap_debug)
+  {
+    printf("p_comp_cache_store: isWritten:%d file:%s\n"
+          , (int)isWritten
+          , filename
+          );
+  }
+
+  if(rgb_data_allocated != NULL)
+  {
+    g_free(rgb_data_allocated);
+  }
+  g_free(filename);
+
+  GAP_TIMM_STOP_FUNCTION(funcId);
+
+}  /* end p_comp_cache_store */
+
+
+/* ----------------------------------------------------
+ * p_comp_cache_print_statistics
+ * ----------------------------------------------------
+ */
+static void
+p_comp_cache_print_statistics(void)
+{
+  if(gap_file_cache_is_enabled(&compCacheFcd))
+  {
+    printf("storyboard composite cache: hits:%d misses:%d stores:%d total size:%.1f MB (limit:%d MB) dir:%s\n"
+          , (int)compCacheHits
+          , (int)compCacheMisses
+          , (int)compCacheStores
+          , (float)MAX(0, compCacheFcd.totalBytes) / (1024.0 * 1024.0)
+          , (int)compCacheFcd.maxMB
+          , compCacheFcd.dir
+          );
+  }
+}  /* end p_comp_cache_print_statistics */
+
+#endif
@@ -0,0 +1,334 @@
+/* gap_story_render_frn_index_bench.c
+ *
+ * GAP ... Gimp Animation Plugins
+ *
+ * equality check and benchmark for the interval index p_frn_index_locate
+ * of the storyboard render processor (gap_story_render_processor.c)
+ *
+ * Framerange lists are generated (random tracks and frames_to_handle
+ * with a fixed seed, some elements with the wait_until attribute).
+ * For each list the element at the start, the start +1, the end and the end +1
+ * master frame of every element, and of random master frames, is located twice:
+ *   a) by p_frn_list_locate, the original sequential scan of the frn_list
+ *   b) by p_frn_index_locate with the index built by p_frn_index_new
+ * Both must deliver the same element, frame_group_count and found_at_idx.
+ *
+ * usage:
+ *   gap_story_render_frn_index_bench            equality check (run by make check)
+ *   gap_story_render_frn_index_bench -b [n]     equality check and benchmark
+ *                                               of sequential rendering on a list
+ *                                               with n elements (default 10000)
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * 2026.10.18  created
+ */
+
+/* included (not linked) to access the static frn_list locate procedures */
+#include "gap_story_render_processor.c"
+
+#define BENCH_MAX_TRACK  4
+
+int gap_debug = 0;  /* 1 == print debug infos , 0 dont print debug infos */
+
+
+/* ---------------------------------
+ * p_generate_frn_list
+ * ---------------------------------
+ * generate a frn_list with count elements in the tracks 1 .. BENCH_MAX_TRACK.
+ * if allowNegative is TRUE some elements get a negative length
+ * (the index must fall back to the sequential scan in such tracks)
+ */
+static GapStoryRenderFrameRangeElem *
+p_generate_frn_list(gint32 count, gint32 maxFrames, gboolean allowNegative, guint32 seed)
+{
+  GapStoryRenderFrameRangeElem *frn_list;
+  GapStoryRenderFrameRangeElem *frn_prev;
+  GapStoryRenderFrameRangeElem *frn_elem;
+  GRand                        *rand;
+  gint32                        ii;
+
+  rand = g_rand_new_with_seed(seed);
+  frn_list = NULL;
+  frn_prev = NULL;
+  for(ii = 0; ii < count; ii++)
+  {
+    frn_elem = g_new0(GapStoryRenderFrameRangeElem, 1);
+    frn_elem->track = g_rand_int_range(rand, 1, BENCH_MAX_TRACK + 1);
+    frn_elem->frames_to_handle = g_rand_int_range(rand, 0, maxFrames + 1);
+    if((allowNegative) && (g_rand_int_range(rand, 0, 50) == 0))
+    {
+      frn_elem->frames_to_handle = -frn_elem->frames_to_handle;
+    }
+    if(g_rand_int_range(rand, 0, 20) == 0)
+    {
+      frn_elem->wait_untiltime_sec = 1.0;
+      frn_elem->wait_untilframes = g_rand_int_range(rand, 0, (ii * maxFrames / 4) + maxFrames + 1);
+    }
+
+    if(frn_prev == NULL)
+    {
+      frn_list = frn_elem;
+    }
+    else
+    {
+      frn_prev->next = frn_elem;
+    }
+    frn_prev = frn_elem;
+  }
+  g_rand_free(rand);
+
+  return (frn_list);
+}  /* end p_generate_frn_list */
+
+
+/* ---------------------------------
+ * p_free_frn_list
+ * ---------------------------------
+ */
+static void
+p_free_frn_list(GapStoryRenderFrameRangeElem *frn_list)
+{
+  GapStoryRenderFrameRangeElem *frn_elem;
+  GapStoryRenderFrameRangeElem *frn_next;
+
+  for(frn_elem = frn_list; frn_elem != NULL; frn_elem = frn_next)
+  {
+    frn_next = (GapStoryRenderFrameRangeElem *)frn_elem->next;
+    g_free(frn_elem);
+  }
+}  /* end p_free_frn_list */
+
+
+/* ---------------------------------
+ * p_check_one_nr
+ * ---------------------------------
+ * return 1 if list scan and index deliver different results, else 0
+ */
+static gint32
+p_check_one_nr(GapStoryRenderFrnIndex *frnidx, gint32 master_frame_nr, gint32 track)
+{
+  GapStoryRenderFrameRangeElem *elemList;
+  GapStoryRenderFrameRangeElem *elemIndex;
+  gint32  groupCountList;
+  gint32  groupCountIndex;
+  gint32  foundIdxList;
+  gint32  foundIdxIndex;
+
+  elemList = p_frn_list_locate(frnidx->frn_list, master_frame_nr, track, &groupCountList, &foundIdxList);
+  elemIndex = p_frn_index_locate(frnidx, master_frame_nr, track, &groupCountIndex, &foundIdxIndex);
+
+  if((elemList != elemIndex)
+  || (groupCountList != groupCountIndex)
+  || (foundIdxList != foundIdxIndex))
+  {
+    printf("MISMATCH track:%d master_frame_nr:%d list:(%d %d) index:(%d %d)\n"
+          , (int)track
+          , (int)master_frame_nr
+          , (int)groupCountList, (int)foundIdxList
+          , (int)groupCountIndex, (int)foundIdxIndex
+          );
+    return (1);
+  }
+  return (0);
+}  /* end p_check_one_nr */
+
+
+/* ---------------------------------
+ * p_check_one_list
+ * ---------------------------------
+ * return the number of differing lookups
+ */
+static gint32
+p_check_one_list(gint32 count, gint32 maxFrames, gboolean allowNegative, guint32 seed)
+{
+  GapStoryRenderFrameRangeElem *frn_list;
+  GapStoryRenderFrnIndex       *frnidx;
+  GRand                        *rand;
+  gint32                        errors;
+  gint32                        track;
+  gint32                        ti;
+  gint32                        ii;
+
+  frn_list = p_generate_frn_list(count, maxFrames, allowNegative, seed);
+  frnidx = p_frn_index_new(frn_list);
+  rand = g_rand_new_with_seed(seed);
+  errors = 0;
+
+  /* track 0 and BENCH_MAX_TRACK +1 have no elements */
+  for(track = 0; track <= BENCH_MAX_TRACK + 1; track++)
+  {
+    GapStoryRenderFrnIndexTrack *itrack;
+    gint32 l_total;
+
+    itrack = p_frn_index_find_track(frnidx, track);
+    l_total = 0;
+    if(itrack != NULL)
+    {
+      for(ti = 0; ti < itrack->count; ti++)
+      {
+        errors += p_check_one_nr(frnidx, itrack->start[ti], track);
+        errors += p_check_one_nr(frnidx, itrack->start[ti] + 1, track);
+        errors += p_check_one_nr(frnidx, itrack->end[ti], track);
+        errors += p_check_one_nr(frnidx, itrack->end[ti] + 1, track);
+        l_total = MAX(l_total, itrack->end[ti]);
+      }
+    }
+    for(ii = 0; ii < 200; ii++)
+    {
+      errors += p_check_one_nr(frnidx, g_rand_int_range(rand, -2, l_total + 3), track);
+    }
+  }
+
+  g_rand_free(rand);
+  p_frn_index_free(frnidx);
+  p_free_frn_list(frn_list);
+
+  return (errors);
+}  /* end p_check_one_list */
+
+
+/* ---------------------------------
+ * p_bench_sequential
+ * ---------------------------------
+ * locate the elements of all tracks for master frames 1 .. total
+ * (as done by sequential rendering) with list scan and index.
+ * The master frame step is chosen for about 20000 frames.
+ */
+static gint32
+p_bench_sequential(gint32 count)
+{
+  GapStoryRenderFrameRangeElem *frn_list;
+  GapStoryRenderFrnIndex       *frnidx;
+  GTimer                       *timer;
+  gdouble                       timeList;
+  gdouble                       timeIndex;
+  gint32                        l_total;
+  gint32                        l_step;
+  gint32                        l_lookups;
+  gint32                        errors;
+  gint32                        master_frame_nr;
+  gint32                        track;
+  gint32                        ii;
+
+  frn_list = p_generate_frn_list(count, 100, FALSE, 4711);
+  frnidx = p_frn_index_new(frn_list);
+
+  l_total = 0;
+  for(ii = 0; ii < frnidx->numTracks; ii++)
+  {
+    l_total = MAX(l_total, frnidx->itracks[ii].end[frnidx->itracks[ii].count -1]);
+  }
+  l_step = MAX(1, l_total / 20000);
+
+  timer = g_timer_new();
+  timeList = 0.0;
+  timeIndex = 0.0;
+  errors = 0;
+  l_lookups = 0;
+  for(master_frame_nr = 1; master_frame_nr <= l_total; master_frame_nr += l_step)
+  {
+    for(track = 1; track <= BENCH_MAX_TRACK; track++)
+    {
+      GapStoryRenderFrameRangeElem *elemList;
+      GapStoryRenderFrameRangeElem *elemIndex;
+      gint32  groupCountList;
+      gint32  groupCountIndex;
+      gint32  foundIdxList;
+      gint32  foundIdxIndex;
+
+      g_timer_start(timer);
+      elemList = p_frn_list_locate(frn_list, master_frame_nr, track, &groupCountList, &foundIdxList);
+      timeList += g_timer_elapsed(timer, NULL);
+
+      g_timer_start(timer);
+      elemIndex = p_frn_index_locate(frnidx, master_frame_nr, track, &groupCountIndex, &foundIdxIndex);
+      timeIndex += g_timer_elapsed(timer, NULL);
+
+      if((elemList != elemIndex)
+      || (groupCountList != groupCountIndex)
+      || (foundIdxList != foundIdxIndex))
+      {
+        errors++;
+      }
+      l_lookups++;
+    }
+  }
+
+  printf("sequential n=%d frames:%d lookups:%d list:%9.1f ms index:%9.1f ms (%.1f x) %s\n"
+        , (int)count
+        , (int)l_total
+        , (int)l_lookups
+        , timeList * 1000.0
+        , timeIndex * 1000.0
+        , (timeIndex > 0.0) ? timeList / timeIndex : 0.0
+        , (errors == 0) ? "identical" : "MISMATCH"
+        );
+
+  g_timer_destroy(timer);
+  p_frn_index_free(frnidx);
+  p_free_frn_list(frn_list);
+
+  return (errors);
+}  /* end p_bench_sequential */
+
+
+/* ---------------------------------
+ * main
+ * ---------------------------------
+ */
+int
+main(int argc, char *argv[])
+{
+  static const gint32  counts[] = { 1, 2, 10, 100, 1000 };
+  gint32    errors;
+  guint     ci;
+  gint      negative;
+
+  errors = 0;
+  for(negative = 0; negative < 2; negative++)
+  {
+    for(ci = 0; ci < G_N_ELEMENTS(counts); ci++)
+    {
+      errors += p_check_one_list(counts[ci], 20, negative, 100 + ci);
+      errors += p_check_one_list(counts[ci], 2, negative, 200 + ci);
+    }
+  }
+
+  if((argc > 1) && (strcmp(argv[1], "-b") == 0))
+  {
+    gint32 count;
+
+    count = 10000;
+    if(argc > 2)
+    {
+      count = MAX(1, atoi(argv[2]));
+    }
+    errors += p_bench_sequential(count);
+  }
+
+  printf("frn_index equality check: %s (%d lookups differ)\n"
+        , (errors == 0) ? "OK" : "FAILED"
+        , (int)errors
+        );
+
+  return ((errors == 0) ? 0 : 1);
+
+}  /* end main */
@@ -361,7 +361,7 @@ p_check_chunk_fetch_possible(GapStoryRenderVidHandle *vidhand
    */
   for(l_track = vidhand->maxVidTrack; l_track >= vidhand->minVidTrack; l_track--)
   {
-    l_framename = p_fetch_framename(vidhand->frn_list
+    l_framename = p_fetch_framename(vidhand
                  , master_frame_nr /* starts at 1 */
                  , l_track
                  , gfd
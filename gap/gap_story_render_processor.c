@@ -77,6 +77,7 @@
 #include "gap_story_render_audio.h"
 #include "gap_story_render_processor.h"
 #include "gap_fmac_name.h"
+#include "gap_fmac_base.h"
 #include "gap_frame_fetcher.h"
 #include "gap_accel_char.h"
 #include "gap_mov_exec.h"
@@ -228,7 +229,23 @@ static gdouble  p_attribute__at_step(gint32 frame_step /* current frame (since s
 static void     p_select_section_by_name(GapStoryRenderVidHandle *vidhand
                   , const char *section_name);
 
-static char*    p_fetch_framename   (GapStoryRenderFrameRangeElem *frn_list
+static void     p_frn_index_free(GapStoryRenderFrnIndex *frnidx);
+static GapStoryRenderFrnIndexTrack * p_frn_index_find_track(GapStoryRenderFrnIndex *frnidx, gint32 track);
+static GapStoryRenderFrnIndex * p_frn_index_new(GapStoryRenderFrameRangeElem *frn_list);
+static void     p_frn_index_build_all_sections(GapStoryRenderVidHandle *vidhand);
+static GapStoryRenderFrameRangeElem * p_frn_list_locate(GapStoryRenderFrameRangeElem *frn_list
+                            , gint32 master_frame_nr
+                            , gint32 track
+                            , gint32 *frame_group_count
+                            , gint32 *found_at_idx
+                            );
+static GapStoryRenderFrameRangeElem * p_frn_index_locate(GapStoryRenderFrnIndex *frnidx
+                            , gint32 master_frame_nr
+                            , gint32 track
+                            , gint32 *frame_group_count
+                            , gint32 *found_at_idx
+                            );
+static char*    p_fetch_framename   (GapStoryRenderVidHandle *vidhand
                             , gint32 master_frame_nr                   /* starts at 1 */
                             , gint32 track
                             , GapStbFetchData *gfd        /* out: result structure of the fetch */
@@ -471,7 +488,19 @@ static void    p_stb_render_movie_single_processor(GapStbFetchData *gfd
                       , gint32  vid_height);
 static void    p_call_GVA_get_next_frame_andSendReadySignal(VideoPrefetchData *vpre, gint32 targetFrameNumber);
 static void    p_videoPrefetchWorkerThreadFunction (VideoPrefetchData *vpre);
+static GapStoryRenderFrameRangeElem * p_get_next_clip_in_track(GapStoryRenderFrameRangeElem *frn_elem);
+static gboolean p_is_continued_video_clip(GapStoryRenderFrameRangeElem *frn_elem
+                      , GapStoryRenderFrameRangeElem *frn_elem_next
+                      , gint32 maxGap);
 static gint32  p_getPredictedNextFramenr(gint32 targetFrameNr, GapStoryRenderFrameRangeElem *frn_elem);
+static void    p_stb_trigger_prefetch(GapStbFetchData *gfd
+                      , gint32 targetFrameNumber
+                      , gint32 track);
+static VideoPrefetchData * p_get_VideoPrefetchData(GapStbFetchData *gfd
+                      , gint32 targetFrameNumber
+                      , gint32 predictedNextFrameNr);
+static void    p_stb_prefetch_movie_tracks(GapStoryRenderVidHandle *vidhand
+                      , gint32 master_frame_nr);
 static void    p_stb_render_movie_multiprocessor(GapStbFetchData *gfd
                       , GapStoryRenderVidHandle *vidhand
                       , gint32 master_frame_nr
@@ -517,6 +546,8 @@ static void       p_do_insert_alpha_processing(GapStbFetchData *gfd
                       , GapStoryRenderVidHandle *vidhand);
 
 static gboolean  p_isFiltermacroActive(const char *filtermacro_file);
+static gboolean  p_is_auto_insert_active(GapStbFetchData *gfd
+                    , GapStoryRenderVidHandle *vidhand);
 static gboolean  p_story_render_bypass_where_possible(GapStoryRenderVidHandle *vidhand
                     , gint32 master_frame_nr  /* starts at 1 */
                     , gint32  vid_width       /* desired Video Width in pixels */
@@ -524,6 +555,36 @@ static gboolean  p_story_render_bypass_where_possible(GapStoryRenderVidHandle *v
                     , gboolean enable_rgb888_flag  /* enable fetch as rgb888 data buffer */
                     , GapStoryFetchResult      *gapStoryFetchResult
                     );
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+static gboolean  p_story_render_rgb_composite_where_possible(GapStoryRenderVidHandle *vidhand
+                    , gint32 master_frame_nr  /* starts at 1 */
+                    , gint32  vid_width       /* desired Video Width in pixels */
+                    , gint32  vid_height      /* desired Video Height in pixels */
+                    , GapStoryFetchResult      *gapStoryFetchResult
+                    );
+static gchar *   p_comp_cache_build_key(GapStoryRenderVidHandle *vidhand
+                    , gint32 master_frame_nr  /* starts at 1 */
+                    , gint32  vid_width
+                    , gint32  vid_height
+                    , const char *filtermacro_file
+                    );
+static gboolean  p_comp_cache_fetch(const gchar *key
+                    , gint32  vid_width
+                    , gint32  vid_height
+                    , gint32 *image_id
+                    , gint32 *layer_id
+                    , gboolean enable_rgb888_flag
+                    , GapStoryFetchResult *gapStoryFetchResult
+                    );
+static void      p_comp_cache_store(const gchar *key
+                    , gint32  vid_width
+                    , gint32  vid_height
+                    , gint32  image_id
+                    , gint32  layer_id
+                    , GapStoryFetchResult *gapStoryFetchResult
+                    );
+static void      p_comp_cache_print_statistics(void);
+#endif
 
 static gint32    p_story_render_fetch_composite_image_private(GapStoryRenderVidHandle *vidhand
                     , gint32 master_frame_nr       /* starts at 1 */
@@ -1300,6 +1361,7 @@ p_select_section_by_name(GapStoryRenderVidHandle *vidhand, const char *section_n
   if (section != NULL)
   {
     vidhand->aud_list = section->aud_list;
+    vidhand->frn_index = section->frn_index;
     if(vidhand->frn_list != section->frn_list)
     {
       vidhand->frn_list = section->frn_list;
@@ -1309,6 +1371,7 @@ p_select_section_by_name(GapStoryRenderVidHandle *vidhand, const char *section_n
   else
   {
     vidhand->frn_list = NULL;
+    vidhand->frn_index = NULL;
     vidhand->aud_list = NULL;
     p_refresh_min_max_vid_tracknumbers(vidhand);
   }
@@ -1327,12 +1390,313 @@ p_select_section_by_name(GapStoryRenderVidHandle *vidhand, const char *section_n
 
 
 
+/* ----------------------------------------------------
+ * p_frn_index_free
+ * ----------------------------------------------------
+ */
+static void
+p_frn_index_free(GapStoryRenderFrnIndex *frnidx)
+{
+  gint32 ii;
+
+  if(frnidx == NULL)
+  {
+    return;
+  }
+  for(ii = 0; ii < frnidx->numTracks; ii++)
+  {
+    GapStoryRenderFrnIndexTrack *itrack;
+
+    itrack = &frnidx->itracks[ii];
+    g_free(itrack->start);
+    g_free(itrack->end);
+    g_free(itrack->list_idx);
+    g_free(itrack->elems);
+  }
+  g_free(frnidx->itracks);
+  g_free(frnidx);
+
+}  /* end p_frn_index_free */
+
+
+/* ----------------------------------------------------
+ * p_frn_index_find_track
+ * ----------------------------------------------------
+ * return the index track for the specified track number
+ * or NULL if the index has no elements in this track.
+ * (there are only a few tracks in typical storyboards,
+ *  therefore a simple sequential search is used here)
+ */
+static GapStoryRenderFrnIndexTrack *
+p_frn_index_find_track(GapStoryRenderFrnIndex *frnidx, gint32 track)
+{
+  gint32 ii;
+
+  for(ii = 0; ii < frnidx->numTracks; ii++)
+  {
+    if(frnidx->itracks[ii].track == track)
+    {
+      return (&frnidx->itracks[ii]);
+    }
+  }
+  return (NULL);
+
+}  /* end p_frn_index_find_track */
+
+
+/* ----------------------------------------------------
+ * p_frn_index_new
+ * ----------------------------------------------------
+ * compile the specified frn_list into one sorted interval array per track.
+ * start and end are the prefix sums of the frames handled by the
+ * preceding elements in the same track, calculated exactly the same way
+ * as the sequential scan in p_frn_list_locate does
+ * (the wait_until attribute depends on the frames before the element).
+ *
+ * returns NULL for an empty frn_list.
+ */
+static GapStoryRenderFrnIndex *
+p_frn_index_new(GapStoryRenderFrameRangeElem *frn_list)
+{
+  GapStoryRenderFrnIndex       *frnidx;
+  GapStoryRenderFrnIndexTrack  *itrack;
+  GapStoryRenderFrameRangeElem *frn_elem;
+  gint32                        l_list_length;
+  gint32                        l_idx;
+  gint32                        ii;
+
+  l_list_length = 0;
+  for(frn_elem = frn_list; frn_elem != NULL; frn_elem = (GapStoryRenderFrameRangeElem *)frn_elem->next)
+  {
+    l_list_length++;
+  }
+  if(l_list_length == 0)
+  {
+    return (NULL);
+  }
+
+  frnidx = g_new(GapStoryRenderFrnIndex, 1);
+  frnidx->frn_list = frn_list;
+  frnidx->list_length = l_list_length;
+  frnidx->numTracks = 0;
+  frnidx->itracks = g_new0(GapStoryRenderFrnIndexTrack, l_list_length);
+
+  /* pass 1: count the elements per track */
+  for(frn_elem = frn_list; frn_elem != NULL; frn_elem = (GapStoryRenderFrameRangeElem *)frn_elem->next)
+  {
+    itrack = p_frn_index_find_track(frnidx, frn_elem->track);
+    if(itrack == NULL)
+    {
+      itrack = &frnidx->itracks[frnidx->numTracks];
+      itrack->track = frn_elem->track;
+      frnidx->numTracks++;
+    }
+    itrack->count++;
+  }
+  frnidx->itracks = g_renew(GapStoryRenderFrnIndexTrack, frnidx->itracks, frnidx->numTracks);
+
+  for(ii = 0; ii < frnidx->numTracks; ii++)
+  {
+    itrack = &frnidx->itracks[ii];
+    itrack->start    = g_new(gint32, itrack->count);
+    itrack->end      = g_new(gint32, itrack->count);
+    itrack->list_idx = g_new(gint32, itrack->count);
+    itrack->elems    = g_new(GapStoryRenderFrameRangeElem *, itrack->count);
+    itrack->isSorted = TRUE;
+    itrack->count    = 0;  /* is incremented again while filling in pass 2 */
+  }
+
+  /* pass 2: fill the interval arrays */
+  l_idx = 0;
+  for(frn_elem = frn_list; frn_elem != NULL; frn_elem = (GapStoryRenderFrameRangeElem *)frn_elem->next)
+  {
+    gint32 l_start;
+    gint32 l_frames_to_handle;
+    gint32 l_pos;
+
+    itrack = p_frn_index_find_track(frnidx, frn_elem->track);
+    l_pos = itrack->count;
+    l_start = 0;
+    if(l_pos > 0)
+    {
+      l_start = itrack->end[l_pos -1];
+    }
+
+    l_frames_to_handle = frn_elem->frames_to_handle;
+    if (frn_elem->wait_untiltime_sec > 0)
+    {
+      l_frames_to_handle += MAX(0, frn_elem->wait_untilframes - l_start);
+    }
+
+    itrack->start[l_pos]    = l_start;
+    itrack->end[l_pos]      = l_start + l_frames_to_handle;
+    itrack->list_idx[l_pos] = l_idx;
+    itrack->elems[l_pos]    = frn_elem;
+    if(itrack->end[l_pos] < l_start)
+    {
+      /* negative length would break the binary search */
+      itrack->isSorted = FALSE;
+    }
+    itrack->count++;
+    l_idx++;
+  }
+
+  if(gap_debug)
+  {
+    printf("p_frn_index_new: frn_list:%d list_length:%d numTracks:%d\n"
+      , (int)frn_list
+      , (int)frnidx->list_length
+      , (int)frnidx->numTracks
+      );
+  }
+
+  return (frnidx);
+
+}  /* end p_frn_index_new */
+
+
+/* ----------------------------------------------------
+ * p_frn_index_build_all_sections
+ * ----------------------------------------------------
+ * (re)build the frn_index for the frn_list of all sections
+ * of the specified video handle.
+ * This procedure is called once at the end of opening
+ * the video handle, when the frn_lists are complete.
+ */
+static void
+p_frn_index_build_all_sections(GapStoryRenderVidHandle *vidhand)
+{
+  GapStoryRenderSection *section;
+
+  for(section = vidhand->section_list; section != NULL; section = section->next)
+  {
+    p_frn_index_free(section->frn_index);
+    section->frn_index = p_frn_index_new(section->frn_list);
+  }
+  vidhand->frn_index = NULL;
+
+}  /* end p_frn_index_build_all_sections */
+
+
+/* ----------------------------------------------------
+ * p_frn_list_locate
+ * ----------------------------------------------------
+ * sequential search for the element in the specified track
+ * that covers master_frame_nr (starts at 1).
+ * frame_group_count is set to the number of frames in the track
+ * before the found element.
+ * found_at_idx is set to the position of the element in the list.
+ *
+ * returns NULL if there is no element at the master_frame_nr in the track.
+ */
+static GapStoryRenderFrameRangeElem *
+p_frn_list_locate(GapStoryRenderFrameRangeElem *frn_list
+                 , gint32 master_frame_nr
+                 , gint32 track
+                 , gint32 *frame_group_count
+                 , gint32 *found_at_idx
+                 )
+{
+  GapStoryRenderFrameRangeElem *frn_elem;
+  gint32  l_frame_group_count;
+  gint32  l_found_at_idx;
+  gint32  l_frames_to_handle;
+
+  l_frame_group_count = 0;
+  l_found_at_idx = 0;
+  for (frn_elem = frn_list; frn_elem != NULL; frn_elem = (GapStoryRenderFrameRangeElem *)frn_elem->next)
+  {
+    if(frn_elem->track == track)
+    {
+      l_frames_to_handle = frn_elem->frames_to_handle;
+      if (frn_elem->wait_untiltime_sec > 0)
+      {
+        l_frames_to_handle += MAX(0, frn_elem->wait_untilframes - l_frame_group_count);
+      }
+      if (master_frame_nr <= l_frame_group_count + l_frames_to_handle)
+      {
+        break;
+      }
+      l_frame_group_count += l_frames_to_handle;
+    }
+    l_found_at_idx++;
+  }
+
+  *frame_group_count = l_frame_group_count;
+  *found_at_idx = l_found_at_idx;
+  return (frn_elem);
+
+}  /* end p_frn_list_locate */
+
+
+/* ----------------------------------------------------
+ * p_frn_index_locate
+ * ----------------------------------------------------
+ * same as p_frn_list_locate, but uses binary search in the interval index.
+ * The index is only read here (no cursor of the most recent hit),
+ * because the lookups may run in parallel.
+ */
+static GapStoryRenderFrameRangeElem *
+p_frn_index_locate(GapStoryRenderFrnIndex *frnidx
+                 , gint32 master_frame_nr
+                 , gint32 track
+                 , gint32 *frame_group_count
+                 , gint32 *found_at_idx
+                 )
+{
+  GapStoryRenderFrnIndexTrack *itrack;
+  gint32  l_lo;
+  gint32  l_hi;
+
+  itrack = p_frn_index_find_track(frnidx, track);
+  if(itrack == NULL)
+  {
+    *frame_group_count = 0;
+    *found_at_idx = frnidx->list_length;
+    return (NULL);
+  }
+  if(itrack->isSorted != TRUE)
+  {
+    return (p_frn_list_locate(frnidx->frn_list, master_frame_nr, track, frame_group_count, found_at_idx));
+  }
+
+  /* binary search for the first element with end >= master_frame_nr */
+  l_lo = 0;
+  l_hi = itrack->count;
+  while(l_lo < l_hi)
+  {
+    gint32 l_mid;
+
+    l_mid = l_lo + ((l_hi - l_lo) / 2);
+    if(itrack->end[l_mid] < master_frame_nr)
+    {
+      l_lo = l_mid + 1;
+    }
+    else
+    {
+      l_hi = l_mid;
+    }
+  }
+  if(l_lo >= itrack->count)
+  {
+    *frame_group_count = itrack->end[itrack->count -1];
+    *found_at_idx = frnidx->list_length;
+    return (NULL);
+  }
+
+  *frame_group_count = itrack->start[l_lo];
+  *found_at_idx = itrack->list_idx[l_lo];
+  return (itrack->elems[l_lo]);
+
+}  /* end p_frn_index_locate */
+
+
 /* ----------------------------------------------------
  * p_fetch_framename
  * ----------------------------------------------------
  * fetch frame access (framename or videofilename framenumber)
  * and transition values relevant for a given master_frame_nr in the given video track
- * within a storyboard framerange list.
+ * within the storyboard framerange list of the current section of the video handle.
  * (simple animations without a storyboard file
  *  are represented by a short storyboard framerange list that has
  *  just one element entry at track 1).
@@ -1346,9 +1710,12 @@ p_select_section_by_name(GapStoryRenderVidHandle *vidhand, const char *section_n
  * (in this cases localframe_index referes to the relevant framenumber in the videofile
  * or to the layerstack position in the multilayer image)
  * gfd->framename is set to NULL if there is no frame at desired track and master_frame_nr
+ *
+ * The element is located via the interval index of the section
+ * (falls back to sequential search in the frn_list if there is no valid index).
  */
 static char *
-p_fetch_framename(GapStoryRenderFrameRangeElem *frn_list
+p_fetch_framename(GapStoryRenderVidHandle *vidhand
                  , gint32 master_frame_nr      /* starts at 1 */
                  , gint32 track
                  , GapStbFetchData *gfd        /* out: result structure of the fetch */
@@ -1360,7 +1727,6 @@ p_fetch_framename(GapStoryRenderFrameRangeElem *frn_list
   gint32  l_fnr;
   gint32  l_step;
   gint32  l_found_at_idx;
-  gint32  l_frames_to_handle;
 
   l_frame_group_count = 0;
   l_framename = NULL;
@@ -1389,188 +1755,192 @@ p_fetch_framename(GapStoryRenderFrameRangeElem *frn_list
   gfd->movepath_framePhase   = 0;
 
   l_found_at_idx=0;
-  for (frn_elem = frn_list; frn_elem != NULL; frn_elem = (GapStoryRenderFrameRangeElem *)frn_elem->next)
+  if((vidhand->frn_index != NULL)
+  && (vidhand->frn_index->frn_list == vidhand->frn_list))
+  {
+    frn_elem = p_frn_index_locate(vidhand->frn_index
+                 , master_frame_nr
+                 , track
+                 , &l_frame_group_count
+                 , &l_found_at_idx
+                 );
+  }
+  else
   {
-    if(frn_elem->track == track)
-    {
-      l_frames_to_handle = frn_elem->frames_to_handle;
-      if (frn_elem->wait_untiltime_sec > 0)
-      {
-        l_frames_to_handle += MAX(0, frn_elem->wait_untilframes - l_frame_group_count);
-      }
-      if (master_frame_nr <= l_frame_group_count + l_frames_to_handle)
-      {
-        gdouble fnr;
+    frn_elem = p_frn_list_locate(vidhand->frn_list
+                 , master_frame_nr
+                 , track
+                 , &l_frame_group_count
+                 , &l_found_at_idx
+                 );
+  }
 
-        /* calculate positive or negative offset from_frame to desired frame */
-        fnr = (gdouble)(frn_elem->delta * (master_frame_nr - (l_frame_group_count +1 )))
-              * frn_elem->step_density;
+  if(frn_elem != NULL)
+  {
+    gdouble fnr;
 
-        /* calculate framenumber local to the clip */
-        l_fnr = (gint32)(frn_elem->frame_from + fnr);
+    /* calculate positive or negative offset from_frame to desired frame */
+    fnr = (gdouble)(frn_elem->delta * (master_frame_nr - (l_frame_group_count +1 )))
+          * frn_elem->step_density;
 
-        {
-          gint32 fnrInt;
+    /* calculate framenumber local to the clip */
+    l_fnr = (gint32)(frn_elem->frame_from + fnr);
 
-          fnrInt = fnr;  /* truncate to integer */
+    {
+      gint32 fnrInt;
 
-          gfd->localframe_tween_rest = fnr - fnrInt;
+      fnrInt = fnr;  /* truncate to integer */
 
-          if(gap_debug)
-          {
-            printf("fnr:%.4f, fnrInt:%d localframe_tween_rest:%.4f\n"
-                     ,(float)fnr
-                     ,(int)fnrInt
-                     ,(float)gfd->localframe_tween_rest
-                     );
-          }
-        }
+      gfd->localframe_tween_rest = fnr - fnrInt;
 
-        gfd->local_stepcount = master_frame_nr - l_frame_group_count;
-        gfd->local_stepcount -= 1;
+      if(gap_debug)
+      {
+        printf("fnr:%.4f, fnrInt:%d localframe_tween_rest:%.4f\n"
+                 ,(float)fnr
+                 ,(int)fnrInt
+                 ,(float)gfd->localframe_tween_rest
+                 );
+      }
+    }
 
-        switch(frn_elem->frn_type)
-        {
-          case GAP_FRN_SILENCE:
-          case GAP_FRN_COLOR:
-            l_framename = NULL;   /* there is no filename for video silence or unicolor */
-            break;
-          case GAP_FRN_IMAGE:
-            l_framename = g_strdup(frn_elem->basename);   /* use 1:1 basename for single images */
-            break;
-          case GAP_FRN_ANIMIMAGE:
-            l_framename = g_strdup(frn_elem->basename);   /* use 1:1 basename for ainimated single images */
-            gfd->localframe_index = l_fnr;                    /* local frame number is index in the layerstack */
-            break;
-          case GAP_FRN_MOVIE:
-            /* video file frame numners start at 1 */
-            l_framename = g_strdup(frn_elem->basename);   /* use 1:1 basename for videofiles */
-            gfd->localframe_index = l_fnr;                    /* local frame number is the wanted video frame number */
-            break;
-          case GAP_FRN_FRAMES:
-            l_framename = gap_lib_alloc_fname(frn_elem->basename
-                                   ,l_fnr
-                                   ,frn_elem->ext
-                                   );
-            break;
-          case GAP_FRN_SECTION:
-            /* frame numners in storyboard sections start at 1 */
-            l_framename = g_strdup(frn_elem->basename);   /* section_name 1:1 for STB sections */
-            gfd->localframe_index = l_fnr;                    /* local frame number is the wanted video frame number */
-            break;
-        }
+    gfd->local_stepcount = master_frame_nr - l_frame_group_count;
+    gfd->local_stepcount -= 1;
 
-         /* return values for current fixed attribute settings
-          */
-         gfd->frn_type              = frn_elem->frn_type;
-         gfd->keep_proportions      = frn_elem->keep_proportions;
-         gfd->fit_width             = frn_elem->fit_width;
-         gfd->fit_height            = frn_elem->fit_height;
-         gfd->red_f                 = frn_elem->red_f;
-         gfd->green_f               = frn_elem->green_f;
-         gfd->blue_f                = frn_elem->blue_f;
-         gfd->alpha_f               = frn_elem->alpha_f;
-         gfd->trak_filtermacro_file = frn_elem->filtermacro_file;
+    switch(frn_elem->frn_type)
+    {
+      case GAP_FRN_SILENCE:
+      case GAP_FRN_COLOR:
+        l_framename = NULL;   /* there is no filename for video silence or unicolor */
+        break;
+      case GAP_FRN_IMAGE:
+        l_framename = g_strdup(frn_elem->basename);   /* use 1:1 basename for single images */
+        break;
+      case GAP_FRN_ANIMIMAGE:
+        l_framename = g_strdup(frn_elem->basename);   /* use 1:1 basename for ainimated single images */
+        gfd->localframe_index = l_fnr;                    /* local frame number is index in the layerstack */
+        break;
+      case GAP_FRN_MOVIE:
+        /* video file frame numners start at 1 */
+        l_framename = g_strdup(frn_elem->basename);   /* use 1:1 basename for videofiles */
+        gfd->localframe_index = l_fnr;                    /* local frame number is the wanted video frame number */
+        break;
+      case GAP_FRN_FRAMES:
+        l_framename = gap_lib_alloc_fname(frn_elem->basename
+                               ,l_fnr
+                               ,frn_elem->ext
+                               );
+        break;
+      case GAP_FRN_SECTION:
+        /* frame numners in storyboard sections start at 1 */
+        l_framename = g_strdup(frn_elem->basename);   /* section_name 1:1 for STB sections */
+        gfd->localframe_index = l_fnr;                    /* local frame number is the wanted video frame number */
+        break;
+    }
 
-         frn_elem->last_master_frame_access = master_frame_nr;
+     /* return values for current fixed attribute settings
+      */
+     gfd->frn_type              = frn_elem->frn_type;
+     gfd->keep_proportions      = frn_elem->keep_proportions;
+     gfd->fit_width             = frn_elem->fit_width;
+     gfd->fit_height            = frn_elem->fit_height;
+     gfd->red_f                 = frn_elem->red_f;
+     gfd->green_f               = frn_elem->green_f;
+     gfd->blue_f                = frn_elem->blue_f;
+     gfd->alpha_f               = frn_elem->alpha_f;
+     gfd->trak_filtermacro_file = frn_elem->filtermacro_file;
 
-         gfd->frn_elem = frn_elem;  /* deliver pointer to the current frn_elem */
+     frn_elem->last_master_frame_access = master_frame_nr;
 
+     gfd->frn_elem = frn_elem;  /* deliver pointer to the current frn_elem */
 
-         /* calculate effect attributes for the current step
-          * where l_step = 0 at the 1.st frame of the local range
-          */
-         l_step = (master_frame_nr - 1) - l_frame_group_count;
-
-
-         gfd->rotate = p_attribute_query_at_step(l_step
-                                    , frn_elem->rotate_from
-                                    , frn_elem->rotate_to
-                                    , frn_elem->rotate_dur
-                                    , frn_elem->rotate_frames_done
-                                    , frn_elem->rotate_accel
-                                    );
-         gfd->opacity = p_attribute_query_at_step(l_step
-                                    , frn_elem->opacity_from
-                                    , frn_elem->opacity_to
-                                    , frn_elem->opacity_dur
-                                    , frn_elem->opacity_frames_done
-                                    , frn_elem->opacity_accel
-                                    );
-         gfd->scale_x = p_attribute_query_at_step(l_step
-                                    , frn_elem->scale_x_from
-                                    , frn_elem->scale_x_to
-                                    , frn_elem->scale_x_dur
-                                    , frn_elem->scale_x_frames_done
-                                    , frn_elem->scale_x_accel
-                                    );
-         gfd->scale_y = p_attribute_query_at_step(l_step
-                                    , frn_elem->scale_y_from
-                                    , frn_elem->scale_y_to
-                                    , frn_elem->scale_y_dur
-                                    , frn_elem->scale_y_frames_done
-                                    , frn_elem->scale_y_accel
-                                    );
-         gfd->move_x  = p_attribute_query_at_step(l_step
-                                    , frn_elem->move_x_from
-                                    , frn_elem->move_x_to
-                                    , frn_elem->move_x_dur
-                                    , frn_elem->move_x_frames_done
-                                    , frn_elem->move_x_accel
-                                    );
-         gfd->move_y  = p_attribute_query_at_step(l_step
-                                    , frn_elem->move_y_from
-                                    , frn_elem->move_y_to
-                                    , frn_elem->move_y_dur
-                                    , frn_elem->move_y_frames_done
-                                    , frn_elem->move_y_accel
-                                    );
-
-         /* movepath transition handling */                                   
-         if(frn_elem->movepath_file_xml != NULL)
-         {
-           gint32  l_steps_since_transition_start;
-           gdouble phase;
 
-           l_steps_since_transition_start = frn_elem->movepath_frames_done + l_step;
-           phase = 1.0;
-           
-           
-           if (l_steps_since_transition_start < frn_elem->movepath_dur)
-           {
-             gint32 duration;
-             gint   accel;
-             
-             accel = 0;
-             duration = abs(frn_elem->movepath_to - frn_elem->movepath_from);
-             gfd->movepath_file_xml = frn_elem->movepath_file_xml;
-             phase = p_attribute_query_at_step(l_step
-                                                 , frn_elem->movepath_from
-                                                 , frn_elem->movepath_to
-                                                 , duration
-                                                 , frn_elem->movepath_frames_done
-                                                 , accel
-                                                 );
-             gfd->movepath_framePhase = rint(phase);
-           }
-           if(gap_debug)
-           {
-             printf("FETCH: l_steps_since_transition_start:%d movepath_dur:%d movepath_framePhase:%d (phase:%.4f)\n"
-               , (int)l_steps_since_transition_start
-               , (int)frn_elem->movepath_dur
-               , (int)gfd->movepath_framePhase
-               , (float)phase
-               );
-           }
-           
-         }
+     /* calculate effect attributes for the current step
+      * where l_step = 0 at the 1.st frame of the local range
+      */
+     l_step = (master_frame_nr - 1) - l_frame_group_count;
 
 
-        break;
-      }
-      l_frame_group_count += l_frames_to_handle;
-    }
-    l_found_at_idx++;
+     gfd->rotate = p_attribute_query_at_step(l_step
+                                , frn_elem->rotate_from
+                                , frn_elem->rotate_to
+                                , frn_elem->rotate_dur
+                                , frn_elem->rotate_frames_done
+                                , frn_elem->rotate_accel
+                                );
+     gfd->opacity = p_attribute_query_at_step(l_step
+                                , frn_elem->opacity_from
+                                , frn_elem->opacity_to
+                                , frn_elem->opacity_dur
+                                , frn_elem->opacity_frames_done
+                                , frn_elem->opacity_accel
+                                );
+     gfd->scale_x = p_attribute_query_at_step(l_step
+                                , frn_elem->scale_x_from
+                                , frn_elem->scale_x_to
+                                , frn_elem->scale_x_dur
+                                , frn_elem->scale_x_frames_done
+                                , frn_elem->scale_x_accel
+                                );
+     gfd->scale_y = p_attribute_query_at_step(l_step
+                                , frn_elem->scale_y_from
+                                , frn_elem->scale_y_to
+                                , frn_elem->scale_y_dur
+                                , frn_elem->scale_y_frames_done
+                                , frn_elem->scale_y_accel
+                                );
+     gfd->move_x  = p_attribute_query_at_step(l_step
+                                , frn_elem->move_x_from
+                                , frn_elem->move_x_to
+                                , frn_elem->move_x_dur
+                                , frn_elem->move_x_frames_done
+                                , frn_elem->move_x_accel
+                                );
+     gfd->move_y  = p_attribute_query_at_step(l_step
+                                , frn_elem->move_y_from
+                                , frn_elem->move_y_to
+                                , frn_elem->move_y_dur
+                                , frn_elem->move_y_frames_done
+                                , frn_elem->move_y_accel
+                                );
+
+     /* movepath transition handling */                                   
+     if(frn_elem->movepath_file_xml != NULL)
+     {
+       gint32  l_steps_since_transition_start;
+       gdouble phase;
+
+       l_steps_since_transition_start = frn_elem->movepath_frames_done + l_step;
+       phase = 1.0;
+       
+       
+       if (l_steps_since_transition_start < frn_elem->movepath_dur)
+       {
+         gint32 duration;
+         gint   accel;
+         
+         accel = 0;
+         duration = abs(frn_elem->movepath_to - frn_elem->movepath_from);
+         gfd->movepath_file_xml = frn_elem->movepath_file_xml;
+         phase = p_attribute_query_at_step(l_step
+                                             , frn_elem->movepath_from
+                                             , frn_elem->movepath_to
+                                             , duration
+                                             , frn_elem->movepath_frames_done
+                                             , accel
+                                             );
+         gfd->movepath_framePhase = rint(phase);
+       }
+       if(gap_debug)
+       {
+         printf("FETCH: l_steps_since_transition_start:%d movepath_dur:%d movepath_framePhase:%d (phase:%.4f)\n"
+           , (int)l_steps_since_transition_start
+           , (int)frn_elem->movepath_dur
+           , (int)gfd->movepath_framePhase
+           , (float)phase
+           );
+       }
+       
+     }
   }
 
   if(gap_debug)
@@ -1888,6 +2258,10 @@ p_add_frn_list(GapStoryRenderVidHandle *vidhand, GapStoryRenderFrameRangeElem *f
        return;
      }
 
+     /* the list changes, drop an index that was built before */
+     p_frn_index_free(vidhand->parsing_section->frn_index);
+     vidhand->parsing_section->frn_index = NULL;
+
      frn_listend = vidhand->parsing_section->frn_list;
      if (vidhand->parsing_section->frn_list == NULL)
      {
@@ -3462,6 +3836,7 @@ p_new_render_section(const char *section_name)
 
    new_render_section = g_new(GapStoryRenderSection, 1);
    new_render_section->frn_list = NULL;
+   new_render_section->frn_index = NULL;
    new_render_section->aud_list = NULL;
    new_render_section->section_name = NULL;
    if (section_name != NULL)
@@ -3696,6 +4071,7 @@ gap_story_render_close_vid_handle(GapStoryRenderVidHandle *vidhand)
 
      next_render_section = render_section->next;
 
+     p_frn_index_free(render_section->frn_index);
      p_free_framerange_list(render_section->frn_list);
 
      if (render_section->section_name != NULL)
@@ -3710,10 +4086,18 @@ gap_story_render_close_vid_handle(GapStoryRenderVidHandle *vidhand)
    p_free_stb_error(vidhand->sterr);
    p_free_mask_definitions(vidhand);
 
-   /* unregister frame fetcher resource usage (e.g. the image cache) */
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+   if(gap_debug)
+   {
+     p_comp_cache_print_statistics();
+   }
+#endif
+
+   /* unregister frame fetcher resource usage (e.g. the image cache) */
    gap_frame_fetch_unregister_user(vidhand->ffetch_user_id);
    vidhand->section_list = NULL;
    vidhand->frn_list = NULL;
+   vidhand->frn_index = NULL;
    vidhand->sterr = NULL;
 }  /* end gap_story_render_close_vid_handle */
 
@@ -4102,6 +4486,7 @@ p_open_video_handle_private(    gboolean ignore_audio
   p_initOptionalMulitprocessorSupport(vidhand);
   
   vidhand->frn_list = NULL;
+  vidhand->frn_index = NULL;
   vidhand->preferred_decoder = NULL;
   vidhand->master_insert_alpha_format = NULL;
   vidhand->master_insert_alpha_format_has_videobasename = FALSE;
@@ -4436,6 +4821,10 @@ p_open_video_handle_private(    gboolean ignore_audio
       render_section->frn_list = frn_elem;
   }
 
+  /* the frn_lists of all sections are complete now,
+   * compile them for fast lookup in p_fetch_framename
+   */
+  p_frn_index_build_all_sections(vidhand);
 
   /* select MAIN section (has section_name NULL) per default */
   p_select_section_by_name(vidhand, NULL);
@@ -4633,6 +5022,10 @@ gap_story_render_open_vid_handle(GapLibTypeInputRange input_mode
  * - execute the (optional) filtermacro_file if not NULL
  *   (filtermacro_file is a set of one or more gimp_filter procedures
  *    with predefined parameter values)
+ *   the filtermacro is executed in-process (instead of calling the
+ *   filtermacro plug-in via PDB for each frame) this way the parsed filtermacro
+ *   files are kept in the filtermacro cache and only the filters themselves
+ *   are called via PDB.
  * returns the resulting layer_id (this may be the same as the specified layer_id at calling time
  *           but can change in case the called filter did add additional layers that were
  *           merged to one resulting layer (either in the called filter or after the filtercall
@@ -4646,8 +5039,7 @@ p_exec_filtermacro(gint32 image_id, gint32 layer_id, const char *filtermacro_fil
     , gint accelerationCharacteristic
 )
 {
-  GimpParam* l_params;
-  gint   l_retvals;
+  gint   l_fmac_rc;
   gint32 l_rc_layer_id;
   gint          l_nlayers;
   gint32       *l_layers_list;
@@ -4689,13 +5081,12 @@ p_exec_filtermacro(gint32 image_id, gint32 layer_id, const char *filtermacro_fil
        || (total_steps <= 1))
        {
           /* execute simple GAP Filtermacro_file */
-          l_params = gimp_run_procedure (GAP_FMACNAME_PLUG_IN_NAME_FMAC,
-                     &l_retvals,
-                     GIMP_PDB_INT32,    GIMP_RUN_NONINTERACTIVE,
-                     GIMP_PDB_IMAGE,    image_id,
-                     GIMP_PDB_DRAWABLE, layer_id,
-                     GIMP_PDB_STRING,   filtermacro_file,
-                     GIMP_PDB_END);
+          l_fmac_rc = gap_fmac_execute(GIMP_RUN_NONINTERACTIVE, image_id, layer_id
+                     , filtermacro_file
+                     , NULL  /* filtermacro_file2 */
+                     , 1.0   /* current_step */
+                     , 1     /* total_steps */
+                     );
        }
        else
        {
@@ -4707,24 +5098,19 @@ p_exec_filtermacro(gint32 image_id, gint32 layer_id, const char *filtermacro_fil
                                    );
 
            /* execute varying value mix of 2 GAP Filtermacro_files */
-           l_params = gimp_run_procedure (GAP_FMACNAME_PLUG_IN_NAME_FMAC_VARYING,
-                     &l_retvals,
-                     GIMP_PDB_INT32,    GIMP_RUN_NONINTERACTIVE,
-                     GIMP_PDB_IMAGE,    image_id,
-                     GIMP_PDB_DRAWABLE, layer_id,
-                     GIMP_PDB_STRING,   filtermacro_file,
-                     GIMP_PDB_STRING,   filtermacro_file_to,
-                     GIMP_PDB_FLOAT,    current_accel_step,
-                     GIMP_PDB_INT32,    total_steps,
-                     GIMP_PDB_END);
+           l_fmac_rc = gap_fmac_execute(GIMP_RUN_NONINTERACTIVE, image_id, layer_id
+                     , filtermacro_file
+                     , filtermacro_file_to
+                     , current_accel_step
+                     , total_steps
+                     );
        }
 
-       if(l_params[0].data.d_status != GIMP_PDB_SUCCESS)
+       if(l_fmac_rc < 0)
        {
          printf("ERROR: filtermacro_file:%s failed\n", filtermacro_file);
          l_rc_layer_id = -1;
        }
-       g_free(l_params);
 
        l_layers_list = gimp_image_get_layers(image_id, &l_nlayers);
        if(l_layers_list != NULL)
@@ -6342,6 +6728,9 @@ p_dump_stb_resources_gvahand(GapStoryRenderVidHandle *vidhand
  *  are represented by a short storyboard framerange list that has
  *  just one element entry at track 1).
  *
+ * the (optional) composite frame cache is checked first, frames that are not
+ * yet cached are rendered and added to the cache.
+ *
  * return image_id of resulting image and the flattened resulting layer_id
  */
 static gint32
@@ -6355,9 +6744,32 @@ p_story_render_fetch_composite_image_or_buffer(GapStoryRenderVidHandle *vidhand
                     , GapStoryFetchResult      *gapStoryFetchResult
                  )
 {
-  gint32 image_id;
-  
-  image_id = p_story_render_fetch_composite_image_private(vidhand
+  gint32   image_id;
+  gboolean isCompCacheHit;
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+  gchar   *compCacheKey;
+
+  compCacheKey = p_comp_cache_build_key(vidhand
+                                       ,master_frame_nr
+                                       ,vid_width
+                                       ,vid_height
+                                       ,filtermacro_file
+                                       );
+  isCompCacheHit = p_comp_cache_fetch(compCacheKey
+                                       ,vid_width
+                                       ,vid_height
+                                       ,&image_id
+                                       ,layer_id
+                                       ,enable_rgb888_flag
+                                       ,gapStoryFetchResult
+                                       );
+#else
+  isCompCacheHit = FALSE;
+#endif
+
+  if(isCompCacheHit != TRUE)
+  {
+    image_id = p_story_render_fetch_composite_image_private(vidhand
                                                   ,master_frame_nr
                                                   ,vid_width
                                                   ,vid_height
@@ -6367,6 +6779,22 @@ p_story_render_fetch_composite_image_or_buffer(GapStoryRenderVidHandle *vidhand
                                                   ,enable_rgb888_flag  /* enable fetch as rgb888 data buffer */
                                                   ,gapStoryFetchResult
                                                  );
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+    p_comp_cache_store(compCacheKey
+                      ,vid_width
+                      ,vid_height
+                      ,image_id
+                      ,*layer_id
+                      ,gapStoryFetchResult
+                      );
+#endif
+  }
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+  if(compCacheKey != NULL)
+  {
+    g_free(compCacheKey);
+  }
+#endif
 
   if (image_id >= 0)
   {
@@ -7068,6 +7496,22 @@ p_stb_render_movie_single_processor(GapStbFetchData *gfd
                  , "(single A)"
                  );
 
+     if (fcacheFetchResult.isFrameAvailable != TRUE)
+     {
+       /* check the persistent diskcache before decoding */
+       if(GVA_diskcache_fetch_to_fcache(gfd->frn_elem->gvahand, gfd->localframe_index) == TRUE)
+       {
+         p_call_GVA_search_fcache_and_get_frame_as_gimp_layer_or_rgb888(gfd->frn_elem->gvahand
+                 , gfd->localframe_index   /* framenumber */
+                 , l_deinterlace
+                 , l_threshold
+                 , 1                       /* numProcessors */
+                 , &fcacheFetchResult
+                 , "(single D)"
+                 );
+       }
+     }
+
      if (fcacheFetchResult.isFrameAvailable != TRUE)
      {
        /* if no success, we try explicite read that frame  */
@@ -7361,6 +7805,74 @@ p_videoPrefetchWorkerThreadFunction (VideoPrefetchData *vpre)
 
 
 
+/* -------------------------------------------
+ * p_get_next_clip_in_track
+ * -------------------------------------------
+ * return the element that follows frn_elem in the same track
+ * (or NULL if frn_elem is the last one in its track)
+ */
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+static GapStoryRenderFrameRangeElem *
+p_get_next_clip_in_track(GapStoryRenderFrameRangeElem *frn_elem)
+{
+  GapStoryRenderFrameRangeElem *frn_elem_next;
+
+  for(frn_elem_next = (GapStoryRenderFrameRangeElem *)frn_elem->next
+     ; frn_elem_next != NULL
+     ; frn_elem_next = (GapStoryRenderFrameRangeElem *)frn_elem_next->next)
+  {
+    if(frn_elem_next->track == frn_elem->track)
+    {
+      return (frn_elem_next);
+    }
+  }
+  return (NULL);
+
+}  /* end p_get_next_clip_in_track */
+#endif
+
+
+/* -------------------------------------------
+ * p_is_continued_video_clip
+ * -------------------------------------------
+ * TRUE if frn_elem_next is a forward playing movie clip that refers to the
+ * same video (same videotrack and seek mode) as frn_elem and starts
+ * at a frame that is no more than maxGap frames behind the end of frn_elem.
+ * (typical for an edit decision list that cuts one video into adjacent clips)
+ */
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+static gboolean
+p_is_continued_video_clip(GapStoryRenderFrameRangeElem *frn_elem
+  , GapStoryRenderFrameRangeElem *frn_elem_next
+  , gint32 maxGap)
+{
+  if((frn_elem_next == NULL)
+  || (frn_elem_next->frn_type != GAP_FRN_MOVIE)
+  || (frn_elem->frn_type != GAP_FRN_MOVIE))
+  {
+    return (FALSE);
+  }
+  if((frn_elem_next->frame_from > frn_elem_next->frame_to)
+  || (frn_elem_next->seltrack != frn_elem->seltrack)
+  || (frn_elem_next->exact_seek != frn_elem->exact_seek))
+  {
+    return (FALSE);
+  }
+  if((frn_elem_next->frame_from < frn_elem->frame_to)
+  || (frn_elem_next->frame_from > frn_elem->frame_to + 1 + maxGap))
+  {
+    return (FALSE);
+  }
+  if(strcmp(frn_elem_next->basename, frn_elem->basename) != 0)
+  {
+    return (FALSE);
+  }
+  return (TRUE);
+
+}  /* end p_is_continued_video_clip */
+#endif
+
+
 /* -------------------------------------------
  * p_getPredictedNextFramenr
  * -------------------------------------------
@@ -7368,10 +7880,12 @@ p_videoPrefetchWorkerThreadFunction (VideoPrefetchData *vpre)
  * Frames from targetFrameNr upto the calculated predicted frmanumber
  * shall be read parallel in advance.
  * prefetch is limited by MULTITHREAD_PREFETCH_AMOUNT, the GVA fcache size and
- * the highestReferedFrameNr (current check is limited to current clip)
- *
- * TODO if the same video is also refered in the next clip in continous sequence.
- * the highestReferedFrameNr could be increased accordingly.
+ * the highestReferedFrameNr.
+ * The highestReferedFrameNr is the end of the current clip, extended by the
+ * following clips in the same track that continue to read the same video
+ * in ascending sequence (see p_is_continued_video_clip).
+ * Those clips will reuse the same GVA video handle (and its fcache)
+ * so prefetch can run across the clip boundaries.
  */
 #ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
 static gint32
@@ -7408,6 +7922,22 @@ p_getPredictedNextFramenr(gint32 targetFrameNr, GapStoryRenderFrameRangeElem *fr
 //       highestReferedFrameNr = MIN(frn_elem->frame_to, frn_elem->gvahand->total_frames);
 //     }
 
+    /* lookahead into following clips in the same track that continue the same video */
+    {
+      GapStoryRenderFrameRangeElem *frn_elem_next;
+      GapStoryRenderFrameRangeElem *frn_elem_prev;
+
+      frn_elem_prev = frn_elem;
+      frn_elem_next = p_get_next_clip_in_track(frn_elem);
+      while((highestReferedFrameNr < targetFrameNr + prefetchAmount)
+      && (p_is_continued_video_clip(frn_elem_prev, frn_elem_next, prefetchAmount) == TRUE))
+      {
+        highestReferedFrameNr = frn_elem_next->frame_to;
+        frn_elem_prev = frn_elem_next;
+        frn_elem_next = p_get_next_clip_in_track(frn_elem_next);
+      }
+    }
+
     predictedFrameNr = MIN((targetFrameNr + prefetchAmount), highestReferedFrameNr);
 
     if(gap_debug)
@@ -7431,6 +7961,235 @@ p_getPredictedNextFramenr(gint32 targetFrameNr, GapStoryRenderFrameRangeElem *fr
 #endif
 
 
+/* -------------------------------------------
+ * p_get_VideoPrefetchData
+ * -------------------------------------------
+ * return the VideoPrefetchData that is attached as user_data
+ * to the GVA video handle of the clip (gfd->frn_elem->gvahand).
+ * The VideoPrefetchData is created and attached at the first call
+ * for a video handle.
+ */
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+static VideoPrefetchData *
+p_get_VideoPrefetchData(GapStbFetchData *gfd
+  , gint32 targetFrameNumber
+  , gint32 predictedNextFrameNr)
+{
+  VideoPrefetchData *vpre;
+
+  vpre = (VideoPrefetchData *)gfd->frn_elem->gvahand->user_data;
+  if(vpre == NULL)
+  {
+    /* attach VideoPrefetchData for multithread usage as user_data to the GVA handle */
+    vpre = g_new(VideoPrefetchData, 1);
+    vpre->gvahand = gfd->frn_elem->gvahand;
+    vpre->prefetchFrameNumber = predictedNextFrameNr;
+    vpre->targetFrameNumber = targetFrameNumber;
+    vpre->isPrefetchThreadRunning = FALSE;
+    vpre->mutex = p_pooled_g_mutex_new ();
+    vpre->targetFrameReadyCond = g_cond_new ();
+    vpre->prefetchDoneCond = g_cond_new ();
+    vpre->isPlayingBackwards = FALSE;
+    if (gfd->frn_elem->frame_from > gfd->frn_elem->frame_to)
+    {
+      vpre->isPlayingBackwards = TRUE;
+    }
+    gfd->frn_elem->gvahand->user_data = vpre;
+    
+    /* Let the GVA api know about the mutex.
+     * This triggers g_mutex_lock / g_mutex_unlock calls in API internal functions
+     * dealing with the fcache access.
+     */
+    gfd->frn_elem->gvahand->fcache_mutex = vpre->mutex;
+  }
+
+  return (vpre);
+
+}  /* end p_get_VideoPrefetchData */
+#endif
+
+
+/* -------------------------------------------
+ * p_stb_trigger_prefetch
+ * -------------------------------------------
+ * trigger a prefetch worker thread that reads targetFrameNumber
+ * (and the predicted next frames) from the already opened videohandle
+ * gfd->frn_elem->gvahand into its fcache.
+ * Nothing is done when the target frame is already cached
+ * or a prefetch worker thread is already running on this videohandle.
+ */
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+static void
+p_stb_trigger_prefetch(GapStbFetchData *gfd
+  , gint32 targetFrameNumber
+  , gint32 track)
+{
+  VideoPrefetchData *vpre;
+  gint32             predictedNextFrameNr;
+  GError            *error;
+
+  error = NULL;
+  predictedNextFrameNr = p_getPredictedNextFramenr(targetFrameNumber, gfd->frn_elem);
+  vpre = p_get_VideoPrefetchData(gfd, targetFrameNumber, predictedNextFrameNr);
+
+  if(GVA_search_fcache(gfd->frn_elem->gvahand, targetFrameNumber) == GVA_RET_OK)
+  {
+    return;
+  }
+  if(GVA_diskcache_fetch_to_fcache(gfd->frn_elem->gvahand, targetFrameNumber) == TRUE)
+  {
+    return;
+  }
+
+  GVA_fcache_mutex_lock (vpre->gvahand);
+  if(vpre->isPrefetchThreadRunning != TRUE)
+  {
+    vpre->prefetchFrameNumber = predictedNextFrameNr;
+    vpre->targetFrameNumber = targetFrameNumber;
+
+    if(gap_debug)
+    {
+      printf("TRACK PREFETCH PUSH track:%d gvahand:%d targetFrameNumber:%d predictedFrameNr:%d\n"
+        , (int)track
+        , (int)vpre->gvahand
+        , (int)targetFrameNumber
+        , (int)predictedNextFrameNr
+        );
+    }
+
+    vpre->isPrefetchThreadRunning = TRUE;
+    /* activate a worker thread that fills the fcache upto prefetchFrameNumber */
+    g_thread_pool_push (p_get_PrefetchThreadPool()
+                     , vpre    /* VideoPrefetchData */
+                     , &error
+                     );
+  }
+  GVA_fcache_mutex_unlock (vpre->gvahand);
+
+}  /* end p_stb_trigger_prefetch */
+#endif
+
+
+/* -------------------------------------------
+ * p_stb_prefetch_movie_tracks
+ * -------------------------------------------
+ * this procedure runs in the main thread before the tracks of a composite frame
+ * are fetched and composited (in multithread environment).
+ * It triggers a prefetch worker thread (from the prefetchThreadPool)
+ * for each movie clip track where the required frame is not yet in the GVA fcache.
+ * This way the video decoding for all movie tracks runs parallel,
+ * while the main thread still processes the tracks in their layerstack order
+ * (and waits in p_stb_render_movie_multiprocessor only for frames that are not yet ready).
+ *
+ * Note that image and frame loading and all other gimp PDB calls
+ * remain in the main thread.
+ *
+ * Opening a videohandle may close other handles via p_limit_open_videohandles,
+ * that keeps only handles of clips accessed at the current master_frame_nr.
+ * Therefore the clips of all tracks are marked as accessed (by p_fetch_framename)
+ * before any videohandle is opened.
+ */
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+static void
+p_stb_prefetch_movie_tracks(GapStoryRenderVidHandle *vidhand
+  , gint32 master_frame_nr)
+{
+  GapStbFetchData gapStbFetchData;
+  GapStbFetchData *gfd;
+  gint32           l_track;
+
+  static gint32 funcId = -1;
+
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "p_stb_prefetch_movie_tracks");
+  GAP_TIMM_START_FUNCTION(funcId);
+
+  gfd = &gapStbFetchData;
+
+  /* mark the clips of all tracks at master_frame_nr as accessed
+   * (protects their videohandles against closing by p_limit_open_videohandles)
+   */
+  for(l_track = vidhand->maxVidTrack; l_track >= vidhand->minVidTrack; l_track--)
+  {
+    gfd->framename = p_fetch_framename(vidhand
+                 , master_frame_nr /* starts at 1 */
+                 , l_track
+                 , gfd
+                 );
+    if(gfd->framename != NULL)
+    {
+      g_free(gfd->framename);
+    }
+  }
+
+  for(l_track = vidhand->maxVidTrack; l_track >= vidhand->minVidTrack; l_track--)
+  {
+    gfd->framename = p_fetch_framename(vidhand
+                 , master_frame_nr /* starts at 1 */
+                 , l_track
+                 , gfd
+                 );
+    if(gfd->framename == NULL)
+    {
+      continue;
+    }
+
+    if(gfd->frn_type == GAP_FRN_MOVIE)
+    {
+      p_check_and_open_video_handle(gfd->frn_elem
+                                   , vidhand
+                                   , master_frame_nr
+                                   , gfd->frn_elem->basename /* videofile name */
+                                   );
+      if(gfd->frn_elem->gvahand)
+      {
+        p_stb_trigger_prefetch(gfd, gfd->localframe_index, l_track);
+      }
+
+      /* when the current clip is about to end, open the videohandle
+       * of the next clip in this track and start decoding its first frame in advance.
+       * (not required when the next clip continues the same video,
+       * because it will reuse the current handle where the prefetch already runs
+       * across the clip boundary)
+       */
+      if((gfd->frn_elem->frame_from <= gfd->frn_elem->frame_to)
+      && ((gfd->frn_elem->frame_to - gfd->localframe_index)
+            <= (MULTITHREAD_PREFETCH_AMOUNT * MAX(1.0, gfd->frn_elem->step_density))))
+      {
+        GapStoryRenderFrameRangeElem *frn_elem_next;
+
+        frn_elem_next = p_get_next_clip_in_track(gfd->frn_elem);
+        if((frn_elem_next != NULL)
+        && (frn_elem_next->frn_type == GAP_FRN_MOVIE)
+        && (frn_elem_next->gvahand == NULL)
+        && (frn_elem_next->frame_from <= frn_elem_next->frame_to)
+        && (p_is_continued_video_clip(gfd->frn_elem, frn_elem_next, MULTITHREAD_PREFETCH_AMOUNT) != TRUE))
+        {
+          GapStbFetchData gapStbFetchDataNext;
+
+          /* the next clip is needed soon, protect its handle like the current clips */
+          frn_elem_next->last_master_frame_access = master_frame_nr;
+          p_check_and_open_video_handle(frn_elem_next
+                                       , vidhand
+                                       , master_frame_nr
+                                       , frn_elem_next->basename /* videofile name */
+                                       );
+          if(frn_elem_next->gvahand)
+          {
+            gapStbFetchDataNext.frn_elem = frn_elem_next;
+            p_stb_trigger_prefetch(&gapStbFetchDataNext, (gint32)frn_elem_next->frame_from, l_track);
+          }
+        }
+      }
+    }
+    g_free(gfd->framename);
+  }
+
+  GAP_TIMM_STOP_FUNCTION(funcId);
+
+}  /* end p_stb_prefetch_movie_tracks */
+#endif
+
+
 /* ------------------------------------------------
  * p_stb_render_movie_multiprocessor (GAP_FRN_MOVIE)
  * ------------------------------------------------
@@ -7497,31 +8256,7 @@ p_stb_render_movie_multiprocessor(GapStbFetchData *gfd
 
   predictedNextFrameNr = p_getPredictedNextFramenr(targetFrameNumber, gfd->frn_elem);
 
-  vpre = (VideoPrefetchData *)gfd->frn_elem->gvahand->user_data;
-  if(vpre == NULL)
-  {
-    /* attach VideoPrefetchData for multithread usage as user_data to the GVA handle */
-    vpre = g_new(VideoPrefetchData, 1);
-    vpre->gvahand = gfd->frn_elem->gvahand;
-    vpre->prefetchFrameNumber = predictedNextFrameNr;
-    vpre->targetFrameNumber = targetFrameNumber;
-    vpre->isPrefetchThreadRunning = FALSE;
-    vpre->mutex = p_pooled_g_mutex_new ();
-    vpre->targetFrameReadyCond = g_cond_new ();
-    vpre->prefetchDoneCond = g_cond_new ();
-    vpre->isPlayingBackwards = FALSE;
-    if (gfd->frn_elem->frame_from > gfd->frn_elem->frame_to)
-    {
-      vpre->isPlayingBackwards = TRUE;
-    }
-    gfd->frn_elem->gvahand->user_data = vpre;
-    
-    /* Let the GVA api know about the mutex.
-     * This triggers g_mutex_lock / g_mutex_unlock calls in API internal functions
-     * dealing with the fcache access.
-     */
-    gfd->frn_elem->gvahand->fcache_mutex = vpre->mutex;
-  }
+  vpre = p_get_VideoPrefetchData(gfd, targetFrameNumber, predictedNextFrameNr);
 
   for(retryCount=0; retryCount < 200; retryCount++)
   {
@@ -7596,6 +8331,17 @@ p_stb_render_movie_multiprocessor(GapStbFetchData *gfd
     else
     {
       /* frame is NOT (yet) in fcache */
+      if(retryCount == 0)
+      {
+        /* check the persistent diskcache before decoding
+         * (not possible while a prefetch worker thread has locked the fcache)
+         */
+        if(GVA_diskcache_fetch_to_fcache(gfd->frn_elem->gvahand, targetFrameNumber) == TRUE)
+        {
+          continue;
+        }
+      }
+
       GVA_fcache_mutex_lock (vpre->gvahand);
       
       if(vpre->isPrefetchThreadRunning != TRUE)
@@ -8378,6 +9124,50 @@ p_isFiltermacroActive(const char *filtermacro_file)
 }  /* end p_isFiltermacroActive */
 
 
+/* --------------------------------------------
+ * p_is_auto_insert_active
+ * --------------------------------------------
+ * check if automatic insert of alpha channel or logo area
+ * is configured for the movie clip frame described by gfd
+ * (e.g. the corresponding imagefile exists)
+ */
+static gboolean
+p_is_auto_insert_active(GapStbFetchData *gfd, GapStoryRenderVidHandle *vidhand)
+{
+  gboolean isAutoInsertActive;
+
+  isAutoInsertActive = FALSE;
+
+  if(vidhand->master_insert_alpha_format != NULL)
+  {
+    char *alpha_imagename;
+    alpha_imagename = p_get_insert_alpha_filename(gfd, vidhand);
+
+    if(g_file_test(alpha_imagename, G_FILE_TEST_EXISTS))
+    {
+      isAutoInsertActive = TRUE;
+    }
+    g_free(alpha_imagename);
+  }
+
+  if((vidhand->master_insert_area_format != NULL)
+  && (isAutoInsertActive != TRUE))
+  {
+    char *logo_imagename;
+    logo_imagename = p_get_insert_area_filename(gfd, vidhand);
+
+    if(g_file_test(logo_imagename, G_FILE_TEST_EXISTS))
+    {
+      isAutoInsertActive = TRUE;
+    }
+    g_free(logo_imagename);
+  }
+
+  return (isAutoInsertActive);
+
+}  /* end p_is_auto_insert_active */
+
+
 /* --------------------------------------------
  * p_story_render_bypass_where_possible          rgb888 handling
  * --------------------------------------------
@@ -8427,7 +9217,7 @@ p_story_render_bypass_where_possible(GapStoryRenderVidHandle *vidhand
    */
   for(l_track = vidhand->minVidTrack; l_track <= vidhand->maxVidTrack; l_track++)
   {
-    gfd->framename = p_fetch_framename(vidhand->frn_list
+    gfd->framename = p_fetch_framename(vidhand
                  , master_frame_nr /* starts at 1 */
                  , l_track
                  , gfd
@@ -8470,36 +9260,7 @@ p_story_render_bypass_where_possible(GapStoryRenderVidHandle *vidhand
           //     && (!gfd->keep_proportions)
           )
           {
-            gboolean isAutoInsertActive;
-            
-            isAutoInsertActive = FALSE;
-            
-            if(vidhand->master_insert_alpha_format != NULL)
-            {
-              char *alpha_imagename;
-              alpha_imagename = p_get_insert_alpha_filename(gfd, vidhand);
-
-              if(g_file_test(alpha_imagename, G_FILE_TEST_EXISTS))
-              {
-                isAutoInsertActive = TRUE;;
-              }
-              g_free(alpha_imagename);
-            }
-
-            if((vidhand->master_insert_area_format != NULL)
-            && (isAutoInsertActive != TRUE))
-            {
-              char *logo_imagename;
-              logo_imagename = p_get_insert_area_filename(gfd, vidhand);
-
-              if(g_file_test(logo_imagename, G_FILE_TEST_EXISTS))
-              {
-                isAutoInsertActive = TRUE;;
-              }
-              g_free(logo_imagename);
-            }
-            
-            if (isAutoInsertActive != TRUE)
+            if (p_is_auto_insert_active(gfd, vidhand) != TRUE)
             {
               gfdMovie = gfd;
               videofileName = g_strdup(gfd->framename);
@@ -8628,6 +9389,7 @@ p_story_render_fetch_composite_image_private(GapStoryRenderVidHandle *vidhand
   GapStbFetchData *gfd;
 
   gint32  l_track;
+  gboolean isTrackPrefetchDone;
 
   static gint32 funcId = -1;
   static gint32 funcIdDirect = -1;
@@ -8648,6 +9410,7 @@ p_story_render_fetch_composite_image_private(GapStoryRenderVidHandle *vidhand
   gfd->gapStoryFetchResult = NULL;
   gfd->isRgb888Result      = FALSE;
   *layer_id         = -1;
+  isTrackPrefetchDone = FALSE;
 
 
 
@@ -8717,14 +9480,54 @@ p_story_render_fetch_composite_image_private(GapStoryRenderVidHandle *vidhand
        */
       return (-1);
     }
+
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+    if (vidhand->isMultithreadEnabled == TRUE)
+    {
+      p_stb_prefetch_movie_tracks(vidhand, master_frame_nr);
+      isTrackPrefetchDone = TRUE;
+    }
+
+    /* try native rgb888 compositing of movie and color clips
+     * (without converting to gimp layers)
+     */
+    if (p_story_render_rgb_composite_where_possible(vidhand
+                    , master_frame_nr
+                    , vid_width
+                    , vid_height
+                    , gapStoryFetchResult
+                    ) == TRUE)
+    {
+      if(gap_debug)
+      {
+        printf("p_story_render_fetch_composite_image_private: "
+               "native rgb888 composite delivered master_frame_nr:%d\n"
+               ,(int)master_frame_nr
+               );
+      }
+      GAP_TIMM_STOP_FUNCTION(funcId);
+      return (-1);
+    }
+#endif
+  }
+
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+  /* start parallel decoding of the frames of all movie tracks
+   * (the tracks are still composited in layerstack order by the main thread)
+   */
+  if ((vidhand->isMultithreadEnabled == TRUE)
+  && (isTrackPrefetchDone != TRUE))
+  {
+    p_stb_prefetch_movie_tracks(vidhand, master_frame_nr);
   }
+#endif
 
   /* reverse order, has the effect, that track 0 is processed as last track
    * and will be put on top of the layerstack (e.g. in the foreground)
    */
   for(l_track = vidhand->maxVidTrack; l_track >= vidhand->minVidTrack; l_track--)
   {
-    gfd->framename = p_fetch_framename(vidhand->frn_list
+    gfd->framename = p_fetch_framename(vidhand
                  , master_frame_nr /* starts at 1 */
                  , l_track
                  , gfd
@@ -8939,3 +9742,19 @@ p_story_render_fetch_composite_image_private(GapStoryRenderVidHandle *vidhand
  */
 
 #include "gap_story_render_lossless.c"
+
+/* -------------------------------------------------------------------
+ * p_story_render_rgb_composite_where_possible (see included file)
+ * -------------------------------------------------------------------
+ *
+ */
+
+#include "gap_story_render_rgb_composite.c"
+
+/* -------------------------------------------------------------------
+ * p_comp_cache_fetch, p_comp_cache_store (see included file)
+ * -------------------------------------------------------------------
+ *
+ */
+
+#include "gap_story_render_comp_cache.c"
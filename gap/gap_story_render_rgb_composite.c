@@ -0,0 +1,646 @@
+/* gap_story_render_rgb_composite.c
+ *
+ *
+ *  GAP storyboard native rgb888 compositing.
+ *  (renders composite frames that are built from movie clips and
+ *   color clips with simple scale / move / opacity transitions
+ *   directly into the rgb888 result buffer of the calling encoder
+ *   without creating gimp images and layers)
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * 2026.10.18  - created (native rgb888 compositing for the storyboard render processor)
+ * 2026.10.18  - native rgb888 compositing is off by default (gimprc video-storyboard-native-rgb-composite)
+ */
+
+#ifdef GAP_ENABLE_VIDEOAPI_SUPPORT
+
+#define GAP_RGB_COMPOSITE_BPP  3
+
+
+/* scratch buffer for decoded movie frames (reused for all tracks and frames) */
+static guchar *rgbCompositeScratchBuffer = NULL;
+static gint32  rgbCompositeScratchSize = 0;
+
+
+/* ----------------------------------------------------
+ * p_rgb_composite_is_enabled
+ * ----------------------------------------------------
+ * check the gimprc parameter video-storyboard-native-rgb-composite
+ * (the value is read only once per plug-in process)
+ */
+static gboolean
+p_rgb_composite_is_enabled(void)
+{
+  static gint isEnabled = -1;
+
+  if (isEnabled < 0)
+  {
+    isEnabled = gap_base_get_gimprc_gboolean_value(GAP_GIMPRC_VIDEO_STORYBOARD_NATIVE_RGB_COMPOSITE
+                                     , FALSE  /* default */
+                                     );
+  }
+  return (isEnabled == TRUE);
+
+}  /* end p_rgb_composite_is_enabled */
+
+
+/* ----------------------------------------------------
+ * p_rgb_composite_is_track_supported
+ * ----------------------------------------------------
+ * check if the clip at the track position (described by gfd)
+ * can be rendered by the native rgb888 compositing.
+ * This is the case for movie and color clips without
+ * rotation, flip, mask, filtermacro and movepath transformations.
+ * Silence (no clip at this track position) is always supported.
+ */
+static gboolean
+p_rgb_composite_is_track_supported(GapStbFetchData *gfd
+  , GapStoryRenderVidHandle *vidhand)
+{
+  if ((gfd->frn_type != GAP_FRN_COLOR) && (gfd->framename == NULL))
+  {
+    return (TRUE);
+  }
+
+  if ((gfd->frn_type != GAP_FRN_COLOR) && (gfd->frn_type != GAP_FRN_MOVIE))
+  {
+    return (FALSE);
+  }
+
+  if ((gfd->rotate > 0.05) || (gfd->rotate < -0.05)
+  || (gfd->frn_elem == NULL)
+  || (gfd->frn_elem->flip_request != GAP_STB_FLIP_NONE)
+  || (gfd->frn_elem->mask_name != NULL)
+  || (p_isFiltermacroActive(gfd->trak_filtermacro_file) == TRUE)
+  || (gfd->movepath_file_xml != NULL))
+  {
+    return (FALSE);
+  }
+
+  if (gfd->frn_type == GAP_FRN_MOVIE)
+  {
+    if (p_is_auto_insert_active(gfd, vidhand) == TRUE)
+    {
+      return (FALSE);
+    }
+  }
+
+  return (TRUE);
+
+}  /* end p_rgb_composite_is_track_supported */
+
+
+/* ----------------------------------------------------
+ * p_rgb_composite_is_direct_track
+ * ----------------------------------------------------
+ * TRUE if the track meets the conditions where the gimp layer based
+ * render engine uses the fetched clip image directly as the composite image
+ * (instead of pasting it onto an opaque black background)
+ */
+static gboolean
+p_rgb_composite_is_direct_track(GapStbFetchData *gfd)
+{
+  if((gfd->opacity == 1.0)
+  && (gfd->rotate == 0.0)
+  && (gfd->scale_x == 1.0)
+  && (gfd->scale_y == 1.0)
+  && (gfd->move_x == 0.0)
+  && (gfd->move_y == 0.0)
+  && (gfd->fit_width)
+  && (gfd->fit_height)
+  && (!gfd->keep_proportions)
+  && (gfd->frn_elem->flip_request == GAP_STB_FLIP_NONE)
+  && (gfd->frn_elem->mask_name == NULL)
+  && (gfd->trak_filtermacro_file == NULL)
+  && (gfd->movepath_file_xml == NULL))
+  {
+    return (TRUE);
+  }
+  return (FALSE);
+
+}  /* end p_rgb_composite_is_direct_track */
+
+
+/* ----------------------------------------------------
+ * p_rgb_composite_fill_color
+ * ----------------------------------------------------
+ * fill the visible part of the calculated rectangle in the rgb888 buffer
+ * with the specified color, blended at alpha (0 upto 255)
+ * using gimp normal mode over the (opaque) composite.
+ */
+static void
+p_rgb_composite_fill_color(guchar *dst, gint32 vid_width, gint32 vid_height
+  , GapStoryCalcAttr *calculated
+  , guchar red, guchar green, guchar blue
+  , gint alpha)
+{
+  gint32 x1;
+  gint32 y1;
+  gint32 x2;
+  gint32 y2;
+  gint32 x;
+  gint32 y;
+  gint   alphaInv;
+
+  x1 = MAX(0, calculated->x_offs);
+  y1 = MAX(0, calculated->y_offs);
+  x2 = MIN(vid_width, calculated->x_offs + calculated->width);
+  y2 = MIN(vid_height, calculated->y_offs + calculated->height);
+  alphaInv = 255 - alpha;
+
+  for(y = y1; y < y2; y++)
+  {
+    guchar *row;
+
+    row = dst + (((y * vid_width) + x1) * GAP_RGB_COMPOSITE_BPP);
+    if (alpha == 255)
+    {
+      for(x = x1; x < x2; x++)
+      {
+        row[0] = red;
+        row[1] = green;
+        row[2] = blue;
+        row += GAP_RGB_COMPOSITE_BPP;
+      }
+    }
+    else
+    {
+      for(x = x1; x < x2; x++)
+      {
+        row[0] = ((red   * alpha) + (row[0] * alphaInv) + 127) / 255;
+        row[1] = ((green * alpha) + (row[1] * alphaInv) + 127) / 255;
+        row[2] = ((blue  * alpha) + (row[2] * alphaInv) + 127) / 255;
+        row += GAP_RGB_COMPOSITE_BPP;
+      }
+    }
+  }
+
+}  /* end p_rgb_composite_fill_color */
+
+
+/* ----------------------------------------------------
+ * p_rgb_composite_blend_frame
+ * ----------------------------------------------------
+ * scale the rgb888 source frame to the calculated size (bilinear, fixed point)
+ * and blend the visible part at the calculated offsets into the
+ * rgb888 composite buffer at alpha (0 upto 255).
+ * Source coordinates and weights for the columns are calculated once per call,
+ * the 1:1 case (no scaling) copies or blends the rows directly.
+ */
+static void
+p_rgb_composite_blend_frame(guchar *dst, gint32 vid_width, gint32 vid_height
+  , const guchar *src, gint32 src_width, gint32 src_height
+  , GapStoryCalcAttr *calculated
+  , gint alpha)
+{
+  gint32  x1;
+  gint32  y1;
+  gint32  x2;
+  gint32  y2;
+  gint32  x;
+  gint32  y;
+  gint32  visibleWidth;
+  gint    alphaInv;
+  gint32 *colOffs0;
+  gint32 *colOffs1;
+  gint   *colWeight;
+  static gint32 funcIdScale = -1;
+
+  GAP_TIMM_GET_FUNCTION_ID(funcIdScale, "p_rgb_composite_blend_frame.Scale");
+
+  x1 = MAX(0, calculated->x_offs);
+  y1 = MAX(0, calculated->y_offs);
+  x2 = MIN(vid_width, calculated->x_offs + calculated->width);
+  y2 = MIN(vid_height, calculated->y_offs + calculated->height);
+  visibleWidth = x2 - x1;
+  alphaInv = 255 - alpha;
+
+  if ((visibleWidth <= 0) || (y2 <= y1))
+  {
+    return;
+  }
+
+  if ((calculated->width == src_width) && (calculated->height == src_height))
+  {
+    for(y = y1; y < y2; y++)
+    {
+      guchar       *dstRow;
+      const guchar *srcRow;
+
+      dstRow = dst + (((y * vid_width) + x1) * GAP_RGB_COMPOSITE_BPP);
+      srcRow = src + ((((y - calculated->y_offs) * src_width) + (x1 - calculated->x_offs)) * GAP_RGB_COMPOSITE_BPP);
+      if (alpha == 255)
+      {
+        memcpy(dstRow, srcRow, visibleWidth * GAP_RGB_COMPOSITE_BPP);
+      }
+      else
+      {
+        for(x = 0; x < visibleWidth * GAP_RGB_COMPOSITE_BPP; x++)
+        {
+          dstRow[x] = ((srcRow[x] * alpha) + (dstRow[x] * alphaInv) + 127) / 255;
+        }
+      }
+    }
+    return;
+  }
+
+  GAP_TIMM_START_FUNCTION(funcIdScale);
+
+  colOffs0  = g_new(gint32, visibleWidth);
+  colOffs1  = g_new(gint32, visibleWidth);
+  colWeight = g_new(gint, visibleWidth);
+
+  for(x = 0; x < visibleWidth; x++)
+  {
+    gint32 sx16;
+    gint32 sx;
+
+    /* source x in 16.16 fixed point (pixel centers are mapped onto each other) */
+    sx16 = (gint32)(((((gdouble)(x1 + x - calculated->x_offs) + 0.5) * (gdouble)src_width)
+                    / (gdouble)calculated->width - 0.5) * 65536.0);
+    sx16 = CLAMP(sx16, 0, (src_width - 1) << 16);
+    sx = sx16 >> 16;
+    colOffs0[x] = sx * GAP_RGB_COMPOSITE_BPP;
+    colOffs1[x] = MIN(sx + 1, src_width - 1) * GAP_RGB_COMPOSITE_BPP;
+    colWeight[x] = (sx16 >> 8) & 0xff;
+  }
+
+  for(y = y1; y < y2; y++)
+  {
+    guchar       *dstRow;
+    const guchar *srcRow0;
+    const guchar *srcRow1;
+    gint32        sy16;
+    gint32        sy;
+    gint          wy;
+    gint          wyInv;
+
+    sy16 = (gint32)(((((gdouble)(y - calculated->y_offs) + 0.5) * (gdouble)src_height)
+                    / (gdouble)calculated->height - 0.5) * 65536.0);
+    sy16 = CLAMP(sy16, 0, (src_height - 1) << 16);
+    sy = sy16 >> 16;
+    wy = (sy16 >> 8) & 0xff;
+    wyInv = 256 - wy;
+
+    srcRow0 = src + (sy * src_width * GAP_RGB_COMPOSITE_BPP);
+    srcRow1 = src + (MIN(sy + 1, src_height - 1) * src_width * GAP_RGB_COMPOSITE_BPP);
+    dstRow = dst + (((y * vid_width) + x1) * GAP_RGB_COMPOSITE_BPP);
+
+    for(x = 0; x < visibleWidth; x++)
+    {
+      const guchar *p00;
+      const guchar *p01;
+      const guchar *p10;
+      const guchar *p11;
+      gint          wx;
+      gint          wxInv;
+      gint          ch;
+
+      p00 = srcRow0 + colOffs0[x];
+      p01 = srcRow0 + colOffs1[x];
+      p10 = srcRow1 + colOffs0[x];
+      p11 = srcRow1 + colOffs1[x];
+      wx = colWeight[x];
+      wxInv = 256 - wx;
+
+      for(ch = 0; ch < GAP_RGB_COMPOSITE_BPP; ch++)
+      {
+        guint32 top;
+        guint32 bottom;
+        guint32 value;
+
+        top    = (p00[ch] * wxInv) + (p01[ch] * wx);
+        bottom = (p10[ch] * wxInv) + (p11[ch] * wx);
+        value  = ((top * wyInv) + (bottom * wy) + 32768) >> 16;
+
+        if (alpha == 255)
+        {
+          dstRow[ch] = value;
+        }
+        else
+        {
+          dstRow[ch] = ((value * alpha) + (dstRow[ch] * alphaInv) + 127) / 255;
+        }
+      }
+      dstRow += GAP_RGB_COMPOSITE_BPP;
+    }
+  }
+
+  g_free(colOffs0);
+  g_free(colOffs1);
+  g_free(colWeight);
+
+  GAP_TIMM_STOP_FUNCTION(funcIdScale);
+
+}  /* end p_rgb_composite_blend_frame */
+
+
+/* ----------------------------------------------------
+ * p_rgb_composite_fetch_movie_frame
+ * ----------------------------------------------------
+ * fetch the movie frame for the track described by gfd as rgb888 data
+ * into the scratch buffer.
+ * returns the buffer (at gvahand width * height size) or NULL
+ * in case the frame is not available as rgb888.
+ */
+static guchar *
+p_rgb_composite_fetch_movie_frame(GapStbFetchData *gfd
+  , GapStoryRenderVidHandle *vidhand
+  , gint32 master_frame_nr
+  , gint32 vid_width
+  , gint32 vid_height
+  , gint32 *src_width
+  , gint32 *src_height)
+{
+  GapStoryFetchResult  movieFetchResult;
+  t_GVA_Handle        *gvahand;
+  gint32               frameSize;
+
+  p_check_and_open_video_handle(gfd->frn_elem
+                               , vidhand
+                               , master_frame_nr
+                               , gfd->frn_elem->basename /* videofile name */
+                               );
+  gvahand = gfd->frn_elem->gvahand;
+  if (gvahand == NULL)
+  {
+    return (NULL);
+  }
+  if ((gvahand->width <= 0) || (gvahand->height <= 0))
+  {
+    return (NULL);
+  }
+
+  frameSize = gvahand->width * gvahand->height * GAP_RGB_COMPOSITE_BPP;
+  if (frameSize > rgbCompositeScratchSize)
+  {
+    g_free(rgbCompositeScratchBuffer);
+    rgbCompositeScratchBuffer = g_malloc(frameSize);
+    rgbCompositeScratchSize = frameSize;
+  }
+
+  movieFetchResult.resultEnum = GAP_STORY_FETCH_RESULT_IS_ERROR;
+  movieFetchResult.layer_id = -1;
+  movieFetchResult.image_id = -1;
+  movieFetchResult.raw_rgb_data = rgbCompositeScratchBuffer;
+
+  gfd->gapStoryFetchResult = &movieFetchResult;
+  gfd->isRgb888Result      = TRUE;
+  p_stb_render_movie(gfd, vidhand, master_frame_nr, vid_width, vid_height);
+  gfd->gapStoryFetchResult = NULL;
+
+  if (movieFetchResult.resultEnum != GAP_STORY_FETCH_RESULT_IS_RAW_RGB888)
+  {
+    /* the decoder delivered the frame as gimp image (e.g. frame has alpha channel) */
+    if (gfd->tmp_image_id >= 0)
+    {
+      gap_image_delete_immediate(gfd->tmp_image_id);
+      gfd->tmp_image_id = -1;
+    }
+    return (NULL);
+  }
+
+  if (movieFetchResult.raw_rgb_data != rgbCompositeScratchBuffer)
+  {
+    /* the fetch allocated a new buffer, keep it as scratch buffer */
+    g_free(rgbCompositeScratchBuffer);
+    rgbCompositeScratchBuffer = movieFetchResult.raw_rgb_data;
+    rgbCompositeScratchSize = frameSize;
+  }
+
+  *src_width  = gvahand->width;
+  *src_height = gvahand->height;
+  return (rgbCompositeScratchBuffer);
+
+}  /* end p_rgb_composite_fetch_movie_frame */
+
+
+/* ----------------------------------------------------
+ * p_story_render_rgb_composite_where_possible
+ * ----------------------------------------------------
+ * this procedure checks if the composite frame at master_frame_nr can be
+ * rendered natively into the rgb888 result buffer.
+ * This is possible when all tracks refer to movie clips, color clips or silence,
+ * where only scale, move and opacity transitions are used.
+ * (frames, images, animimages, sections, masks, filtermacros, movepath, flip
+ * and rotation are handled by the gimp layer based render engine)
+ *
+ * if native compositing is possible for the current master_frame_nr
+ * the composite is rendered into gapStoryFetchResult->raw_rgb_data
+ * (allocated at vid_width * vid_height * 3 when NULL)
+ * and TRUE will be returned. otherwise FALSE is returned.
+ */
+static gboolean
+p_story_render_rgb_composite_where_possible(GapStoryRenderVidHandle *vidhand
+                    , gint32 master_frame_nr  /* starts at 1 */
+                    , gint32  vid_width       /* desired Video Width in pixels */
+                    , gint32  vid_height      /* desired Video Height in pixels */
+                    , GapStoryFetchResult      *gapStoryFetchResult
+                    )
+{
+  GapStbFetchData *gfdTracks;
+  GapStbFetchData *gfd;
+  gint32           l_track;
+  gint32           l_idx;
+  gint32           numTracks;
+  gboolean         isNativeComposite;
+  gboolean         isBottomTrack;
+  guchar          *dst;
+
+  static gint32 funcId = -1;
+  static gint32 funcIdCheck = -1;
+
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "p_story_render_rgb_composite_where_possible");
+  GAP_TIMM_GET_FUNCTION_ID(funcIdCheck, "p_story_render_rgb_composite_where_possible.Check");
+
+  if (p_rgb_composite_is_enabled() != TRUE)
+  {
+    return (FALSE);
+  }
+
+  numTracks = 1 + vidhand->maxVidTrack - vidhand->minVidTrack;
+  if ((numTracks <= 0) || (vid_width <= 0) || (vid_height <= 0))
+  {
+    return (FALSE);
+  }
+
+  GAP_TIMM_START_FUNCTION(funcId);
+  GAP_TIMM_START_FUNCTION(funcIdCheck);
+
+  isNativeComposite = TRUE;
+  isBottomTrack = TRUE;
+  gfdTracks = g_new0(GapStbFetchData, numTracks);
+
+  /* check all tracks, starting at the bottom of the layerstack (maxVidTrack) */
+  for(l_track = vidhand->maxVidTrack; l_track >= vidhand->minVidTrack; l_track--)
+  {
+    gfd = &gfdTracks[vidhand->maxVidTrack - l_track];
+    gfd->comp_image_id = -1;
+    gfd->tmp_image_id  = -1;
+    gfd->layer_id      = -1;
+    gfd->framename = p_fetch_framename(vidhand
+                 , master_frame_nr /* starts at 1 */
+                 , l_track
+                 , gfd
+                 );
+
+    if (p_rgb_composite_is_track_supported(gfd, vidhand) != TRUE)
+    {
+      isNativeComposite = FALSE;
+      break;
+    }
+
+    if ((gfd->framename) || (gfd->frn_type == GAP_FRN_COLOR))
+    {
+      if ((isBottomTrack)
+      && (gfd->frn_type == GAP_FRN_COLOR)
+      && (gfd->alpha_f < 1.0)
+      && (p_rgb_composite_is_direct_track(gfd) == TRUE))
+      {
+        /* the gimp layer based engine uses the transparent color image
+         * as composite image and flattens it against the background color
+         */
+        isNativeComposite = FALSE;
+        break;
+      }
+      isBottomTrack = FALSE;
+    }
+  }
+
+  GAP_TIMM_STOP_FUNCTION(funcIdCheck);
+
+  if(gap_debug)
+  {
+    printf("p_story_render_rgb_composite_where_possible master_frame_nr:%d isNativeComposite:%d\n"
+      ,(int)master_frame_nr
+      ,(int)isNativeComposite
+      );
+  }
+
+  if (isNativeComposite == TRUE)
+  {
+    if (gapStoryFetchResult->raw_rgb_data == NULL)
+    {
+      gapStoryFetchResult->raw_rgb_data = g_malloc(vid_width * vid_height * GAP_RGB_COMPOSITE_BPP);
+    }
+    dst = gapStoryFetchResult->raw_rgb_data;
+
+    /* opaque black background */
+    memset(dst, 0, vid_width * vid_height * GAP_RGB_COMPOSITE_BPP);
+
+    /* render from bottom to top, track minVidTrack is processed last (foreground) */
+    for(l_idx = 0; l_idx < numTracks; l_idx++)
+    {
+      GapStoryCalcAttr  calculate_attributes;
+      const guchar     *src;
+      gint32            src_width;
+      gint32            src_height;
+      gint              alpha;
+
+      gfd = &gfdTracks[l_idx];
+      if ((gfd->framename == NULL) && (gfd->frn_type != GAP_FRN_COLOR))
+      {
+        continue;
+      }
+
+      src = NULL;
+      src_width  = vid_width;
+      src_height = vid_height;
+      if (gfd->frn_type == GAP_FRN_MOVIE)
+      {
+        src = p_rgb_composite_fetch_movie_frame(gfd, vidhand, master_frame_nr
+                                               , vid_width, vid_height
+                                               , &src_width, &src_height);
+        if (src == NULL)
+        {
+          isNativeComposite = FALSE;
+          break;
+        }
+      }
+
+      gap_story_file_calculate_render_attributes(&calculate_attributes
+        , vid_width
+        , vid_height
+        , vid_width
+        , vid_height
+        , src_width
+        , src_height
+        , gfd->keep_proportions
+        , gfd->fit_width
+        , gfd->fit_height
+        , gfd->rotate
+        , gfd->opacity
+        , gfd->scale_x
+        , gfd->scale_y
+        , gfd->move_x
+        , gfd->move_y
+        );
+
+      if (gfd->frn_type == GAP_FRN_COLOR)
+      {
+        alpha = rint(calculate_attributes.opacity * 2.55 * CLAMP(gfd->alpha_f, 0.0, 1.0));
+        if (alpha > 0)
+        {
+          p_rgb_composite_fill_color(dst, vid_width, vid_height
+            , &calculate_attributes
+            , (guchar)CLAMP(rint(gfd->red_f * 255.0), 0, 255)
+            , (guchar)CLAMP(rint(gfd->green_f * 255.0), 0, 255)
+            , (guchar)CLAMP(rint(gfd->blue_f * 255.0), 0, 255)
+            , alpha
+            );
+        }
+      }
+      else
+      {
+        alpha = rint(calculate_attributes.opacity * 2.55);
+        if (alpha > 0)
+        {
+          p_rgb_composite_blend_frame(dst, vid_width, vid_height
+            , src, src_width, src_height
+            , &calculate_attributes
+            , alpha
+            );
+        }
+      }
+    }
+  }
+
+  for(l_idx = 0; l_idx < numTracks; l_idx++)
+  {
+    if (gfdTracks[l_idx].framename != NULL)
+    {
+      g_free(gfdTracks[l_idx].framename);
+    }
+  }
+  g_free(gfdTracks);
+
+  if (isNativeComposite == TRUE)
+  {
+    gapStoryFetchResult->resultEnum = GAP_STORY_FETCH_RESULT_IS_RAW_RGB888;
+    gapStoryFetchResult->layer_id = -1;
+    gapStoryFetchResult->image_id = -1;
+  }
+
+  GAP_TIMM_STOP_FUNCTION(funcId);
+
+  return (isNativeComposite);
+
+}  /* end p_story_render_rgb_composite_where_possible */
+
+#endif
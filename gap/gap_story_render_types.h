@@ -333,9 +333,37 @@ typedef struct GapStoryRenderErrors
 
 
 
+/* interval index over the elements of one track in a frn_list
+ * (elements in list order, start/end are the master frame ranges
+ *  start < master_frame_nr <= end covered by the element,
+ *  including frames added by the wait_until attribute)
+ * The index is not changed after it was built
+ * (concurrent lookups need no lock)
+ */
+typedef struct GapStoryRenderFrnIndexTrack  /* nick: itrack */
+{
+  gint32                          track;
+  gint32                          count;
+  gint32                         *start;        /* prefix sum of the frames before the element */
+  gint32                         *end;          /* start + frames of the element */
+  gint32                         *list_idx;     /* position of the element in the frn_list */
+  GapStoryRenderFrameRangeElem  **elems;
+  gboolean                        isSorted;     /* FALSE: end values not ascending, use sequential search */
+} GapStoryRenderFrnIndexTrack;
+
+typedef struct GapStoryRenderFrnIndex  /* nick: frnidx */
+{
+  GapStoryRenderFrameRangeElem    *frn_list;    /* the list this index was built for */
+  gint32                           list_length;
+  gint32                           numTracks;
+  GapStoryRenderFrnIndexTrack     *itracks;
+} GapStoryRenderFrnIndex;
+
+
 typedef struct GapStoryRenderSection
 {
   GapStoryRenderFrameRangeElem    *frn_list;
+  GapStoryRenderFrnIndex          *frn_index;     /* NULL or interval index of frn_list */
   GapStoryRenderAudioRangeElem    *aud_list;
   gchar                           *section_name;  /* null refers to the main section */
   void                            *next;
@@ -348,6 +376,7 @@ typedef struct GapStoryRenderVidHandle  /* nick: vidhand */
   GapStoryRenderSection           *section_list;
   GapStoryRenderSection           *parsing_section;
   GapStoryRenderFrameRangeElem    *frn_list;
+  GapStoryRenderFrnIndex          *frn_index;     /* index of the current section (refers to section->frn_index) */
   GapStoryRenderAudioRangeElem    *aud_list;
   GapStoryRenderErrors            *sterr;
   char                         *preferred_decoder;
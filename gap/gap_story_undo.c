@@ -21,6 +21,13 @@
 
 /* revision history:
  * version 1.3.25a; 2007/10/18  hof: created
+ * version 2.7.0;   2026/10/18  undo elements keep shared references to unchanged
+ *                              clips and sections instead of full storyboard duplicates.
+ *                              the undo stack size is limited by gimprc
+ *                              parameter video-storyboard-undo-size
+ * version 2.7.0;   2026/10/18  file snapshots are included in the undo stack size.
+ *                              the next snapshot compares only the clips and sections
+ *                              that the pushed feature marks as dirty.
  */
 
 #include "config.h"
@@ -48,8 +55,17 @@
 
 extern int gap_debug;  /* 1 == print debug infos , 0 dont print debug infos */
 
-static void             p_free_undo_elem(GapStoryUndoElem    *undo_elem);
+/* number of elements in the previous undo section that are checked
+ * for an equal element (starting at the position after the last match)
+ * when an element can not be matched by its story_id.
+ */
+#define GAP_STB_UNDO_MATCH_WINDOW   8
+
+#define GAP_STB_UNDO_DEFAULT_SIZE_MB  64
+
+static void             p_free_undo_elem(GapStbTabWidgets *tabw, GapStoryUndoElem *undo_elem);
 static void             p_delete_redo_stack_area(GapStbTabWidgets *tabw);
+static void             p_set_dirty_all(GapStoryUndoElem *undo_elem);
 
 /* ----------------------------------------------------
  * gap_stb_undo_debug_print_stack
@@ -200,6 +216,36 @@ p_create_file_snapshot(char *filename)
 }  /* end p_create_file_snapshot */
 
 
+/* -----------------------------------------
+ * p_add_file_snapshot_bytes
+ * -----------------------------------------
+ * add the estimated memory usage of the file snapshot (including the
+ * filecontent) to the byte_size of the undo element and to the undo stack size.
+ * (p_free_undo_elem subtracts the byte_size when the undo element is freed)
+ */
+static void
+p_add_file_snapshot_bytes(GapStbTabWidgets *tabw, GapStoryUndoElem *undo_elem
+  , GapStoryUndoFileSnapshot *fileSnapshot)
+{
+  gint32 byte_size;
+
+  if(fileSnapshot == NULL)
+  {
+    return;
+  }
+
+  byte_size = sizeof(GapStoryUndoFileSnapshot) + fileSnapshot->filesize;
+  if(fileSnapshot->filename)
+  {
+    byte_size += strlen(fileSnapshot->filename) + 1;
+  }
+
+  undo_elem->byte_size += byte_size;
+  tabw->undo_stack_bytes += byte_size;
+
+}  /* end p_add_file_snapshot_bytes */
+
+
 
 /* -----------------------------------------
  * p_replace_file_from_snapshot
@@ -256,6 +302,609 @@ p_replace_file_from_snapshot(GapStoryUndoFileSnapshot* fileSnapshot)
 }  /* end p_replace_file_from_snapshot */
 
 
+/* ---------------------------------------
+ * p_estimate_elem_size
+ * ---------------------------------------
+ * estimate the memory usage of an element reference
+ * (including the copy of the storyboard element and its strings)
+ */
+static gint32
+p_estimate_elem_size(GapStoryElem *stb_elem)
+{
+  gint32 byte_size;
+
+  byte_size = sizeof(GapStoryUndoElemRef) + sizeof(GapStoryElem);
+  if(stb_elem->orig_filename)          { byte_size += strlen(stb_elem->orig_filename) + 1; }
+  if(stb_elem->orig_src_line)          { byte_size += strlen(stb_elem->orig_src_line) + 1; }
+  if(stb_elem->basename)               { byte_size += strlen(stb_elem->basename) + 1; }
+  if(stb_elem->ext)                    { byte_size += strlen(stb_elem->ext) + 1; }
+  if(stb_elem->filtermacro_file)       { byte_size += strlen(stb_elem->filtermacro_file) + 1; }
+  if(stb_elem->colormask_file)         { byte_size += strlen(stb_elem->colormask_file) + 1; }
+  if(stb_elem->preferred_decoder)      { byte_size += strlen(stb_elem->preferred_decoder) + 1; }
+  if(stb_elem->att_movepath_file_xml)  { byte_size += strlen(stb_elem->att_movepath_file_xml) + 1; }
+  if(stb_elem->mask_name)              { byte_size += strlen(stb_elem->mask_name) + 1; }
+  if(stb_elem->aud_filename)           { byte_size += strlen(stb_elem->aud_filename) + 1; }
+
+  return (byte_size);
+}  /* end p_estimate_elem_size */
+
+
+/* ---------------------------------------
+ * p_new_elem_ref
+ * ---------------------------------------
+ * create a new element reference with a private copy of stb_elem
+ */
+static GapStoryUndoElemRef *
+p_new_elem_ref(GapStbTabWidgets *tabw, GapStoryElem *stb_elem)
+{
+  GapStoryUndoElemRef *elem_ref;
+
+  elem_ref = g_new(GapStoryUndoElemRef, 1);
+  elem_ref->stb_elem = gap_story_elem_duplicate(stb_elem);
+  elem_ref->ref_count = 1;
+  elem_ref->byte_size = p_estimate_elem_size(stb_elem);
+
+  tabw->undo_stack_bytes += elem_ref->byte_size;
+
+  return (elem_ref);
+}  /* end p_new_elem_ref */
+
+
+/* ---------------------------------------
+ * p_unref_elem_ref
+ * ---------------------------------------
+ * release one reference, free the element reference
+ * when it is no longer used by any undo section.
+ */
+static void
+p_unref_elem_ref(GapStbTabWidgets *tabw, GapStoryUndoElemRef *elem_ref)
+{
+  if(elem_ref == NULL)
+  {
+    return;
+  }
+
+  elem_ref->ref_count--;
+  if(elem_ref->ref_count > 0)
+  {
+    return;
+  }
+
+  tabw->undo_stack_bytes -= elem_ref->byte_size;
+  if(elem_ref->stb_elem != NULL)
+  {
+    gap_story_elem_free(&elem_ref->stb_elem);
+  }
+  g_free(elem_ref);
+
+}  /* end p_unref_elem_ref */
+
+
+/* ---------------------------------------
+ * p_find_undo_section
+ * ---------------------------------------
+ * find the undo section with the specified section_name
+ * in the sections of undo_elem.
+ * (NULL section_name refers to the main section)
+ */
+static GapStoryUndoSection *
+p_find_undo_section(GapStoryUndoElem *undo_elem, const char *section_name)
+{
+  gint32 ii;
+
+  if(undo_elem == NULL)
+  {
+    return (NULL);
+  }
+
+  for(ii=0; ii < undo_elem->section_count; ii++)
+  {
+    GapStoryUndoSection *usection;
+
+    usection = undo_elem->sections[ii];
+    if((usection->section_name == NULL) && (section_name == NULL))
+    {
+      return (usection);
+    }
+    if((usection->section_name != NULL) && (section_name != NULL))
+    {
+      if(strcmp(usection->section_name, section_name) == 0)
+      {
+        return (usection);
+      }
+    }
+  }
+  return (NULL);
+
+}  /* end p_find_undo_section */
+
+
+/* ---------------------------------------
+ * p_unref_undo_section
+ * ---------------------------------------
+ * release one reference, free the undo section (and release
+ * its element references) when it is no longer used by any undo element.
+ */
+static void
+p_unref_undo_section(GapStbTabWidgets *tabw, GapStoryUndoSection *usection)
+{
+  gint32 ii;
+
+  if(usection == NULL)
+  {
+    return;
+  }
+
+  usection->ref_count--;
+  if(usection->ref_count > 0)
+  {
+    return;
+  }
+
+  for(ii=0; ii < usection->elem_count; ii++)
+  {
+    p_unref_elem_ref(tabw, usection->elem_refs[ii]);
+  }
+  tabw->undo_stack_bytes -= (sizeof(GapStoryUndoSection)
+                            + (usection->elem_count * sizeof(GapStoryUndoElemRef *)));
+  if(usection->section_name)
+  {
+    g_free(usection->section_name);
+  }
+  if(usection->elem_refs)
+  {
+    g_free(usection->elem_refs);
+  }
+  g_free(usection);
+
+}  /* end p_unref_undo_section */
+
+
+/* ---------------------------------------
+ * p_is_same_clip
+ * ---------------------------------------
+ * check if rec_elem (a recorded copy) was recorded from the live element stb_elem
+ * or stb_elem was restored from rec_elem by undo.
+ */
+static gboolean
+p_is_same_clip(GapStoryElem *rec_elem, GapStoryElem *stb_elem)
+{
+  if(rec_elem->story_orig_id == stb_elem->story_id)
+  {
+    return (TRUE);
+  }
+  if((stb_elem->story_orig_id >= 0) && (stb_elem->story_orig_id == rec_elem->story_id))
+  {
+    return (TRUE);
+  }
+  return (FALSE);
+
+}  /* end p_is_same_clip */
+
+
+/* ---------------------------------------
+ * p_is_same_clip_sequence
+ * ---------------------------------------
+ * check if the live elements of the section are the recorded elements
+ * of prev_usection in unchanged order (compared by identity only).
+ */
+static gboolean
+p_is_same_clip_sequence(GapStorySection *section, GapStoryUndoSection *prev_usection
+  , gint32 elem_count)
+{
+  GapStoryElem *stb_elem;
+  gint32        ii;
+
+  if(prev_usection->elem_count != elem_count)
+  {
+    return (FALSE);
+  }
+
+  ii = 0;
+  for(stb_elem = section->stb_elem; stb_elem != NULL; stb_elem = stb_elem->next)
+  {
+    if(p_is_same_clip(prev_usection->elem_refs[ii]->stb_elem, stb_elem) != TRUE)
+    {
+      return (FALSE);
+    }
+    ii++;
+  }
+  return (TRUE);
+
+}  /* end p_is_same_clip_sequence */
+
+
+/* ---------------------------------------
+ * p_new_undo_section
+ * ---------------------------------------
+ * create an undo section that records the elements of the specified section.
+ * elements that are equal to an element of prev_usection (the same section
+ * in the previous undo element) share its element reference,
+ * only changed or new elements are copied.
+ *
+ * is_dirty and dirty_story_id describe the changes since prev_usection was recorded
+ * (as marked by the feature of the previous undo element):
+ * if the section is not dirty, or only the clip with dirty_story_id has changed,
+ * and the section still holds the recorded clips in the same order,
+ * the unchanged clips share their element reference without comparing
+ * attributes and only the dirty clip is compared.
+ * Otherwise (all clips are dirty, or the clip sequence does not match)
+ * the element of prev_usection is found by identity:
+ * the recorded copy has the story_id of the live element as story_orig_id,
+ * and elements restored by undo have the story_id of the recorded copy
+ * as story_orig_id. Elements without identity match (e.g. replaced by a duplicate)
+ * are searched in a small window after the position of the last match.
+ * Therefore any number of inserted or deleted elements does not prevent
+ * sharing of the unchanged elements.
+ * if nothing has changed at all, prev_usection itself is shared
+ * and returned (with incremented ref_count).
+ */
+static GapStoryUndoSection *
+p_new_undo_section(GapStbTabWidgets *tabw, GapStorySection *section
+  , GapStoryUndoSection *prev_usection, gboolean is_dirty, gint32 dirty_story_id)
+{
+  GapStoryUndoSection *usection;
+  GapStoryElem        *stb_elem;
+  GHashTable          *id_table;
+  gint32               ii;
+  gint32               cursor;
+  gboolean             all_shared;
+  gboolean             use_dirty_marks;
+
+  usection = g_new(GapStoryUndoSection, 1);
+  usection->section_name = NULL;
+  if(section->section_name)
+  {
+    usection->section_name = g_strdup(section->section_name);
+  }
+  usection->ref_count = 1;
+
+  usection->elem_count = 0;
+  for(stb_elem = section->stb_elem; stb_elem != NULL; stb_elem = stb_elem->next)
+  {
+    usection->elem_count++;
+  }
+  usection->elem_refs = NULL;
+  if(usection->elem_count > 0)
+  {
+    usection->elem_refs = g_new(GapStoryUndoElemRef *, usection->elem_count);
+  }
+  tabw->undo_stack_bytes += (sizeof(GapStoryUndoSection)
+                            + (usection->elem_count * sizeof(GapStoryUndoElemRef *)));
+
+  all_shared = FALSE;
+  use_dirty_marks = FALSE;
+  id_table = NULL;
+  if(prev_usection != NULL)
+  {
+    all_shared = (prev_usection->elem_count == usection->elem_count);
+    if((is_dirty != TRUE) || (dirty_story_id >= 0))
+    {
+      use_dirty_marks = p_is_same_clip_sequence(section, prev_usection, usection->elem_count);
+    }
+  }
+
+  if((prev_usection != NULL) && (use_dirty_marks != TRUE))
+  {
+    /* map the ids of the recorded elements to their position + 1 in prev_usection
+     * (story_id values are unique, recorded copy and live element ids do not collide)
+     */
+    id_table = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for(ii=0; ii < prev_usection->elem_count; ii++)
+    {
+      GapStoryElem *rec_elem;
+
+      rec_elem = prev_usection->elem_refs[ii]->stb_elem;
+      g_hash_table_insert(id_table, GINT_TO_POINTER(rec_elem->story_id), GINT_TO_POINTER(ii + 1));
+      if(rec_elem->story_orig_id >= 0)
+      {
+        g_hash_table_insert(id_table, GINT_TO_POINTER(rec_elem->story_orig_id), GINT_TO_POINTER(ii + 1));
+      }
+    }
+  }
+
+  cursor = 0;
+  ii = 0;
+  for(stb_elem = section->stb_elem; stb_elem != NULL; stb_elem = stb_elem->next)
+  {
+    GapStoryUndoElemRef *elem_ref;
+
+    elem_ref = NULL;
+    if(use_dirty_marks)
+    {
+      /* same clip at same position, compare only the dirty clip */
+      if((is_dirty != TRUE)
+      || (stb_elem->story_id != dirty_story_id)
+      || (gap_story_elem_is_equal(prev_usection->elem_refs[ii]->stb_elem, stb_elem)))
+      {
+        elem_ref = prev_usection->elem_refs[ii];
+        elem_ref->ref_count++;
+      }
+    }
+    else if(prev_usection != NULL)
+    {
+      gint32 jj;
+
+      /* identity match (by the id of the live element or of its origin) */
+      jj = GPOINTER_TO_INT(g_hash_table_lookup(id_table, GINT_TO_POINTER(stb_elem->story_id))) -1;
+      if((jj < 0) && (stb_elem->story_orig_id >= 0))
+      {
+        jj = GPOINTER_TO_INT(g_hash_table_lookup(id_table, GINT_TO_POINTER(stb_elem->story_orig_id))) -1;
+      }
+      if(jj >= 0)
+      {
+        if(gap_story_elem_is_equal(prev_usection->elem_refs[jj]->stb_elem, stb_elem))
+        {
+          elem_ref = prev_usection->elem_refs[jj];
+          elem_ref->ref_count++;
+        }
+        /* resync the window position even if the element was changed */
+        cursor = jj + 1;
+      }
+
+      for(jj = cursor;
+          (elem_ref == NULL) && (jj < prev_usection->elem_count) && (jj < cursor + GAP_STB_UNDO_MATCH_WINDOW);
+          jj++)
+      {
+        if(gap_story_elem_is_equal(prev_usection->elem_refs[jj]->stb_elem, stb_elem))
+        {
+          elem_ref = prev_usection->elem_refs[jj];
+          elem_ref->ref_count++;
+          cursor = jj + 1;
+          break;
+        }
+      }
+    }
+
+    if(elem_ref == NULL)
+    {
+      elem_ref = p_new_elem_ref(tabw, stb_elem);
+      all_shared = FALSE;
+    }
+    else if((all_shared) && (elem_ref != prev_usection->elem_refs[ii]))
+    {
+      all_shared = FALSE;
+    }
+
+    usection->elem_refs[ii] = elem_ref;
+    ii++;
+  }
+
+  if(id_table != NULL)
+  {
+    g_hash_table_destroy(id_table);
+  }
+
+  if(all_shared)
+  {
+    /* the section is unchanged, share the previous undo section */
+    p_unref_undo_section(tabw, usection);
+    prev_usection->ref_count++;
+    return (prev_usection);
+  }
+
+  return (usection);
+
+}  /* end p_new_undo_section */
+
+
+/* ---------------------------------------
+ * p_is_dirty_section
+ * ---------------------------------------
+ * check if the feature of undo_elem may have changed clips
+ * in the section with section_name.
+ * (NULL section_name refers to the main section)
+ */
+static gboolean
+p_is_dirty_section(GapStoryUndoElem *undo_elem, const char *section_name)
+{
+  if(undo_elem == NULL)
+  {
+    return (TRUE);
+  }
+  if(undo_elem->dirty_section_only != TRUE)
+  {
+    return (TRUE);
+  }
+  if((undo_elem->dirty_section_name == NULL) || (section_name == NULL))
+  {
+    return (undo_elem->dirty_section_name == section_name);
+  }
+  return (strcmp(undo_elem->dirty_section_name, section_name) == 0);
+
+}  /* end p_is_dirty_section */
+
+
+/* ---------------------------------------
+ * p_create_snapshot
+ * ---------------------------------------
+ * record the current state of the storyboard stb in undo_elem.
+ * undo_elem->stb holds a copy of master data, edit settings and the
+ * section structure (without elements), the elements
+ * are recorded in undo sections that share unchanged elements
+ * with prev_undo_elem (the previously recorded undo element, may be NULL).
+ * only the clips and sections marked dirty by the feature of prev_undo_elem
+ * are compared with their recorded copies.
+ */
+static void
+p_create_snapshot(GapStbTabWidgets *tabw, GapStoryUndoElem *undo_elem
+  , GapStoryBoard *stb, GapStoryUndoElem *prev_undo_elem)
+{
+  GapStorySection *section;
+  gint32           ii;
+
+  undo_elem->stb = NULL;
+  undo_elem->sections = NULL;
+  undo_elem->section_count = 0;
+  undo_elem->byte_size = sizeof(GapStoryUndoElem) + sizeof(GapStoryBoard);
+
+  if(stb != NULL)
+  {
+    undo_elem->stb = gap_story_duplicate_without_elems(stb);
+  }
+  if(undo_elem->stb == NULL)
+  {
+    tabw->undo_stack_bytes += undo_elem->byte_size;
+    return;
+  }
+
+  for(section = stb->stb_section; section != NULL; section = section->next)
+  {
+    undo_elem->section_count++;
+  }
+  if(undo_elem->section_count > 0)
+  {
+    undo_elem->sections = g_new(GapStoryUndoSection *, undo_elem->section_count);
+  }
+
+  ii = 0;
+  for(section = stb->stb_section; section != NULL; section = section->next)
+  {
+    undo_elem->sections[ii] = p_new_undo_section(tabw
+                                  , section
+                                  , p_find_undo_section(prev_undo_elem, section->section_name)
+                                  , p_is_dirty_section(prev_undo_elem, section->section_name)
+                                  , (prev_undo_elem != NULL) ? prev_undo_elem->dirty_story_id : -1
+                                  );
+    ii++;
+  }
+
+  undo_elem->byte_size += (undo_elem->section_count * sizeof(GapStoryUndoSection *));
+  tabw->undo_stack_bytes += undo_elem->byte_size;
+
+  if(gap_debug)
+  {
+    printf("p_create_snapshot: sections:%d undo_stack_bytes:%.0f\n"
+      ,(int)undo_elem->section_count
+      ,(float)tabw->undo_stack_bytes
+      );
+  }
+
+}  /* end p_create_snapshot */
+
+
+/* ---------------------------------------
+ * p_restore_snapshot
+ * ---------------------------------------
+ * returns a new storyboard that is built from the recorded
+ * master data and the recorded (shared) elements of undo_elem.
+ * (the result is equal to a full duplicate of the storyboard
+ * at recording time)
+ */
+static GapStoryBoard *
+p_restore_snapshot(GapStoryUndoElem *undo_elem)
+{
+  GapStoryBoard *stb;
+  gint32         ii;
+  gint32         jj;
+
+  if(undo_elem->stb == NULL)
+  {
+    return (NULL);
+  }
+
+  stb = gap_story_duplicate_without_elems(undo_elem->stb);
+  if(stb == NULL)
+  {
+    return (NULL);
+  }
+
+  for(ii=0; ii < undo_elem->section_count; ii++)
+  {
+    GapStoryUndoSection *usection;
+    GapStorySection     *section;
+
+    usection = undo_elem->sections[ii];
+    section = gap_story_create_or_find_section_by_name(stb, usection->section_name);
+    for(jj=0; jj < usection->elem_count; jj++)
+    {
+      gap_story_list_append_elem_at_section(stb
+                 , gap_story_elem_duplicate(usection->elem_refs[jj]->stb_elem)
+                 , section
+                 );
+    }
+  }
+
+  stb->stb_parttype  = 0;  /* restored storyboard is a full copy */
+  stb->unsaved_changes = undo_elem->stb->unsaved_changes;
+
+  return (stb);
+
+}  /* end p_restore_snapshot */
+
+
+/* ---------------------------------------
+ * p_trim_undo_stack_to_budget
+ * ---------------------------------------
+ * discard the oldest undo elements while the estimated memory usage
+ * of the undo stack exceeds the limit that is configured
+ * by gimprc parameter video-storyboard-undo-size (in MB, 0 is unlimited).
+ * (the gimprc parameter is read only once per storyboard tab)
+ * only elements below the stackpointer are discarded
+ * (the element at the stackpointer and the redo area are kept).
+ */
+static void
+p_trim_undo_stack_to_budget(GapStbTabWidgets *tabw)
+{
+  gint64 max_bytes;
+
+  if(tabw->undo_stack_max_mb < 0)
+  {
+    tabw->undo_stack_max_mb = gap_base_get_gimprc_int_value(GAP_GIMPRC_VIDEO_STORYBOARD_UNDO_SIZE
+                                           , GAP_STB_UNDO_DEFAULT_SIZE_MB
+                                           , 0        /* min (0 is unlimited) */
+                                           , 1000000  /* max */
+                                           );
+  }
+  if(tabw->undo_stack_max_mb <= 0)
+  {
+    return;
+  }
+  max_bytes = (gint64)tabw->undo_stack_max_mb * (1024 * 1024);
+
+  while(tabw->undo_stack_bytes > max_bytes)
+  {
+    GapStoryUndoElem    *undo_elem;
+    GapStoryUndoElem    *prev_elem;
+    gboolean             stack_ptr_found;
+
+    if(tabw->undo_stack_list == NULL)
+    {
+      break;
+    }
+
+    /* find the oldest (last) element of the stack list */
+    prev_elem = NULL;
+    stack_ptr_found = FALSE;
+    for(undo_elem = tabw->undo_stack_list; undo_elem->next != NULL; undo_elem = undo_elem->next)
+    {
+      if(undo_elem == tabw->undo_stack_ptr)
+      {
+        stack_ptr_found = TRUE;
+      }
+      prev_elem = undo_elem;
+    }
+
+    if((prev_elem == NULL) || (stack_ptr_found != TRUE))
+    {
+      break;
+    }
+
+    if(gap_debug)
+    {
+      printf("p_trim_undo_stack_to_budget: undo_stack_bytes:%.0f max_bytes:%.0f\n"
+        ,(float)tabw->undo_stack_bytes
+        ,(float)max_bytes
+        );
+    }
+
+    prev_elem->next = NULL;
+    p_free_undo_elem(tabw, undo_elem);
+  }
+
+}  /* end p_trim_undo_stack_to_budget */
+
+
 
 
 
@@ -323,7 +972,7 @@ gap_stb_undo_pop(GapStbTabWidgets *tabw)
     tabw->undo_stack_ptr = tabw->undo_stack_ptr->next;
   }
 
-  stb = gap_story_duplicate_full(tabw->undo_stack_ptr->stb);
+  stb = p_restore_snapshot(tabw->undo_stack_ptr);
   
   if(tabw->undo_stack_ptr->fileSnapshotBefore != NULL)
   {
@@ -343,6 +992,11 @@ gap_stb_undo_pop(GapStbTabWidgets *tabw)
   
   tabw->undo_stack_ptr = tabw->undo_stack_ptr->next;
 
+  /* the storyboard is replaced by new copies of the recorded clips,
+   * the dirty marks (story_id of the live clip) do not apply to these copies.
+   */
+  p_set_dirty_all(tabw->undo_stack_ptr);
+
   gap_story_dlg_tabw_undo_redo_sensitivity(tabw);
   
   return (stb);
@@ -405,7 +1059,7 @@ gap_stb_undo_redo(GapStbTabWidgets *tabw)
 
   if (redo_elem != NULL)
   {
-    stb = gap_story_duplicate_full(redo_elem->stb);
+    stb = p_restore_snapshot(redo_elem);
     if(tabw->undo_stack_ptr != NULL)
     {
       if(tabw->undo_stack_ptr->fileSnapshotAfter != NULL)
@@ -414,6 +1068,9 @@ gap_stb_undo_redo(GapStbTabWidgets *tabw)
       }
     }
 
+    /* the storyboard is replaced by new copies of the recorded clips */
+    p_set_dirty_all(tabw->undo_stack_ptr);
+
     gap_story_dlg_tabw_undo_redo_sensitivity(tabw);
 
     if(gap_debug)
@@ -438,8 +1095,10 @@ gap_stb_undo_redo(GapStbTabWidgets *tabw)
  * ---------------------------------------
  */
 static void
-p_free_undo_elem(GapStoryUndoElem    *undo_elem)
+p_free_undo_elem(GapStbTabWidgets *tabw, GapStoryUndoElem *undo_elem)
 {
+  gint32 ii;
+
   if(undo_elem == NULL)
   {
     return;
@@ -476,6 +1135,15 @@ p_free_undo_elem(GapStoryUndoElem    *undo_elem)
   {
     gap_story_free_storyboard(&undo_elem->stb);
   }
+  for(ii=0; ii < undo_elem->section_count; ii++)
+  {
+    p_unref_undo_section(tabw, undo_elem->sections[ii]);
+  }
+  if(undo_elem->sections)
+  {
+    g_free(undo_elem->sections);
+  }
+  tabw->undo_stack_bytes -= undo_elem->byte_size;
   
   if(undo_elem->fileSnapshotBefore != NULL)
   {
@@ -487,6 +1155,10 @@ p_free_undo_elem(GapStoryUndoElem    *undo_elem)
     p_free_file_snapshot(undo_elem->fileSnapshotAfter);
     undo_elem->fileSnapshotAfter = NULL;
   }
+  if(undo_elem->dirty_section_name)
+  {
+    g_free(undo_elem->dirty_section_name);
+  }
   
   g_free(undo_elem);
   
@@ -545,7 +1217,7 @@ p_delete_redo_stack_area(GapStbTabWidgets *tabw)
       break;
     }
     next_elem = undo_elem->next;
-    p_free_undo_elem(undo_elem);
+    p_free_undo_elem(tabw, undo_elem);
   }
 
   tabw->undo_stack_list = new_root_elem;
@@ -584,8 +1256,104 @@ gap_stb_undo_destroy_undo_stack(GapStbTabWidgets *tabw)
 }  /* end gap_stb_undo_destroy_undo_stack */
 
 
+/* ---------------------------------------
+ * p_set_dirty_all
+ * ---------------------------------------
+ * mark all clips in all sections as dirty (changed by the feature of undo_elem)
+ */
+static void
+p_set_dirty_all(GapStoryUndoElem *undo_elem)
+{
+  if(undo_elem == NULL)
+  {
+    return;
+  }
+  undo_elem->dirty_story_id = -1;
+  undo_elem->dirty_section_only = FALSE;
+  if(undo_elem->dirty_section_name)
+  {
+    g_free(undo_elem->dirty_section_name);
+    undo_elem->dirty_section_name = NULL;
+  }
+
+}  /* end p_set_dirty_all */
+
+
+/* ---------------------------------------
+ * p_set_dirty_section
+ * ---------------------------------------
+ * mark all clips of the section with section_name as dirty
+ * (NULL section_name refers to the main section)
+ */
+static void
+p_set_dirty_section(GapStoryUndoElem *undo_elem, const char *section_name)
+{
+  p_set_dirty_all(undo_elem);
+  undo_elem->dirty_section_only = TRUE;
+  if(section_name)
+  {
+    undo_elem->dirty_section_name = g_strdup(section_name);
+  }
+
+}  /* end p_set_dirty_section */
+
+
+/* ---------------------------------------
+ * p_widen_dirty_scope
+ * ---------------------------------------
+ * extend the dirty marks of undo_elem by the clip (dirty_story_id)
+ * or the section (dirty_section) of a push that is collected into undo_elem
+ * (pushes within an undo group).
+ * a clip in the dirty section (or another clip in the section of the dirty clip)
+ * widens to the section, all other combinations mark all clips as dirty.
+ */
+static void
+p_widen_dirty_scope(GapStbTabWidgets *tabw, GapStoryUndoElem *undo_elem
+  , gint32 dirty_story_id, GapStorySection *dirty_section)
+{
+  if(undo_elem == NULL)
+  {
+    return;
+  }
+  if((undo_elem->dirty_section_only != TRUE) && (undo_elem->dirty_story_id < 0))
+  {
+    /* all clips are already marked dirty */
+    return;
+  }
+
+  if((dirty_section == NULL) && (dirty_story_id >= 0))
+  {
+    if(dirty_story_id == undo_elem->dirty_story_id)
+    {
+      return;
+    }
+    dirty_section = gap_story_find_section_by_story_id(gap_story_dlg_tabw_get_stb_ptr(tabw)
+                                                      , dirty_story_id);
+  }
+
+  if(dirty_section != NULL)
+  {
+    if(undo_elem->dirty_section_only)
+    {
+      if(p_is_dirty_section(undo_elem, dirty_section->section_name))
+      {
+        return;
+      }
+    }
+    else if(gap_story_elem_find_in_section_by_story_id(dirty_section, undo_elem->dirty_story_id) != NULL)
+    {
+      p_set_dirty_section(undo_elem, dirty_section->section_name);
+      return;
+    }
+  }
+
+  p_set_dirty_all(undo_elem);
+
+}  /* end p_widen_dirty_scope */
+
+
 /* -----------------------------------------
- * gap_stb_undo_push_clip_with_file_snapshot
+ * p_undo_push
  * -----------------------------------------
  * create a new undo element (according to specified parameters)
  * and place it at top (first) of the undo stack.
@@ -640,15 +1408,26 @@ gap_stb_undo_destroy_undo_stack(GapStbTabWidgets *tabw)
  *          (e.g. after processing EEEE is finished, that is relevant for redo EEEE purpose)
  *  EEEE.filenamePtr is rest to NULL
  *
+ * Dirty marks
+ * ===========
+ * the pushed element records the part of the storyboard that the feature
+ * is going to change: only the clip with story_id for the clip and transition
+ * properties features, only the clips of dirty_section if specified (not NULL),
+ * else all clips. The next push compares only the dirty clips with their
+ * recorded copies. (pushes that are collected into the same undo element
+ * widen the dirty marks, see gap_stb_undo_mark_all_dirty for features
+ * that change further clips)
  */
-void
-gap_stb_undo_push_clip_with_file_snapshot(GapStbTabWidgets *tabw
+static void
+p_undo_push(GapStbTabWidgets *tabw
    , GapStoryFeatureEnum feature_id, gint32 story_id
-   , char **filenamePtr)
+   , char **filenamePtr, GapStorySection *dirty_section)
 {
   GapStoryBoard       *stb;
   GapStoryUndoElem    *new_undo_elem;
   GapStoryUndoElem    *top_undo_elem;
+  GapStoryUndoElem    *prev_undo_elem;
+  gint32               dirty_story_id;
 
 
   if(tabw == NULL)
@@ -667,8 +1446,24 @@ gap_stb_undo_push_clip_with_file_snapshot(GapStbTabWidgets *tabw
   }
 
 
+  dirty_story_id = -1;
+  if(story_id >= 0)
+  {
+    switch (feature_id)
+    {
+      case GAP_STB_FEATURE_PROPERTIES_CLIP:
+      case GAP_STB_FEATURE_PROPERTIES_TRANSITION:
+        dirty_story_id = story_id;
+        break;
+      default:
+        break;
+    }
+  }
+
   if(tabw->undo_stack_group_counter > 1)
   {
+    /* the push is collected into the undo element of the group */
+    p_widen_dirty_scope(tabw, tabw->undo_stack_list, dirty_story_id, dirty_section);
     return;
   }
 
@@ -709,6 +1504,18 @@ gap_stb_undo_push_clip_with_file_snapshot(GapStbTabWidgets *tabw
   new_undo_elem->clip_story_id = story_id;
   new_undo_elem->feature_id = feature_id;
 
+  new_undo_elem->dirty_story_id = -1;
+  new_undo_elem->dirty_section_only = FALSE;
+  new_undo_elem->dirty_section_name = NULL;
+  if(dirty_section != NULL)
+  {
+    p_set_dirty_section(new_undo_elem, dirty_section->section_name);
+  }
+  else
+  {
+    new_undo_elem->dirty_story_id = dirty_story_id;
+  }
+
   new_undo_elem->filenamePtr = NULL;
   new_undo_elem->fileSnapshotBefore = NULL;
   new_undo_elem->fileSnapshotAfter = NULL;
@@ -743,6 +1550,7 @@ gap_stb_undo_push_clip_with_file_snapshot(GapStbTabWidgets *tabw
       if(filename != NULL)
       {
         top_undo_elem->fileSnapshotAfter = p_create_file_snapshot(filename);
+        p_add_file_snapshot_bytes(tabw, top_undo_elem, top_undo_elem->fileSnapshotAfter);
       }
     }
     /* clear the filenamePtr to disable multiple recording of fileSnapshotAfter
@@ -753,6 +1561,11 @@ gap_stb_undo_push_clip_with_file_snapshot(GapStbTabWidgets *tabw
     top_undo_elem->filenamePtr = NULL;
   }
   
+  /* the most recent recorded element (if any) is the reference
+   * for sharing unchanged elements.
+   */
+  prev_undo_elem = tabw->undo_stack_list;
+
   new_undo_elem->next = tabw->undo_stack_list;
 
   tabw->undo_stack_list = new_undo_elem;
@@ -760,10 +1573,28 @@ gap_stb_undo_push_clip_with_file_snapshot(GapStbTabWidgets *tabw
 
   gap_story_dlg_update_edit_settings(stb, tabw);
 
-  new_undo_elem->stb = gap_story_duplicate_full(stb);
+  p_create_snapshot(tabw, new_undo_elem, stb, prev_undo_elem);
+  p_add_file_snapshot_bytes(tabw, new_undo_elem, new_undo_elem->fileSnapshotBefore);
+
+  p_trim_undo_stack_to_budget(tabw);
 
   gap_story_dlg_tabw_undo_redo_sensitivity(tabw);
   
+}  /* end p_undo_push */
+
+
+/* -----------------------------------------
+ * gap_stb_undo_push_clip_with_file_snapshot
+ * -----------------------------------------
+ * push the feature on the clip with story_id and record
+ * a snapshot of the file *filenamePtr (see p_undo_push)
+ */
+void
+gap_stb_undo_push_clip_with_file_snapshot(GapStbTabWidgets *tabw
+   , GapStoryFeatureEnum feature_id, gint32 story_id
+   , char **filenamePtr)
+{
+  p_undo_push(tabw, feature_id, story_id, filenamePtr, NULL);
 }  /* end gap_stb_undo_push_clip_with_file_snapshot */
 
 
@@ -804,6 +1635,41 @@ gap_stb_undo_push(GapStbTabWidgets *tabw, GapStoryFeatureEnum feature_id)
 }  /* end gap_stb_undo_push */
 
 
+/* ---------------------------------------
+ * gap_stb_undo_push_section
+ * ---------------------------------------
+ * push a feature that changes only clips in the specified section
+ * (e.g. appends a new clip to the section).
+ * the next push compares only the clips of this section
+ * with their recorded copies.
+ */
+void
+gap_stb_undo_push_section(GapStbTabWidgets *tabw, GapStoryFeatureEnum feature_id
+  , GapStorySection *section)
+{
+  p_undo_push(tabw, feature_id, -1 /* story_id */, NULL, section);
+}  /* end gap_stb_undo_push_section */
+
+
+/* ---------------------------------------
+ * gap_stb_undo_mark_all_dirty
+ * ---------------------------------------
+ * this procedure is called by features that pushed a single clip or section
+ * but also change other clips (e.g. propagate a renamed mask
+ * to all references). it marks all clips as dirty in the
+ * undo element of the current feature.
+ */
+void
+gap_stb_undo_mark_all_dirty(GapStbTabWidgets *tabw)
+{
+  if(tabw == NULL)
+  {
+    return;
+  }
+  p_set_dirty_all(tabw->undo_stack_list);
+}  /* end gap_stb_undo_mark_all_dirty */
+
+
 
 /* ---------------------------------------
  * gap_stb_undo_group_begin
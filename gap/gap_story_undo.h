@@ -22,6 +22,7 @@
 
 /* revision history:
  * version 1.3.25a; 2007/10/18  hof: created
+ * version 2.7.0;   2026/10/18  added gap_stb_undo_push_section, gap_stb_undo_mark_all_dirty
  */
 
 #ifndef _GAP_STORY_UNDO_H
@@ -50,6 +51,11 @@ void                    gap_stb_undo_push_clip_with_file_snapshot(GapStbTabWidge
                            , char **filenamePtr);
 
 void                    gap_stb_undo_push(GapStbTabWidgets *tabw, GapStoryFeatureEnum feature_id);
+void                    gap_stb_undo_push_section(GapStbTabWidgets *tabw
+                           , GapStoryFeatureEnum feature_id
+                           , GapStorySection *section
+                           );
+void                    gap_stb_undo_mark_all_dirty(GapStbTabWidgets *tabw);
 void                    gap_stb_undo_group_begin(GapStbTabWidgets *tabw);
 void                    gap_stb_undo_group_end(GapStbTabWidgets *tabw);
 
@@ -0,0 +1,726 @@
+/* gap_story_undo_bench.c
+ *
+ * GAP ... Gimp Animation Plugins
+ *
+ * check and benchmark for the storyboard undo stack (gap_story_undo.c)
+ *
+ *   a) budget: undo elements with file snapshots (the xml file of a transition)
+ *      are pushed with a 1 MB limit of the undo stack size.
+ *      undo_stack_bytes must include the filecontent of the snapshots,
+ *      must be equal to the sum recounted from all (shared) undo sections
+ *      and element references, the stack must be trimmed to the limit
+ *      and undo_stack_bytes must be 0 after destroying the undo stack.
+ *   b) snapshots: a random sequence of clip property changes, clips appended
+ *      to a section, cut clips, mask renames (propagated to other clips),
+ *      undo and redo on a storyboard with 3 sections (with a fixed seed).
+ *      after each push the restored snapshot must be equal to the storyboard.
+ *   c) dirty marks: a sequence of property changes on different clips
+ *      must not compare more than one clip per push.
+ *
+ * usage:
+ *   gap_story_undo_bench             check on a 300 clip storyboard (run by make check)
+ *   gap_story_undo_bench -b [n]      check and benchmark (200 property pushes)
+ *                                    on a n clip storyboard (default 5000)
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * 2026.10.18  created
+ */
+
+/* included (not linked) to access the static undo procedures,
+ * the element compare of the undo module is counted.
+ */
+#define gap_story_elem_is_equal  p_counted_elem_is_equal
+#include "gap_story_undo.c"
+#undef gap_story_elem_is_equal
+
+gboolean            gap_story_elem_is_equal(GapStoryElem *stb_elem1, GapStoryElem *stb_elem2);
+
+#define BENCH_PUSHES  200
+
+int gap_debug = 0;  /* 1 == print debug infos , 0 dont print debug infos */
+
+static GapStoryBoard *global_stb = NULL;
+static gint32         global_compare_count = 0;
+
+
+/* ---------------------------------
+ * p_counted_elem_is_equal
+ * ---------------------------------
+ */
+gboolean
+p_counted_elem_is_equal(GapStoryElem *stb_elem1, GapStoryElem *stb_elem2)
+{
+  global_compare_count++;
+  return (gap_story_elem_is_equal(stb_elem1, stb_elem2));
+}  /* end p_counted_elem_is_equal */
+
+
+/* the storyboard dialog procedures used by the undo module */
+GapStoryBoard *
+gap_story_dlg_tabw_get_stb_ptr (GapStbTabWidgets *tabw)
+{
+  return (global_stb);
+}
+
+void
+gap_story_dlg_update_edit_settings(GapStoryBoard *stb, GapStbTabWidgets *tabw)
+{
+}
+
+void
+gap_story_dlg_tabw_undo_redo_sensitivity(GapStbTabWidgets *tabw)
+{
+}
+
+
+/* ---------------------------------
+ * p_new_clip
+ * ---------------------------------
+ */
+static GapStoryElem *
+p_new_clip(GRand *rand, gint32 idx)
+{
+  GapStoryElem *stb_elem;
+
+  stb_elem = gap_story_new_elem(GAP_STBREC_VID_MOVIE);
+  stb_elem->orig_filename = g_strdup_printf("/data/video/clip_%06d.mpg", (int)idx);
+  stb_elem->track = 1;
+  stb_elem->from_frame = g_rand_int_range(rand, 1, 1000);
+  stb_elem->to_frame = stb_elem->from_frame + g_rand_int_range(rand, 1, 500);
+  stb_elem->nloop = 1;
+  gap_story_elem_calculate_nframes(stb_elem);
+
+  return (stb_elem);
+}  /* end p_new_clip */
+
+
+/* ---------------------------------
+ * p_generate_storyboard
+ * ---------------------------------
+ * main section with numClips clips, 2 sub sections with numClips / 10 clips
+ */
+static GapStoryBoard *
+p_generate_storyboard(GRand *rand, gint32 numClips)
+{
+  GapStoryBoard   *stb;
+  GapStorySection *section;
+  gint32           ii;
+
+  stb = gap_story_new_story_board("bench_undo.txt");
+  section = gap_story_create_or_find_section_by_name(stb, NULL);
+  for(ii=0; ii < numClips; ii++)
+  {
+    gap_story_list_append_elem_at_section(stb, p_new_clip(rand, ii), section);
+  }
+
+  section = gap_story_create_or_find_section_by_name(stb, "intro");
+  for(ii=0; ii < numClips / 10; ii++)
+  {
+    gap_story_list_append_elem_at_section(stb, p_new_clip(rand, numClips + ii), section);
+  }
+
+  section = gap_story_create_or_find_section_by_name(stb, "outro");
+  for(ii=0; ii < numClips / 10; ii++)
+  {
+    gap_story_list_append_elem_at_section(stb, p_new_clip(rand, 2 * numClips + ii), section);
+  }
+
+  stb->active_section = gap_story_find_main_section(stb);
+  return (stb);
+}  /* end p_generate_storyboard */
+
+
+/* ---------------------------------
+ * p_pick_clip
+ * ---------------------------------
+ * return a random clip of the specified section (NULL if the section is empty)
+ */
+static GapStoryElem *
+p_pick_clip(GRand *rand, GapStorySection *section)
+{
+  GapStoryElem *stb_elem;
+  gint32        count;
+  gint32        idx;
+
+  count = 0;
+  for(stb_elem = section->stb_elem; stb_elem != NULL; stb_elem = stb_elem->next)
+  {
+    count++;
+  }
+  if(count == 0)
+  {
+    return (NULL);
+  }
+  idx = g_rand_int_range(rand, 0, count);
+  for(stb_elem = section->stb_elem; idx > 0; stb_elem = stb_elem->next)
+  {
+    idx--;
+  }
+  return (stb_elem);
+}  /* end p_pick_clip */
+
+
+/* ---------------------------------
+ * p_pick_section
+ * ---------------------------------
+ */
+static GapStorySection *
+p_pick_section(GRand *rand, GapStoryBoard *stb)
+{
+  GapStorySection *section;
+  gint32           idx;
+
+  idx = g_rand_int_range(rand, 0, 3);
+  for(section = stb->stb_section; (section->next != NULL) && (idx > 0); section = section->next)
+  {
+    idx--;
+  }
+  return (section);
+}  /* end p_pick_section */
+
+
+/* ---------------------------------
+ * p_compare_storyboards
+ * ---------------------------------
+ * return TRUE if all sections of both storyboards hold equal clips
+ */
+static gboolean
+p_compare_storyboards(GapStoryBoard *stb1, GapStoryBoard *stb2)
+{
+  GapStorySection *section1;
+
+  for(section1 = stb1->stb_section; section1 != NULL; section1 = section1->next)
+  {
+    GapStorySection *section2;
+    GapStoryElem    *stb_elem1;
+    GapStoryElem    *stb_elem2;
+
+    section2 = gap_story_find_section_by_name(stb2, section1->section_name);
+    if(section2 == NULL)
+    {
+      return (FALSE);
+    }
+
+    stb_elem2 = section2->stb_elem;
+    for(stb_elem1 = section1->stb_elem; stb_elem1 != NULL; stb_elem1 = stb_elem1->next)
+    {
+      if(stb_elem2 == NULL)
+      {
+        return (FALSE);
+      }
+      if(gap_story_elem_is_equal(stb_elem1, stb_elem2) != TRUE)
+      {
+        return (FALSE);
+      }
+      stb_elem2 = stb_elem2->next;
+    }
+    if(stb_elem2 != NULL)
+    {
+      return (FALSE);
+    }
+  }
+  return (TRUE);
+}  /* end p_compare_storyboards */
+
+
+/* ---------------------------------
+ * p_check_top_snapshot
+ * ---------------------------------
+ * the snapshot of a newly pushed undo element must be equal to the storyboard
+ */
+static gboolean
+p_check_top_snapshot(GapStbTabWidgets *tabw, GapStoryUndoElem *old_top)
+{
+  GapStoryBoard *stb_restored;
+  gboolean       isEqual;
+
+  if(tabw->undo_stack_list == old_top)
+  {
+    /* the push was collected into the previous undo element */
+    return (TRUE);
+  }
+  stb_restored = p_restore_snapshot(tabw->undo_stack_list);
+  if(stb_restored == NULL)
+  {
+    return (FALSE);
+  }
+  isEqual = p_compare_storyboards(global_stb, stb_restored);
+  gap_story_free_storyboard(&stb_restored);
+
+  return (isEqual);
+}  /* end p_check_top_snapshot */
+
+
+/* ---------------------------------
+ * p_recount_stack_bytes
+ * ---------------------------------
+ * sum of all undo elements (including file snapshots), all different
+ * undo sections and all different element references of the undo stack.
+ * returns -1 if the byte_size of an undo element is not the expected size.
+ */
+static gint64
+p_recount_stack_bytes(GapStbTabWidgets *tabw)
+{
+  GapStoryUndoElem *undo_elem;
+  GHashTable       *counted;
+  gint64            byte_sum;
+
+  counted = g_hash_table_new(g_direct_hash, g_direct_equal);
+  byte_sum = 0;
+  for(undo_elem = tabw->undo_stack_list; undo_elem != NULL; undo_elem = undo_elem->next)
+  {
+    GapStoryUndoFileSnapshot *snapshots[2];
+    gint64  elem_size;
+    gint32  ii;
+    gint32  jj;
+
+    elem_size = sizeof(GapStoryUndoElem) + sizeof(GapStoryBoard)
+              + (undo_elem->section_count * sizeof(GapStoryUndoSection *));
+    snapshots[0] = undo_elem->fileSnapshotBefore;
+    snapshots[1] = undo_elem->fileSnapshotAfter;
+    for(ii=0; ii < 2; ii++)
+    {
+      if(snapshots[ii] != NULL)
+      {
+        elem_size += sizeof(GapStoryUndoFileSnapshot) + snapshots[ii]->filesize
+                   + strlen(snapshots[ii]->filename) + 1;
+      }
+    }
+    if(elem_size != undo_elem->byte_size)
+    {
+      byte_sum = -1;
+      break;
+    }
+    byte_sum += elem_size;
+
+    for(ii=0; ii < undo_elem->section_count; ii++)
+    {
+      GapStoryUndoSection *usection;
+
+      usection = undo_elem->sections[ii];
+      if(g_hash_table_lookup(counted, usection) != NULL)
+      {
+        continue;
+      }
+      g_hash_table_insert(counted, usection, usection);
+      byte_sum += sizeof(GapStoryUndoSection)
+                + (usection->elem_count * sizeof(GapStoryUndoElemRef *));
+      for(jj=0; jj < usection->elem_count; jj++)
+      {
+        if(g_hash_table_lookup(counted, usection->elem_refs[jj]) == NULL)
+        {
+          g_hash_table_insert(counted, usection->elem_refs[jj], usection->elem_refs[jj]);
+          byte_sum += usection->elem_refs[jj]->byte_size;
+        }
+      }
+    }
+  }
+  g_hash_table_destroy(counted);
+
+  return (byte_sum);
+}  /* end p_recount_stack_bytes */
+
+
+/* ---------------------------------
+ * p_write_xml_file
+ * ---------------------------------
+ */
+static gboolean
+p_write_xml_file(const char *filename, gint32 size, gint32 variant)
+{
+  FILE   *fp;
+  gint32  ii;
+
+  fp = g_fopen(filename, "wb");
+  if(fp == NULL)
+  {
+    return (FALSE);
+  }
+  fprintf(fp, "<?xml version=\"1.0\"?>\n<gimp_gap_mov_params variant=\"%d\">\n", (int)variant);
+  for(ii=0; ftell(fp) < size; ii++)
+  {
+    fprintf(fp, "  <controlpoint px=\"%d\" py=\"%d\" />\n", (int)ii, (int)(ii + variant));
+  }
+  fprintf(fp, "</gimp_gap_mov_params>\n");
+  fclose(fp);
+
+  return (TRUE);
+}  /* end p_write_xml_file */
+
+
+/* ---------------------------------
+ * p_check_budget
+ * ---------------------------------
+ */
+static gboolean
+p_check_budget(GRand *rand)
+{
+  GapStbTabWidgets *tabw;
+  GapStoryUndoElem *undo_elem;
+  GapStoryElem     *stb_elem;
+  char             *xml_filename;
+  gint32            ii;
+  gint32            stackCount;
+  gboolean          ok;
+
+  global_stb = p_generate_storyboard(rand, 50);
+  tabw = g_new0(GapStbTabWidgets, 1);
+  tabw->undo_stack_max_mb = 1;
+
+  xml_filename = g_strdup("bench_undo_movepath.xml");
+  ok = TRUE;
+  stb_elem = global_stb->active_section->stb_elem;
+  for(ii=0; (ii < 20) && (ok); ii++)
+  {
+    gint64 recount;
+
+    /* a different clip for each push (repeated pushes on the same clip are collected) */
+    if(stb_elem->next == NULL)
+    {
+      stb_elem = global_stb->active_section->stb_elem;
+    }
+    stb_elem = stb_elem->next;
+
+    /* 200 KB movepath xml file, changed by each step */
+    p_write_xml_file(xml_filename, 200000, ii);
+    gap_stb_undo_push_clip_with_file_snapshot(tabw
+          , GAP_STB_FEATURE_PROPERTIES_TRANSITION
+          , stb_elem->story_id
+          , &xml_filename
+          );
+    stb_elem->from_frame++;
+
+    recount = p_recount_stack_bytes(tabw);
+    if(recount != tabw->undo_stack_bytes)
+    {
+      printf("budget: push %d undo_stack_bytes:%.0f recounted:%.0f\n"
+        , (int)ii, (double)tabw->undo_stack_bytes, (double)recount);
+      ok = FALSE;
+    }
+    if((tabw->undo_stack_bytes > (1024 * 1024)) && (tabw->undo_stack_list->next != NULL))
+    {
+      printf("budget: push %d undo_stack_bytes:%.0f exceeds the limit\n"
+        , (int)ii, (double)tabw->undo_stack_bytes);
+      ok = FALSE;
+    }
+  }
+
+  stackCount = 0;
+  for(undo_elem = tabw->undo_stack_list; undo_elem != NULL; undo_elem = undo_elem->next)
+  {
+    stackCount++;
+  }
+  if(stackCount >= 20)
+  {
+    printf("budget: the undo stack was not trimmed (%d elements)\n", (int)stackCount);
+    ok = FALSE;
+  }
+
+  gap_stb_undo_destroy_undo_stack(tabw);
+  if(tabw->undo_stack_bytes != 0)
+  {
+    printf("budget: undo_stack_bytes:%.0f after destroy\n", (double)tabw->undo_stack_bytes);
+    ok = FALSE;
+  }
+
+  printf("budget: %d of 20 undo elements kept within 1 MB: %s\n"
+    , (int)stackCount, ok ? "OK" : "FAILED");
+
+  g_remove(xml_filename);
+  g_free(xml_filename);
+  g_free(tabw);
+  gap_story_free_storyboard(&global_stb);
+
+  return (ok);
+}  /* end p_check_budget */
+
+
+/* ---------------------------------
+ * p_check_snapshots
+ * ---------------------------------
+ */
+static gboolean
+p_check_snapshots(GRand *rand, gint32 numClips, gint32 numSteps)
+{
+  GapStbTabWidgets *tabw;
+  gint32            ii;
+  gint32            newClipIdx;
+  gint32            pushCount;
+  gboolean          ok;
+
+  global_stb = p_generate_storyboard(rand, numClips);
+  tabw = g_new0(GapStbTabWidgets, 1);
+  tabw->undo_stack_max_mb = 0;
+
+  ok = TRUE;
+  pushCount = 0;
+  newClipIdx = 3 * numClips;
+  global_compare_count = 0;
+  for(ii=0; (ii < numSteps) && (ok); ii++)
+  {
+    GapStoryUndoElem *old_top;
+    GapStorySection  *section;
+    GapStoryElem     *stb_elem;
+    GapStoryElem     *stb_elem2;
+    GapStoryBoard    *stb_restored;
+    gint32            op;
+
+    old_top = tabw->undo_stack_list;
+    section = p_pick_section(rand, global_stb);
+    stb_elem = p_pick_clip(rand, section);
+    stb_restored = NULL;
+    op = g_rand_int_range(rand, 0, 10);
+    switch(op)
+    {
+      case 0: case 1: case 2: case 3:
+        if(stb_elem == NULL)
+        {
+          break;
+        }
+        gap_stb_undo_push_clip(tabw, GAP_STB_FEATURE_PROPERTIES_CLIP, stb_elem->story_id);
+        ok = p_check_top_snapshot(tabw, old_top);
+        stb_elem->from_frame++;
+        pushCount++;
+        break;
+      case 4:
+        global_stb->active_section = section;
+        gap_stb_undo_push_section(tabw, GAP_STB_FEATURE_CREATE_CLIP, global_stb->active_section);
+        ok = p_check_top_snapshot(tabw, old_top);
+        gap_story_list_append_elem(global_stb, p_new_clip(rand, newClipIdx++));
+        pushCount++;
+        break;
+      case 5:
+        if(stb_elem == NULL)
+        {
+          break;
+        }
+        gap_stb_undo_push(tabw, GAP_STB_FEATURE_EDIT_CUT);
+        ok = p_check_top_snapshot(tabw, old_top);
+        stb_elem->selected = TRUE;
+        gap_story_remove_sel_elems(global_stb);
+        pushCount++;
+        break;
+      case 6:
+        /* a mask rename changes the references in other clips too */
+        stb_elem2 = p_pick_clip(rand, p_pick_section(rand, global_stb));
+        if((stb_elem == NULL) || (stb_elem2 == NULL))
+        {
+          break;
+        }
+        gap_stb_undo_push_clip(tabw, GAP_STB_FEATURE_PROPERTIES_CLIP, stb_elem->story_id);
+        ok = p_check_top_snapshot(tabw, old_top);
+        gap_stb_undo_mark_all_dirty(tabw);
+        stb_elem->to_frame++;
+        stb_elem2->to_frame++;
+        pushCount++;
+        break;
+      case 7:
+        /* clip creation and its properties in one undo group,
+         * (with a property change on a clip in a random section)
+         */
+        stb_elem = p_pick_clip(rand, p_pick_section(rand, global_stb));
+        global_stb->active_section = section;
+        gap_stb_undo_group_begin(tabw);
+        gap_stb_undo_push_section(tabw, GAP_STB_FEATURE_CREATE_CLIP, global_stb->active_section);
+        ok = p_check_top_snapshot(tabw, old_top);
+        stb_elem2 = p_new_clip(rand, newClipIdx++);
+        gap_story_list_append_elem(global_stb, stb_elem2);
+        gap_stb_undo_push_clip(tabw, GAP_STB_FEATURE_PROPERTIES_CLIP, stb_elem2->story_id);
+        stb_elem2->from_frame++;
+        if(stb_elem != NULL)
+        {
+          gap_stb_undo_push_clip(tabw, GAP_STB_FEATURE_PROPERTIES_CLIP, stb_elem->story_id);
+          stb_elem->from_frame++;
+        }
+        gap_stb_undo_group_end(tabw);
+        pushCount++;
+        break;
+      case 8:
+        stb_restored = gap_stb_undo_pop(tabw);
+        break;
+      case 9:
+        stb_restored = gap_stb_undo_redo(tabw);
+        break;
+    }
+
+    if(stb_restored != NULL)
+    {
+      gap_story_free_storyboard(&global_stb);
+      global_stb = stb_restored;
+      global_stb->active_section = gap_story_find_main_section(global_stb);
+    }
+    if(ok != TRUE)
+    {
+      printf("snapshots: step %d (op %d) the undo snapshot differs from the storyboard\n"
+        , (int)ii, (int)op);
+    }
+  }
+
+  printf("snapshots: %d steps, %d pushes on %d clips, %.1f compares per push: %s\n"
+    , (int)numSteps
+    , (int)pushCount
+    , (int)numClips
+    , (double)global_compare_count / (double)MAX(1, pushCount)
+    , ok ? "OK" : "FAILED"
+    );
+
+  gap_stb_undo_destroy_undo_stack(tabw);
+  if(tabw->undo_stack_bytes != 0)
+  {
+    printf("snapshots: undo_stack_bytes:%.0f after destroy\n", (double)tabw->undo_stack_bytes);
+    ok = FALSE;
+  }
+  g_free(tabw);
+  gap_story_free_storyboard(&global_stb);
+
+  return (ok);
+}  /* end p_check_snapshots */
+
+
+/* ---------------------------------
+ * p_run_property_pushes
+ * ---------------------------------
+ * push property changes on numPushes different clips.
+ * markAll TRUE marks all clips dirty after each push
+ * (the undo stack compares all clips as without dirty marks).
+ * returns the number of compared clips.
+ */
+static gint32
+p_run_property_pushes(GRand *rand, gint32 numClips, gint32 numPushes
+  , gboolean markAll, gdouble *elapsedMs)
+{
+  GapStbTabWidgets *tabw;
+  GapStoryElem     *stb_elem;
+  GTimer           *timer;
+  gint32            ii;
+  gint32            compareCount;
+
+  global_stb = p_generate_storyboard(rand, numClips);
+  tabw = g_new0(GapStbTabWidgets, 1);
+  tabw->undo_stack_max_mb = 0;
+
+  /* the initial push records all clips, the 1st property push
+   * compares all clips (the master properties mark all clips dirty)
+   */
+  gap_stb_undo_push(tabw, GAP_STB_FEATURE_PROPERTIES_MASTER);
+  stb_elem = global_stb->active_section->stb_elem;
+  gap_stb_undo_push_clip(tabw, GAP_STB_FEATURE_PROPERTIES_CLIP, stb_elem->story_id);
+  stb_elem->from_frame++;
+  stb_elem = stb_elem->next;
+
+  global_compare_count = 0;
+  timer = g_timer_new();
+  for(ii=0; ii < numPushes; ii++)
+  {
+    gap_stb_undo_push_clip(tabw, GAP_STB_FEATURE_PROPERTIES_CLIP, stb_elem->story_id);
+    if(markAll)
+    {
+      gap_stb_undo_mark_all_dirty(tabw);
+    }
+    stb_elem->from_frame++;
+    stb_elem = stb_elem->next;
+    if(stb_elem == NULL)
+    {
+      stb_elem = global_stb->active_section->stb_elem;
+    }
+  }
+  *elapsedMs = g_timer_elapsed(timer, NULL) * 1000.0;
+  g_timer_destroy(timer);
+  compareCount = global_compare_count;
+
+  gap_stb_undo_destroy_undo_stack(tabw);
+  g_free(tabw);
+  gap_story_free_storyboard(&global_stb);
+
+  return (compareCount);
+}  /* end p_run_property_pushes */
+
+
+/* ---------------------------------
+ * main
+ * ---------------------------------
+ */
+int
+main(int argc, char **argv)
+{
+  GRand   *rand;
+  gint32   numClips;
+  gint32   numPushes;
+  gint32   compareCount;
+  gdouble  elapsedMs;
+  gboolean benchmark;
+  gboolean ok;
+
+  benchmark = FALSE;
+  numClips = 300;
+  numPushes = 50;
+  if(argc > 1)
+  {
+    if(strcmp(argv[1], "-b") == 0)
+    {
+      benchmark = TRUE;
+      numClips = 5000;
+      numPushes = BENCH_PUSHES;
+      if(argc > 2)
+      {
+        numClips = MAX(10, atol(argv[2]));
+      }
+    }
+  }
+
+  rand = g_rand_new_with_seed(4711);
+
+  ok = p_check_budget(rand);
+  if(p_check_snapshots(rand, numClips, 400) != TRUE)
+  {
+    ok = FALSE;
+  }
+
+  compareCount = p_run_property_pushes(rand, numClips, numPushes, FALSE, &elapsedMs);
+  printf("dirty marks: %d property pushes, %d compared clips\n"
+    , (int)numPushes, (int)compareCount);
+  if(compareCount > numPushes)
+  {
+    printf("dirty marks: FAILED (more than one compared clip per push)\n");
+    ok = FALSE;
+  }
+
+  if(benchmark)
+  {
+    gdouble elapsedAllMs;
+    gint32  compareAllCount;
+
+    compareAllCount = p_run_property_pushes(rand, numClips, numPushes, TRUE, &elapsedAllMs);
+    printf("benchmark: %d property pushes on %d clips\n", (int)numPushes, (int)numClips);
+    printf("  all clips dirty:   %9.2f ms  (%d compared clips)\n"
+      , elapsedAllMs, (int)compareAllCount);
+    printf("  marked clip dirty: %9.2f ms  (%d compared clips)\n"
+      , elapsedMs, (int)compareCount);
+  }
+
+  g_rand_free(rand);
+
+  if(ok)
+  {
+    return (0);
+  }
+  return (1);
+}  /* end main */
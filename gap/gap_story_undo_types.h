@@ -22,6 +22,10 @@
 
 /* revision history:
  * version 1.3.25a; 2007/10/18  hof: created
+ * version 2.7.0;   2026/10/18  undo elements share unchanged clips and sections
+ *                              with the previous undo element.
+ * version 2.7.0;   2026/10/18  undo elements record the clip or section that is changed
+ *                              by the feature (dirty_story_id, dirty_section_name)
  */
 
 #ifndef _GAP_STORY_UNDO_TYPES_H
@@ -65,6 +69,31 @@ typedef struct GapStoryUndoFileSnapshot {
 
 
 
+/* storyboard undo clip reference
+ * holds a private copy of one storyboard element.
+ * the same reference is shared by all undo elements where
+ * this storyboard element was recorded unchanged.
+ */
+typedef struct GapStoryUndoElemRef {
+  GapStoryElem        *stb_elem;
+  gint32               ref_count;
+  gint32               byte_size;   /* estimated memory usage */
+}  GapStoryUndoElemRef;
+
+
+/* storyboard undo section
+ * holds the ordered list of element references of one section.
+ * the whole undo section is shared with the previous undo element
+ * if the section was not changed in between.
+ */
+typedef struct GapStoryUndoSection {
+  gchar                *section_name;  /* null refers to the main section */
+  gint32                elem_count;
+  GapStoryUndoElemRef **elem_refs;
+  gint32                ref_count;
+}  GapStoryUndoSection;
+
+
 /* storyboard undo element
  */
 typedef struct GapStoryUndoElem {
@@ -72,7 +101,24 @@ typedef struct GapStoryUndoElem {
   gint32 clip_story_id;            /* -1 if feature modifies more than 1 clip */
   GapStoryBoard       *stb;        /* storyboard backup before
                                     * feature with feature_id was applied
+                                    * (master data, edit settings and empty sections only,
+                                    * the elements are kept in the sections array)
                                     */
+  GapStoryUndoSection **sections;
+  gint32                section_count;
+  gint32                byte_size;  /* estimated memory usage without element references
+                                     * (including the file snapshots)
+                                     */
+
+  /* the part of the storyboard that is changed by the feature with feature_id
+   * (as announced by the caller of the push procedure).
+   * The next snapshot compares only the dirty clips with the recorded clips,
+   * all other clips are shared without comparing their attributes.
+   */
+  gint32                dirty_story_id;      /* >= 0: only the clip with this story_id is changed */
+  gboolean              dirty_section_only;  /* TRUE: only clips of dirty_section_name are changed */
+  gchar                *dirty_section_name;  /* NULL refers to the main section */
+
   GapStoryUndoFileSnapshot  *fileSnapshotBefore;
   GapStoryUndoFileSnapshot  *fileSnapshotAfter;
   char                     **filenamePtr;
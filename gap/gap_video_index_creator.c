@@ -23,6 +23,8 @@
  */
 
 /* Revision history
+ *  (2026/10/18)  v2.7.0     hof: index up to video-index-creator-parallel-files videos
+ *                                 at the same time (one worker thread per videofile)
  *  (2007/04/02)  v1.0       hof: created
  */
 
@@ -69,6 +71,10 @@ int gap_debug = 0;  /* 1 == print debug infos , 0 dont print debug infos */
 #define PROCESSING_STATUS_STRING "@@@PROCESSING"
 #define DEFAULT_SMART_PERCENTAGE 15.0
 
+#define GAP_GIMPRC_VINDEX_PARALLEL_FILES  "video-index-creator-parallel-files"
+#define GAP_VINDEX_MAX_PARALLEL_FILES     16
+#define GAP_VINDEX_POLL_USLEEP            100000
+
 typedef struct {
   gint32  seltrack;
   gchar   videofile[4000];
@@ -86,15 +92,11 @@ typedef struct GapVideoIndexCreatorProgressParams {  /* nickname vipp */
 
   GtkWidget    *progress_bar_master;
   GtkWidget    *progress_bar_sub;
-  gboolean      cancel_video_api;
   gboolean      cancel_immedeiate_request;
-  gboolean      cancel_enabled_smart;
   gboolean      processing_finished;
   VindexValues *val_ptr;
-  GapStoryVideoFileRef  *vref;
   GapStoryVideoFileRef  *vref_list;
   gint32        timertag;
-  t_GVA_Handle  *gvahand;
   GTimeVal      startTime;
   GTimeVal      endTime;
   
@@ -102,11 +104,33 @@ typedef struct GapVideoIndexCreatorProgressParams {  /* nickname vipp */
   gint32        numberOfValidVideos;
   gint32        countVideos;
 
-  gdouble       breakPercentage;
-  gint32        breakFrames;
+  gint32        maxParallelFiles;   /* gimprc video-index-creator-parallel-files */
   
 } GapVideoIndexCreatorProgressParams;
 
+
+typedef struct GapVideoIndexCreatorJob {  /* nickname vjob */
+  GapVideoIndexCreatorProgressParams *vipp;
+  GapStoryVideoFileRef  *vref;
+  t_GVA_Handle  *gvahand;
+  GThread       *thread;           /* NULL when the job runs in the main thread */
+  gboolean       isThreaded;       /* TRUE: the job must not access gtk widgets */
+
+  gboolean       cancel_video_api;
+  gboolean       cancel_enabled_smart;
+  gdouble        breakPercentage;
+  gint32         breakFrames;
+
+  /* the following members are written by the job and read by the main thread
+   * (access is protected by the vjobMutex)
+   */
+  gdouble        progress;
+  gchar         *result_userdata;  /* processing result for vref->userdata */
+  gboolean       isFinished;
+} GapVideoIndexCreatorJob;
+
+static GStaticMutex vjobMutex = G_STATIC_MUTEX_INIT;
+
 static VindexValues glob_vindex_vals =
 {
     1               /* seltrack */
@@ -127,9 +151,15 @@ static void  run (const gchar *name,          /* name of plugin */
 static void      p_do_processing (GapVideoIndexCreatorProgressParams *vipp);
 static gboolean  p_check_videofile(const char *filename, gint32 seltrack
                                      , const char *preferred_decoder);
-static void      p_create_video_index(const char *filename, gint32 seltrack
-                                     , const char *preferred_decoder
-                                     , GapVideoIndexCreatorProgressParams *vipp);
+static void      p_create_video_index(GapVideoIndexCreatorJob *vjob);
+static gpointer  p_job_thread_function(GapVideoIndexCreatorJob *vjob);
+static void      p_set_job_result(GapVideoIndexCreatorJob *vjob, const char *userdata);
+static gchar *   p_progress_message(GapVideoIndexCreatorJob *vjob, gdouble progress);
+static GapVideoIndexCreatorJob * p_start_job(GapVideoIndexCreatorProgressParams *vipp
+                                     , GapStoryVideoFileRef  *vref, gboolean isThreaded);
+static void      p_finish_job(GapVideoIndexCreatorJob *vjob);
+static void      p_process_all_jobs(GapVideoIndexCreatorProgressParams *vipp
+                                     , GapStoryVideoFileRef  *vref_list);
 static void      p_set_vref_userdata(GapStoryVideoFileRef  *vref, const char *userdata);
 static void      p_set_userdata_processingstatus_check_videofile(GapStoryVideoFileRef  *vref
                                      , GapVideoIndexCreatorProgressParams *vipp);
@@ -319,16 +349,18 @@ run (const gchar *name,          /* name of plugin */
     GapVideoIndexCreatorProgressParams *vipp;
     
     vipp = &vip_struct;
-    vipp->vref = NULL;
     vipp->vref_list = NULL;
     vipp->shell_window = NULL;
-    vipp->gvahand = NULL;
     vipp->tv = NULL;
     vipp->progress_bar_master = NULL;
     vipp->progress_bar_sub = NULL;
-    vipp->cancel_video_api = FALSE;
     vipp->timertag = -1;
     vipp->cancel_immedeiate_request = FALSE;
+    vipp->maxParallelFiles = gap_base_get_gimprc_int_value(GAP_GIMPRC_VINDEX_PARALLEL_FILES
+                                , gap_base_get_numProcessors()   /* default */
+                                , 1                              /* min */
+                                , GAP_VINDEX_MAX_PARALLEL_FILES  /* max */
+                                );
 
     vipp->val_ptr = &glob_vindex_vals;
     
@@ -432,47 +464,62 @@ p_is_valid_vindex_available(t_GVA_Handle  *gvahand)
   return (l_have_valid_vindex);
 }
 
+/* --------------------------------
+ * p_set_job_result
+ * --------------------------------
+ * set the processing result of the job.
+ * (it is copied to vref->userdata by the main thread
+ * when the job has finished)
+ */
+static void
+p_set_job_result(GapVideoIndexCreatorJob *vjob, const char *userdata)
+{
+  g_static_mutex_lock(&vjobMutex);
+  if(vjob->result_userdata != NULL)
+  {
+    g_free(vjob->result_userdata);
+  }
+  vjob->result_userdata = g_strdup(userdata);
+  g_static_mutex_unlock(&vjobMutex);
+
+}  /* end p_set_job_result */
+
+
 /* --------------------------------
  * p_create_video_index
  * --------------------------------
- * check if specified filename is a videofile and if there is
- * a valid video index available for that videofile.
+ * check if there is a valid video index available for the
+ * videofile of the job (that was already opened as vjob->gvahand).
  * In case there is no valid video index, this procedure
  * will create the video index.
  *
- * return FALSE if specified video filename could not be opened as videofile.
- *
+ * this procedure runs in a worker thread
+ * in case more than one videofile is processed in parallel.
+ * (the videohandle is opened and closed by the main thread)
  */
 static void
-p_create_video_index(const char *filename, gint32 seltrack
-  , const char *preferred_decoder,GapVideoIndexCreatorProgressParams *vipp)
+p_create_video_index(GapVideoIndexCreatorJob *vjob)
 {
+  GapVideoIndexCreatorProgressParams *vipp;
   char *vindex_file;
+  const char *filename;
   gboolean    l_have_valid_vindex;
   t_GVA_Handle  *gvahand;
 
-  vipp->cancel_enabled_smart = FALSE;
+  vipp = vjob->vipp;
+  gvahand = vjob->gvahand;
+  filename = vjob->vref->videofile;
+  vjob->cancel_enabled_smart = FALSE;
 
   vindex_file = NULL;
   l_have_valid_vindex = FALSE;
 
-  gvahand =  GVA_open_read_pref(filename
-                                  , seltrack
-                                  , 1 /* aud_track */
-                                  , preferred_decoder
-                                  , FALSE  /* use MMX if available (disable_mmx == FALSE) */
-                                  );
-
-
-
   if(gvahand)
   {
-    vipp->gvahand = gvahand;
-    
     /* gvahand->emulate_seek = TRUE; */
     gvahand->do_gimp_progress = FALSE;
 
-    gvahand->progress_cb_user_data = vipp;
+    gvahand->progress_cb_user_data = vjob;
     gvahand->fptr_progress_callback = p_vid_progress_callback;
     
     if ((vipp->val_ptr->mode == QICK_MODE)
@@ -491,13 +538,10 @@ p_create_video_index(const char *filename, gint32 seltrack
         }
         if (vipp->val_ptr->mode == QICK_MODE)
         {
-          vipp->gvahand = NULL;
-          GVA_close(gvahand);
-          p_set_vref_userdata(vipp->vref, _("NO vindex created (QUICK)"));
-
+          p_set_job_result(vjob, _("NO vindex created (QUICK)"));
           return;
         }
-        vipp->cancel_enabled_smart = TRUE;
+        vjob->cancel_enabled_smart = TRUE;
       }
     }
     
@@ -509,7 +553,7 @@ p_create_video_index(const char *filename, gint32 seltrack
       if(dec_elem->decoder_name)
       {
         vindex_file = GVA_build_videoindex_filename(filename
-                                             ,seltrack  /* track */
+                                             ,vjob->vref->seltrack  /* track */
                                              ,dec_elem->decoder_name
                                              );
       }
@@ -524,7 +568,7 @@ p_create_video_index(const char *filename, gint32 seltrack
 
     if (l_have_valid_vindex)
     {
-      p_set_vref_userdata(vipp->vref, _("vindex already OK"));
+      p_set_job_result(vjob, _("vindex already OK"));
       if(gap_debug)
       {
         printf("VALID VIDEO INDEX found for video:%s\n  (index:%s)\n"
@@ -546,10 +590,10 @@ p_create_video_index(const char *filename, gint32 seltrack
       gvahand->create_vindex = TRUE;
       GVA_count_frames(gvahand);      /* here we CRREATE the vindex */
 
-      if ((vipp->cancel_video_api != TRUE)
+      if ((vjob->cancel_video_api != TRUE)
       && (TRUE == p_is_valid_vindex_available(gvahand)))
       {
-        p_set_vref_userdata(vipp->vref, _("vindex created (FULLSCAN OK)"));
+        p_set_job_result(vjob, _("vindex created (FULLSCAN OK)"));
       }
       else
       {
@@ -566,8 +610,8 @@ p_create_video_index(const char *filename, gint32 seltrack
           }
 
           usrdata = g_strdup_printf(_("NO vindex created (SMART %.1f%% %d frames)")
-                                   ,(float)vipp->breakPercentage
-                                   ,(int)vipp->breakFrames
+                                   ,(float)vjob->breakPercentage
+                                   ,(int)vjob->breakFrames
                                    );
         }
         else
@@ -576,7 +620,7 @@ p_create_video_index(const char *filename, gint32 seltrack
                                    ,(int)gvahand->frame_counter
                                    );
         }
-        p_set_vref_userdata(vipp->vref, usrdata);
+        p_set_job_result(vjob, usrdata);
         g_free(usrdata);
       }
     }
@@ -586,13 +630,130 @@ p_create_video_index(const char *filename, gint32 seltrack
     {
       g_free(vindex_file);
     }
+  }
 
-    vipp->gvahand = NULL;
-    GVA_close(gvahand);
+}  /* end p_create_video_index */
+
+
+/* --------------------------------
+ * p_job_thread_function
+ * --------------------------------
+ */
+static gpointer
+p_job_thread_function(GapVideoIndexCreatorJob *vjob)
+{
+  if(vjob->gvahand != NULL)
+  {
+    p_create_video_index(vjob);
   }
 
+  g_static_mutex_lock(&vjobMutex);
+  vjob->isFinished = TRUE;
+  g_static_mutex_unlock(&vjobMutex);
 
-}  /* end p_create_video_index */
+  return (NULL);
+
+}  /* end p_job_thread_function */
+
+
+/* --------------------------------
+ * p_start_job
+ * --------------------------------
+ * open the videofile of the vref element and start the video index
+ * processing for this videofile.
+ * in case isThreaded is TRUE the processing runs as worker thread
+ * and this procedure returns immediate.
+ * otherwise the processing is done in the main thread before return.
+ *
+ * Note: the videohandle is opened (and later closed in p_finish_job)
+ * in the main thread because opening the decoder is not thread safe
+ * for all decoders.
+ */
+static GapVideoIndexCreatorJob *
+p_start_job(GapVideoIndexCreatorProgressParams *vipp
+  , GapStoryVideoFileRef  *vref, gboolean isThreaded)
+{
+  GapVideoIndexCreatorJob *vjob;
+
+  vjob = g_new0(GapVideoIndexCreatorJob, 1);
+  vjob->vipp = vipp;
+  vjob->vref = vref;
+  vjob->thread = NULL;
+  vjob->isThreaded = isThreaded;
+  vjob->cancel_video_api = FALSE;
+  vjob->progress = 0.0;
+  vjob->result_userdata = NULL;
+  vjob->isFinished = FALSE;
+
+  vjob->gvahand =  GVA_open_read_pref(vref->videofile
+                                  , vref->seltrack
+                                  , 1 /* aud_track */
+                                  , vref->preferred_decoder
+                                  , FALSE  /* use MMX if available (disable_mmx == FALSE) */
+                                  );
+
+  if((vjob->isThreaded) && (vjob->gvahand != NULL))
+  {
+    GError *error = NULL;
+
+    vjob->thread = g_thread_create((GThreadFunc)p_job_thread_function
+                                  , vjob
+                                  , TRUE    /* joinable */
+                                  , &error
+                                  );
+    if(vjob->thread != NULL)
+    {
+      return (vjob);
+    }
+
+    printf("** ERROR could not create worker thread for %s (%s)\n"
+          , vref->videofile
+          , (error != NULL) ? error->message : ""
+          );
+    if(error != NULL)
+    {
+      g_error_free(error);
+    }
+    vjob->isThreaded = FALSE;
+  }
+
+  /* process the videofile in the main thread */
+  p_job_thread_function(vjob);
+
+  return (vjob);
+
+}  /* end p_start_job */
+
+
+/* --------------------------------
+ * p_finish_job
+ * --------------------------------
+ * wait until the job has finished (join the worker thread),
+ * copy the processing result to vref->userdata,
+ * close the videohandle and free the job.
+ */
+static void
+p_finish_job(GapVideoIndexCreatorJob *vjob)
+{
+  if(vjob->thread != NULL)
+  {
+    g_thread_join(vjob->thread);
+    vjob->thread = NULL;
+  }
+
+  if(vjob->result_userdata != NULL)
+  {
+    p_set_vref_userdata(vjob->vref, vjob->result_userdata);
+    g_free(vjob->result_userdata);
+  }
+
+  if(vjob->gvahand != NULL)
+  {
+    GVA_close(vjob->gvahand);
+  }
+  g_free(vjob);
+
+}  /* end p_finish_job */
 
 /* -----------------------------------------------
  * p_set_vref_userdata
@@ -721,7 +882,6 @@ p_make_all_video_index(const char *filename, gint32 seltrack
   FILE     *l_fp;
   char      l_buf[BUF_SIZE];
   gboolean  l_file_is_videofile;
-  gint      l_video_count;
   
   GapStoryVideoFileRef  *vref_list;
   GapStoryVideoFileRef  *vref;
@@ -809,94 +969,238 @@ p_make_all_video_index(const char *filename, gint32 seltrack
   }
   
   vipp->vref_list = vref_list;
+  if (vipp->numberOfVideos > 0)
+  {
+    p_process_all_jobs(vipp, vref_list);
+  }
+  
+}  /* end p_make_all_video_index */
+
+
+/* --------------------------------
+ * p_update_master_progress
+ * --------------------------------
+ */
+static void
+p_update_master_progress(GapVideoIndexCreatorProgressParams *vipp
+  , GapStoryVideoFileRef  *vref, gdouble fraction, gint32 video_count)
+{
+  gchar  *message;
+  gchar  *suffix;
+  char timeString[20];
+
+  if(vipp->progress_bar_master == NULL)
+  {
+    return;
+  }
+
+  gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(vipp->progress_bar_master)
+                                , CLAMP(fraction, 0.0, 1.0)
+                                );
+  if(vref == NULL)
+  {
+    return;
+  }
+
+  g_get_current_time(&vipp->endTime);
+  p_elapsedTimeToString (vipp, &timeString[0], sizeof(timeString));
+
+  suffix = g_strdup_printf(_("  %s (%d of %d)")
+     ,timeString
+     ,(int)video_count
+     ,(int)vipp->numberOfVideos
+     );
+
+  message = gap_base_shorten_filename(NULL   /* prefix */
+                    ,vref->videofile        /* filenamepart */
+                    ,suffix                 /* suffix */
+                    ,90                     /* l_max_chars */
+                    );
+
+  gtk_progress_bar_set_text(GTK_PROGRESS_BAR(vipp->progress_bar_master), message);
+  g_free(suffix);
+  g_free(message);
+
+}  /* end p_update_master_progress */
+
+
+/* --------------------------------
+ * p_process_all_jobs
+ * --------------------------------
+ * create video indexes for all elements of the vref_list
+ * that are videofiles (e.g. have userdata != NULL).
+ * Up to vipp->maxParallelFiles videofiles are processed at the same time,
+ * each one in its own worker thread.
+ * The main thread opens and closes the videohandles,
+ * and shows the progress of the running jobs (per videofile in the list widget).
+ * With maxParallelFiles 1 (or without thread support) the videofiles
+ * are processed one after the other in the main thread.
+ */
+static void
+p_process_all_jobs(GapVideoIndexCreatorProgressParams *vipp
+  , GapStoryVideoFileRef  *vref_list)
+{
+  GapVideoIndexCreatorJob *jobs[GAP_VINDEX_MAX_PARALLEL_FILES];
+  GapStoryVideoFileRef  *vref;
+  GapStoryVideoFileRef  *vref_next;
+  gboolean isThreaded;
+  gint     maxJobs;
+  gint     numJobs;
+  gint     ii;
+  gint32   l_video_count;
+  gint32   l_done_count;
+
+  maxJobs = CLAMP(vipp->maxParallelFiles, 1, GAP_VINDEX_MAX_PARALLEL_FILES);
+  isThreaded = FALSE;
+  if(maxJobs > 1)
+  {
+    isThreaded = gap_base_thread_init();
+  }
+  if(!isThreaded)
+  {
+    maxJobs = 1;
+  }
+
+  if(gap_debug)
+  {
+    printf("p_process_all_jobs: maxJobs:%d isThreaded:%d\n"
+      , (int)maxJobs
+      , (int)isThreaded
+      );
+  }
+
+  numJobs = 0;
   l_video_count = 0;
-  for(vref = vref_list; (vref != NULL && vipp->numberOfVideos > 0); vref = vref->next)
+  l_done_count = 0;
+  vref_next = vref_list;
+
+  while(TRUE)
   {
-    vipp->cancel_video_api = FALSE;
-    vipp->vref = vref;
-    
-    
-    if(gap_debug)
-    {
-      printf("vref->videofile: %s\n  seltrack:%d preferred_decoder:%s"
-             , vref->videofile
-             , (int)vref->seltrack
-             , vref->preferred_decoder
-             );
-    }
+    gboolean l_tree_changed;
+    gdouble  l_running_progress;
 
+    l_tree_changed = FALSE;
 
-    if(vipp->progress_bar_master)
+    /* start jobs for the next videofiles */
+    while((numJobs < maxJobs)
+    && (vref_next != NULL)
+    && (vipp->cancel_immedeiate_request != TRUE))
     {
-      gchar  *message;
-      gchar  *suffix;
-      char timeString[20];
-
-      gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(vipp->progress_bar_master)
-                                    , CLAMP(((gdouble)l_video_count / (gdouble)vipp->numberOfVideos), 0.0, 1.0)
-                                    );
-      g_get_current_time(&vipp->endTime);
-      p_elapsedTimeToString (vipp, &timeString[0], sizeof(timeString));
-      
+      vref = vref_next;
+      vref_next = vref->next;
       l_video_count++;
-      
-      suffix = g_strdup_printf(_("  %s (%d of %d)")
-         ,timeString
-         ,(int)l_video_count
-         ,(int)vipp->numberOfVideos
-         );
 
-      message = gap_base_shorten_filename(NULL   /* prefix */
-                        ,vref->videofile        /* filenamepart */
-                        ,suffix                 /* suffix */
-                        ,90                     /* l_max_chars */
-                        );
+      if(gap_debug)
+      {
+        printf("vref->videofile: %s\n  seltrack:%d preferred_decoder:%s"
+               , vref->videofile
+               , (int)vref->seltrack
+               , vref->preferred_decoder
+               );
+      }
 
-      
-      gtk_progress_bar_set_text(GTK_PROGRESS_BAR(vipp->progress_bar_master), message);
-      g_free(suffix);
-      g_free(message);
+      p_update_master_progress(vipp, vref
+                              , (gdouble)l_done_count / (gdouble)vipp->numberOfVideos
+                              , l_video_count
+                              );
 
-    }
+      if(vref->userdata == NULL)
+      {
+        /* not a videofile */
+        l_done_count++;
+        continue;
+      }
 
-    if(vref->userdata != NULL)
-    {
       p_set_vref_userdata(vref, PROCESSING_STATUS_STRING);
       if (vipp->tv != NULL)
       {
         p_tree_fill (vipp, vref_list);
       }
-      p_create_video_index(vref->videofile, vref->seltrack, vref->preferred_decoder, vipp);
-      if (vipp->tv != NULL)
+      jobs[numJobs] = p_start_job(vipp, vref, isThreaded);
+      numJobs++;
+    }
+
+    if (numJobs == 0)
+    {
+      break;
+    }
+
+    /* collect finished jobs and the progress of the running jobs */
+    l_running_progress = 0.0;
+    for(ii = numJobs -1; ii >= 0; ii--)
+    {
+      GapVideoIndexCreatorJob *vjob;
+      gboolean isFinished;
+      gdouble  progress;
+
+      vjob = jobs[ii];
+      g_static_mutex_lock(&vjobMutex);
+      isFinished = vjob->isFinished;
+      progress = vjob->progress;
+      g_static_mutex_unlock(&vjobMutex);
+
+      if(isFinished)
       {
-        p_tree_fill (vipp, vref_list);
+        p_finish_job(vjob);
+        numJobs--;
+        jobs[ii] = jobs[numJobs];
+        l_done_count++;
+        l_tree_changed = TRUE;
       }
-      if (vipp->cancel_immedeiate_request == TRUE)
+      else
       {
-        if(gap_debug)
-        {
-          printf("CANCEL_IMMEDEIATE_REQUEST  vref->videofile: %s\n  seltrack:%d preferred_decoder:%s  userdata:%s"
-                 , vref->videofile
-                 , (int)vref->seltrack
-                 , vref->preferred_decoder
-                 , vref->userdata
-                 );
-        }
-        vipp->processing_finished = TRUE;
-        return;
+        gchar *message;
+
+        l_running_progress += progress;
+
+        /* show per file progress in the status column */
+        message = p_progress_message(vjob, progress);
+        g_free(vjob->vref->userdata);
+        vjob->vref->userdata = g_strdup_printf("%s%s", PROCESSING_STATUS_STRING, message);
+        g_free(message);
+        l_tree_changed = TRUE;
       }
     }
 
+    p_update_master_progress(vipp, NULL
+                            , ((gdouble)l_done_count + l_running_progress) / (gdouble)vipp->numberOfVideos
+                            , l_video_count
+                            );
 
-    if(vipp->progress_bar_master)
+    if((l_tree_changed) && (vipp->tv != NULL))
     {
-       gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(vipp->progress_bar_master)
-                                    , CLAMP(((gdouble)l_video_count / (gdouble)vipp->numberOfVideos), 0.0, 1.0)
-                                    );
+      p_tree_fill (vipp, vref_list);
+    }
+
+    if(numJobs > 0)
+    {
+      /* wait for the running worker threads
+       * (while gtk does refresh widgets and react on events, e.g. the cancel button)
+       */
+      while(g_main_context_iteration(NULL, FALSE));
+      g_usleep(GAP_VINDEX_POLL_USLEEP);
     }
   }
-  
-}  /* end p_make_all_video_index */
+
+  if (vipp->cancel_immedeiate_request == TRUE)
+  {
+    if(gap_debug)
+    {
+      printf("CANCEL_IMMEDEIATE_REQUEST after %d of %d videofiles\n"
+             , (int)l_done_count
+             , (int)vipp->numberOfVideos
+             );
+    }
+    vipp->processing_finished = TRUE;
+    return;
+  }
+
+  p_update_master_progress(vipp, NULL
+                          , (gdouble)l_done_count / (gdouble)vipp->numberOfVideos
+                          , l_video_count
+                          );
+
+}  /* end p_process_all_jobs */
 
 
 /* ------------------
@@ -1069,7 +1373,6 @@ p_vipp_dlg_destroy (GtkWidget *widget,
       vipp->tv = NULL;
       vipp->progress_bar_master = NULL;
       vipp->progress_bar_sub = NULL;
-      vipp->cancel_video_api = TRUE;
       vipp->cancel_immedeiate_request = TRUE;
       gtk_widget_destroy (dialog);
     }
@@ -1157,7 +1460,7 @@ p_print_vref_list (GapVideoIndexCreatorProgressParams *vipp, GapStoryVideoFileRe
      }
      else
      {
-       if (strcmp(PROCESSING_STATUS_STRING, vref->userdata) == 0)
+       if (strncmp(PROCESSING_STATUS_STRING, vref->userdata, strlen(PROCESSING_STATUS_STRING)) == 0)
        {
          processing_status = g_strdup(_("processing not finished"));
         }
@@ -1237,9 +1540,20 @@ p_tree_fill (GapVideoIndexCreatorProgressParams *vipp, GapStoryVideoFileRef  *vr
      }
      else
      {
-       if (strcmp(PROCESSING_STATUS_STRING, vref->userdata) == 0)
+       if (strncmp(PROCESSING_STATUS_STRING, vref->userdata, strlen(PROCESSING_STATUS_STRING)) == 0)
        {
-         processing_status = g_strdup(_("processing in progress"));
+         const char *progress_text;
+
+         /* the status of running jobs may be followed by a progress text */
+         progress_text = &vref->userdata[strlen(PROCESSING_STATUS_STRING)];
+         if (*progress_text != '\0')
+         {
+           processing_status = g_strdup(progress_text);
+         }
+         else
+         {
+           processing_status = g_strdup(_("processing in progress"));
+         }
          currentFlag = TRUE;
         }
        else
@@ -1531,9 +1845,56 @@ on_timer_start(GapVideoIndexCreatorProgressParams *vipp)
   }
 }  /* end on_timer_start */
 
+/* --------------------------------
+ * p_progress_message
+ * --------------------------------
+ * the caller is responsible to g_free the returned string
+ */
+static gchar *
+p_progress_message(GapVideoIndexCreatorJob *vjob, gdouble progress)
+{
+  gchar   *message;
+  gdouble  currentPercentageLimit;
+
+  switch (vjob->vipp->val_ptr->mode)
+  {
+    case QICK_MODE:
+      message = g_strdup_printf(_("Quick check %0.3f %%"), progress * 100.0);
+      break;
+    case SMART_MODE:
+      currentPercentageLimit = vjob->vipp->val_ptr->percentage_smart_mode;
+      if (vjob->gvahand != NULL)
+      {
+        if (vjob->gvahand->critical_timecodesteps_found == TRUE)
+        {
+          currentPercentageLimit = 100.0;
+        }
+      }
+      message = g_strdup_printf(_("Smart check %0.3f %% (of %0.3f %%)")
+                              , progress * 100.0
+                              , currentPercentageLimit
+                              );
+      break;
+    case FULLSCAN_MODE:
+      message = g_strdup_printf(_("Creating video index %0.3f %%"), progress * 100.0);
+      break;
+    default:
+      message = g_strdup_printf("%0.3f %%", progress * 100.0);
+      break;  
+  }
+  return (message);
+
+}  /* end p_progress_message */
+
+
 /* --------------------------------
  * p_vid_progress_callback
  * --------------------------------
+ * user_data is the GapVideoIndexCreatorJob of the videofile.
+ * Note that this callback runs in the worker thread of the job
+ * when videofiles are processed in parallel. In this case
+ * the progress is only recorded in the job (the main thread shows it)
+ *
  * return: TRUE: cancel videoapi immediate
  *         FALSE: continue
  */
@@ -1542,23 +1903,29 @@ p_vid_progress_callback(gdouble progress
                        ,gpointer user_data
                        )
 {
+  GapVideoIndexCreatorJob *vjob;
   GapVideoIndexCreatorProgressParams *vipp;
   gboolean critical_timecode_found;
-  gdouble currentPercentageLimit;
   
   
 
-  vipp = (GapVideoIndexCreatorProgressParams *)user_data;
-  if(vipp == NULL) { return (TRUE); }
+  vjob = (GapVideoIndexCreatorJob *)user_data;
+  if(vjob == NULL) { return (TRUE); }
+  vipp = vjob->vipp;
   
   critical_timecode_found = FALSE;
   
-  if (vipp->gvahand != NULL)
+  if (vjob->gvahand != NULL)
   {
-    critical_timecode_found = vipp->gvahand->critical_timecodesteps_found;
+    critical_timecode_found = vjob->gvahand->critical_timecodesteps_found;
   }
+
+  g_static_mutex_lock(&vjobMutex);
+  vjob->progress = CLAMP(progress, 0.0, 1.0);
+  g_static_mutex_unlock(&vjobMutex);
   
-  if(vipp->progress_bar_sub != NULL)
+  if((vjob->isThreaded != TRUE)
+  && (vipp->progress_bar_sub != NULL))
   {
     char *message;
     
@@ -1568,39 +1935,13 @@ p_vid_progress_callback(gdouble progress
     }
     
     gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(vipp->progress_bar_sub), CLAMP(progress, 0.0, 1.0));
-    switch (vipp->val_ptr->mode)
-    {
-      case QICK_MODE:
-        message = g_strdup_printf(_("Quick check %0.3f %%"), progress * 100.0);
-        break;
-      case SMART_MODE:
-        if (critical_timecode_found == TRUE)
-        {
-          currentPercentageLimit = 100.0;
-        }
-        else
-        {
-          currentPercentageLimit = vipp->val_ptr->percentage_smart_mode;
-        }
-        message = g_strdup_printf(_("Smart check %0.3f %% (of %0.3f %%)")
-                                , progress * 100.0
-                                , currentPercentageLimit
-                                );
-        break;
-      case FULLSCAN_MODE:
-        message = g_strdup_printf(_("Creating video index %0.3f %%"), progress * 100.0);
-        break;
-      default:
-        message = g_strdup_printf("%0.3f %%", progress * 100.0);
-        break;  
-       
-    }
+    message = p_progress_message(vjob, progress);
     gtk_progress_bar_set_text(GTK_PROGRESS_BAR(vipp->progress_bar_sub), message);
     g_free(message);
   }
   
   if ((vipp->val_ptr->mode == SMART_MODE)
-  && (vipp->cancel_enabled_smart == TRUE))
+  && (vjob->cancel_enabled_smart == TRUE))
   {
     if ((progress * 100.0 > vipp->val_ptr->percentage_smart_mode)
     && (critical_timecode_found == FALSE))
@@ -1612,21 +1953,23 @@ p_vid_progress_callback(gdouble progress
           ,(float)vipp->val_ptr->percentage_smart_mode
           );
       }
-      vipp->cancel_video_api = TRUE;
-      vipp->breakPercentage = progress * 100.0;
-      vipp->breakFrames = vipp->gvahand->frame_counter;
+      vjob->cancel_video_api = TRUE;
+      vjob->breakPercentage = progress * 100.0;
+      vjob->breakFrames = vjob->gvahand->frame_counter;
     }
   }
 
 
-  /* g_main_context_iteration makes sure that
-   *  gtk does refresh widgets,  and react on events while the videoapi
-   *  is busy with searching for the next frame.
-   */
-  while(g_main_context_iteration(NULL, FALSE));
-
-  return(vipp->cancel_video_api || vipp->cancel_immedeiate_request);
+  if(vjob->isThreaded != TRUE)
+  {
+    /* g_main_context_iteration makes sure that
+     *  gtk does refresh widgets,  and react on events while the videoapi
+     *  is busy with searching for the next frame.
+     * (in parallel processing mode the main thread does this)
+     */
+    while(g_main_context_iteration(NULL, FALSE));
+  }
 
-  /* return (TRUE); */ /* cancel video api if playback was stopped */
+  return(vjob->cancel_video_api || vipp->cancel_immedeiate_request);
 
 }  /* end p_vid_progress_callback */
@@ -25,6 +25,8 @@
  */
 
 /* revision history:
+ * 2.7.0  2026.10.18   hof: gimprc queries are serialized by the gimp mutex
+ *                          (gap_base_get_gimprc_* may be called from worker threads)
  * 2.5.0  2009.03.07   hof: created
  */
 
@@ -440,6 +442,25 @@ gap_base_check_tooltips(gboolean *old_state)
 }  /* end gap_base_check_tooltips */
 
 
+/* -----------------------------------------
+ * p_gimprc_query_locked
+ * -----------------------------------------
+ * query the gimprc while holding the gimp mutex
+ * (the PDB communication with the gimp core is not thread safe)
+ */
+static char *
+p_gimprc_query_locked(const char *gimprc_option_name)
+{
+  char *value_string;
+
+  gap_base_gimp_mutex_lock(NULL);
+  value_string = gimp_gimprc_query(gimprc_option_name);
+  gap_base_gimp_mutex_unlock(NULL);
+
+  return (value_string);
+}  /* end p_gimprc_query_locked */
+
+
 /* -----------------------------------------
  * gap_base_get_gimprc_gdouble_value
  * -----------------------------------------
@@ -458,7 +479,7 @@ gap_base_get_gimprc_gdouble_value (const char *gimprc_option_name
 
   value = default_value;
 
-  value_string = gimp_gimprc_query(gimprc_option_name);
+  value_string = p_gimprc_query_locked(gimprc_option_name);
   if(value_string)
   {
      gchar *endptr;
@@ -496,7 +517,7 @@ gap_base_get_gimprc_int_value (const char *gimprc_option_name
 
   value = default_value;
 
-  value_string = gimp_gimprc_query(gimprc_option_name);
+  value_string = p_gimprc_query_locked(gimprc_option_name);
   if(value_string)
   {
      value = atol(value_string);
@@ -519,7 +540,7 @@ gap_base_get_gimprc_gboolean_value (const char *gimprc_option_name
 
   value = default_value;
 
-  value_string = gimp_gimprc_query(gimprc_option_name);
+  value_string = p_gimprc_query_locked(gimprc_option_name);
   if(value_string)
   {
      value = FALSE;
@@ -0,0 +1,430 @@
+/* gap_file_cache.c
+ *
+ *  GAP persistent file cache directory procedures
+ *   - configuration via gimprc (size limit and directory)
+ *   - cache file header write and verification
+ *   - size accounting and LRU eviction
+ *
+ * used by the GVA frame diskcache (libgapvidapi/gap_vid_api_diskcache.c)
+ * and the storyboard composite cache (gap/gap_story_render_comp_cache.c)
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * 2026.10.18  created (common code of the GVA diskcache and the storyboard composite cache)
+ * 2026.10.18  - configurable default size (used by the persistent frame index)
+ */
+
+/* SYTEM (UNIX) includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <glib/gstdio.h>
+
+/* GIMP includes */
+#include "libgimp/gimp.h"
+
+#include "gap_base.h"
+#include "gap_file_cache.h"
+
+extern      int gap_debug; /* ==0  ... dont print debug infos */
+
+/* upper limit for the number of cache specific header values */
+#define GAP_FILE_CACHE_MAX_HDR_COUNT  8
+
+
+typedef struct GapFileCacheFileElem {   /* fcfile */
+  gchar   *filename;
+  time_t   mtime;
+  gint64   size;
+} GapFileCacheFileElem;
+
+
+/* --------------------------------
+ * gap_file_cache_init_config
+ * --------------------------------
+ * read the cache configuration from gimprc (only once per process)
+ * and create the cache directory.
+ * The cache is turned off when the size limit is 0
+ * (default_maxMB is used if not configured)
+ * or the directory can not be created.
+ */
+void
+gap_file_cache_init_config(GapFileCache *fcd
+                  , const char *gimprc_size_name
+                  , const char *gimprc_dir_name
+                  , const char *default_subdir
+                  , gint32 default_maxMB
+                  )
+{
+  gchar *dir;
+
+  if(fcd->maxMB >= 0)
+  {
+    return;
+  }
+
+  fcd->maxMB = gap_base_get_gimprc_int_value(gimprc_size_name
+                                                , default_maxMB
+                                                , 0        /* min */
+                                                , 1000000  /* max */
+                                                );
+  if(fcd->maxMB <= 0)
+  {
+    return;
+  }
+
+  gap_base_gimp_mutex_lock(NULL);
+  dir = gimp_gimprc_query(gimprc_dir_name);
+  gap_base_gimp_mutex_unlock(NULL);
+  if(dir)
+  {
+    fcd->dir = g_strdup(dir);
+    g_free(dir);
+  }
+  else
+  {
+    /* nothing configured. in that case we use a default directory */
+    fcd->dir = g_build_filename(gimp_directory(), default_subdir, NULL);
+  }
+
+  if(g_mkdir_with_parents(fcd->dir, 0755) != 0)
+  {
+    printf("%s: could not create directory %s (cache is turned off)\n"
+          , fcd->name
+          , fcd->dir);
+    fcd->maxMB = 0;
+  }
+
+  if(gap_debug)
+  {
+    printf("%s: dir:%s size limit:%d MB\n"
+          , fcd->name
+          , fcd->dir
+          , (int)fcd->maxMB
+          );
+  }
+}  /* end gap_file_cache_init_config */
+
+
+/* --------------------------------
+ * gap_file_cache_is_enabled
+ * --------------------------------
+ */
+gboolean
+gap_file_cache_is_enabled(GapFileCache *fcd)
+{
+  return ((fcd->maxMB > 0) && (fcd->dir != NULL));
+}  /* end gap_file_cache_is_enabled */
+
+
+/* --------------------------------
+ * gap_file_cache_build_filename
+ * --------------------------------
+ * return the full filename of the cache file with the specified name
+ * (name is typically the MD5 checksum of the key, the cache suffix is appended)
+ * the caller must g_free the returned string.
+ */
+gchar *
+gap_file_cache_build_filename(GapFileCache *fcd, const char *name)
+{
+  gchar *filename_part;
+  gchar *filename;
+
+  filename_part = g_strdup_printf("%s%s", name, fcd->suffix);
+  filename = g_build_filename(fcd->dir, filename_part, NULL);
+  g_free(filename_part);
+
+  return (filename);
+}  /* end gap_file_cache_build_filename */
+
+
+/* --------------------------------
+ * p_compare_mtime
+ * --------------------------------
+ */
+static gint
+p_compare_mtime(gconstpointer a, gconstpointer b)
+{
+  const GapFileCacheFileElem *fcfileA;
+  const GapFileCacheFileElem *fcfileB;
+
+  fcfileA = (const GapFileCacheFileElem *)a;
+  fcfileB = (const GapFileCacheFileElem *)b;
+  if(fcfileA->mtime < fcfileB->mtime)
+  {
+    return (-1);
+  }
+  if(fcfileA->mtime > fcfileB->mtime)
+  {
+    return (1);
+  }
+  return (0);
+}  /* end p_compare_mtime */
+
+
+/* --------------------------------
+ * p_scan
+ * --------------------------------
+ * scan the cache directory, return the total size of all cache files.
+ * if fileArray is not NULL, the found files are added as GapFileCacheFileElem.
+ */
+static gint64
+p_scan(GapFileCache *fcd, GArray *fileArray)
+{
+  GDir        *dirp;
+  const gchar *entry;
+  gint64       totalBytes;
+
+  totalBytes = 0;
+  dirp = g_dir_open(fcd->dir, 0, NULL);
+  if(dirp == NULL)
+  {
+    return (0);
+  }
+
+  while((entry = g_dir_read_name(dirp)) != NULL)
+  {
+    gchar      *filename;
+    struct stat l_stat;
+
+    if(g_str_has_suffix(entry, fcd->suffix) != TRUE)
+    {
+      continue;
+    }
+    filename = g_build_filename(fcd->dir, entry, NULL);
+    if(g_stat(filename, &l_stat) == 0)
+    {
+      totalBytes += l_stat.st_size;
+      if(fileArray != NULL)
+      {
+        GapFileCacheFileElem fcfile;
+
+        fcfile.filename = filename;
+        fcfile.mtime = l_stat.st_mtime;
+        fcfile.size = l_stat.st_size;
+        g_array_append_val(fileArray, fcfile);
+        filename = NULL;
+      }
+    }
+    g_free(filename);
+  }
+  g_dir_close(dirp);
+
+  return (totalBytes);
+}  /* end p_scan */
+
+
+/* --------------------------------
+ * p_evict
+ * --------------------------------
+ * remove the least recently used cache files until the total size
+ * is below GAP_FILE_CACHE_EVICT_TARGET_PERCENT of the configured limit.
+ */
+static void
+p_evict(GapFileCache *fcd)
+{
+  GArray *fileArray;
+  gint64  targetBytes;
+  guint   ii;
+
+  fileArray = g_array_new(FALSE, FALSE, sizeof(GapFileCacheFileElem));
+  fcd->totalBytes = p_scan(fcd, fileArray);
+  g_array_sort(fileArray, p_compare_mtime);
+
+  targetBytes = ((gint64)fcd->maxMB * 1024 * 1024 * GAP_FILE_CACHE_EVICT_TARGET_PERCENT) / 100;
+  for(ii = 0; ii < fileArray->len; ii++)
+  {
+    GapFileCacheFileElem *fcfile;
+
+    fcfile = &g_array_index(fileArray, GapFileCacheFileElem, ii);
+    if(fcd->totalBytes > targetBytes)
+    {
+      if(g_remove(fcfile->filename) == 0)
+      {
+        fcd->totalBytes -= fcfile->size;
+      }
+    }
+    g_free(fcfile->filename);
+  }
+  g_array_free(fileArray, TRUE);
+
+  if(gap_debug)
+  {
+    printf("%s: evict done, total size now:%.1f MB\n"
+          , fcd->name
+          , (float)fcd->totalBytes / (1024.0 * 1024.0)
+          );
+  }
+}  /* end p_evict */
+
+
+/* --------------------------------
+ * gap_file_cache_add_stored_bytes
+ * --------------------------------
+ * account a newly stored cache file of fileSize bytes
+ * and remove the least recently used files when the size limit is exceeded.
+ * (callers that store from more than one thread must serialize the calls)
+ */
+void
+gap_file_cache_add_stored_bytes(GapFileCache *fcd, gint64 fileSize)
+{
+  if(fcd->totalBytes < 0)
+  {
+    fcd->totalBytes = p_scan(fcd, NULL);
+  }
+  else
+  {
+    fcd->totalBytes += fileSize;
+  }
+  if(fcd->totalBytes > (gint64)fcd->maxMB * 1024 * 1024)
+  {
+    p_evict(fcd);
+  }
+}  /* end gap_file_cache_add_stored_bytes */
+
+
+/* --------------------------------
+ * gap_file_cache_get_file_size
+ * --------------------------------
+ * return the size of a cache file with hdr_count header values, key and data_size bytes of data.
+ */
+gsize
+gap_file_cache_get_file_size(gint32 hdr_count, const char *key, gsize data_size)
+{
+  return (GAP_FILE_CACHE_MAGIC_LEN
+         + ((hdr_count + 1) * sizeof(gint32))
+         + strlen(key)
+         + data_size);
+}  /* end gap_file_cache_get_file_size */
+
+
+/* --------------------------------
+ * gap_file_cache_write_file
+ * --------------------------------
+ * write a cache file (magic, header values, keylen, key and data).
+ * The file is written to a temporary file that is renamed when complete,
+ * so that readers (in other threads or processes) never see partial written cache files.
+ * return TRUE when the file was written.
+ */
+gboolean
+gap_file_cache_write_file(GapFileCache *fcd
+                  , const char *filename
+                  , const gint32 *hdr, gint32 hdr_count
+                  , const char *key
+                  , const guchar *data, gsize data_size
+                  )
+{
+  FILE     *fp;
+  gchar    *filenameTmp;
+  gint32    keylen;
+  gboolean  isWritten;
+
+  keylen = strlen(key);
+  isWritten = FALSE;
+  filenameTmp = g_strdup_printf("%s.%x.%x.tmp", filename
+                               , (guint)g_random_int()
+                               , (guint)g_random_int()
+                               );
+  fp = g_fopen(filenameTmp, "wb");
+  if(fp)
+  {
+    if((fwrite(fcd->magic, GAP_FILE_CACHE_MAGIC_LEN, 1, fp) == 1)
+    && (fwrite(hdr, sizeof(gint32), hdr_count, fp) == (size_t)hdr_count)
+    && (fwrite(&keylen, sizeof(gint32), 1, fp) == 1)
+    && (fwrite(key, keylen, 1, fp) == 1)
+    && (fwrite(data, data_size, 1, fp) == 1))
+    {
+      isWritten = TRUE;
+    }
+    if(fclose(fp) != 0)
+    {
+      isWritten = FALSE;
+    }
+
+    if(isWritten)
+    {
+      isWritten = (g_rename(filenameTmp, filename) == 0);
+    }
+    if(!isWritten)
+    {
+      g_remove(filenameTmp);
+    }
+  }
+  g_free(filenameTmp);
+
+  return (isWritten);
+}  /* end gap_file_cache_write_file */
+
+
+/* --------------------------------
+ * gap_file_cache_check_contents
+ * --------------------------------
+ * verify the contents of a cache file (typically memory mapped)
+ * against the expected header values, key and data size.
+ * return a pointer to the data part of contents,
+ * or NULL if the contents does not match.
+ */
+const guchar *
+gap_file_cache_check_contents(GapFileCache *fcd
+                  , const gchar *contents, gsize length
+                  , const gint32 *hdr, gint32 hdr_count
+                  , const char *key
+                  , gsize data_size
+                  )
+{
+  gint32  fileHdr[GAP_FILE_CACHE_MAX_HDR_COUNT + 1];
+  gsize   hdrSize;
+  gsize   keylen;
+
+  if((contents == NULL)
+  || (hdr_count > GAP_FILE_CACHE_MAX_HDR_COUNT))
+  {
+    return (NULL);
+  }
+
+  hdrSize = GAP_FILE_CACHE_MAGIC_LEN + ((hdr_count + 1) * sizeof(gint32));
+  keylen = strlen(key);
+  if((length != hdrSize + keylen + data_size)
+  || (memcmp(contents, fcd->magic, GAP_FILE_CACHE_MAGIC_LEN) != 0))
+  {
+    return (NULL);
+  }
+
+  memcpy(fileHdr, contents + GAP_FILE_CACHE_MAGIC_LEN, (hdr_count + 1) * sizeof(gint32));
+  if(memcmp(fileHdr, hdr, hdr_count * sizeof(gint32)) != 0)
+  {
+    return (NULL);
+  }
+  if((fileHdr[hdr_count] < 0)
+  || ((gsize)fileHdr[hdr_count] != keylen))
+  {
+    return (NULL);
+  }
+  if(memcmp(contents + hdrSize, key, keylen) != 0)
+  {
+    return (NULL);
+  }
+
+  return ((const guchar *)(contents + hdrSize + keylen));
+
+}  /* end gap_file_cache_check_contents */
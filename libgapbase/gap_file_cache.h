@@ -0,0 +1,88 @@
+/* gap_file_cache.h
+ *
+ *  GAP persistent file cache directory procedures
+ *  (shared by the GVA frame diskcache and the storyboard composite cache)
+ *
+ */
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * 2026.10.18  created
+ * 2026.10.18  - configurable default size
+ */
+
+#ifndef GAP_FILE_CACHE_H
+#define GAP_FILE_CACHE_H
+
+#include "libgimp/gimp.h"
+
+#define GAP_FILE_CACHE_MAGIC_LEN      8
+
+/* percentage of the size limit to keep after eviction */
+#define GAP_FILE_CACHE_EVICT_TARGET_PERCENT   90
+
+/* a file cache directory holds one file per cached item. Each file has the layout
+ *   magic (GAP_FILE_CACHE_MAGIC_LEN bytes)
+ *   hdr_count gint32 header values (cache specific, e.g. width, height)
+ *   gint32 keylen
+ *   key (keylen bytes, not terminated)
+ *   data
+ * The files are named by the caller (typically the MD5 checksum of the key)
+ * and the mtime of the files is used as last access time for LRU eviction.
+ */
+typedef struct GapFileCache {   /* fcd */
+  const char *name;          /* cache name for log messages */
+  const char *suffix;        /* filename suffix of the cache files */
+  const char *magic;         /* GAP_FILE_CACHE_MAGIC_LEN characters */
+  gint32      maxMB;         /* -1 gimprc not yet checked, 0 cache is off */
+  gchar      *dir;
+  gint64      totalBytes;    /* -1 directory not yet scanned */
+} GapFileCache;
+
+#define GAP_FILE_CACHE_INITIALIZER(name, suffix, magic)  { name, suffix, magic, -1, NULL, -1 }
+
+
+/* --------------------------*/
+/* PROCEDURE DECLARATIONS    */
+/* --------------------------*/
+
+void          gap_file_cache_init_config(GapFileCache *fcd
+                  , const char *gimprc_size_name
+                  , const char *gimprc_dir_name
+                  , const char *default_subdir
+                  , gint32 default_maxMB
+                  );
+gboolean      gap_file_cache_is_enabled(GapFileCache *fcd);
+gchar *       gap_file_cache_build_filename(GapFileCache *fcd, const char *name);
+void          gap_file_cache_add_stored_bytes(GapFileCache *fcd, gint64 fileSize);
+gsize         gap_file_cache_get_file_size(gint32 hdr_count, const char *key, gsize data_size);
+gboolean      gap_file_cache_write_file(GapFileCache *fcd
+                  , const char *filename
+                  , const gint32 *hdr, gint32 hdr_count
+                  , const char *key
+                  , const guchar *data, gsize data_size
+                  );
+const guchar *gap_file_cache_check_contents(GapFileCache *fcd
+                  , const gchar *contents, gsize length
+                  , const gint32 *hdr, gint32 hdr_count
+                  , const char *key
+                  , gsize data_size
+                  );
+
+#endif
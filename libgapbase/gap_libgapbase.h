@@ -35,6 +35,7 @@
 
 #include "gap_val_file.h"
 #include "gap_file_util.h"
+#include "gap_file_cache.h"
 #include "gap_base.h"
 #include "gap_timm.h"
 
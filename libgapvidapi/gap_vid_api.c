@@ -106,9 +106,11 @@ t_GVA_DecoderElem  *GVA_global_decoder_list = NULL;
 
 
 
-static void                      p_alloc_rowpointers(t_GVA_Handle *gvahand, t_GVA_Frame_Cache_Elem  *fc_ptr);
-static t_GVA_Frame_Cache_Elem *  p_new_frame_cache_elem(t_GVA_Handle *gvahand);
-static void                      p_drop_next_frame_cache_elem(t_GVA_Frame_Cache *fcache);
+static gint32                    p_frame_cache_elem_bytes(t_GVA_Handle *gvahand);
+static void                      p_frame_cache_invalidate_elem(t_GVA_Frame_Cache *fcache, t_GVA_Frame_Cache_Elem *fc_ptr);
+static void                      p_frame_cache_set_framenumber(t_GVA_Frame_Cache *fcache, t_GVA_Frame_Cache_Elem *fc_ptr, gint32 framenumber);
+static t_GVA_Frame_Cache_Elem *  p_frame_cache_lookup(t_GVA_Frame_Cache *fcache, gint32 framenumber);
+static void                      p_frame_cache_advance(t_GVA_Handle *gvahand);
 static void                      p_drop_frame_cache(t_GVA_Handle *gvahand);
 static gint32                    p_build_frame_cache(t_GVA_Handle *gvahand, gint32 frames_to_keep_cahed);
 static gdouble                   p_guess_total_frames(t_GVA_Handle *gvahand);
@@ -135,6 +137,8 @@ static t_GVA_Handle *            p_gva_worker_open_read(const char *filename, gi
                                     ,gboolean disable_mmx
                                     );
 
+#include "gap_vid_api_diskcache.c"
+
 
 /* ---------------------------
  * GVA_percent_2_frame
@@ -228,7 +232,12 @@ GVA_debug_print_fcache(t_GVA_Handle *gvahand)
   {
     gint ii;
 
-    printf("frame_cache_size: %d\n", (int)fcache->frame_cache_size);
+    printf("frame_cache_size: %d  hits:%d misses:%d evictions:%d\n"
+          , (int)fcache->frame_cache_size
+          , (int)fcache->hits
+          , (int)fcache->misses
+          , (int)fcache->evictions
+          );
 
     fc_ptr = (t_GVA_Frame_Cache_Elem  *)fcache->fc_current;
     for(ii=0; ii < fcache->frame_cache_size; ii++)
@@ -265,101 +274,144 @@ GVA_debug_print_fcache(t_GVA_Handle *gvahand)
 
 
 /* ------------------------------
- * p_alloc_rowpointers
+ * p_frame_cache_elem_bytes
  * ------------------------------
- * allocate frame_data buffer (for RGB or RGBA imagedata)
- * and  row pointers for each row
+ * return the number of bytes reserved for one frame in the frame slab.
  * We must allocate 4 extra bytes in the last output_row.
  * This is scratch area for the MMX routines used by some decoder libs.
+ * The size is rounded up to a multiple of 16 so that each frame in the slab
+ * starts at an aligned address.
  */
-static void
-p_alloc_rowpointers(t_GVA_Handle *gvahand, t_GVA_Frame_Cache_Elem  *fc_ptr)
+static gint32
+p_frame_cache_elem_bytes(t_GVA_Handle *gvahand)
 {
-    int ii, wwidth, wheight, bpp;
+  gint32 wwidth, wheight, bpp;
+  gint32 elemBytes;
+
+  wwidth  = MAX(gvahand->width, 2);
+  wheight = MAX(gvahand->height, 2);
+  bpp = gvahand->frame_bpp;
+
+  elemBytes = (wwidth * wheight * bpp) + 4;
+  elemBytes = (elemBytes + 15) & ~15;
 
-    wwidth  = MAX(gvahand->width, 2);
-    wheight = MAX(gvahand->height, 2);
-    bpp = gvahand->frame_bpp;
+  return (elemBytes);
+}  /* end p_frame_cache_elem_bytes */
 
-    fc_ptr->frame_data = g_malloc(wwidth * wheight * bpp + 4);
-    fc_ptr->row_pointers = g_malloc(sizeof(unsigned char*) * wheight);
 
-    /* init row pointers */
-    for(ii = 0; ii < wheight; ii++)
+/* ------------------------------
+ * p_frame_cache_invalidate_elem
+ * ------------------------------
+ * mark the specified element as unused and remove it from the framenumber index.
+ */
+static void
+p_frame_cache_invalidate_elem(t_GVA_Frame_Cache *fcache, t_GVA_Frame_Cache_Elem *fc_ptr)
+{
+  if(fc_ptr->framenumber >= 0)
+  {
+    if(fcache->fc_index != NULL)
     {
-      fc_ptr->row_pointers[ii] = &fc_ptr->frame_data[ii * wwidth * bpp];
+      if(g_hash_table_lookup(fcache->fc_index, GINT_TO_POINTER(fc_ptr->framenumber)) == fc_ptr)
+      {
+        g_hash_table_remove(fcache->fc_index, GINT_TO_POINTER(fc_ptr->framenumber));
+      }
     }
-}  /* end p_alloc_rowpointers */
+  }
+  fc_ptr->framenumber = -1;
+}  /* end p_frame_cache_invalidate_elem */
 
 
-/* ----------------------------------------------------
- * p_new_frame_cache_elem
- * ----------------------------------------------------
+/* ------------------------------
+ * p_frame_cache_set_framenumber
+ * ------------------------------
+ * set the framenumber of the specified element and register it in the framenumber index.
+ * An older element holding the same framenumber (e.g. after a backwards seek
+ * has read the same frame again) is invalidated, so that the index
+ * always refers to exactly one element per framenumber.
  */
-static t_GVA_Frame_Cache_Elem *
-p_new_frame_cache_elem(t_GVA_Handle *gvahand)
+static void
+p_frame_cache_set_framenumber(t_GVA_Frame_Cache *fcache, t_GVA_Frame_Cache_Elem *fc_ptr, gint32 framenumber)
 {
-  t_GVA_Frame_Cache_Elem  *fc_ptr;
+  t_GVA_Frame_Cache_Elem *fc_old;
 
+  p_frame_cache_invalidate_elem(fcache, fc_ptr);
+  if((framenumber < 0) || (fcache->fc_index == NULL))
+  {
+    return;
+  }
 
-  fc_ptr = g_malloc0(sizeof(t_GVA_Frame_Cache_Elem));
-  gvahand->fcache.max_fcache_id++;
-  fc_ptr->id = gvahand->fcache.max_fcache_id;
-  fc_ptr->framenumber = -1;    /* marker for unused element, framedata is allocated but not initialized */
-  fc_ptr->prev = fc_ptr;
-  fc_ptr->next = fc_ptr;
+  fc_old = g_hash_table_lookup(fcache->fc_index, GINT_TO_POINTER(framenumber));
+  if((fc_old != NULL) && (fc_old != fc_ptr))
+  {
+    fc_old->framenumber = -1;
+  }
+  fc_ptr->framenumber = framenumber;
+  g_hash_table_insert(fcache->fc_index, GINT_TO_POINTER(framenumber), fc_ptr);
 
-  p_alloc_rowpointers(gvahand, fc_ptr);
+}  /* end p_frame_cache_set_framenumber */
 
-  return (fc_ptr);
-}  /* end p_new_frame_cache_elem */
 
+/* ------------------------------
+ * p_frame_cache_lookup
+ * ------------------------------
+ * return the fcache element that holds the specified framenumber
+ * or NULL in case framenumber is not cached.
+ * (updates the hit/miss statistics)
+ */
+static t_GVA_Frame_Cache_Elem *
+p_frame_cache_lookup(t_GVA_Frame_Cache *fcache, gint32 framenumber)
+{
+  t_GVA_Frame_Cache_Elem *fc_ptr;
+
+  fc_ptr = NULL;
+  if((framenumber >= 0) && (fcache->fc_index != NULL))
+  {
+    fc_ptr = g_hash_table_lookup(fcache->fc_index, GINT_TO_POINTER(framenumber));
+  }
+
+  if(fc_ptr != NULL)
+  {
+    fcache->hits++;
+  }
+  else
+  {
+    fcache->misses++;
+  }
+  return (fc_ptr);
+}  /* end p_frame_cache_lookup */
 
 
-/* ----------------------------------------------------
- * p_drop_next_frame_cache_elem
- * ----------------------------------------------------
- * drop the next (== oldest) element of the frame cache list
+/* ------------------------------
+ * p_frame_cache_advance
+ * ------------------------------
+ * advance the current write position to the next element in the fcache ring
+ * (that is the oldest element) and set gvahand->frame_data and gvahand->row_pointers
+ * to the (now unused) new current element.
+ * In case the current element is still unused (framenumber is negative)
+ * we can reuse that EMPTY element without advance.
  */
 static void
-p_drop_next_frame_cache_elem(t_GVA_Frame_Cache *fcache)
+p_frame_cache_advance(t_GVA_Handle *gvahand)
 {
-  t_GVA_Frame_Cache_Elem  *fc_ptr;
+  t_GVA_Frame_Cache *fcache;
 
-  if(fcache)
+  fcache = &gvahand->fcache;
+  if(fcache->fc_current == NULL)
   {
-    if(fcache->fc_current)
+    return;
+  }
+  if(fcache->fc_current->framenumber >= 0)
+  {
+    fcache->fc_current = fcache->fc_current->next;
+    if(fcache->fc_current->framenumber >= 0)
     {
-      fc_ptr = (t_GVA_Frame_Cache_Elem  *)fcache->fc_current->next;
-      if(fc_ptr)
-      {
-        if(gap_debug) printf("p_drop_next_frame_cache_elem framenumber:%d\n", (int)fc_ptr->framenumber);
-
-        if(fc_ptr != fcache->fc_current)
-        {
-          t_GVA_Frame_Cache_Elem  *fc_nxt;
-
-          /* the ring still has 2 or more elements
-           * we must update prev pointer of the next element
-           * and next pointer of the previous element
-           */
-          fc_nxt = (t_GVA_Frame_Cache_Elem  *)fc_ptr->next;
-          fcache->fc_current->next = fc_nxt;
-          fc_nxt->prev = fcache->fc_current;
-        }
-        else
-        {
-          /* we are dropping the last element, set fc_current pointer to NULL */
-          fcache->fc_current = NULL;
-        }
-
-        g_free(fc_ptr->frame_data);
-        g_free(fc_ptr->row_pointers);
-        g_free(fc_ptr);
-      }
+      fcache->evictions++;
     }
+    p_frame_cache_invalidate_elem(fcache, fcache->fc_current);
+    gvahand->frame_data = fcache->fc_current->frame_data;
+    gvahand->row_pointers = fcache->fc_current->row_pointers;
   }
-}  /* end p_drop_next_frame_cache_elem */
+}  /* end p_frame_cache_advance */
 
 
 /* ----------------------------------------------------
@@ -375,10 +427,28 @@ p_drop_frame_cache(t_GVA_Handle *gvahand)
   fcache = &gvahand->fcache;
   if(fcache)
   {
-    while(fcache->fc_current)
+    if(fcache->fc_index)
+    {
+      g_hash_table_destroy(fcache->fc_index);
+      fcache->fc_index = NULL;
+    }
+    if(fcache->fc_elems)
     {
-      p_drop_next_frame_cache_elem(fcache);
+      g_free(fcache->fc_elems);
+      fcache->fc_elems = NULL;
     }
+    if(fcache->fc_slab)
+    {
+      g_free(fcache->fc_slab);
+      fcache->fc_slab = NULL;
+    }
+    if(fcache->fc_row_slab)
+    {
+      g_free(fcache->fc_row_slab);
+      fcache->fc_row_slab = NULL;
+    }
+    fcache->fc_current = NULL;
+    fcache->frame_cache_size = 0;
   }
   if(gap_debug) printf("p_drop_frame_cache END\n");
 
@@ -388,80 +458,146 @@ p_drop_frame_cache(t_GVA_Handle *gvahand)
 /* ----------------------------------------------------
  * p_build_frame_cache
  * ----------------------------------------------------
- * the frame cache is a double linked ringlist.
- * this procedure creates such a list (if we have none)
- * or changes the (existing) ringlist to the desired number of elements.
- * this is done by dropping the oldest elements (if we already have to much)
- * or adding new elements (if we have not enough elements)
+ * the frame cache is a double linked ringlist of elements
+ * that are stored in one array (fc_elems) where the ring order
+ * is the same as the array order (the next element of the last array element
+ * is the 1st array element). The frame data of all elements is allocated
+ * as one contiguous slab (fc_slab) and the fc_index hashtable maps framenumbers
+ * to the elements, so that lookups by framenumber or by index do not need to
+ * walk the ring.
+ *
+ * this procedure creates such a cache (if we have none)
+ * or changes the (existing) cache to the desired number of elements.
+ * On resize the slab is reallocated and the current element
+ * plus the most recently read frames (as much as fit into the new size)
+ * are copied into the new slab.
  *
- * if the fcache does not exist (if fcache gvahand->fcache.fc_current == NULL)
- * it will be created.
  * the pointers
  *    gvahand->frame_data
  *    gvahand->row_pointers
- * are set to point at the 1.st (current) fcache element in that case.
+ * are set to point at the current fcache element.
  */
 static gint32
 p_build_frame_cache(t_GVA_Handle *gvahand, gint32 frames_to_keep_cahed)
 {
   t_GVA_Frame_Cache *fcache;
   t_GVA_Frame_Cache_Elem  *fc_ptr;
+  t_GVA_Frame_Cache_Elem  *fc_elems;
+  t_GVA_Frame_Cache_Elem **fc_keep;
+  guchar                  *fc_slab;
+  guchar                 **fc_row_slab;
+  gint32                   elemBytes;
+  gint32                   wwidth, wheight, bpp;
+  gint32                   keepCount;
+  gint32                   oldValidCount;
+  gint32                   ii;
+  gint32                   jj;
 
   fcache = &gvahand->fcache;
-  fcache->frame_cache_size = 0;
+  frames_to_keep_cahed = MAX(frames_to_keep_cahed, 1);
+  if((fcache->fc_current != NULL)
+  && (fcache->frame_cache_size == frames_to_keep_cahed))
+  {
+    return(fcache->frame_cache_size);
+  }
+
+  wwidth  = MAX(gvahand->width, 2);
+  wheight = MAX(gvahand->height, 2);
+  bpp = gvahand->frame_bpp;
+  elemBytes = p_frame_cache_elem_bytes(gvahand);
+
+  fc_elems = g_new0(t_GVA_Frame_Cache_Elem, frames_to_keep_cahed);
+  fc_slab = g_malloc((gsize)elemBytes * (gsize)frames_to_keep_cahed);
+  fc_row_slab = g_new(guchar *, (gsize)wheight * (gsize)frames_to_keep_cahed);
+
+  /* link the elements as ring in array order and init the row pointers */
+  for(ii = 0; ii < frames_to_keep_cahed; ii++)
+  {
+    fc_ptr = &fc_elems[ii];
+    fcache->max_fcache_id++;
+    fc_ptr->id = fcache->max_fcache_id;
+    fc_ptr->framenumber = -1;    /* marker for unused element, framedata is allocated but not initialized */
+    fc_ptr->frame_data = &fc_slab[(gsize)ii * (gsize)elemBytes];
+    fc_ptr->row_pointers = &fc_row_slab[(gsize)ii * (gsize)wheight];
+    fc_ptr->prev = &fc_elems[(ii + frames_to_keep_cahed - 1) % frames_to_keep_cahed];
+    fc_ptr->next = &fc_elems[(ii + 1) % frames_to_keep_cahed];
+
+    for(jj = 0; jj < wheight; jj++)
+    {
+      fc_ptr->row_pointers[jj] = &fc_ptr->frame_data[jj * wwidth * bpp];
+    }
+  }
+
+  /* collect the elements to keep, starting at the current element
+   * and stepping backwards (towards older frames).
+   */
+  keepCount = 0;
+  fc_keep = g_new(t_GVA_Frame_Cache_Elem *, frames_to_keep_cahed);
   if(fcache->fc_current)
   {
-    fcache->frame_cache_size = 1;
-    fc_ptr = (t_GVA_Frame_Cache_Elem  *)fcache->fc_current->next;
-    while(fcache->fc_current != fc_ptr)
+    fc_ptr = fcache->fc_current;
+    fc_keep[keepCount++] = fc_ptr;
+    fc_ptr = (t_GVA_Frame_Cache_Elem  *)fc_ptr->prev;
+    while((fc_ptr != fcache->fc_current) && (keepCount < frames_to_keep_cahed))
     {
-      fcache->frame_cache_size++;
-      fc_ptr = (t_GVA_Frame_Cache_Elem  *)fc_ptr->next;
-      if(fc_ptr == NULL)
+      if(fc_ptr->framenumber >= 0)
       {
-         printf("API internal ERROR (frame cache is not linked as ring)\n");
-         exit(1);
+        fc_keep[keepCount++] = fc_ptr;
       }
+      fc_ptr = (t_GVA_Frame_Cache_Elem  *)fc_ptr->prev;
     }
+  }
 
-    /* if cache is greater than wanted size drop the oldest (next)
-     * elements until we have desired number of elements
-     */
-    while(fcache->frame_cache_size > frames_to_keep_cahed)
-    {
-      p_drop_next_frame_cache_elem(fcache);
-      fcache->frame_cache_size--;
-    }
+  oldValidCount = 0;
+  if(fcache->fc_index == NULL)
+  {
+    fcache->fc_index = g_hash_table_new(g_direct_hash, g_direct_equal);
   }
   else
   {
-    /* create the 1st element, ring-linked to itself */
-    fc_ptr = p_new_frame_cache_elem(gvahand);
-    fc_ptr->prev = fc_ptr;
-    fc_ptr->next = fc_ptr;
-    fcache->fc_current = fc_ptr;
-    gvahand->frame_data = fc_ptr->frame_data;
-    gvahand->row_pointers = fc_ptr->row_pointers;
-    fcache->frame_cache_size = 1;
+    oldValidCount = g_hash_table_size(fcache->fc_index);
   }
+  g_hash_table_remove_all(fcache->fc_index);
 
-  /* if current cache is smaller than requested, add the missing elements */
-  while(fcache->frame_cache_size < frames_to_keep_cahed)
+  /* copy the kept frames into the new slab. The current element goes to
+   * array position keepCount -1, older frames to the lower positions,
+   * so that the next element of the current one is the oldest (or an unused) element.
+   */
+  for(ii = 0; ii < keepCount; ii++)
   {
-    t_GVA_Frame_Cache_Elem  *fc_nxt;
+    fc_ptr = &fc_elems[keepCount - 1 - ii];
+    memcpy(fc_ptr->frame_data
+          , fc_keep[ii]->frame_data
+          , MIN(elemBytes, fcache->fc_elem_bytes)
+          );
+    p_frame_cache_set_framenumber(fcache, fc_ptr, fc_keep[ii]->framenumber);
+  }
+  g_free(fc_keep);
+  fcache->evictions += MAX(0, oldValidCount - (gint32)g_hash_table_size(fcache->fc_index));
 
-    /* add a new element after the current element in the pointerring
-     */
-    fc_nxt = (t_GVA_Frame_Cache_Elem  *)fcache->fc_current->next;
+  /* drop the old cache and install the new one */
+  if(fcache->fc_elems)
+  {
+    g_free(fcache->fc_elems);
+  }
+  if(fcache->fc_slab)
+  {
+    g_free(fcache->fc_slab);
+  }
+  if(fcache->fc_row_slab)
+  {
+    g_free(fcache->fc_row_slab);
+  }
 
-    fc_ptr = p_new_frame_cache_elem(gvahand);
-    fc_ptr->prev = fcache->fc_current;
-    fc_ptr->next = fc_nxt;
-    fc_nxt->prev = fc_ptr;
-    fcache->fc_current->next = fc_ptr;
+  fcache->fc_elems = fc_elems;
+  fcache->fc_slab = fc_slab;
+  fcache->fc_row_slab = fc_row_slab;
+  fcache->fc_elem_bytes = elemBytes;
+  fcache->frame_cache_size = frames_to_keep_cahed;
+  fcache->fc_current = &fc_elems[MAX(keepCount - 1, 0)];
 
-    fcache->frame_cache_size++;
-  }
+  gvahand->frame_data = fcache->fc_current->frame_data;
+  gvahand->row_pointers = fcache->fc_current->row_pointers;
 
   return(fcache->frame_cache_size);
 
@@ -534,15 +670,13 @@ GVA_get_fcache_size_in_elements(t_GVA_Handle *gvahand)
 gint32 
 GVA_get_fcache_size_in_bytes(t_GVA_Handle *gvahand)
 {
-  int wwidth, wheight, bpp;
+  int wheight;
   gint32 bytesUsedPerElem;
   gint32 bytesUsedSummary;
 
-  wwidth  = MAX(gvahand->width, 2);
   wheight = MAX(gvahand->height, 2);
-  bpp = gvahand->frame_bpp;
 
-  bytesUsedPerElem = (wwidth * wheight * bpp + 4);          /* data size per cache element */
+  bytesUsedPerElem = p_frame_cache_elem_bytes(gvahand);    /* data size per cache element */
   bytesUsedPerElem += (sizeof(unsigned char*) * wheight);   /* rowpointers per cache element */
 
 
@@ -552,6 +686,37 @@ GVA_get_fcache_size_in_bytes(t_GVA_Handle *gvahand)
 }  /* end GVA_get_fcache_size_in_bytes */
 
 
+/* ------------------------------
+ * GVA_get_fcache_statistics
+ * ------------------------------
+ * report the fcache hit/miss/eviction counters
+ * (accumulated since the videohandle was opened)
+ */
+void
+GVA_get_fcache_statistics(t_GVA_Handle *gvahand
+                 , GVA_fcache_statistics *stats
+                 )
+{
+  t_GVA_Frame_Cache *fcache;
+
+  GVA_fcache_mutex_lock (gvahand);
+
+  fcache = &gvahand->fcache;
+  stats->hits = fcache->hits;
+  stats->misses = fcache->misses;
+  stats->evictions = fcache->evictions;
+  stats->size_in_elements = fcache->frame_cache_size;
+  stats->cached_frames = 0;
+  if(fcache->fc_index != NULL)
+  {
+    stats->cached_frames = g_hash_table_size(fcache->fc_index);
+  }
+
+  GVA_fcache_mutex_unlock (gvahand);
+
+}  /* end GVA_get_fcache_statistics */
+
+
 /* ------------------------------------
  * GVA_search_fcache
  * ------------------------------------
@@ -599,54 +764,31 @@ GVA_search_fcache(t_GVA_Handle *gvahand
   gvahand->fc_row_pointers = gvahand->row_pointers;
 
   fcache = &gvahand->fcache;
-  if(fcache->fc_current)
+  if(fcache->fc_current == NULL)
   {
-    fc_ptr = (t_GVA_Frame_Cache_Elem  *)fcache->fc_current;
-    while(1 == 1)
-    {
-      if(framenumber == fc_ptr->framenumber)
-      {
-        if(fc_ptr->framenumber >= 0)
-        {
-          gvahand->fc_frame_data = fc_ptr->frame_data;  /* framedata of cached frame */
-          gvahand->fc_row_pointers = fc_ptr->row_pointers;
-
+    GAP_TIMM_STOP_FUNCTION(funcId);
+    GVA_fcache_mutex_unlock (gvahand);
 
-          GAP_TIMM_STOP_FUNCTION(funcId);
-          GVA_fcache_mutex_unlock (gvahand);
-
-          return(GVA_RET_OK);  /* OK */
-        }
-      }
-
-      /* try to get framedata from fcache ringlist,
-       * by stepping backwards the frames that were read before
-       */
-      fc_ptr = (t_GVA_Frame_Cache_Elem  *)fc_ptr->prev;
+    /* ringlist not found */
+    return (GVA_RET_ERROR);
+  }
 
-      if(fcache->fc_current == fc_ptr)
-      {
-        GAP_TIMM_STOP_FUNCTION(funcId);
+  fc_ptr = p_frame_cache_lookup(fcache, framenumber);
+  if(fc_ptr != NULL)
+  {
+    gvahand->fc_frame_data = fc_ptr->frame_data;  /* framedata of cached frame */
+    gvahand->fc_row_pointers = fc_ptr->row_pointers;
 
-        GVA_fcache_mutex_unlock (gvahand);
+    GAP_TIMM_STOP_FUNCTION(funcId);
+    GVA_fcache_mutex_unlock (gvahand);
 
-        return (GVA_RET_EOF);  /* STOP, we are back at startpoint of the ringlist */
-      }
-      if(fc_ptr == NULL)
-      {
-        GAP_TIMM_STOP_FUNCTION(funcId);
-        GVA_fcache_mutex_unlock (gvahand);
-
-        return (GVA_RET_ERROR);  /* internal error, ringlist is broken */
-      }
-    }
+    return(GVA_RET_OK);  /* OK */
   }
 
   GAP_TIMM_STOP_FUNCTION(funcId);
   GVA_fcache_mutex_unlock (gvahand);
 
-  /* ringlist not found */
-  return (GVA_RET_ERROR);
+  return (GVA_RET_EOF);  /* framenumber not cached */
 
 }  /* end GVA_search_fcache */
 
@@ -696,67 +838,53 @@ GVA_search_fcache_by_index(t_GVA_Handle *gvahand
   gvahand->fc_row_pointers = gvahand->row_pointers;
 
   fcache = &gvahand->fcache;
-  if(fcache->fc_current)
+  if((fcache->fc_current == NULL) || (fcache->fc_elems == NULL))
   {
-    gint32 ii;
+    GVA_fcache_mutex_unlock (gvahand);
 
-    fc_ptr = (t_GVA_Frame_Cache_Elem  *)fcache->fc_current;
-    for(ii=0; 1==1; ii++)
-    {
-      if(index == ii)
-      {
-        *framenumber = fc_ptr->framenumber;
-        if(fc_ptr->framenumber < 0)
-        {
-          if(gap_debug)
-          {
-            printf("GVA_search_fcache_by_index: INDEX: %d  NOT FOUND (fnum < 0) ###########\n", (int)index );
-          }
-
-          GVA_fcache_mutex_unlock (gvahand);
-
-          return (GVA_RET_EOF);
-        }
-        gvahand->fc_frame_data = fc_ptr->frame_data;  /* framedata of cached frame */
-        gvahand->fc_row_pointers = fc_ptr->row_pointers;
+    /* ringlist not found */
+    return (GVA_RET_ERROR);
+  }
 
-        if(gap_debug)
-        {
-          printf("GVA_search_fcache_by_index: fnum; %d INDEX: %d  FOUND ;;;;;;;;;;;;;;;;;;\n", (int)*framenumber, (int)index );
-        }
-        GVA_fcache_mutex_unlock (gvahand);
+  if((index < 0) || (index >= fcache->frame_cache_size))
+  {
+    if(gap_debug)
+    {
+      printf("GVA_search_fcache_by_index: INDEX: %d  NOT FOUND (ring done) ************\n", (int)index );
+    }
+    GVA_fcache_mutex_unlock (gvahand);
 
-        return(GVA_RET_OK);  /* OK */
-      }
+    return (GVA_RET_EOF);  /* index is beyond the ringlist */
+  }
 
-      /* try to get framedata from fcache ringlist,
-       * by stepping backwards the frames that were read before
-       */
-      fc_ptr = (t_GVA_Frame_Cache_Elem  *)fc_ptr->prev;
+  /* the ring order is the same as the array order,
+   * stepping backwards index times from the current element is plain index arithmetic
+   */
+  fc_ptr = &fcache->fc_elems[((fcache->fc_current - fcache->fc_elems) - index + fcache->frame_cache_size)
+                             % fcache->frame_cache_size];
 
-      if(fcache->fc_current == fc_ptr)
-      {
-        if(gap_debug)
-        {
-          printf("GVA_search_fcache_by_index: INDEX: %d  NOT FOUND (ring done) ************\n", (int)index );
-        }
-        GVA_fcache_mutex_unlock (gvahand);
+  *framenumber = fc_ptr->framenumber;
+  if(fc_ptr->framenumber < 0)
+  {
+    if(gap_debug)
+    {
+      printf("GVA_search_fcache_by_index: INDEX: %d  NOT FOUND (fnum < 0) ###########\n", (int)index );
+    }
 
-        return (GVA_RET_EOF);  /* STOP, we are back at startpoint of the ringlist */
-      }
-      if(fc_ptr == NULL)
-      {
-        GVA_fcache_mutex_unlock (gvahand);
+    GVA_fcache_mutex_unlock (gvahand);
 
-        return (GVA_RET_ERROR);  /* internal error, ringlist is broken */
-      }
-    }
+    return (GVA_RET_EOF);
   }
+  gvahand->fc_frame_data = fc_ptr->frame_data;  /* framedata of cached frame */
+  gvahand->fc_row_pointers = fc_ptr->row_pointers;
 
+  if(gap_debug)
+  {
+    printf("GVA_search_fcache_by_index: fnum; %d INDEX: %d  FOUND ;;;;;;;;;;;;;;;;;;\n", (int)*framenumber, (int)index );
+  }
   GVA_fcache_mutex_unlock (gvahand);
 
-  /* ringlist not found */
-  return (GVA_RET_ERROR);
+  return(GVA_RET_OK);  /* OK */
 
 }  /* end GVA_search_fcache_by_index */
 
@@ -880,8 +1008,9 @@ GVA_search_fcache_and_get_frame_as_gimp_layer_or_rgb888(t_GVA_Handle *gvahand
   fcache = &gvahand->fcache;
   if(fcache->fc_current)
   {
-    fc_ptr = (t_GVA_Frame_Cache_Elem  *)fcache->fc_current;
-    while(1 == 1)
+    /* lookup the framenumber in the fcache index (instead of stepping through the ringlist) */
+    fc_ptr = p_frame_cache_lookup(fcache, framenumber);
+    if(fc_ptr != NULL)
     {
       if(framenumber == fc_ptr->framenumber)
       {
@@ -1138,21 +1267,6 @@ GVA_search_fcache_and_get_frame_as_gimp_layer_or_rgb888(t_GVA_Handle *gvahand
           return;
         }
       }
-
-      /* try to get framedata from fcache ringlist,
-       * by stepping backwards the frames that were read before
-       */
-      fc_ptr = (t_GVA_Frame_Cache_Elem  *)fc_ptr->prev;
-
-      if(fcache->fc_current == fc_ptr)
-      {
-        break;  /* STOP, we are back at startpoint of the ringlist */
-      }
-      if(fc_ptr == NULL)
-      {
-        printf("** ERROR in GVA_search_fcache_and_get_frame_as_gimp_layer ringlist broken \n");
-        break;  /* internal error, ringlist is broken */
-      }
     }
   }
 
@@ -1728,6 +1842,17 @@ p_gva_worker_close(t_GVA_Handle  *gvahand)
       GVA_copy_or_delace_print_statistics();
       GAP_TIMM_PRINT_RECORD(&gvahand->fcacheMutexLockStats, nameMutexLockStats);
       g_free(nameMutexLockStats);
+
+      if(gap_debug)
+      {
+        printf("GVA: gvahand:%d fcache statistics hits:%d misses:%d evictions:%d size:%d\n"
+           , (int)gvahand
+           , (int)gvahand->fcache.hits
+           , (int)gvahand->fcache.misses
+           , (int)gvahand->fcache.evictions
+           , (int)gvahand->fcache.frame_cache_size
+           );
+      }
       
       (*dec_elem->fptr_close)(gvahand);
 
@@ -1745,6 +1870,16 @@ p_gva_worker_close(t_GVA_Handle  *gvahand)
          g_free(gvahand->filename);
          gvahand->filename = NULL;
       }
+      if(gvahand->diskcache_key)
+      {
+         g_free(gvahand->diskcache_key);
+         gvahand->diskcache_key = NULL;
+  gvahand->diskcache_pos_exact = TRUE;
+      }
+      if(gap_debug)
+      {
+        GVA_diskcache_print_statistics();
+      }
 
       /* free image buffer and row_pointers */
       p_drop_frame_cache(gvahand);
@@ -1786,18 +1921,13 @@ p_gva_worker_get_next_frame(t_GVA_Handle  *gvahand)
       if(fcache->fc_current)
       {
         t_GVA_Frame_Cache_Elem *fc_current;
+        guchar                 *diskcache_frame_data;
+        gint32                  diskcache_framenumber;
 
-        /* if fcache framenumber is negative, we can reuse
-         * that EMPTY element without advance
+        /* advance current write position to next element in the fcache ringlist
+         * (or reuse the current element if it is EMPTY)
          */
-        if(fcache->fc_current->framenumber >= 0)
-        {
-          /* advance current write position to next element in the fcache ringlist */
-          fcache->fc_current = fcache->fc_current->next;
-          fcache->fc_current->framenumber = -1;
-          gvahand->frame_data = fcache->fc_current->frame_data;
-          gvahand->row_pointers = fcache->fc_current->row_pointers;
-        }
+        p_frame_cache_advance(gvahand);
         
         fc_current = fcache->fc_current;
 
@@ -1808,10 +1938,30 @@ p_gva_worker_get_next_frame(t_GVA_Handle  *gvahand)
 
         GVA_fcache_mutex_lock (gvahand);
 
+        diskcache_frame_data = NULL;
+        diskcache_framenumber = gvahand->current_frame_nr;
         if (l_rc == GVA_RET_OK)
         {
-          fc_current->framenumber = gvahand->current_frame_nr;
+          p_frame_cache_set_framenumber(fcache, fc_current, gvahand->current_frame_nr);
+          if ((gvahand->diskcache_key != NULL) && (gvahand->diskcache_pos_exact))
+          {
+            /* copy the decoded frame while the fcache is locked
+             * (the fcache element may be reused by another thread after unlock)
+             */
+            diskcache_frame_data = g_memdup(fc_current->frame_data
+                                           , gvahand->width * gvahand->height * gvahand->frame_bpp);
+          }
         }
+        fcache->fcache_locked = FALSE;
+        GVA_fcache_mutex_unlock (gvahand);
+
+        if (diskcache_frame_data != NULL)
+        {
+          /* keep a copy of the decoded frame in the persistent diskcache */
+          GVA_diskcache_store_frame(gvahand, diskcache_framenumber, diskcache_frame_data);
+          g_free(diskcache_frame_data);
+        }
+        return(l_rc);
       }
       fcache->fcache_locked = FALSE;
       GVA_fcache_mutex_unlock (gvahand);
@@ -1850,29 +2000,18 @@ p_gva_worker_seek_frame(t_GVA_Handle  *gvahand, gdouble pos, t_GVA_PosUnit pos_u
 
       GVA_fcache_mutex_lock (gvahand);
 
-      if(fcache->fc_current)
-      {
-        /* if fcache framenumber is negative, we can reuse
-         * that EMPTY element without advance
-         */
-        if(fcache->fc_current->framenumber >= 0)
-        {
-          /* advance current write position to next element in the fcache ringlist
-           * Some of the seek procedure implementations do dummy reads
-           * therefore we provide a fcache element, but leave the
-           * framenumber -1 because this element is invalid in most cases
-           */
-          fcache->fc_current = fcache->fc_current->next;
-          fcache->fc_current->framenumber = -1;
-          gvahand->frame_data = fcache->fc_current->frame_data;
-          gvahand->row_pointers = fcache->fc_current->row_pointers;
-        }
-      }
+      /* advance current write position to next element in the fcache ringlist
+       * Some of the seek procedure implementations do dummy reads
+       * therefore we provide a fcache element, but leave the
+       * framenumber -1 because this element is invalid in most cases
+       */
+      p_frame_cache_advance(gvahand);
 
       GVA_fcache_mutex_unlock (gvahand);
         
       /* CALL decoder specific implementation of SEEK_FRAME procedure */
       l_rc = (*dec_elem->fptr_seek_frame)(gvahand, pos, pos_unit);
+      gvahand->diskcache_pos_exact = p_diskcache_seek_is_exact(gvahand, l_rc);
       fcache->fcache_locked = FALSE;
     }
   }
@@ -2128,6 +2267,14 @@ p_gva_worker_open_read(const char *filename, gint32 vid_track, gint32 aud_track
   gvahand->fcache.frame_cache_size = 0;
   gvahand->fcache.max_fcache_id = 0;
   gvahand->fcache.fcache_locked = FALSE;
+  gvahand->fcache.fc_elems = NULL;
+  gvahand->fcache.fc_slab = NULL;
+  gvahand->fcache.fc_row_slab = NULL;
+  gvahand->fcache.fc_elem_bytes = 0;
+  gvahand->fcache.fc_index = NULL;
+  gvahand->fcache.hits = 0;
+  gvahand->fcache.misses = 0;
+  gvahand->fcache.evictions = 0;
   gvahand->image_id = -1;
   gvahand->layer_id = -1;
   gvahand->disable_mmx = disable_mmx;
@@ -2156,6 +2303,7 @@ p_gva_worker_open_read(const char *filename, gint32 vid_track, gint32 aud_track
   gvahand->gva_thread_save = TRUE;  /* default for most decoder libs */
   gvahand->fcache_mutex = NULL;     /* per default do not use g_mutex_lock / g_mutex_unlock at fcache access */
   gvahand->user_data = NULL;        /* reserved for user data */
+  gvahand->diskcache_key = NULL;
   
   GAP_TIMM_INIT_RECORD(&gvahand->fcacheMutexLockStats);
 
@@ -2246,6 +2394,9 @@ p_gva_worker_open_read(const char *filename, gint32 vid_track, gint32 aud_track
   gvahand->vid_track = CLAMP(gvahand->vid_track, 0, gvahand->vtracks-1);
   gvahand->aud_track = CLAMP(gvahand->aud_track, 0, gvahand->atracks-1);
 
+  /* prepare key for the persistent frame diskcache (if configured in gimprc) */
+  p_diskcache_init_handle(gvahand);
+
   if(gap_debug) printf("END OF p_gva_worker_open_read: vtracks:%d atracks:%d\n", (int)gvahand->vtracks, (int)gvahand->atracks );
 
   return (gvahand);
@@ -3102,6 +3253,26 @@ GVA_frame_to_gimp_layer_2(t_GVA_Handle *gvahand
 
   GVA_fcache_mutex_lock (gvahand);
 
+  /* lookup the frame again while locked
+   * (the fcache slab may have been reallocated by a resize since GVA_search_fcache)
+   */
+  {
+    t_GVA_Frame_Cache_Elem  *fc_ptr;
+
+    fc_ptr = NULL;
+    if(gvahand->fcache.fc_current != NULL)
+    {
+      fc_ptr = p_frame_cache_lookup(&gvahand->fcache, framenumber);
+    }
+    if(fc_ptr == NULL)
+    {
+      GVA_fcache_mutex_unlock (gvahand);
+      return (-2);
+    }
+    gvahand->fc_frame_data = fc_ptr->frame_data;
+    gvahand->fc_row_pointers = fc_ptr->row_pointers;
+  }
+
   /* expand threshold range from 0.0-1.0  to 0 - MIX_MAX_THRESHOLD */
   threshold = CLAMP(threshold, 0.0, 1.0);
   l_threshold = (gdouble)MIX_MAX_THRESHOLD * (threshold * threshold * threshold);
@@ -3316,6 +3487,8 @@ GVA_fcache_to_gimp_image(t_GVA_Handle *gvahand
   t_GVA_Frame_Cache *fcache;
   t_GVA_Frame_Cache_Elem  *fc_ptr;
   t_GVA_Frame_Cache_Elem  *fc_minframe;
+  GArray  *framenumbers;
+  guint    ii;
   gint32   image_id;
   gint32   layer_id;
   gboolean delete_mode;
@@ -3363,6 +3536,12 @@ GVA_fcache_to_gimp_image(t_GVA_Handle *gvahand
     }
   }
 
+  /* collect the framenumbers in the requested range while the fcache is locked.
+   * the layers are created after unlock, referring to the frames by framenumber only.
+   * (no fcache element pointers are kept across unlock,
+   * because the fcache slab may be reallocated by a concurrent resize)
+   */
+  framenumbers = g_array_new(FALSE, FALSE, sizeof(gint32));
   if(fc_minframe)
   {
     fc_ptr = (t_GVA_Frame_Cache_Elem  *)fc_minframe;
@@ -3372,19 +3551,7 @@ GVA_fcache_to_gimp_image(t_GVA_Handle *gvahand
       &&((fc_ptr->framenumber <= max_framenumber) || (max_framenumber < 0))
       && (fc_ptr->framenumber >= 0))
       {
-          GVA_fcache_mutex_unlock (gvahand);
-
-          GVA_frame_to_gimp_layer_2(gvahand
-                  , &image_id
-                  , layer_id
-                  , delete_mode
-                  , fc_ptr->framenumber
-                  , deinterlace
-                  , threshold
-                  );
-           delete_mode = FALSE;  /* keep old layers */
-
-           GVA_fcache_mutex_lock (gvahand);
+        g_array_append_val(framenumbers, fc_ptr->framenumber);
       }
 
       /* step from fc_minframe forward in the fcache ringlist,
@@ -3394,19 +3561,31 @@ GVA_fcache_to_gimp_image(t_GVA_Handle *gvahand
 
       if(fc_minframe == fc_ptr)
       {
-        GVA_fcache_mutex_unlock (gvahand);
-        return (image_id);  /* STOP, we are back at startpoint of the ringlist */
+        break;  /* STOP, we are back at startpoint of the ringlist */
       }
       if(fc_ptr == NULL)
       {
-        GVA_fcache_mutex_unlock (gvahand);
-        return (image_id);  /* internal error, ringlist is broken */
+        break;  /* internal error, ringlist is broken */
       }
     }
   }
 
   GVA_fcache_mutex_unlock (gvahand);
 
+  for(ii = 0; ii < framenumbers->len; ii++)
+  {
+    GVA_frame_to_gimp_layer_2(gvahand
+            , &image_id
+            , layer_id
+            , delete_mode
+            , g_array_index(framenumbers, gint32, ii)
+            , deinterlace
+            , threshold
+            );
+    delete_mode = FALSE;  /* keep old layers */
+  }
+  g_array_free(framenumbers, TRUE);
+
   return image_id;
 }  /* end GVA_fcache_to_gimp_image */
 
@@ -3674,6 +3853,7 @@ GVA_frame_to_buffer(t_GVA_Handle *gvahand
  * This procedure does fetch the specified framenumber from a videofile
  * and returns a buffer of RGB (or RGBA) encoded pixeldata.
  * (it does first search the API internal framecache,
+ *  then the persistent diskcache (if configured)
  *  then tries to read from the videofile (if not found in the framecahe)
  *
  * the returned data is a (optional downscaled) copy of the API internal frame data
@@ -3728,6 +3908,23 @@ GVA_fetch_frame_to_buffer(t_GVA_Handle *gvahand
              , height
              );
 
+  if(frame_data == NULL)
+  {
+    /* check the persistent diskcache before decoding */
+    if(GVA_diskcache_fetch_to_fcache(gvahand, framenumber) == TRUE)
+    {
+      frame_data = GVA_frame_to_buffer(gvahand
+                 , do_scale
+                 , framenumber
+                 , deinterlace
+                 , threshold
+                 , bpp
+                 , width
+                 , height
+                 );
+    }
+  }
+
   if(frame_data == NULL)
   {
     gint32 l_delta;
@@ -112,8 +112,8 @@ typedef struct t_GVA_Frame_Cache_Elem
 {
    gint32  id;             /* element identifier */
    gint32  framenumber;    /* -1 is the mark for unused elements */
-   guchar *frame_data;     /* uncompressed framedata */
-   guchar **row_pointers;  /* array of pointers to each row of the frame_data */
+   guchar *frame_data;     /* uncompressed framedata (points into the fc_slab) */
+   guchar **row_pointers;  /* array of pointers to each row of the frame_data (points into the fc_row_slab) */
    void *prev;
    void *next;
 } t_GVA_Frame_Cache_Elem;
@@ -124,8 +124,27 @@ typedef struct t_GVA_Frame_Cache
   gint32            frame_cache_size;  /* number of frames in the cache */
   gint32            max_fcache_id;
   gboolean          fcache_locked;     /* TRUE whilw SEEK_FRAME and GET_NEXT_FRAME operations in progress */
+
+  /* PRIVATE members (dont change this outside the API !) */
+  t_GVA_Frame_Cache_Elem *fc_elems;    /* array of frame_cache_size elements (ring order == array order) */
+  guchar           *fc_slab;           /* frame_data of all elements in one contiguous buffer */
+  guchar          **fc_row_slab;       /* row_pointers of all elements in one contiguous buffer */
+  gint32            fc_elem_bytes;     /* bytes per element in the fc_slab */
+  GHashTable       *fc_index;          /* maps framenumber to the (valid) element holding that frame */
+
+  gint32            hits;              /* statistics (see GVA_get_fcache_statistics) */
+  gint32            misses;
+  gint32            evictions;
 } t_GVA_Frame_Cache;
 
+typedef struct GVA_fcache_statistics {
+  gint32     hits;                    /* number of lookups that found the frame in the fcache */
+  gint32     misses;                  /* number of lookups that did not find the frame */
+  gint32     evictions;               /* number of cached frames that were overwritten or dropped */
+  gint32     cached_frames;           /* number of elements currently holding a valid frame */
+  gint32     size_in_elements;        /* number of allocated elements */
+} GVA_fcache_statistics;
+
 
 typedef struct GVA_RgbPixelBuffer
 {
@@ -330,6 +349,12 @@ typedef struct t_GVA_Handle  /* nickname: gvahand */
 
   gpointer user_data;         /* is set to NULL at open and is not internally used by GVA procedures */
 
+  char    *diskcache_key;     /* PRIVATE: key prefix for the persistent frame diskcache (NULL if diskcache is off) */
+  gboolean diskcache_pos_exact; /* PRIVATE: TRUE while current_frame_nr is known to be exact
+                                 * (sequential reads from the start, emulated or videoindex based seek)
+                                 * decoded frames are stored in the diskcache only in this state.
+                                 */
+
 } t_GVA_Handle;
 
 typedef enum
@@ -423,6 +448,9 @@ void            GVA_set_fcache_size(t_GVA_Handle *gvahand
                  );
 gint32          GVA_get_fcache_size_in_elements(t_GVA_Handle *gvahand);
 gint32          GVA_get_fcache_size_in_bytes(t_GVA_Handle *gvahand);
+void            GVA_get_fcache_statistics(t_GVA_Handle *gvahand
+                 , GVA_fcache_statistics *stats
+                 );
 
 
 t_GVA_RetCode   GVA_search_fcache(t_GVA_Handle *gvahand
@@ -450,6 +478,17 @@ void           GVA_search_fcache_and_get_frame_as_gimp_layer_or_rgb888(t_GVA_Han
 //                  );
 
 
+/* persistent diskcache for decoded frames (see gap_vid_api_diskcache.c) */
+gboolean        GVA_diskcache_fetch_to_fcache(t_GVA_Handle *gvahand
+                 , gint32 framenumber
+                 );
+void            GVA_diskcache_store_frame(t_GVA_Handle *gvahand
+                 , gint32 framenumber
+                 , const guchar *frame_data
+                 );
+void            GVA_diskcache_print_statistics(void);
+
+
 gboolean        GVA_fcache_mutex_trylock(t_GVA_Handle  *gvahand);
 void            GVA_fcache_mutex_lock(t_GVA_Handle  *gvahand);
 void            GVA_fcache_mutex_unlock(t_GVA_Handle  *gvahand);
@@ -0,0 +1,389 @@
+/* gap_vid_api_diskcache.c
+ *
+ * GAP Video read API persistent diskcache for decoded frames.
+ *
+ * The diskcache keeps decoded videoframes (at original size and bpp
+ * as delivered by the decoder, before deinterlacing) as files in a cache directory,
+ * so that they are shared between the player, the storyboard processor
+ * and the video encoders, and survive the end of the process.
+ *
+ * Each frame is stored in one file that is named by the MD5 checksum
+ * of its key. The key is built from videofile (uri), mtime of the videofile,
+ * videotrack, decoder name and framenumber. The full key is also stored
+ * in the file header and is verified at read access.
+ *
+ * The total size of the diskcache is limited by the gimprc parameter
+ *   (video-frame-diskcache-size "0")     size in MB, 0 turns the diskcache off (default)
+ * the directory can be configured via
+ *   (video-frame-diskcache-dir "/path/to/dir")    default is gvaframecache in the gimp directory.
+ * When the limit is exceeded the least recently used frames are removed
+ * (the mtime of the cache files is updated at each read access).
+ *
+ * The cache directory handling (configuration, header verification,
+ * size accounting and LRU eviction) is shared with the storyboard
+ * composite cache, see libgapbase/gap_file_cache.c
+ *
+ * Frames are stored only while the decoder position of the handle is exact
+ * (see p_diskcache_seek_is_exact), because approximate seek ops may deliver
+ * a neighbour frame under the requested framenumber.
+ *
+ * 2026.10.18  created
+ * 2026.10.18  - store frames only at exact decoder positions
+ */
+
+#define GVA_DISKCACHE_MAGIC          "GVAFC001"
+#define GVA_DISKCACHE_SUFFIX         ".gvafc"
+#define GVA_DISKCACHE_HDR_COUNT      3       /* width, height, bpp */
+
+
+static GStaticMutex diskcacheMutex = G_STATIC_MUTEX_INIT;
+static GapFileCache diskcacheFcd = GAP_FILE_CACHE_INITIALIZER("GVA diskcache"
+                                                             , GVA_DISKCACHE_SUFFIX
+                                                             , GVA_DISKCACHE_MAGIC
+                                                             );
+static gint32       diskcacheHits = 0;
+static gint32       diskcacheStores = 0;
+
+
+/* ------------------------------
+ * p_diskcache_init_config
+ * ------------------------------
+ * read the diskcache configuration from gimprc.
+ * Note: this procedure must be called from the main thread
+ * (gimprc queries are PDB calls). It is called at video open time.
+ */
+static void
+p_diskcache_init_config(void)
+{
+  gap_file_cache_init_config(&diskcacheFcd
+                            , "video-frame-diskcache-size"
+                            , "video-frame-diskcache-dir"
+                            , "gvaframecache"
+                            , 0     /* default: diskcache is off */
+                            );
+}  /* end p_diskcache_init_config */
+
+
+/* ------------------------------
+ * p_diskcache_is_enabled
+ * ------------------------------
+ */
+static gboolean
+p_diskcache_is_enabled(void)
+{
+  return (gap_file_cache_is_enabled(&diskcacheFcd));
+}  /* end p_diskcache_is_enabled */
+
+
+/* ------------------------------
+ * p_diskcache_init_handle
+ * ------------------------------
+ * build the handle specific part of the diskcache key
+ * (called after successful open of the videofile)
+ */
+static void
+p_diskcache_init_handle(t_GVA_Handle *gvahand)
+{
+  t_GVA_DecoderElem *dec_elem;
+  gchar             *uri;
+
+  gvahand->diskcache_key = NULL;
+  p_diskcache_init_config();
+  if(p_diskcache_is_enabled() != TRUE)
+  {
+    return;
+  }
+
+  dec_elem = (t_GVA_DecoderElem *)gvahand->dec_elem;
+  uri = GVA_filename_to_uri(gvahand->filename);
+  if((uri == NULL) || (dec_elem == NULL))
+  {
+    g_free(uri);
+    return;
+  }
+
+  gvahand->diskcache_key = g_strdup_printf("[@GVAFRAME]:%d:%s:%d:%s"
+               , (int)gap_file_get_mtime(gvahand->filename)
+               , uri
+               , (int)gvahand->vid_track
+               , dec_elem->decoder_name
+               );
+  g_free(uri);
+
+}  /* end p_diskcache_init_handle */
+
+
+/* ------------------------------
+ * p_diskcache_seek_is_exact
+ * ------------------------------
+ * check if the decoder position after a seek op is exact.
+ * This is the case for seek ops that are emulated by reading all frames,
+ * a seek back to the start of the video, and videoindex based seek
+ * (the videoindex was created by counting all frames and is only
+ * used when no critical timecode steps were found).
+ * Native timecode based seek ops of the decoders may deliver
+ * a neighbour frame, frames decoded after such a seek
+ * are not stored in the diskcache until the handle is back at the start.
+ */
+static gboolean
+p_diskcache_seek_is_exact(t_GVA_Handle *gvahand, t_GVA_RetCode seek_rc)
+{
+  if(seek_rc != GVA_RET_OK)
+  {
+    return (FALSE);
+  }
+  if((gvahand->emulate_seek) || (gvahand->current_seek_nr <= 1))
+  {
+    return (TRUE);
+  }
+  if((gvahand->vindex != NULL)
+  && (gvahand->vindex->tabsize_used > 0)
+  && (gvahand->critical_timecodesteps_found != TRUE))
+  {
+    return (TRUE);
+  }
+
+  if(gap_debug)
+  {
+    printf("p_diskcache_seek_is_exact: approximate position seek_nr:%d, diskcache store is off for %s\n"
+          , (int)gvahand->current_seek_nr
+          , gvahand->filename
+          );
+  }
+  return (FALSE);
+
+}  /* end p_diskcache_seek_is_exact */
+
+
+/* ------------------------------
+ * p_diskcache_build_filename
+ * ------------------------------
+ * return the name of the diskcache file for the specified frame
+ * and set *key to the full key (the caller must g_free both strings)
+ */
+static gchar *
+p_diskcache_build_filename(t_GVA_Handle *gvahand, gint32 framenumber, gchar **key)
+{
+  gchar  name[40];
+
+  *key = g_strdup_printf("%s:%06d", gvahand->diskcache_key, (int)framenumber);
+  GVA_md5_string(name, *key);
+
+  return (gap_file_cache_build_filename(&diskcacheFcd, name));
+}  /* end p_diskcache_build_filename */
+
+
+/* ------------------------------
+ * GVA_diskcache_fetch_to_fcache
+ * ------------------------------
+ * check if the specified frame is available in the persistent diskcache
+ * and load it into the GVA fcache (as if it was decoded).
+ * The cache file is read via memory mapping and copied directly into
+ * the next fcache element. The decoder position (current_frame_nr, current_seek_nr)
+ * is not changed.
+ *
+ * return TRUE if the frame is now available in the fcache.
+ */
+gboolean
+GVA_diskcache_fetch_to_fcache(t_GVA_Handle *gvahand, gint32 framenumber)
+{
+  GMappedFile       *mapped;
+  t_GVA_Frame_Cache *fcache;
+  gchar             *filename;
+  gchar             *key;
+  const guchar      *frame_data;
+  gint32             hdr[GVA_DISKCACHE_HDR_COUNT];
+  gint32             frameSize;
+  gboolean           isLoaded;
+
+  static gint32 funcId = -1;
+
+  if((gvahand == NULL) || (gvahand->diskcache_key == NULL) || (framenumber < 1))
+  {
+    return (FALSE);
+  }
+  if(gvahand->fcache.fcache_locked)
+  {
+    return (FALSE);  /* dont touch the fcache while locked */
+  }
+
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "GVA_diskcache_fetch_to_fcache");
+
+  filename = p_diskcache_build_filename(gvahand, framenumber, &key);
+  mapped = g_mapped_file_new(filename, FALSE, NULL);
+  if(mapped == NULL)
+  {
+    g_free(filename);
+    g_free(key);
+    return (FALSE);
+  }
+
+  GAP_TIMM_START_FUNCTION(funcId);
+
+  isLoaded = FALSE;
+  frameSize = gvahand->width * gvahand->height * gvahand->frame_bpp;
+  hdr[0] = gvahand->width;
+  hdr[1] = gvahand->height;
+  hdr[2] = gvahand->frame_bpp;
+
+  /* header: magic, width, height, bpp, keylen, key, framedata */
+  frame_data = gap_file_cache_check_contents(&diskcacheFcd
+                         , g_mapped_file_get_contents(mapped)
+                         , g_mapped_file_get_length(mapped)
+                         , hdr, GVA_DISKCACHE_HDR_COUNT
+                         , key
+                         , frameSize
+                         );
+  if(frame_data != NULL)
+  {
+    fcache = &gvahand->fcache;
+    GVA_fcache_mutex_lock (gvahand);
+    if((fcache->fcache_locked != TRUE)
+    && (fcache->fc_current != NULL)
+    && (fcache->fc_index != NULL))
+    {
+      if(g_hash_table_lookup(fcache->fc_index, GINT_TO_POINTER(framenumber)) == NULL)
+      {
+        /* store the frame in the next fcache element (same as get_next_frame would do) */
+        p_frame_cache_advance(gvahand);
+        memcpy(fcache->fc_current->frame_data, frame_data, frameSize);
+        p_frame_cache_set_framenumber(fcache, fcache->fc_current, framenumber);
+      }
+      isLoaded = TRUE;
+    }
+    GVA_fcache_mutex_unlock (gvahand);
+  }
+
+#if GLIB_CHECK_VERSION(2, 22, 0)
+  g_mapped_file_unref(mapped);
+#else
+  g_mapped_file_free(mapped);
+#endif
+
+  if(isLoaded)
+  {
+    /* update mtime of the cache file (mtime is used as last access time for LRU eviction) */
+    g_utime(filename, NULL);
+
+    g_static_mutex_lock(&diskcacheMutex);
+    diskcacheHits++;
+    g_static_mutex_unlock(&diskcacheMutex);
+  }
+
+  if(gap_debug)
+  {
+    printf("GVA_diskcache_fetch_to_fcache: framenumber:%d isLoaded:%d file:%s\n"
+          , (int)framenumber
+          , (int)isLoaded
+          , filename
+          );
+  }
+
+  g_free(filename);
+  g_free(key);
+
+  GAP_TIMM_STOP_FUNCTION(funcId);
+
+  return (isLoaded);
+
+}  /* end GVA_diskcache_fetch_to_fcache */
+
+
+/* ------------------------------
+ * GVA_diskcache_store_frame
+ * ------------------------------
+ * write the specified (already decoded) frame to the persistent diskcache
+ * (nothing is done if the diskcache is turned off or the frame is already stored).
+ * frame_data must be at the size and bpp of the videohandle.
+ * The caller must make sure that framenumber is exact
+ * (see diskcache_pos_exact of the handle).
+ * The frame is written to a temporary file that is renamed when complete
+ * (see gap_file_cache_write_file), so that readers never see partial written cache files.
+ * The least recently used frames are removed when the size limit is exceeded.
+ */
+void
+GVA_diskcache_store_frame(t_GVA_Handle *gvahand, gint32 framenumber, const guchar *frame_data)
+{
+  gchar  *filename;
+  gchar  *key;
+  gint32  hdr[GVA_DISKCACHE_HDR_COUNT];
+  gint32  frameSize;
+  gboolean isWritten;
+
+  static gint32 funcId = -1;
+
+  if((gvahand == NULL) || (gvahand->diskcache_key == NULL)
+  || (framenumber < 1) || (frame_data == NULL))
+  {
+    return;
+  }
+
+  filename = p_diskcache_build_filename(gvahand, framenumber, &key);
+  if(g_file_test(filename, G_FILE_TEST_EXISTS))
+  {
+    g_free(filename);
+    g_free(key);
+    return;
+  }
+
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "GVA_diskcache_store_frame");
+  GAP_TIMM_START_FUNCTION(funcId);
+
+  frameSize = gvahand->width * gvahand->height * gvahand->frame_bpp;
+  hdr[0] = gvahand->width;
+  hdr[1] = gvahand->height;
+  hdr[2] = gvahand->frame_bpp;
+
+  isWritten = gap_file_cache_write_file(&diskcacheFcd
+                         , filename
+                         , hdr, GVA_DISKCACHE_HDR_COUNT
+                         , key
+                         , frame_data, frameSize
+                         );
+  if(isWritten)
+  {
+    g_static_mutex_lock(&diskcacheMutex);
+
+    diskcacheStores++;
+    gap_file_cache_add_stored_bytes(&diskcacheFcd
+                         , gap_file_cache_get_file_size(GVA_DISKCACHE_HDR_COUNT, key, frameSize)
+                         );
+
+    g_static_mutex_unlock(&diskcacheMutex);
+  }
+
+  if(gap_debug)
+  {
+    printf("GVA_diskcache_store_frame: framenumber:%d isWritten:%d file:%s\n"
+          , (int)framenumber
+          , (int)isWritten
+          , filename
+          );
+  }
+
+  g_free(filename);
+  g_free(key);
+
+  GAP_TIMM_STOP_FUNCTION(funcId);
+
+}  /* end GVA_diskcache_store_frame */
+
+
+/* ------------------------------
+ * GVA_diskcache_print_statistics
+ * ------------------------------
+ */
+void
+GVA_diskcache_print_statistics(void)
+{
+  if(p_diskcache_is_enabled())
+  {
+    printf("GVA diskcache: hits:%d stores:%d total size:%.1f MB (limit:%d MB) dir:%s\n"
+          , (int)diskcacheHits
+          , (int)diskcacheStores
+          , (float)MAX(0, diskcacheFcd.totalBytes) / (1024.0 * 1024.0)
+          , (int)diskcacheFcd.maxMB
+          , diskcacheFcd.dir
+          );
+  }
+}  /* end GVA_diskcache_print_statistics */
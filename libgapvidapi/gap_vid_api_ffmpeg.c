@@ -3,6 +3,10 @@
  * GAP Video read API implementation of libavformat/lbavcodec (also known as FFMPEG)
  * based wrappers to read various videofile formats
  *
+ * 2026.10.18   avcodec_open/avcodec_close/av_find_stream_info serialized by codecMutex
+ *              (the player read-ahead thread opens its own handle in parallel to the main thread)
+ *              and no static state in the vindex creation (allows parallel count_frames on different handles)
+ *              count_frames skips the seek self test when it already did run on the handle
  * 2010.07.31   update to support both ffmpeg-0.5 and ffmpeg-0.6
  * 2007.11.04   update to ffmpeg svn snapshot 2007.10.31
  *                bugfix: selftest sometimes did not detect variable timecodes.
@@ -197,6 +201,8 @@ typedef struct t_GVA_ffmpeg
  gboolean           continueAfterReadErrors;   /* default TRUE try to to continue reading next frame after read errors */
  gint32             libavcodec_version_int;    /* the ffmpeg libs version that was used to analyze the current video as integer LIBAVCODEC_VERSION_INT */
  gint64             pkt1_dts;                  /* dts timecode offset of the 1st package of the current frame */
+ int64_t            tclog_old_pts;             /* previous pts written to the timecode log */
+ int64_t            tclog_old_dts;             /* previous dts written to the timecode log */
 
 } t_GVA_ffmpeg;
 
@@ -270,6 +276,62 @@ static          t_GVA_RetCode   p_wrapper_ffmpeg_seek_frame(t_GVA_Handle *gvahan
 static          t_GVA_RetCode   p_wrapper_ffmpeg_get_next_frame(t_GVA_Handle *gvahand);
 static          t_GVA_RetCode   p_private_ffmpeg_get_next_frame(t_GVA_Handle *gvahand, gboolean do_copy_raw_chunk_data);
 
+/* avcodec_open and avcodec_close are not thread safe
+ * (av_find_stream_info opens and closes the codecs of the streams internally).
+ * the codecMutex serializes those calls for handles that are
+ * used in parallel threads (e.g. the player read-ahead thread
+ * and parallel video index creation)
+ */
+static GStaticMutex codecMutex = G_STATIC_MUTEX_INIT;
+
+/* -----------------------------
+ * p_avcodec_open_locked
+ * -----------------------------
+ */
+static int
+p_avcodec_open_locked(AVCodecContext *codec_context, AVCodec *codec)
+{
+  int ret;
+
+  g_static_mutex_lock(&codecMutex);
+  ret = avcodec_open(codec_context, codec);
+  g_static_mutex_unlock(&codecMutex);
+
+  return (ret);
+}  /* end p_avcodec_open_locked */
+
+/* -----------------------------
+ * p_avcodec_close_locked
+ * -----------------------------
+ */
+static int
+p_avcodec_close_locked(AVCodecContext *codec_context)
+{
+  int ret;
+
+  g_static_mutex_lock(&codecMutex);
+  ret = avcodec_close(codec_context);
+  g_static_mutex_unlock(&codecMutex);
+
+  return (ret);
+}  /* end p_avcodec_close_locked */
+
+/* -----------------------------
+ * p_av_find_stream_info_locked
+ * -----------------------------
+ */
+static int
+p_av_find_stream_info_locked(AVFormatContext *ic)
+{
+  int ret;
+
+  g_static_mutex_lock(&codecMutex);
+  ret = av_find_stream_info(ic);
+  g_static_mutex_unlock(&codecMutex);
+
+  return (ret);
+}  /* end p_av_find_stream_info_locked */
+
 /* -----------------------------
  * p_wrapper_ffmpeg_check_sig
  * -----------------------------
@@ -308,7 +370,7 @@ p_wrapper_ffmpeg_check_sig(char *filename)
   /* If not enough info to get the stream parameters, we decode the
    * first frames to get it. (used in mpeg case for example)
    */
-  ret = av_find_stream_info(ic);
+  ret = p_av_find_stream_info_locked(ic);
   if (ret < 0)
   {
      if(gap_debug) printf("p_wrapper_ffmpeg_check_sig:%s: could not find codec parameters\n", filename);
@@ -358,6 +420,8 @@ p_wrapper_ffmpeg_open_read(char *filename, t_GVA_Handle *gvahand)
   handle->continueAfterReadErrors = gap_base_get_gimprc_gboolean_value(GIMPRC_CONTINUE_AFTER_READ_ERRORS, TRUE);
   handle->libavcodec_version_int = 0;
   handle->pkt1_dts = AV_NOPTS_VALUE;
+  handle->tclog_old_pts = AV_NOPTS_VALUE;
+  handle->tclog_old_dts = 0;
   handle->dummy_read = FALSE;
   handle->capture_offset = FALSE;
   handle->guess_gop_size = 0;
@@ -662,7 +726,7 @@ p_wrapper_ffmpeg_close(t_GVA_Handle *gvahand)
   {
     if(gap_debug) printf("p_wrapper_ffmpeg_close: avcodec_close VIDEO_CODEC: %s\n", handle->vcodec->name);
 
-    avcodec_close(handle->vid_codec_context);
+    p_avcodec_close_locked(handle->vid_codec_context);
     handle->vid_codec_context = NULL;
     /* ?????????? do not attempt to free handle->vid_codec_context (it points to &handle->vid_stream.codec) */
   }
@@ -671,7 +735,7 @@ p_wrapper_ffmpeg_close(t_GVA_Handle *gvahand)
   {
     if(gap_debug) printf("p_wrapper_ffmpeg_close: avcodec_close AUDIO_CODEC: %s\n", handle->acodec->name);
 
-    avcodec_close(handle->aud_codec_context);
+    p_avcodec_close_locked(handle->aud_codec_context);
     handle->aud_codec_context = NULL;
     /* ??????? do not attempt to free handle->aud_codec_context (it points to &handle->aud_stream.codec) */
   }
@@ -3351,11 +3415,23 @@ p_wrapper_ffmpeg_count_frames(t_GVA_Handle *gvahand)
   }
   gvahand->percentage_done = 0.0;
   persitent_analyse_available = FALSE;
+  master_handle = (t_GVA_ffmpeg*)gvahand->decoder_handle;
 
   if(gap_base_get_gimprc_gboolean_value(GIMPRC_PERSISTENT_ANALYSE, ANALYSE_DEFAULT))
   {
+    if (master_handle->timecode_proberead_done == TRUE)
+    {
+      /* the self test already did run on this handle
+       * (e.g. via GVA_check_seek_support in the videoindex creator)
+       * and has saved its results. Skip the 2nd run of probereads and seek tests.
+       */
+      persitent_analyse_available = TRUE;
+    }
+    else
+    {
       persitent_analyse_available = p_seek_timecode_reliability_self_test(gvahand);
-      gvahand->percentage_done = 0.0;
+    }
+    gvahand->percentage_done = 0.0;
   }
 
   if(gvahand->vindex == NULL)
@@ -3795,7 +3871,7 @@ p_ff_open_input(char *filename, t_GVA_Handle *gvahand, t_GVA_ffmpeg*  handle, gb
   /* If not enough info to get the stream parameters, we decode the
    * first frames to get it. (used in mpeg case for example)
    */
-  ret = av_find_stream_info(ic);
+  ret = p_av_find_stream_info_locked(ic);
   if (ret < 0)
   {
      if(gap_debug) printf("p_ff_open_input:%s: could not find codec parameters\n", filename);
@@ -3961,7 +4037,7 @@ p_ff_open_input(char *filename, t_GVA_Handle *gvahand, t_GVA_ffmpeg*  handle, gb
     if(handle->vcodec)
     {
       /* open codec  */
-      if (avcodec_open(handle->vid_codec_context, handle->vcodec) < 0)
+      if (p_avcodec_open_locked(handle->vid_codec_context, handle->vcodec) < 0)
       {
          printf("Error while opening video codec %s\n", handle->vcodec->name);
          return(FALSE);
@@ -3994,7 +4070,7 @@ p_ff_open_input(char *filename, t_GVA_Handle *gvahand, t_GVA_ffmpeg*  handle, gb
     }
     if(handle->acodec)
     {
-      if (avcodec_open(handle->aud_codec_context, handle->acodec) < 0)
+      if (p_avcodec_open_locked(handle->aud_codec_context, handle->acodec) < 0)
       {
          printf("** Error while opening audio codec %s\n", handle->acodec->name);
          return(FALSE);
@@ -4144,7 +4220,7 @@ p_ffmpeg_vid_reopen_read(t_GVA_ffmpeg *handle, t_GVA_Handle *gvahand)
     /* CLOSE the video codec */
     if((handle->vid_codec_context) && (handle->vcodec))
     {
-      avcodec_close(handle->vid_codec_context);
+      p_avcodec_close_locked(handle->vid_codec_context);
       handle->vid_codec_context = NULL;
     }
 
@@ -4208,7 +4284,7 @@ p_ffmpeg_aud_reopen_read(t_GVA_ffmpeg *handle, t_GVA_Handle *gvahand)
     /* CLOSE the audio codec */
     if((handle->aud_codec_context) && (handle->acodec))
     {
-      avcodec_close(handle->aud_codec_context);
+      p_avcodec_close_locked(handle->aud_codec_context);
       handle->aud_codec_context = NULL;
     }
 
@@ -4808,16 +4884,17 @@ p_vindex_add_url_offest(t_GVA_Handle *gvahand
                          , gint64 timecode_dts
                          )
 {
-  static gint64 s_last_seek_nr;
-
   if(vindex->tabsize_used > 0)
   {
-    if(seek_nr <= s_last_seek_nr)
+    /* the last recorded seek_nr is taken from the vindex table
+     * (not from a static variable, because more than one vindex
+     * may be created in parallel threads)
+     */
+    if(seek_nr <= vindex->ofs_tab[vindex->tabsize_used -1].seek_nr)
     {
       return;
     }
   }
-  s_last_seek_nr = seek_nr;
 
   if(vindex->tabsize_used >= vindex->tabsize_allocated -1)
   {
@@ -4997,8 +5074,6 @@ p_timecode_check_and_log(FILE *fp_timecode_log, gint32 framenr, t_GVA_ffmpeg *ha
 {
   static const char *ok_string = "";
   static const char *err_string = "; # CRITICAL exp - dts difference > 10";
-  static int64_t old_pts = AV_NOPTS_VALUE;
-  static int64_t old_dts = 0;
   const char *remark_ptr;
   int64_t expected_dts;
   int64_t diff_dts;
@@ -5026,11 +5101,11 @@ p_timecode_check_and_log(FILE *fp_timecode_log, gint32 framenr, t_GVA_ffmpeg *ha
           , framenr
           , expected_dts
           , handle->vid_pkt.dts
-          , handle->vid_pkt.dts - old_dts
+          , handle->vid_pkt.dts - handle->tclog_old_dts
           , expected_dts - handle->vid_pkt.dts
           );
 
-  old_dts = handle->vid_pkt.dts;
+  handle->tclog_old_dts = handle->vid_pkt.dts;
 
   if(handle->vid_pkt.pts != AV_NOPTS_VALUE)
   {
@@ -5040,13 +5115,13 @@ p_timecode_check_and_log(FILE *fp_timecode_log, gint32 framenr, t_GVA_ffmpeg *ha
           , handle->vid_pkt.pts - handle->vid_pkt.dts
           );
 
-    if (old_pts != AV_NOPTS_VALUE)
+    if (handle->tclog_old_pts != AV_NOPTS_VALUE)
     {
       fprintf(fp_timecode_log, "; pts-oldpts:%lld"
-          , handle->vid_pkt.pts - old_pts
+          , handle->vid_pkt.pts - handle->tclog_old_pts
           );
     }
-    old_pts = handle->vid_pkt.pts;
+    handle->tclog_old_pts = handle->vid_pkt.pts;
   }
   else
   {
@@ -11,6 +11,7 @@
  * but only if the decoder has an implementation for videoindex.
  * (the 1.st decoder with videoindex implementation is libavformat FFMPEG) 
  *
+ * 2026.10.18   hof thread safe index filenames (for parallel video index creation)
  * 2004.03.06   hof created
  *
  */
@@ -45,7 +46,7 @@ static char *
 p_build_gvaidx_filename(const char *filename, gint32 track, const char *decoder_name
   , const char *suffix)
 {
-  static gchar name[40];
+  gchar name[40];
   gchar *vindex_file;
   gchar *filename_part;
   gchar *uri;
@@ -67,7 +68,9 @@ p_build_gvaidx_filename(const char *filename, gint32 track, const char *decoder_
         , decoder_name
         , suffix
         );
+  gap_base_gimp_mutex_lock(NULL);
   gvaindexes_dir = gimp_gimprc_query("video-index-dir");
+  gap_base_gimp_mutex_unlock(NULL);
   if(gvaindexes_dir)
   {
     vindex_file = g_build_filename(gvaindexes_dir, filename_part, NULL);
@@ -156,7 +159,7 @@ p_equal_mtime(time_t mtime_idx, time_t mtime_file)
 char *
 GVA_build_video_toc_filename(const char *filename, const char *decoder_name)
 {
-  static gchar name[40];
+  gchar name[40];
   gchar *toc_file;
   gchar *filename_part;
   gchar *uri;
@@ -174,7 +177,9 @@ GVA_build_video_toc_filename(const char *filename, const char *decoder_name)
   }
   
   filename_part = g_strdup_printf("%s.%s.toc", name, decoder_name);
+  gap_base_gimp_mutex_lock(NULL);
   gvaindexes_dir = gimp_gimprc_query("video-index-dir");
+  gap_base_gimp_mutex_unlock(NULL);
   if(gvaindexes_dir)
   {
     toc_file = g_build_filename(gvaindexes_dir, filename_part, NULL);
@@ -47,21 +47,41 @@
 /* GAP includes */
 #include "gap_base.h"
 #include "gap_gve_raw.h"
+#include "gap_gve_raw_simd.h"
 
 
 /* the raw CODEC needs no extra LIB includes */
 
+#define GAP_GVE_MAX_THREADS 16
+#define GAP_GVE_MIN_ROWS_PER_THREAD 16
+
+typedef struct DrawableToRgbBufferJob DrawableToRgbBufferJob;
+
 typedef struct DrawableToRgbBufferProcessorData {  /* drgb */
-    GimpDrawable       *src_drawable;
+    DrawableToRgbBufferJob *job;
+    const guchar       *src_data;        /* drawable pixels fetched by the main thread (full frame size) */
+    gint32              src_bpp;
+    gint32              src_rowstride;
     GimpImageType       drawable_type;
     GapRgbPixelBuffer  *rgbBuffer;
-    gint                startCol;
-    gint                colWidth;
+    gint                startRow;
+    gint                rowHeight;
     gint                cpuId;
-    gboolean            isFinished;
+    gboolean            isStarted;       /* protected by job->doneMutex */
+    gboolean            isFinished;      /* protected by job->doneMutex */
     
 } DrawableToRgbBufferProcessorData;
 
+/* state of one gap_gve_drawable_to_RgbBuffer_multithread call
+ * (concurrent calls, e.g. from more than one encoder thread, each use their own job)
+ */
+struct DrawableToRgbBufferJob {  /* job */
+    DrawableToRgbBufferProcessorData  drgbArray[GAP_GVE_MAX_THREADS];
+    GMutex             *doneMutex;
+    GCond              *doneCond;
+    gint                refCount;        /* protected by doneMutex, one reference per queued stripe + one for the caller */
+};
+
 extern int gap_debug;
 
 
@@ -134,25 +154,18 @@ gap_gve_free_GapRgbPixelBuffer(GapRgbPixelBuffer *rgbBuffer)
 void
 gap_gve_convert_GapRgbPixelBuffer_To_BGR(GapRgbPixelBuffer *rgbBuffer)
 {
-  gint32   pixelCount;
-  guchar  *ptrA;
-  guchar  *ptrB;
-  
-  ptrA = &rgbBuffer->data[0];
-  ptrB = &rgbBuffer->data[2];
-  
-  for (pixelCount = rgbBuffer->width * rgbBuffer->height; pixelCount > 0; pixelCount--)
-  {
-    guchar tmp;
-    
-    tmp = *ptrA;
-    *ptrA = *ptrB;
-    *ptrB = tmp;
-    
-    ptrA += rgbBuffer->bpp;
-    ptrB += rgbBuffer->bpp;
-  }
-  
+  static gint32 funcId = -1;
+
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "gap_gve_convert_GapRgbPixelBuffer_To_BGR");
+  GAP_TIMM_START_FUNCTION(funcId);
+
+  gap_gve_raw_simd_swap_rgb_to_bgr(rgbBuffer->data
+                                  , rgbBuffer->width * rgbBuffer->height
+                                  , rgbBuffer->bpp
+                                  );
+
+  GAP_TIMM_STOP_FUNCTION(funcId);
+
 }  /* end gap_gve_convert_GapRgbPixelBuffer_To_BGR */
 
 
@@ -218,7 +231,7 @@ gap_gve_raw_RGB_or_BGR_drawable_encode(GimpDrawable *drawable, gint32 *RAW_size,
   }
 
   rgbBuffer->data = RAW_data + app0_length;;
-  gap_gve_drawable_to_RgbBuffer(drawable, rgbBuffer);
+  gap_gve_drawable_to_RgbBuffer_multithread(drawable, rgbBuffer);
   
   if(convertToBGR)
   {
@@ -282,10 +295,8 @@ gap_gve_raw_YUV444_drawable_encode(GimpDrawable *drawable, gint32 *RAW_size, gbo
                         ,gint32 matrix_coefficients
                         )
 {
-  guint j;
+  static gint32 funcId = -1;
   int i;
-  int r, g, b;
-  double y, u, v;
   double cr, cg, cb, cu, cv;
   unsigned char *yp, *up, *vp;
   static unsigned char *y444, *u444, *v444;
@@ -310,6 +321,8 @@ gap_gve_raw_YUV444_drawable_encode(GimpDrawable *drawable, gint32 *RAW_size, gbo
   guint   l_row;
 
 
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "gap_gve_raw_YUV444_drawable_encode (convert)");
+
   drawable_type = gimp_drawable_type (drawable->drawable_id);
   l_rowstride = drawable->width * drawable->bpp;
   pixelrow_data = (guchar *)g_malloc0(l_rowstride);
@@ -360,7 +373,6 @@ gap_gve_raw_YUV444_drawable_encode(GimpDrawable *drawable, gint32 *RAW_size, gbo
   for(l_row = 0; l_row < drawable->height; l_row++)
   {
      gint32   l_row_x_width;
-     guchar *l_bptr;
      gint32 l_src_row;
 
      if(vflip)  { l_src_row = (drawable->height - 1) - l_row; }
@@ -373,24 +385,14 @@ gap_gve_raw_YUV444_drawable_encode(GimpDrawable *drawable, gint32 *RAW_size, gbo
 
     gimp_pixel_rgn_get_row (&srcPR, pixelrow_data, 0, l_src_row, drawable->width);
 
-    l_bptr = pixelrow_data;
-    for (j=0; j < drawable->width; j++)
-    {
-      /* peek RGB (for grey images: R==G==B) */
-      r=l_bptr[l_red];
-      g=l_bptr[l_green];
-      b=l_bptr[l_blue];
-
-      /* convert to YUV */
-      y = cr*r + cg*g + cb*b;
-      u = cu*(b-y);
-      v = cv*(r-y);
-      yp[j] = (219.0/256.0)*y + 16.5;  /* nominal range: 16..235 */
-      up[j] = (224.0/256.0)*u + 128.5; /* 16..240 */
-      vp[j] = (224.0/256.0)*v + 128.5; /* 16..240 */
-
-      l_bptr += drawable->bpp;   /* advance read pointer */
-    }
+    /* convert to YUV (for grey images: R==G==B) */
+    GAP_TIMM_START_FUNCTION(funcId);
+    gap_gve_raw_simd_rgb_row_to_yuv444(pixelrow_data, drawable->bpp, drawable->width
+                  , l_red, l_green, l_blue
+                  , cr, cg, cb, cu, cv
+                  , yp, up, vp
+                  );
+    GAP_TIMM_STOP_FUNCTION(funcId);
   }
 
   g_free(pixelrow_data);
@@ -414,17 +416,11 @@ gap_gve_raw_YUV444_drawable_encode(GimpDrawable *drawable, gint32 *RAW_size, gbo
  *
  */
 
-#define SCALEBITS 8
-#define ONE_HALF  (1 << (SCALEBITS - 1))
-#define FIX(x)          ((int) ((x) * (1L<<SCALEBITS) + 0.5))
-
 void
 gap_gve_raw_YUV420P_drawable_encode(GimpDrawable *drawable, guchar *yuv420_buffer)
 {
-  guint x, y;
-  int wrap, wrap3;
-  int r, g, b, r1, g1, b1;
-  guchar *p;
+  static gint32 funcId = -1;
+  int wrap3;
   guchar *lum;
   guchar *cb;
   guchar *cr;
@@ -436,6 +432,8 @@ gap_gve_raw_YUV420P_drawable_encode(GimpDrawable *drawable, guchar *yuv420_buffe
   guchar *all_pixelrows;
   int     size;
 
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "gap_gve_raw_YUV420P_drawable_encode (convert)");
+
   drawable_type = gimp_drawable_type (drawable->drawable_id);
   l_red   = 0;
   l_green = 1;
@@ -452,14 +450,13 @@ gap_gve_raw_YUV420P_drawable_encode(GimpDrawable *drawable, guchar *yuv420_buffe
   gimp_pixel_rgn_init (&srcPR, drawable, 0, 0, drawable->width, drawable->height,
                          FALSE, FALSE);
 
-  wrap = drawable->width;
   wrap3 = drawable->width * drawable->bpp;
   size = drawable->width * drawable->height;
   lum = yuv420_buffer;
   cb = yuv420_buffer + size;
   cr = cb + (size / 4);
 
-    /* buffer for 2 pixelrows (RGB, RGBA, GREY, or GRAYA Gimp Colormodel) */
+    /* buffer for all pixelrows (RGB, RGBA, GREY, or GRAYA Gimp Colormodel) */
     all_pixelrows = g_malloc(wrap3 * drawable->height);
 
     gimp_pixel_rgn_get_rect (&srcPR, all_pixelrows
@@ -469,63 +466,13 @@ gap_gve_raw_YUV420P_drawable_encode(GimpDrawable *drawable, guchar *yuv420_buffe
                               , drawable->height               /* get all rows */
                               );
 
-    for(y=0;y < drawable->height;y+=2)
-    {
-        p = all_pixelrows + (y * wrap3);
-        for(x=0;x < drawable->width;x+=2)
-        {
-            r = p[l_red];
-            g = p[l_green];
-            b = p[l_blue];
-            r1 = r;
-            g1 = g;
-            b1 = b;
-            lum[0] = (FIX(0.29900) * r + FIX(0.58700) * g +
-                      FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
-            r = p[drawable->bpp + l_red];
-            g = p[drawable->bpp + l_green];
-            b = p[drawable->bpp + l_blue];
-            r1 += r;
-            g1 += g;
-            b1 += b;
-            lum[1] = (FIX(0.29900) * r + FIX(0.58700) * g +
-                      FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
-
-            /* step to next row (same column) */
-            p += wrap3;
-            lum += wrap;
-
-            r = p[l_red];
-            g = p[l_green];
-            b = p[l_blue];
-            r1 += r;
-            g1 += g;
-            b1 += b;
-            lum[0] = (FIX(0.29900) * r + FIX(0.58700) * g +
-                      FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
-            r = p[drawable->bpp + l_red];
-            g = p[drawable->bpp + l_green];
-            b = p[drawable->bpp + l_blue];
-            r1 += r;
-            g1 += g;
-            b1 += b;
-            lum[1] = (FIX(0.29900) * r + FIX(0.58700) * g +
-                      FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
-
-            cb[0] = ((- FIX(0.16874) * r1 - FIX(0.33126) * g1 +
-                      FIX(0.50000) * b1 + 4 * ONE_HALF - 1) >> (SCALEBITS + 2)) + 128;
-            cr[0] = ((FIX(0.50000) * r1 - FIX(0.41869) * g1 -
-                     FIX(0.08131) * b1 + 4 * ONE_HALF - 1) >> (SCALEBITS + 2)) + 128;
-
-            cb++;
-            cr++;
-
-            /* backstep to current row and advance 2 column */
-            p += -wrap3 + 2 * drawable->bpp;
-            lum += -wrap + 2;
-        }
-        lum += wrap;
-    }
+    GAP_TIMM_START_FUNCTION(funcId);
+    gap_gve_raw_simd_rgb_to_yuv420p(all_pixelrows, drawable->bpp, wrap3
+                              , drawable->width, drawable->height
+                              , l_red, l_green, l_blue
+                              , lum, cb, cr
+                              );
+    GAP_TIMM_STOP_FUNCTION(funcId);
 
     g_free(all_pixelrows);
 
@@ -564,30 +511,29 @@ gap_gve_raw_YUV420_drawable_encode(GimpDrawable *drawable, gint32 *RAW_size, gbo
 
 
 /* ---------------------------------
- * p_copyPixelRegionToRgbBuffer
+ * p_copyRowsToRgbBuffer
  * ---------------------------------
+ * copy height rows of width pixels from src (src_bpp bytes per pixel)
+ * to dest that points into the pixel data of dstBuff.
+ * at different bpp the gray or rgb channel(s) are copied to an RGB (bpp 3) buffer
+ * (the alpha channel is dropped).
  */
 static inline void
-p_copyPixelRegionToRgbBuffer (const GimpPixelRgn *srcPR
+p_copyRowsToRgbBuffer (const guchar *src, gint32 src_bpp, gint32 src_rowstride
+                    ,gint32 width, gint32 height
+                    ,guchar *dest
                     ,const GapRgbPixelBuffer *dstBuff
                     ,GimpImageType drawable_type)
 {
-  guint    row;
-  guchar*  src;
-  guchar*  dest;
-   
-  src  = srcPR->data;
-  dest = dstBuff->data 
-       + (srcPR->y * dstBuff->rowstride)
-       + (srcPR->x * dstBuff->bpp);
+  gint32   row;
 
-  if(srcPR->bpp == dstBuff->bpp)
+  if(src_bpp == dstBuff->bpp)
   {
     /* at same bbp size we can use fast memcpy */
-    for (row = 0; row < srcPR->h; row++)
+    for (row = 0; row < height; row++)
     {
-       memcpy(dest, src, srcPR->w * srcPR->bpp);
-       src  += srcPR->rowstride;
+       memcpy(dest, src, width * src_bpp);
+       src  += src_rowstride;
        dest += dstBuff->rowstride;
     }
     return;
@@ -595,11 +541,12 @@ p_copyPixelRegionToRgbBuffer (const GimpPixelRgn *srcPR
   }
 
 
-  if((srcPR->bpp != dstBuff->bpp)
+  if((src_bpp != dstBuff->bpp)
   && (dstBuff->bpp == 3))
   {
     guchar       *RAW_ptr;
     gint32        l_idx;
+    gint32        l_rowbytes;
     gint32        l_red;
     gint32        l_green;
     gint32        l_blue;
@@ -613,30 +560,53 @@ p_copyPixelRegionToRgbBuffer (const GimpPixelRgn *srcPR
       l_green = 0;
       l_blue  = 0;
     }
+    l_rowbytes = width * src_bpp;
     
-    /* copy gray or rgb channel(s) from src tile to RGB dest buffer */
-    for (row = 0; row < srcPR->h; row++)
+    /* copy gray or rgb channel(s) from src rows to RGB dest buffer */
+    for (row = 0; row < height; row++)
     {
       RAW_ptr = dest;
-      for(l_idx=0; l_idx < srcPR->rowstride; l_idx += srcPR->bpp)
+      for(l_idx=0; l_idx < l_rowbytes; l_idx += src_bpp)
       {
         *(RAW_ptr++) = src[l_idx + l_red];
         *(RAW_ptr++) = src[l_idx + l_green];
         *(RAW_ptr++) = src[l_idx + l_blue];
       }
 
-      src  += srcPR->rowstride;
+      src  += src_rowstride;
       dest += dstBuff->rowstride;
     }
     return;
   }
 
   
-  printf("** ERROR p_copyPixelRegionToRgbBuffer: unsupported conversion from src bpp:%d to  dest bpp:%d\n"
-    , (int)srcPR->bpp
+  printf("** ERROR p_copyRowsToRgbBuffer: unsupported conversion from src bpp:%d to  dest bpp:%d\n"
+    , (int)src_bpp
     , (int)dstBuff->bpp
     );
   
+}  /* end p_copyRowsToRgbBuffer */
+
+
+/* ---------------------------------
+ * p_copyPixelRegionToRgbBuffer
+ * ---------------------------------
+ */
+static inline void
+p_copyPixelRegionToRgbBuffer (const GimpPixelRgn *srcPR
+                    ,const GapRgbPixelBuffer *dstBuff
+                    ,GimpImageType drawable_type)
+{
+  guchar*  dest;
+   
+  dest = dstBuff->data 
+       + (srcPR->y * dstBuff->rowstride)
+       + (srcPR->x * dstBuff->bpp);
+
+  p_copyRowsToRgbBuffer (srcPR->data, srcPR->bpp, srcPR->rowstride
+                        , srcPR->w, srcPR->h
+                        , dest, dstBuff, drawable_type);
+  
 }  /* end p_copyPixelRegionToRgbBuffer */
 
 
@@ -746,283 +716,433 @@ gap_gve_drawable_to_RgbBuffer(GimpDrawable *drawable, GapRgbPixelBuffer *rgbBuff
 
 
 
-// /* --------------------------------------------
-//  * p_drawable_to_RgbBuffer_WorkerThreadFunction
-//  * --------------------------------------------
-//  * this function runs in concurrent parallel worker threads in multiprocessor environment.
-//  * each one of the parallel running threads processes another portion of the drawable
-//  * (e.g. stripes starting at startCol and colWidth wide. of the processed drawable differs for each thread) 
-//  */
-// static void
-// p_drawable_to_RgbBuffer_WorkerThreadFunction(DrawableToRgbBufferProcessorData *drgb)
-// {
-//   GimpPixelRgn     srcPR;
-//   gpointer  pr;
-//   GStaticMutex    *gimpMutex;
-// 
-//   if(gap_debug)
-//   {
-//     printf("RgbBuffer_WorkerThreadFunction: START cpu[%d] drawableID:%d (before mutex_lock)\n"
-//       ,(int)drgb->cpuId
-//       ,(int)drgb->src_drawable->drawable_id
-//       );
-//   }  
-//   gimpMutex = gap_base_get_gimp_mutex();
-//    
-//   g_static_mutex_lock(gimpMutex);
-//  
-//   gimp_pixel_rgn_init (&srcPR, drgb->src_drawable
-//                       , drgb->startCol, 0
-//                       , drgb->colWidth, drgb->src_drawable->height
-//                       , FALSE     /* dirty */
-//                       , FALSE     /* shadow */
-//                        );
-//   for (pr = gimp_pixel_rgns_register (1, &srcPR);
-//        pr != NULL;
-//        pr = gimp_pixel_rgns_process (pr))
-//   {
-//       g_static_mutex_unlock(gimpMutex);
-//       p_copyPixelRegionToRgbBuffer (&srcPR, drgb->rgbBuffer, drgb->drawable_type);
-//       if(gap_debug)
-//       {
-//         printf("RgbBuffer_WorkerThreadFunction: PR-LOOP cpu[%d] drawableID:%d (before mutex_lock)\n"
-//           ,(int)drgb->cpuId
-//           ,(int)drgb->src_drawable->drawable_id
-//           );
-//       }  
-//       g_static_mutex_lock(gimpMutex);
-//   }
-// 
-//   if(gap_debug)
-//   {
-//     printf("RgbBuffer_WorkerThreadFunction: DONE cpu[%d] drawableID:%d\n"
-//       ,(int)drgb->cpuId
-//       ,(int)drgb->src_drawable->drawable_id
-//       );
-//   }  
-// 
-//   drgb->isFinished = TRUE;
-//   
-//   g_static_mutex_unlock(gimpMutex);
-//    
-// }  /* end p_drawable_to_RgbBuffer_WorkerThreadFunction */
-// 
-// 
-// 
-// /* -----------------------------------------
-//  * gap_gve_drawable_to_RgbBuffer_multithread
-//  * -----------------------------------------
-//  * Encode drawable to RGBBuffer (Bytesequence RGB) on multiprocessor machines.
-//  * This implementation uses threads to spread the work to the configured
-//  * number of processors by using a thread pool.
-//  *
-//  * ==> tests on my 4 CPU system showed that this runs slower than the singleprocessor implementation
-//  *     main reason is:
-//  *       lot of time wasted with wait to get the mutex that must be used to synchronize
-//  *       access to the gimp plug-in communication
-//  */
-// void
-// gap_gve_drawable_to_RgbBuffer_multithread(GimpDrawable *drawable, GapRgbPixelBuffer *rgbBuffer)
-// {
-// #define GAP_GVE_MAX_THREADS 16
-//   static GThreadPool  *threadPool = NULL;
-//   GStaticMutex        *gimpMutex;
-//   gboolean             isMultithreadEnabled;
-//   gint                 numThreads;
-//   gint                 tilesPerRow;
-//   gint                 tilesPerCpu;
-//   gint                 colsPerCpu;
-//   gint                 retry;
-//   gint                 startCol;
-//   gint                 colWidth;
-//   gint                 ii;
-//   GimpImageType        drawable_type;
-//   DrawableToRgbBufferProcessorData  drgbArray[GAP_GVE_MAX_THREADS];
-//   DrawableToRgbBufferProcessorData *drgb;
-//   GError *error;
-// 
-//   static gint32 funcId = -1;
-// 
-//   GAP_TIMM_GET_FUNCTION_ID(funcId, "gap_gve_drawable_to_RgbBuffer_multithread");
-//   GAP_TIMM_START_FUNCTION(funcId);
-// 
-// 
-//   error = NULL;
-// 
-//    
-//   numThreads = MIN(gap_base_get_numProcessors(), GAP_GVE_MAX_THREADS);
-// 
-//   /* check and init thread system */
-//   isMultithreadEnabled = gap_base_thread_init();
-//   
-//   if((isMultithreadEnabled != TRUE)
-//   || (drawable->height < numThreads)
-//   || (numThreads < 2))
-//   {
-//     /* use singleproceesor implementation where multithread variant is not
-//      * available or would be slower than singleprocessor implementation
-//      */
-//     gap_gve_drawable_to_RgbBuffer(drawable, rgbBuffer);
-//     return;
-//   }
-//     
-//   if (threadPool == NULL)
-//   {
-//     GError *error = NULL;
-// 
-// 
-//     /* init the treadPool at first multiprocessing call
-//      * (and keep the threads until end of main process..)
-//      */
-//     threadPool = g_thread_pool_new((GFunc) p_drawable_to_RgbBuffer_WorkerThreadFunction
-//                                          ,NULL        /* user data */
-//                                          ,GAP_GVE_MAX_THREADS          /* max_threads */
-//                                          ,TRUE        /* exclusive */
-//                                          ,&error      /* GError **error */
-//                                          );
-//   }
-// 
-//   gimpMutex = gap_base_get_gimp_mutex();
-//   drawable_type = gimp_drawable_type (drawable->drawable_id);
-// 
-//   tilesPerRow = drawable->width / gimp_tile_width();
-//   tilesPerCpu = tilesPerRow / numThreads;
-//   colsPerCpu = tilesPerCpu * gimp_tile_width();
-//   if(colsPerCpu < drawable->width)
-//   {
-//     tilesPerCpu++;
-//     colsPerCpu = tilesPerCpu * gimp_tile_width();
-//   }
-//   
-//   if(gap_debug)
-//   {
-//     printf("gap_gve_drawable_to_RgbBuffer_multithread drawableId :%d size:%d x %d tileWidth:%d numThreads:%d tilesPerCpu:%d colsPerCpu:%d\n"
-//       ,(int)drawable->drawable_id
-//       ,(int)drawable->width
-//       ,(int)drawable->height
-//       ,(int)gimp_tile_width()
-//       ,(int)numThreads
-//       ,(int)tilesPerCpu
-//       ,(int)colsPerCpu
-//       );
-//   }
-// 
-//   startCol = 0;
-//   colWidth = colsPerCpu;
-//   
-//   if(gap_debug)
-//   {
-//     printf("gap_gve_drawable_to_RgbBuffer_multithread: before LOCK gimpMutex INITIAL drawableId :%d\n"
-//         ,(int)drawable->drawable_id
-//       );
-//   }
-//   g_static_mutex_lock(gimpMutex);
-// 
-//   for(ii=0; ii < numThreads; ii++)
-//   {
-//     DrawableToRgbBufferProcessorData *drgb;
-// 
-//     if(gap_debug)
-//     {
-//       printf("gap_gve_drawable_to_RgbBuffer_multithread drawableId :%d Cpu[%d] startCol:%d colWidth:%d\n"
-//         ,(int)drawable->drawable_id
-//         ,(int)ii
-//         ,(int)startCol
-//         ,(int)colWidth
-//         );
-//     }
-//     
-//     drgb = &drgbArray[ii];
-//     drgb->drawable_type = drawable_type;
-//     drgb->src_drawable = drawable;
-//     drgb->rgbBuffer = rgbBuffer;
-//     
-//     drgb->startCol = startCol;
-//     drgb->colWidth = colWidth;
-//     drgb->cpuId = ii;
-//     drgb->isFinished = FALSE;
-//     
-//     /* (re)activate thread */
-//     g_thread_pool_push (threadPool
-//                        , drgb    /* user Data for the worker thread*/
-//                        , &error
-//                        );
-//     startCol += colsPerCpu;
-//     if((startCol + colsPerCpu) >  drawable->width)
-//     {
-//       /* the last thread handles a stripe with the remaining columns
-//        * (note that the partitioning into stripes is done in tile with portions
-//        * to avoid concurrent thread access to the same tile.)
-//        */
-//       colWidth = drawable->width - startCol;
-//     }
-//   }
-// 
-//   g_static_mutex_unlock(gimpMutex);
-// 
-//   for(retry = 0; retry < 2000; retry++)
-//   {
-//     gboolean isAllWorkDone;
-// 
-//     /* assume all threads finished work (this may already be the case after firts retry) */
-//     isAllWorkDone = TRUE;
-//     
-//     // g_static_mutex_lock(gimpMutex);
-//     
-//     for(ii=0; ii < numThreads; ii++)
-//     {
-//       drgb = &drgbArray[ii];
-//       if(gap_debug)
-//       {
-//         printf("gap_gve_drawable_to_RgbBuffer_multithread: STATUS Cpu[%d] retry :%d  isFinished:%d\n"
-//           ,(int)ii
-//           ,(int)retry
-//           ,(int)drgb->isFinished
-//           );
-//       }
-//       if(drgb->isFinished != TRUE)
-//       {
-//         isAllWorkDone = FALSE;
-//         break;
-//       }
-//     }
-// 
-//     // g_static_mutex_unlock(gimpMutex);
-//      
-//     if(isAllWorkDone == TRUE)
-//     {
-//       break;
-//     }
-//     
-//     if(gap_debug)
-//     {
-//       printf("gap_gve_drawable_to_RgbBuffer_multithread: SLEEP retry :%d\n"
-//         ,(int)retry
-//         );
-//     }
-//   
-//     g_usleep (500);
-// 
-//     if(gap_debug)
-//     {
-//       printf("gap_gve_drawable_to_RgbBuffer_multithread: WAKE-UP drawableId:%d retry :%d\n"
-//         , (int)drawable->drawable_id
-//         , (int)retry
-//         );
-//     }
-// 
-//     
-//   }
-// 
-// 
-//   GAP_TIMM_STOP_FUNCTION(funcId);
-// 
-//   if(gap_debug)
-//   {
-//     printf("gap_gve_drawable_to_RgbBuffer_multithread: DONE drawableId:%d retry :%d\n"
-//         , (int)drawable->drawable_id
-//         , (int)retry
-//         );
-//   }
-//   
-// }    /* end gap_gve_drawable_to_RgbBuffer_multithread */
+/* --------------------------------------------
+ * p_drgb_job_new
+ * --------------------------------------------
+ */
+static DrawableToRgbBufferJob *
+p_drgb_job_new(void)
+{
+  DrawableToRgbBufferJob *job;
+
+  job = g_new0(DrawableToRgbBufferJob, 1);
+  job->doneMutex = g_mutex_new();
+  job->doneCond = g_cond_new();
+  job->refCount = 1;
+
+  return (job);
+}  /* end p_drgb_job_new */
+
+
+/* --------------------------------------------
+ * p_drgb_job_unref
+ * --------------------------------------------
+ * drop one reference, the job is freed when the last reference is dropped
+ */
+static void
+p_drgb_job_unref(DrawableToRgbBufferJob *job)
+{
+  gint refCount;
+
+  g_mutex_lock(job->doneMutex);
+  job->refCount--;
+  refCount = job->refCount;
+  g_mutex_unlock(job->doneMutex);
+
+  if(refCount <= 0)
+  {
+    g_mutex_free(job->doneMutex);
+    g_cond_free(job->doneCond);
+    g_free(job);
+  }
+}  /* end p_drgb_job_unref */
+
+
+/* --------------------------------------------
+ * p_drgb_claim_and_convert_stripe
+ * --------------------------------------------
+ * convert the stripe unless it was already started by another thread.
+ * (a stripe that could not be handed over to the thread pool
+ *  may still be picked up by a worker thread later)
+ */
+static void
+p_drgb_claim_and_convert_stripe(DrawableToRgbBufferProcessorData *drgb)
+{
+  DrawableToRgbBufferJob *job;
+  gboolean isClaimed;
+
+  job = drgb->job;
+  g_mutex_lock(job->doneMutex);
+  isClaimed = (drgb->isStarted != TRUE);
+  drgb->isStarted = TRUE;
+  g_mutex_unlock(job->doneMutex);
+
+  if(isClaimed)
+  {
+    const guchar *src;
+    guchar       *dest;
+
+    src = drgb->src_data
+        + (drgb->startRow * drgb->src_rowstride);
+    dest = drgb->rgbBuffer->data
+         + (drgb->startRow * drgb->rgbBuffer->rowstride);
+
+    p_copyRowsToRgbBuffer (src, drgb->src_bpp, drgb->src_rowstride
+                          , drgb->rgbBuffer->width, drgb->rowHeight
+                          , dest, drgb->rgbBuffer, drgb->drawable_type);
+
+    g_mutex_lock(job->doneMutex);
+    drgb->isFinished = TRUE;
+    g_cond_signal(job->doneCond);
+    g_mutex_unlock(job->doneMutex);
+  }
+}  /* end p_drgb_claim_and_convert_stripe */
+
+
+/* --------------------------------------------
+ * p_drawable_to_RgbBuffer_WorkerThreadFunction
+ * --------------------------------------------
+ * this function runs in concurrent parallel worker threads in multiprocessor environment.
+ * each one of the parallel running threads converts another row stripe
+ * (starting at startRow and rowHeight rows high) of the source pixel data
+ * that was already fetched from the drawable by the main thread.
+ * Note that the worker threads do not call any gimp procedures
+ * (the plug-in communication with the gimp core is not thread save).
+ */
+static void
+p_drawable_to_RgbBuffer_WorkerThreadFunction(DrawableToRgbBufferProcessorData *drgb)
+{
+  DrawableToRgbBufferJob *job;
+
+  job = drgb->job;
+  p_drgb_claim_and_convert_stripe(drgb);
+  p_drgb_job_unref(job);
+   
+}  /* end p_drawable_to_RgbBuffer_WorkerThreadFunction */
+
+
+/* --------------------------------------------
+ * p_get_thread_pool
+ * --------------------------------------------
+ * return the thread pool shared by all callers
+ * (created at the first multiprocessing call and kept until end of the process)
+ * or NULL if no thread pool is available.
+ */
+static GThreadPool *
+p_get_thread_pool(void)
+{
+  static GStaticMutex poolMutex = G_STATIC_MUTEX_INIT;
+  static GThreadPool *threadPool = NULL;
+  static gboolean     isPoolFailed = FALSE;
+  GThreadPool        *pool;
+  GError             *error;
+
+  g_static_mutex_lock(&poolMutex);
+  if((threadPool == NULL) && (isPoolFailed != TRUE))
+  {
+    error = NULL;
+    threadPool = g_thread_pool_new((GFunc) p_drawable_to_RgbBuffer_WorkerThreadFunction
+                                         ,NULL        /* user data */
+                                         ,GAP_GVE_MAX_THREADS          /* max_threads */
+                                         ,TRUE        /* exclusive */
+                                         ,&error      /* GError **error */
+                                         );
+    if((threadPool == NULL) || (error != NULL))
+    {
+      /* an exclusive pool reports an error when not all of its threads could be started */
+      printf("** ERROR gap_gve_drawable_to_RgbBuffer_multithread: could not create thread pool %s\n"
+        , (error != NULL) ? error->message : ""
+        );
+      if(error != NULL)
+      {
+        g_error_free(error);
+      }
+      if(threadPool != NULL)
+      {
+        g_thread_pool_free(threadPool, FALSE, TRUE);
+        threadPool = NULL;
+      }
+      isPoolFailed = TRUE;
+    }
+  }
+  pool = threadPool;
+  g_static_mutex_unlock(&poolMutex);
+
+  return (pool);
+}  /* end p_get_thread_pool */
+
+
+/* --------------------------------------------
+ * p_drgb_start_stripe
+ * --------------------------------------------
+ * hand over the stripe drgb to the thread pool.
+ * in case the thread pool is not available or refuses the stripe
+ * it is converted in the calling thread.
+ */
+static void
+p_drgb_start_stripe(DrawableToRgbBufferJob *job, GThreadPool *threadPool
+   , DrawableToRgbBufferProcessorData *drgb)
+{
+  GError *error;
+
+  drgb->job = job;
+  drgb->isStarted = FALSE;
+  drgb->isFinished = FALSE;
+
+  if(threadPool != NULL)
+  {
+    /* the queued stripe holds a reference to the job until a worker has processed it */
+    g_mutex_lock(job->doneMutex);
+    job->refCount++;
+    g_mutex_unlock(job->doneMutex);
+
+    error = NULL;
+    g_thread_pool_push (threadPool
+                       , drgb    /* user Data for the worker thread*/
+                       , &error
+                       );
+    if(error == NULL)
+    {
+      return;
+    }
+
+    /* glib queues the data even when no additional thread could be started.
+     * the stripe is converted here unless a worker thread has already picked it up,
+     * a worker that picks it up later only drops its job reference.
+     */
+    printf("** WARNING gap_gve_drawable_to_RgbBuffer_multithread: could not push stripe %d to the thread pool %s\n"
+      , (int)drgb->cpuId
+      , error->message
+      );
+    g_error_free(error);
+  }
+
+  p_drgb_claim_and_convert_stripe(drgb);
+
+}  /* end p_drgb_start_stripe */
+
+
+/* --------------------------------------------
+ * p_drgb_convert_stripes
+ * --------------------------------------------
+ * convert the pixel data src_data (height rows at src_bpp and src_rowstride)
+ * to the rgbBuffer in numThreads row stripes that are processed in parallel.
+ * if srcPR is not NULL, each stripe is fetched from srcPR into src_data right before
+ * it is handed over, so fetching of the next stripe runs while the worker threads
+ * convert the already fetched stripes.
+ * threadPool NULL converts all stripes in the calling thread.
+ */
+static void
+p_drgb_convert_stripes(GimpPixelRgn *srcPR, guchar *src_data, gint32 src_bpp, gint32 src_rowstride
+   , GimpImageType drawable_type, GapRgbPixelBuffer *rgbBuffer
+   , gint numThreads, GThreadPool *threadPool)
+{
+  DrawableToRgbBufferJob           *job;
+  DrawableToRgbBufferProcessorData *drgb;
+  gint                 rowsPerCpu;
+  gint                 startRow;
+  gint                 rowHeight;
+  gint                 numStripes;
+  gint                 ii;
+
+  static gint32 funcIdFetch = -1;
+  static gint32 funcIdMainWait = -1;
+
+  GAP_TIMM_GET_FUNCTION_ID(funcIdFetch, "gap_gve_drawable_to_RgbBuffer_multithread.main (fetch)");
+  GAP_TIMM_GET_FUNCTION_ID(funcIdMainWait, "gap_gve_drawable_to_RgbBuffer_multithread.main (Wait)");
+
+  numThreads = CLAMP(numThreads, 1, GAP_GVE_MAX_THREADS);
+  rowsPerCpu = (rgbBuffer->height + (numThreads -1)) / numThreads;
+  job = p_drgb_job_new();
+
+  numStripes = 0;
+  startRow = 0;
+  for(ii=0; ii < numThreads; ii++)
+  {
+    rowHeight = MIN(rowsPerCpu, (gint)rgbBuffer->height - startRow);
+    if(rowHeight <= 0)
+    {
+      break;
+    }
+
+    if(srcPR != NULL)
+    {
+      /* fetch the next stripe while the worker threads convert the already fetched stripes */
+      GAP_TIMM_START_FUNCTION(funcIdFetch);
+      gimp_pixel_rgn_get_rect (srcPR
+                         , src_data + (startRow * src_rowstride)
+                         , 0
+                         , startRow
+                         , rgbBuffer->width
+                         , rowHeight);
+      GAP_TIMM_STOP_FUNCTION(funcIdFetch);
+    }
+
+    drgb = &job->drgbArray[ii];
+    drgb->src_data = src_data;
+    drgb->src_bpp = src_bpp;
+    drgb->src_rowstride = src_rowstride;
+    drgb->drawable_type = drawable_type;
+    drgb->rgbBuffer = rgbBuffer;
+    drgb->startRow = startRow;
+    drgb->rowHeight = rowHeight;
+    drgb->cpuId = ii;
+
+    if(gap_debug)
+    {
+      printf("gap_gve_drawable_to_RgbBuffer_multithread Cpu[%d] startRow:%d rowHeight:%d\n"
+        ,(int)ii
+        ,(int)startRow
+        ,(int)rowHeight
+        );
+    }
+
+    p_drgb_start_stripe(job, threadPool, drgb);
+    numStripes++;
+    startRow += rowHeight;
+  }
+
+  /* now wait until all stripes are finished */
+  GAP_TIMM_START_FUNCTION(funcIdMainWait);
+  g_mutex_lock(job->doneMutex);
+  for(ii=0; ii < numStripes; ii++)
+  {
+    while(job->drgbArray[ii].isFinished != TRUE)
+    {
+      g_cond_wait(job->doneCond, job->doneMutex);
+    }
+  }
+  g_mutex_unlock(job->doneMutex);
+  GAP_TIMM_STOP_FUNCTION(funcIdMainWait);
+
+  p_drgb_job_unref(job);
+
+}  /* end p_drgb_convert_stripes */
+
+
+/* -----------------------------------------
+ * gap_gve_drawable_to_RgbBuffer_multithread
+ * -----------------------------------------
+ * Encode drawable to RGBBuffer (Bytesequence RGB) on multiprocessor machines.
+ * This implementation uses threads to spread the work to the configured
+ * number of processors by using a thread pool.
+ *
+ * The main thread fetches the drawable in horizontal row stripes (one per thread)
+ * via gimp_pixel_rgn_get_rect and hands each fetched stripe to a worker thread
+ * that converts it into the rgbBuffer while the main thread already fetches
+ * the next stripe.
+ * (an older variant did run the gimp_pixel_rgn calls in the worker threads
+ *  and was slower than the singleprocessor implementation, because
+ *  most time was wasted waiting for the mutex that synchronizes
+ *  the plug-in communication with the gimp core)
+ *
+ * In case drawable and rgbBuffer have the same bpp there is no conversion work,
+ * and the stripes are fetched directly into the rgbBuffer.
+ * Falls back to the singleprocessor implementation in case
+ * threads are not available or the drawable is too small to benefit.
+ * All state of one call is kept in a DrawableToRgbBufferJob,
+ * so this procedure can be called from more than one thread at the same time
+ * (provided the callers serialize their gimp procedure calls).
+ */
+void
+gap_gve_drawable_to_RgbBuffer_multithread(GimpDrawable *drawable, GapRgbPixelBuffer *rgbBuffer)
+{
+  GThreadPool         *threadPool;
+  guchar              *srcBuffer;
+  gboolean             isMultithreadEnabled;
+  gint                 numThreads;
+  gint32               src_rowstride;
+  GimpPixelRgn         srcPR;
+
+  static gint32 funcId = -1;
+  static gint32 funcIdFetch = -1;
+
+  GAP_TIMM_GET_FUNCTION_ID(funcId, "gap_gve_drawable_to_RgbBuffer_multithread");
+  GAP_TIMM_GET_FUNCTION_ID(funcIdFetch, "gap_gve_drawable_to_RgbBuffer_multithread.main (fetch)");
+
+  numThreads = MIN(gap_base_get_numProcessors(), GAP_GVE_MAX_THREADS);
+  if(numThreads > 1)
+  {
+    /* check and init thread system */
+    isMultithreadEnabled = gap_base_thread_init();
+  }
+  else
+  {
+    isMultithreadEnabled = FALSE;
+  }
+
+  if((isMultithreadEnabled != TRUE)
+  || (drawable->width != rgbBuffer->width)
+  || (drawable->height != rgbBuffer->height)
+  || (drawable->height < (numThreads * GAP_GVE_MIN_ROWS_PER_THREAD)))
+  {
+    /* use singleproceesor implementation where multithread variant is not
+     * available or would be slower than singleprocessor implementation
+     */
+    gap_gve_drawable_to_RgbBuffer(drawable, rgbBuffer);
+    return;
+  }
+
+  GAP_TIMM_START_FUNCTION(funcId);
+
+  gimp_pixel_rgn_init (&srcPR, drawable, 0, 0
+                      , drawable->width, drawable->height
+                      , FALSE     /* dirty */
+                      , FALSE     /* shadow */
+                      );
+
+  if(drawable->bpp == rgbBuffer->bpp)
+  {
+    /* nothing to convert, fetch all rows at once directly into the rgbBuffer */
+    GAP_TIMM_START_FUNCTION(funcIdFetch);
+    gimp_pixel_rgn_get_rect (&srcPR, rgbBuffer->data
+                       , 0
+                       , 0
+                       , drawable->width
+                       , drawable->height);
+    GAP_TIMM_STOP_FUNCTION(funcIdFetch);
+    GAP_TIMM_STOP_FUNCTION(funcId);
+    return;
+  }
+
+  threadPool = p_get_thread_pool();
+  if (threadPool == NULL)
+  {
+    GAP_TIMM_STOP_FUNCTION(funcId);
+    gap_gve_drawable_to_RgbBuffer(drawable, rgbBuffer);
+    return;
+  }
+
+  if(gap_debug)
+  {
+    printf("gap_gve_drawable_to_RgbBuffer_multithread drawableId :%d size:%d x %d bpp:%d numThreads:%d\n"
+      ,(int)drawable->drawable_id
+      ,(int)drawable->width
+      ,(int)drawable->height
+      ,(int)drawable->bpp
+      ,(int)numThreads
+      );
+  }
+
+  /* the source buffer holds the fetched drawable pixels at drawable bpp */
+  src_rowstride = drawable->width * drawable->bpp;
+  srcBuffer = g_malloc(src_rowstride * drawable->height);
+
+  p_drgb_convert_stripes(&srcPR, srcBuffer, drawable->bpp, src_rowstride
+                        , gimp_drawable_type (drawable->drawable_id)
+                        , rgbBuffer
+                        , numThreads
+                        , threadPool
+                        );
+  g_free(srcBuffer);
+
+  GAP_TIMM_STOP_FUNCTION(funcId);
+
+  if(gap_debug)
+  {
+    printf("gap_gve_drawable_to_RgbBuffer_multithread: DONE drawableId:%d\n"
+        , (int)drawable->drawable_id
+        );
+  }
+  
+}    /* end gap_gve_drawable_to_RgbBuffer_multithread */
@@ -174,7 +174,11 @@ gap_gve_drawable_to_RgbBuffer(GimpDrawable *drawable, GapRgbPixelBuffer *rgbBuff
  * Encode drawable to RGBBuffer (Bytesequence RGB) on multiprocessor machines.
  * This implementation uses threads to spread the work to the configured
  * number of processors by using a thread pool.
- *
+ * The drawable is fetched by the calling (main) thread, the worker threads
+ * only convert the fetched pixel rows and do not call any gimp procedures.
+ * Falls back to gap_gve_drawable_to_RgbBuffer when threads are not available.
+ * RESTRICTION: drawable and rgbBuffer must have the same width and height
+ *              (otherwise the singleprocessor implementation is used)
  */
 void
 gap_gve_drawable_to_RgbBuffer_multithread(GimpDrawable *drawable, GapRgbPixelBuffer *rgbBuffer);
@@ -0,0 +1,198 @@
+/* gap_gve_raw_multithread_test.c
+ *
+ * (GAP ... GIMP Animation Plugins, now also known as GIMP Video)
+ *    test for the multithreaded drawable to RgbBuffer conversion
+ *    of gap_gve_drawable_to_RgbBuffer_multithread
+ *
+ * The stripe conversion (p_drgb_convert_stripes) is checked against
+ * the single threaded row copy p_copyRowsToRgbBuffer on generated frames
+ *   - random sizes, source bpp 1..4 (GRAY, GRAYA, RGB, RGBA), 1..16 stripes
+ *   - with the shared thread pool and without thread pool (inline fallback)
+ *   - with several caller threads converting different frames at the same time
+ *     (as done by concurrent encoders)
+ * The drawable fetch itself needs a running gimp and is not part of this test.
+ *
+ * usage:
+ *   gap_gve_raw_multithread_test        (run by make check)
+ */
+
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * version 2.7.0; 2026.10.18  created
+ */
+
+#include <stdlib.h>
+
+/* included (not linked) to access the static stripe conversion procedures */
+#include "gap_gve_raw.c"
+
+#define TEST_NUM_FRAMES        200
+#define TEST_NUM_CALLERS       4
+#define TEST_FRAMES_PER_CALLER 50
+
+int gap_debug = 0;
+
+
+/* ---------------------------------
+ * p_check_one_frame
+ * ---------------------------------
+ * convert a generated frame of random size and the specified source bpp
+ * with numThreads stripes and compare against the single threaded row copy.
+ * return the number of mismatches (0 or 1).
+ */
+static gint
+p_check_one_frame(GRand *rand, gint32 src_bpp, gint numThreads, GThreadPool *threadPool)
+{
+  static const GimpImageType typeOfBpp[5] = {
+     GIMP_RGB_IMAGE, GIMP_GRAY_IMAGE, GIMP_GRAYA_IMAGE, GIMP_RGB_IMAGE, GIMP_RGBA_IMAGE
+  };
+  GapRgbPixelBuffer  refBuffer;
+  GapRgbPixelBuffer  rgbBuffer;
+  guchar            *src;
+  gint32             width;
+  gint32             height;
+  gint32             src_rowstride;
+  gint32             ii;
+  gint               errors;
+
+  width = g_rand_int_range(rand, 1, 300);
+  height = g_rand_int_range(rand, 1, 300);
+  src_rowstride = width * src_bpp;
+  src = g_malloc(src_rowstride * height);
+  for(ii = 0; ii < src_rowstride * height; ii++)
+  {
+    src[ii] = g_rand_int_range(rand, 0, 256);
+  }
+
+  refBuffer.width = width;
+  refBuffer.height = height;
+  refBuffer.bpp = 3;
+  refBuffer.rowstride = width * 3;
+  refBuffer.data = g_malloc0(refBuffer.rowstride * height);
+  rgbBuffer = refBuffer;
+  rgbBuffer.data = g_malloc0(rgbBuffer.rowstride * height);
+
+  p_copyRowsToRgbBuffer (src, src_bpp, src_rowstride, width, height
+                        , refBuffer.data, &refBuffer, typeOfBpp[src_bpp]);
+  p_drgb_convert_stripes(NULL, src, src_bpp, src_rowstride, typeOfBpp[src_bpp]
+                        , &rgbBuffer, numThreads, threadPool);
+
+  errors = 0;
+  if(memcmp(refBuffer.data, rgbBuffer.data, refBuffer.rowstride * height) != 0)
+  {
+    printf("MISMATCH size:%dx%d src_bpp:%d numThreads:%d threadPool:%s\n"
+      , (int)width, (int)height, (int)src_bpp, numThreads
+      , (threadPool != NULL) ? "yes" : "no (inline)"
+      );
+    errors = 1;
+  }
+
+  g_free(src);
+  g_free(refBuffer.data);
+  g_free(rgbBuffer.data);
+
+  return (errors);
+}  /* end p_check_one_frame */
+
+
+/* ---------------------------------
+ * p_caller_thread
+ * ---------------------------------
+ * one of TEST_NUM_CALLERS concurrent callers (encoders) that share the thread pool.
+ * returns the number of mismatches as pointer value.
+ */
+static gpointer
+p_caller_thread(gpointer data)
+{
+  GRand  *rand;
+  gint    errors;
+  gint    ii;
+
+  rand = g_rand_new_with_seed(GPOINTER_TO_INT(data));
+  errors = 0;
+  for(ii = 0; ii < TEST_FRAMES_PER_CALLER; ii++)
+  {
+    errors += p_check_one_frame(rand
+                 , g_rand_int_range(rand, 1, 5)
+                 , g_rand_int_range(rand, 1, GAP_GVE_MAX_THREADS + 1)
+                 , p_get_thread_pool()
+                 );
+  }
+  g_rand_free(rand);
+
+  return (GINT_TO_POINTER(errors));
+}  /* end p_caller_thread */
+
+
+/* ---------------------------------
+ * main
+ * ---------------------------------
+ */
+int
+main(int argc, char *argv[])
+{
+  GRand   *rand;
+  GThread *callers[TEST_NUM_CALLERS];
+  gint     errors;
+  gint     ii;
+
+  if(gap_base_thread_init() != TRUE)
+  {
+    printf("thread system not available, test skipped\n");
+    return (77);   /* automake: skipped test */
+  }
+  if(p_get_thread_pool() == NULL)
+  {
+    printf("could not create the thread pool\n");
+    return (1);
+  }
+
+  errors = 0;
+  rand = g_rand_new_with_seed(1);
+  for(ii = 0; ii < TEST_NUM_FRAMES; ii++)
+  {
+    gint32 src_bpp;
+    gint   numThreads;
+
+    src_bpp = 1 + (ii % 4);
+    numThreads = 1 + (ii % GAP_GVE_MAX_THREADS);
+    errors += p_check_one_frame(rand, src_bpp, numThreads, p_get_thread_pool());
+    errors += p_check_one_frame(rand, src_bpp, numThreads, NULL);
+  }
+  g_rand_free(rand);
+  printf("single caller: %d mismatches\n", errors);
+
+  for(ii = 0; ii < TEST_NUM_CALLERS; ii++)
+  {
+    callers[ii] = g_thread_create(p_caller_thread, GINT_TO_POINTER(100 + ii), TRUE, NULL);
+  }
+  for(ii = 0; ii < TEST_NUM_CALLERS; ii++)
+  {
+    if(callers[ii] != NULL)
+    {
+      errors += GPOINTER_TO_INT(g_thread_join(callers[ii]));
+    }
+  }
+
+  printf("multithread RgbBuffer test: %s (%d mismatches)\n", (errors == 0) ? "OK" : "FAILED", errors);
+
+  return ((errors == 0) ? 0 : 1);
+
+}  /* end main */
@@ -0,0 +1,899 @@
+/* gap_gve_raw_simd.c
+ *
+ * (GAP ... GIMP Animation Plugins, now also known as GIMP Video)
+ *    colormodel conversion kernels for RAW video encoding.
+ *
+ * Each kernel has a scalar implementation (the reference) and vector
+ * implementations for x86 CPUs (SSE2 / SSSE3 / AVX2) that are selected
+ * at runtime depending on the capabilities of the CPU.
+ * The vector implementations are compiled via gcc target attributes,
+ * so the library itself does not require any special compiler flags
+ * and still runs on CPUs without those extensions.
+ *
+ * All vector implementations deliver bit-exact the same results
+ * as the scalar implementation:
+ * - RGB to YUV420P uses the same 8 bit fixed point arithmetic (SCALEBITS)
+ *   based on 16 bit multiply / 32 bit add (pmaddwd).
+ * - RGB to YUV444 uses double precision in the same order of operations
+ *   as the scalar code. This vector kernel is only compiled where the
+ *   scalar code also uses SSE2 double math without FMA contraction
+ *   (x87 extended precision or fused multiply add would change the rounding).
+ */
+
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * version 2.7.0; 2026.10.18  created
+ */
+
+
+#include <config.h>
+
+
+/* SYSTEM (UNIX) includes */
+#include <stdio.h>
+#include <string.h>
+
+/* GIMP includes */
+#include "gtk/gtk.h"
+#include "libgimp/gimp.h"
+
+/* GAP includes */
+#include "gap_gve_raw_simd.h"
+
+
+/* vector implementations require gcc >= 4.9 (target attributes with intrinsics)
+ * and an x86 CPU
+ */
+#if defined(__GNUC__) && !defined(__clang__) \
+ && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))) \
+ && (defined(__x86_64__) || defined(__i386__))
+#define GAP_GVE_SIMD_X86 1
+#include <immintrin.h>
+
+/* the YUV444 vector kernel is only bit-exact when the scalar code
+ * uses SSE2 double math without fused multiply add
+ */
+#if defined(__SSE2_MATH__) && !defined(__FMA__)
+#define GAP_GVE_SIMD_X86_DOUBLE 1
+#endif
+
+#define GAP_GVE_TARGET_SSE2   __attribute__((target("sse2")))
+#define GAP_GVE_TARGET_SSSE3  __attribute__((target("ssse3")))
+#define GAP_GVE_TARGET_AVX2   __attribute__((target("avx2")))
+#endif
+
+
+#define SCALEBITS 8
+#define ONE_HALF  (1 << (SCALEBITS - 1))
+#define FIX(x)          ((int) ((x) * (1L<<SCALEBITS) + 0.5))
+
+/* two 16 bit factors packed into one 32 bit lane (operand of pmaddwd) */
+#define P_PAIR16(lo, hi)  ((gint32)(((guint32)(guint16)(lo)) | (((guint32)(guint16)(hi)) << 16)))
+
+/* pack the channel bytes of one pixel as 0x00BBGGRR */
+#define P_PIXEL32(ptr, red, green, blue) \
+   ((gint32)((ptr)[red] | ((ptr)[green] << 8) | ((ptr)[blue] << 16)))
+
+/* number of pixels that must follow 8 pixels loaded by p_avx2_load8
+ * in the same row (the 3 byte pixel load reads 4 bytes ahead)
+ */
+#define P_AVX2_LOAD8_TAIL  2
+
+extern int gap_debug;
+
+static gboolean  simdInitialized = FALSE;
+static gboolean  simdSse2 = FALSE;
+static gboolean  simdSsse3 = FALSE;
+static gboolean  simdAvx2 = FALSE;
+
+
+/* ---------------------------------
+ * p_simd_init
+ * ---------------------------------
+ * check the capabilities of the CPU (once)
+ */
+static void
+p_simd_init(void)
+{
+  if(simdInitialized)
+  {
+    return;
+  }
+
+#ifdef GAP_GVE_SIMD_X86
+  __builtin_cpu_init();
+  simdSse2  = (__builtin_cpu_supports("sse2") != 0);
+  simdSsse3 = (__builtin_cpu_supports("ssse3") != 0);
+  simdAvx2  = (__builtin_cpu_supports("avx2") != 0);
+#endif
+
+  if(gap_debug)
+  {
+    printf("gap_gve_raw_simd: sse2:%d ssse3:%d avx2:%d\n"
+      , (int)simdSse2
+      , (int)simdSsse3
+      , (int)simdAvx2
+      );
+  }
+  simdInitialized = TRUE;
+
+}  /* end p_simd_init */
+
+
+/*************************************************************
+ *          RGB to YUV420P                                   *
+ *************************************************************/
+
+/* ---------------------------------
+ * p_scalar_rgb_to_yuv420p_block
+ * ---------------------------------
+ * convert 2x2 pixels at src to 4 luminance values and one pair of chroma values.
+ * (this is the reference implementation)
+ */
+static inline void
+p_scalar_rgb_to_yuv420p_block(const guchar *src, gint32 src_bpp, gint32 src_rowstride
+                  , gint32 red, gint32 green, gint32 blue
+                  , guchar *lum, gint32 lum_wrap, guchar *cb, guchar *cr)
+{
+  const guchar *p;
+  int r, g, b, r1, g1, b1;
+
+  p = src;
+  r = p[red];
+  g = p[green];
+  b = p[blue];
+  r1 = r;
+  g1 = g;
+  b1 = b;
+  lum[0] = (FIX(0.29900) * r + FIX(0.58700) * g +
+            FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
+  r = p[src_bpp + red];
+  g = p[src_bpp + green];
+  b = p[src_bpp + blue];
+  r1 += r;
+  g1 += g;
+  b1 += b;
+  lum[1] = (FIX(0.29900) * r + FIX(0.58700) * g +
+            FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
+
+  /* step to next row (same column) */
+  p += src_rowstride;
+  lum += lum_wrap;
+
+  r = p[red];
+  g = p[green];
+  b = p[blue];
+  r1 += r;
+  g1 += g;
+  b1 += b;
+  lum[0] = (FIX(0.29900) * r + FIX(0.58700) * g +
+            FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
+  r = p[src_bpp + red];
+  g = p[src_bpp + green];
+  b = p[src_bpp + blue];
+  r1 += r;
+  g1 += g;
+  b1 += b;
+  lum[1] = (FIX(0.29900) * r + FIX(0.58700) * g +
+            FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
+
+  cb[0] = ((- FIX(0.16874) * r1 - FIX(0.33126) * g1 +
+            FIX(0.50000) * b1 + 4 * ONE_HALF - 1) >> (SCALEBITS + 2)) + 128;
+  cr[0] = ((FIX(0.50000) * r1 - FIX(0.41869) * g1 -
+           FIX(0.08131) * b1 + 4 * ONE_HALF - 1) >> (SCALEBITS + 2)) + 128;
+
+}  /* end p_scalar_rgb_to_yuv420p_block */
+
+
+/* ---------------------------------
+ * p_scalar_rgb_to_yuv420p_rowpair
+ * ---------------------------------
+ * convert the 2x2 blocks of one pair of rows starting at column startCol
+ */
+static void
+p_scalar_rgb_to_yuv420p_rowpair(const guchar *src, gint32 src_bpp, gint32 src_rowstride
+                  , gint32 startCol, gint32 width
+                  , gint32 red, gint32 green, gint32 blue
+                  , guchar *lum, guchar *cb, guchar *cr)
+{
+  gint32 x;
+
+  for(x = startCol; x < width; x += 2)
+  {
+    p_scalar_rgb_to_yuv420p_block(src + (x * src_bpp), src_bpp, src_rowstride
+                  , red, green, blue
+                  , lum + x, width
+                  , cb + (x / 2)
+                  , cr + (x / 2)
+                  );
+  }
+
+}  /* end p_scalar_rgb_to_yuv420p_rowpair */
+
+
+#ifdef GAP_GVE_SIMD_X86
+
+/* ---------------------------------
+ * p_sse2_load4
+ * ---------------------------------
+ * load 4 pixels as 32 bit lanes 0x??BBGGRR
+ */
+static inline __m128i GAP_GVE_TARGET_SSE2
+p_sse2_load4(const guchar *p, gint32 bpp, gint32 red, gint32 green, gint32 blue)
+{
+  if((bpp == 4) && (red == 0) && (green == 1) && (blue == 2))
+  {
+    /* RGBA: the alpha byte is masked out at channel split */
+    return (_mm_loadu_si128((const __m128i *)p));
+  }
+  return (_mm_set_epi32(P_PIXEL32(p + (3 * bpp), red, green, blue)
+                       ,P_PIXEL32(p + (2 * bpp), red, green, blue)
+                       ,P_PIXEL32(p + bpp,       red, green, blue)
+                       ,P_PIXEL32(p,             red, green, blue)
+                       ));
+}  /* end p_sse2_load4 */
+
+
+/* ---------------------------------
+ * p_sse2_luma4
+ * ---------------------------------
+ * split 4 pixels into channels (32 bit lanes) and calculate the luminance.
+ */
+static inline __m128i GAP_GVE_TARGET_SSE2
+p_sse2_luma4(__m128i px, __m128i *r, __m128i *g, __m128i *b)
+{
+  __m128i mask;
+  __m128i rg;
+  __m128i b1;
+
+  mask = _mm_set1_epi32(0xff);
+  *r = _mm_and_si128(px, mask);
+  *g = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+  *b = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+
+  /* (r,g) * (FIX(0.299), FIX(0.587)) + (b,1) * (FIX(0.114), ONE_HALF) */
+  rg = _mm_or_si128(*r, _mm_slli_epi32(*g, 16));
+  b1 = _mm_or_si128(*b, _mm_set1_epi32(1 << 16));
+
+  return (_mm_srai_epi32(_mm_add_epi32(
+                      _mm_madd_epi16(rg, _mm_set1_epi32(P_PAIR16(FIX(0.29900), FIX(0.58700))))
+                    , _mm_madd_epi16(b1, _mm_set1_epi32(P_PAIR16(FIX(0.11400), ONE_HALF))))
+                    , SCALEBITS));
+}  /* end p_sse2_luma4 */
+
+
+/* ---------------------------------
+ * p_sse2_rgb_to_yuv420p_rowpair
+ * ---------------------------------
+ * convert one pair of rows (8 columns per loop).
+ * returns the number of converted columns
+ * (the remaining columns are converted by the caller)
+ */
+static gint32 GAP_GVE_TARGET_SSE2
+p_sse2_rgb_to_yuv420p_rowpair(const guchar *src, gint32 src_bpp, gint32 src_rowstride
+                  , gint32 width
+                  , gint32 red, gint32 green, gint32 blue
+                  , guchar *lum, guchar *cb, guchar *cr)
+{
+  gint32  x;
+  __m128i ones;
+  __m128i offset;
+
+  ones = _mm_set1_epi16(1);
+  offset = _mm_set1_epi32(128);
+
+  for(x = 0; x + 8 <= width; x += 8)
+  {
+    const guchar *p0;
+    const guchar *p1;
+    __m128i r0, g0, b0, r1, g1, b1, r2, g2, b2, r3, g3, b3;
+    __m128i y0, y1, y2, y3;
+    __m128i rs, gs, bs;
+    __m128i rg, bk;
+    __m128i vcb, vcr;
+    gint32  chroma4;
+
+    p0 = src + (x * src_bpp);
+    p1 = p0 + src_rowstride;
+
+    y0 = p_sse2_luma4(p_sse2_load4(p0,                 src_bpp, red, green, blue), &r0, &g0, &b0);
+    y1 = p_sse2_luma4(p_sse2_load4(p0 + (4 * src_bpp), src_bpp, red, green, blue), &r1, &g1, &b1);
+    y2 = p_sse2_luma4(p_sse2_load4(p1,                 src_bpp, red, green, blue), &r2, &g2, &b2);
+    y3 = p_sse2_luma4(p_sse2_load4(p1 + (4 * src_bpp), src_bpp, red, green, blue), &r3, &g3, &b3);
+
+    y0 = _mm_packs_epi32(y0, y1);
+    _mm_storel_epi64((__m128i *)(lum + x), _mm_packus_epi16(y0, y0));
+    y2 = _mm_packs_epi32(y2, y3);
+    _mm_storel_epi64((__m128i *)(lum + width + x), _mm_packus_epi16(y2, y2));
+
+    /* sum of the 2x2 blocks: vertical add at 16 bit, horizontal add via pmaddwd */
+    rs = _mm_madd_epi16(_mm_add_epi16(_mm_packs_epi32(r0, r1), _mm_packs_epi32(r2, r3)), ones);
+    gs = _mm_madd_epi16(_mm_add_epi16(_mm_packs_epi32(g0, g1), _mm_packs_epi32(g2, g3)), ones);
+    bs = _mm_madd_epi16(_mm_add_epi16(_mm_packs_epi32(b0, b1), _mm_packs_epi32(b2, b3)), ones);
+
+    rg = _mm_or_si128(rs, _mm_slli_epi32(gs, 16));
+    bk = _mm_or_si128(bs, _mm_set1_epi32((4 * ONE_HALF - 1) << 16));
+
+    vcb = _mm_add_epi32(_mm_madd_epi16(rg, _mm_set1_epi32(P_PAIR16(- FIX(0.16874), - FIX(0.33126))))
+                      , _mm_madd_epi16(bk, _mm_set1_epi32(P_PAIR16(FIX(0.50000), 1))));
+    vcr = _mm_add_epi32(_mm_madd_epi16(rg, _mm_set1_epi32(P_PAIR16(FIX(0.50000), - FIX(0.41869))))
+                      , _mm_madd_epi16(bk, _mm_set1_epi32(P_PAIR16(- FIX(0.08131), 1))));
+    vcb = _mm_add_epi32(_mm_srai_epi32(vcb, SCALEBITS + 2), offset);
+    vcr = _mm_add_epi32(_mm_srai_epi32(vcr, SCALEBITS + 2), offset);
+
+    vcb = _mm_packs_epi32(vcb, vcb);
+    chroma4 = _mm_cvtsi128_si32(_mm_packus_epi16(vcb, vcb));
+    memcpy(cb + (x / 2), &chroma4, 4);
+    vcr = _mm_packs_epi32(vcr, vcr);
+    chroma4 = _mm_cvtsi128_si32(_mm_packus_epi16(vcr, vcr));
+    memcpy(cr + (x / 2), &chroma4, 4);
+  }
+  return (x);
+
+}  /* end p_sse2_rgb_to_yuv420p_rowpair */
+
+
+/* ---------------------------------
+ * p_avx2_load8
+ * ---------------------------------
+ * load 8 pixels as 32 bit lanes 0x??BBGGRR
+ */
+static inline __m256i GAP_GVE_TARGET_AVX2
+p_avx2_load8(const guchar *p, gint32 bpp, gint32 red, gint32 green, gint32 blue)
+{
+  if((red == 0) && (green == 1) && (blue == 2))
+  {
+    if(bpp == 4)
+    {
+      return (_mm256_loadu_si256((const __m256i *)p));
+    }
+    if(bpp == 3)
+    {
+      __m256i px;
+
+      /* 2 x 16 byte loads (4 pixels each in the low 12 bytes) and
+       * spread each 3 byte pixel to one 32 bit lane.
+       * Note: reads 4 bytes beyond the 8th pixel (see P_AVX2_LOAD8_TAIL)
+       */
+      px = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)p))
+                                  , _mm_loadu_si128((const __m128i *)(p + 12))
+                                  , 1);
+      return (_mm256_shuffle_epi8(px, _mm256_setr_epi8(
+                   0, 1, 2, -1,  3, 4, 5, -1,  6, 7, 8, -1,  9, 10, 11, -1
+                 , 0, 1, 2, -1,  3, 4, 5, -1,  6, 7, 8, -1,  9, 10, 11, -1)));
+    }
+  }
+  return (_mm256_set_epi32(P_PIXEL32(p + (7 * bpp), red, green, blue)
+                          ,P_PIXEL32(p + (6 * bpp), red, green, blue)
+                          ,P_PIXEL32(p + (5 * bpp), red, green, blue)
+                          ,P_PIXEL32(p + (4 * bpp), red, green, blue)
+                          ,P_PIXEL32(p + (3 * bpp), red, green, blue)
+                          ,P_PIXEL32(p + (2 * bpp), red, green, blue)
+                          ,P_PIXEL32(p + bpp,       red, green, blue)
+                          ,P_PIXEL32(p,             red, green, blue)
+                          ));
+}  /* end p_avx2_load8 */
+
+
+/* ---------------------------------
+ * p_avx2_luma8
+ * ---------------------------------
+ */
+static inline __m256i GAP_GVE_TARGET_AVX2
+p_avx2_luma8(__m256i px, __m256i *r, __m256i *g, __m256i *b)
+{
+  __m256i mask;
+  __m256i rg;
+  __m256i b1;
+
+  mask = _mm256_set1_epi32(0xff);
+  *r = _mm256_and_si256(px, mask);
+  *g = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+  *b = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask);
+
+  rg = _mm256_or_si256(*r, _mm256_slli_epi32(*g, 16));
+  b1 = _mm256_or_si256(*b, _mm256_set1_epi32(1 << 16));
+
+  return (_mm256_srai_epi32(_mm256_add_epi32(
+                      _mm256_madd_epi16(rg, _mm256_set1_epi32(P_PAIR16(FIX(0.29900), FIX(0.58700))))
+                    , _mm256_madd_epi16(b1, _mm256_set1_epi32(P_PAIR16(FIX(0.11400), ONE_HALF))))
+                    , SCALEBITS));
+}  /* end p_avx2_luma8 */
+
+
+/* ---------------------------------
+ * p_avx2_pack16
+ * ---------------------------------
+ * pack 2 x 8 32 bit lanes (in order) to 16 x 16 bit lanes in order.
+ * (the pack instructions operate per 128 bit lane and need a permute)
+ */
+static inline __m256i GAP_GVE_TARGET_AVX2
+p_avx2_pack16(__m256i a, __m256i b)
+{
+  return (_mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8));
+}  /* end p_avx2_pack16 */
+
+
+/* ---------------------------------
+ * p_avx2_rgb_to_yuv420p_rowpair
+ * ---------------------------------
+ * convert one pair of rows (16 columns per loop).
+ * returns the number of converted columns
+ */
+static gint32 GAP_GVE_TARGET_AVX2
+p_avx2_rgb_to_yuv420p_rowpair(const guchar *src, gint32 src_bpp, gint32 src_rowstride
+                  , gint32 width
+                  , gint32 red, gint32 green, gint32 blue
+                  , guchar *lum, guchar *cb, guchar *cr)
+{
+  gint32  x;
+  __m256i ones;
+  __m256i offset;
+
+  ones = _mm256_set1_epi16(1);
+  offset = _mm256_set1_epi32(128);
+
+  for(x = 0; x + 16 + P_AVX2_LOAD8_TAIL <= width; x += 16)
+  {
+    const guchar *p0;
+    const guchar *p1;
+    __m256i r0, g0, b0, r1, g1, b1, r2, g2, b2, r3, g3, b3;
+    __m256i y0, y1, y2, y3;
+    __m256i rs, gs, bs;
+    __m256i rg, bk;
+    __m256i vcb, vcr;
+    __m128i lo, hi;
+
+    p0 = src + (x * src_bpp);
+    p1 = p0 + src_rowstride;
+
+    y0 = p_avx2_luma8(p_avx2_load8(p0,                 src_bpp, red, green, blue), &r0, &g0, &b0);
+    y1 = p_avx2_luma8(p_avx2_load8(p0 + (8 * src_bpp), src_bpp, red, green, blue), &r1, &g1, &b1);
+    y2 = p_avx2_luma8(p_avx2_load8(p1,                 src_bpp, red, green, blue), &r2, &g2, &b2);
+    y3 = p_avx2_luma8(p_avx2_load8(p1 + (8 * src_bpp), src_bpp, red, green, blue), &r3, &g3, &b3);
+
+    /* 16 x 16 bit in order --> 16 bytes (lane0 low 8 bytes, lane1 low 8 bytes) */
+    y0 = p_avx2_pack16(y0, y1);
+    y0 = _mm256_permute4x64_epi64(_mm256_packus_epi16(y0, y0), 0x08);
+    _mm_storeu_si128((__m128i *)(lum + x), _mm256_castsi256_si128(y0));
+    y2 = p_avx2_pack16(y2, y3);
+    y2 = _mm256_permute4x64_epi64(_mm256_packus_epi16(y2, y2), 0x08);
+    _mm_storeu_si128((__m128i *)(lum + width + x), _mm256_castsi256_si128(y2));
+
+    rs = _mm256_madd_epi16(_mm256_add_epi16(p_avx2_pack16(r0, r1), p_avx2_pack16(r2, r3)), ones);
+    gs = _mm256_madd_epi16(_mm256_add_epi16(p_avx2_pack16(g0, g1), p_avx2_pack16(g2, g3)), ones);
+    bs = _mm256_madd_epi16(_mm256_add_epi16(p_avx2_pack16(b0, b1), p_avx2_pack16(b2, b3)), ones);
+
+    rg = _mm256_or_si256(rs, _mm256_slli_epi32(gs, 16));
+    bk = _mm256_or_si256(bs, _mm256_set1_epi32((4 * ONE_HALF - 1) << 16));
+
+    vcb = _mm256_add_epi32(_mm256_madd_epi16(rg, _mm256_set1_epi32(P_PAIR16(- FIX(0.16874), - FIX(0.33126))))
+                         , _mm256_madd_epi16(bk, _mm256_set1_epi32(P_PAIR16(FIX(0.50000), 1))));
+    vcr = _mm256_add_epi32(_mm256_madd_epi16(rg, _mm256_set1_epi32(P_PAIR16(FIX(0.50000), - FIX(0.41869))))
+                         , _mm256_madd_epi16(bk, _mm256_set1_epi32(P_PAIR16(- FIX(0.08131), 1))));
+    vcb = _mm256_add_epi32(_mm256_srai_epi32(vcb, SCALEBITS + 2), offset);
+    vcr = _mm256_add_epi32(_mm256_srai_epi32(vcr, SCALEBITS + 2), offset);
+
+    /* 8 x 32 bit --> 8 bytes (the 1st 4 bytes of each 128 bit lane) */
+    vcb = _mm256_packs_epi32(vcb, vcb);
+    vcb = _mm256_packus_epi16(vcb, vcb);
+    lo = _mm256_castsi256_si128(vcb);
+    hi = _mm256_extracti128_si256(vcb, 1);
+    _mm_storel_epi64((__m128i *)(cb + (x / 2)), _mm_unpacklo_epi32(lo, hi));
+
+    vcr = _mm256_packs_epi32(vcr, vcr);
+    vcr = _mm256_packus_epi16(vcr, vcr);
+    lo = _mm256_castsi256_si128(vcr);
+    hi = _mm256_extracti128_si256(vcr, 1);
+    _mm_storel_epi64((__m128i *)(cr + (x / 2)), _mm_unpacklo_epi32(lo, hi));
+  }
+  return (x);
+
+}  /* end p_avx2_rgb_to_yuv420p_rowpair */
+
+#endif  /* GAP_GVE_SIMD_X86 */
+
+
+/* ------------------------------------
+ * gap_gve_raw_simd_rgb_to_yuv420p
+ * ------------------------------------
+ */
+void
+gap_gve_raw_simd_rgb_to_yuv420p(const guchar *src, gint32 src_bpp, gint32 src_rowstride
+                  , gint32 width, gint32 height
+                  , gint32 red, gint32 green, gint32 blue
+                  , guchar *lum, guchar *cb, guchar *cr)
+{
+  gint32 y;
+
+  p_simd_init();
+
+  for(y = 0; y < height; y += 2)
+  {
+    gint32 x;
+
+    x = 0;
+#ifdef GAP_GVE_SIMD_X86
+    if(simdAvx2)
+    {
+      x = p_avx2_rgb_to_yuv420p_rowpair(src, src_bpp, src_rowstride, width
+                    , red, green, blue, lum, cb, cr);
+    }
+    else if(simdSse2)
+    {
+      x = p_sse2_rgb_to_yuv420p_rowpair(src, src_bpp, src_rowstride, width
+                    , red, green, blue, lum, cb, cr);
+    }
+#endif
+    /* remaining columns (or all columns on CPUs without vector support) */
+    p_scalar_rgb_to_yuv420p_rowpair(src, src_bpp, src_rowstride, x, width
+                    , red, green, blue, lum, cb, cr);
+
+    src += 2 * src_rowstride;
+    lum += 2 * width;
+    cb  += width / 2;
+    cr  += width / 2;
+  }
+
+}  /* end gap_gve_raw_simd_rgb_to_yuv420p */
+
+
+/*************************************************************
+ *          RGB to YUV444                                    *
+ *************************************************************/
+
+/* ---------------------------------
+ * p_scalar_rgb_row_to_yuv444
+ * ---------------------------------
+ * convert pixels startCol upto width-1 of one row.
+ * (this is the reference implementation)
+ */
+static void
+p_scalar_rgb_row_to_yuv444(const guchar *src, gint32 src_bpp, gint32 startCol, gint32 width
+                  , gint32 red, gint32 green, gint32 blue
+                  , gdouble coef_r, gdouble coef_g, gdouble coef_b
+                  , gdouble coef_u, gdouble coef_v
+                  , guchar *yp, guchar *up, guchar *vp)
+{
+  gint32 j;
+  const guchar *l_bptr;
+
+  l_bptr = src + (startCol * src_bpp);
+  for (j = startCol; j < width; j++)
+  {
+    int r, g, b;
+    double y, u, v;
+
+    /* peek RGB (for grey images: R==G==B) */
+    r=l_bptr[red];
+    g=l_bptr[green];
+    b=l_bptr[blue];
+
+    /* convert to YUV */
+    y = coef_r*r + coef_g*g + coef_b*b;
+    u = coef_u*(b-y);
+    v = coef_v*(r-y);
+    yp[j] = (219.0/256.0)*y + 16.5;  /* nominal range: 16..235 */
+    up[j] = (224.0/256.0)*u + 128.5; /* 16..240 */
+    vp[j] = (224.0/256.0)*v + 128.5; /* 16..240 */
+
+    l_bptr += src_bpp;   /* advance read pointer */
+  }
+
+}  /* end p_scalar_rgb_row_to_yuv444 */
+
+
+#ifdef GAP_GVE_SIMD_X86_DOUBLE
+
+/* ---------------------------------
+ * p_sse2_yuv444_2
+ * ---------------------------------
+ * convert 2 pixels (r, g, b as doubles) to 2 x (y, u, v) as 32 bit integers
+ * in the low half of the results.
+ */
+static inline void GAP_GVE_TARGET_SSE2
+p_sse2_yuv444_2(__m128d r, __m128d g, __m128d b
+  , __m128d coef_r, __m128d coef_g, __m128d coef_b, __m128d coef_u, __m128d coef_v
+  , __m128i *yi, __m128i *ui, __m128i *vi)
+{
+  __m128d y, u, v;
+
+  /* same order of operations as the scalar implementation */
+  y = _mm_add_pd(_mm_add_pd(_mm_mul_pd(coef_r, r), _mm_mul_pd(coef_g, g)), _mm_mul_pd(coef_b, b));
+  u = _mm_mul_pd(coef_u, _mm_sub_pd(b, y));
+  v = _mm_mul_pd(coef_v, _mm_sub_pd(r, y));
+
+  *yi = _mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(219.0/256.0), y), _mm_set1_pd(16.5)));
+  *ui = _mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(224.0/256.0), u), _mm_set1_pd(128.5)));
+  *vi = _mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(224.0/256.0), v), _mm_set1_pd(128.5)));
+}  /* end p_sse2_yuv444_2 */
+
+
+/* ---------------------------------
+ * p_sse2_store4_bytes
+ * ---------------------------------
+ * store the low 2 lanes of lo and hi as 4 bytes
+ */
+static inline void GAP_GVE_TARGET_SSE2
+p_sse2_store4_bytes(guchar *dst, __m128i lo, __m128i hi)
+{
+  __m128i v;
+  gint32  bytes4;
+
+  v = _mm_unpacklo_epi64(lo, hi);
+  v = _mm_packs_epi32(v, v);
+  bytes4 = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+  memcpy(dst, &bytes4, 4);
+}  /* end p_sse2_store4_bytes */
+
+
+/* ---------------------------------
+ * p_sse2_rgb_row_to_yuv444
+ * ---------------------------------
+ * returns the number of converted pixels (4 per loop)
+ */
+static gint32 GAP_GVE_TARGET_SSE2
+p_sse2_rgb_row_to_yuv444(const guchar *src, gint32 src_bpp, gint32 width
+                  , gint32 red, gint32 green, gint32 blue
+                  , gdouble dcoef_r, gdouble dcoef_g, gdouble dcoef_b
+                  , gdouble dcoef_u, gdouble dcoef_v
+                  , guchar *yp, guchar *up, guchar *vp)
+{
+  gint32  j;
+  __m128d coef_r, coef_g, coef_b, coef_u, coef_v;
+  __m128i mask;
+
+  coef_r = _mm_set1_pd(dcoef_r);
+  coef_g = _mm_set1_pd(dcoef_g);
+  coef_b = _mm_set1_pd(dcoef_b);
+  coef_u = _mm_set1_pd(dcoef_u);
+  coef_v = _mm_set1_pd(dcoef_v);
+  mask = _mm_set1_epi32(0xff);
+
+  for(j = 0; j + 4 <= width; j += 4)
+  {
+    __m128i px, r, g, b;
+    __m128i ylo, ulo, vlo, yhi, uhi, vhi;
+
+    px = p_sse2_load4(src + (j * src_bpp), src_bpp, red, green, blue);
+    r = _mm_and_si128(px, mask);
+    g = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+    b = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+
+    p_sse2_yuv444_2(_mm_cvtepi32_pd(r), _mm_cvtepi32_pd(g), _mm_cvtepi32_pd(b)
+                   , coef_r, coef_g, coef_b, coef_u, coef_v, &ylo, &ulo, &vlo);
+    p_sse2_yuv444_2(_mm_cvtepi32_pd(_mm_shuffle_epi32(r, 0xEE))
+                   , _mm_cvtepi32_pd(_mm_shuffle_epi32(g, 0xEE))
+                   , _mm_cvtepi32_pd(_mm_shuffle_epi32(b, 0xEE))
+                   , coef_r, coef_g, coef_b, coef_u, coef_v, &yhi, &uhi, &vhi);
+
+    p_sse2_store4_bytes(yp + j, ylo, yhi);
+    p_sse2_store4_bytes(up + j, ulo, uhi);
+    p_sse2_store4_bytes(vp + j, vlo, vhi);
+  }
+  return (j);
+
+}  /* end p_sse2_rgb_row_to_yuv444 */
+
+
+/* ---------------------------------
+ * p_avx2_rgb_row_to_yuv444
+ * ---------------------------------
+ * returns the number of converted pixels (8 per loop)
+ */
+static gint32 GAP_GVE_TARGET_AVX2
+p_avx2_rgb_row_to_yuv444(const guchar *src, gint32 src_bpp, gint32 width
+                  , gint32 red, gint32 green, gint32 blue
+                  , gdouble dcoef_r, gdouble dcoef_g, gdouble dcoef_b
+                  , gdouble dcoef_u, gdouble dcoef_v
+                  , guchar *yp, guchar *up, guchar *vp)
+{
+  gint32  j;
+  __m256d coef_r, coef_g, coef_b, coef_u, coef_v;
+  __m256d k219, k224, k16, k128;
+  __m256i mask;
+
+  coef_r = _mm256_set1_pd(dcoef_r);
+  coef_g = _mm256_set1_pd(dcoef_g);
+  coef_b = _mm256_set1_pd(dcoef_b);
+  coef_u = _mm256_set1_pd(dcoef_u);
+  coef_v = _mm256_set1_pd(dcoef_v);
+  k219 = _mm256_set1_pd(219.0/256.0);
+  k224 = _mm256_set1_pd(224.0/256.0);
+  k16  = _mm256_set1_pd(16.5);
+  k128 = _mm256_set1_pd(128.5);
+  mask = _mm256_set1_epi32(0xff);
+
+  for(j = 0; j + 8 + P_AVX2_LOAD8_TAIL <= width; j += 8)
+  {
+    __m256i px, ri, gi, bi;
+    __m128i yq[2], uq[2], vq[2];
+    __m128i v16;
+    gint    half;
+
+    px = p_avx2_load8(src + (j * src_bpp), src_bpp, red, green, blue);
+    ri = _mm256_and_si256(px, mask);
+    gi = _mm256_and_si256(_mm256_srli_epi32(px, 8), mask);
+    bi = _mm256_and_si256(_mm256_srli_epi32(px, 16), mask);
+
+    for(half = 0; half < 2; half++)
+    {
+      __m256d r, g, b, y, u, v;
+
+      if(half == 0)
+      {
+        r = _mm256_cvtepi32_pd(_mm256_castsi256_si128(ri));
+        g = _mm256_cvtepi32_pd(_mm256_castsi256_si128(gi));
+        b = _mm256_cvtepi32_pd(_mm256_castsi256_si128(bi));
+      }
+      else
+      {
+        r = _mm256_cvtepi32_pd(_mm256_extracti128_si256(ri, 1));
+        g = _mm256_cvtepi32_pd(_mm256_extracti128_si256(gi, 1));
+        b = _mm256_cvtepi32_pd(_mm256_extracti128_si256(bi, 1));
+      }
+
+      /* same order of operations as the scalar implementation */
+      y = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(coef_r, r), _mm256_mul_pd(coef_g, g)), _mm256_mul_pd(coef_b, b));
+      u = _mm256_mul_pd(coef_u, _mm256_sub_pd(b, y));
+      v = _mm256_mul_pd(coef_v, _mm256_sub_pd(r, y));
+
+      yq[half] = _mm256_cvttpd_epi32(_mm256_add_pd(_mm256_mul_pd(k219, y), k16));
+      uq[half] = _mm256_cvttpd_epi32(_mm256_add_pd(_mm256_mul_pd(k224, u), k128));
+      vq[half] = _mm256_cvttpd_epi32(_mm256_add_pd(_mm256_mul_pd(k224, v), k128));
+    }
+
+    v16 = _mm_packs_epi32(yq[0], yq[1]);
+    _mm_storel_epi64((__m128i *)(yp + j), _mm_packus_epi16(v16, v16));
+    v16 = _mm_packs_epi32(uq[0], uq[1]);
+    _mm_storel_epi64((__m128i *)(up + j), _mm_packus_epi16(v16, v16));
+    v16 = _mm_packs_epi32(vq[0], vq[1]);
+    _mm_storel_epi64((__m128i *)(vp + j), _mm_packus_epi16(v16, v16));
+  }
+  return (j);
+
+}  /* end p_avx2_rgb_row_to_yuv444 */
+
+#endif  /* GAP_GVE_SIMD_X86_DOUBLE */
+
+
+/* ------------------------------------
+ * gap_gve_raw_simd_rgb_row_to_yuv444
+ * ------------------------------------
+ */
+void
+gap_gve_raw_simd_rgb_row_to_yuv444(const guchar *src, gint32 src_bpp, gint32 width
+                  , gint32 red, gint32 green, gint32 blue
+                  , gdouble coef_r, gdouble coef_g, gdouble coef_b
+                  , gdouble coef_u, gdouble coef_v
+                  , guchar *yp, guchar *up, guchar *vp)
+{
+  gint32 j;
+
+  p_simd_init();
+
+  j = 0;
+#ifdef GAP_GVE_SIMD_X86_DOUBLE
+  if(simdAvx2)
+  {
+    j = p_avx2_rgb_row_to_yuv444(src, src_bpp, width, red, green, blue
+              , coef_r, coef_g, coef_b, coef_u, coef_v, yp, up, vp);
+  }
+  else if(simdSse2)
+  {
+    j = p_sse2_rgb_row_to_yuv444(src, src_bpp, width, red, green, blue
+              , coef_r, coef_g, coef_b, coef_u, coef_v, yp, up, vp);
+  }
+#endif
+  p_scalar_rgb_row_to_yuv444(src, src_bpp, j, width, red, green, blue
+              , coef_r, coef_g, coef_b, coef_u, coef_v, yp, up, vp);
+
+}  /* end gap_gve_raw_simd_rgb_row_to_yuv444 */
+
+
+/*************************************************************
+ *          RGB to BGR                                       *
+ *************************************************************/
+
+#ifdef GAP_GVE_SIMD_X86
+
+/* ---------------------------------
+ * p_ssse3_swap_rgb_to_bgr
+ * ---------------------------------
+ * swap R and B of packed 3 byte pixels.
+ * processes 16 pixels (3 x 16 bytes) per loop. Each output block
+ * is combined from byte shuffles of the input block and its neighbours
+ * (pixels that cross the 16 byte borders).
+ * returns the number of converted pixels.
+ */
+static gint32 GAP_GVE_TARGET_SSSE3
+p_ssse3_swap_rgb_to_bgr(guchar *data, gint32 pixelCount)
+{
+  gint32  done;
+  __m128i m00, m01, m10, m11, m12, m21, m22;
+
+  /* mXY: shuffle mask to get bytes of output block X from input block Y (-1 == zero) */
+  m00 = _mm_setr_epi8( 2,  1,  0,  5,  4,  3,  8,  7,  6, 11, 10,  9, 14, 13, 12, -1);
+  m01 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  1);
+  m10 = _mm_setr_epi8(-1, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  m11 = _mm_setr_epi8( 0, -1,  4,  3,  2,  7,  6,  5, 10,  9,  8, 13, 12, 11, -1, 15);
+  m12 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0, -1);
+  m21 = _mm_setr_epi8(14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  m22 = _mm_setr_epi8(-1,  3,  2,  1,  6,  5,  4,  9,  8,  7, 12, 11, 10, 15, 14, 13);
+
+  for(done = 0; done + 16 <= pixelCount; done += 16)
+  {
+    __m128i *ptr;
+    __m128i a, b, c;
+
+    ptr = (__m128i *)(data + (done * 3));
+    a = _mm_loadu_si128(ptr);
+    b = _mm_loadu_si128(ptr + 1);
+    c = _mm_loadu_si128(ptr + 2);
+
+    _mm_storeu_si128(ptr,     _mm_or_si128(_mm_shuffle_epi8(a, m00), _mm_shuffle_epi8(b, m01)));
+    _mm_storeu_si128(ptr + 1, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m10), _mm_shuffle_epi8(b, m11))
+                                         , _mm_shuffle_epi8(c, m12)));
+    _mm_storeu_si128(ptr + 2, _mm_or_si128(_mm_shuffle_epi8(b, m21), _mm_shuffle_epi8(c, m22)));
+  }
+  return (done);
+
+}  /* end p_ssse3_swap_rgb_to_bgr */
+
+#endif  /* GAP_GVE_SIMD_X86 */
+
+
+/* ------------------------------------
+ * gap_gve_raw_simd_swap_rgb_to_bgr
+ * ------------------------------------
+ */
+void
+gap_gve_raw_simd_swap_rgb_to_bgr(guchar *data, gint32 pixelCount, gint32 bpp)
+{
+  gint32   done;
+  guchar  *ptrA;
+  guchar  *ptrB;
+
+  p_simd_init();
+
+  done = 0;
+#ifdef GAP_GVE_SIMD_X86
+  if((simdSsse3) && (bpp == 3))
+  {
+    done = p_ssse3_swap_rgb_to_bgr(data, pixelCount);
+  }
+#endif
+
+  ptrA = &data[(done * bpp)];
+  ptrB = &data[(done * bpp) + 2];
+
+  for (; done < pixelCount; done++)
+  {
+    guchar tmp;
+
+    tmp = *ptrA;
+    *ptrA = *ptrB;
+    *ptrB = tmp;
+
+    ptrA += bpp;
+    ptrB += bpp;
+  }
+
+}  /* end gap_gve_raw_simd_swap_rgb_to_bgr */
@@ -0,0 +1,81 @@
+/* gap_gve_raw_simd.h
+ *
+ * (GAP ... GIMP Animation Plugins, now also known as GIMP Video)
+ *    colormodel conversion kernels for RAW video encoding
+ *    with SSE2 / SSSE3 / AVX2 implementations (runtime CPU dispatch)
+ *
+ */
+
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * version 2.7.0; 2026.10.18  created
+ */
+
+#ifndef GAP_GVE_RAW_SIMD_H
+#define GAP_GVE_RAW_SIMD_H
+
+/* GIMP includes */
+#include "gtk/gtk.h"
+#include "libgimp/gimp.h"
+
+
+/* ------------------------------------
+ * gap_gve_raw_simd_rgb_to_yuv420p
+ * ------------------------------------
+ * convert the pixel data src (height rows of width pixels with src_bpp bytes per pixel)
+ * to planar YUV420P written to lum, cb and cr.
+ * red, green, blue are the byte offsets of the color channels within one pixel
+ * (all 0 for GRAY images).
+ * both width and height must be a multiple of 2.
+ * The result is bit-exact with the scalar fixed point implementation
+ * on all CPU types.
+ */
+void
+gap_gve_raw_simd_rgb_to_yuv420p(const guchar *src, gint32 src_bpp, gint32 src_rowstride
+                  , gint32 width, gint32 height
+                  , gint32 red, gint32 green, gint32 blue
+                  , guchar *lum, guchar *cb, guchar *cr);
+
+/* ------------------------------------
+ * gap_gve_raw_simd_rgb_row_to_yuv444
+ * ------------------------------------
+ * convert one pixel row src (width pixels with src_bpp bytes per pixel)
+ * to YUV 4:4:4 using the matrix coefficients coef_r, coef_g, coef_b
+ * and the chroma scale factors coef_u, coef_v.
+ * The vector implementation is only used where it is bit-exact with
+ * the scalar double precision code (SSE2 math without FMA contraction).
+ */
+void
+gap_gve_raw_simd_rgb_row_to_yuv444(const guchar *src, gint32 src_bpp, gint32 width
+                  , gint32 red, gint32 green, gint32 blue
+                  , gdouble coef_r, gdouble coef_g, gdouble coef_b
+                  , gdouble coef_u, gdouble coef_v
+                  , guchar *yp, guchar *up, guchar *vp);
+
+/* ------------------------------------
+ * gap_gve_raw_simd_swap_rgb_to_bgr
+ * ------------------------------------
+ * swap the 1st and 3rd byte of pixelCount pixels with bpp bytes per pixel
+ * (converts RGB to BGR and vice versa)
+ */
+void
+gap_gve_raw_simd_swap_rgb_to_bgr(guchar *data, gint32 pixelCount, gint32 bpp);
+
+#endif
@@ -0,0 +1,463 @@
+/* gap_gve_raw_simd_bench.c
+ *
+ * (GAP ... GIMP Animation Plugins, now also known as GIMP Video)
+ *    equality check and micro-benchmark for the colormodel conversion
+ *    kernels in gap_gve_raw_simd.c
+ *
+ * The test frames are generated (random pixels with a fixed seed
+ * and saturated color patterns) and converted by
+ *   a) the original scalar loops of gap_gve_raw.c (copied below as reference)
+ *   b) gap_gve_raw_simd_* at each dispatch level the CPU supports
+ *      (scalar, SSE2/SSSE3, AVX2)
+ * All results must be bit-identical to the reference.
+ *
+ * usage:
+ *   gap_gve_raw_simd_bench            equality check only (run by make check)
+ *   gap_gve_raw_simd_bench -b [N]     equality check and benchmark with N loops per frame size
+ *                                     (default 50) for 720x576, 1280x720 and 1920x1080
+ */
+
+/* The GIMP -- an image manipulation program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+/* revision history:
+ * version 2.7.0; 2026.10.18  created
+ */
+
+#include <stdlib.h>
+
+/* the kernels are included (not linked) to switch the static dispatch level */
+#include "gap_gve_raw_simd.c"
+
+#define BENCH_LEVEL_SCALAR   0
+#define BENCH_LEVEL_SSE2     1
+#define BENCH_LEVEL_AVX2     2
+
+int gap_debug = 0;
+
+static gboolean cpuSse2;
+static gboolean cpuSsse3;
+static gboolean cpuAvx2;
+
+
+/* ---------------------------------
+ * p_set_level
+ * ---------------------------------
+ * force the dispatch level of the kernels
+ * return FALSE if the CPU does not support the level.
+ */
+static gboolean
+p_set_level(gint level)
+{
+  p_simd_init();
+  simdSse2  = (level >= BENCH_LEVEL_SSE2) && cpuSse2;
+  simdSsse3 = (level >= BENCH_LEVEL_SSE2) && cpuSsse3;
+  simdAvx2  = (level >= BENCH_LEVEL_AVX2) && cpuAvx2;
+  if(level == BENCH_LEVEL_SSE2)
+  {
+    return (cpuSse2);
+  }
+  if(level == BENCH_LEVEL_AVX2)
+  {
+    return (cpuAvx2);
+  }
+  return (TRUE);
+}  /* end p_set_level */
+
+
+/* ---------------------------------
+ * p_generate_frame
+ * ---------------------------------
+ * pattern 0: random pixels, pattern 1: saturated colors (0 / 255 only)
+ */
+static guchar *
+p_generate_frame(gint32 width, gint32 height, gint32 bpp, gint pattern)
+{
+  guchar *data;
+  gint32  ii;
+  gint32  size;
+
+  size = width * height * bpp;
+  data = g_malloc(size + 32);
+  for(ii = 0; ii < size + 32; ii++)
+  {
+    if(pattern == 0)
+    {
+      data[ii] = rand() & 255;
+    }
+    else
+    {
+      data[ii] = ((rand() & 1) ? 255 : 0);
+    }
+  }
+  return (data);
+}  /* end p_generate_frame */
+
+
+/* ---------------------------------
+ * p_ref_yuv420p
+ * ---------------------------------
+ * original scalar loop of gap_gve_raw_YUV420P_drawable_encode
+ */
+static void
+p_ref_yuv420p(const guchar *all, gint32 bpp, gint32 width, gint32 height
+   , gint32 l_red, gint32 l_green, gint32 l_blue, guchar *yuv420_buffer)
+{
+  gint32 wrap, wrap3, x, y;
+  gint   r, g, b, r1, g1, b1;
+  const guchar *p;
+  guchar *lum, *cb, *cr;
+
+  wrap = width;
+  wrap3 = width * bpp;
+  lum = yuv420_buffer;
+  cb = lum + (width * height);
+  cr = cb + ((width * height) / 4);
+
+  for(y = 0; y < height; y += 2)
+  {
+    p = all + (y * wrap3);
+    for(x = 0; x < width; x += 2)
+    {
+      r = p[l_red]; g = p[l_green]; b = p[l_blue];
+      r1 = r; g1 = g; b1 = b;
+      lum[0] = (FIX(0.29900) * r + FIX(0.58700) * g + FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
+      r = p[bpp + l_red]; g = p[bpp + l_green]; b = p[bpp + l_blue];
+      r1 += r; g1 += g; b1 += b;
+      lum[1] = (FIX(0.29900) * r + FIX(0.58700) * g + FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
+      p += wrap3;
+      lum += wrap;
+
+      r = p[l_red]; g = p[l_green]; b = p[l_blue];
+      r1 += r; g1 += g; b1 += b;
+      lum[0] = (FIX(0.29900) * r + FIX(0.58700) * g + FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
+      r = p[bpp + l_red]; g = p[bpp + l_green]; b = p[bpp + l_blue];
+      r1 += r; g1 += g; b1 += b;
+      lum[1] = (FIX(0.29900) * r + FIX(0.58700) * g + FIX(0.11400) * b + ONE_HALF) >> SCALEBITS;
+
+      cb[0] = ((- FIX(0.16874) * r1 - FIX(0.33126) * g1 + FIX(0.50000) * b1 + 4 * ONE_HALF - 1) >> (SCALEBITS + 2)) + 128;
+      cr[0] = ((FIX(0.50000) * r1 - FIX(0.41869) * g1 - FIX(0.08131) * b1 + 4 * ONE_HALF - 1) >> (SCALEBITS + 2)) + 128;
+
+      cb++;
+      cr++;
+      p += -wrap3 + 2 * bpp;
+      lum += -wrap + 2;
+    }
+    lum += wrap;
+  }
+}  /* end p_ref_yuv420p */
+
+
+/* ---------------------------------
+ * p_ref_yuv444_row
+ * ---------------------------------
+ * original scalar loop of gap_gve_raw_YUV444_drawable_encode (one row)
+ */
+static void
+p_ref_yuv444_row(const guchar *l_bptr, gint32 bpp, gint32 width
+   , gint32 l_red, gint32 l_green, gint32 l_blue
+   , double cr, double cg, double cb, double cu, double cv
+   , guchar *yp, guchar *up, guchar *vp)
+{
+  gint32 j;
+  int    r, g, b;
+  double y, u, v;
+
+  for (j = 0; j < width; j++)
+  {
+    r = l_bptr[l_red];
+    g = l_bptr[l_green];
+    b = l_bptr[l_blue];
+
+    y = cr*r + cg*g + cb*b;
+    u = cu*(b-y);
+    v = cv*(r-y);
+    yp[j] = (219.0/256.0)*y + 16.5;
+    up[j] = (224.0/256.0)*u + 128.5;
+    vp[j] = (224.0/256.0)*v + 128.5;
+
+    l_bptr += bpp;
+  }
+}  /* end p_ref_yuv444_row */
+
+
+/* ---------------------------------
+ * p_ref_bgr
+ * ---------------------------------
+ * original scalar loop of gap_gve_convert_GapRgbPixelBuffer_To_BGR
+ */
+static void
+p_ref_bgr(guchar *data, gint32 pixelCount, gint32 bpp)
+{
+  gint32 ii;
+  guchar tmp;
+
+  for(ii = 0; ii < pixelCount; ii++)
+  {
+    tmp = data[0];
+    data[0] = data[2];
+    data[2] = tmp;
+    data += bpp;
+  }
+}  /* end p_ref_bgr */
+
+
+/* ---------------------------------
+ * p_check_frame
+ * ---------------------------------
+ * compare all kernels at the current dispatch level against the reference.
+ * return the number of mismatches.
+ */
+static gint
+p_check_frame(const guchar *src, gint32 width, gint32 height, gint32 bpp, gint level)
+{
+  gint32  red, green, blue;
+  gint32  size;
+  gint32  row;
+  gint    errors;
+  guchar *refBuf;
+  guchar *newBuf;
+  double  cr, cg, cb, cu, cv;
+
+  errors = 0;
+  red = 0;
+  green = (bpp >= 3) ? 1 : 0;
+  blue = (bpp >= 3) ? 2 : 0;
+  size = width * height;
+  refBuf = g_malloc0(size * 3);
+  newBuf = g_malloc0(size * 3);
+
+  p_ref_yuv420p(src, bpp, width, height, red, green, blue, refBuf);
+  gap_gve_raw_simd_rgb_to_yuv420p(src, bpp, width * bpp, width, height, red, green, blue
+                , newBuf, newBuf + size, newBuf + size + (size / 4));
+  if(memcmp(refBuf, newBuf, (size * 3) / 2) != 0)
+  {
+    printf("MISMATCH yuv420p %dx%d bpp:%d level:%d\n", (int)width, (int)height, (int)bpp, level);
+    errors++;
+  }
+
+  cr = 0.299;
+  cg = 0.587;
+  cb = 0.114;
+  cu = 0.5 / (1.0 - cb);
+  cv = 0.5 / (1.0 - cr);
+  for(row = 0; row < height; row++)
+  {
+    const guchar *rowPtr;
+
+    rowPtr = src + (row * width * bpp);
+    p_ref_yuv444_row(rowPtr, bpp, width, red, green, blue, cr, cg, cb, cu, cv
+                , refBuf, refBuf + width, refBuf + (2 * width));
+    gap_gve_raw_simd_rgb_row_to_yuv444(rowPtr, bpp, width, red, green, blue, cr, cg, cb, cu, cv
+                , newBuf, newBuf + width, newBuf + (2 * width));
+    if(memcmp(refBuf, newBuf, width * 3) != 0)
+    {
+      printf("MISMATCH yuv444 %dx%d bpp:%d row:%d level:%d\n", (int)width, (int)height, (int)bpp, (int)row, level);
+      errors++;
+      break;
+    }
+  }
+  g_free(refBuf);
+  g_free(newBuf);
+
+  if(bpp >= 3)
+  {
+    refBuf = g_memdup(src, size * bpp);
+    newBuf = g_memdup(src, size * bpp);
+    p_ref_bgr(refBuf, size, bpp);
+    gap_gve_raw_simd_swap_rgb_to_bgr(newBuf, size, bpp);
+    if(memcmp(refBuf, newBuf, size * bpp) != 0)
+    {
+      printf("MISMATCH bgr %dx%d bpp:%d level:%d\n", (int)width, (int)height, (int)bpp, level);
+      errors++;
+    }
+    g_free(refBuf);
+    g_free(newBuf);
+  }
+
+  return (errors);
+}  /* end p_check_frame */
+
+
+/* ---------------------------------
+ * p_bench_size
+ * ---------------------------------
+ * print the time per frame of the reference loops and of the kernels
+ * at each supported dispatch level.
+ */
+static void
+p_bench_size(gint32 width, gint32 height, gint loops)
+{
+  GTimer *timer;
+  guchar *src;
+  guchar *dst;
+  gint32  size;
+  gint32  row;
+  gint    level;
+  gint    ii;
+  gdouble t420, t444, tbgr;
+
+  size = width * height;
+  src = p_generate_frame(width, height, 3, 0);
+  dst = g_malloc(size * 3);
+  timer = g_timer_new();
+
+  /* level -1 is the reference (original scalar loops of gap_gve_raw.c) */
+  for(level = -1; level <= BENCH_LEVEL_AVX2; level++)
+  {
+    if(level >= 0)
+    {
+      if(p_set_level(level) != TRUE)
+      {
+        continue;
+      }
+    }
+
+    g_timer_start(timer);
+    for(ii = 0; ii < loops; ii++)
+    {
+      if(level < 0)
+      {
+        p_ref_yuv420p(src, 3, width, height, 0, 1, 2, dst);
+      }
+      else
+      {
+        gap_gve_raw_simd_rgb_to_yuv420p(src, 3, width * 3, width, height, 0, 1, 2
+                , dst, dst + size, dst + size + (size / 4));
+      }
+    }
+    t420 = g_timer_elapsed(timer, NULL);
+
+    g_timer_start(timer);
+    for(ii = 0; ii < loops; ii++)
+    {
+      for(row = 0; row < height; row++)
+      {
+        if(level < 0)
+        {
+          p_ref_yuv444_row(src + (row * width * 3), 3, width, 0, 1, 2
+                , 0.299, 0.587, 0.114, 0.5 / 0.886, 0.5 / 0.701
+                , dst, dst + width, dst + (2 * width));
+        }
+        else
+        {
+          gap_gve_raw_simd_rgb_row_to_yuv444(src + (row * width * 3), 3, width, 0, 1, 2
+                , 0.299, 0.587, 0.114, 0.5 / 0.886, 0.5 / 0.701
+                , dst, dst + width, dst + (2 * width));
+        }
+      }
+    }
+    t444 = g_timer_elapsed(timer, NULL);
+
+    g_timer_start(timer);
+    for(ii = 0; ii < loops; ii++)
+    {
+      if(level < 0)
+      {
+        p_ref_bgr(src, size, 3);
+      }
+      else
+      {
+        gap_gve_raw_simd_swap_rgb_to_bgr(src, size, 3);
+      }
+    }
+    tbgr = g_timer_elapsed(timer, NULL);
+
+    printf("%4dx%-4d %-9s yuv420p:%7.3f ms  yuv444:%7.3f ms  bgr:%7.3f ms  (per frame)\n"
+          , (int)width, (int)height
+          , (level < 0) ? "reference" : (level == BENCH_LEVEL_SCALAR) ? "scalar" : (level == BENCH_LEVEL_SSE2) ? "sse2" : "avx2"
+          , (t420 * 1000.0) / loops
+          , (t444 * 1000.0) / loops
+          , (tbgr * 1000.0) / loops
+          );
+  }
+
+  g_timer_destroy(timer);
+  g_free(src);
+  g_free(dst);
+
+}  /* end p_bench_size */
+
+
+/* ---------------------------------
+ * main
+ * ---------------------------------
+ */
+int
+main(int argc, char *argv[])
+{
+  static const gint32 checkSizes[][2] = {
+    {2, 2}, {6, 4}, {14, 2}, {18, 6}, {30, 4}, {34, 8}, {66, 6}, {130, 4}, {720, 576}
+  };
+  static const gint32 benchSizes[][2] = {
+    {720, 576}, {1280, 720}, {1920, 1080}
+  };
+  gint   errors;
+  gint   level;
+  guint  ss;
+  gint32 bpp;
+  gint   pattern;
+  gint   loops;
+
+  p_simd_init();
+  cpuSse2 = simdSse2;
+  cpuSsse3 = simdSsse3;
+  cpuAvx2 = simdAvx2;
+  printf("cpu support: sse2:%d ssse3:%d avx2:%d\n", (int)cpuSse2, (int)cpuSsse3, (int)cpuAvx2);
+
+  srand(1);
+  errors = 0;
+  for(level = BENCH_LEVEL_SCALAR; level <= BENCH_LEVEL_AVX2; level++)
+  {
+    if(p_set_level(level) != TRUE)
+    {
+      continue;
+    }
+    for(ss = 0; ss < G_N_ELEMENTS(checkSizes); ss++)
+    {
+      for(bpp = 1; bpp <= 4; bpp++)
+      {
+        for(pattern = 0; pattern < 2; pattern++)
+        {
+          guchar *src;
+
+          src = p_generate_frame(checkSizes[ss][0], checkSizes[ss][1], bpp, pattern);
+          errors += p_check_frame(src, checkSizes[ss][0], checkSizes[ss][1], bpp, level);
+          g_free(src);
+        }
+      }
+    }
+  }
+  printf("equality check: %s (%d mismatches)\n", (errors == 0) ? "OK" : "FAILED", errors);
+
+  if((argc > 1) && (strcmp(argv[1], "-b") == 0))
+  {
+    loops = 50;
+    if(argc > 2)
+    {
+      loops = MAX(1, atoi(argv[2]));
+    }
+    for(ss = 0; ss < G_N_ELEMENTS(benchSizes); ss++)
+    {
+      p_bench_size(benchSizes[ss][0], benchSizes[ss][1], loops);
+    }
+  }
+
+  return ((errors == 0) ? 0 : 1);
+
+}  /* end main */
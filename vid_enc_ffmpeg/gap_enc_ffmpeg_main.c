@@ -124,7 +124,13 @@
 #define MAX_VIDEO_STREAMS 1
 #define MAX_AUDIO_STREAMS 16
 
-#define ENCODER_QUEUE_RINGBUFFER_SIZE 4
+/* default and max number of elements in the queues between the stages of the encoder pipeline
+ * (the sizes can be configured via gimprc)
+ */
+#define ENCODER_QUEUE_DEFAULT_CONVERT_SIZE 4
+#define ENCODER_QUEUE_DEFAULT_ENCODE_SIZE  4
+#define ENCODER_QUEUE_DEFAULT_MUX_SIZE     8
+#define ENCODER_QUEUE_MAX_SIZE             64
  
 
 
@@ -221,55 +227,78 @@ typedef struct t_ffmpeg_handle         /* ffh */
 
 typedef enum
 {
-   EQELEM_STATUS_FREE
-  ,EQELEM_STATUS_READY
-  ,EQELEM_STATUS_LOCK        
-} EncoderQueueElemStatusEnum;
+   EQELEM_ACTION_FRAME      /* convert, encode and write the frame */
+  ,EQELEM_ACTION_FLUSH      /* encode the previous frame again to flush the codecs internal buffer */
+  ,EQELEM_ACTION_STOP       /* terminate the stage threads */
+} EncoderQueueElemActionEnum;
 
 
 typedef struct EncoderQueueElem  /* eq_elem */
 {
-  AVFrame                      *eq_big_picture_codec[MAX_VIDEO_STREAMS];   /* picture data to feed the encoder codec */
+  EncoderQueueElemActionEnum    action;
   gint32                        encode_frame_nr;
   gint                          vid_track;
   gboolean                      force_keyframe;
-  
-  EncoderQueueElemStatusEnum    status;
-  GMutex                       *elemMutex;
-  void                         *next;
+
+  /* convert stage input */
+  guchar                       *rgb_data;              /* rgb888 frame data at frame size */
+
+  /* encode stage input */
+  AVFrame                      *picture_codec;         /* picture data to feed the encoder codec */
+  uint8_t                      *picture_buffer;        /* pixel data referred by picture_codec */
+
+  /* mux stage input */
+  uint8_t                      *pkt_data;              /* copy of the encoded videoframe (NULL if codec has buffered the frame) */
+  int                           pkt_size;
+  int64_t                       pkt_pts;
+  gboolean                      pkt_is_keyframe;
 
 } EncoderQueueElem;
 
 
-typedef struct EncoderQueue    /* eque */
+typedef struct EncoderStageQueue    /* squeue */
 {
-  gint                numberOfElements;
-  EncoderQueueElem   *eq_root;           /* 1st element in the ringbuffer */
-  EncoderQueueElem   *eq_write_ptr;      /* reserved for the frame fetcher thread to writes into the ringbuffer */
-  EncoderQueueElem   *eq_read_ptr;       /* reserved for the encoder thread to read frames from the ringbuffer */
+  const char         *name;
+  gint                size;              /* number of elements */
+  EncoderQueueElem   *elems;
+  GAsyncQueue        *freeQueue;         /* elements available for the producer stage */
+  GAsyncQueue        *readyQueue;        /* elements ready for processing in the consumer stage */
+
+  /* statistics */
+  gint                maxOccupancy;
+  gint64              sumOccupancy;
+  gint64              numberOfPushes;
+  guint64             producerStallMicrosecs;   /* producer waited for a free element (queue full) */
+  guint64             consumerStallMicrosecs;   /* consumer waited for a ready element (queue empty) */
 
+} EncoderStageQueue;
+
+
+typedef struct EncoderQueue    /* eque */
+{
   t_ffmpeg_handle     *ffh;
   t_awk_array         *awp;
-  gint                 runningThreadsCounter;
-  
-  GCond               *frameEncodedCond;  /* sent each time the encoder finished one frame */
-  GMutex              *poolMutex;
 
+  EncoderStageQueue    convertQueue;     /* fetch   --> convert */
+  EncoderStageQueue    encodeQueue;      /* convert --> encode  */
+  EncoderStageQueue    muxQueue;         /* encode  --> mux     */
 
-  /* debug attributes reserved for runtime measuring in the main thread */
-  GapTimmRecord       mainElemMutexWaits;
-  GapTimmRecord       mainPoolMutexWaits;
-  GapTimmRecord       mainEnqueueWaits;
-  GapTimmRecord       mainPush2;
-  GapTimmRecord       mainWriteFrame;
-  GapTimmRecord       mainDrawableToRgb;
-  GapTimmRecord       mainReadFrame;
+  GThread             *convertThread;
+  GThread             *encoderThread;
+  GThread             *muxThread;
 
+  EncoderQueueElem    *fetchElem;        /* reserved for the main thread (the renderer writes the next frame into its rgb_data) */
+  EncoderQueueElem    *lastPictElem;     /* reserved for the encoder thread (picture used for flush) */
+
+  gint                 framesInProgress; /* enqueued frames that are not yet written (protected by poolMutex) */
+  GCond               *frameMuxedCond;   /* sent each time the mux stage finished one frame */
+  GMutex              *poolMutex;
 
-  /* debug attributes reserved for runtime measuring in the encoder thread */
-  GapTimmRecord       ethreadElemMutexWaits;
-  GapTimmRecord       ethreadPoolMutexWaits;
-  GapTimmRecord       ethreadEncodeFrame;
+  /* busy time per stage (each attribute is reserved for the thread of its stage) */
+  guint64              fetchMicrosecs;
+  guint64              convertMicrosecs;
+  guint64              encodeMicrosecs;
+  guint64              muxMicrosecs;
 
 } EncoderQueue;
 
@@ -284,8 +313,6 @@ typedef struct EncoderQueue    /* eque */
 
 int gap_debug = 0;
 
-static GThreadPool         *encoderThreadPool = NULL;
-
 GapGveFFMpegGlobalParams global_params;
 int global_nargs_ffmpeg_enc_par;
 
@@ -347,8 +374,14 @@ static t_ffmpeg_handle * p_ffmpeg_open(GapGveFFMpegGlobalParams *gpp
                                       , gint video_tracks
                                       );
 static int    p_ffmpeg_write_frame_chunk(t_ffmpeg_handle *ffh, gint32 encoded_size, gint vid_track);
-static void   p_convert_colormodel(t_ffmpeg_handle *ffh, AVPicture *picture_codec, guchar *rgb_buffer, gint vid_track);
-
+static void   p_convert_colormodel(t_ffmpeg_handle *ffh, AVPicture *picture_codec, uint8_t *dst_buffer
+                     , guchar *rgb_buffer, gint vid_track);
+
+static int    p_ffmpeg_encodeVideoFrame(t_ffmpeg_handle *ffh, AVFrame *picture_codec
+                     , gboolean force_keyframe, gint vid_track, gint32 encode_frame_nr
+                     , int64_t *pkt_pts, gboolean *pkt_is_keyframe);
+static int    p_ffmpeg_writeVideoPacket(t_ffmpeg_handle *ffh, uint8_t *encoded_data, int encoded_size
+                     , int64_t pkt_pts, gboolean pkt_is_keyframe, gint vid_track);
 static int    p_ffmpeg_encodeAndWriteVideoFrame(t_ffmpeg_handle *ffh, AVFrame *picture_codec
                      , gboolean force_keyframe, gint vid_track, gint32 encode_frame_nr);
 
@@ -358,15 +391,29 @@ static void   p_ffmpeg_convert_GapStoryFetchResult_to_AVFrame(t_ffmpeg_handle *f
                      , gint vid_track
                      );
 
-static void   p_create_EncoderQueueRingbuffer(EncoderQueue *eque);
+static void              p_init_EncoderStageQueue(EncoderStageQueue *squeue, const char *name, gint size);
+static EncoderQueueElem *p_getFreeEncoderStageQueueElem(EncoderStageQueue *squeue);
+static void              p_pushReadyEncoderStageQueueElem(EncoderStageQueue *squeue, EncoderQueueElem *eq_elem);
+static EncoderQueueElem *p_popReadyEncoderStageQueueElem(EncoderStageQueue *squeue);
+static void              p_releaseEncoderStageQueueElem(EncoderStageQueue *squeue, EncoderQueueElem *eq_elem);
+static void              p_free_EncoderStageQueue(EncoderStageQueue *squeue);
+
+static gboolean       p_ffmpeg_copy_GapStoryFetchResult_to_RgbBuffer(t_ffmpeg_handle *ffh
+                         , GapStoryFetchResult *gapStoryFetchResult
+                         , guchar *rgb_data);
+static guchar *       p_reserveFetchEncoderQueueElem(EncoderQueue *eque);
+static gpointer       p_convertWorkerThreadFunction (EncoderQueue *eque);
+static gpointer       p_encoderWorkerThreadFunction (EncoderQueue *eque);
+static gpointer       p_muxWorkerThreadFunction (EncoderQueue *eque);
+
 static EncoderQueue * p_init_EncoderQueueResources(t_ffmpeg_handle *ffh, t_awk_array *awp);
-static void           p_debug_print_RingbufferStatus(EncoderQueue *eque);
+static void           p_debug_print_EncoderQueueStatus(EncoderQueue *eque);
+static void           p_print_EncoderStageQueueStatistics(EncoderStageQueue *squeue);
+static void           p_print_EncoderQueueStatistics(EncoderQueue *eque);
 static void           p_waitUntilEncoderQueIsProcessed(EncoderQueue *eque);
+static void           p_stop_EncoderQueueThreads(EncoderQueue *eque);
 static void           p_free_EncoderQueueResources(EncoderQueue     *eque);
 
-static void   p_fillQueueElem(EncoderQueue *eque, GapStoryFetchResult *gapStoryFetchResult, gboolean force_keyframe, gint vid_track);
-static void   p_encodeCurrentQueueElem(EncoderQueue *eque);
-static void   p_encoderWorkerThreadFunction (EncoderQueue *eque);
 static int    p_ffmpeg_write_frame_and_audio_multithread(EncoderQueue *eque, GapStoryFetchResult *gapStoryFetchResult, gboolean force_keyframe, gint vid_track);
 
 
@@ -3267,12 +3314,14 @@ p_ffmpeg_write_frame_chunk(t_ffmpeg_handle *ffh, gint32 encoded_size, gint vid_t
  * -----------------------
  * convert video frame specified in the rgb_buffer
  * from PIX_FMT_RGB24 to the colormodel that is required
- * by the video codec.
+ * by the video codec. The converted pixel data is written to dst_buffer
+ * (that must be large enough to hold one frame in the pix_fmt of the codec)
  *
  * conversion is done based on ffmpegs img_convert procedure.
  */
 static void
-p_convert_colormodel(t_ffmpeg_handle *ffh, AVPicture *picture_codec, guchar *rgb_buffer, gint vid_track)
+p_convert_colormodel(t_ffmpeg_handle *ffh, AVPicture *picture_codec, uint8_t *dst_buffer
+  , guchar *rgb_buffer, gint vid_track)
 {
   AVFrame   *big_picture_rgb;
   AVPicture *picture_rgb;
@@ -3297,7 +3346,7 @@ p_convert_colormodel(t_ffmpeg_handle *ffh, AVPicture *picture_codec, guchar *rgb
   /* init destination picture structure (the codec context tells us what pix_fmt is needed)
    */
    avpicture_fill(picture_codec
-                  ,ffh->convert_buffer
+                  ,dst_buffer
                   ,ffh->vst[ii].vid_codec_context->pix_fmt          /* PIX_FMT_RGB24, PIX_FMT_RGBA32, PIX_FMT_BGRA32 */
                   ,ffh->frame_width
                   ,ffh->frame_height
@@ -3374,21 +3423,27 @@ p_convert_colormodel(t_ffmpeg_handle *ffh, AVPicture *picture_codec, guchar *rgb
 
 
 /* ---------------------------------
- * p_ffmpeg_encodeAndWriteVideoFrame
+ * p_ffmpeg_encodeVideoFrame
  * ---------------------------------
- * encode one videoframe using the selected codec and write
- * the encoded frame to the mediafile as packet.
+ * encode one videoframe using the selected codec.
+ * The encoded data is delivered in ffh->vst[ii].video_buffer,
+ * the pts (rescaled to the time_base of the video stream) and the keyframe flag
+ * of the encoded frame are delivered in *pkt_pts and *pkt_is_keyframe.
+ *
+ * returns the encoded size (0 in case the codec has buffered the frame).
  */
 static int
-p_ffmpeg_encodeAndWriteVideoFrame(t_ffmpeg_handle *ffh, AVFrame *picture_codec
-   , gboolean force_keyframe, gint vid_track, gint32 encode_frame_nr)
+p_ffmpeg_encodeVideoFrame(t_ffmpeg_handle *ffh, AVFrame *picture_codec
+   , gboolean force_keyframe, gint vid_track, gint32 encode_frame_nr
+   , int64_t *pkt_pts, gboolean *pkt_is_keyframe)
 {
   int encoded_size;
-  int ret;
   int ii;
 
   ii = ffh->vst[vid_track].video_stream_index;
-  ret = 0;
+  encoded_size = 0;
+  *pkt_pts = AV_NOPTS_VALUE;
+  *pkt_is_keyframe = FALSE;
 
   /* AVFrame is the new structure introduced in FFMPEG 0.4.6,
    * (same as AVPicture but with additional members at the end)
@@ -3416,7 +3471,7 @@ p_ffmpeg_encodeAndWriteVideoFrame(t_ffmpeg_handle *ffh, AVFrame *picture_codec
   {
     if(gap_debug)
     {
-      printf("p_ffmpeg_encodeAndWriteVideoFrame: TID:%d before avcodec_encode_video  picture_codec:%d\n"
+      printf("p_ffmpeg_encodeVideoFrame: TID:%d before avcodec_encode_video  picture_codec:%d\n"
          , p_base_get_thread_id_as_int()
          ,(int)picture_codec
          );
@@ -3437,95 +3492,139 @@ p_ffmpeg_encodeAndWriteVideoFrame(t_ffmpeg_handle *ffh, AVFrame *picture_codec
 
     if(gap_debug)
     {
-      printf("p_ffmpeg_encodeAndWriteVideoFrame: TID:%d after avcodec_encode_video  encoded_size:%d\n"
+      printf("p_ffmpeg_encodeVideoFrame: TID:%d after avcodec_encode_video  encoded_size:%d\n"
          , p_base_get_thread_id_as_int()
          ,(int)encoded_size
          );
     }
 
     /* if zero size, it means the image was buffered */
-    if(encoded_size != 0)
+    if(encoded_size > 0)
     {
+      AVCodecContext *c;
+
+      c = ffh->vst[ii].vid_codec_context;
+
+      if (c->coded_frame->pts != AV_NOPTS_VALUE)
       {
-        AVPacket pkt;
-        AVCodecContext *c;
+        *pkt_pts = av_rescale_q(c->coded_frame->pts, c->time_base, ffh->vst[ii].vid_stream->time_base);
+      }
+      else if(gap_debug)
+      {
+        printf("p_ffmpeg_encodeVideoFrame: TID:%d ** HOF: Codec delivered invalid pts  AV_NOPTS_VALUE !\n"
+              , p_base_get_thread_id_as_int()
+              );
+      }
 
-        av_init_packet (&pkt);
-        c = ffh->vst[ii].vid_codec_context;
+      if(c->coded_frame->key_frame)
+      {
+        *pkt_is_keyframe = TRUE;
+      }
+    }
+    else
+    {
+      encoded_size = 0;
+    }
+  }
 
 
-        ///// pkt.pts = ffh->vst[ii].vid_codec_context->coded_frame->pts; // OLD
+  /* if we are in pass1 of a two pass encoding run, output log */
+  if (ffh->vst[ii].passlog_fp && ffh->vst[ii].vid_codec_context->stats_out)
+  {
+    fprintf(ffh->vst[ii].passlog_fp, "%s", ffh->vst[ii].vid_codec_context->stats_out);
+  }
 
-        if (c->coded_frame->pts != AV_NOPTS_VALUE)
-        {
-          pkt.pts= av_rescale_q(c->coded_frame->pts, c->time_base, ffh->vst[ii].vid_stream->time_base);
-        }
+  return(encoded_size);
 
+}  /* end p_ffmpeg_encodeVideoFrame */
 
-        if(c->coded_frame->key_frame)
-        {
-          pkt.flags |= AV_PKT_FLAG_KEY;
-        }
 
-        pkt.stream_index = ffh->vst[ii].video_stream_index;
-        pkt.data = ffh->vst[ii].video_buffer;
-        pkt.size = encoded_size;
+/* ---------------------------------
+ * p_ffmpeg_writeVideoPacket
+ * ---------------------------------
+ * write one encoded videoframe to the mediafile as packet.
+ */
+static int
+p_ffmpeg_writeVideoPacket(t_ffmpeg_handle *ffh, uint8_t *encoded_data, int encoded_size
+   , int64_t pkt_pts, gboolean pkt_is_keyframe, gint vid_track)
+{
+  AVPacket pkt;
+  int ret;
+  int ii;
 
-        if(gap_debug)
-        {
-          AVStream *st;
+  ii = ffh->vst[vid_track].video_stream_index;
 
-          st = ffh->output_context->streams[pkt.stream_index];
-          if (pkt.pts == AV_NOPTS_VALUE)
-          {
-            printf("p_ffmpeg_encodeAndWriteVideoFrame: TID:%d ** HOF: Codec delivered invalid pts  AV_NOPTS_VALUE !\n"
-                  , p_base_get_thread_id_as_int()
-                  );
-          }
+  av_init_packet (&pkt);
+  pkt.pts = pkt_pts;
+  if(pkt_is_keyframe)
+  {
+    pkt.flags |= AV_PKT_FLAG_KEY;
+  }
+  pkt.stream_index = ffh->vst[ii].video_stream_index;
+  pkt.data = encoded_data;
+  pkt.size = encoded_size;
 
-          printf("p_ffmpeg_encodeAndWriteVideoFrame: TID:%d  before av_interleaved_write_frame video encoded_size:%d\n"
-                " pkt.stream_index:%d pkt.pts:%lld dts:%lld coded_frame->pts:%lld  c->time_base:%d den:%d\n"
-                " st->pts.num:%lld, st->pts.den:%lld st->pts.val:%lld\n"
-             , p_base_get_thread_id_as_int()
-             , (int)encoded_size
-             , pkt.stream_index
-             , pkt.pts
-             , pkt.dts
-             , c->coded_frame->pts
-             , c->time_base.num
-             , c->time_base.den
-             ,st->pts.num
-             ,st->pts.den
-             ,st->pts.val
-             );
+  if(gap_debug)
+  {
+    printf("p_ffmpeg_writeVideoPacket: TID:%d  before av_interleaved_write_frame video encoded_size:%d\n"
+           " pkt.stream_index:%d pkt.pts:%lld dts:%lld\n"
+       , p_base_get_thread_id_as_int()
+       , (int)encoded_size
+       , pkt.stream_index
+       , pkt.pts
+       , pkt.dts
+       );
+  }
 
-        }
+  //ret = av_write_frame(ffh->output_context, &pkt);
+  ret = av_interleaved_write_frame(ffh->output_context, &pkt);
 
-        //ret = av_write_frame(ffh->output_context, &pkt);
-        ret = av_interleaved_write_frame(ffh->output_context, &pkt);
+  ffh->countVideoFramesWritten++;
 
-        ffh->countVideoFramesWritten++;
-        
-        if(gap_debug)
-        {
-          printf("p_ffmpeg_encodeAndWriteVideoFrame: TID:%d after av_interleaved_write_frame  encoded_size:%d\n"
-            , p_base_get_thread_id_as_int()
-            , (int)encoded_size 
-            );
-        }
-      }
-    }
+  if(gap_debug)
+  {
+    printf("p_ffmpeg_writeVideoPacket: TID:%d after av_interleaved_write_frame  encoded_size:%d\n"
+      , p_base_get_thread_id_as_int()
+      , (int)encoded_size
+      );
   }
 
+  return(ret);
 
-  /* if we are in pass1 of a two pass encoding run, output log */
-  if (ffh->vst[ii].passlog_fp && ffh->vst[ii].vid_codec_context->stats_out)
+}  /* end p_ffmpeg_writeVideoPacket */
+
+
+/* ---------------------------------
+ * p_ffmpeg_encodeAndWriteVideoFrame
+ * ---------------------------------
+ * encode one videoframe using the selected codec and write
+ * the encoded frame to the mediafile as packet.
+ */
+static int
+p_ffmpeg_encodeAndWriteVideoFrame(t_ffmpeg_handle *ffh, AVFrame *picture_codec
+   , gboolean force_keyframe, gint vid_track, gint32 encode_frame_nr)
+{
+  int      encoded_size;
+  int      ret;
+  int64_t  pkt_pts;
+  gboolean pkt_is_keyframe;
+
+  ret = 0;
+  encoded_size = p_ffmpeg_encodeVideoFrame(ffh, picture_codec
+                    , force_keyframe, vid_track, encode_frame_nr
+                    , &pkt_pts, &pkt_is_keyframe
+                    );
+  if(encoded_size > 0)
   {
-    fprintf(ffh->vst[ii].passlog_fp, "%s", ffh->vst[ii].vid_codec_context->stats_out);
+    ret = p_ffmpeg_writeVideoPacket(ffh
+                    , ffh->vst[ffh->vst[vid_track].video_stream_index].video_buffer
+                    , encoded_size
+                    , pkt_pts, pkt_is_keyframe, vid_track
+                    );
   }
 
   return(ret);
-  
+
 }  /* end p_ffmpeg_encodeAndWriteVideoFrame */
 
 /* -----------------------------------------------
@@ -3585,17 +3684,11 @@ p_ffmpeg_convert_GapStoryFetchResult_to_AVFrame(t_ffmpeg_handle *ffh
       printf("p_ffmpeg_convert_GapStoryFetchResult_to_AVFrame: before gap_gve_drawable_to_RgbBuffer rgb_buffer\n");
     }
  
-    /* tests with framesize 720 x 480 on my 4 CPU development machine showed that
-     *    gap_gve_drawable_to_RgbBuffer_multithread runs 1.5 times
-     *    slower than the singleprocessor implementation  (1.25 times slower on larger frames 1440 x 960)
-     * possible reasons may be
-     * a) too much overhead to init multithread stuff
-     * b) too much time spent waiting for unlocking the mutex.
-     * TODO in case a ==> remove code for gap_gve_drawable_to_RgbBuffer_multithread
-     *      in case b ==> further tuning to reduce wait cycles.
+    /* the multithread variant fetches the drawable in the main thread
+     * and spreads the conversion to bpp 3 on the available processors.
+     * (it falls back to the singleprocessor implementation where threads are not available)
      */
-    // gap_gve_drawable_to_RgbBuffer_multithread(drawable, rgbBuffer);
-    gap_gve_drawable_to_RgbBuffer(drawable, rgbBuffer);
+    gap_gve_drawable_to_RgbBuffer_multithread(drawable, rgbBuffer);
     gimp_drawable_detach (drawable);
  
     /* destroy the fetched (tmp) image */
@@ -3621,7 +3714,7 @@ p_ffmpeg_convert_GapStoryFetchResult_to_AVFrame(t_ffmpeg_handle *ffh
     {
       printf("p_ffmpeg_convert_GapStoryFetchResult_to_AVFrame: before p_convert_colormodel rgb_buffer\n");
     }
-    p_convert_colormodel(ffh, picture_codec, rgbBuffer->data, vid_track);
+    p_convert_colormodel(ffh, picture_codec, ffh->convert_buffer, rgbBuffer->data, vid_track);
   }
 
 
@@ -3638,881 +3731,970 @@ p_ffmpeg_convert_GapStoryFetchResult_to_AVFrame(t_ffmpeg_handle *ffh
 
 
 /* -------------------------------------------
- * p_create_EncoderQueueRingbuffer
+ * p_init_EncoderStageQueue
  * -------------------------------------------
- * this procedure allocates the encoder queue ringbuffer
- * for use in multiprocessor environment.
- * The Encoder queue ringbuffer is created 
- * with all AVFrame buffers for N elements allocated
- * and all elements have the initial status EQELEM_STATUS_FREE
- *
- * Initial                                                 After writing the 1st frame (main thread)
- *                                                       
- *                          +---------------------+		                          +------------------------+
- *  eque->eq_write_ptr  --->| EQELEM_STATUS_FREE  |<---+                                  | EQELEM_STATUS_FREE     |<---+  
- *  (main thread)           +---------------------+    |	                          +------------------------+    |
- *                                  |                  |	                                  |                     |
- *                                  V                  |	                                  V                     |
- *                          +---------------------+    |	  eque->eq_write_ptr  --->+------------------------+    |
- *  eque->eq_read_ptr   --->| EQELEM_STATUS_FREE  |    | 	  eque->eq_read_ptr   --->| EQELEM_STATUS_READY ** |    | 
- *  (encoder thread)        +---------------------+    |	                          +------------------------+    |
- *                                  |                  |	                                  |                     |
- *                                  V                  |	                                  V                     |
- *                          +---------------------+    |	                          +------------------------+    |
- *                          | EQELEM_STATUS_FREE  |    | 	                          | EQELEM_STATUS_FREE     |    | 
- *                          +---------------------+    |	                          +------------------------+    |
- *                                  |                  |	                                  |                     |
- *                                  V                  |	                                  V                     |
- *                          +---------------------+    |	                          +------------------------+    |
- *                          | EQELEM_STATUS_FREE  |    | 	                          | EQELEM_STATUS_FREE     |    | 
- *                          +---------------------+    |	                          +------------------------+    |
- *                                  |                  |	                                  |                     |
- *                                  +------------------+	                                  +---------------------+
- *
+ * init a bounded queue between two stages of the encoder pipeline.
+ * The queue is bounded by a fixed number of elements that circulate between
+ * freeQueue (available for the producer stage) and readyQueue
+ * (filled elements that wait for processing in the consumer stage).
+ * The stage specific buffers of the elements are allocated by the caller.
  */
 static void
-p_create_EncoderQueueRingbuffer(EncoderQueue *eque)
+p_init_EncoderStageQueue(EncoderStageQueue *squeue, const char *name, gint size)
 {
   gint ii;
-  gint jj;
-  EncoderQueueElem *eq_elem_one;
-  EncoderQueueElem *eq_elem;
-  
-  eq_elem_one = NULL;
-  eq_elem = NULL;
-  for(jj=0; jj < ENCODER_QUEUE_RINGBUFFER_SIZE; jj++)
-  {
-    eq_elem = g_new(EncoderQueueElem, 1);
-    eq_elem->encode_frame_nr = 0;
-    eq_elem->vid_track = 1;
-    eq_elem->force_keyframe = FALSE;
-    eq_elem->status = EQELEM_STATUS_FREE;
-    eq_elem->elemMutex = g_mutex_new();
-    eq_elem->next = eque->eq_root;
-    
-    if(eq_elem_one == NULL)
-    {
-      eq_elem_one = eq_elem;
-    }
-    eque->eq_root = eq_elem;
-    
-    for (ii=0; ii < MAX_VIDEO_STREAMS; ii++)
-    {
-      eq_elem->eq_big_picture_codec[ii] = avcodec_alloc_frame();
-    }
-  }
-  
-  /* close the pointer ring */
-  if(eq_elem_one)
+
+  squeue->name = name;
+  squeue->size = size;
+  squeue->elems = g_new0(EncoderQueueElem, size);
+  squeue->freeQueue = g_async_queue_new();
+  squeue->readyQueue = g_async_queue_new();
+
+  squeue->maxOccupancy = 0;
+  squeue->sumOccupancy = 0;
+  squeue->numberOfPushes = 0;
+  squeue->producerStallMicrosecs = 0;
+  squeue->consumerStallMicrosecs = 0;
+
+  for(ii=0; ii < size; ii++)
   {
-    eq_elem_one->next = eq_elem;
+    squeue->elems[ii].action = EQELEM_ACTION_FRAME;
+    squeue->elems[ii].vid_track = 0;
+    g_async_queue_push(squeue->freeQueue, &squeue->elems[ii]);
   }
-  
-  /* init read and write pointers
-   * note that write access typically start with advancing the write pointer
-   * followed by write data to eq_big_picture_codec.
-   */
-  eque->eq_write_ptr = eque->eq_root;
-  eque->eq_read_ptr  = eque->eq_root->next;
 
-}  /* end p_create_EncoderQueueRingbuffer */
+}  /* end p_init_EncoderStageQueue */
 
 
 /* -------------------------------------------
- * p_init_EncoderQueueResources
+ * p_getFreeEncoderStageQueueElem
  * -------------------------------------------
- * this procedure creates a thread pool and an EncoderQueue ringbuffer in case 
- * the gimprc parameters are configured for multiprocessor support.
- * (otherwise those resources are not allocated and were initalized with NULL pointers)
- * 
+ * get a free element (producer side).
+ * blocks while the queue is full, the wait time is recorded as producer stall.
  */
-static EncoderQueue *
-p_init_EncoderQueueResources(t_ffmpeg_handle *ffh, t_awk_array *awp)
+static EncoderQueueElem *
+p_getFreeEncoderStageQueueElem(EncoderStageQueue *squeue)
 {
-  EncoderQueue     *eque;
-  
-  eque = g_new(EncoderQueue ,1);
-  eque->numberOfElements = 0;
-  eque->eq_root      = NULL;
-  eque->eq_write_ptr = NULL;
-  eque->eq_read_ptr  = NULL;
-  eque->ffh          = ffh;
-  eque->awp          = awp;
-  eque->runningThreadsCounter = 0;
-  eque->frameEncodedCond   = NULL;
-  eque->poolMutex          = NULL;
-  eque->frameEncodedCond   = NULL;
-
-  GAP_TIMM_INIT_RECORD(&eque->mainElemMutexWaits);
-  GAP_TIMM_INIT_RECORD(&eque->mainPoolMutexWaits);
-  GAP_TIMM_INIT_RECORD(&eque->mainEnqueueWaits);
-  GAP_TIMM_INIT_RECORD(&eque->mainPush2);
-  GAP_TIMM_INIT_RECORD(&eque->mainWriteFrame);
-  GAP_TIMM_INIT_RECORD(&eque->mainDrawableToRgb);
-  GAP_TIMM_INIT_RECORD(&eque->mainReadFrame);
-
-  GAP_TIMM_INIT_RECORD(&eque->ethreadElemMutexWaits);
-  GAP_TIMM_INIT_RECORD(&eque->ethreadPoolMutexWaits);
-  GAP_TIMM_INIT_RECORD(&eque->ethreadEncodeFrame);
-  
-  if (ffh->isMultithreadEnabled)
-  {
-    /* check and init thread system */
-    ffh->isMultithreadEnabled = gap_base_thread_init();
-    if(gap_debug)
-    {
-      printf("p_init_EncoderQueueResources: isMultithreadEnabled: %d\n"
-        ,(int)ffh->isMultithreadEnabled
-        );
-    }
-  }
-  
-  if (ffh->isMultithreadEnabled)
+  EncoderQueueElem *eq_elem;
+
+  eq_elem = (EncoderQueueElem *)g_async_queue_try_pop(squeue->freeQueue);
+  if(eq_elem == NULL)
   {
-    p_create_EncoderQueueRingbuffer(eque);
-    eque->poolMutex          = g_mutex_new ();
-    eque->frameEncodedCond   = g_cond_new ();
+    GTimeVal startTime;
+    GTimeVal endTime;
+
+    g_get_current_time(&startTime);
+    eq_elem = (EncoderQueueElem *)g_async_queue_pop(squeue->freeQueue);
+    g_get_current_time(&endTime);
+    squeue->producerStallMicrosecs += p_timespecDiff(&startTime, &endTime);
   }
+  return (eq_elem);
 
-  return (eque);
-  
-}  /* end p_init_EncoderQueueResources */
+}  /* end p_getFreeEncoderStageQueueElem */
 
 
-/* ------------------------------
- * p_debug_print_RingbufferStatus
- * ------------------------------
- * print status of all encoder queue ringbuffer elements
- * to stdout for debug purpose.
- * (all log lines are printed to a buffer and printed to stdout
- * at once to prevent mix up stdout with output from other threads)
+/* -------------------------------------------
+ * p_pushReadyEncoderStageQueueElem
+ * -------------------------------------------
+ * pass a filled element to the consumer stage (producer side)
+ * and record the queue occupancy.
  */
 static void
-p_debug_print_RingbufferStatus(EncoderQueue *eque)
+p_pushReadyEncoderStageQueueElem(EncoderStageQueue *squeue, EncoderQueueElem *eq_elem)
 {
-  EncoderQueueElem    *eq_elem;
-  EncoderQueueElem    *eq_elem_next;
-  GString             *logString;
-  gint tid;
-  gint ii;
-      
-  tid = p_base_get_thread_id_as_int();
-  
-  logString = g_string_new(
-    "--------------------------------\n"
-    "p_debug_print_RingbufferStatus\n"
-    "--------------------------------\n"
-  );
-
-  eq_elem_next = NULL;
-  ii=0;
-  for(eq_elem = eque->eq_root; eq_elem != NULL; eq_elem = eq_elem_next)
-  {
-    g_string_append_printf(logString, "TID:%d EQ_ELEM[%d]: %d  EQ_ELEM->next:%d STATUS:%d encode_frame_nr:%d"
-          , (int)tid
-          , (int)ii
-          , (int)eq_elem
-          , (int)eq_elem->next
-          , (int)eq_elem->status
-          , (int)eq_elem->encode_frame_nr
-          );
-    if(eq_elem == eque->eq_write_ptr)
-    {
-      g_string_append_printf(logString, " <-- eq_write_ptr");
-    }
-    
-    if(eq_elem == eque->eq_read_ptr)
-    {
-      g_string_append_printf(logString, " <-- eq_read_ptr");
-    }
-    
-    g_string_append_printf(logString, "\n");
-    
-    
-    eq_elem_next = eq_elem->next;
-    if(eq_elem_next == eque->eq_root)
-    {
-      /* this was the last element in the ringbuffer.
-       */
-      eq_elem_next = NULL;
-    }
-    ii++;
-  }
+  gint occupancy;
 
-  printf("%s\n", logString->str);
-  
-  g_string_free(logString, TRUE);
+  g_async_queue_push(squeue->readyQueue, eq_elem);
 
-}  /* end p_debug_print_RingbufferStatus */
+  /* note: g_async_queue_length is negative while consumer threads are waiting */
+  occupancy = MAX(0, g_async_queue_length(squeue->readyQueue));
+  squeue->sumOccupancy += occupancy;
+  squeue->numberOfPushes++;
+  squeue->maxOccupancy = MAX(squeue->maxOccupancy, occupancy);
 
-/* -----------------------------------------
- * p_waitUntilEncoderQueIsProcessed
- * -----------------------------------------
- * check if encoder thread is still running
- * if yes then wait until  finished (e.q. until
- * all enqued frames have been processed)
- * 
+}  /* end p_pushReadyEncoderStageQueueElem */
+
+
+/* -------------------------------------------
+ * p_popReadyEncoderStageQueueElem
+ * -------------------------------------------
+ * get the next filled element (consumer side).
+ * blocks while the queue is empty, the wait time is recorded as consumer stall.
  */
-static void
-p_waitUntilEncoderQueIsProcessed(EncoderQueue *eque)
+static EncoderQueueElem *
+p_popReadyEncoderStageQueueElem(EncoderStageQueue *squeue)
 {
-  gint retryCount;
+  EncoderQueueElem *eq_elem;
 
-  if(eque == NULL)
+  eq_elem = (EncoderQueueElem *)g_async_queue_try_pop(squeue->readyQueue);
+  if(eq_elem == NULL)
   {
-    return;
-  }
+    GTimeVal startTime;
+    GTimeVal endTime;
 
-  if(gap_debug)
-  {
-    printf("p_waitUntilEncoderQueIsProcessed: MainTID:%d\n"
-            ,p_base_get_thread_id_as_int()
-            );
-    p_debug_print_RingbufferStatus(eque);
+    g_get_current_time(&startTime);
+    eq_elem = (EncoderQueueElem *)g_async_queue_pop(squeue->readyQueue);
+    g_get_current_time(&endTime);
+    squeue->consumerStallMicrosecs += p_timespecDiff(&startTime, &endTime);
   }
+  return (eq_elem);
 
-  retryCount = 0;
-  g_mutex_lock (eque->poolMutex);
-  while(eque->runningThreadsCounter > 0)
-  {
-    if(gap_debug)
-    {
-      printf("p_waitUntilEncoderQueIsProcessed: WAIT MainTID:%d until encoder thread finishes queue processing. eq_write_ptr:%d STATUS:%d retry:%d \n"
-        , p_base_get_thread_id_as_int()
-        , (int)eque->eq_write_ptr
-        , (int)eque->eq_write_ptr->status
-        , (int)retryCount
-        );
-      fflush(stdout);
-    }
-
-    g_cond_wait (eque->frameEncodedCond, eque->poolMutex);
+}  /* end p_popReadyEncoderStageQueueElem */
 
-    if(gap_debug)
-    {
-      printf("p_waitUntilEncoderQueIsProcessed: WAKE-UP MainTID:%d after encoder thread finished queue processing. eq_write_ptr:%d STATUS:%d retry:%d \n"
-        , p_base_get_thread_id_as_int()
-        , (int)eque->eq_write_ptr
-        , (int)eque->eq_write_ptr->status
-        , (int)retryCount
-        );
-      fflush(stdout);
-    }
 
-    retryCount++;
-    if(retryCount >= 250)
-    {
-      printf("** WARNING encoder thread not yet finished after %d wait retries\n"
-        ,(int)retryCount
-        );
-      break;
-    }
-  }
-  g_mutex_unlock (eque->poolMutex);
+/* -------------------------------------------
+ * p_releaseEncoderStageQueueElem
+ * -------------------------------------------
+ * give a processed element back to the producer (consumer side)
+ */
+static void
+p_releaseEncoderStageQueueElem(EncoderStageQueue *squeue, EncoderQueueElem *eq_elem)
+{
+  g_async_queue_push(squeue->freeQueue, eq_elem);
 
-}  /* end p_waitUntilEncoderQueIsProcessed */
+}  /* end p_releaseEncoderStageQueueElem */
 
 
 /* -------------------------------------------
- * p_free_EncoderQueueResources
+ * p_free_EncoderStageQueue
  * -------------------------------------------
- * this procedure frees the resources for the specified EncoderQueue.
- * Note: this does NOT include the ffh reference.
- * 
+ * free the queue and the stage specific buffers of all its elements.
+ * (must not be called while stage threads are still running)
  */
 static void
-p_free_EncoderQueueResources(EncoderQueue     *eque)
+p_free_EncoderStageQueue(EncoderStageQueue *squeue)
 {
-  t_ffmpeg_handle     *ffh;
-  EncoderQueueElem    *eq_elem;
-  EncoderQueueElem    *eq_elem_next;
-  gint                 ii;
-  
-  if(eque == NULL)
+  gint ii;
+
+  if(squeue->elems == NULL)
   {
     return;
   }
 
-  if(eque->frameEncodedCond != NULL)
+  for(ii=0; ii < squeue->size; ii++)
   {
-    if(gap_debug)
-    {
-      printf("p_free_EncoderQueueResources: before g_cond_free(eque->frameEncodedCond)\n");
-    }
-    g_cond_free(eque->frameEncodedCond);
-    eque->frameEncodedCond = NULL;
-    if(gap_debug)
+    EncoderQueueElem *eq_elem;
+
+    eq_elem = &squeue->elems[ii];
+    if(eq_elem->rgb_data != NULL)
     {
-      printf("p_free_EncoderQueueResources: after g_cond_free(eque->frameEncodedCond)\n");
+      g_free(eq_elem->rgb_data);
     }
-  }
-
-  eq_elem_next = NULL;
-  for(eq_elem = eque->eq_root; eq_elem != NULL; eq_elem = eq_elem_next)
-  {
-    for (ii=0; ii < MAX_VIDEO_STREAMS; ii++)
+    if(eq_elem->picture_codec != NULL)
     {
-      if(gap_debug)
-      {
-        printf("p_free_EncoderQueueResources: g_free big_picture[%d] of eq_elem:%d\n"
-          ,(int)ii
-          ,(int)eq_elem
-          );
-      }
-      g_free(eq_elem->eq_big_picture_codec[ii]);
-      if(gap_debug)
-      {
-        printf("p_free_EncoderQueueResources: g_mutex_free of eq_elem:%d\n"
-          ,(int)eq_elem
-          );
-      }
-      g_mutex_free(eq_elem->elemMutex);
+      av_free(eq_elem->picture_codec);
     }
-    if(gap_debug)
+    if(eq_elem->picture_buffer != NULL)
     {
-      printf("p_free_EncoderQueueResources: g_free eq_elem:%d\n"
-        ,(int)eq_elem
-        );
+      g_free(eq_elem->picture_buffer);
     }
-    eq_elem_next = eq_elem->next;
-    if(eq_elem_next == eque->eq_root)
+    if(eq_elem->pkt_data != NULL)
     {
-      /* this was the last element in the ringbuffer that points to
-       * the (already free'd root); it is time to break the loop now.
-       */
-      eq_elem_next = NULL;
+      g_free(eq_elem->pkt_data);
     }
-    g_free(eq_elem);
   }
-  eque->eq_root      = NULL;
-  eque->eq_write_ptr = NULL;
-  eque->eq_read_ptr  = NULL;
-  
-}  /* end p_free_EncoderQueueResources */
+  g_async_queue_unref(squeue->freeQueue);
+  g_async_queue_unref(squeue->readyQueue);
+  g_free(squeue->elems);
+  squeue->elems = NULL;
+  squeue->freeQueue = NULL;
+  squeue->readyQueue = NULL;
+
+}  /* end p_free_EncoderStageQueue */
 
 
-/* -------------------------------------
- * p_fillQueueElem
- * -------------------------------------
- * fill element eque->eq_write_ptr with imag data and information
- * that is required for the encoder.
+/* -------------------------------------------
+ * p_ffmpeg_copy_GapStoryFetchResult_to_RgbBuffer
+ * -------------------------------------------
+ * copy the specified gapStoryFetchResult as rgb888 data
+ * at frame size into the buffer rgb_data.
+ * In case the result is a gimp image, the image is deleted after the copy.
+ * Note: this procedure must be called in the main thread (gimp drawable access).
+ *
+ * returns TRUE on success.
  */
-static void
-p_fillQueueElem(EncoderQueue *eque, GapStoryFetchResult *gapStoryFetchResult, gboolean force_keyframe, gint vid_track)
+static gboolean
+p_ffmpeg_copy_GapStoryFetchResult_to_RgbBuffer(t_ffmpeg_handle *ffh
+ , GapStoryFetchResult *gapStoryFetchResult
+ , guchar *rgb_data)
 {
-  EncoderQueueElem *eq_write_ptr;
-  AVFrame *picture_codec;
-  GimpDrawable *drawable;
-
-  eq_write_ptr = eque->eq_write_ptr;
-  eq_write_ptr->encode_frame_nr = eque->ffh->encode_frame_nr;
-  eq_write_ptr->vid_track = vid_track;
-  eq_write_ptr->force_keyframe = force_keyframe;
-  picture_codec = eq_write_ptr->eq_big_picture_codec[vid_track];
+  gboolean isCopied;
 
-  GAP_TIMM_START_RECORD(&eque->mainDrawableToRgb);
-  if(gap_debug)
+  isCopied = FALSE;
+  if(gapStoryFetchResult->resultEnum == GAP_STORY_FETCH_RESULT_IS_RAW_RGB888)
   {
-    printf("p_fillQueueElem: START drawable:%d eq_write_ptr:%d picture_codec:%d vid_track:%d encode_frame_nr:%d\n"
-      ,(int)drawable
-      ,(int)eq_write_ptr
-      ,(int)picture_codec
-      ,(int)eq_write_ptr->vid_track
-      ,(int)eq_write_ptr->encode_frame_nr
-      );
+    if(gapStoryFetchResult->raw_rgb_data == NULL)
+    {
+      printf("** ERROR p_ffmpeg_copy_GapStoryFetchResult_to_RgbBuffer  RGB88 raw_rgb_data is NULL!\n");
+      return (FALSE);
+    }
+    memcpy(rgb_data, gapStoryFetchResult->raw_rgb_data, ffh->frame_width * ffh->frame_height * 3);
+    isCopied = TRUE;
   }
-  
-  /* fill the AVFrame data at eq_write_ptr */
-  if(gapStoryFetchResult != NULL)
+  else
   {
-    p_ffmpeg_convert_GapStoryFetchResult_to_AVFrame(eque->ffh
-                 , picture_codec
-                 , gapStoryFetchResult
-                 , vid_track
-                 );
-    if(gap_debug)
+    GimpDrawable      *drawable;
+    GapRgbPixelBuffer  rgbBufferLocal;
+
+    drawable = gimp_drawable_get (gapStoryFetchResult->layer_id);
+    if((drawable->bpp == 3)
+    && (drawable->width == ffh->frame_width)
+    && (drawable->height == ffh->frame_height))
+    {
+      gap_gve_init_GapRgbPixelBuffer(&rgbBufferLocal, drawable->width, drawable->height);
+      rgbBufferLocal.data = rgb_data;
+      gap_gve_drawable_to_RgbBuffer_multithread(drawable, &rgbBufferLocal);
+      isCopied = TRUE;
+    }
+    else
     {
-      printf("p_fillQueueElem: DONE drawable:%d drawableId:%d eq_write_ptr:%d picture_codec:%d vid_track:%d encode_frame_nr:%d\n"
-        ,(int)drawable
-        ,(int)drawable->drawable_id
-        ,(int)eq_write_ptr
-        ,(int)picture_codec
-        ,(int)eq_write_ptr->vid_track
-        ,(int)eq_write_ptr->encode_frame_nr
+      printf("** ERROR drawable bpp:%d size:(%d x %d) is not supported (only bpp == 3 at frame size (%d x %d) is supported!\n"
+        ,(int)drawable->bpp
+        ,(int)drawable->width
+        ,(int)drawable->height
+        ,(int)ffh->frame_width
+        ,(int)ffh->frame_height
         );
     }
+    gimp_drawable_detach (drawable);
+
+    /* destroy the fetched (tmp) image */
+    gimp_image_delete(gapStoryFetchResult->image_id);
   }
-  GAP_TIMM_STOP_RECORD(&eque->mainDrawableToRgb);
-  
-}  /* end p_fillQueueElem */
+
+  return (isCopied);
+
+}  /* end p_ffmpeg_copy_GapStoryFetchResult_to_RgbBuffer */
 
 
-/* -------------------------------------
- * p_encodeCurrentQueueElem
- * -------------------------------------
- * Encode current queue element at eq_read_ptr
- * and write encoded videoframe to the mediafile.
+/* -------------------------------------------
+ * p_convertWorkerThreadFunction
+ * -------------------------------------------
+ * thread function of the convert stage.
+ * converts rgb888 frames from the convertQueue to the pix_fmt required
+ * by the codec and passes the resulting pictures to the encodeQueue.
+ * Note: the img_convert_ctx of the ffh is reserved for this thread
+ * while the pipeline is running.
  */
-static void
-p_encodeCurrentQueueElem(EncoderQueue *eque)
+static gpointer
+p_convertWorkerThreadFunction (EncoderQueue *eque)
 {
-  EncoderQueueElem *eq_read_ptr;
-  AVFrame *picture_codec;
-  gint     vid_track;
-  
-  eq_read_ptr = eque->eq_read_ptr;
-  
-  vid_track = eq_read_ptr->vid_track;
-  picture_codec = eq_read_ptr->eq_big_picture_codec[vid_track];
+  t_ffmpeg_handle  *ffh;
+  gboolean          isStopRequested;
 
-  if(gap_debug)
+  ffh = eque->ffh;
+  isStopRequested = FALSE;
+  while(isStopRequested != TRUE)
   {
-    printf("p_encodeCurrentQueueElem: TID:%d START eq_read_ptr:%d STATUS:%d ffh:%d picture_codec:%d vid_track:%d encode_frame_nr:%d\n"
-      , p_base_get_thread_id_as_int()
-      ,(int)eq_read_ptr
-      ,(int)eq_read_ptr->status
-      ,(int)eque->ffh
-      ,(int)picture_codec
-      ,(int)eq_read_ptr->vid_track
-      ,(int)eq_read_ptr->encode_frame_nr
-      );
+    EncoderQueueElem *rgb_elem;
+    EncoderQueueElem *pict_elem;
+
+    rgb_elem = p_popReadyEncoderStageQueueElem(&eque->convertQueue);
+    pict_elem = p_getFreeEncoderStageQueueElem(&eque->encodeQueue);
+
+    pict_elem->action          = rgb_elem->action;
+    pict_elem->encode_frame_nr = rgb_elem->encode_frame_nr;
+    pict_elem->vid_track       = rgb_elem->vid_track;
+    pict_elem->force_keyframe  = rgb_elem->force_keyframe;
+
+    if(rgb_elem->action == EQELEM_ACTION_FRAME)
+    {
+      GTimeVal startTime;
+      GTimeVal endTime;
+      int      ii;
+
+      g_get_current_time(&startTime);
+
+      ii = ffh->vst[rgb_elem->vid_track].video_stream_index;
+      if (ffh->vst[ii].vid_codec_context->pix_fmt == PIX_FMT_RGB24)
+      {
+        uint8_t *swap_buffer;
+
+        /* no convert required, hand over the rgb buffer to the picture element
+         * by swapping the buffers (both are large enough to hold one rgb888 frame)
+         */
+        swap_buffer = pict_elem->picture_buffer;
+        pict_elem->picture_buffer = rgb_elem->rgb_data;
+        rgb_elem->rgb_data = swap_buffer;
+        avpicture_fill((AVPicture *)pict_elem->picture_codec
+                    ,pict_elem->picture_buffer
+                    ,PIX_FMT_RGB24
+                    ,ffh->frame_width
+                    ,ffh->frame_height
+                    );
+      }
+      else
+      {
+        p_convert_colormodel(ffh
+                    , (AVPicture *)pict_elem->picture_codec
+                    , pict_elem->picture_buffer
+                    , rgb_elem->rgb_data
+                    , rgb_elem->vid_track
+                    );
+      }
+
+      g_get_current_time(&endTime);
+      eque->convertMicrosecs += p_timespecDiff(&startTime, &endTime);
+    }
+    else if (rgb_elem->action == EQELEM_ACTION_STOP)
+    {
+      isStopRequested = TRUE;
+    }
+
+    p_releaseEncoderStageQueueElem(&eque->convertQueue, rgb_elem);
+    p_pushReadyEncoderStageQueueElem(&eque->encodeQueue, pict_elem);
   }
-  
-  p_ffmpeg_encodeAndWriteVideoFrame(eque->ffh
-                                  , picture_codec
-                                  , eque->eq_read_ptr->force_keyframe
-                                  , vid_track
-                                  , eque->eq_read_ptr->encode_frame_nr
-                                  );
 
   if(gap_debug)
   {
-    printf("p_encodeCurrentQueueElem: TID:%d DONE eq_read_ptr:%d picture_codec:%d vid_track:%d encode_frame_nr:%d\n"
-      , p_base_get_thread_id_as_int()
-      ,(int)eq_read_ptr
-      ,(int)picture_codec
-      ,(int)eq_read_ptr->vid_track
-      ,(int)eq_read_ptr->encode_frame_nr
-      );
+    printf("p_convertWorkerThreadFunction: TID:%d  DONE\n"
+          , p_base_get_thread_id_as_int()
+          );
   }
-}  /* end p_encodeCurrentQueueElem */
+  return (NULL);
+
+}  /* end p_convertWorkerThreadFunction */
 
 
 /* -------------------------------------------
  * p_encoderWorkerThreadFunction
  * -------------------------------------------
- * this procedure runs as thread pool function to encode video and audio
- * frames, Encoding is based on libavformat/libavcodec.
- * videoframe input is taken from the EncoderQueue ringbuffer
- *  (that is filled parallel by the main thread)
- * audioframe input is directly fetched from an input audifile.
- *
- * After encoding the first available frame this thread tries
- * to encode following frames when available.
- * In case the elemMutex can not be locked for those additional frames
- * it gives up immediate to avoid deadlocks. (such frames are handled in the next call
- * when the thread is restarted from the thread pool)
- * 
- *
- * The encoding is done with the selected codec, the compressed data is written
- * to the mediafile as packet.
- *
- * Note: the read pointer is reserved for exclusive use in this thread
- * therefore advance of this pointer can be done without locks.
- * but accessing the element data (status or buffer) requires locking at element level
- * because the main thread does acces the same data via the write pointer.
- *
- * 
+ * thread function of the encode stage.
+ * encodes the pictures from the encodeQueue with the selected codec
+ * and passes copies of the encoded data to the muxQueue.
+ * Flush requests encode the last encoded picture again,
+ * therefore the last picture element is kept until the next picture arrives.
+ * Note: the codec context and the video_buffer of the ffh are reserved for this thread
+ * while the pipeline is running.
  */
-static void
+static gpointer
 p_encoderWorkerThreadFunction (EncoderQueue *eque)
 {
-  EncoderQueueElem     *nextElem;
-  gint32                encoded_frame_nr;
-  if(gap_debug)
-  {
-    printf("p_encoderWorkerThreadFunction: TID:%d before elemMutex eq_read_ptr:%d\n"
-          , p_base_get_thread_id_as_int()
-          , (int)eque->eq_read_ptr
-          );
-  }
-  /* lock at element level */
-  if(g_mutex_trylock (eque->eq_read_ptr->elemMutex) != TRUE)
-  {
-    GAP_TIMM_START_RECORD(&eque->ethreadElemMutexWaits);
+  t_ffmpeg_handle  *ffh;
+  gboolean          isStopRequested;
 
-    g_mutex_lock (eque->eq_read_ptr->elemMutex);
-  
-    GAP_TIMM_STOP_RECORD(&eque->ethreadElemMutexWaits);
-  }
-  
-  
-  
-  if(gap_debug)
+  ffh = eque->ffh;
+  isStopRequested = FALSE;
+  while(isStopRequested != TRUE)
   {
-    printf("p_encoderWorkerThreadFunction: TID:%d  after elemMutex lock eq_read_ptr:%d STATUS:%d encode_frame_nr:%d\n"
-          , p_base_get_thread_id_as_int()
-          , (int)eque->eq_read_ptr
-          , (int)eque->eq_read_ptr->status
-          , (int)eque->eq_read_ptr->encode_frame_nr
-          );
-    p_debug_print_RingbufferStatus(eque);
-  }
+    EncoderQueueElem *pict_elem;
+    EncoderQueueElem *pkt_elem;
+    EncoderQueueElem *encode_elem;
 
-ENCODER_LOOP:
+    pict_elem = p_popReadyEncoderStageQueueElem(&eque->encodeQueue);
+    pkt_elem = p_getFreeEncoderStageQueueElem(&eque->muxQueue);
 
-  /* check next element is ready and advance read pointer if true.
-   *
-   * encoding of the last n-frames is typically triggerd
-   * by setting the same frame n times to EQELEM_STATUS_READY
-   * repeated without advance to the next element.
-   * therefore the read pointer advance is done only in case
-   * when the next element with EQELEM_STATUS_READY is already available.
-   */
-  if(eque->eq_read_ptr->status == EQELEM_STATUS_FREE)
-  {
-    nextElem = eque->eq_read_ptr->next;
-    g_mutex_unlock (eque->eq_read_ptr->elemMutex);
+    pkt_elem->action          = pict_elem->action;
+    pkt_elem->encode_frame_nr = pict_elem->encode_frame_nr;
+    pkt_elem->vid_track       = pict_elem->vid_track;
+    pkt_elem->force_keyframe  = pict_elem->force_keyframe;
+    pkt_elem->pkt_data        = NULL;
+    pkt_elem->pkt_size        = 0;
 
-    if(TRUE != g_mutex_trylock (nextElem->elemMutex))
+    encode_elem = NULL;
+    if(pict_elem->action == EQELEM_ACTION_FRAME)
+    {
+      encode_elem = pict_elem;
+    }
+    else if(pict_elem->action == EQELEM_ACTION_FLUSH)
     {
-        goto ENCODER_STOP;
+      /* in case of flush we feed the previous handled picture (e.g the last of the input)
+       * again to the codec (same as the singleprocessor implementation does)
+       */
+      encode_elem = eque->lastPictElem;
     }
     else
     {
-      if(nextElem->status == EQELEM_STATUS_READY)
+      isStopRequested = TRUE;
+    }
+
+    if(encode_elem != NULL)
+    {
+      GTimeVal startTime;
+      GTimeVal endTime;
+      int      encoded_size;
+
+      g_get_current_time(&startTime);
+
+      encoded_size = p_ffmpeg_encodeVideoFrame(ffh
+                          , encode_elem->picture_codec
+                          , pict_elem->force_keyframe
+                          , pict_elem->vid_track
+                          , pict_elem->encode_frame_nr
+                          , &pkt_elem->pkt_pts
+                          , &pkt_elem->pkt_is_keyframe
+                          );
+      if(encoded_size > 0)
       {
-        eque->eq_read_ptr = nextElem;
+        pkt_elem->pkt_data = g_memdup(ffh->vst[ffh->vst[pict_elem->vid_track].video_stream_index].video_buffer
+                                     , encoded_size);
+        pkt_elem->pkt_size = encoded_size;
       }
-      else
+
+      g_get_current_time(&endTime);
+      eque->encodeMicrosecs += p_timespecDiff(&startTime, &endTime);
+    }
+
+    if(pict_elem->action == EQELEM_ACTION_FRAME)
+    {
+      if(eque->lastPictElem != NULL)
       {
-        /* next element is not ready, 
-         */
-        g_mutex_unlock (nextElem->elemMutex);
-        goto ENCODER_STOP;
+        p_releaseEncoderStageQueueElem(&eque->encodeQueue, eque->lastPictElem);
       }
+      eque->lastPictElem = pict_elem;
+    }
+    else
+    {
+      p_releaseEncoderStageQueueElem(&eque->encodeQueue, pict_elem);
     }
+
+    p_pushReadyEncoderStageQueueElem(&eque->muxQueue, pkt_elem);
   }
 
-  if(eque->eq_read_ptr->status == EQELEM_STATUS_READY)
+  if(gap_debug)
   {
-    eque->eq_read_ptr->status = EQELEM_STATUS_LOCK;
-
-
-    GAP_TIMM_START_RECORD(&eque->ethreadEncodeFrame);
-
-    /* Encode and write the current element (e.g. videoframe) at eq_read_ptr */
-    p_encodeCurrentQueueElem(eque);
+    printf("p_encoderWorkerThreadFunction: TID:%d  DONE\n"
+          , p_base_get_thread_id_as_int()
+          );
+  }
+  return (NULL);
 
-    if(eque->ffh->countVideoFramesWritten > 0)
-    {
-      /* fetch, encode and write one audioframe */
-      p_process_audio_frame(eque->ffh, eque->awp);
-    }
+}  /* end p_encoderWorkerThreadFunction */
 
-    GAP_TIMM_STOP_RECORD(&eque->ethreadEncodeFrame);
 
+/* -------------------------------------------
+ * p_muxWorkerThreadFunction
+ * -------------------------------------------
+ * thread function of the mux stage.
+ * writes the encoded videoframes from the muxQueue as packets to the mediafile
+ * and fetches, encodes and writes one audioframe per handled videoframe.
+ * Each handled frame is reported to the main thread via frameMuxedCond.
+ */
+static gpointer
+p_muxWorkerThreadFunction (EncoderQueue *eque)
+{
+  t_ffmpeg_handle  *ffh;
+  gboolean          isStopRequested;
 
-    /* setting EQELEM_STATUS_FREE enables re-use (e.g. overwrite)
-     * of this element's data buffers.
-     */
-    eque->eq_read_ptr->status = EQELEM_STATUS_FREE;
-    encoded_frame_nr = eque->eq_read_ptr->encode_frame_nr;
-    
-    /* encoding of the last n-frames is typically triggerd
-     * by setting the same frame n times to EQELEM_STATUS_READY
-     * repeated without advance to the next element.
-     * therefore the read pointer advance is done only in case
-     * when the next element with EQELEM_STATUS_READY is already available.
-     */
-    nextElem = eque->eq_read_ptr->next;
+  ffh = eque->ffh;
+  isStopRequested = FALSE;
+  while(isStopRequested != TRUE)
+  {
+    EncoderQueueElem *pkt_elem;
 
-    /* advance the lock to next element */
-    g_mutex_unlock (eque->eq_read_ptr->elemMutex);
+    pkt_elem = p_popReadyEncoderStageQueueElem(&eque->muxQueue);
 
-    if(TRUE != g_mutex_trylock (nextElem->elemMutex))
+    if(pkt_elem->action == EQELEM_ACTION_STOP)
     {
-        goto ENCODER_STOP;
+      isStopRequested = TRUE;
+      p_releaseEncoderStageQueueElem(&eque->muxQueue, pkt_elem);
     }
     else
     {
-      if (nextElem->status == EQELEM_STATUS_READY)
-      {
-        eque->eq_read_ptr = nextElem;
+      GTimeVal startTime;
+      GTimeVal endTime;
+
+      g_get_current_time(&startTime);
 
-        if(TRUE == g_mutex_trylock (eque->poolMutex))
+      if(pkt_elem->pkt_data != NULL)
+      {
+        if(ffh->output_context)
         {
-          g_cond_signal  (eque->frameEncodedCond);
-          g_mutex_unlock (eque->poolMutex);
+          p_ffmpeg_writeVideoPacket(ffh
+                                   , pkt_elem->pkt_data
+                                   , pkt_elem->pkt_size
+                                   , pkt_elem->pkt_pts
+                                   , pkt_elem->pkt_is_keyframe
+                                   , pkt_elem->vid_track
+                                   );
         }
-        /* next frame already available, contine the encoder loop */ 
-        goto ENCODER_LOOP;
+        g_free(pkt_elem->pkt_data);
+        pkt_elem->pkt_data = NULL;
       }
-      else
+
+      if(ffh->countVideoFramesWritten > 0)
       {
-        /* unlock because next element is not ready, 
-         */
-        g_mutex_unlock (nextElem->elemMutex);
+        /* fetch, encode and write one audioframe */
+        p_process_audio_frame(ffh, eque->awp);
       }
+
+      g_get_current_time(&endTime);
+      eque->muxMicrosecs += p_timespecDiff(&startTime, &endTime);
+
+      p_releaseEncoderStageQueueElem(&eque->muxQueue, pkt_elem);
+
+      g_mutex_lock (eque->poolMutex);
+      eque->framesInProgress--;
+      g_cond_signal  (eque->frameMuxedCond);
+      g_mutex_unlock (eque->poolMutex);
     }
+  }
 
+  if(gap_debug)
+  {
+    printf("p_muxWorkerThreadFunction: TID:%d  DONE\n"
+          , p_base_get_thread_id_as_int()
+          );
   }
-  else
+  return (NULL);
+
+}  /* end p_muxWorkerThreadFunction */
+
+
+/* -------------------------------------------
+ * p_init_EncoderQueueResources
+ * -------------------------------------------
+ * this procedure creates the encoder pipeline in case
+ * the gimprc parameters are configured for multiprocessor support.
+ * (otherwise those resources are not allocated and were initalized with NULL pointers)
+ *
+ * The pipeline has 4 stages that run in parallel:
+ *   fetch    (main thread)     storyboard render and copy to rgb888 buffer
+ *   convert  (convert thread)  rgb888 to the pix_fmt of the codec
+ *   encode   (encoder thread)  encode the picture with the selected codec
+ *   mux      (mux thread)      write video packets and audio frames to the mediafile
+ * The stages are connected by bounded queues, the number of elements
+ * of each queue is configured via gimprc.
+ */
+static EncoderQueue *
+p_init_EncoderQueueResources(t_ffmpeg_handle *ffh, t_awk_array *awp)
+{
+  EncoderQueue     *eque;
+  GError           *error;
+  gint              ii;
+
+  eque = g_new0(EncoderQueue ,1);
+  eque->ffh          = ffh;
+  eque->awp          = awp;
+  eque->fetchElem    = NULL;
+  eque->lastPictElem = NULL;
+  eque->framesInProgress = 0;
+  eque->poolMutex      = NULL;
+  eque->frameMuxedCond = NULL;
+  eque->convertThread  = NULL;
+  eque->encoderThread  = NULL;
+  eque->muxThread      = NULL;
+
+  if (ffh->isMultithreadEnabled)
   {
-    g_mutex_unlock (eque->eq_read_ptr->elemMutex);
+    /* check and init thread system */
+    ffh->isMultithreadEnabled = gap_base_thread_init();
+    if(gap_debug)
+    {
+      printf("p_init_EncoderQueueResources: isMultithreadEnabled: %d\n"
+        ,(int)ffh->isMultithreadEnabled
+        );
+    }
   }
-  
 
-  /* no element in ready status available.
-   * This can occure in followinc scenarios:
-   * a) all frames are encoded
-   *    in this case the main thread will free up resources and exit
-   *    or
-   * b) encoding was faster than fetching/rendering (in the main thread)
-   *    in this case the main thread will reactivate this thread pool function
-   *    when the next frame is enqued and reached the ready status.
-   *
-   * send signal to wake up main thread (even if nothing was actually encoded)
-   */
+  if (ffh->isMultithreadEnabled != TRUE)
+  {
+    return (eque);
+  }
 
-ENCODER_STOP:
+  p_init_EncoderStageQueue(&eque->convertQueue, "convert"
+      , gap_base_get_gimprc_int_value(GAP_GIMPRC_VIDEO_ENCODER_FFMPEG_QUEUE_CONVERT_SIZE
+                                     , ENCODER_QUEUE_DEFAULT_CONVERT_SIZE
+                                     , 1
+                                     , ENCODER_QUEUE_MAX_SIZE
+                                     )
+      );
+  /* the encoder thread keeps one picture for flushing, therefore at least 2 elements are required */
+  p_init_EncoderStageQueue(&eque->encodeQueue, "encode"
+      , gap_base_get_gimprc_int_value(GAP_GIMPRC_VIDEO_ENCODER_FFMPEG_QUEUE_ENCODE_SIZE
+                                     , ENCODER_QUEUE_DEFAULT_ENCODE_SIZE
+                                     , 2
+                                     , ENCODER_QUEUE_MAX_SIZE
+                                     )
+      );
+  p_init_EncoderStageQueue(&eque->muxQueue, "mux"
+      , gap_base_get_gimprc_int_value(GAP_GIMPRC_VIDEO_ENCODER_FFMPEG_QUEUE_MUX_SIZE
+                                     , ENCODER_QUEUE_DEFAULT_MUX_SIZE
+                                     , 1
+                                     , ENCODER_QUEUE_MAX_SIZE
+                                     )
+      );
 
-  /* lock at pool level */
-  if(g_mutex_trylock (eque->poolMutex) != TRUE)
+  for(ii=0; ii < eque->convertQueue.size; ii++)
   {
-    GAP_TIMM_START_RECORD(&eque->ethreadPoolMutexWaits);
-    g_mutex_lock (eque->poolMutex);
-    GAP_TIMM_STOP_RECORD(&eque->ethreadPoolMutexWaits);
+    eque->convertQueue.elems[ii].rgb_data = g_malloc(ffh->frame_width * ffh->frame_height * 3);
   }
+  for(ii=0; ii < eque->encodeQueue.size; ii++)
+  {
+    int jj;
+    int size;
 
-  if(gap_debug)
+    jj = ffh->vst[0].video_stream_index;
+    size = avpicture_get_size(ffh->vst[jj].vid_codec_context->pix_fmt, ffh->frame_width, ffh->frame_height);
+    eque->encodeQueue.elems[ii].picture_codec = avcodec_alloc_frame();
+    eque->encodeQueue.elems[ii].picture_buffer = g_malloc(MAX(size, ffh->frame_width * ffh->frame_height * 3));
+  }
+
+  eque->poolMutex      = g_mutex_new ();
+  eque->frameMuxedCond = g_cond_new ();
+
+  error = NULL;
+  eque->muxThread = g_thread_create((GThreadFunc)p_muxWorkerThreadFunction
+                                   , eque, TRUE /* joinable */, &error);
+  if(eque->muxThread != NULL)
   {
-    printf("p_encoderWorkerThreadFunction: TID:%d  send frameEncodedCond encoded_frame_nr:%d\n"
-          , p_base_get_thread_id_as_int()
-          , encoded_frame_nr
-          );
+    eque->encoderThread = g_thread_create((GThreadFunc)p_encoderWorkerThreadFunction
+                                   , eque, TRUE /* joinable */, &error);
+  }
+  if(eque->encoderThread != NULL)
+  {
+    eque->convertThread = g_thread_create((GThreadFunc)p_convertWorkerThreadFunction
+                                   , eque, TRUE /* joinable */, &error);
   }
-  eque->runningThreadsCounter--;
-  g_cond_signal  (eque->frameEncodedCond);
-  g_mutex_unlock (eque->poolMutex);
 
-  if(gap_debug)
+  if(eque->convertThread == NULL)
   {
-    printf("p_encoderWorkerThreadFunction: TID:%d  DONE eq_read_ptr:%d encoded_frame_nr:%d\n"
-          , p_base_get_thread_id_as_int()
-          , (int)eque->eq_read_ptr
-          , encoded_frame_nr
+    printf("WARNING: could not create encoder pipeline threads (%s)\n"
+          , (error != NULL) ? error->message : "unknown error"
           );
+    printf("         therefore single cpu processing will be done\n");
+    if(error != NULL)
+    {
+      g_error_free(error);
+    }
+    /* terminate already started stage threads and continue single threaded */
+    p_stop_EncoderQueueThreads(eque);
+    ffh->isMultithreadEnabled = FALSE;
   }
 
-}  /* end p_encoderWorkerThreadFunction */
+  return (eque);
+  
+}  /* end p_init_EncoderQueueResources */
 
 
-/* ------------------------------------------
- * p_ffmpeg_write_frame_and_audio_multithread
- * ------------------------------------------
- * trigger encoding one videoframe and one audioframe (in case audio is uesd)
- * The videoframe is enqueued and processed in parallel by the encoder worker thread.
- * Passing NULL as gapStoryFetchResult is used to flush one frame from the codecs internal buffer
- * (typically required after the last frame has been already feed to the codec)
+/* -------------------------------------------
+ * p_debug_print_EncoderQueueStatus
+ * -------------------------------------------
+ * print current fill level of all encoder pipeline queues
+ * to stdout for debug purpose.
  */
-static int
-p_ffmpeg_write_frame_and_audio_multithread(EncoderQueue *eque
-   , GapStoryFetchResult *gapStoryFetchResult, gboolean force_keyframe, gint vid_track)
+static void
+p_debug_print_EncoderQueueStatus(EncoderQueue *eque)
 {
-  GError *error = NULL;
-  gint retryCount;
+  if(eque->convertQueue.elems == NULL)
+  {
+    return;
+  }
+  printf("TID:%d encoder pipeline: framesInProgress:%d ready convert:%d encode:%d mux:%d\n"
+        , p_base_get_thread_id_as_int()
+        , (int)eque->framesInProgress
+        , (int)g_async_queue_length(eque->convertQueue.readyQueue)
+        , (int)g_async_queue_length(eque->encodeQueue.readyQueue)
+        , (int)g_async_queue_length(eque->muxQueue.readyQueue)
+        );
+
+}  /* end p_debug_print_EncoderQueueStatus */
 
-  GAP_TIMM_START_RECORD(&eque->mainWriteFrame);
 
-  retryCount = 0;
+/* -------------------------------------------
+ * p_print_EncoderStageQueueStatistics
+ * -------------------------------------------
+ */
+static void
+p_print_EncoderStageQueueStatistics(EncoderStageQueue *squeue)
+{
+  gdouble avgOccupancy;
 
-  if(encoderThreadPool == NULL)
+  avgOccupancy = 0.0;
+  if(squeue->numberOfPushes > 0)
   {
-    /* init thread pool for one encoder thread.
-     * The current implementation does not support 2 or more concurrent queue writer threads
-     * -- more threads would crash or produce unusable video --
-     * But independent form this setup some of the codecs in libavcodec do support
-     * multiple threads that are configuread with the treads encoder parameter.
-     */
-    encoderThreadPool = g_thread_pool_new((GFunc) p_encoderWorkerThreadFunction
-                                         ,NULL        /* user data */
-                                         ,1           /* max_threads */
-                                         ,TRUE        /* exclusive */
-                                         ,&error      /* GError **error */
-                                         );
+    avgOccupancy = (gdouble)squeue->sumOccupancy / (gdouble)squeue->numberOfPushes;
   }
+  printf("  queue %-8s size:%3d occupancy avg:%6.2f max:%3d  stall producer:%10.1f ms consumer:%10.1f ms\n"
+        , squeue->name
+        , (int)squeue->size
+        , (float)avgOccupancy
+        , (int)squeue->maxOccupancy
+        , (float)squeue->producerStallMicrosecs / 1000.0
+        , (float)squeue->consumerStallMicrosecs / 1000.0
+        );
 
-  if(gapStoryFetchResult != NULL)
+}  /* end p_print_EncoderStageQueueStatistics */
+
+
+/* -------------------------------------------
+ * p_print_EncoderQueueStatistics
+ * -------------------------------------------
+ * print per stage busy time and per queue occupancy and stall times
+ * of the encoder pipeline.
+ * (producer stall: the queue was full, consumer stall: the queue was empty)
+ */
+static void
+p_print_EncoderQueueStatistics(EncoderQueue *eque)
+{
+  if(eque->convertQueue.elems == NULL)
   {
-    /* a new frame is availble as gimp drawable
-     * and shall be enqueued at next position in the 
-     * EncoderQueue ringbuffer. Therefore first advance
-     * write position. 
-     */
-    eque->eq_write_ptr = eque->eq_write_ptr->next;
+    return;
+  }
+  printf("GAP FFMPEG encoder pipeline statistics:\n");
+  printf("  stage busy time fetch:%.1f ms convert:%.1f ms encode:%.1f ms mux:%.1f ms\n"
+        , (float)eque->fetchMicrosecs / 1000.0
+        , (float)eque->convertMicrosecs / 1000.0
+        , (float)eque->encodeMicrosecs / 1000.0
+        , (float)eque->muxMicrosecs / 1000.0
+        );
+  p_print_EncoderStageQueueStatistics(&eque->convertQueue);
+  p_print_EncoderStageQueueStatistics(&eque->encodeQueue);
+  p_print_EncoderStageQueueStatistics(&eque->muxQueue);
+
+}  /* end p_print_EncoderQueueStatistics */
+
+
+/* -----------------------------------------
+ * p_waitUntilEncoderQueIsProcessed
+ * -----------------------------------------
+ * wait until all frames that were enqueued by the main thread
+ * have passed all stages of the encoder pipeline
+ * (e.g. are written to the mediafile)
+ */
+static void
+p_waitUntilEncoderQueIsProcessed(EncoderQueue *eque)
+{
+  if(eque == NULL)
+  {
+    return;
+  }
+  if(eque->poolMutex == NULL)
+  {
+    return;
   }
 
   if(gap_debug)
   {
-    printf("p_ffmpeg_write_frame_and_audio_multithread: before elemMutex lock eq_write_ptr:%d STATUS:%d retry:%d encode_frame_nr:%d\n"
-          , (int)eque->eq_write_ptr
-          , (int)eque->eq_write_ptr->status
-          , (int)retryCount
-          , (int)eque->ffh->encode_frame_nr
-          );
-    fflush(stdout);
+    printf("p_waitUntilEncoderQueIsProcessed: MainTID:%d\n"
+            ,p_base_get_thread_id_as_int()
+            );
+    p_debug_print_EncoderQueueStatus(eque);
   }
-  
-  /* lock at element level (until element is filled and has reached EQELEM_STATUS_READY) */
-  if(g_mutex_trylock (eque->eq_write_ptr->elemMutex) != TRUE)
+
+  g_mutex_lock (eque->poolMutex);
+  while(eque->framesInProgress > 0)
   {
-    GAP_TIMM_START_RECORD(&eque->mainElemMutexWaits);
+    g_cond_wait (eque->frameMuxedCond, eque->poolMutex);
+  }
+  g_mutex_unlock (eque->poolMutex);
+
+}  /* end p_waitUntilEncoderQueIsProcessed */
 
-    g_mutex_lock (eque->eq_write_ptr->elemMutex);
 
-    GAP_TIMM_STOP_RECORD(&eque->mainElemMutexWaits);
+/* -----------------------------------------
+ * p_stop_EncoderQueueThreads
+ * -----------------------------------------
+ * send the stop request through all stages of the encoder pipeline
+ * and wait until all stage threads have terminated.
+ */
+static void
+p_stop_EncoderQueueThreads(EncoderQueue *eque)
+{
+  if(eque == NULL)
+  {
+    return;
   }
-  
-  if(gap_debug)
+
+  if(eque->convertThread != NULL)
   {
-    printf("p_ffmpeg_write_frame_and_audio_multithread: after elemMutex lock eq_write_ptr:%d STATUS:%d retry:%d encode_frame_nr:%d\n"
-          , (int)eque->eq_write_ptr
-          , (int)eque->eq_write_ptr->status
-          , (int)retryCount
-          , (int)eque->ffh->encode_frame_nr
-          );
+    EncoderQueueElem *rgb_elem;
+
+    /* the stop request passes all stages in order */
+    rgb_elem = p_getFreeEncoderStageQueueElem(&eque->convertQueue);
+    rgb_elem->action = EQELEM_ACTION_STOP;
+    p_pushReadyEncoderStageQueueElem(&eque->convertQueue, rgb_elem);
+    g_thread_join(eque->convertThread);
+    eque->convertThread = NULL;
   }
-  
-  while(eque->eq_write_ptr->status != EQELEM_STATUS_FREE)
+  else if(eque->encoderThread != NULL)
   {
-    GAP_TIMM_START_RECORD(&eque->mainEnqueueWaits);
-    
-    g_mutex_unlock (eque->eq_write_ptr->elemMutex);
+    EncoderQueueElem *pict_elem;
 
-    /* lock at pool level for checking numer of running encoder threads (0 or 1 expected) */
-    if(g_mutex_trylock (eque->poolMutex) != TRUE)
-    {
-      GAP_TIMM_START_RECORD(&eque->mainPoolMutexWaits);
-      g_mutex_lock (eque->poolMutex);
-      GAP_TIMM_STOP_RECORD(&eque->mainPoolMutexWaits);
-    }
+    pict_elem = p_getFreeEncoderStageQueueElem(&eque->encodeQueue);
+    pict_elem->action = EQELEM_ACTION_STOP;
+    p_pushReadyEncoderStageQueueElem(&eque->encodeQueue, pict_elem);
+  }
+  else if(eque->muxThread != NULL)
+  {
+    EncoderQueueElem *pkt_elem;
 
-    if(eque->runningThreadsCounter <= 0)
-    {
-      if(gap_debug)
-      {
-        printf("p_ffmpeg_write_frame_and_audio_multithread: PUSH-1 (re)start worker thread eq_write_ptr:%d STATUS:%d retry:%d encode_frame_nr:%d\n"
-          , (int)eque->eq_write_ptr
-          , (int)eque->eq_write_ptr->status
-          , (int)retryCount
-          , (int)eque->ffh->encode_frame_nr
-          );
-      }
-      /* (re)activate encoder thread */
-      eque->runningThreadsCounter++;
-      g_thread_pool_push (encoderThreadPool
-                         , eque    /* VideoPrefetchData */
-                         , &error
-                         );
-    }
+    pkt_elem = p_getFreeEncoderStageQueueElem(&eque->muxQueue);
+    pkt_elem->action = EQELEM_ACTION_STOP;
+    p_pushReadyEncoderStageQueueElem(&eque->muxQueue, pkt_elem);
+  }
 
-    /* ringbuffer queue is currently full, 
-     * have to wait until encoder thread finished processing for at least one frame
-     * and sets the status to EQELEM_STATUS_FREE.
-     * g_cond_wait Waits until this thread is woken up on frameEncodedCond. 
-     * The mutex is unlocked before falling asleep and locked again before resuming. 
-     */
-    if(gap_debug)
-    {
-      printf("p_ffmpeg_write_frame_and_audio_multithread: WAIT MainTID:%d retry:%d encode_frame_nr:%d\n"
-        ,  p_base_get_thread_id_as_int()
-        , (int)retryCount
-        , (int)eque->ffh->encode_frame_nr
-        );
-    }
-    g_cond_wait (eque->frameEncodedCond, eque->poolMutex);
-    if(gap_debug)
-    {
-      printf("p_ffmpeg_write_frame_and_audio_multithread: WAKE-UP MainTID:%d retry:%d encode_frame_nr:%d\n"
-        ,  p_base_get_thread_id_as_int()
-        , (int)retryCount
-        , (int)eque->ffh->encode_frame_nr
-        );
-    }
-    g_mutex_unlock (eque->poolMutex);
+  if(eque->encoderThread != NULL)
+  {
+    g_thread_join(eque->encoderThread);
+    eque->encoderThread = NULL;
+  }
+  if(eque->muxThread != NULL)
+  {
+    g_thread_join(eque->muxThread);
+    eque->muxThread = NULL;
+  }
 
-    retryCount++;
-    if(retryCount > 100)
-    {
-      printf("** INTERNAL ERROR: failed to enqueue frame data after %d reties!\n"
-         ,(int)retryCount
-         );
-      exit (1);
-    }
+  if(gap_debug)
+  {
+    printf("p_stop_EncoderQueueThreads: all stage threads terminated\n");
+  }
 
-    /* lock at element level (until element is filled and has reached EQELEM_STATUS_READY) */
-    g_mutex_lock (eque->eq_write_ptr->elemMutex);
+}  /* end p_stop_EncoderQueueThreads */
 
-    GAP_TIMM_STOP_RECORD(&eque->mainEnqueueWaits);
 
+/* -------------------------------------------
+ * p_free_EncoderQueueResources
+ * -------------------------------------------
+ * this procedure frees the resources for the specified EncoderQueue.
+ * (the stage threads are stopped if still running)
+ * Note: this does NOT include the ffh reference.
+ *
+ */
+static void
+p_free_EncoderQueueResources(EncoderQueue     *eque)
+{
+  if(eque == NULL)
+  {
+    return;
   }
 
+  p_stop_EncoderQueueThreads(eque);
 
-  if(gap_debug)
+  eque->fetchElem = NULL;
+  eque->lastPictElem = NULL;
+  p_free_EncoderStageQueue(&eque->convertQueue);
+  p_free_EncoderStageQueue(&eque->encodeQueue);
+  p_free_EncoderStageQueue(&eque->muxQueue);
+
+  if(eque->frameMuxedCond != NULL)
   {
-    printf("p_ffmpeg_write_frame_and_audio_multithread: FILL-QUEUE eq_write_ptr:%d STATUS:%d retry:%d encode_frame_nr:%d\n"
-      , (int)eque->eq_write_ptr
-      , (int)eque->eq_write_ptr->status
-      , (int)retryCount
-      , (int)eque->ffh->encode_frame_nr
-      );
+    g_cond_free(eque->frameMuxedCond);
+    eque->frameMuxedCond = NULL;
+  }
+  if(eque->poolMutex != NULL)
+  {
+    g_mutex_free(eque->poolMutex);
+    eque->poolMutex = NULL;
   }
 
-  /* convert gapStoryFetchResult and put resulting data into element eque->eq_write_ptr */
-  p_fillQueueElem(eque, gapStoryFetchResult, force_keyframe, vid_track);
+}  /* end p_free_EncoderQueueResources */
 
-  eque->eq_write_ptr->status = EQELEM_STATUS_READY;
 
-  g_mutex_unlock (eque->eq_write_ptr->elemMutex);
-  
+/* ------------------------------------------
+ * p_reserveFetchEncoderQueueElem
+ * ------------------------------------------
+ * reserve the next free element of the convertQueue for the fetch stage
+ * and return its rgb_data buffer.
+ * The caller passes this buffer as raw_rgb_data to the storyboard render processor
+ * that renders rgb888 results directly into caller supplied buffers.
+ * This way the composite frame is rendered into the encoder pipeline
+ * without an extra copy. (blocks while the convertQueue is full)
+ */
+static guchar *
+p_reserveFetchEncoderQueueElem(EncoderQueue *eque)
+{
+  if(eque->fetchElem == NULL)
+  {
+    eque->fetchElem = p_getFreeEncoderStageQueueElem(&eque->convertQueue);
+  }
+  return (eque->fetchElem->rgb_data);
 
-  /* try lock at pool level to check if encoder thread is already running
-   * and (re)start if this is not the case.
-   * in case g_mutex_trylock returns FALSE, the mutex is already locked
-   * and it can be assumed that the encoder Thread is the lock holder and already running
-   */
-  if(TRUE == g_mutex_trylock (eque->poolMutex))
+}  /* end p_reserveFetchEncoderQueueElem */
+
+
+/* ------------------------------------------
+ * p_ffmpeg_write_frame_and_audio_multithread
+ * ------------------------------------------
+ * fetch stage of the encoder pipeline (runs in the main thread).
+ * passes the videoframe in the reserved element of the convertQueue
+ * to the convert thread. In case the frame was rendered as rgb888 into the
+ * rgb_data buffer of the reserved element (see p_reserveFetchEncoderQueueElem)
+ * no copy is required, otherwise the frame is copied. Conversion, encoding and writing
+ * of the videoframe and one audioframe (in case audio is used)
+ * are done in parallel by the following pipeline stages.
+ * Passing NULL as gapStoryFetchResult is used to flush one frame from the codecs internal buffer
+ * (typically required after the last frame has been already feed to the codec)
+ * returns 0 if OK, -1 in case the frame could not be copied into the pipeline
+ * (in this case nothing is enqueued and the caller shall abort the encode)
+ */
+static int
+p_ffmpeg_write_frame_and_audio_multithread(EncoderQueue *eque
+   , GapStoryFetchResult *gapStoryFetchResult, gboolean force_keyframe, gint vid_track)
+{
+  EncoderQueueElem *rgb_elem;
+  GTimeVal          startTime;
+  GTimeVal          endTime;
+
+  if(eque->fetchElem != NULL)
   {
-    if(eque->runningThreadsCounter <= 0)
-    {
-      GAP_TIMM_START_RECORD(&eque->mainPush2);
-      
-      if(gap_debug)
-      {
-        printf("p_ffmpeg_write_frame_and_audio_multithread: PUSH-2 (re)start worker thread eq_write_ptr:%d STATUS:%d retry:%d encode_frame_nr:%d\n"
-          , (int)eque->eq_write_ptr
-          , (int)eque->eq_write_ptr->status
-          , (int)retryCount
-          , (int)eque->ffh->encode_frame_nr
-          );
-      }
+    rgb_elem = eque->fetchElem;
+    eque->fetchElem = NULL;
+  }
+  else
+  {
+    rgb_elem = p_getFreeEncoderStageQueueElem(&eque->convertQueue);
+  }
+
+  g_get_current_time(&startTime);
 
-      /* (re)activate encoder thread */
-      eque->runningThreadsCounter++;
-      g_thread_pool_push (encoderThreadPool
-                         , eque    /* VideoPrefetchData */
-                         , &error
-                         );
+  rgb_elem->action          = EQELEM_ACTION_FLUSH;
+  rgb_elem->encode_frame_nr = eque->ffh->encode_frame_nr;
+  rgb_elem->vid_track       = vid_track;
+  rgb_elem->force_keyframe  = force_keyframe;
 
-      GAP_TIMM_STOP_RECORD(&eque->mainPush2);
+  if(gapStoryFetchResult != NULL)
+  {
+    if((gapStoryFetchResult->resultEnum == GAP_STORY_FETCH_RESULT_IS_RAW_RGB888)
+    && (gapStoryFetchResult->raw_rgb_data == rgb_elem->rgb_data))
+    {
+      /* the frame was rendered directly into the queue element (zero copy) */
+      rgb_elem->action = EQELEM_ACTION_FRAME;
     }
+    else if(p_ffmpeg_copy_GapStoryFetchResult_to_RgbBuffer(eque->ffh
+                 , gapStoryFetchResult
+                 , rgb_elem->rgb_data) == TRUE)
+    {
+      rgb_elem->action = EQELEM_ACTION_FRAME;
+    }
+    else
+    {
+      /* do not enqueue the element as FLUSH, that would silently
+       * repeat the previous frame instead of the requested one.
+       */
+      printf("** ERROR p_ffmpeg_write_frame_and_audio_multithread: failed to copy frame (encode_frame_nr:%d) into the encoder queue\n"
+            , (int)rgb_elem->encode_frame_nr
+            );
+      p_releaseEncoderStageQueueElem(&eque->convertQueue, rgb_elem);
+      return (-1);
+    }
+
+    if(gapStoryFetchResult->raw_rgb_data == rgb_elem->rgb_data)
+    {
+      /* the buffer is owned by the pipeline from now on */
+      gapStoryFetchResult->raw_rgb_data = NULL;
+    }
+  }
 
-    g_mutex_unlock (eque->poolMutex);
+  g_get_current_time(&endTime);
+  eque->fetchMicrosecs += p_timespecDiff(&startTime, &endTime);
 
+  if(gap_debug)
+  {
+    printf("p_ffmpeg_write_frame_and_audio_multithread: MainTID:%d enqueue action:%d encode_frame_nr:%d\n"
+          , p_base_get_thread_id_as_int()
+          , (int)rgb_elem->action
+          , (int)rgb_elem->encode_frame_nr
+          );
   }
 
-  GAP_TIMM_STOP_RECORD(&eque->mainWriteFrame);
+  g_mutex_lock (eque->poolMutex);
+  eque->framesInProgress++;
+  g_mutex_unlock (eque->poolMutex);
+
+  p_pushReadyEncoderStageQueueElem(&eque->convertQueue, rgb_elem);
+
+  return (0);
 
 }  /* end p_ffmpeg_write_frame_and_audio_multithread */
 
@@ -5012,6 +5194,7 @@ p_ffmpeg_encode_pass(GapGveFFMpegGlobalParams *gpp, gint32 current_pass, GapGveM
   GapGveFFMpegValues   *epp = NULL;
   t_ffmpeg_handle      *ffh = NULL;
   EncoderQueue         *eque = NULL;
+  GTimeVal              fetchStartTime;
   GapGveStoryVidHandle        *l_vidhand = NULL;
   long          l_master_frame_nr;
   long          l_step, l_begin, l_end;
@@ -5204,7 +5387,20 @@ p_ffmpeg_encode_pass(GapGveFFMpegGlobalParams *gpp, gint32 current_pass, GapGveM
     GAP_TIMM_START_FUNCTION(funcIdVidFetch);
     if(eque)
     {
-      GAP_TIMM_START_RECORD(&eque->mainReadFrame);
+      g_get_current_time(&fetchStartTime);
+    }
+    if(ffh->isMultithreadEnabled)
+    {
+      guchar *elem_rgb_data;
+
+      /* let the renderer write rgb888 results directly into the encoder pipeline */
+      elem_rgb_data = p_reserveFetchEncoderQueueElem(eque);
+      if((gapStoryFetchResult->raw_rgb_data != NULL)
+      && (gapStoryFetchResult->raw_rgb_data != elem_rgb_data))
+      {
+        g_free(gapStoryFetchResult->raw_rgb_data);
+      }
+      gapStoryFetchResult->raw_rgb_data = elem_rgb_data;
     }
 
     
@@ -5229,7 +5425,10 @@ p_ffmpeg_encode_pass(GapGveFFMpegGlobalParams *gpp, gint32 current_pass, GapGveM
     GAP_TIMM_STOP_FUNCTION(funcIdVidFetch);
     if(eque)
     {
-      GAP_TIMM_STOP_RECORD(&eque->mainReadFrame);
+      GTimeVal fetchEndTime;
+
+      g_get_current_time(&fetchEndTime);
+      eque->fetchMicrosecs += p_timespecDiff(&fetchStartTime, &fetchEndTime);
     }
 
     if(gap_debug)
@@ -5292,7 +5491,10 @@ p_ffmpeg_encode_pass(GapGveFFMpegGlobalParams *gpp, gint32 current_pass, GapGveM
 
         if(ffh->isMultithreadEnabled)
         {
-          p_ffmpeg_write_frame_and_audio_multithread(eque, gapStoryFetchResult, l_force_keyframe, 0 /* vid_track */ );
+          if(p_ffmpeg_write_frame_and_audio_multithread(eque, gapStoryFetchResult, l_force_keyframe, 0 /* vid_track */ ) < 0)
+          {
+            l_rc = -1;
+          }
         }
         else
         {
@@ -5381,8 +5583,12 @@ p_ffmpeg_encode_pass(GapGveFFMpegGlobalParams *gpp, gint32 current_pass, GapGveM
                 ,p_base_get_thread_id_as_int()
                 ,(int)flushCount
                 );
-             p_debug_print_RingbufferStatus(eque);
+             p_debug_print_EncoderQueueStatus(eque);
            }
+           /* the flushed frame must pass all pipeline stages before
+            * ffh->countVideoFramesWritten can be checked for the next flush try
+            */
+           p_waitUntilEncoderQueIsProcessed(eque);
          }
          else
          {
@@ -5415,7 +5621,11 @@ p_ffmpeg_encode_pass(GapGveFFMpegGlobalParams *gpp, gint32 current_pass, GapGveM
     
     if(ffh->isMultithreadEnabled)
     {
+      /* the stage threads use the codecs and the output context of the ffh,
+       * therefore terminate them before close
+       */
       p_waitUntilEncoderQueIsProcessed(eque);
+      p_stop_EncoderQueueThreads(eque);
     }
     
     p_ffmpeg_close(ffh);
@@ -5461,21 +5671,15 @@ p_ffmpeg_encode_pass(GapGveFFMpegGlobalParams *gpp, gint32 current_pass, GapGveM
 
   if(eque)
   {
-    g_usleep(30000);  /* sleep 0.3 seconds */
-    
-    /*  print MAIN THREAD runtime statistics */
-    GAP_TIMM_PRINT_RECORD(&eque->mainReadFrame,         "... mainReadFrame");
-    GAP_TIMM_PRINT_RECORD(&eque->mainWriteFrame,        "... mainWriteFrame");
-    GAP_TIMM_PRINT_RECORD(&eque->mainDrawableToRgb,     "... mainWriteFrame.DrawableToRgb");
-    GAP_TIMM_PRINT_RECORD(&eque->mainElemMutexWaits,    "... mainElemMutexWaits");
-    GAP_TIMM_PRINT_RECORD(&eque->mainPoolMutexWaits,    "... mainPoolMutexWaits");
-    GAP_TIMM_PRINT_RECORD(&eque->mainEnqueueWaits,      "... mainEnqueueWaits");
-    GAP_TIMM_PRINT_RECORD(&eque->mainPush2,             "... mainPush2 (re-start times of encoder thread)");
-
-    /*  print Encoder THREAD runtime statistics */
-    GAP_TIMM_PRINT_RECORD(&eque->ethreadElemMutexWaits, "... ethreadElemMutexWaits");
-    GAP_TIMM_PRINT_RECORD(&eque->ethreadPoolMutexWaits, "... ethreadPoolMutexWaits");
-    GAP_TIMM_PRINT_RECORD(&eque->ethreadEncodeFrame,    "... ethreadEncodeFrame");
+    /* print per stage busy times and queue occupancy of the encoder pipeline */
+    p_print_EncoderQueueStatistics(eque);
+
+    if((eque->fetchElem != NULL)
+    && (gapStoryFetchResult->raw_rgb_data == eque->fetchElem->rgb_data))
+    {
+      /* the buffer of the reserved (unused) element is freed with the queue */
+      gapStoryFetchResult->raw_rgb_data = NULL;
+    }
 
     p_free_EncoderQueueResources(eque);
     g_free(eque);